@@ -0,0 +1,396 @@
+
+// LuaAsyncJobs.cpp
+
+// Implements the jobs that the Lua plugins run in the cWorkerPool threads, and the cLuaPortableValue class used to pass data to them
+
+#include "Globals.h"
+#include "LuaAsyncJobs.h"
+#include "PluginProfiler.h"
+#include "tolua++/include/tolua++.h"
+#include "../BlockArea.h"
+#include "../Root.h"
+#include "../WorldStorage/SchematicFileSerializer.h"
+
+
+
+
+
+// fwd: SQLite/lsqlite3.c
+extern "C"
+{
+	int luaopen_lsqlite3(lua_State * L);
+}
+
+// fwd: LuaExpat/lxplib.c:
+extern "C"
+{
+	int luaopen_lxp(lua_State * L);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLuaPortableValue:
+
+cLuaPortableValue::cLuaPortableValue(void) :
+	m_Type(vtNil),
+	m_Boolean(false),
+	m_Number(0)
+{
+}
+
+
+
+
+
+bool cLuaPortableValue::Read(lua_State * a_LuaState, int a_StackPos, AString & a_Error)
+{
+	// Make the index absolute, the table traversal pushes values onto the stack:
+	if ((a_StackPos < 0) && (a_StackPos > LUA_REGISTRYINDEX))
+	{
+		a_StackPos = lua_gettop(a_LuaState) + a_StackPos + 1;
+	}
+	return Read(a_LuaState, a_StackPos, a_Error, 0);
+}
+
+
+
+
+
+bool cLuaPortableValue::Read(lua_State * a_LuaState, int a_StackPos, AString & a_Error, int a_Depth)
+{
+	switch (lua_type(a_LuaState, a_StackPos))
+	{
+		case LUA_TNIL:
+		{
+			m_Type = vtNil;
+			return true;
+		}
+		case LUA_TBOOLEAN:
+		{
+			m_Type = vtBoolean;
+			m_Boolean = (lua_toboolean(a_LuaState, a_StackPos) != 0);
+			return true;
+		}
+		case LUA_TNUMBER:
+		{
+			m_Type = vtNumber;
+			m_Number = lua_tonumber(a_LuaState, a_StackPos);
+			return true;
+		}
+		case LUA_TSTRING:
+		{
+			size_t Len = 0;
+			const char * Str = lua_tolstring(a_LuaState, a_StackPos, &Len);
+			m_Type = vtString;
+			m_String.assign(Str, Len);
+			return true;
+		}
+		case LUA_TTABLE:
+		{
+			if (a_Depth >= MAX_DEPTH)
+			{
+				a_Error = "the tables are nested too deep";
+				return false;
+			}
+			if (!lua_checkstack(a_LuaState, STACK_SLOTS_PER_LEVEL))
+			{
+				a_Error = "the Lua stack is too small for the nested tables";
+				return false;
+			}
+			m_Type = vtTable;
+			m_Table = std::make_shared<cValues>();
+			lua_pushnil(a_LuaState);
+			while (lua_next(a_LuaState, a_StackPos) != 0)
+			{
+				// The key is at -2, the value at -1:
+				int Top = lua_gettop(a_LuaState);
+				m_Table->push_back(cLuaPortableValue());
+				m_Table->push_back(cLuaPortableValue());
+				cLuaPortableValue & Key = (*m_Table)[m_Table->size() - 2];
+				cLuaPortableValue & Value = (*m_Table)[m_Table->size() - 1];
+				if (!Key.Read(a_LuaState, Top - 1, a_Error, a_Depth + 1) || !Value.Read(a_LuaState, Top, a_Error, a_Depth + 1))
+				{
+					lua_pop(a_LuaState, 2);
+					return false;
+				}
+				lua_pop(a_LuaState, 1);  // Keep the key for lua_next()
+			}
+			return true;
+		}
+		default:
+		{
+			a_Error = Printf("a %s value cannot be passed between Lua states", lua_typename(a_LuaState, lua_type(a_LuaState, a_StackPos)));
+			return false;
+		}
+	}
+}
+
+
+
+
+
+bool cLuaPortableValue::Push(lua_State * a_LuaState) const
+{
+	if (!lua_checkstack(a_LuaState, STACK_SLOTS_PER_LEVEL))
+	{
+		return false;
+	}
+	switch (m_Type)
+	{
+		case vtNil:     lua_pushnil(a_LuaState);                                    break;
+		case vtBoolean: lua_pushboolean(a_LuaState, m_Boolean ? 1 : 0);             break;
+		case vtNumber:  lua_pushnumber(a_LuaState, m_Number);                       break;
+		case vtString:  lua_pushlstring(a_LuaState, m_String.data(), m_String.size()); break;
+		case vtTable:
+		{
+			lua_createtable(a_LuaState, 0, static_cast<int>(m_Table->size() / 2));
+			for (size_t i = 0; i + 1 < m_Table->size(); i += 2)
+			{
+				if (!(*m_Table)[i].Push(a_LuaState))
+				{
+					lua_pop(a_LuaState, 1);  // The table
+					return false;
+				}
+				if (!(*m_Table)[i + 1].Push(a_LuaState))
+				{
+					lua_pop(a_LuaState, 2);  // The key and the table
+					return false;
+				}
+				lua_rawset(a_LuaState, -3);
+			}
+			break;
+		}
+	}
+	return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLuaAsyncJob:
+
+cLuaAsyncJob::cLuaAsyncJob(cPluginLua & a_Plugin, lua_State * a_LuaState) :
+	cPluginLua::cResettable(a_Plugin)
+{
+	m_CallbackName = "async " + cPluginProfiler::GetFunctionName(a_LuaState, -1);
+	m_CallbackRef = luaL_ref(a_LuaState, LUA_REGISTRYINDEX);
+}
+
+
+
+
+
+void cLuaAsyncJob::Finished(void)
+{
+	cCSLock Lock(m_CSPlugin);
+	if (m_Plugin == nullptr)
+	{
+		// The plugin has been unloaded while the job was running
+		return;
+	}
+	cPluginLua::cOperation Op(*m_Plugin);
+	lua_State * L = Op();
+	{
+		cPluginProfiler::cScope ProfilerScope(m_Plugin->GetProfiler(), cPluginProfiler::pcTask, m_CallbackName);
+		lua_rawgeti(L, LUA_REGISTRYINDEX, m_CallbackRef);
+		int NumParams = PushResults(L);
+		int s = lua_pcall(L, NumParams, 0, 0);
+		if (cLuaState::ReportErrors(L, s))
+		{
+			LOGWARNING("Error in plugin %s calling the async job callback %s", m_Plugin->GetName().c_str(), m_CallbackName.c_str());
+		}
+	}
+	luaL_unref(L, LUA_REGISTRYINDEX, m_CallbackRef);
+
+	// The job is done, the plugin doesn't need to reset it anymore:
+	m_Plugin->RemoveResettable(this);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLuaAsyncCodeJob:
+
+cLuaAsyncCodeJob::cLuaAsyncCodeJob(cPluginLua & a_Plugin, lua_State * a_LuaState, const AString & a_Code, const cLuaPortableValues & a_Params) :
+	super(a_Plugin, a_LuaState),
+	m_Code(a_Code),
+	m_Params(a_Params),
+	m_IsSuccess(false)
+{
+}
+
+
+
+
+
+void cLuaAsyncCodeJob::Execute(void)
+{
+	// Create a Lua state with no access to the server:
+	cLuaState LuaState("async job");
+	LuaState.Create();
+	lua_State * L = LuaState;
+	luaopen_lsqlite3(L);
+	luaopen_lxp(L);
+	lua_settop(L, 0);
+
+	// Run the code:
+	int s = luaL_loadbuffer(L, m_Code.data(), m_Code.size(), m_CallbackName.c_str());
+	if (s == 0)
+	{
+		if (!lua_checkstack(L, static_cast<int>(m_Params.size())))
+		{
+			m_Error = Printf("Cannot pass %u parameters to the async job, the Lua stack is too small", static_cast<unsigned>(m_Params.size()));
+			return;
+		}
+		for (cLuaPortableValues::const_iterator itr = m_Params.begin(), end = m_Params.end(); itr != end; ++itr)
+		{
+			if (!itr->Push(L))
+			{
+				m_Error = Printf("Cannot pass parameter #%d to the async job, the Lua stack is too small", static_cast<int>(itr - m_Params.begin()) + 1);
+				return;
+			}
+		}
+
+		// Abort the code once the server is stopping, the worker pool waits for the job to finish:
+		lua_sethook(L, &cLuaAsyncCodeJob::StopHook, LUA_MASKCOUNT, STOP_CHECK_INSTRUCTION_COUNT);
+		s = lua_pcall(L, static_cast<int>(m_Params.size()), LUA_MULTRET, 0);
+		lua_sethook(L, nullptr, 0, 0);
+	}
+	if (s != 0)
+	{
+		const char * Error = lua_tostring(L, -1);
+		m_Error = (Error != nullptr) ? Error : "unknown error";
+		return;
+	}
+
+	// Copy the results:
+	int NumResults = lua_gettop(L);
+	m_Results.resize(static_cast<size_t>(NumResults));
+	for (int i = 0; i < NumResults; i++)
+	{
+		AString Error;
+		if (!m_Results[static_cast<size_t>(i)].Read(L, i + 1, Error))
+		{
+			m_Results.clear();
+			m_Error = Printf("Cannot return value #%d from the async job: %s", i + 1, Error.c_str());
+			return;
+		}
+	}
+	m_IsSuccess = true;
+}
+
+
+
+
+
+void cLuaAsyncCodeJob::StopHook(lua_State * a_LuaState, lua_Debug * a_Debug)
+{
+	UNUSED(a_Debug);
+
+	if (cRoot::Get()->GetWorkerPool().IsStopping())
+	{
+		luaL_error(a_LuaState, "The async job was aborted, the server is stopping");
+	}
+}
+
+
+
+
+
+int cLuaAsyncCodeJob::PushResults(lua_State * a_LuaState)
+{
+	if (m_IsSuccess && lua_checkstack(a_LuaState, static_cast<int>(m_Results.size()) + 1))
+	{
+		int Top = lua_gettop(a_LuaState);
+		lua_pushboolean(a_LuaState, 1);
+		bool IsPushed = true;
+		for (cLuaPortableValues::const_iterator itr = m_Results.begin(), end = m_Results.end(); itr != end; ++itr)
+		{
+			if (!itr->Push(a_LuaState))
+			{
+				IsPushed = false;
+				break;
+			}
+		}
+		if (IsPushed)
+		{
+			return static_cast<int>(m_Results.size()) + 1;
+		}
+		lua_settop(a_LuaState, Top);
+	}
+
+	// Report the failure, or the results that don't fit onto the plugin's Lua stack:
+	lua_pushboolean(a_LuaState, 0);
+	if (m_IsSuccess)
+	{
+		AString Error = Printf("Cannot return %u values from the async job, the Lua stack is too small", static_cast<unsigned>(m_Results.size()));
+		lua_pushlstring(a_LuaState, Error.data(), Error.size());
+	}
+	else
+	{
+		lua_pushlstring(a_LuaState, m_Error.data(), m_Error.size());
+	}
+	return 2;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLuaAsyncSchematicJob:
+
+cLuaAsyncSchematicJob::cLuaAsyncSchematicJob(cPluginLua & a_Plugin, lua_State * a_LuaState, const AString & a_FileName) :
+	super(a_Plugin, a_LuaState),
+	m_FileName(a_FileName)
+{
+}
+
+
+
+
+
+cLuaAsyncSchematicJob::~cLuaAsyncSchematicJob()
+{
+}
+
+
+
+
+
+void cLuaAsyncSchematicJob::Execute(void)
+{
+	m_Area.reset(new cBlockArea);
+	if (!cSchematicFileSerializer::LoadFromSchematicFile(*m_Area, m_FileName))
+	{
+		m_Area.reset();
+	}
+}
+
+
+
+
+
+int cLuaAsyncSchematicJob::PushResults(lua_State * a_LuaState)
+{
+	if (m_Area == nullptr)
+	{
+		lua_pushnil(a_LuaState);
+	}
+	else
+	{
+		tolua_pushusertype_and_takeownership(a_LuaState, m_Area.release(), "cBlockArea");
+	}
+	return 1;
+}
+
+
+
+
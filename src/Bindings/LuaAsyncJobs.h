@@ -0,0 +1,169 @@
+
+// LuaAsyncJobs.h
+
+// Declares the jobs that the Lua plugins run in the cWorkerPool threads, and the cLuaPortableValue class used to pass data to them
+
+
+
+
+
+#pragma once
+
+#include "PluginLua.h"
+#include "../WorkerPool.h"
+
+
+
+
+
+class cBlockArea;
+
+
+
+
+
+/** A copy of a Lua value that can be moved from one Lua state to another: nil, a boolean, a number, a string,
+or a table of those. Used to pass the parameters and the results of the async jobs. */
+class cLuaPortableValue
+{
+public:
+
+	cLuaPortableValue(void);
+
+	/** Copies the value at the specified stack index.
+	Returns false and fills in a_Error if the value contains anything that cannot be copied
+	(functions, userdata, threads, or tables nested too deep). */
+	bool Read(lua_State * a_LuaState, int a_StackPos, AString & a_Error);
+
+	/** Pushes a copy of the value onto the Lua stack.
+	Returns false, with the stack left unchanged, if the Lua stack cannot grow enough to hold the nested tables. */
+	bool Push(lua_State * a_LuaState) const;
+
+protected:
+
+	enum eType
+	{
+		vtNil,
+		vtBoolean,
+		vtNumber,
+		vtString,
+		vtTable,
+	} ;
+
+	typedef std::vector<cLuaPortableValue> cValues;
+
+	/** Maximum nesting of the tables; protects against the reference cycles */
+	static const int MAX_DEPTH = 32;
+
+	/** The number of the Lua stack slots needed by a single table level while reading or pushing: the table, a key and a value */
+	static const int STACK_SLOTS_PER_LEVEL = 3;
+
+	eType m_Type;
+	bool m_Boolean;
+	lua_Number m_Number;
+	AString m_String;
+
+	/** The table's keys and values, alternating */
+	SharedPtr<cValues> m_Table;
+
+
+	bool Read(lua_State * a_LuaState, int a_StackPos, AString & a_Error, int a_Depth);
+} ;
+
+typedef std::vector<cLuaPortableValue> cLuaPortableValues;
+
+
+
+
+
+/** The base for the async jobs of the Lua plugins: keeps the reference to the plugin's callback function
+and calls it from the tick thread once the job has been executed. */
+class cLuaAsyncJob :
+	public cWorkerPool::cJob,
+	public cPluginLua::cResettable
+{
+public:
+	/** Creates the job; the callback function is taken from the top of the plugin's Lua stack and popped */
+	cLuaAsyncJob(cPluginLua & a_Plugin, lua_State * a_LuaState);
+
+	// cWorkerPool::cJob override:
+	virtual void Finished(void) override;
+
+protected:
+	/** Reference to the callback function in the plugin's Lua state */
+	int m_CallbackRef;
+
+	/** The name of the callback function, for the plugin's profiler */
+	AString m_CallbackName;
+
+	/** Pushes the callback's parameters onto the plugin's Lua stack, returns their number */
+	virtual int PushResults(lua_State * a_LuaState) = 0;
+} ;
+
+
+
+
+
+/** Runs a piece of Lua code in a separate Lua state in a worker thread.
+The worker state has the standard libraries, lsqlite3 and lxp, but none of the server API.
+The code gets the job's parameters as "...", and its return values are passed to the callback, after a true;
+if the code fails, the callback receives false and the error message. */
+class cLuaAsyncCodeJob :
+	public cLuaAsyncJob
+{
+	typedef cLuaAsyncJob super;
+
+public:
+	cLuaAsyncCodeJob(cPluginLua & a_Plugin, lua_State * a_LuaState, const AString & a_Code, const cLuaPortableValues & a_Params);
+
+	// cWorkerPool::cJob override:
+	virtual void Execute(void) override;
+
+protected:
+	AString m_Code;
+	cLuaPortableValues m_Params;
+
+	bool m_IsSuccess;
+	cLuaPortableValues m_Results;
+	AString m_Error;
+
+	/** The number of Lua instructions between the checks whether the worker pool is stopping */
+	static const int STOP_CHECK_INSTRUCTION_COUNT = 10000;
+
+	/** The lua_sethook() callback, aborts the code with an error once the worker pool is stopping,
+	so that a runaway job doesn't hang the server shutdown */
+	static void StopHook(lua_State * a_LuaState, lua_Debug * a_Debug);
+
+	// cLuaAsyncJob override:
+	virtual int PushResults(lua_State * a_LuaState) override;
+} ;
+
+
+
+
+
+/** Loads a schematic file into a new cBlockArea in a worker thread.
+The callback receives the cBlockArea, owned by Lua, or nil if the file couldn't be loaded. */
+class cLuaAsyncSchematicJob :
+	public cLuaAsyncJob
+{
+	typedef cLuaAsyncJob super;
+
+public:
+	cLuaAsyncSchematicJob(cPluginLua & a_Plugin, lua_State * a_LuaState, const AString & a_FileName);
+	virtual ~cLuaAsyncSchematicJob();
+
+	// cWorkerPool::cJob override:
+	virtual void Execute(void) override;
+
+protected:
+	AString m_FileName;
+	std::unique_ptr<cBlockArea> m_Area;
+
+	// cLuaAsyncJob override:
+	virtual int PushResults(lua_State * a_LuaState) override;
+} ;
+
+
+
+
@@ -12,6 +12,7 @@
 #include "PluginManager.h"
 #include "LuaWindow.h"
 #include "LuaChunkStay.h"
+#include "LuaAsyncJobs.h"
 #include "../Root.h"
 #include "../World.h"
 #include "../Entities/Player.h"
@@ -1269,14 +1270,18 @@ class cLuaWorldTask :
 	public cPluginLua::cResettable
 {
 public:
-	cLuaWorldTask(cPluginLua & a_Plugin, int a_FnRef) :
+	cLuaWorldTask(cPluginLua & a_Plugin, int a_FnRef, const AString & a_Name) :
 		cPluginLua::cResettable(a_Plugin),
-		m_FnRef(a_FnRef)
+		m_FnRef(a_FnRef),
+		m_Name(a_Name)
 	{
 	}
 
 protected:
 	int m_FnRef;
+
+	/** The name of the task's function, for the plugin's profiler */
+	AString m_Name;
 	
 	// cWorld::cTask overrides:
 	virtual void Run(cWorld & a_World) override
@@ -1284,7 +1289,9 @@ protected:
 		cCSLock Lock(m_CSPlugin);
 		if (m_Plugin != nullptr)
 		{
-			m_Plugin->Call(m_FnRef, &a_World);
+			cPluginLua::cOperation Op(*m_Plugin);
+			cPluginProfiler::cScope ProfilerScope(m_Plugin->GetProfiler(), cPluginProfiler::pcTask, m_Name);
+			Op().Call(m_FnRef, &a_World);
 		}
 	}
 } ;
@@ -1318,13 +1325,14 @@ static int tolua_cWorld_QueueTask(lua_State * tolua_S)
 	}
 
 	// Create a reference to the function:
+	AString FnName = cPluginProfiler::GetFunctionName(tolua_S, -1);
 	int FnRef = luaL_ref(tolua_S, LUA_REGISTRYINDEX);
 	if (FnRef == LUA_REFNIL)
 	{
 		return lua_do_error(tolua_S, "Error in function call '#funcname#': Could not get function reference of parameter #1");
 	}
 
-	auto task = std::make_shared<cLuaWorldTask>(*Plugin, FnRef);
+	auto task = std::make_shared<cLuaWorldTask>(*Plugin, FnRef, FnName);
 	Plugin->AddResettable(task);
 	self->QueueTask(task);
 	return 0;
@@ -1339,14 +1347,18 @@ class cLuaScheduledWorldTask :
 	public cPluginLua::cResettable
 {
 public:
-	cLuaScheduledWorldTask(cPluginLua & a_Plugin, int a_FnRef) :
+	cLuaScheduledWorldTask(cPluginLua & a_Plugin, int a_FnRef, const AString & a_Name) :
 		cPluginLua::cResettable(a_Plugin),
-		m_FnRef(a_FnRef)
+		m_FnRef(a_FnRef),
+		m_Name(a_Name)
 	{
 	}
 
 protected:
 	int m_FnRef;
+
+	/** The name of the task's function, for the plugin's profiler */
+	AString m_Name;
 	
 	// cWorld::cTask overrides:
 	virtual void Run(cWorld & a_World) override
@@ -1354,7 +1366,9 @@ protected:
 		cCSLock Lock(m_CSPlugin);
 		if (m_Plugin != nullptr)
 		{
-			m_Plugin->Call(m_FnRef, &a_World);
+			cPluginLua::cOperation Op(*m_Plugin);
+			cPluginProfiler::cScope ProfilerScope(m_Plugin->GetProfiler(), cPluginProfiler::pcTask, m_Name);
+			Op().Call(m_FnRef, &a_World);
 		}
 	}
 };
@@ -1393,6 +1407,7 @@ static int tolua_cWorld_ScheduleTask(lua_State * tolua_S)
 	}
 
 	// Create a reference to the function:
+	AString FnName = cPluginProfiler::GetFunctionName(tolua_S, -1);
 	int FnRef = luaL_ref(tolua_S, LUA_REGISTRYINDEX);
 	if (FnRef == LUA_REFNIL)
 	{
@@ -1401,7 +1416,7 @@ static int tolua_cWorld_ScheduleTask(lua_State * tolua_S)
 	
 	int DelayTicks = (int)tolua_tonumber(tolua_S, 2, 0);
 
-	auto task = std::make_shared<cLuaScheduledWorldTask>(*Plugin, FnRef);
+	auto task = std::make_shared<cLuaScheduledWorldTask>(*Plugin, FnRef, FnName);
 	Plugin->AddResettable(task);
 	World->ScheduleTask(DelayTicks, task);
 	return 0;
@@ -1411,6 +1426,123 @@ static int tolua_cWorld_ScheduleTask(lua_State * tolua_S)
 
 
 
+/** Reports the progress of a cWorld:QueueWriteBlockArea() call to the plugin's callback function */
+class cLuaBlockAreaWriterCallbacks :
+	public cBlockAreaWriter::cCallbacks,
+	public cPluginLua::cResettable
+{
+public:
+	cLuaBlockAreaWriterCallbacks(cPluginLua & a_Plugin, int a_FnRef, const AString & a_Name) :
+		cPluginLua::cResettable(a_Plugin),
+		m_FnRef(a_FnRef),
+		m_Name(a_Name)
+	{
+	}
+
+protected:
+	int m_FnRef;
+
+	/** The name of the callback function, for the plugin's profiler */
+	AString m_Name;
+
+	// cBlockAreaWriter::cCallbacks overrides:
+	virtual void OnProgress(int a_NumDone, int a_NumTotal, int a_NumSkipped) override
+	{
+		cCSLock Lock(m_CSPlugin);
+		if (m_Plugin == nullptr)
+		{
+			return;
+		}
+		cPluginLua::cOperation Op(*m_Plugin);
+		{
+			cPluginProfiler::cScope ProfilerScope(m_Plugin->GetProfiler(), cPluginProfiler::pcTask, m_Name);
+			Op().Call(m_FnRef, a_NumDone, a_NumTotal, a_NumSkipped);
+		}
+		if (a_NumDone >= a_NumTotal)
+		{
+			// The write has finished, there will be no more calls:
+			luaL_unref(Op(), LUA_REGISTRYINDEX, m_FnRef);
+			m_Plugin->RemoveResettable(this);
+		}
+	}
+} ;
+
+
+
+
+
+static int tolua_cWorld_QueueWriteBlockArea(lua_State * tolua_S)
+{
+	// Binding for cWorld::QueueBlockAreaWriter
+	// Params: cBlockArea, MinBlockX, MinBlockY, MinBlockZ, [ProgressCallback]
+
+	// Retrieve the cPlugin from the LuaState:
+	cPluginLua * Plugin = GetLuaPlugin(tolua_S);
+	if (Plugin == nullptr)
+	{
+		// An error message has been already printed in GetLuaPlugin()
+		return 0;
+	}
+
+	// Retrieve the args:
+	cLuaState L(tolua_S);
+	if (
+		!L.CheckParamUserType(1, "cWorld") ||
+		!L.CheckParamUserType(2, "cBlockArea") ||
+		!L.CheckParamNumber  (3, 5)
+	)
+	{
+		return 0;
+	}
+	cWorld * World = (cWorld *)tolua_tousertype(tolua_S, 1, nullptr);
+	if (World == nullptr)
+	{
+		return lua_do_error(tolua_S, "Error in function call '#funcname#': Not called on an object instance");
+	}
+	const cBlockArea * Area = (const cBlockArea *)tolua_tousertype(tolua_S, 2, nullptr);
+	if (Area == nullptr)
+	{
+		return lua_do_error(tolua_S, "Error in function call '#funcname#': Expected a cBlockArea for parameter #1");
+	}
+	if ((Area->GetDataTypes() & (cBlockArea::baTypes | cBlockArea::baMetas)) != (cBlockArea::baTypes | cBlockArea::baMetas))
+	{
+		return lua_do_error(tolua_S, "Error in function call '#funcname#': The cBlockArea must contain both block types and metas");
+	}
+	int MinBlockX = static_cast<int>(tolua_tonumber(tolua_S, 3, 0));
+	int MinBlockY = static_cast<int>(tolua_tonumber(tolua_S, 4, 0));
+	int MinBlockZ = static_cast<int>(tolua_tonumber(tolua_S, 5, 0));
+
+	// Create a reference to the optional callback:
+	cBlockAreaWriter::cCallbacksPtr Callbacks;
+	if (lua_isfunction(tolua_S, 6))
+	{
+		lua_settop(tolua_S, 6);
+		AString FnName = cPluginProfiler::GetFunctionName(tolua_S, -1);
+		int FnRef = luaL_ref(tolua_S, LUA_REGISTRYINDEX);
+		if (FnRef == LUA_REFNIL)
+		{
+			return lua_do_error(tolua_S, "Error in function call '#funcname#': Could not get function reference of parameter #5");
+		}
+		auto LuaCallbacks = std::make_shared<cLuaBlockAreaWriterCallbacks>(*Plugin, FnRef, FnName);
+		Plugin->AddResettable(LuaCallbacks);
+		Callbacks = LuaCallbacks;
+	}
+	else if (!lua_isnoneornil(tolua_S, 6))
+	{
+		return lua_do_error(tolua_S, "Error in function call '#funcname#': Expected a function for parameter #5");
+	}
+
+	// The writer works on a copy, the plugin is free to modify or destroy its area meanwhile:
+	cBlockArea * Copy = new cBlockArea;
+	Area->CopyTo(*Copy);
+	World->QueueBlockAreaWriter(new cBlockAreaWriter(Copy, MinBlockX, MinBlockY, MinBlockZ, Callbacks));
+	return 0;
+}
+
+
+
+
+
 static int tolua_cPluginManager_GetAllPlugins(lua_State * tolua_S)
 {
 	// API function no longer available:
@@ -3166,6 +3298,96 @@ static int tolua_cRoot_GetFurnaceRecipe(lua_State * tolua_S)
 
 
 
+static int tolua_cRoot_RunAsync(lua_State * tolua_S)
+{
+	// Function signature: cRoot:RunAsync(Code, Callback, ...)
+	// The Code runs in a separate Lua state in a worker thread, gets the rest of the params as "...";
+	// then the Callback is called in the tick thread with true and the Code's return values, or false and the error message
+
+	// Retrieve the cPlugin from the LuaState:
+	cPluginLua * Plugin = GetLuaPlugin(tolua_S);
+	if (Plugin == nullptr)
+	{
+		// An error message has been already printed in GetLuaPlugin()
+		return 0;
+	}
+
+	// Check the params:
+	cLuaState L(tolua_S);
+	if (
+		!L.CheckParamUserTable(1, "cRoot") ||
+		!L.CheckParamString   (2) ||
+		!L.CheckParamFunction (3)
+	)
+	{
+		return 0;
+	}
+	AString Code;
+	L.GetStackValue(2, Code);
+
+	// Copy the job's params, they can't be shared between Lua states:
+	cLuaPortableValues Params;
+	int Top = lua_gettop(tolua_S);
+	for (int i = 4; i <= Top; i++)
+	{
+		AString Error;
+		Params.push_back(cLuaPortableValue());
+		if (!Params.back().Read(tolua_S, i, Error))
+		{
+			return lua_do_error(tolua_S, "Error in function call '#funcname#': Cannot pass parameter #%d to the async job: %s", i - 1, Error.c_str());
+		}
+	}
+
+	// Queue the job, it takes the callback from the top of the stack:
+	lua_pushvalue(tolua_S, 3);
+	auto Job = std::make_shared<cLuaAsyncCodeJob>(*Plugin, tolua_S, Code, Params);
+	Plugin->AddResettable(Job);
+	cRoot::Get()->GetWorkerPool().QueueJob(Job);
+	return 0;
+}
+
+
+
+
+
+static int tolua_cRoot_LoadSchematicFileAsync(lua_State * tolua_S)
+{
+	// Function signature: cRoot:LoadSchematicFileAsync(FileName, Callback)
+	// The file is loaded in a worker thread, then the Callback is called in the tick thread with the loaded cBlockArea, or nil on failure
+
+	// Retrieve the cPlugin from the LuaState:
+	cPluginLua * Plugin = GetLuaPlugin(tolua_S);
+	if (Plugin == nullptr)
+	{
+		// An error message has been already printed in GetLuaPlugin()
+		return 0;
+	}
+
+	// Check the params:
+	cLuaState L(tolua_S);
+	if (
+		!L.CheckParamUserTable(1, "cRoot") ||
+		!L.CheckParamString   (2) ||
+		!L.CheckParamFunction (3) ||
+		!L.CheckParamEnd      (4)
+	)
+	{
+		return 0;
+	}
+	AString FileName;
+	L.GetStackValue(2, FileName);
+
+	// Queue the job, it takes the callback from the top of the stack:
+	auto Job = std::make_shared<cLuaAsyncSchematicJob>(*Plugin, tolua_S, FileName);
+	Plugin->AddResettable(Job);
+	cRoot::Get()->GetWorkerPool().QueueJob(Job);
+	return 0;
+}
+
+
+
+
+
 static int tolua_cHopperEntity_GetOutputBlockPos(lua_State * tolua_S)
 {
 	// function cHopperEntity::GetOutputBlockPos()
@@ -3844,6 +4066,8 @@ void ManualBindings::Bind(lua_State * tolua_S)
 			tolua_function(tolua_S, "ForEachPlayer",       tolua_ForEach<cRoot, cPlayer, &cRoot::ForEachPlayer>);
 			tolua_function(tolua_S, "ForEachWorld",        tolua_ForEach<cRoot, cWorld,  &cRoot::ForEachWorld>);
 			tolua_function(tolua_S, "GetFurnaceRecipe",    tolua_cRoot_GetFurnaceRecipe);
+			tolua_function(tolua_S, "LoadSchematicFileAsync", tolua_cRoot_LoadSchematicFileAsync);
+			tolua_function(tolua_S, "RunAsync",            tolua_cRoot_RunAsync);
 		tolua_endmodule(tolua_S);
 		
 		tolua_beginmodule(tolua_S, "cWorld");
@@ -3876,6 +4100,7 @@ void ManualBindings::Bind(lua_State * tolua_S)
 			tolua_function(tolua_S, "GetSignLines",              tolua_cWorld_GetSignLines);
 			tolua_function(tolua_S, "PrepareChunk",              tolua_cWorld_PrepareChunk);
 			tolua_function(tolua_S, "QueueTask",                 tolua_cWorld_QueueTask);
+			tolua_function(tolua_S, "QueueWriteBlockArea",       tolua_cWorld_QueueWriteBlockArea);
 			tolua_function(tolua_S, "ScheduleTask",              tolua_cWorld_ScheduleTask);
 			tolua_function(tolua_S, "SetSignLines",              tolua_cWorld_SetSignLines);
 			tolua_function(tolua_S, "TryGetHeight",              tolua_cWorld_TryGetHeight);
@@ -33,7 +33,8 @@ extern "C"
 
 cPluginLua::cPluginLua(const AString & a_PluginDirectory) :
 	cPlugin(a_PluginDirectory),
-	m_LuaState(Printf("plugin %s", a_PluginDirectory.c_str()))
+	m_LuaState(Printf("plugin %s", a_PluginDirectory.c_str())),
+	m_Profiler(m_LuaState)
 {
 }
 
@@ -59,7 +60,12 @@ void cPluginLua::Close(void)
 	if (!m_LuaState.IsValid())
 	{
 		ASSERT(m_Resettables.empty());
-		ASSERT(m_HookMap.empty());
+		#ifdef _DEBUG
+			for (size_t i = 0; i < ARRAYCOUNT(m_HookMap); i++)
+			{
+				ASSERT(m_HookMap[i].empty());
+			}
+		#endif  // _DEBUG
 		return;
 	}
 
@@ -81,14 +87,14 @@ void cPluginLua::Close(void)
 	}  // cCSUnlock (m_CriticalSection)
 
 	// Release all the references in the hook map:
-	for (cHookMap::iterator itrH = m_HookMap.begin(), endH = m_HookMap.end(); itrH != endH; ++itrH)
+	for (size_t i = 0; i < ARRAYCOUNT(m_HookMap); i++)
 	{
-		for (cLuaRefs::iterator itrR = itrH->second.begin(), endR = itrH->second.end(); itrR != endR; ++itrR)
+		for (cLuaRefs::iterator itrR = m_HookMap[i].begin(), endR = m_HookMap[i].end(); itrR != endR; ++itrR)
 		{
 			delete *itrR;
-		}  // for itrR - itrH->second[]
-	}  // for itrH - m_HookMap[]
-	m_HookMap.clear();
+		}  // for itrR - m_HookMap[i][]
+		m_HookMap[i].clear();
+	}  // for i - m_HookMap[]
 
 	// Close the Lua engine:
 	m_LuaState.Close();
@@ -236,6 +242,7 @@ void cPluginLua::Tick(float a_Dt)
 		return;
 	}
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_TICK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_TICK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), a_Dt);
@@ -255,6 +262,7 @@ bool cPluginLua::OnBlockSpread(cWorld & a_World, int a_BlockX, int a_BlockY, int
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_BLOCK_SPREAD];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_BLOCK_SPREAD);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_BlockX, a_BlockY, a_BlockZ, a_Source, cLuaState::Return, res);
@@ -279,6 +287,7 @@ bool cPluginLua::OnBlockToPickups(cWorld & a_World, cEntity * a_Digger, int a_Bl
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_BLOCK_TO_PICKUPS];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_BLOCK_TO_PICKUPS);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_Digger, a_BlockX, a_BlockY, a_BlockZ, a_BlockType, a_BlockMeta, &a_Pickups, cLuaState::Return, res);
@@ -303,6 +312,7 @@ bool cPluginLua::OnChat(cPlayer & a_Player, AString & a_Message)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CHAT];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CHAT);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_Message, cLuaState::Return, res, a_Message);
@@ -327,6 +337,7 @@ bool cPluginLua::OnChunkAvailable(cWorld & a_World, int a_ChunkX, int a_ChunkZ)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CHUNK_AVAILABLE];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CHUNK_AVAILABLE);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_ChunkX, a_ChunkZ, cLuaState::Return, res);
@@ -351,6 +362,7 @@ bool cPluginLua::OnChunkGenerated(cWorld & a_World, int a_ChunkX, int a_ChunkZ,
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CHUNK_GENERATED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CHUNK_GENERATED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_ChunkX, a_ChunkZ, a_ChunkDesc, cLuaState::Return, res);
@@ -375,6 +387,7 @@ bool cPluginLua::OnChunkGenerating(cWorld & a_World, int a_ChunkX, int a_ChunkZ,
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CHUNK_GENERATING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CHUNK_GENERATING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_ChunkX, a_ChunkZ, a_ChunkDesc, cLuaState::Return, res);
@@ -399,6 +412,7 @@ bool cPluginLua::OnChunkUnloaded(cWorld & a_World, int a_ChunkX, int a_ChunkZ)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CHUNK_UNLOADED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CHUNK_UNLOADED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_ChunkX, a_ChunkZ, cLuaState::Return, res);
@@ -423,6 +437,7 @@ bool cPluginLua::OnChunkUnloading(cWorld & a_World, int a_ChunkX, int a_ChunkZ)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CHUNK_UNLOADING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CHUNK_UNLOADING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_ChunkX, a_ChunkZ, cLuaState::Return, res);
@@ -447,6 +462,7 @@ bool cPluginLua::OnCollectingPickup(cPlayer & a_Player, cPickup & a_Pickup)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_COLLECTING_PICKUP];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_COLLECTING_PICKUP);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, &a_Pickup, cLuaState::Return, res);
@@ -471,6 +487,7 @@ bool cPluginLua::OnCraftingNoRecipe(cPlayer & a_Player, cCraftingGrid & a_Grid,
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_CRAFTING_NO_RECIPE];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_CRAFTING_NO_RECIPE);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, &a_Grid, &a_Recipe, cLuaState::Return, res);
@@ -495,6 +512,7 @@ bool cPluginLua::OnDisconnect(cClientHandle & a_Client, const AString & a_Reason
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_DISCONNECT];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_DISCONNECT);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Client, a_Reason, cLuaState::Return, res);
@@ -519,6 +537,7 @@ bool cPluginLua::OnEntityAddEffect(cEntity & a_Entity, int a_EffectType, int a_E
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_ENTITY_ADD_EFFECT];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_ENTITY_ADD_EFFECT);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Entity, a_EffectType, a_EffectDurationTicks, a_EffectIntensity, a_DistanceModifier, cLuaState::Return, res);
@@ -543,6 +562,7 @@ bool cPluginLua::OnExecuteCommand(cPlayer * a_Player, const AStringVector & a_Sp
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_EXECUTE_COMMAND];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_EXECUTE_COMMAND);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), a_Player, a_Split, cLuaState::Return, res);
@@ -567,6 +587,7 @@ bool cPluginLua::OnExploded(cWorld & a_World, double a_ExplosionSize, bool a_Can
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_EXPLODED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_EXPLODED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		switch (a_Source)
@@ -608,6 +629,7 @@ bool cPluginLua::OnExploding(cWorld & a_World, double & a_ExplosionSize, bool &
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_EXPLODING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_EXPLODING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		switch (a_Source)
@@ -649,6 +671,7 @@ bool cPluginLua::OnHandshake(cClientHandle & a_Client, const AString & a_Usernam
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_HANDSHAKE];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_HANDSHAKE);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Client, a_Username, cLuaState::Return, res);
@@ -673,6 +696,7 @@ bool cPluginLua::OnHopperPullingItem(cWorld & a_World, cHopperEntity & a_Hopper,
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_HOPPER_PULLING_ITEM];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_HOPPER_PULLING_ITEM);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, &a_Hopper, a_DstSlotNum, &a_SrcEntity, a_SrcSlotNum, cLuaState::Return, res);
@@ -697,6 +721,7 @@ bool cPluginLua::OnHopperPushingItem(cWorld & a_World, cHopperEntity & a_Hopper,
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_HOPPER_PUSHING_ITEM];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_HOPPER_PUSHING_ITEM);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, &a_Hopper, a_SrcSlotNum, &a_DstEntity, a_DstSlotNum, cLuaState::Return, res);
@@ -721,6 +746,7 @@ bool cPluginLua::OnKilling(cEntity & a_Victim, cEntity * a_Killer, TakeDamageInf
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_KILLING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_KILLING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Victim, a_Killer, &a_TDI, cLuaState::Return, res);
@@ -745,6 +771,7 @@ bool cPluginLua::OnLogin(cClientHandle & a_Client, int a_ProtocolVersion, const
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_LOGIN];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_LOGIN);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Client, a_ProtocolVersion, a_Username, cLuaState::Return, res);
@@ -769,6 +796,7 @@ bool cPluginLua::OnPlayerAnimation(cPlayer & a_Player, int a_Animation)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_ANIMATION];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_ANIMATION);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_Animation, cLuaState::Return, res);
@@ -793,6 +821,7 @@ bool cPluginLua::OnPlayerBreakingBlock(cPlayer & a_Player, int a_BlockX, int a_B
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_BREAKING_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_BREAKING_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_BlockType, a_BlockMeta, cLuaState::Return, res);
@@ -817,6 +846,7 @@ bool cPluginLua::OnPlayerBrokenBlock(cPlayer & a_Player, int a_BlockX, int a_Blo
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_BROKEN_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_BROKEN_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_BlockType, a_BlockMeta, cLuaState::Return, res);
@@ -841,6 +871,7 @@ bool cPluginLua::OnPlayerDestroyed(cPlayer & a_Player)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_DESTROYED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_DESTROYED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, cLuaState::Return, res);
@@ -865,6 +896,7 @@ bool cPluginLua::OnPlayerEating(cPlayer & a_Player)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_EATING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_EATING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, cLuaState::Return, res);
@@ -889,6 +921,7 @@ bool cPluginLua::OnPlayerFoodLevelChange(cPlayer & a_Player, int a_NewFoodLevel)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_FOOD_LEVEL_CHANGE];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_FOOD_LEVEL_CHANGE);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_NewFoodLevel, cLuaState::Return, res);
@@ -913,6 +946,7 @@ bool cPluginLua::OnPlayerFished(cPlayer & a_Player, const cItems & a_Reward)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_FISHED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_FISHED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_Reward, cLuaState::Return, res);
@@ -937,6 +971,7 @@ bool cPluginLua::OnPlayerFishing(cPlayer & a_Player, cItems & a_Reward)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_FISHING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_FISHING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, &a_Reward, cLuaState::Return, res);
@@ -961,6 +996,7 @@ bool cPluginLua::OnPlayerJoined(cPlayer & a_Player)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_JOINED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_JOINED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, cLuaState::Return, res);
@@ -985,6 +1021,7 @@ bool cPluginLua::OnPlayerLeftClick(cPlayer & a_Player, int a_BlockX, int a_Block
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_LEFT_CLICK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_LEFT_CLICK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_Status, cLuaState::Return, res);
@@ -1009,6 +1046,7 @@ bool cPluginLua::OnPlayerMoving(cPlayer & a_Player, const Vector3d & a_OldPositi
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_MOVING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_MOVING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_OldPosition, a_NewPosition, cLuaState::Return, res);
@@ -1033,6 +1071,7 @@ bool cPluginLua::OnEntityTeleport(cEntity & a_Entity, const Vector3d & a_OldPosi
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_ENTITY_TELEPORT];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_ENTITY_TELEPORT);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Entity, a_OldPosition, a_NewPosition, cLuaState::Return, res);
@@ -1057,6 +1096,7 @@ bool cPluginLua::OnPlayerPlacedBlock(cPlayer & a_Player, const sSetBlock & a_Blo
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_PLACED_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_PLACED_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player,
@@ -1086,6 +1126,7 @@ bool cPluginLua::OnPlayerPlacingBlock(cPlayer & a_Player, const sSetBlock & a_Bl
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_PLACING_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_PLACING_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player,
@@ -1115,6 +1156,7 @@ bool cPluginLua::OnPlayerRightClick(cPlayer & a_Player, int a_BlockX, int a_Bloc
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_RIGHT_CLICK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_RIGHT_CLICK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, cLuaState::Return, res);
@@ -1139,6 +1181,7 @@ bool cPluginLua::OnPlayerRightClickingEntity(cPlayer & a_Player, cEntity & a_Ent
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_RIGHT_CLICKING_ENTITY];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_RIGHT_CLICKING_ENTITY);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, &a_Entity, cLuaState::Return, res);
@@ -1163,6 +1206,7 @@ bool cPluginLua::OnPlayerShooting(cPlayer & a_Player)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_SHOOTING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_SHOOTING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, cLuaState::Return, res);
@@ -1187,6 +1231,7 @@ bool cPluginLua::OnPlayerSpawned(cPlayer & a_Player)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_SPAWNED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_SPAWNED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, cLuaState::Return, res);
@@ -1211,6 +1256,7 @@ bool cPluginLua::OnPlayerTossingItem(cPlayer & a_Player)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_TOSSING_ITEM];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_TOSSING_ITEM);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, cLuaState::Return, res);
@@ -1235,6 +1281,7 @@ bool cPluginLua::OnPlayerUsedBlock(cPlayer & a_Player, int a_BlockX, int a_Block
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_USED_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_USED_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, a_BlockType, a_BlockMeta, cLuaState::Return, res);
@@ -1259,6 +1306,7 @@ bool cPluginLua::OnPlayerUsedItem(cPlayer & a_Player, int a_BlockX, int a_BlockY
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_USED_ITEM];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_USED_ITEM);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, cLuaState::Return, res);
@@ -1283,6 +1331,7 @@ bool cPluginLua::OnPlayerUsingBlock(cPlayer & a_Player, int a_BlockX, int a_Bloc
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_USING_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_USING_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, a_BlockType, a_BlockMeta, cLuaState::Return, res);
@@ -1307,6 +1356,7 @@ bool cPluginLua::OnPlayerUsingItem(cPlayer & a_Player, int a_BlockX, int a_Block
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLAYER_USING_ITEM];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLAYER_USING_ITEM);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, cLuaState::Return, res);
@@ -1331,6 +1381,7 @@ bool cPluginLua::OnPluginMessage(cClientHandle & a_Client, const AString & a_Cha
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLUGIN_MESSAGE];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLUGIN_MESSAGE);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Client, a_Channel, a_Message, cLuaState::Return, res);
@@ -1355,6 +1406,7 @@ bool cPluginLua::OnPluginsLoaded(void)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PLUGINS_LOADED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PLUGINS_LOADED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		bool ret = false;
@@ -1377,6 +1429,7 @@ bool cPluginLua::OnPostCrafting(cPlayer & a_Player, cCraftingGrid & a_Grid, cCra
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_POST_CRAFTING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_POST_CRAFTING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, &a_Grid, &a_Recipe, cLuaState::Return, res);
@@ -1401,6 +1454,7 @@ bool cPluginLua::OnPreCrafting(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraf
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PRE_CRAFTING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PRE_CRAFTING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Player, &a_Grid, &a_Recipe, cLuaState::Return, res);
@@ -1425,6 +1479,7 @@ bool cPluginLua::OnProjectileHitBlock(cProjectileEntity & a_Projectile, int a_Bl
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PROJECTILE_HIT_BLOCK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PROJECTILE_HIT_BLOCK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Projectile, a_BlockX, a_BlockY, a_BlockZ, a_Face, a_BlockHitPos, cLuaState::Return, res);
@@ -1449,6 +1504,7 @@ bool cPluginLua::OnProjectileHitEntity(cProjectileEntity & a_Projectile, cEntity
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_PROJECTILE_HIT_ENTITY];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_PROJECTILE_HIT_ENTITY);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Projectile, &a_HitEntity, cLuaState::Return, res);
@@ -1473,6 +1529,7 @@ bool cPluginLua::OnServerPing(cClientHandle & a_ClientHandle, AString & a_Server
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_SERVER_PING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_SERVER_PING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_ClientHandle, a_ServerDescription, a_OnlinePlayersCount, a_MaxPlayersCount, a_Favicon, cLuaState::Return, res, a_ServerDescription, a_OnlinePlayersCount, a_MaxPlayersCount, a_Favicon);
@@ -1497,6 +1554,7 @@ bool cPluginLua::OnSpawnedEntity(cWorld & a_World, cEntity & a_Entity)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_SPAWNED_ENTITY];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_SPAWNED_ENTITY);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, &a_Entity, cLuaState::Return, res);
@@ -1521,6 +1579,7 @@ bool cPluginLua::OnSpawnedMonster(cWorld & a_World, cMonster & a_Monster)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_SPAWNED_MONSTER];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_SPAWNED_MONSTER);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, &a_Monster, cLuaState::Return, res);
@@ -1545,6 +1604,7 @@ bool cPluginLua::OnSpawningEntity(cWorld & a_World, cEntity & a_Entity)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_SPAWNING_ENTITY];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_SPAWNING_ENTITY);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, &a_Entity, cLuaState::Return, res);
@@ -1569,6 +1629,7 @@ bool cPluginLua::OnSpawningMonster(cWorld & a_World, cMonster & a_Monster)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_SPAWNING_MONSTER];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_SPAWNING_MONSTER);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, &a_Monster, cLuaState::Return, res);
@@ -1593,6 +1654,7 @@ bool cPluginLua::OnTakeDamage(cEntity & a_Receiver, TakeDamageInfo & a_TDI)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_TAKE_DAMAGE];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_TAKE_DAMAGE);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_Receiver, &a_TDI, cLuaState::Return, res);
@@ -1622,6 +1684,7 @@ bool cPluginLua::OnUpdatedSign(
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_UPDATED_SIGN];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_UPDATED_SIGN);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_BlockX, a_BlockY, a_BlockZ, a_Line1, a_Line2, a_Line3, a_Line4, a_Player, cLuaState::Return, res);
@@ -1651,6 +1714,7 @@ bool cPluginLua::OnUpdatingSign(
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_UPDATING_SIGN];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_UPDATING_SIGN);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_BlockX, a_BlockY, a_BlockZ, a_Line1, a_Line2, a_Line3, a_Line4, a_Player, cLuaState::Return, res, a_Line1, a_Line2, a_Line3, a_Line4);
@@ -1675,6 +1739,7 @@ bool cPluginLua::OnWeatherChanged(cWorld & a_World)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_WEATHER_CHANGED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_WEATHER_CHANGED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, cLuaState::Return, res);
@@ -1699,6 +1764,7 @@ bool cPluginLua::OnWeatherChanging(cWorld & a_World, eWeather & a_NewWeather)
 	}
 	bool res = false;
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_WEATHER_CHANGING];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_WEATHER_CHANGING);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_NewWeather, cLuaState::Return, res, a_NewWeather);
@@ -1722,6 +1788,7 @@ bool cPluginLua::OnWorldStarted(cWorld & a_World)
 		return false;
 	}
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_WORLD_STARTED];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_WORLD_STARTED);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World);
@@ -1741,6 +1808,7 @@ bool cPluginLua::OnWorldTick(cWorld & a_World, std::chrono::milliseconds a_Dt, s
 		return false;
 	}
 	cLuaRefs & Refs = m_HookMap[cPluginManager::HOOK_WORLD_TICK];
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginManager::HOOK_WORLD_TICK);
 	for (cLuaRefs::iterator itr = Refs.begin(), end = Refs.end(); itr != end; ++itr)
 	{
 		m_LuaState.Call((int)(**itr), &a_World, a_Dt, a_LastTickDurationMSec);
@@ -1763,6 +1831,7 @@ bool cPluginLua::HandleCommand(const AStringVector & a_Split, cPlayer & a_Player
 	}
 	
 	cCSLock Lock(m_CriticalSection);
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginProfiler::pcCommand, cmd->first);
 	bool res = false;
 	m_LuaState.Call(cmd->second, a_Split, &a_Player, a_FullCommand, cLuaState::Return, res);
 	return res;
@@ -1785,6 +1854,7 @@ bool cPluginLua::HandleConsoleCommand(const AStringVector & a_Split, cCommandOut
 	}
 	
 	cCSLock Lock(m_CriticalSection);
+	cPluginProfiler::cScope ProfilerScope(m_Profiler, cPluginProfiler::pcConsoleCommand, cmd->first);
 	bool res = false;
 	AString str;
 	m_LuaState.Call(cmd->second, a_Split, a_FullCommand, cLuaState::Return, res, str);
@@ -1942,6 +2012,7 @@ const char * cPluginLua::GetHookFnName(int a_HookType)
 bool cPluginLua::AddHookRef(int a_HookType, int a_FnRefIdx)
 {
 	ASSERT(m_CriticalSection.IsLockedByCurrentThread());  // It probably has to be, how else would we have a LuaState?
+	ASSERT(cPluginManager::IsValidHookType(a_HookType));  // Checked by the callers
 	
 	// Check if the function reference is valid:
 	cLuaState::cRef * Ref = new cLuaState::cRef(m_LuaState, a_FnRefIdx);
@@ -2006,6 +2077,23 @@ void cPluginLua::AddResettable(cPluginLua::cResettablePtr a_Resettable)
 
 
 
+void cPluginLua::RemoveResettable(cResettable * a_Resettable)
+{
+	cCSLock Lock(m_CriticalSection);
+	for (cResettablePtrs::iterator itr = m_Resettables.begin(), end = m_Resettables.end(); itr != end; ++itr)
+	{
+		if (itr->get() == a_Resettable)
+		{
+			m_Resettables.erase(itr);
+			return;
+		}
+	}
+}
+
+
+
+
+
 AString cPluginLua::HandleWebRequest(const HTTPRequest & a_Request)
 {
 	// Find the tab to use for the request:
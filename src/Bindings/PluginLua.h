@@ -12,6 +12,7 @@
 #include "Plugin.h"
 #include "WebPlugin.h"
 #include "LuaState.h"
+#include "PluginProfiler.h"
 
 // Names for the global variables through which the plugin is identified in its LuaState
 #define LUA_PLUGIN_NAME_VAR_NAME     "_MCServerInternal_PluginName"
@@ -230,9 +231,15 @@ public:
 		return m_LuaState.Call(a_Fn, a_Args...);
 	}
 
+	/** Returns the profiler measuring the time spent in the plugin's handlers. */
+	cPluginProfiler & GetProfiler(void) { return m_Profiler; }
+
 	/** Adds the specified cResettable instance to m_Resettables, so that it is notified when the plugin is being closed. */
 	void AddResettable(cResettablePtr a_Resettable);
 
+	/** Removes the specified cResettable instance from m_Resettables, once it no longer needs the notification. */
+	void RemoveResettable(cResettable * a_Resettable);
+
 protected:
 	/** Maps command name into Lua function reference */
 	typedef std::map<AString, int> CommandMap;
@@ -240,15 +247,15 @@ protected:
 	/** Provides an array of Lua function references */
 	typedef std::vector<cLuaState::cRef *> cLuaRefs;
 	
-	/** Maps hook types into arrays of Lua function references to call for each hook type */
-	typedef std::map<int, cLuaRefs> cHookMap;
-	
 
 	/** The mutex protecting m_LuaState and each of the m_Resettables[] against multithreaded use. */
 	cCriticalSection m_CriticalSection;
 
 	/** The plugin's Lua state. */
 	cLuaState m_LuaState;
+
+	/** Measures the time spent in the plugin's hook handlers, commands and tasks. */
+	cPluginProfiler m_Profiler;
 	
 	/** Objects that need notification when the plugin is about to be unloaded. */
 	cResettablePtrs m_Resettables;
@@ -259,8 +266,8 @@ protected:
 	/** Console commands that the plugin has registered. */
 	CommandMap m_ConsoleCommands;
 	
-	/** Hooks that the plugin has registered. */
-	cHookMap m_HookMap;
+	/** Hooks that the plugin has registered, the Lua function references to call, indexed by the hook type. */
+	cLuaRefs m_HookMap[cPluginManager::HOOK_NUM_HOOKS];
 	
 
 	/** Releases all Lua references, notifies and removes all m_Resettables[] and closes the m_LuaState. */
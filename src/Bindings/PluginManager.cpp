@@ -12,12 +12,20 @@
 #include "../IniFile.h"
 #include "../Entities/Player.h"
 
-#define FIND_HOOK(a_HookName) HookMap::iterator Plugins = m_Hooks.find(a_HookName);
-#define VERIFY_HOOK \
-	if (Plugins == m_Hooks.end()) \
+/** Bails out of the CallHook function if no plugin handles the hook; otherwise gets the hook's plugin list
+into Plugins, and times the rest of the function into the hook's stats. */
+#define FIND_HOOK(a_HookName) \
+	if (!HasHookSubscribers(a_HookName)) \
 	{ \
 		return false; \
-	}
+	} \
+	cHookTimer HookTimer(m_HookStats[a_HookName]); \
+	PluginList * Plugins = &m_Hooks[a_HookName];
+
+
+
+// The subscriber bitmap has a single bit per hook:
+static_assert(cPluginManager::HOOK_NUM_HOOKS <= 64, "cPluginManager::m_HookSubscribers needs more bits");
 
 
 
@@ -33,8 +41,14 @@ cPluginManager * cPluginManager::Get(void)
 
 
 cPluginManager::cPluginManager(void) :
+	m_HookSubscribers(0),
 	m_bReloadPlugins(false)
 {
+	for (size_t i = 0; i < ARRAYCOUNT(m_HookStats); i++)
+	{
+		m_HookStats[i].m_NumCalls = 0;
+		m_HookStats[i].m_NanoSec = 0;
+	}
 }
 
 
@@ -213,10 +227,11 @@ void cPluginManager::Tick(float a_Dt)
 		ReloadPluginsNow();
 	}
 
-	FIND_HOOK(HOOK_TICK);
-	if (Plugins != m_Hooks.end())
+	if (HasHookSubscribers(HOOK_TICK))
 	{
-		for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+		cHookTimer HookTimer(m_HookStats[HOOK_TICK]);
+		PluginList & Plugins = m_Hooks[HOOK_TICK];
+		for (PluginList::iterator itr = Plugins.begin(); itr != Plugins.end(); ++itr)
 		{
 			(*itr)->Tick(a_Dt);
 		}
@@ -230,9 +245,8 @@ void cPluginManager::Tick(float a_Dt)
 bool cPluginManager::CallHookBlockSpread(cWorld & a_World, int a_BlockX, int a_BlockY, int a_BlockZ, eSpreadSource a_Source)
 {
 	FIND_HOOK(HOOK_BLOCK_SPREAD);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnBlockSpread(a_World, a_BlockX, a_BlockY, a_BlockZ, a_Source))
 		{
@@ -253,9 +267,8 @@ bool cPluginManager::CallHookBlockToPickups(
 )
 {
 	FIND_HOOK(HOOK_BLOCK_TO_PICKUPS);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnBlockToPickups(a_World, a_Digger, a_BlockX, a_BlockY, a_BlockZ, a_BlockType, a_BlockMeta, a_Pickups))
 		{
@@ -319,9 +332,8 @@ bool cPluginManager::CallHookChat(cPlayer & a_Player, AString & a_Message)
 	}
 
 	FIND_HOOK(HOOK_CHAT);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnChat(a_Player, a_Message))
 		{
@@ -339,9 +351,8 @@ bool cPluginManager::CallHookChat(cPlayer & a_Player, AString & a_Message)
 bool cPluginManager::CallHookChunkAvailable(cWorld & a_World, int a_ChunkX, int a_ChunkZ)
 {
 	FIND_HOOK(HOOK_CHUNK_AVAILABLE);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnChunkAvailable(a_World, a_ChunkX, a_ChunkZ))
 		{
@@ -358,9 +369,8 @@ bool cPluginManager::CallHookChunkAvailable(cWorld & a_World, int a_ChunkX, int
 bool cPluginManager::CallHookChunkGenerated(cWorld & a_World, int a_ChunkX, int a_ChunkZ, cChunkDesc * a_ChunkDesc)
 {
 	FIND_HOOK(HOOK_CHUNK_GENERATED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnChunkGenerated(a_World, a_ChunkX, a_ChunkZ, a_ChunkDesc))
 		{
@@ -377,9 +387,8 @@ bool cPluginManager::CallHookChunkGenerated(cWorld & a_World, int a_ChunkX, int
 bool cPluginManager::CallHookChunkGenerating(cWorld & a_World, int a_ChunkX, int a_ChunkZ, cChunkDesc * a_ChunkDesc)
 {
 	FIND_HOOK(HOOK_CHUNK_GENERATING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnChunkGenerating(a_World, a_ChunkX, a_ChunkZ, a_ChunkDesc))
 		{
@@ -396,9 +405,8 @@ bool cPluginManager::CallHookChunkGenerating(cWorld & a_World, int a_ChunkX, int
 bool cPluginManager::CallHookChunkUnloaded(cWorld & a_World, int a_ChunkX, int a_ChunkZ)
 {
 	FIND_HOOK(HOOK_CHUNK_UNLOADED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnChunkUnloaded(a_World, a_ChunkX, a_ChunkZ))
 		{
@@ -415,9 +423,8 @@ bool cPluginManager::CallHookChunkUnloaded(cWorld & a_World, int a_ChunkX, int a
 bool cPluginManager::CallHookChunkUnloading(cWorld & a_World, int a_ChunkX, int a_ChunkZ)
 {
 	FIND_HOOK(HOOK_CHUNK_UNLOADING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnChunkUnloading(a_World, a_ChunkX, a_ChunkZ))
 		{
@@ -434,9 +441,8 @@ bool cPluginManager::CallHookChunkUnloading(cWorld & a_World, int a_ChunkX, int
 bool cPluginManager::CallHookCollectingPickup(cPlayer & a_Player, cPickup & a_Pickup)
 {
 	FIND_HOOK(HOOK_COLLECTING_PICKUP);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnCollectingPickup(a_Player, a_Pickup))
 		{
@@ -453,9 +459,8 @@ bool cPluginManager::CallHookCollectingPickup(cPlayer & a_Player, cPickup & a_Pi
 bool cPluginManager::CallHookCraftingNoRecipe(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraftingRecipe & a_Recipe)
 {
 	FIND_HOOK(HOOK_CRAFTING_NO_RECIPE);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnCraftingNoRecipe(a_Player, a_Grid, a_Recipe))
 		{
@@ -472,9 +477,8 @@ bool cPluginManager::CallHookCraftingNoRecipe(cPlayer & a_Player, cCraftingGrid
 bool cPluginManager::CallHookDisconnect(cClientHandle & a_Client, const AString & a_Reason)
 {
 	FIND_HOOK(HOOK_DISCONNECT);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnDisconnect(a_Client, a_Reason))
 		{
@@ -491,9 +495,8 @@ bool cPluginManager::CallHookDisconnect(cClientHandle & a_Client, const AString
 bool cPluginManager::CallHookEntityAddEffect(cEntity & a_Entity, int a_EffectType, int a_EffectDurationTicks, int a_EffectIntensity, double a_DistanceModifier)
 {
 	FIND_HOOK(HOOK_ENTITY_ADD_EFFECT);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnEntityAddEffect(a_Entity, a_EffectType, a_EffectDurationTicks, a_EffectIntensity, a_DistanceModifier))
 		{
@@ -510,9 +513,8 @@ bool cPluginManager::CallHookEntityAddEffect(cEntity & a_Entity, int a_EffectTyp
 bool cPluginManager::CallHookEntityTeleport(cEntity & a_Entity, const Vector3d & a_OldPosition, const Vector3d & a_NewPosition)
 {
 	FIND_HOOK(HOOK_ENTITY_TELEPORT);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnEntityTeleport(a_Entity, a_OldPosition, a_NewPosition))
 		{
@@ -528,9 +530,8 @@ bool cPluginManager::CallHookEntityTeleport(cEntity & a_Entity, const Vector3d &
 bool cPluginManager::CallHookExecuteCommand(cPlayer * a_Player, const AStringVector & a_Split)
 {
 	FIND_HOOK(HOOK_EXECUTE_COMMAND);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnExecuteCommand(a_Player, a_Split))
 		{
@@ -547,9 +548,8 @@ bool cPluginManager::CallHookExecuteCommand(cPlayer * a_Player, const AStringVec
 bool cPluginManager::CallHookExploded(cWorld & a_World, double a_ExplosionSize, bool a_CanCauseFire, double a_X, double a_Y, double a_Z, eExplosionSource a_Source, void * a_SourceData)
 {
 	FIND_HOOK(HOOK_EXPLODED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnExploded(a_World, a_ExplosionSize, a_CanCauseFire, a_X, a_Y, a_Z, a_Source, a_SourceData))
 		{
@@ -566,9 +566,8 @@ bool cPluginManager::CallHookExploded(cWorld & a_World, double a_ExplosionSize,
 bool cPluginManager::CallHookExploding(cWorld & a_World, double & a_ExplosionSize, bool & a_CanCauseFire, double a_X, double a_Y, double a_Z, eExplosionSource a_Source, void * a_SourceData)
 {
 	FIND_HOOK(HOOK_EXPLODING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnExploding(a_World, a_ExplosionSize, a_CanCauseFire, a_X, a_Y, a_Z, a_Source, a_SourceData))
 		{
@@ -585,9 +584,8 @@ bool cPluginManager::CallHookExploding(cWorld & a_World, double & a_ExplosionSiz
 bool cPluginManager::CallHookHandshake(cClientHandle & a_ClientHandle, const AString & a_Username)
 {
 	FIND_HOOK(HOOK_HANDSHAKE);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnHandshake(a_ClientHandle, a_Username))
 		{
@@ -604,9 +602,8 @@ bool cPluginManager::CallHookHandshake(cClientHandle & a_ClientHandle, const ASt
 bool cPluginManager::CallHookHopperPullingItem(cWorld & a_World, cHopperEntity & a_Hopper, int a_DstSlotNum, cBlockEntityWithItems & a_SrcEntity, int a_SrcSlotNum)
 {
 	FIND_HOOK(HOOK_HOPPER_PULLING_ITEM);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnHopperPullingItem(a_World, a_Hopper, a_DstSlotNum, a_SrcEntity, a_SrcSlotNum))
 		{
@@ -623,9 +620,8 @@ bool cPluginManager::CallHookHopperPullingItem(cWorld & a_World, cHopperEntity &
 bool cPluginManager::CallHookHopperPushingItem(cWorld & a_World, cHopperEntity & a_Hopper, int a_SrcSlotNum, cBlockEntityWithItems & a_DstEntity, int a_DstSlotNum)
 {
 	FIND_HOOK(HOOK_HOPPER_PUSHING_ITEM);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnHopperPushingItem(a_World, a_Hopper, a_SrcSlotNum, a_DstEntity, a_DstSlotNum))
 		{
@@ -642,9 +638,8 @@ bool cPluginManager::CallHookHopperPushingItem(cWorld & a_World, cHopperEntity &
 bool cPluginManager::CallHookKilling(cEntity & a_Victim, cEntity * a_Killer, TakeDamageInfo & a_TDI)
 {
 	FIND_HOOK(HOOK_KILLING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnKilling(a_Victim, a_Killer, a_TDI))
 		{
@@ -661,9 +656,8 @@ bool cPluginManager::CallHookKilling(cEntity & a_Victim, cEntity * a_Killer, Tak
 bool cPluginManager::CallHookLogin(cClientHandle & a_Client, int a_ProtocolVersion, const AString & a_Username)
 {
 	FIND_HOOK(HOOK_LOGIN);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnLogin(a_Client, a_ProtocolVersion, a_Username))
 		{
@@ -680,9 +674,8 @@ bool cPluginManager::CallHookLogin(cClientHandle & a_Client, int a_ProtocolVersi
 bool cPluginManager::CallHookPlayerAnimation(cPlayer & a_Player, int a_Animation)
 {
 	FIND_HOOK(HOOK_PLAYER_ANIMATION);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerAnimation(a_Player, a_Animation))
 		{
@@ -699,9 +692,8 @@ bool cPluginManager::CallHookPlayerAnimation(cPlayer & a_Player, int a_Animation
 bool cPluginManager::CallHookPlayerBreakingBlock(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
 {
 	FIND_HOOK(HOOK_PLAYER_BREAKING_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerBreakingBlock(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_BlockType, a_BlockMeta))
 		{
@@ -718,9 +710,8 @@ bool cPluginManager::CallHookPlayerBreakingBlock(cPlayer & a_Player, int a_Block
 bool cPluginManager::CallHookPlayerBrokenBlock(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
 {
 	FIND_HOOK(HOOK_PLAYER_BROKEN_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerBrokenBlock(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_BlockType, a_BlockMeta))
 		{
@@ -737,9 +728,8 @@ bool cPluginManager::CallHookPlayerBrokenBlock(cPlayer & a_Player, int a_BlockX,
 bool cPluginManager::CallHookPlayerDestroyed(cPlayer & a_Player)
 {
 	FIND_HOOK(HOOK_PLAYER_DESTROYED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerDestroyed(a_Player))
 		{
@@ -756,9 +746,8 @@ bool cPluginManager::CallHookPlayerDestroyed(cPlayer & a_Player)
 bool cPluginManager::CallHookPlayerEating(cPlayer & a_Player)
 {
 	FIND_HOOK(HOOK_PLAYER_EATING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerEating(a_Player))
 		{
@@ -775,9 +764,8 @@ bool cPluginManager::CallHookPlayerEating(cPlayer & a_Player)
 bool cPluginManager::CallHookPlayerFoodLevelChange(cPlayer & a_Player, int a_NewFoodLevel)
 {
 	FIND_HOOK(HOOK_PLAYER_FOOD_LEVEL_CHANGE);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerFoodLevelChange(a_Player, a_NewFoodLevel))
 		{
@@ -794,9 +782,8 @@ bool cPluginManager::CallHookPlayerFoodLevelChange(cPlayer & a_Player, int a_New
 bool cPluginManager::CallHookPlayerFished(cPlayer & a_Player, const cItems & a_Reward)
 {
 	FIND_HOOK(HOOK_PLAYER_FISHED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerFished(a_Player, a_Reward))
 		{
@@ -813,9 +800,8 @@ bool cPluginManager::CallHookPlayerFished(cPlayer & a_Player, const cItems & a_R
 bool cPluginManager::CallHookPlayerFishing(cPlayer & a_Player, cItems a_Reward)
 {
 	FIND_HOOK(HOOK_PLAYER_FISHING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerFishing(a_Player, a_Reward))
 		{
@@ -832,9 +818,8 @@ bool cPluginManager::CallHookPlayerFishing(cPlayer & a_Player, cItems a_Reward)
 bool cPluginManager::CallHookPlayerJoined(cPlayer & a_Player)
 {
 	FIND_HOOK(HOOK_PLAYER_JOINED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerJoined(a_Player))
 		{
@@ -851,9 +836,8 @@ bool cPluginManager::CallHookPlayerJoined(cPlayer & a_Player)
 bool cPluginManager::CallHookPlayerLeftClick(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, char a_Status)
 {
 	FIND_HOOK(HOOK_PLAYER_LEFT_CLICK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerLeftClick(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_Status))
 		{
@@ -870,9 +854,8 @@ bool cPluginManager::CallHookPlayerLeftClick(cPlayer & a_Player, int a_BlockX, i
 bool cPluginManager::CallHookPlayerMoving(cPlayer & a_Player, const Vector3d & a_OldPosition, const Vector3d & a_NewPosition)
 {
 	FIND_HOOK(HOOK_PLAYER_MOVING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerMoving(a_Player, a_OldPosition, a_NewPosition))
 		{
@@ -889,9 +872,8 @@ bool cPluginManager::CallHookPlayerMoving(cPlayer & a_Player, const Vector3d & a
 bool cPluginManager::CallHookPlayerPlacedBlock(cPlayer & a_Player, const sSetBlock & a_BlockChange)
 {
 	FIND_HOOK(HOOK_PLAYER_PLACED_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerPlacedBlock(a_Player, a_BlockChange))
 		{
@@ -908,9 +890,8 @@ bool cPluginManager::CallHookPlayerPlacedBlock(cPlayer & a_Player, const sSetBlo
 bool cPluginManager::CallHookPlayerPlacingBlock(cPlayer & a_Player, const sSetBlock & a_BlockChange)
 {
 	FIND_HOOK(HOOK_PLAYER_PLACING_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerPlacingBlock(a_Player, a_BlockChange))
 		{
@@ -927,9 +908,8 @@ bool cPluginManager::CallHookPlayerPlacingBlock(cPlayer & a_Player, const sSetBl
 bool cPluginManager::CallHookPlayerRightClick(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, int a_CursorX, int a_CursorY, int a_CursorZ)
 {
 	FIND_HOOK(HOOK_PLAYER_RIGHT_CLICK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerRightClick(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ))
 		{
@@ -946,9 +926,8 @@ bool cPluginManager::CallHookPlayerRightClick(cPlayer & a_Player, int a_BlockX,
 bool cPluginManager::CallHookPlayerRightClickingEntity(cPlayer & a_Player, cEntity & a_Entity)
 {
 	FIND_HOOK(HOOK_PLAYER_RIGHT_CLICKING_ENTITY);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerRightClickingEntity(a_Player, a_Entity))
 		{
@@ -965,9 +944,8 @@ bool cPluginManager::CallHookPlayerRightClickingEntity(cPlayer & a_Player, cEnti
 bool cPluginManager::CallHookPlayerShooting(cPlayer & a_Player)
 {
 	FIND_HOOK(HOOK_PLAYER_SHOOTING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerShooting(a_Player))
 		{
@@ -984,9 +962,8 @@ bool cPluginManager::CallHookPlayerShooting(cPlayer & a_Player)
 bool cPluginManager::CallHookPlayerSpawned(cPlayer & a_Player)
 {
 	FIND_HOOK(HOOK_PLAYER_SPAWNED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerSpawned(a_Player))
 		{
@@ -1003,9 +980,8 @@ bool cPluginManager::CallHookPlayerSpawned(cPlayer & a_Player)
 bool cPluginManager::CallHookPlayerTossingItem(cPlayer & a_Player)
 {
 	FIND_HOOK(HOOK_PLAYER_TOSSING_ITEM);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerTossingItem(a_Player))
 		{
@@ -1022,9 +998,8 @@ bool cPluginManager::CallHookPlayerTossingItem(cPlayer & a_Player)
 bool cPluginManager::CallHookPlayerUsedBlock(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, int a_CursorX, int a_CursorY, int a_CursorZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
 {
 	FIND_HOOK(HOOK_PLAYER_USED_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerUsedBlock(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, a_BlockType, a_BlockMeta))
 		{
@@ -1041,9 +1016,8 @@ bool cPluginManager::CallHookPlayerUsedBlock(cPlayer & a_Player, int a_BlockX, i
 bool cPluginManager::CallHookPlayerUsedItem(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, int a_CursorX, int a_CursorY, int a_CursorZ)
 {
 	FIND_HOOK(HOOK_PLAYER_USED_ITEM);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerUsedItem(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ))
 		{
@@ -1060,9 +1034,8 @@ bool cPluginManager::CallHookPlayerUsedItem(cPlayer & a_Player, int a_BlockX, in
 bool cPluginManager::CallHookPlayerUsingBlock(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, int a_CursorX, int a_CursorY, int a_CursorZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
 {
 	FIND_HOOK(HOOK_PLAYER_USING_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerUsingBlock(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ, a_BlockType, a_BlockMeta))
 		{
@@ -1079,9 +1052,8 @@ bool cPluginManager::CallHookPlayerUsingBlock(cPlayer & a_Player, int a_BlockX,
 bool cPluginManager::CallHookPlayerUsingItem(cPlayer & a_Player, int a_BlockX, int a_BlockY, int a_BlockZ, char a_BlockFace, int a_CursorX, int a_CursorY, int a_CursorZ)
 {
 	FIND_HOOK(HOOK_PLAYER_USING_ITEM);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPlayerUsingItem(a_Player, a_BlockX, a_BlockY, a_BlockZ, a_BlockFace, a_CursorX, a_CursorY, a_CursorZ))
 		{
@@ -1098,9 +1070,8 @@ bool cPluginManager::CallHookPlayerUsingItem(cPlayer & a_Player, int a_BlockX, i
 bool cPluginManager::CallHookPluginMessage(cClientHandle & a_Client, const AString & a_Channel, const AString & a_Message)
 {
 	FIND_HOOK(HOOK_PLUGIN_MESSAGE);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPluginMessage(a_Client, a_Channel, a_Message))
 		{
@@ -1117,10 +1088,9 @@ bool cPluginManager::CallHookPluginMessage(cClientHandle & a_Client, const AStri
 bool cPluginManager::CallHookPluginsLoaded(void)
 {
 	FIND_HOOK(HOOK_PLUGINS_LOADED);
-	VERIFY_HOOK;
 
 	bool res = false;
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		res = !(*itr)->OnPluginsLoaded() || res;
 	}
@@ -1134,9 +1104,8 @@ bool cPluginManager::CallHookPluginsLoaded(void)
 bool cPluginManager::CallHookPostCrafting(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraftingRecipe & a_Recipe)
 {
 	FIND_HOOK(HOOK_POST_CRAFTING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPostCrafting(a_Player, a_Grid, a_Recipe))
 		{
@@ -1153,9 +1122,8 @@ bool cPluginManager::CallHookPostCrafting(cPlayer & a_Player, cCraftingGrid & a_
 bool cPluginManager::CallHookPreCrafting(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraftingRecipe & a_Recipe)
 {
 	FIND_HOOK(HOOK_PRE_CRAFTING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnPreCrafting(a_Player, a_Grid, a_Recipe))
 		{
@@ -1172,9 +1140,8 @@ bool cPluginManager::CallHookPreCrafting(cPlayer & a_Player, cCraftingGrid & a_G
 bool cPluginManager::CallHookProjectileHitBlock(cProjectileEntity & a_Projectile, int a_BlockX, int a_BlockY, int a_BlockZ, eBlockFace a_Face, const Vector3d & a_BlockHitPos)
 {
 	FIND_HOOK(HOOK_PROJECTILE_HIT_BLOCK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnProjectileHitBlock(a_Projectile, a_BlockX, a_BlockY, a_BlockZ, a_Face, a_BlockHitPos))
 		{
@@ -1191,9 +1158,8 @@ bool cPluginManager::CallHookProjectileHitBlock(cProjectileEntity & a_Projectile
 bool cPluginManager::CallHookProjectileHitEntity(cProjectileEntity & a_Projectile, cEntity & a_HitEntity)
 {
 	FIND_HOOK(HOOK_PROJECTILE_HIT_ENTITY);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnProjectileHitEntity(a_Projectile, a_HitEntity))
 		{
@@ -1210,9 +1176,8 @@ bool cPluginManager::CallHookProjectileHitEntity(cProjectileEntity & a_Projectil
 bool cPluginManager::CallHookServerPing(cClientHandle & a_ClientHandle, AString & a_ServerDescription, int & a_OnlinePlayersCount, int & a_MaxPlayersCount, AString & a_Favicon)
 {
 	FIND_HOOK(HOOK_SERVER_PING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnServerPing(a_ClientHandle, a_ServerDescription, a_OnlinePlayersCount, a_MaxPlayersCount, a_Favicon))
 		{
@@ -1229,9 +1194,8 @@ bool cPluginManager::CallHookServerPing(cClientHandle & a_ClientHandle, AString
 bool cPluginManager::CallHookSpawnedEntity(cWorld & a_World, cEntity & a_Entity)
 {
 	FIND_HOOK(HOOK_SPAWNED_ENTITY);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnSpawnedEntity(a_World, a_Entity))
 		{
@@ -1247,9 +1211,8 @@ bool cPluginManager::CallHookSpawnedEntity(cWorld & a_World, cEntity & a_Entity)
 bool cPluginManager::CallHookSpawnedMonster(cWorld & a_World, cMonster & a_Monster)
 {
 	FIND_HOOK(HOOK_SPAWNED_MONSTER);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnSpawnedMonster(a_World, a_Monster))
 		{
@@ -1265,9 +1228,8 @@ bool cPluginManager::CallHookSpawnedMonster(cWorld & a_World, cMonster & a_Monst
 bool cPluginManager::CallHookSpawningEntity(cWorld & a_World, cEntity & a_Entity)
 {
 	FIND_HOOK(HOOK_SPAWNING_ENTITY);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnSpawningEntity(a_World, a_Entity))
 		{
@@ -1284,9 +1246,8 @@ bool cPluginManager::CallHookSpawningEntity(cWorld & a_World, cEntity & a_Entity
 bool cPluginManager::CallHookSpawningMonster(cWorld & a_World, cMonster & a_Monster)
 {
 	FIND_HOOK(HOOK_SPAWNING_MONSTER);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnSpawningMonster(a_World, a_Monster))
 		{
@@ -1303,9 +1264,8 @@ bool cPluginManager::CallHookSpawningMonster(cWorld & a_World, cMonster & a_Mons
 bool cPluginManager::CallHookTakeDamage(cEntity & a_Receiver, TakeDamageInfo & a_TDI)
 {
 	FIND_HOOK(HOOK_TAKE_DAMAGE);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnTakeDamage(a_Receiver, a_TDI))
 		{
@@ -1322,9 +1282,8 @@ bool cPluginManager::CallHookTakeDamage(cEntity & a_Receiver, TakeDamageInfo & a
 bool cPluginManager::CallHookUpdatingSign(cWorld & a_World, int a_BlockX, int a_BlockY, int a_BlockZ, AString & a_Line1, AString & a_Line2, AString & a_Line3, AString & a_Line4, cPlayer * a_Player)
 {
 	FIND_HOOK(HOOK_UPDATING_SIGN);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnUpdatingSign(a_World, a_BlockX, a_BlockY, a_BlockZ, a_Line1, a_Line2, a_Line3, a_Line4, a_Player))
 		{
@@ -1341,9 +1300,8 @@ bool cPluginManager::CallHookUpdatingSign(cWorld & a_World, int a_BlockX, int a_
 bool cPluginManager::CallHookUpdatedSign(cWorld & a_World, int a_BlockX, int a_BlockY, int a_BlockZ, const AString & a_Line1, const AString & a_Line2, const AString & a_Line3, const AString & a_Line4, cPlayer * a_Player)
 {
 	FIND_HOOK(HOOK_UPDATED_SIGN);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnUpdatedSign(a_World, a_BlockX, a_BlockY, a_BlockZ, a_Line1, a_Line2, a_Line3, a_Line4, a_Player))
 		{
@@ -1360,9 +1318,8 @@ bool cPluginManager::CallHookUpdatedSign(cWorld & a_World, int a_BlockX, int a_B
 bool cPluginManager::CallHookWeatherChanged(cWorld & a_World)
 {
 	FIND_HOOK(HOOK_WEATHER_CHANGED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnWeatherChanged(a_World))
 		{
@@ -1379,9 +1336,8 @@ bool cPluginManager::CallHookWeatherChanged(cWorld & a_World)
 bool cPluginManager::CallHookWeatherChanging(cWorld & a_World, eWeather & a_NewWeather)
 {
 	FIND_HOOK(HOOK_WEATHER_CHANGING);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnWeatherChanging(a_World, a_NewWeather))
 		{
@@ -1398,9 +1354,8 @@ bool cPluginManager::CallHookWeatherChanging(cWorld & a_World, eWeather & a_NewW
 bool cPluginManager::CallHookWorldStarted(cWorld & a_World)
 {
 	FIND_HOOK(HOOK_WORLD_STARTED);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnWorldStarted(a_World))
 		{
@@ -1417,9 +1372,8 @@ bool cPluginManager::CallHookWorldStarted(cWorld & a_World)
 bool cPluginManager::CallHookWorldTick(cWorld & a_World, std::chrono::milliseconds a_Dt, std::chrono::milliseconds a_LastTickDurationMSec)
 {
 	FIND_HOOK(HOOK_WORLD_TICK);
-	VERIFY_HOOK;
 
-	for (PluginList::iterator itr = Plugins->second.begin(); itr != Plugins->second.end(); ++itr)
+	for (PluginList::iterator itr = Plugins->begin(); itr != Plugins->end(); ++itr)
 	{
 		if ((*itr)->OnWorldTick(a_World, a_Dt, a_LastTickDurationMSec))
 		{
@@ -1482,7 +1436,11 @@ cPluginManager::CommandResult cPluginManager::HandleCommand(cPlayer & a_Player,
 void cPluginManager::UnloadPluginsNow()
 {
 	// Remove all bindings:
-	m_Hooks.clear();
+	for (size_t i = 0; i < ARRAYCOUNT(m_Hooks); i++)
+	{
+		m_Hooks[i].clear();
+	}
+	UpdateHookSubscribers();
 	m_Commands.clear();
 	m_ConsoleCommands.clear();
 
@@ -1538,10 +1496,11 @@ bool cPluginManager::LoadPlugin(const AString & a_FolderName)
 
 void cPluginManager::RemoveHooks(cPlugin * a_Plugin)
 {
-	for (HookMap::iterator itr = m_Hooks.begin(), end = m_Hooks.end(); itr != end; ++itr)
+	for (size_t i = 0; i < ARRAYCOUNT(m_Hooks); i++)
 	{
-		itr->second.remove(a_Plugin);
+		m_Hooks[i].remove(a_Plugin);
 	}
+	UpdateHookSubscribers();
 }
 
 
@@ -1845,11 +1804,60 @@ void cPluginManager::AddHook(cPlugin * a_Plugin, int a_Hook)
 		LOGWARN("Called cPluginManager::AddHook() with a_Plugin == nullptr");
 		return;
 	}
+	if (!IsValidHookType(a_Hook))
+	{
+		LOGWARN("Called cPluginManager::AddHook() with an invalid hook type %d", a_Hook);
+		return;
+	}
 	PluginList & Plugins = m_Hooks[a_Hook];
 	if (std::find(Plugins.cbegin(), Plugins.cend(), a_Plugin) == Plugins.cend())
 	{
 		Plugins.push_back(a_Plugin);
 	}
+	UpdateHookSubscribers();
+}
+
+
+
+
+
+void cPluginManager::UpdateHookSubscribers(void)
+{
+	UInt64 Subscribers = 0;
+	for (size_t i = 0; i < ARRAYCOUNT(m_Hooks); i++)
+	{
+		if (!m_Hooks[i].empty())
+		{
+			Subscribers |= (static_cast<UInt64>(1) << i);
+		}
+	}
+	m_HookSubscribers.store(Subscribers, std::memory_order_release);
+}
+
+
+
+
+
+void cPluginManager::ReportHookStats(cCommandOutputCallback & a_Output) const
+{
+	a_Output.Out("Plugin hooks, by type:");
+	a_Output.Out("  hook                         plugins    calls   total ms  avg us");
+	for (int i = 0; i < HOOK_NUM_HOOKS; i++)
+	{
+		UInt64 NumCalls = GetHookNumCalls(static_cast<PluginHook>(i));
+		if ((NumCalls == 0) && !HasHookSubscribers(static_cast<PluginHook>(i)))
+		{
+			continue;
+		}
+		UInt64 NanoSec = GetHookTotalNanoSec(static_cast<PluginHook>(i));
+		a_Output.Out("  %-28s %7u %8llu %10llu %7llu",
+			cPluginLua::GetHookFnName(i),
+			static_cast<unsigned>(m_Hooks[i].size()),
+			static_cast<unsigned long long>(NumCalls),
+			static_cast<unsigned long long>(NanoSec / 1000000),
+			static_cast<unsigned long long>((NumCalls == 0) ? 0 : NanoSec / NumCalls / 1000)
+		);
+	}
 }
 
 
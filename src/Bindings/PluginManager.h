@@ -3,6 +3,8 @@
 
 
 #include "Defines.h"
+#include "../OSSupport/CriticalSection.h"
+#include <atomic>
 
 
 
@@ -185,6 +187,22 @@ public:
 
 	/** Returns the number of plugins that are psLoaded. */
 	size_t GetNumLoadedPlugins(void) const;  // tolua_export
+
+	/** Returns true if any plugin handles the specified hook.
+	A single atomic load, cheap enough for the callers of the hot hooks to check before preparing the hook's parameters. */
+	bool HasHookSubscribers(PluginHook a_Hook) const
+	{
+		return (((m_HookSubscribers.load(std::memory_order_relaxed) >> a_Hook) & 1) != 0);
+	}
+
+	/** Returns the number of times the specified hook has been dispatched to the plugins. */
+	UInt64 GetHookNumCalls(PluginHook a_Hook) const { return m_HookStats[a_Hook].m_NumCalls; }
+
+	/** Returns the total time spent in the plugins' handlers of the specified hook, in nanoseconds. */
+	UInt64 GetHookTotalNanoSec(PluginHook a_Hook) const { return m_HookStats[a_Hook].m_NanoSec; }
+
+	/** Outputs the hook statistics as a table, used by the "hookstats" console command. */
+	void ReportHookStats(cCommandOutputCallback & a_Output) const;
 	
 	// Calls for individual hooks. Each returns false if the action is to continue or true if the plugin wants to abort
 	bool CallHookBlockSpread              (cWorld & a_World, int a_BlockX, int a_BlockY, int a_BlockZ, eSpreadSource a_Source);
@@ -333,9 +351,36 @@ private:
 		AString   m_HelpString;
 	} ;
 	
-	typedef std::map<int, cPluginManager::PluginList> HookMap;
 	typedef std::map<AString, cCommandReg> CommandMap;
 
+	/** Statistics of a single hook's dispatching. Atomic, the hooks are called from multiple threads. */
+	struct sHookStats
+	{
+		std::atomic<UInt64> m_NumCalls;
+		std::atomic<UInt64> m_NanoSec;
+	} ;
+
+	/** Adds the time spent in its scope to a hook's stats; used by the CallHook functions. */
+	class cHookTimer
+	{
+	public:
+		cHookTimer(sHookStats & a_Stats) :
+			m_Stats(a_Stats),
+			m_StartTime(std::chrono::steady_clock::now())
+		{
+		}
+
+		~cHookTimer()
+		{
+			m_Stats.m_NumCalls.fetch_add(1, std::memory_order_relaxed);
+			m_Stats.m_NanoSec.fetch_add(static_cast<UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count()), std::memory_order_relaxed);
+		}
+
+	protected:
+		sHookStats & m_Stats;
+		std::chrono::steady_clock::time_point m_StartTime;
+	} ;
+
 
 	/** FolderNames of plugins that should be unloaded.
 	The plugins will be unloaded within the next call to Tick(), to avoid multithreading issues.
@@ -348,7 +393,15 @@ private:
 	/** All plugins that have been found in the Plugins folder. */
 	cPluginPtrs m_Plugins;
 
-	HookMap    m_Hooks;
+	/** The plugins handling each hook, indexed by the hook type. */
+	PluginList m_Hooks[HOOK_NUM_HOOKS];
+
+	/** Bit N is set if m_Hooks[N] is non-empty. Lets the CallHook functions bail out without touching the lists. */
+	std::atomic<UInt64> m_HookSubscribers;
+
+	/** Dispatch statistics, indexed by the hook type. */
+	sHookStats m_HookStats[HOOK_NUM_HOOKS];
+
 	CommandMap m_Commands;
 	CommandMap m_ConsoleCommands;
 
@@ -376,6 +429,9 @@ private:
 
 	/** Returns the folders that are specified in the settings ini to load plugins from. */
 	AStringVector GetFoldersToLoad(cIniFile & a_SettingsIni);
+
+	/** Recalculates m_HookSubscribers from m_Hooks; called whenever the hook lists change. */
+	void UpdateHookSubscribers(void);
 } ;  // tolua_export
 
 
@@ -0,0 +1,414 @@
+
+// PluginProfiler.cpp
+
+// Implements the cPluginProfiler class that measures the time a Lua plugin spends in its hooks, commands and tasks
+
+#include "Globals.h"
+#include "PluginProfiler.h"
+#include "PluginLua.h"
+#include "../CommandOutput.h"
+
+#ifndef _WIN32
+	#include <time.h>
+#endif
+
+
+
+
+
+/** The address of this variable is the key of the profiler pointer in the Lua registry, used by the sampling hook */
+static char g_ProfilerRegistryKey;
+
+std::atomic<bool> cPluginProfiler::s_IsEnabled(true);
+std::atomic<int> cPluginProfiler::s_SlowCallThresholdMSec(0);
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPluginProfiler::cScope:
+
+cPluginProfiler::cScope::cScope(cPluginProfiler & a_Profiler, cPluginManager::PluginHook a_Hook) :
+	m_Profiler(a_Profiler),
+	m_Category(pcHook),
+	m_Hook(a_Hook),
+	m_Name(nullptr)
+{
+	Start();
+}
+
+
+
+
+
+cPluginProfiler::cScope::cScope(cPluginProfiler & a_Profiler, eCategory a_Category, const AString & a_Name) :
+	m_Profiler(a_Profiler),
+	m_Category(a_Category),
+	m_Hook(cPluginManager::HOOK_TICK),
+	m_Name(&a_Name)
+{
+	ASSERT(a_Category != pcHook);
+	Start();
+}
+
+
+
+
+
+void cPluginProfiler::cScope::Start(void)
+{
+	m_IsActive = s_IsEnabled;
+	m_IsSampling = false;
+	m_Outer = nullptr;
+	if (!m_IsActive)
+	{
+		return;
+	}
+
+	m_Outer = m_Profiler.m_CurrentScope;
+	m_Profiler.m_CurrentScope = this;
+
+	// Install the sampling hook for the outermost scope, if sampling is enabled:
+	if ((m_Outer == nullptr) && (s_SlowCallThresholdMSec > 0) && m_Profiler.m_LuaState.IsValid())
+	{
+		lua_State * L = m_Profiler.m_LuaState;
+		lua_pushlightuserdata(L, &g_ProfilerRegistryKey);
+		lua_pushlightuserdata(L, &m_Profiler);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+		lua_sethook(L, &cPluginProfiler::SampleHook, LUA_MASKCOUNT, SAMPLE_INSTRUCTION_COUNT);
+		m_IsSampling = true;
+	}
+
+	m_StartCpuNanoSec = GetThreadCpuNanoSec();
+	m_StartTime = std::chrono::steady_clock::now();
+}
+
+
+
+
+
+cPluginProfiler::cScope::~cScope()
+{
+	if (!m_IsActive)
+	{
+		return;
+	}
+	auto WallNanoSec = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count();
+	UInt64 CpuNanoSec = GetThreadCpuNanoSec() - m_StartCpuNanoSec;
+
+	if (m_IsSampling && m_Profiler.m_LuaState.IsValid())
+	{
+		lua_sethook(m_Profiler.m_LuaState, nullptr, 0, 0);
+	}
+	ASSERT(m_Profiler.m_CurrentScope == this);
+	m_Profiler.m_CurrentScope = m_Outer;
+
+	m_Profiler.Record(*this, static_cast<UInt64>(WallNanoSec), CpuNanoSec);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPluginProfiler::sEntry:
+
+cPluginProfiler::sEntry::sEntry(void) :
+	m_NumCalls(0),
+	m_WallNanoSec(0),
+	m_CpuNanoSec(0),
+	m_MaxWallNanoSec(0),
+	m_WindowPos(0),
+	m_NumSlowCalls(0)
+{
+}
+
+
+
+
+
+void cPluginProfiler::sEntry::Add(UInt64 a_WallNanoSec, UInt64 a_CpuNanoSec)
+{
+	m_NumCalls += 1;
+	m_WallNanoSec += a_WallNanoSec;
+	m_CpuNanoSec += a_CpuNanoSec;
+	m_MaxWallNanoSec = std::max(m_MaxWallNanoSec, a_WallNanoSec);
+
+	UInt32 MicroSec = static_cast<UInt32>(std::min<UInt64>(a_WallNanoSec / 1000, std::numeric_limits<UInt32>::max()));
+	if (m_Window.size() < WINDOW_SIZE)
+	{
+		m_Window.push_back(MicroSec);
+	}
+	else
+	{
+		m_Window[m_WindowPos] = MicroSec;
+		m_WindowPos = (m_WindowPos + 1) % WINDOW_SIZE;
+	}
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPluginProfiler:
+
+cPluginProfiler::cPluginProfiler(cLuaState & a_LuaState) :
+	m_LuaState(a_LuaState),
+	m_CurrentScope(nullptr)
+{
+}
+
+
+
+
+
+void cPluginProfiler::Record(const cScope & a_Scope, UInt64 a_WallNanoSec, UInt64 a_CpuNanoSec)
+{
+	cCSLock Lock(m_CS);
+	sEntry & Entry = (a_Scope.m_Category == pcHook) ? m_Hooks[a_Scope.m_Hook] : m_Named[a_Scope.m_Category][*a_Scope.m_Name];
+	Entry.Add(a_WallNanoSec, a_CpuNanoSec);
+	if (!a_Scope.m_SlowTrace.empty())
+	{
+		Entry.m_NumSlowCalls += 1;
+		Entry.m_SlowTrace = a_Scope.m_SlowTrace;
+	}
+}
+
+
+
+
+
+void cPluginProfiler::Report(cCommandOutputCallback & a_Output, const AString & a_PluginName) const
+{
+	static const char * CategoryNames[] =
+	{
+		"hook",
+		"command",
+		"console",
+		"task",
+	};
+
+	struct sRow
+	{
+		const char * m_Kind;
+		AString m_Name;
+		const sEntry * m_Entry;
+	} ;
+
+	cCSLock Lock(m_CS);
+
+	// Collect the entries that have been called:
+	std::vector<sRow> Rows;
+	for (int i = 0; i < cPluginManager::HOOK_NUM_HOOKS; i++)
+	{
+		if (m_Hooks[i].m_NumCalls > 0)
+		{
+			sRow Row = { CategoryNames[pcHook], cPluginLua::GetHookFnName(i), &m_Hooks[i] };
+			Rows.push_back(Row);
+		}
+	}
+	for (size_t i = 0; i < ARRAYCOUNT(m_Named); i++)
+	{
+		for (cNamedEntries::const_iterator itr = m_Named[i].begin(), end = m_Named[i].end(); itr != end; ++itr)
+		{
+			sRow Row = { CategoryNames[i], itr->first, &itr->second };
+			Rows.push_back(Row);
+		}
+	}
+	if (Rows.empty())
+	{
+		return;
+	}
+	std::sort(Rows.begin(), Rows.end(), [](const sRow & a_First, const sRow & a_Second)
+		{
+			return (a_First.m_Entry->m_WallNanoSec > a_Second.m_Entry->m_WallNanoSec);
+		}
+	);
+
+	a_Output.Out("Plugin %s:", a_PluginName.c_str());
+	a_Output.Out("  %-8s %-28s %9s %9s %9s %8s %8s %8s %8s %8s",
+		"kind", "name", "calls", "wall ms", "cpu ms", "avg us", "p50 us", "p95 us", "p99 us", "max us"
+	);
+	std::vector<UInt32> Window;
+	for (std::vector<sRow>::const_iterator itr = Rows.begin(), end = Rows.end(); itr != end; ++itr)
+	{
+		const sEntry & Entry = *itr->m_Entry;
+		Window = Entry.m_Window;
+		std::sort(Window.begin(), Window.end());
+		size_t Last = Window.size() - 1;
+		a_Output.Out("  %-8s %-28s %9llu %9llu %9llu %8llu %8u %8u %8u %8llu",
+			itr->m_Kind, itr->m_Name.c_str(),
+			static_cast<unsigned long long>(Entry.m_NumCalls),
+			static_cast<unsigned long long>(Entry.m_WallNanoSec / 1000000),
+			static_cast<unsigned long long>(Entry.m_CpuNanoSec / 1000000),
+			static_cast<unsigned long long>(Entry.m_WallNanoSec / Entry.m_NumCalls / 1000),
+			static_cast<unsigned>(Window[Last * 50 / 100]),
+			static_cast<unsigned>(Window[Last * 95 / 100]),
+			static_cast<unsigned>(Window[Last * 99 / 100]),
+			static_cast<unsigned long long>(Entry.m_MaxWallNanoSec / 1000)
+		);
+	}
+
+	// Output the stacks of the sampled slow calls:
+	for (std::vector<sRow>::const_iterator itr = Rows.begin(), end = Rows.end(); itr != end; ++itr)
+	{
+		if (itr->m_Entry->m_NumSlowCalls == 0)
+		{
+			continue;
+		}
+		a_Output.Out("  %s %s: %llu slow calls, the last one was at:",
+			itr->m_Kind, itr->m_Name.c_str(), static_cast<unsigned long long>(itr->m_Entry->m_NumSlowCalls)
+		);
+		a_Output.Out(itr->m_Entry->m_SlowTrace);
+	}
+}
+
+
+
+
+
+void cPluginProfiler::Reset(void)
+{
+	cCSLock Lock(m_CS);
+	for (size_t i = 0; i < ARRAYCOUNT(m_Hooks); i++)
+	{
+		m_Hooks[i] = sEntry();
+	}
+	for (size_t i = 0; i < ARRAYCOUNT(m_Named); i++)
+	{
+		m_Named[i].clear();
+	}
+}
+
+
+
+
+
+void cPluginProfiler::ReportAll(cCommandOutputCallback & a_Output)
+{
+	class cCallback :
+		public cPluginManager::cPluginCallback
+	{
+	public:
+		cCallback(cCommandOutputCallback & a_Output) : m_Output(a_Output) {}
+
+		virtual bool Item(cPlugin * a_Plugin) override
+		{
+			// All the plugins are Lua plugins:
+			static_cast<cPluginLua *>(a_Plugin)->GetProfiler().Report(m_Output, a_Plugin->GetName());
+			return false;
+		}
+
+		cCommandOutputCallback & m_Output;
+	} Callback(a_Output);
+
+	int Threshold = s_SlowCallThresholdMSec;
+	a_Output.Out("Lua plugin profiling is %s, slow call sampling is %s",
+		s_IsEnabled ? "on" : "off",
+		(Threshold > 0) ? Printf("on (%d ms)", Threshold).c_str() : "off"
+	);
+	cPluginManager::Get()->ForEachPlugin(Callback);
+}
+
+
+
+
+
+void cPluginProfiler::ResetAll(void)
+{
+	class cCallback :
+		public cPluginManager::cPluginCallback
+	{
+		virtual bool Item(cPlugin * a_Plugin) override
+		{
+			static_cast<cPluginLua *>(a_Plugin)->GetProfiler().Reset();
+			return false;
+		}
+	} Callback;
+	cPluginManager::Get()->ForEachPlugin(Callback);
+}
+
+
+
+
+
+AString cPluginProfiler::GetFunctionName(lua_State * a_LuaState, int a_StackPos)
+{
+	lua_Debug Debug;
+	lua_pushvalue(a_LuaState, a_StackPos);
+	if (lua_getinfo(a_LuaState, ">S", &Debug) == 0)  // Pops the function
+	{
+		return "(unknown)";
+	}
+	return Printf("%s:%d", Debug.short_src, Debug.linedefined);
+}
+
+
+
+
+
+void cPluginProfiler::SampleHook(lua_State * a_LuaState, lua_Debug * a_Debug)
+{
+	UNUSED(a_Debug);
+
+	// Get the profiler:
+	lua_pushlightuserdata(a_LuaState, &g_ProfilerRegistryKey);
+	lua_rawget(a_LuaState, LUA_REGISTRYINDEX);
+	cPluginProfiler * Profiler = static_cast<cPluginProfiler *>(lua_touserdata(a_LuaState, -1));
+	lua_pop(a_LuaState, 1);
+	if ((Profiler == nullptr) || (Profiler->m_CurrentScope == nullptr))
+	{
+		return;
+	}
+
+	// Capture the stack once the call becomes slow, once per call:
+	cScope & Scope = *Profiler->m_CurrentScope;
+	if (!Scope.m_SlowTrace.empty())
+	{
+		return;
+	}
+	auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Scope.m_StartTime);
+	if (Elapsed.count() < s_SlowCallThresholdMSec)
+	{
+		return;
+	}
+	lua_Debug Entry;
+	for (int Depth = 0; lua_getstack(a_LuaState, Depth, &Entry) && (Depth < 16); Depth++)
+	{
+		lua_getinfo(a_LuaState, "Sln", &Entry);
+		AppendPrintf(Scope.m_SlowTrace, "    %s(%d): %s\n", Entry.short_src, Entry.currentline, (Entry.name != nullptr) ? Entry.name : "(no name)");
+	}
+}
+
+
+
+
+
+UInt64 cPluginProfiler::GetThreadCpuNanoSec(void)
+{
+	#if defined(_WIN32)
+		FILETIME CreationTime, ExitTime, KernelTime, UserTime;
+		if (!GetThreadTimes(GetCurrentThread(), &CreationTime, &ExitTime, &KernelTime, &UserTime))
+		{
+			return 0;
+		}
+		UInt64 Kernel = (static_cast<UInt64>(KernelTime.dwHighDateTime) << 32) | KernelTime.dwLowDateTime;
+		UInt64 User = (static_cast<UInt64>(UserTime.dwHighDateTime) << 32) | UserTime.dwLowDateTime;
+		return (Kernel + User) * 100;  // FILETIME is in 100 ns units
+	#elif defined(CLOCK_THREAD_CPUTIME_ID)
+		timespec Now;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Now) != 0)
+		{
+			return 0;
+		}
+		return static_cast<UInt64>(Now.tv_sec) * 1000000000 + static_cast<UInt64>(Now.tv_nsec);
+	#else
+		return 0;
+	#endif
+}
+
+
+
+
@@ -0,0 +1,180 @@
+
+// PluginProfiler.h
+
+// Declares the cPluginProfiler class that measures the time a Lua plugin spends in its hooks, commands and tasks
+
+
+
+
+
+#pragma once
+
+#include <atomic>
+#include "LuaState.h"
+#include "PluginManager.h"
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+
+
+
+
+
+/** Measures the wall-clock and CPU time that a single Lua plugin spends in its hook handlers, command handlers
+and scheduled tasks. Each cPluginLua has one, the calls into the plugin's Lua state are wrapped in a cScope.
+For each hook type / command / task the profiler keeps the totals, the maximum, and the wall times of the last
+WINDOW_SIZE calls, from which the percentiles are computed when reporting.
+The times are inclusive: a handler that triggers another handler of the same plugin is charged for both.
+Optionally, the calls that take longer than the slow-call threshold get their Lua stack sampled through
+lua_sethook(), so that the report shows where the slow calls spend their time.
+The "luaprof" console command and the webadmin's default page show the report. */
+class cPluginProfiler
+{
+public:
+
+	/** The kinds of the profiled calls */
+	enum eCategory
+	{
+		pcHook,
+		pcCommand,
+		pcConsoleCommand,
+		pcTask,
+	} ;
+
+
+	/** RAII-style measurement of a single call into the plugin's Lua state.
+	Must be created while holding the plugin's lock, and must not outlive the call. */
+	class cScope
+	{
+	public:
+		/** Measures a hook handler */
+		cScope(cPluginProfiler & a_Profiler, cPluginManager::PluginHook a_Hook);
+
+		/** Measures a command handler or a task; a_Name must outlive the scope */
+		cScope(cPluginProfiler & a_Profiler, eCategory a_Category, const AString & a_Name);
+
+		~cScope();
+
+	protected:
+		friend class cPluginProfiler;
+
+		cPluginProfiler & m_Profiler;
+		eCategory m_Category;
+		cPluginManager::PluginHook m_Hook;
+		const AString * m_Name;
+
+		/** Set to false if the profiler was disabled when the scope started; nothing is measured then */
+		bool m_IsActive;
+
+		std::chrono::steady_clock::time_point m_StartTime;
+		UInt64 m_StartCpuNanoSec;
+
+		/** The scope that was being measured when this one started, nullptr for the outermost scope */
+		cScope * m_Outer;
+
+		/** Set if this scope installed the sampling hook into the Lua state */
+		bool m_IsSampling;
+
+		/** The Lua stack captured by the sampling hook when the call became slow; empty if not sampled */
+		AString m_SlowTrace;
+
+		/** Starts the measurement, shared by the constructors */
+		void Start(void);
+	} ;
+
+
+	cPluginProfiler(cLuaState & a_LuaState);
+
+	/** Outputs the plugin's profile as a table, the most expensive entries first */
+	void Report(cCommandOutputCallback & a_Output, const AString & a_PluginName) const;
+
+	/** Clears all the gathered statistics */
+	void Reset(void);
+
+	/** Enables or disables the profiling of all the plugins */
+	static void SetEnabled(bool a_IsEnabled) { s_IsEnabled = a_IsEnabled; }
+	static bool IsEnabled(void) { return s_IsEnabled; }
+
+	/** Sets the time after which a call gets its Lua stack sampled, for all the plugins; 0 disables the sampling */
+	static void SetSlowCallThreshold(int a_MilliSec) { s_SlowCallThresholdMSec = a_MilliSec; }
+	static int GetSlowCallThreshold(void) { return s_SlowCallThresholdMSec; }
+
+	/** Outputs the profiles of all the plugins, preceded by the profiler settings */
+	static void ReportAll(cCommandOutputCallback & a_Output);
+
+	/** Clears the gathered statistics of all the plugins */
+	static void ResetAll(void);
+
+	/** Returns a name for the Lua function at the specified stack index, "source:line", used to name the tasks */
+	static AString GetFunctionName(lua_State * a_LuaState, int a_StackPos);
+
+protected:
+
+	/** Number of the last calls whose wall times are kept for the percentiles */
+	static const size_t WINDOW_SIZE = 256;
+
+	/** Number of Lua instructions between the sampling hook's checks of the elapsed time */
+	static const int SAMPLE_INSTRUCTION_COUNT = 10000;
+
+	struct sEntry
+	{
+		UInt64 m_NumCalls;
+		UInt64 m_WallNanoSec;
+		UInt64 m_CpuNanoSec;
+		UInt64 m_MaxWallNanoSec;
+
+		/** Wall times of the last calls in microseconds, a ring buffer filled up to WINDOW_SIZE */
+		std::vector<UInt32> m_Window;
+		size_t m_WindowPos;
+
+		/** Number of the calls that exceeded the slow-call threshold while sampling */
+		UInt64 m_NumSlowCalls;
+
+		/** The Lua stack of the most recent sampled slow call */
+		AString m_SlowTrace;
+
+		sEntry(void);
+
+		/** Adds a single measured call */
+		void Add(UInt64 a_WallNanoSec, UInt64 a_CpuNanoSec);
+	} ;
+
+	typedef std::map<AString, sEntry> cNamedEntries;
+
+
+	/** The Lua state of the plugin, used for the sampling */
+	cLuaState & m_LuaState;
+
+	/** Protects the entries against the reports from other threads */
+	mutable cCriticalSection m_CS;
+
+	/** The hook entries, indexed by the hook type */
+	sEntry m_Hooks[cPluginManager::HOOK_NUM_HOOKS];
+
+	/** The command, console command and task entries, indexed by category */
+	cNamedEntries m_Named[pcTask + 1];
+
+	/** The scope being measured, the innermost one; only accessed while holding the plugin's lock */
+	cScope * m_CurrentScope;
+
+	static std::atomic<bool> s_IsEnabled;
+	static std::atomic<int> s_SlowCallThresholdMSec;
+
+
+	/** Adds the measurements of the finished scope to its entry */
+	void Record(const cScope & a_Scope, UInt64 a_WallNanoSec, UInt64 a_CpuNanoSec);
+
+	/** The lua_sethook() callback, captures the Lua stack of the current scope once it becomes slow */
+	static void SampleHook(lua_State * a_LuaState, lua_Debug * a_Debug);
+
+	/** Returns the CPU time consumed by the current thread, in nanoseconds; 0 if not available on this platform */
+	static UInt64 GetThreadCpuNanoSec(void);
+} ;
+
+
+
+
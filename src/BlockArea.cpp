@@ -6,7 +6,12 @@
 
 #include "Globals.h"
 #include "BlockArea.h"
+#include <atomic>
+#include <mutex>
+#include <system_error>
+#include <thread>
 #include "OSSupport/GZipFile.h"
+#include "OSSupport/File.h"
 #include "Blocks/BlockHandler.h"
 #include "Cuboid.h"
 #include "ChunkData.h"
@@ -24,11 +29,89 @@
 
 
 
+/** The meta transformations that have their lookup tables */
+enum eMetaTransform
+{
+	mtRotateCCW,
+	mtRotateCW,
+	mtMirrorXY,
+	mtMirrorXZ,
+	mtMirrorYZ,
+	mtCount,
+} ;
+
+
+
+
+
+/** Returns the lookup table of the meta transformation for all the blocktypes.
+The blockhandlers' meta functions only depend on the meta, so they are tabulated on first use,
+instead of two virtual calls per block in each transformation. */
+static const cBlockAreaKernels::cMetaTable & GetMetaTable(eMetaTransform a_Transform)
+{
+	static cBlockAreaKernels::cMetaTable Tables[mtCount];
+	static std::once_flag TablesBuilt;
+	std::call_once(TablesBuilt, []()
+		{
+			for (int Type = 0; Type < 256; Type++)
+			{
+				cBlockHandler * Handler = BlockHandler(static_cast<BLOCKTYPE>(Type));
+				for (NIBBLETYPE Meta = 0; Meta < 16; Meta++)
+				{
+					Tables[mtRotateCCW][Type][Meta] = Handler->MetaRotateCCW(Meta);
+					Tables[mtRotateCW][Type][Meta]  = Handler->MetaRotateCW(Meta);
+					Tables[mtMirrorXY][Type][Meta]  = Handler->MetaMirrorXY(Meta);
+					Tables[mtMirrorXZ][Type][Meta]  = Handler->MetaMirrorXZ(Meta);
+					Tables[mtMirrorYZ][Type][Meta]  = Handler->MetaMirrorYZ(Meta);
+				}
+			}
+		}
+	);
+	return Tables[a_Transform];
+}
+
+
+
+
+
+/** Unpacks the nibbles of a packed area for the duration of an operation that needs them one per byte,
+and packs them again afterwards. Does nothing for the areas that are not packed. */
+class cUnpackedNibblesScope
+{
+public:
+	cUnpackedNibblesScope(cBlockArea & a_Area) :
+		m_Area(a_Area),
+		m_WasPacked(a_Area.AreNibblesPacked())
+	{
+		if (m_WasPacked)
+		{
+			m_Area.UnpackNibbles();
+		}
+	}
+
+	~cUnpackedNibblesScope()
+	{
+		if (m_WasPacked)
+		{
+			m_Area.PackNibbles();
+		}
+	}
+
+protected:
+	cBlockArea & m_Area;
+	bool m_WasPacked;
+} ;
+
+
+
+
+
 typedef void (CombinatorFunc)(BLOCKTYPE & a_DstType, BLOCKTYPE a_SrcType, NIBBLETYPE & a_DstMeta, NIBBLETYPE a_SrcMeta);
 
 // This wild construct allows us to pass a function argument and still have it inlined by the compiler :)
 /// Merges two blocktypes and blockmetas of the specified sizes and offsets using the specified combinator function
-template <bool MetasValid, CombinatorFunc Combinator>
+/// If SrcMetasPacked is set, the source metas are stored two per byte
+template <bool MetasValid, bool SrcMetasPacked, CombinatorFunc Combinator>
 void InternalMergeBlocks(
 	BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes,
 	NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas,
@@ -55,7 +138,8 @@ void InternalMergeBlocks(
 			{
 				if (MetasValid)
 				{
-					Combinator(a_DstTypes[DstIdx], a_SrcTypes[SrcIdx], a_DstMetas[DstIdx], a_SrcMetas[SrcIdx]);
+					NIBBLETYPE SrcMeta = SrcMetasPacked ? cBlockAreaKernels::GetPackedNibble(a_SrcMetas, static_cast<size_t>(SrcIdx)) : a_SrcMetas[SrcIdx];
+					Combinator(a_DstTypes[DstIdx], a_SrcTypes[SrcIdx], a_DstMetas[DstIdx], SrcMeta);
 				}
 				else
 				{
@@ -73,6 +157,54 @@ void InternalMergeBlocks(
 
 
 
+/// Overwrites the blocktypes and blockmetas of the specified sizes and offsets with the source ones, whole rows at a time
+/// If SrcMetasPacked is set, the source metas are stored two per byte
+template <bool MetasValid, bool SrcMetasPacked>
+void InternalOverwriteBlocks(
+	BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes,
+	NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas,
+	int a_SizeX, int a_SizeY, int a_SizeZ,
+	int a_SrcOffX, int a_SrcOffY, int a_SrcOffZ,
+	int a_DstOffX, int a_DstOffY, int a_DstOffZ,
+	int a_SrcSizeX, int a_SrcSizeY, int a_SrcSizeZ,
+	int a_DstSizeX, int a_DstSizeY, int a_DstSizeZ
+)
+{
+	UNUSED(a_SrcSizeY);
+	UNUSED(a_DstSizeY);
+	if ((a_SizeX <= 0) || (a_SizeY <= 0) || (a_SizeZ <= 0))
+	{
+		return;
+	}
+	size_t RowSize = static_cast<size_t>(a_SizeX);
+	for (int y = 0; y < a_SizeY; y++)
+	{
+		int SrcBaseY = (y + a_SrcOffY) * a_SrcSizeX * a_SrcSizeZ;
+		int DstBaseY = (y + a_DstOffY) * a_DstSizeX * a_DstSizeZ;
+		for (int z = 0; z < a_SizeZ; z++)
+		{
+			int SrcIdx = SrcBaseY + (z + a_SrcOffZ) * a_SrcSizeX + a_SrcOffX;
+			int DstIdx = DstBaseY + (z + a_DstOffZ) * a_DstSizeX + a_DstOffX;
+			memcpy(a_DstTypes + DstIdx, a_SrcTypes + SrcIdx, RowSize * sizeof(BLOCKTYPE));
+			if (MetasValid)
+			{
+				if (SrcMetasPacked)
+				{
+					cBlockAreaKernels::UnpackNibbles(a_DstMetas + DstIdx, a_SrcMetas, static_cast<size_t>(SrcIdx), RowSize);
+				}
+				else
+				{
+					memcpy(a_DstMetas + DstIdx, a_SrcMetas + SrcIdx, RowSize * sizeof(NIBBLETYPE));
+				}
+			}
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
 /// Combinator used for cBlockArea::msOverwrite merging
 template <bool MetaValid>
 void MergeCombinatorOverwrite(BLOCKTYPE & a_DstType, BLOCKTYPE a_SrcType, NIBBLETYPE & a_DstMeta, NIBBLETYPE a_SrcMeta)
@@ -296,7 +428,8 @@ cBlockArea::cBlockArea(void) :
 	m_BlockTypes(nullptr),
 	m_BlockMetas(nullptr),
 	m_BlockLight(nullptr),
-	m_BlockSkyLight(nullptr)
+	m_BlockSkyLight(nullptr),
+	m_AreNibblesPacked(false)
 {
 }
 
@@ -319,6 +452,7 @@ void cBlockArea::Clear(void)
 	delete[] m_BlockMetas;    m_BlockMetas    = nullptr;
 	delete[] m_BlockLight;    m_BlockLight    = nullptr;
 	delete[] m_BlockSkyLight; m_BlockSkyLight = nullptr;
+	m_AreNibblesPacked = false;
 	m_Origin.Set(0, 0, 0);
 	m_Size.Set(0, 0, 0);
 }
@@ -488,7 +622,9 @@ bool cBlockArea::Read(cForEachChunkProvider * a_ForEachChunkProvider, int a_MinB
 		Clear();
 		return false;
 	}
-	
+
+	// The chunks have been released, expand the snapshots:
+	Reader.FillArea();
 	return true;
 }
 
@@ -543,6 +679,7 @@ bool cBlockArea::Write(cForEachChunkProvider * a_ForEachChunkProvider, int a_Min
 		a_MinBlockY = cChunkDef::Height - m_Size.y;
 	}
 
+	cUnpackedNibblesScope Unpacked(*this);
 	return a_ForEachChunkProvider->WriteBlockArea(*this, a_MinBlockX, a_MinBlockY, a_MinBlockZ, a_DataTypes);
 }
 
@@ -571,25 +708,28 @@ void cBlockArea::CopyTo(cBlockArea & a_Into) const
 		return;
 	}
 	
+	// The copy keeps the packed mode, so that the nibble arrays can be copied as they are:
 	a_Into.Clear();
+	a_Into.m_AreNibblesPacked = m_AreNibblesPacked;
 	a_Into.SetSize(m_Size.x, m_Size.y, m_Size.z, GetDataTypes());
 	a_Into.m_Origin = m_Origin;
 	size_t BlockCount = GetBlockCount();
+	size_t NibbleCount = GetNibbleArraySize();
 	if (HasBlockTypes())
 	{
 		memcpy(a_Into.m_BlockTypes, m_BlockTypes, BlockCount * sizeof(BLOCKTYPE));
 	}
 	if (HasBlockMetas())
 	{
-		memcpy(a_Into.m_BlockMetas, m_BlockMetas, BlockCount * sizeof(NIBBLETYPE));
+		memcpy(a_Into.m_BlockMetas, m_BlockMetas, NibbleCount * sizeof(NIBBLETYPE));
 	}
 	if (HasBlockLights())
 	{
-		memcpy(a_Into.m_BlockLight, m_BlockLight, BlockCount * sizeof(NIBBLETYPE));
+		memcpy(a_Into.m_BlockLight, m_BlockLight, NibbleCount * sizeof(NIBBLETYPE));
 	}
 	if (HasBlockSkyLights())
 	{
-		memcpy(a_Into.m_BlockSkyLight, m_BlockSkyLight, BlockCount * sizeof(NIBBLETYPE));
+		memcpy(a_Into.m_BlockSkyLight, m_BlockSkyLight, NibbleCount * sizeof(NIBBLETYPE));
 	}
 }
 
@@ -614,6 +754,7 @@ void cBlockArea::DumpToRawFile(const AString & a_FileName)
 		LOGWARNING("cBlockArea: Cannot open file \"%s\" for raw dump", a_FileName.c_str());
 		return;
 	}
+	cUnpackedNibblesScope Unpacked(*this);
 	UInt32 SizeX = ntohl(m_Size.x);
 	UInt32 SizeY = ntohl(m_Size.y);
 	UInt32 SizeZ = ntohl(m_Size.z);
@@ -671,6 +812,7 @@ void cBlockArea::Crop(int a_AddMinX, int a_SubMaxX, int a_AddMinY, int a_SubMaxY
 		return;
 	}
 	
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
 		CropBlockTypes(a_AddMinX, a_SubMaxX, a_AddMinY, a_SubMaxY, a_AddMinZ, a_SubMaxZ);
@@ -699,6 +841,7 @@ void cBlockArea::Crop(int a_AddMinX, int a_SubMaxX, int a_AddMinY, int a_SubMaxY
 
 void cBlockArea::Expand(int a_SubMinX, int a_AddMaxX, int a_SubMinY, int a_AddMaxY, int a_SubMinZ, int a_AddMaxZ)
 {
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
 		ExpandBlockTypes(a_SubMinX, a_AddMaxX, a_SubMinY, a_AddMaxY, a_SubMinZ, a_AddMaxZ);
@@ -727,19 +870,25 @@ void cBlockArea::Expand(int a_SubMinX, int a_AddMaxX, int a_SubMinY, int a_AddMa
 
 void cBlockArea::Merge(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_RelZ, eMergeStrategy a_Strategy)
 {
+	// Only the destination needs to be unpacked, a packed source is read directly:
+	cUnpackedNibblesScope Unpacked(*this);
 
-	const NIBBLETYPE * SrcMetas = a_Src.GetBlockMetas();
+	const NIBBLETYPE * SrcMetas = a_Src.m_BlockMetas;
 	NIBBLETYPE * DstMetas = m_BlockMetas;
 	
 	bool IsDummyMetas = ((SrcMetas == nullptr) || (DstMetas == nullptr));
 	
 	if (IsDummyMetas)
 	{
-		MergeByStrategy<false>(a_Src, a_RelX, a_RelY, a_RelZ, a_Strategy, SrcMetas, DstMetas);
+		MergeByStrategy<false, false>(a_Src, a_RelX, a_RelY, a_RelZ, a_Strategy, SrcMetas, DstMetas);
+	}
+	else if (a_Src.m_AreNibblesPacked)
+	{
+		MergeByStrategy<true, true>(a_Src, a_RelX, a_RelY, a_RelZ, a_Strategy, SrcMetas, DstMetas);
 	}
 	else
 	{
-		MergeByStrategy<true>(a_Src, a_RelX, a_RelY, a_RelZ, a_Strategy, SrcMetas, DstMetas);
+		MergeByStrategy<true, false>(a_Src, a_RelX, a_RelY, a_RelZ, a_Strategy, SrcMetas, DstMetas);
 	}
 }
 
@@ -766,34 +915,31 @@ void cBlockArea::Fill(int a_DataTypes, BLOCKTYPE a_BlockType, NIBBLETYPE a_Block
 		a_DataTypes = a_DataTypes & GetDataTypes();
 	}
 	
+	// In the packed mode, each byte holds the nibble twice:
+	if (m_AreNibblesPacked)
+	{
+		a_BlockMeta     = static_cast<NIBBLETYPE>((a_BlockMeta     & 0x0f) * 0x11);
+		a_BlockLight    = static_cast<NIBBLETYPE>((a_BlockLight    & 0x0f) * 0x11);
+		a_BlockSkyLight = static_cast<NIBBLETYPE>((a_BlockSkyLight & 0x0f) * 0x11);
+	}
+	
 	size_t BlockCount = GetBlockCount();
+	size_t NibbleCount = GetNibbleArraySize();
 	if ((a_DataTypes & baTypes) != 0)
 	{
-		for (size_t i = 0; i < BlockCount; i++)
-		{
-			m_BlockTypes[i] = a_BlockType;
-		}
+		memset(m_BlockTypes, a_BlockType, BlockCount * sizeof(BLOCKTYPE));
 	}
 	if ((a_DataTypes & baMetas) != 0)
 	{
-		for (size_t i = 0; i < BlockCount; i++)
-		{
-			m_BlockMetas[i] = a_BlockMeta;
-		}
+		memset(m_BlockMetas, a_BlockMeta, NibbleCount * sizeof(NIBBLETYPE));
 	}
 	if ((a_DataTypes & baLight) != 0)
 	{
-		for (size_t i = 0; i < BlockCount; i++)
-		{
-			m_BlockLight[i] = a_BlockLight;
-		}
+		memset(m_BlockLight, a_BlockLight, NibbleCount * sizeof(NIBBLETYPE));
 	}
 	if ((a_DataTypes & baSkyLight) != 0)
 	{
-		for (size_t i = 0; i < BlockCount; i++)
-		{
-			m_BlockSkyLight[i] = a_BlockSkyLight;
-		}
+		memset(m_BlockSkyLight, a_BlockSkyLight, NibbleCount * sizeof(NIBBLETYPE));
 	}
 }
 
@@ -814,6 +960,7 @@ void cBlockArea::FillRelCuboid(int a_MinRelX, int a_MaxRelX, int a_MinRelY, int
 		a_DataTypes = a_DataTypes & GetDataTypes();
 	}
 	
+	cUnpackedNibblesScope Unpacked(*this);
 	if ((a_DataTypes & baTypes) != 0)
 	{
 		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++) for (int x = a_MinRelX; x <= a_MaxRelX; x++)
@@ -1013,24 +1160,13 @@ void cBlockArea::RotateCCW(void)
 		return;
 	}
 	
-	// We are guaranteed that both blocktypes and blockmetas exist; rotate both at the same time:
+	// We are guaranteed that both blocktypes and blockmetas exist; rotate both, then rotate the metas themselves:
+	cUnpackedNibblesScope Unpacked(*this);
 	BLOCKTYPE * NewTypes = new BLOCKTYPE[GetBlockCount()];
 	NIBBLETYPE * NewMetas = new NIBBLETYPE[GetBlockCount()];
-	for (int x = 0; x < m_Size.x; x++)
-	{
-		int NewZ = m_Size.x - x - 1;
-		for (int z = 0; z < m_Size.z; z++)
-		{
-			int NewX = z;
-			for (int y = 0; y < m_Size.y; y++)
-			{
-				int NewIdx = NewX + NewZ * m_Size.z + y * m_Size.x * m_Size.z;
-				int OldIdx = MakeIndex(x, y, z);
-				NewTypes[NewIdx] = m_BlockTypes[OldIdx];
-				NewMetas[NewIdx] = BlockHandler(m_BlockTypes[OldIdx])->MetaRotateCCW(m_BlockMetas[OldIdx]);
-			}  // for y
-		}  // for z
-	}  // for x
+	cBlockAreaKernels::RotateCCW(NewTypes, m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::RotateCCW(NewMetas, m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::TransformMetas(NewTypes, NewMetas, GetBlockCount(), GetMetaTable(mtRotateCCW));
 	std::swap(m_BlockTypes, NewTypes);
 	std::swap(m_BlockMetas, NewMetas);
 	delete[] NewTypes;   NewTypes = nullptr;
@@ -1058,24 +1194,13 @@ void cBlockArea::RotateCW(void)
 		return;
 	}
 	
-	// We are guaranteed that both blocktypes and blockmetas exist; rotate both at the same time:
+	// We are guaranteed that both blocktypes and blockmetas exist; rotate both, then rotate the metas themselves:
+	cUnpackedNibblesScope Unpacked(*this);
 	BLOCKTYPE * NewTypes = new BLOCKTYPE[GetBlockCount()];
 	NIBBLETYPE * NewMetas = new NIBBLETYPE[GetBlockCount()];
-	for (int x = 0; x < m_Size.x; x++)
-	{
-		int NewZ = x;
-		for (int z = 0; z < m_Size.z; z++)
-		{
-			int NewX = m_Size.z - z - 1;
-			for (int y = 0; y < m_Size.y; y++)
-			{
-				int NewIdx = NewX + NewZ * m_Size.z + y * m_Size.x * m_Size.z;
-				int OldIdx = MakeIndex(x, y, z);
-				NewTypes[NewIdx] = m_BlockTypes[OldIdx];
-				NewMetas[NewIdx] = BlockHandler(m_BlockTypes[OldIdx])->MetaRotateCW(m_BlockMetas[OldIdx]);
-			}  // for y
-		}  // for z
-	}  // for x
+	cBlockAreaKernels::RotateCW(NewTypes, m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::RotateCW(NewMetas, m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::TransformMetas(NewTypes, NewMetas, GetBlockCount(), GetMetaTable(mtRotateCW));
 	std::swap(m_BlockTypes, NewTypes);
 	std::swap(m_BlockMetas, NewMetas);
 	delete[] NewTypes;   NewTypes = nullptr;
@@ -1103,25 +1228,11 @@ void cBlockArea::MirrorXY(void)
 		return;
 	}
 
-	// We are guaranteed that both blocktypes and blockmetas exist; mirror both at the same time:
-	int HalfZ = m_Size.z / 2;
-	int MaxZ = m_Size.z - 1;
-	for (int y = 0; y < m_Size.y; y++)
-	{
-		for (int z = 0; z < HalfZ; z++)
-		{
-			for (int x = 0; x < m_Size.x; x++)
-			{
-				int Idx1 = MakeIndex(x, y, z);
-				int Idx2 = MakeIndex(x, y, MaxZ - z);
-				std::swap(m_BlockTypes[Idx1], m_BlockTypes[Idx2]);
-				NIBBLETYPE Meta1 = BlockHandler(m_BlockTypes[Idx2])->MetaMirrorXY(m_BlockMetas[Idx1]);
-				NIBBLETYPE Meta2 = BlockHandler(m_BlockTypes[Idx1])->MetaMirrorXY(m_BlockMetas[Idx2]);
-				m_BlockMetas[Idx1] = Meta2;
-				m_BlockMetas[Idx2] = Meta1;
-			}  // for x
-		}  // for z
-	}  // for y
+	// We are guaranteed that both blocktypes and blockmetas exist; mirror both, then mirror all the metas themselves:
+	cUnpackedNibblesScope Unpacked(*this);
+	cBlockAreaKernels::MirrorXY(m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::MirrorXY(m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::TransformMetas(m_BlockTypes, m_BlockMetas, GetBlockCount(), GetMetaTable(mtMirrorXY));
 }
 
 
@@ -1135,7 +1246,7 @@ void cBlockArea::MirrorXZ(void)
 		LOGWARNING("cBlockArea: Cannot mirror meta without blocktypes!");
 		return;
 	}
-
+	
 	if (!HasBlockMetas())
 	{
 		// There are no blockmetas to mirror, just use the NoMeta function
@@ -1143,25 +1254,11 @@ void cBlockArea::MirrorXZ(void)
 		return;
 	}
 
-	// We are guaranteed that both blocktypes and blockmetas exist; mirror both at the same time:
-	int HalfY = m_Size.y / 2;
-	int MaxY = m_Size.y - 1;
-	for (int y = 0; y < HalfY; y++)
-	{
-		for (int z = 0; z < m_Size.z; z++)
-		{
-			for (int x = 0; x < m_Size.x; x++)
-			{
-				int Idx1 = MakeIndex(x, y, z);
-				int Idx2 = MakeIndex(x, MaxY - y, z);
-				std::swap(m_BlockTypes[Idx1], m_BlockTypes[Idx2]);
-				NIBBLETYPE Meta1 = BlockHandler(m_BlockTypes[Idx2])->MetaMirrorXZ(m_BlockMetas[Idx1]);
-				NIBBLETYPE Meta2 = BlockHandler(m_BlockTypes[Idx1])->MetaMirrorXZ(m_BlockMetas[Idx2]);
-				m_BlockMetas[Idx1] = Meta2;
-				m_BlockMetas[Idx2] = Meta1;
-			}  // for x
-		}  // for z
-	}  // for y
+	// We are guaranteed that both blocktypes and blockmetas exist; mirror both, then mirror all the metas themselves:
+	cUnpackedNibblesScope Unpacked(*this);
+	cBlockAreaKernels::MirrorXZ(m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::MirrorXZ(m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::TransformMetas(m_BlockTypes, m_BlockMetas, GetBlockCount(), GetMetaTable(mtMirrorXZ));
 }
 
 
@@ -1175,7 +1272,7 @@ void cBlockArea::MirrorYZ(void)
 		LOGWARNING("cBlockArea: Cannot mirror meta without blocktypes!");
 		return;
 	}
-
+	
 	if (!HasBlockMetas())
 	{
 		// There are no blockmetas to mirror, just use the NoMeta function
@@ -1183,25 +1280,11 @@ void cBlockArea::MirrorYZ(void)
 		return;
 	}
 
-	// We are guaranteed that both blocktypes and blockmetas exist; mirror both at the same time:
-	int HalfX = m_Size.x / 2;
-	int MaxX = m_Size.x - 1;
-	for (int y = 0; y < m_Size.y; y++)
-	{
-		for (int z = 0; z < m_Size.z; z++)
-		{
-			for (int x = 0; x < HalfX; x++)
-			{
-				int Idx1 = MakeIndex(x, y, z);
-				int Idx2 = MakeIndex(MaxX - x, y, z);
-				std::swap(m_BlockTypes[Idx1], m_BlockTypes[Idx2]);
-				NIBBLETYPE Meta1 = BlockHandler(m_BlockTypes[Idx2])->MetaMirrorYZ(m_BlockMetas[Idx1]);
-				NIBBLETYPE Meta2 = BlockHandler(m_BlockTypes[Idx1])->MetaMirrorYZ(m_BlockMetas[Idx2]);
-				m_BlockMetas[Idx1] = Meta2;
-				m_BlockMetas[Idx2] = Meta1;
-			}  // for x
-		}  // for z
-	}  // for y
+	// We are guaranteed that both blocktypes and blockmetas exist; mirror both, then mirror all the metas themselves:
+	cUnpackedNibblesScope Unpacked(*this);
+	cBlockAreaKernels::MirrorYZ(m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::MirrorYZ(m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	cBlockAreaKernels::TransformMetas(m_BlockTypes, m_BlockMetas, GetBlockCount(), GetMetaTable(mtMirrorYZ));
 }
 
 
@@ -1210,39 +1293,18 @@ void cBlockArea::MirrorYZ(void)
 
 void cBlockArea::RotateCCWNoMeta(void)
 {
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
 		BLOCKTYPE * NewTypes = new BLOCKTYPE[GetBlockCount()];
-		for (int x = 0; x < m_Size.x; x++)
-		{
-			int NewZ = m_Size.x - x - 1;
-			for (int z = 0; z < m_Size.z; z++)
-			{
-				int NewX = z;
-				for (int y = 0; y < m_Size.y; y++)
-				{
-					NewTypes[NewX + NewZ * m_Size.z + y * m_Size.x * m_Size.z] = m_BlockTypes[MakeIndex(x, y, z)];
-				}  // for y
-			}  // for z
-		}  // for x
+		cBlockAreaKernels::RotateCCW(NewTypes, m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
 		std::swap(m_BlockTypes, NewTypes);
 		delete[] NewTypes;   NewTypes = nullptr;
 	}
 	if (HasBlockMetas())
 	{
 		NIBBLETYPE * NewMetas = new NIBBLETYPE[GetBlockCount()];
-		for (int x = 0; x < m_Size.x; x++)
-		{
-			int NewZ = m_Size.x - x - 1;
-			for (int z = 0; z < m_Size.z; z++)
-			{
-				int NewX = z;
-				for (int y = 0; y < m_Size.y; y++)
-				{
-					NewMetas[NewX + NewZ * m_Size.z + y * m_Size.x * m_Size.z] = m_BlockMetas[MakeIndex(x, y, z)];
-				}  // for y
-			}  // for z
-		}  // for x
+		cBlockAreaKernels::RotateCCW(NewMetas, m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
 		std::swap(m_BlockMetas, NewMetas);
 		delete[] NewMetas;   NewMetas = nullptr;
 	}
@@ -1255,39 +1317,18 @@ void cBlockArea::RotateCCWNoMeta(void)
 
 void cBlockArea::RotateCWNoMeta(void)
 {
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
 		BLOCKTYPE * NewTypes = new BLOCKTYPE[GetBlockCount()];
-		for (int z = 0; z < m_Size.z; z++)
-		{
-			int NewX = m_Size.z - z - 1;
-			for (int x = 0; x < m_Size.x; x++)
-			{
-				int NewZ = x;
-				for (int y = 0; y < m_Size.y; y++)
-				{
-					NewTypes[NewX + NewZ * m_Size.z + y * m_Size.x * m_Size.z] = m_BlockTypes[MakeIndex(x, y, z)];
-				}  // for y
-			}  // for x
-		}  // for z
+		cBlockAreaKernels::RotateCW(NewTypes, m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
 		std::swap(m_BlockTypes, NewTypes);
 		delete[] NewTypes;   NewTypes = nullptr;
 	}
 	if (HasBlockMetas())
 	{
 		NIBBLETYPE * NewMetas = new NIBBLETYPE[GetBlockCount()];
-		for (int z = 0; z < m_Size.z; z++)
-		{
-			int NewX = m_Size.z - z - 1;
-			for (int x = 0; x < m_Size.x; x++)
-			{
-				int NewZ = x;
-				for (int y = 0; y < m_Size.y; y++)
-				{
-					NewMetas[NewX + NewZ * m_Size.z + y * m_Size.x * m_Size.z] = m_BlockMetas[MakeIndex(x, y, z)];
-				}  // for y
-			}  // for x
-		}  // for z
+		cBlockAreaKernels::RotateCW(NewMetas, m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
 		std::swap(m_BlockMetas, NewMetas);
 		delete[] NewMetas;   NewMetas = nullptr;
 	}
@@ -1300,35 +1341,15 @@ void cBlockArea::RotateCWNoMeta(void)
 
 void cBlockArea::MirrorXYNoMeta(void)
 {
-	int HalfZ = m_Size.z / 2;
-	int MaxZ = m_Size.z - 1;
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
-		for (int y = 0; y < m_Size.y; y++)
-		{
-			for (int z = 0; z < HalfZ; z++)
-			{
-				for (int x = 0; x < m_Size.x; x++)
-				{
-					std::swap(m_BlockTypes[MakeIndex(x, y, z)], m_BlockTypes[MakeIndex(x, y, MaxZ - z)]);
-				}  // for x
-			}  // for z
-		}  // for y
-	}  // if (HasBlockTypes)
-	
+		cBlockAreaKernels::MirrorXY(m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	}
 	if (HasBlockMetas())
 	{
-		for (int y = 0; y < m_Size.y; y++)
-		{
-			for (int z = 0; z < HalfZ; z++)
-			{
-				for (int x = 0; x < m_Size.x; x++)
-				{
-					std::swap(m_BlockMetas[MakeIndex(x, y, z)], m_BlockMetas[MakeIndex(x, y, MaxZ - z)]);
-				}  // for x
-			}  // for z
-		}  // for y
-	}  // if (HasBlockMetas)
+		cBlockAreaKernels::MirrorXY(m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	}
 }
 
 
@@ -1337,35 +1358,15 @@ void cBlockArea::MirrorXYNoMeta(void)
 
 void cBlockArea::MirrorXZNoMeta(void)
 {
-	int HalfY = m_Size.y / 2;
-	int MaxY = m_Size.y - 1;
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
-		for (int y = 0; y < HalfY; y++)
-		{
-			for (int z = 0; z < m_Size.z; z++)
-			{
-				for (int x = 0; x < m_Size.x; x++)
-				{
-					std::swap(m_BlockTypes[MakeIndex(x, y, z)], m_BlockTypes[MakeIndex(x, MaxY - y, z)]);
-				}  // for x
-			}  // for z
-		}  // for y
-	}  // if (HasBlockTypes)
-	
+		cBlockAreaKernels::MirrorXZ(m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	}
 	if (HasBlockMetas())
 	{
-		for (int y = 0; y < HalfY; y++)
-		{
-			for (int z = 0; z < m_Size.z; z++)
-			{
-				for (int x = 0; x < m_Size.x; x++)
-				{
-					std::swap(m_BlockMetas[MakeIndex(x, y, z)], m_BlockMetas[MakeIndex(x, MaxY - y, z)]);
-				}  // for x
-			}  // for z
-		}  // for y
-	}  // if (HasBlockMetas)
+		cBlockAreaKernels::MirrorXZ(m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	}
 }
 
 
@@ -1374,35 +1375,70 @@ void cBlockArea::MirrorXZNoMeta(void)
 
 void cBlockArea::MirrorYZNoMeta(void)
 {
-	int HalfX = m_Size.x / 2;
-	int MaxX = m_Size.x - 1;
+	cUnpackedNibblesScope Unpacked(*this);
 	if (HasBlockTypes())
 	{
-		for (int y = 0; y < m_Size.y; y++)
-		{
-			for (int z = 0; z < m_Size.z; z++)
-			{
-				for (int x = 0; x < HalfX; x++)
-				{
-					std::swap(m_BlockTypes[MakeIndex(x, y, z)], m_BlockTypes[MakeIndex(MaxX - x, y, z)]);
-				}  // for x
-			}  // for z
-		}  // for y
-	}  // if (HasBlockTypes)
-	
+		cBlockAreaKernels::MirrorYZ(m_BlockTypes, m_Size.x, m_Size.y, m_Size.z);
+	}
 	if (HasBlockMetas())
 	{
-		for (int y = 0; y < m_Size.y; y++)
+		cBlockAreaKernels::MirrorYZ(m_BlockMetas, m_Size.x, m_Size.y, m_Size.z);
+	}
+}
+
+
+
+
+
+void cBlockArea::PackNibbles(void)
+{
+	if (m_AreNibblesPacked)
+	{
+		return;
+	}
+	size_t BlockCount = GetBlockCount();
+	size_t PackedCount = (BlockCount + 1) / 2;
+	NIBBLEARRAY * Arrays[] = { &m_BlockMetas, &m_BlockLight, &m_BlockSkyLight };
+	for (size_t i = 0; i < ARRAYCOUNT(Arrays); i++)
+	{
+		NIBBLEARRAY & Array = *Arrays[i];
+		if (Array == nullptr)
 		{
-			for (int z = 0; z < m_Size.z; z++)
-			{
-				for (int x = 0; x < HalfX; x++)
-				{
-					std::swap(m_BlockMetas[MakeIndex(x, y, z)], m_BlockMetas[MakeIndex(MaxX - x, y, z)]);
-				}  // for x
-			}  // for z
-		}  // for y
-	}  // if (HasBlockMetas)
+			continue;
+		}
+		NIBBLETYPE * Packed = new NIBBLETYPE[PackedCount];
+		cBlockAreaKernels::PackNibbles(Packed, Array, BlockCount);
+		delete[] Array;
+		Array = Packed;
+	}
+	m_AreNibblesPacked = true;
+}
+
+
+
+
+
+void cBlockArea::UnpackNibbles(void)
+{
+	if (!m_AreNibblesPacked)
+	{
+		return;
+	}
+	size_t BlockCount = GetBlockCount();
+	NIBBLEARRAY * Arrays[] = { &m_BlockMetas, &m_BlockLight, &m_BlockSkyLight };
+	for (size_t i = 0; i < ARRAYCOUNT(Arrays); i++)
+	{
+		NIBBLEARRAY & Array = *Arrays[i];
+		if (Array == nullptr)
+		{
+			continue;
+		}
+		NIBBLETYPE * Unpacked = new NIBBLETYPE[BlockCount];
+		cBlockAreaKernels::UnpackNibbles(Unpacked, Array, 0, BlockCount);
+		delete[] Array;
+		Array = Unpacked;
+	}
+	m_AreNibblesPacked = false;
 }
 
 
@@ -1589,7 +1625,7 @@ void cBlockArea::SetRelBlockTypeMeta(int a_RelX,   int a_RelY,   int a_RelZ,   B
 	}
 	else
 	{
-		m_BlockMetas[idx] = a_BlockMeta;
+		SetNibbleAt(m_BlockMetas, idx, a_BlockMeta);
 	}
 }
 
@@ -1626,7 +1662,7 @@ void cBlockArea::GetRelBlockTypeMeta(int a_RelX, int a_RelY, int a_RelZ, BLOCKTY
 	}
 	else
 	{
-		a_BlockMeta = m_BlockMetas[idx];
+		a_BlockMeta = GetNibbleAt(m_BlockMetas, idx);
 	}
 }
 
@@ -1762,9 +1798,11 @@ bool cBlockArea::SetSize(int a_SizeX, int a_SizeY, int a_SizeZ, int a_DataTypes)
 {
 	ASSERT(m_BlockTypes == nullptr);  // Has been cleared
 	
+	size_t BlockCount = static_cast<size_t>(a_SizeX * a_SizeY * a_SizeZ);
+	size_t NibbleCount = m_AreNibblesPacked ? (BlockCount + 1) / 2 : BlockCount;
 	if (a_DataTypes & baTypes)
 	{
-		m_BlockTypes = new BLOCKTYPE[a_SizeX * a_SizeY * a_SizeZ];
+		m_BlockTypes = new BLOCKTYPE[BlockCount];
 		if (m_BlockTypes == nullptr)
 		{
 			return false;
@@ -1772,7 +1810,7 @@ bool cBlockArea::SetSize(int a_SizeX, int a_SizeY, int a_SizeZ, int a_DataTypes)
 	}
 	if (a_DataTypes & baMetas)
 	{
-		m_BlockMetas = new NIBBLETYPE[a_SizeX * a_SizeY * a_SizeZ];
+		m_BlockMetas = new NIBBLETYPE[NibbleCount];
 		if (m_BlockMetas == nullptr)
 		{
 			delete[] m_BlockTypes;
@@ -1782,7 +1820,7 @@ bool cBlockArea::SetSize(int a_SizeX, int a_SizeY, int a_SizeZ, int a_DataTypes)
 	}
 	if (a_DataTypes & baLight)
 	{
-		m_BlockLight = new NIBBLETYPE[a_SizeX * a_SizeY * a_SizeZ];
+		m_BlockLight = new NIBBLETYPE[NibbleCount];
 		if (m_BlockLight == nullptr)
 		{
 			delete[] m_BlockMetas;
@@ -1794,7 +1832,7 @@ bool cBlockArea::SetSize(int a_SizeX, int a_SizeY, int a_SizeZ, int a_DataTypes)
 	}
 	if (a_DataTypes & baSkyLight)
 	{
-		m_BlockSkyLight = new NIBBLETYPE[a_SizeX * a_SizeY * a_SizeZ];
+		m_BlockSkyLight = new NIBBLETYPE[NibbleCount];
 		if (m_BlockSkyLight == nullptr)
 		{
 			delete[] m_BlockLight;
@@ -1837,7 +1875,7 @@ void cBlockArea::SetRelNibble(int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_V
 		LOGWARNING("cBlockArea: datatype has not been read!");
 		return;
 	}
-	a_Array[MakeIndex(a_RelX, a_RelY, a_RelZ)] = a_Value;
+	SetNibbleAt(a_Array, MakeIndex(a_RelX, a_RelY, a_RelZ), a_Value);
 }
 
 
@@ -1860,7 +1898,7 @@ NIBBLETYPE cBlockArea::GetRelNibble(int a_RelX, int a_RelY, int a_RelZ, NIBBLETY
 		LOGWARNING("cBlockArea: datatype has not been read!");
 		return 16;
 	}
-	return a_Array[MakeIndex(a_RelX, a_RelY, a_RelZ)];
+	return GetNibbleAt(a_Array, MakeIndex(a_RelX, a_RelY, a_RelZ));
 }
 
 
@@ -1892,64 +1930,118 @@ cBlockArea::cChunkReader::cChunkReader(cBlockArea & a_Area) :
 
 
 
-void cBlockArea::cChunkReader::CopyNibbles(NIBBLETYPE * a_AreaDst, const NIBBLETYPE * a_ChunkSrc)
+void cBlockArea::cChunkReader::FillArea(void)
 {
-	int SizeY = m_Area.m_Size.y;
-	int MinY = m_Origin.y;
-	
-	// SizeX, SizeZ are the dmensions of the block data to copy from the current chunk (size of the geometric union)
-	// OffX, OffZ are the offsets of the current chunk data from the area origin
-	// BaseX, BaseZ are the offsets of the area data within the current chunk from the chunk borders
-	int SizeX = cChunkDef::Width;
-	int SizeZ = cChunkDef::Width;
-	int OffX, OffZ;
-	int BaseX, BaseZ;
-	OffX = m_CurrentChunkX * cChunkDef::Width - m_Origin.x;
-	if (OffX < 0)
-	{
-		BaseX = -OffX;
-		SizeX += OffX;  // SizeX is decreased, OffX is negative
-		OffX = 0;
-	}
-	else
+	// Each snapshot covers a different part of the area, so they can be expanded in parallel without any locking:
+	unsigned NumThreads = 1;
+	if (m_Snapshots.size() >= PARALLEL_FILL_MIN_SECTIONS)
 	{
-		BaseX = 0;
+		NumThreads = Clamp(std::thread::hardware_concurrency(), 1U, MAX_FILL_THREADS);
 	}
-	OffZ = m_CurrentChunkZ * cChunkDef::Width - m_Origin.z;
-	if (OffZ < 0)
+	std::atomic<size_t> NextSnapshot(0);
+	auto Worker = [this, &NextSnapshot]()
 	{
-		BaseZ = -OffZ;
-		SizeZ += OffZ;  // SizeZ is decreased, OffZ is negative
-		OffZ = 0;
-	}
-	else
+		for (;;)
+		{
+			size_t Idx = NextSnapshot++;
+			if (Idx >= m_Snapshots.size())
+			{
+				return;
+			}
+			FillSection(m_Snapshots[Idx]);
+		}
+	};
+	std::vector<std::thread> Threads;
+	Threads.reserve(NumThreads - 1);
+	for (unsigned i = 1; i < NumThreads; i++)
 	{
-		BaseZ = 0;
+		try
+		{
+			Threads.emplace_back(Worker);
+		}
+		catch (const std::system_error & exc)
+		{
+			// The system is out of threads, the ones already started (or the calling thread alone) fill the rest:
+			LOGD("%s: Cannot start a fill thread (%s), continuing with %u threads", __FUNCTION__, exc.what(), i);
+			break;
+		}
 	}
-	// If the chunk extends beyond the area in the X or Z axis, cut off the Size:
-	if ((m_CurrentChunkX + 1) * cChunkDef::Width > m_Origin.x + m_Area.m_Size.x)
+	Worker();
+	for (auto & Thread : Threads)
 	{
-		SizeX -= (m_CurrentChunkX + 1) * cChunkDef::Width - (m_Origin.x + m_Area.m_Size.x);
+		Thread.join();
 	}
-	if ((m_CurrentChunkZ + 1) * cChunkDef::Width > m_Origin.z + m_Area.m_Size.z)
+	m_Snapshots.clear();
+}
+
+
+
+
+
+void cBlockArea::cChunkReader::FillSection(const sSectionSnapshot & a_Snapshot)
+{
+	const int SectionHeight = static_cast<int>(cChunkData::SectionHeight);
+
+	// The intersection of the area and the section, in area-relative coords:
+	int ChunkOffX = a_Snapshot.m_ChunkX * cChunkDef::Width - m_Origin.x;
+	int ChunkOffZ = a_Snapshot.m_ChunkZ * cChunkDef::Width - m_Origin.z;
+	int SectionOffY = a_Snapshot.m_SectionY * SectionHeight - m_Origin.y;
+	int AreaMinX = std::max(ChunkOffX, 0);
+	int AreaMaxX = std::min(ChunkOffX + static_cast<int>(cChunkDef::Width), m_Area.m_Size.x);
+	int AreaMinY = std::max(SectionOffY, 0);
+	int AreaMaxY = std::min(SectionOffY + SectionHeight, m_Area.m_Size.y);
+	int AreaMinZ = std::max(ChunkOffZ, 0);
+	int AreaMaxZ = std::min(ChunkOffZ + static_cast<int>(cChunkDef::Width), m_Area.m_Size.z);
+	int SizeX = AreaMaxX - AreaMinX;
+	if ((SizeX <= 0) || (AreaMinY >= AreaMaxY) || (AreaMinZ >= AreaMaxZ))
 	{
-		SizeZ -= (m_CurrentChunkZ + 1) * cChunkDef::Width - (m_Origin.z + m_Area.m_Size.z);
+		return;
 	}
 
-	for (int y = 0; y < SizeY; y++)
+	const sSectionData * Section = a_Snapshot.m_Data.get();
+	for (int y = AreaMinY; y < AreaMaxY; y++)
 	{
-		int ChunkY = MinY + y;
-		int AreaY = y;
-		for (int z = 0; z < SizeZ; z++)
+		for (int z = AreaMinZ; z < AreaMaxZ; z++)
 		{
-			int ChunkZ = BaseZ + z;
-			int AreaZ = OffZ + z;
-			for (int x = 0; x < SizeX; x++)
+			int AreaIdx = m_Area.MakeIndex(AreaMinX, y, z);
+			int SectionIdx = cChunkDef::MakeIndexNoCheck(AreaMinX - ChunkOffX, y - SectionOffY, z - ChunkOffZ);
+			if (Section == nullptr)
 			{
-				int ChunkX = BaseX + x;
-				int AreaX = OffX + x;
-				a_AreaDst[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = cChunkDef::GetNibble(a_ChunkSrc, ChunkX, ChunkY, ChunkZ);
-			}  // for x
+				// An unallocated section is all air, dark, with full skylight:
+				if (m_Area.m_BlockTypes != nullptr)
+				{
+					memset(m_Area.m_BlockTypes + AreaIdx, E_BLOCK_AIR, static_cast<size_t>(SizeX));
+				}
+				if (m_Area.m_BlockMetas != nullptr)
+				{
+					memset(m_Area.m_BlockMetas + AreaIdx, 0, static_cast<size_t>(SizeX));
+				}
+				if (m_Area.m_BlockLight != nullptr)
+				{
+					memset(m_Area.m_BlockLight + AreaIdx, 0, static_cast<size_t>(SizeX));
+				}
+				if (m_Area.m_BlockSkyLight != nullptr)
+				{
+					memset(m_Area.m_BlockSkyLight + AreaIdx, 0x0f, static_cast<size_t>(SizeX));
+				}
+				continue;
+			}
+			if (m_Area.m_BlockTypes != nullptr)
+			{
+				memcpy(m_Area.m_BlockTypes + AreaIdx, Section->m_BlockTypes.data() + SectionIdx, static_cast<size_t>(SizeX));
+			}
+			if (m_Area.m_BlockMetas != nullptr)
+			{
+				cBlockAreaKernels::UnpackNibbles(m_Area.m_BlockMetas + AreaIdx, Section->m_BlockMetas.data(), static_cast<size_t>(SectionIdx), static_cast<size_t>(SizeX));
+			}
+			if (m_Area.m_BlockLight != nullptr)
+			{
+				cBlockAreaKernels::UnpackNibbles(m_Area.m_BlockLight + AreaIdx, Section->m_BlockLight.data(), static_cast<size_t>(SectionIdx), static_cast<size_t>(SizeX));
+			}
+			if (m_Area.m_BlockSkyLight != nullptr)
+			{
+				cBlockAreaKernels::UnpackNibbles(m_Area.m_BlockSkyLight + AreaIdx, Section->m_BlockSkyLight.data(), static_cast<size_t>(SectionIdx), static_cast<size_t>(SizeX));
+			}
 		}  // for z
 	}  // for y
 }
@@ -1971,130 +2063,39 @@ bool cBlockArea::cChunkReader::Coords(int a_ChunkX, int a_ChunkZ)
 
 void cBlockArea::cChunkReader::ChunkData(const cChunkData & a_BlockBuffer)
 {
-	int SizeY = m_Area.m_Size.y;
-	int MinY = m_Origin.y;
-
-	// SizeX, SizeZ are the dimensions of the block data to copy from the current chunk (size of the geometric union)
-	// OffX, OffZ are the offsets of the current chunk data from the area origin
-	// BaseX, BaseZ are the offsets of the area data within the current chunk from the chunk borders
-	int SizeX = cChunkDef::Width;
-	int SizeZ = cChunkDef::Width;
-	int OffX, OffZ;
-	int BaseX, BaseZ;
-	OffX = m_CurrentChunkX * cChunkDef::Width - m_Origin.x;
-	if (OffX < 0)
-	{
-		BaseX = -OffX;
-		SizeX += OffX;  // SizeX is decreased, OffX is negative
-		OffX = 0;
-	}
-	else
-	{
-		BaseX = 0;
-	}
-	OffZ = m_CurrentChunkZ * cChunkDef::Width - m_Origin.z;
-	if (OffZ < 0)
-	{
-		BaseZ = -OffZ;
-		SizeZ += OffZ;  // SizeZ is decreased, OffZ is negative
-		OffZ = 0;
-	}
-	else
-	{
-		BaseZ = 0;
-	}
-	// If the chunk extends beyond the area in the X or Z axis, cut off the Size:
-	if ((m_CurrentChunkX + 1) * cChunkDef::Width > m_Origin.x + m_Area.m_Size.x)
-	{
-		SizeX -= (m_CurrentChunkX + 1) * cChunkDef::Width - (m_Origin.x + m_Area.m_Size.x);
-	}
-	if ((m_CurrentChunkZ + 1) * cChunkDef::Width > m_Origin.z + m_Area.m_Size.z)
-	{
-		SizeZ -= (m_CurrentChunkZ + 1) * cChunkDef::Width - (m_Origin.z + m_Area.m_Size.z);
-	}
-	
-	// Copy the blocktypes:
-	if (m_Area.m_BlockTypes != nullptr)
-	{
-		for (int y = 0; y < SizeY; y++)
-		{
-			int InChunkY = MinY + y;
-			int AreaY = y;
-			for (int z = 0; z < SizeZ; z++)
+	// Only snapshot the sections here, the chunkmap is locked; the area is filled in FillArea() later on:
+	const int SectionHeight = static_cast<int>(cChunkData::SectionHeight);
+	int MinSection = m_Origin.y / SectionHeight;
+	int MaxSection = (m_Origin.y + m_Area.m_Size.y - 1) / SectionHeight;
+	for (int SectionY = MinSection; SectionY <= MaxSection; SectionY++)
+	{
+		sSectionSnapshot Snapshot;
+		Snapshot.m_ChunkX = m_CurrentChunkX;
+		Snapshot.m_ChunkZ = m_CurrentChunkZ;
+		Snapshot.m_SectionY = SectionY;
+		const cChunkData::sChunkSection * Section = a_BlockBuffer.GetSection(static_cast<size_t>(SectionY));
+		if (Section != nullptr)
+		{
+			// Copy only the arrays that the area has:
+			Snapshot.m_Data = std::make_shared<sSectionData>();
+			if (m_Area.m_BlockTypes != nullptr)
 			{
-				int InChunkZ = BaseZ + z;
-				int AreaZ = OffZ + z;
-				for (int x = 0; x < SizeX; x++)
-				{
-					int InChunkX = BaseX + x;
-					int AreaX = OffX + x;
-					m_Area.m_BlockTypes[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = a_BlockBuffer.GetBlock(InChunkX, InChunkY, InChunkZ);
-				}  // for x
-			}  // for z
-		}  // for y
-	}
-
-	// Copy the block metas:
-	if (m_Area.m_BlockMetas != nullptr)
-	{
-		for (int y = 0; y < SizeY; y++)
-		{
-			int InChunkY = MinY + y;
-			int AreaY = y;
-			for (int z = 0; z < SizeZ; z++)
+				Snapshot.m_Data->m_BlockTypes.assign(Section->m_BlockTypes, Section->m_BlockTypes + ARRAYCOUNT(Section->m_BlockTypes));
+			}
+			if (m_Area.m_BlockMetas != nullptr)
 			{
-				int InChunkZ = BaseZ + z;
-				int AreaZ = OffZ + z;
-				for (int x = 0; x < SizeX; x++)
-				{
-					int InChunkX = BaseX + x;
-					int AreaX = OffX + x;
-					m_Area.m_BlockMetas[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = a_BlockBuffer.GetMeta(InChunkX, InChunkY, InChunkZ);
-				}  // for x
-			}  // for z
-		}  // for y
-	}
-
-	// Copy the blocklight:
-	if (m_Area.m_BlockLight != nullptr)
-	{
-		for (int y = 0; y < SizeY; y++)
-		{
-			int InChunkY = MinY + y;
-			int AreaY = y;
-			for (int z = 0; z < SizeZ; z++)
+				Snapshot.m_Data->m_BlockMetas.assign(Section->m_BlockMetas, Section->m_BlockMetas + ARRAYCOUNT(Section->m_BlockMetas));
+			}
+			if (m_Area.m_BlockLight != nullptr)
 			{
-				int InChunkZ = BaseZ + z;
-				int AreaZ = OffZ + z;
-				for (int x = 0; x < SizeX; x++)
-				{
-					int InChunkX = BaseX + x;
-					int AreaX = OffX + x;
-					m_Area.m_BlockLight[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = a_BlockBuffer.GetBlockLight(InChunkX, InChunkY, InChunkZ);
-				}  // for x
-			}  // for z
-		}  // for y
-	}
-
-	// Copy the skylight:
-	if (m_Area.m_BlockSkyLight != nullptr)
-	{
-		for (int y = 0; y < SizeY; y++)
-		{
-			int InChunkY = MinY + y;
-			int AreaY = y;
-			for (int z = 0; z < SizeZ; z++)
+				Snapshot.m_Data->m_BlockLight.assign(Section->m_BlockLight, Section->m_BlockLight + ARRAYCOUNT(Section->m_BlockLight));
+			}
+			if (m_Area.m_BlockSkyLight != nullptr)
 			{
-				int InChunkZ = BaseZ + z;
-				int AreaZ = OffZ + z;
-				for (int x = 0; x < SizeX; x++)
-				{
-					int InChunkX = BaseX + x;
-					int AreaX = OffX + x;
-					m_Area.m_BlockSkyLight[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = a_BlockBuffer.GetSkyLight(InChunkX, InChunkY, InChunkZ);
-				}  // for x
-			}  // for z
-		}  // for y
+				Snapshot.m_Data->m_BlockSkyLight.assign(Section->m_BlockSkyLight, Section->m_BlockSkyLight + ARRAYCOUNT(Section->m_BlockSkyLight));
+			}
+		}
+		m_Snapshots.push_back(Snapshot);
 	}
 }
 
@@ -2119,7 +2120,7 @@ void cBlockArea::CropBlockTypes(int a_AddMinX, int a_SubMaxX, int a_AddMinY, int
 			}  // for x
 		}  // for z
 	}  // for y
-	delete m_BlockTypes;
+	delete[] m_BlockTypes;
 	m_BlockTypes = NewBlockTypes;
 }
 
@@ -2144,7 +2145,7 @@ void cBlockArea::CropNibbles(NIBBLEARRAY & a_Array, int a_AddMinX, int a_SubMaxX
 			}  // for x
 		}  // for z
 	}  // for y
-	delete a_Array;
+	delete[] a_Array;
 	a_Array = NewNibbles;
 }
 
@@ -2174,7 +2175,7 @@ void cBlockArea::ExpandBlockTypes(int a_SubMinX, int a_AddMaxX, int a_SubMinY, i
 			}  // for x
 		}  // for z
 	}  // for y
-	delete m_BlockTypes;
+	delete[] m_BlockTypes;
 	m_BlockTypes = NewBlockTypes;
 }
 
@@ -2204,7 +2205,7 @@ void cBlockArea::ExpandNibbles(NIBBLEARRAY & a_Array, int a_SubMinX, int a_AddMa
 			}  // for x
 		}  // for z
 	}  // for y
-	delete a_Array;
+	delete[] a_Array;
 	a_Array = NewNibbles;
 }
 
@@ -2225,15 +2226,15 @@ void cBlockArea::RelSetData(
 	}
 	if ((a_DataTypes & baMetas) != 0)
 	{
-		m_BlockMetas[Index] = a_BlockMeta;
+		SetNibbleAt(m_BlockMetas, Index, a_BlockMeta);
 	}
 	if ((a_DataTypes & baLight) != 0)
 	{
-		m_BlockLight[Index] = a_BlockLight;
+		SetNibbleAt(m_BlockLight, Index, a_BlockLight);
 	}
 	if ((a_DataTypes & baSkyLight) != 0)
 	{
-		m_BlockSkyLight[Index] = a_BlockSkyLight;
+		SetNibbleAt(m_BlockSkyLight, Index, a_BlockSkyLight);
 	}
 }
 
@@ -2241,7 +2242,7 @@ void cBlockArea::RelSetData(
 
 
 
-template <bool MetasValid>
+template <bool MetasValid, bool SrcMetasPacked>
 void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_RelZ, eMergeStrategy a_Strategy, const NIBBLETYPE * SrcMetas, NIBBLETYPE * DstMetas)
 {
 	// Block types are compulsory, block metas are optional
@@ -2268,7 +2269,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 	{
 		case cBlockArea::msOverwrite:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorOverwrite<MetasValid> >(
+			InternalOverwriteBlocks<MetasValid, SrcMetasPacked>(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2282,7 +2283,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 		
 		case cBlockArea::msFillAir:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorFillAir<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorFillAir<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2296,7 +2297,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 		
 		case cBlockArea::msImprint:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorImprint<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorImprint<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2310,7 +2311,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 		
 		case cBlockArea::msLake:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorLake<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorLake<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2324,7 +2325,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 		
 		case cBlockArea::msSpongePrint:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorSpongePrint<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorSpongePrint<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2338,7 +2339,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 
 		case cBlockArea::msDifference:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorDifference<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorDifference<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2352,7 +2353,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 		
 		case cBlockArea::msSimpleCompare:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorSimpleCompare<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorSimpleCompare<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -2366,7 +2367,7 @@ void cBlockArea::MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_Rel
 		
 		case cBlockArea::msMask:
 		{
-			InternalMergeBlocks<MetasValid, MergeCombinatorMask<MetasValid> >(
+			InternalMergeBlocks<MetasValid, SrcMetasPacked, MergeCombinatorMask<MetasValid> >(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -4,7 +4,8 @@
 // Interfaces to the cBlockArea object representing an area of block data that can be queried from cWorld and then accessed again without further queries
 // The object also supports writing the blockdata back into cWorld, even into other coords
 
-// NOTE: All Nibble values (meta, blocklight, skylight) are stored one-nibble-per-byte for faster access / editting!
+// NOTE: All Nibble values (meta, blocklight, skylight) are stored one-nibble-per-byte for faster access / editting,
+// unless the area has been switched to the packed mode by PackNibbles()!
 
 
 
@@ -15,6 +16,8 @@
 #include "ForEachChunkProvider.h"
 #include "Vector3.h"
 #include "ChunkDataCallback.h"
+#include "ChunkData.h"
+#include "BlockAreaKernels.h"
 
 
 
@@ -245,6 +248,18 @@ public:
 	/** Mirrors the entire area around the YZ plane, doesn't use blockhandlers for block meta */
 	void MirrorYZNoMeta(void);
 	
+	/** Stores the metas and lights packed two nibbles per byte, halving their memory.
+	Meant for the areas that are kept around for a long time, such as the prefabs and the loaded schematics.
+	The per-block getters and setters, Merge() and CopyTo() work with the packed data directly,
+	the other operations unpack it temporarily. */
+	void PackNibbles(void);
+	
+	/** Stores the metas and lights one nibble per byte again (the default) */
+	void UnpackNibbles(void);
+	
+	/** Returns true if the metas and lights are stored packed two nibbles per byte */
+	bool AreNibblesPacked(void) const { return m_AreNibblesPacked; }
+	
 	// Setters:
 	void SetRelBlockType    (int a_RelX,   int a_RelY,   int a_RelZ,   BLOCKTYPE  a_BlockType);
 	void SetBlockType       (int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE  a_BlockType);
@@ -316,11 +331,12 @@ public:
 	void GetNonAirCropRelCoords(int & a_MinRelX, int & a_MinRelY, int & a_MinRelZ, int & a_MaxRelX, int & a_MaxRelY, int & a_MaxRelZ, BLOCKTYPE a_IgnoreBlockType = E_BLOCK_AIR);
 	
 	// Clients can use these for faster access to all blocktypes. Be careful though!
+	// The nibble arrays can only be accessed while the area is not packed, see UnpackNibbles().
 	/** Returns the internal pointer to the block types */
 	BLOCKTYPE *  GetBlockTypes   (void) const { return m_BlockTypes; }
-	NIBBLETYPE * GetBlockMetas   (void) const { return m_BlockMetas; }     // NOTE: one byte per block!
-	NIBBLETYPE * GetBlockLight   (void) const { return m_BlockLight; }     // NOTE: one byte per block!
-	NIBBLETYPE * GetBlockSkyLight(void) const { return m_BlockSkyLight; }  // NOTE: one byte per block!
+	NIBBLETYPE * GetBlockMetas   (void) const { ASSERT(!m_AreNibblesPacked); return m_BlockMetas; }     // NOTE: one byte per block!
+	NIBBLETYPE * GetBlockLight   (void) const { ASSERT(!m_AreNibblesPacked); return m_BlockLight; }     // NOTE: one byte per block!
+	NIBBLETYPE * GetBlockSkyLight(void) const { ASSERT(!m_AreNibblesPacked); return m_BlockSkyLight; }  // NOTE: one byte per block!
 	size_t       GetBlockCount(void) const { return (size_t)(m_Size.x * m_Size.y * m_Size.z); }
 	int MakeIndex(int a_RelX, int a_RelY, int a_RelZ) const;
 
@@ -328,19 +344,56 @@ protected:
 	friend class cChunkDesc;
 	friend class cSchematicFileSerializer;
 	
+	/** Reads the chunk data into the area in two steps: while the chunks are locked, it only snapshots
+	the chunk sections that the area intersects; FillArea() then expands the snapshots into the area
+	after the lock is released, using several threads for large areas. */
 	class cChunkReader :
 		public cChunkDataCallback
 	{
 	public:
 		cChunkReader(cBlockArea & a_Area);
+
+		/** Fills the area from the snapshots taken while reading the chunks, then drops the snapshots */
+		void FillArea(void);
 		
 	protected:
+		/** The copies of a chunk section's arrays; only the arrays that the area has are copied, the others stay empty */
+		struct sSectionData
+		{
+			std::vector<BLOCKTYPE>  m_BlockTypes;
+			std::vector<NIBBLETYPE> m_BlockMetas;
+			std::vector<NIBBLETYPE> m_BlockLight;
+			std::vector<NIBBLETYPE> m_BlockSkyLight;
+		} ;
+
+		/** A copy of a single chunk section, with the data shared so that the snapshots can be moved around cheaply */
+		struct sSectionSnapshot
+		{
+			int m_ChunkX;
+			int m_ChunkZ;
+			int m_SectionY;
+
+			/** The section's data; nullptr if the section was not allocated (air, no blocklight, full skylight) */
+			SharedPtr<sSectionData> m_Data;
+		} ;
+
+		typedef std::vector<sSectionSnapshot> cSectionSnapshots;
+
+		/** The number of section snapshots from which FillArea() uses more threads */
+		static const size_t PARALLEL_FILL_MIN_SECTIONS = 64;
+
+		/** The maximum number of threads used by FillArea(), including the calling thread.
+		If the threads cannot be started, FillArea() makes do with those that have started, down to the calling thread alone. */
+		static const unsigned MAX_FILL_THREADS = 4;
+
 		cBlockArea & m_Area;
 		Vector3i m_Origin;
 		int m_CurrentChunkX;
 		int m_CurrentChunkZ;
-		
-		void CopyNibbles(NIBBLETYPE * a_AreaDst, const NIBBLETYPE * a_ChunkSrc);
+		cSectionSnapshots m_Snapshots;
+
+		/** Copies the part of the snapshot that the area intersects into the area */
+		void FillSection(const sSectionSnapshot & a_Snapshot);
 		
 		// cChunkDataCallback overrides:
 		virtual bool Coords(int a_ChunkX, int a_ChunkZ) override;
@@ -362,6 +415,31 @@ protected:
 	NIBBLETYPE * m_BlockLight;     // Each light value is stored as a separate byte for faster access
 	NIBBLETYPE * m_BlockSkyLight;  // Each light value is stored as a separate byte for faster access
 	
+	/** If set, the three nibble arrays above are packed two nibbles per byte, see PackNibbles() */
+	bool m_AreNibblesPacked;
+	
+	/** Returns the number of bytes that a nibble array of the current size takes */
+	size_t GetNibbleArraySize(void) const { return m_AreNibblesPacked ? (GetBlockCount() + 1) / 2 : GetBlockCount(); }
+	
+	/** Returns the nibble at the specified index of one of the nibble arrays, packed or not */
+	NIBBLETYPE GetNibbleAt(const NIBBLETYPE * a_Array, int a_Index) const
+	{
+		return m_AreNibblesPacked ? cBlockAreaKernels::GetPackedNibble(a_Array, static_cast<size_t>(a_Index)) : a_Array[a_Index];
+	}
+	
+	/** Sets the nibble at the specified index of one of the nibble arrays, packed or not */
+	void SetNibbleAt(NIBBLETYPE * a_Array, int a_Index, NIBBLETYPE a_Value)
+	{
+		if (m_AreNibblesPacked)
+		{
+			cBlockAreaKernels::SetPackedNibble(a_Array, static_cast<size_t>(a_Index), a_Value);
+		}
+		else
+		{
+			a_Array[a_Index] = a_Value;
+		}
+	}
+	
 	/** Clears the data stored and prepares a fresh new block area with the specified dimensions */
 	bool SetSize(int a_SizeX, int a_SizeY, int a_SizeZ, int a_DataTypes);
 	
@@ -388,7 +466,7 @@ protected:
 		NIBBLETYPE a_BlockLight, NIBBLETYPE a_BlockSkyLight
 	);
 	
-	template <bool MetasValid>
+	template <bool MetasValid, bool SrcMetasPacked>
 	void MergeByStrategy(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_RelZ, eMergeStrategy a_Strategy, const NIBBLETYPE * SrcMetas, NIBBLETYPE * DstMetas);
 	// tolua_begin
 } ;
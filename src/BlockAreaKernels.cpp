@@ -0,0 +1,184 @@
+
+// BlockAreaKernels.cpp
+
+// Implements the cBlockAreaKernels class with the bulk array operations used by cBlockArea's transformations
+
+// The loops are kept free of dependencies between the iterations and of function calls,
+// so that the compilers can vectorize them without any platform-specific code.
+
+#include "Globals.h"
+#include "BlockAreaKernels.h"
+
+
+
+
+
+void cBlockAreaKernels::RotateCCW(Byte * a_Dst, const Byte * a_Src, int a_SizeX, int a_SizeY, int a_SizeZ)
+{
+	// (x, z) -> (NewX, NewZ) = (z, SizeX - 1 - x); the new X size is SizeZ
+	size_t LayerSize = static_cast<size_t>(a_SizeX * a_SizeZ);
+	for (int y = 0; y < a_SizeY; y++)
+	{
+		const Byte * SrcLayer = a_Src + static_cast<size_t>(y) * LayerSize;
+		Byte * DstLayer = a_Dst + static_cast<size_t>(y) * LayerSize;
+		for (int TileZ = 0; TileZ < a_SizeZ; TileZ += TILE_SIZE)
+		{
+			int MaxZ = std::min(TileZ + TILE_SIZE, a_SizeZ);
+			for (int TileX = 0; TileX < a_SizeX; TileX += TILE_SIZE)
+			{
+				int MaxX = std::min(TileX + TILE_SIZE, a_SizeX);
+				for (int z = TileZ; z < MaxZ; z++)
+				{
+					const Byte * SrcRow = SrcLayer + z * a_SizeX;
+					Byte * DstColumn = DstLayer + z;
+					for (int x = TileX; x < MaxX; x++)
+					{
+						DstColumn[(a_SizeX - 1 - x) * a_SizeZ] = SrcRow[x];
+					}  // for x
+				}  // for z
+			}  // for TileX
+		}  // for TileZ
+	}  // for y
+}
+
+
+
+
+
+void cBlockAreaKernels::RotateCW(Byte * a_Dst, const Byte * a_Src, int a_SizeX, int a_SizeY, int a_SizeZ)
+{
+	// (x, z) -> (NewX, NewZ) = (SizeZ - 1 - z, x); the new X size is SizeZ
+	size_t LayerSize = static_cast<size_t>(a_SizeX * a_SizeZ);
+	for (int y = 0; y < a_SizeY; y++)
+	{
+		const Byte * SrcLayer = a_Src + static_cast<size_t>(y) * LayerSize;
+		Byte * DstLayer = a_Dst + static_cast<size_t>(y) * LayerSize;
+		for (int TileZ = 0; TileZ < a_SizeZ; TileZ += TILE_SIZE)
+		{
+			int MaxZ = std::min(TileZ + TILE_SIZE, a_SizeZ);
+			for (int TileX = 0; TileX < a_SizeX; TileX += TILE_SIZE)
+			{
+				int MaxX = std::min(TileX + TILE_SIZE, a_SizeX);
+				for (int z = TileZ; z < MaxZ; z++)
+				{
+					const Byte * SrcRow = SrcLayer + z * a_SizeX;
+					Byte * DstColumn = DstLayer + (a_SizeZ - 1 - z);
+					for (int x = TileX; x < MaxX; x++)
+					{
+						DstColumn[x * a_SizeZ] = SrcRow[x];
+					}  // for x
+				}  // for z
+			}  // for TileX
+		}  // for TileZ
+	}  // for y
+}
+
+
+
+
+
+void cBlockAreaKernels::MirrorXY(Byte * a_Array, int a_SizeX, int a_SizeY, int a_SizeZ)
+{
+	size_t RowSize = static_cast<size_t>(a_SizeX);
+	size_t LayerSize = RowSize * static_cast<size_t>(a_SizeZ);
+	int HalfZ = a_SizeZ / 2;
+	for (int y = 0; y < a_SizeY; y++)
+	{
+		Byte * Layer = a_Array + static_cast<size_t>(y) * LayerSize;
+		for (int z = 0; z < HalfZ; z++)
+		{
+			Byte * Row1 = Layer + static_cast<size_t>(z) * RowSize;
+			Byte * Row2 = Layer + static_cast<size_t>(a_SizeZ - 1 - z) * RowSize;
+			std::swap_ranges(Row1, Row1 + RowSize, Row2);
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
+void cBlockAreaKernels::MirrorXZ(Byte * a_Array, int a_SizeX, int a_SizeY, int a_SizeZ)
+{
+	size_t LayerSize = static_cast<size_t>(a_SizeX * a_SizeZ);
+	int HalfY = a_SizeY / 2;
+	for (int y = 0; y < HalfY; y++)
+	{
+		Byte * Layer1 = a_Array + static_cast<size_t>(y) * LayerSize;
+		Byte * Layer2 = a_Array + static_cast<size_t>(a_SizeY - 1 - y) * LayerSize;
+		std::swap_ranges(Layer1, Layer1 + LayerSize, Layer2);
+	}  // for y
+}
+
+
+
+
+
+void cBlockAreaKernels::MirrorYZ(Byte * a_Array, int a_SizeX, int a_SizeY, int a_SizeZ)
+{
+	size_t RowSize = static_cast<size_t>(a_SizeX);
+	size_t NumRows = static_cast<size_t>(a_SizeY * a_SizeZ);
+	for (size_t i = 0; i < NumRows; i++)
+	{
+		Byte * Row = a_Array + i * RowSize;
+		std::reverse(Row, Row + RowSize);
+	}  // for i
+}
+
+
+
+
+
+void cBlockAreaKernels::TransformMetas(const BLOCKTYPE * a_BlockTypes, NIBBLETYPE * a_BlockMetas, size_t a_Count, const cMetaTable & a_Table)
+{
+	for (size_t i = 0; i < a_Count; i++)
+	{
+		a_BlockMetas[i] = a_Table[a_BlockTypes[i]][a_BlockMetas[i] & 0x0f];
+	}
+}
+
+
+
+
+
+void cBlockAreaKernels::PackNibbles(NIBBLETYPE * a_Dst, const NIBBLETYPE * a_Src, size_t a_Count)
+{
+	size_t NumBytes = a_Count / 2;
+	for (size_t i = 0; i < NumBytes; i++)
+	{
+		a_Dst[i] = static_cast<NIBBLETYPE>((a_Src[2 * i] & 0x0f) | ((a_Src[2 * i + 1] & 0x0f) << 4));
+	}
+	if ((a_Count & 1) != 0)
+	{
+		a_Dst[NumBytes] = a_Src[a_Count - 1] & 0x0f;
+	}
+}
+
+
+
+
+
+void cBlockAreaKernels::UnpackNibbles(NIBBLETYPE * a_Dst, const NIBBLETYPE * a_Src, size_t a_SrcIdx, size_t a_Count)
+{
+	if (((a_SrcIdx & 1) != 0) && (a_Count > 0))
+	{
+		*a_Dst++ = (a_Src[a_SrcIdx / 2] >> 4) & 0x0f;
+		a_SrcIdx += 1;
+		a_Count -= 1;
+	}
+	const NIBBLETYPE * Src = a_Src + a_SrcIdx / 2;
+	size_t NumBytes = a_Count / 2;
+	for (size_t i = 0; i < NumBytes; i++)
+	{
+		a_Dst[2 * i]     = Src[i] & 0x0f;
+		a_Dst[2 * i + 1] = (Src[i] >> 4) & 0x0f;
+	}
+	if ((a_Count & 1) != 0)
+	{
+		a_Dst[a_Count - 1] = Src[NumBytes] & 0x0f;
+	}
+}
+
+
+
+
@@ -0,0 +1,75 @@
+
+// BlockAreaKernels.h
+
+// Declares the cBlockAreaKernels class with the bulk array operations used by cBlockArea's transformations
+
+// The kernels work on plain arrays of bytes indexed the same way as cBlockArea's arrays (x + z * SizeX + y * SizeX * SizeZ),
+// they don't depend on the rest of the server so that they can be benchmarked on their own.
+
+
+
+
+
+#pragma once
+
+
+
+
+
+class cBlockAreaKernels
+{
+public:
+
+	/** A lookup table of the meta transformation for each blocktype and meta, indexed [BlockType][BlockMeta] */
+	typedef NIBBLETYPE cMetaTable[256][16];
+
+
+	/** Rotates the array counter-clockwise around the Y axis, into a_Dst. The result has the X and Z sizes swapped.
+	The layers are processed in square tiles, so that both the reads and the writes stay within the cache. */
+	static void RotateCCW(Byte * a_Dst, const Byte * a_Src, int a_SizeX, int a_SizeY, int a_SizeZ);
+
+	/** Rotates the array clockwise around the Y axis, into a_Dst. The result has the X and Z sizes swapped.
+	The layers are processed in square tiles, so that both the reads and the writes stay within the cache. */
+	static void RotateCW(Byte * a_Dst, const Byte * a_Src, int a_SizeX, int a_SizeY, int a_SizeZ);
+
+	/** Mirrors the array in place around the XY plane, by swapping whole X rows */
+	static void MirrorXY(Byte * a_Array, int a_SizeX, int a_SizeY, int a_SizeZ);
+
+	/** Mirrors the array in place around the XZ plane, by swapping whole layers */
+	static void MirrorXZ(Byte * a_Array, int a_SizeX, int a_SizeY, int a_SizeZ);
+
+	/** Mirrors the array in place around the YZ plane, by reversing each X row */
+	static void MirrorYZ(Byte * a_Array, int a_SizeX, int a_SizeY, int a_SizeZ);
+
+	/** Replaces each meta with its transformed value from the table, based on the blocktype at the same index */
+	static void TransformMetas(const BLOCKTYPE * a_BlockTypes, NIBBLETYPE * a_BlockMetas, size_t a_Count, const cMetaTable & a_Table);
+
+	/** Packs a_Count one-per-byte nibbles into (a_Count + 1) / 2 bytes, two nibbles per byte.
+	The even indices go to the low nibbles, the same as in the chunk data. */
+	static void PackNibbles(NIBBLETYPE * a_Dst, const NIBBLETYPE * a_Src, size_t a_Count);
+
+	/** Expands a_Count packed nibbles, starting at the nibble index a_SrcIdx, into one byte per nibble. */
+	static void UnpackNibbles(NIBBLETYPE * a_Dst, const NIBBLETYPE * a_Src, size_t a_SrcIdx, size_t a_Count);
+
+	/** Returns the nibble at the specified index in a packed array */
+	inline static NIBBLETYPE GetPackedNibble(const NIBBLETYPE * a_Array, size_t a_Idx)
+	{
+		return (a_Array[a_Idx / 2] >> ((a_Idx & 1) * 4)) & 0x0f;
+	}
+
+	/** Sets the nibble at the specified index in a packed array */
+	inline static void SetPackedNibble(NIBBLETYPE * a_Array, size_t a_Idx, NIBBLETYPE a_Value)
+	{
+		int Shift = static_cast<int>((a_Idx & 1) * 4);
+		a_Array[a_Idx / 2] = static_cast<NIBBLETYPE>((a_Array[a_Idx / 2] & (0xf0 >> Shift)) | ((a_Value & 0x0f) << Shift));
+	}
+
+protected:
+
+	/** The size of the square tiles in which the rotations are processed */
+	static const int TILE_SIZE = 32;
+} ;
+
+
+
+
@@ -0,0 +1,140 @@
+
+// BlockAreaWriter.cpp
+
+// Implements the cBlockAreaWriter class that writes a large cBlockArea into the world a few chunk sections per tick
+
+#include "Globals.h"
+#include "BlockAreaWriter.h"
+#include "BlockArea.h"
+#include "ChunkData.h"
+#include "ChunkMap.h"
+
+
+
+
+
+cBlockAreaWriter::cBlockAreaWriter(cBlockArea * a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, cCallbacksPtr a_Callbacks) :
+	m_Area(a_Area),
+	m_MinBlockX(a_MinBlockX),
+	m_MinBlockY(a_MinBlockY),
+	m_MinBlockZ(a_MinBlockZ),
+	m_Callbacks(a_Callbacks),
+	m_HasChunkChanged(false),
+	m_NumTotal(0),
+	m_NumDone(0),
+	m_NumSkipped(0),
+	m_IsFinished(false)
+{
+	ASSERT(m_Area != nullptr);
+	ASSERT((m_Area->GetDataTypes() & (cBlockArea::baTypes | cBlockArea::baMetas)) == (cBlockArea::baTypes | cBlockArea::baMetas));
+
+	// The chunk sections are written from the raw arrays, one meta per byte:
+	m_Area->UnpackNibbles();
+
+	const int SectionHeight = static_cast<int>(cChunkData::SectionHeight);
+	int MaxBlockX = a_MinBlockX + m_Area->GetSizeX() - 1;
+	int MaxBlockZ = a_MinBlockZ + m_Area->GetSizeZ() - 1;
+	int MinBlockY = std::max(a_MinBlockY, 0);
+	int MaxBlockY = std::min(a_MinBlockY + m_Area->GetSizeY() - 1, cChunkDef::Height - 1);
+	cChunkDef::BlockToChunk(a_MinBlockX, a_MinBlockZ, m_MinChunkX, m_MinChunkZ);
+	cChunkDef::BlockToChunk(MaxBlockX, MaxBlockZ, m_MaxChunkX, m_MaxChunkZ);
+	m_MinSectionY = MinBlockY / SectionHeight;
+	m_MaxSectionY = MaxBlockY / SectionHeight;
+	if ((MinBlockY <= MaxBlockY) && (m_Area->GetSizeX() > 0) && (m_Area->GetSizeZ() > 0))
+	{
+		m_NumTotal = (m_MaxChunkX - m_MinChunkX + 1) * (m_MaxChunkZ - m_MinChunkZ + 1) * (m_MaxSectionY - m_MinSectionY + 1);
+	}
+	m_ChunkX = m_MinChunkX;
+	m_ChunkZ = m_MinChunkZ;
+	m_SectionY = m_MinSectionY;
+}
+
+
+
+
+
+cBlockAreaWriter::~cBlockAreaWriter()
+{
+}
+
+
+
+
+
+int cBlockAreaWriter::Tick(cChunkMap & a_ChunkMap, int a_MaxSections)
+{
+	if (m_IsFinished)
+	{
+		return 0;
+	}
+
+	int NumProcessed = 0;
+	while ((m_NumDone < m_NumTotal) && (NumProcessed < a_MaxSections))
+	{
+		NumProcessed += 1;
+		if (!a_ChunkMap.WriteBlockAreaSection(*m_Area, m_MinBlockX, m_MinBlockY, m_MinBlockZ, m_ChunkX, m_ChunkZ, m_SectionY, m_HasChunkChanged))
+		{
+			// The chunk is not loaded, skip all its remaining sections:
+			int NumSkipped = m_MaxSectionY - m_SectionY + 1;
+			m_NumSkipped += NumSkipped;
+			m_NumDone += NumSkipped;
+			m_HasChunkChanged = false;
+			NextChunk();
+			continue;
+		}
+		m_NumDone += 1;
+		NextSection(a_ChunkMap);
+	}
+
+	if (m_NumDone >= m_NumTotal)
+	{
+		// Free the memory early, the writer may be kept around until the world's tick finishes:
+		m_Area.reset();
+		m_IsFinished = true;
+	}
+	if ((m_Callbacks != nullptr) && ((NumProcessed > 0) || m_IsFinished))
+	{
+		m_Callbacks->OnProgress(m_NumDone, m_NumTotal, m_NumSkipped);
+	}
+	return NumProcessed;
+}
+
+
+
+
+
+void cBlockAreaWriter::NextSection(cChunkMap & a_ChunkMap)
+{
+	if (m_SectionY < m_MaxSectionY)
+	{
+		m_SectionY += 1;
+		return;
+	}
+
+	// The chunk is done, send it all at once:
+	if (m_HasChunkChanged)
+	{
+		a_ChunkMap.ResendChunkToClients(m_ChunkX, m_ChunkZ);
+		m_HasChunkChanged = false;
+	}
+	NextChunk();
+}
+
+
+
+
+
+void cBlockAreaWriter::NextChunk(void)
+{
+	m_SectionY = m_MinSectionY;
+	m_ChunkX += 1;
+	if (m_ChunkX > m_MaxChunkX)
+	{
+		m_ChunkX = m_MinChunkX;
+		m_ChunkZ += 1;
+	}
+}
+
+
+
+
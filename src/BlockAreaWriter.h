@@ -0,0 +1,102 @@
+
+// BlockAreaWriter.h
+
+// Declares the cBlockAreaWriter class that writes a large cBlockArea into the world a few chunk sections per tick
+
+
+
+
+
+#pragma once
+
+#include "ChunkDef.h"
+
+
+
+
+
+// fwd:
+class cBlockArea;
+class cChunkMap;
+
+
+
+
+
+/** Writes a cBlockArea into a world incrementally, so that large edits don't stall the tick thread.
+The area is split into the chunk sections it covers; each Tick() writes at most the given number of sections,
+a row of blocks at a time, directly into the chunk data. Each chunk is resent to its clients as a whole
+once all its sections have been written, instead of queueing the single block changes.
+Only the block types and metas are written. The sections of the chunks that are not loaded are skipped.
+The writer is owned and ticked by cWorld, see cWorld::QueueBlockAreaWriter(). */
+class cBlockAreaWriter
+{
+public:
+
+	/** The interface for being notified about the progress of the write */
+	class cCallbacks
+	{
+	public:
+		// Force a virtual destructor in descendants:
+		virtual ~cCallbacks() {}
+
+		/** Called after each tick that has written some sections, and once more when the write finishes.
+		a_NumDone includes the skipped sections; the write is finished when a_NumDone == a_NumTotal. */
+		virtual void OnProgress(int a_NumDone, int a_NumTotal, int a_NumSkipped) = 0;
+	} ;
+
+	typedef SharedPtr<cCallbacks> cCallbacksPtr;
+
+
+	/** Creates a writer for the specified area; takes ownership of the area. a_Callbacks may be nullptr. */
+	cBlockAreaWriter(cBlockArea * a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, cCallbacksPtr a_Callbacks);
+
+	~cBlockAreaWriter();
+
+	/** Writes up to a_MaxSections sections into the chunkmap. Returns the number of sections processed. */
+	int Tick(cChunkMap & a_ChunkMap, int a_MaxSections);
+
+	/** Returns true once all the sections have been processed and the callbacks notified */
+	bool IsFinished(void) const { return m_IsFinished; }
+
+	int GetNumTotal(void) const { return m_NumTotal; }
+	int GetNumDone (void) const { return m_NumDone; }
+
+protected:
+
+	/** The area being written */
+	std::unique_ptr<cBlockArea> m_Area;
+
+	/** The world coords where the area's origin is written */
+	int m_MinBlockX, m_MinBlockY, m_MinBlockZ;
+
+	cCallbacksPtr m_Callbacks;
+
+	/** The range of the chunks and sections covered by the area, inclusive */
+	int m_MinChunkX, m_MaxChunkX;
+	int m_MinChunkZ, m_MaxChunkZ;
+	int m_MinSectionY, m_MaxSectionY;
+
+	/** The next section to be written */
+	int m_ChunkX, m_ChunkZ, m_SectionY;
+
+	/** Set if any block in the current chunk has changed, so that the chunk needs resending */
+	bool m_HasChunkChanged;
+
+	int m_NumTotal;
+	int m_NumDone;
+	int m_NumSkipped;
+
+	bool m_IsFinished;
+
+
+	/** Moves to the next section, resending the current chunk if it has been finished */
+	void NextSection(cChunkMap & a_ChunkMap);
+
+	/** Moves to the first section of the next chunk */
+	void NextChunk(void);
+} ;
+
+
+
+
@@ -88,6 +88,7 @@ protected:
 			}
 
 			m_World->MarkChunkDirty(GetChunkX(), GetChunkZ());
+			m_World->GetHopperScheduler().WakeUpAt(m_PosX, m_PosY, m_PosZ);
 		}
 	}
 } ;  // tolua_export
@@ -5,6 +5,7 @@
 
 #include "Globals.h"
 #include "HopperEntity.h"
+#include "HopperScheduler.h"
 #include "../Chunk.h"
 #include "../Entities/Player.h"
 #include "../Entities/Pickup.h"
@@ -20,7 +21,9 @@
 cHopperEntity::cHopperEntity(int a_BlockX, int a_BlockY, int a_BlockZ, cWorld * a_World) :
 	super(E_BLOCK_HOPPER, a_BlockX, a_BlockY, a_BlockZ, ContentsWidth, ContentsHeight, a_World),
 	m_LastMoveItemsInTick(0),
-	m_LastMoveItemsOutTick(0)
+	m_LastMoveItemsOutTick(0),
+	m_IsPowered(false),
+	m_IsSleeping(false)
 {
 }
 
@@ -28,6 +31,18 @@ cHopperEntity::cHopperEntity(int a_BlockX, int a_BlockY, int a_BlockZ, cWorld *
 
 
 
+cHopperEntity::~cHopperEntity()
+{
+	if (m_IsSleeping && (m_World != nullptr))
+	{
+		m_World->GetHopperScheduler().WakeUp(*this);
+	}
+}
+
+
+
+
+
 /** Returns the block coords of the block receiving the output items, based on the meta
 Returns false if unattached
 */
@@ -55,15 +70,57 @@ bool cHopperEntity::GetOutputBlockPos(NIBBLETYPE a_BlockMeta, int & a_OutputX, i
 
 
 
+void cHopperEntity::SetRedstonePower(bool a_IsPowered)
+{
+	if (a_IsPowered == m_IsPowered)
+	{
+		return;
+	}
+	m_IsPowered = a_IsPowered;
+
+	// A powered hopper is locked and sleeps; wake it up to either unlock, or to go to sleep right away:
+	if (m_IsSleeping && (m_World != nullptr))
+	{
+		m_World->GetHopperScheduler().WakeUp(*this);
+	}
+}
+
+
+
+
+
 bool cHopperEntity::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 {
 	UNUSED(a_Dt);
+	if (m_IsSleeping)
+	{
+		// Nothing has changed around the hopper since it last had nothing to do
+		return false;
+	}
+	if (m_IsPowered)
+	{
+		// Locked by the redstone power, there's nothing to do until the power changes
+		GoToSleep(a_Chunk);
+		return false;
+	}
+
+	a_Chunk.GetWorld()->GetHopperScheduler().CountActive();
 	Int64 CurrentTick = a_Chunk.GetWorld()->GetWorldAge();
 
 	bool res = false;
 	res = MoveItemsIn  (a_Chunk, CurrentTick) || res;
 	res = MovePickupsIn(a_Chunk, CurrentTick) || res;
 	res = MoveItemsOut (a_Chunk, CurrentTick) || res;
+
+	// If all the moves were tried and none succeeded, the next tries would fail the same way until something changes:
+	if (
+		!res &&
+		(CurrentTick - m_LastMoveItemsInTick >= TICKS_PER_TRANSFER) &&
+		(CurrentTick - m_LastMoveItemsOutTick >= TICKS_PER_TRANSFER)
+	)
+	{
+		GoToSleep(a_Chunk);
+	}
 	return res;
 }
 
@@ -71,6 +128,82 @@ bool cHopperEntity::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 
 
 
+/** Adds the block and its four horizontal neighbors to a_Positions, skipping the ones already present.
+Returns false if any of the blocks is in a chunk that isn't available. */
+static bool AddWatchedBlockAndSides(cChunk & a_Chunk, int a_BlockX, int a_BlockY, int a_BlockZ, std::vector<Vector3i> & a_Positions)
+{
+	if ((a_BlockY < 0) || (a_BlockY >= cChunkDef::Height))
+	{
+		// Nothing can change outside the world
+		return true;
+	}
+
+	static const struct
+	{
+		int x, z;
+	}
+	Coords [] =
+	{
+		{0, 0},
+		{1, 0},
+		{-1, 0},
+		{0, 1},
+		{0, -1},
+	} ;
+	for (size_t i = 0; i < ARRAYCOUNT(Coords); i++)
+	{
+		Vector3i Pos(a_BlockX + Coords[i].x, a_BlockY, a_BlockZ + Coords[i].z);
+		int RelX = Pos.x - a_Chunk.GetPosX() * cChunkDef::Width;
+		int RelZ = Pos.z - a_Chunk.GetPosZ() * cChunkDef::Width;
+		cChunk * Chunk = a_Chunk.GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+		if ((Chunk == nullptr) || !Chunk->IsValid())
+		{
+			return false;
+		}
+		if (std::find(a_Positions.begin(), a_Positions.end(), Pos) == a_Positions.end())
+		{
+			a_Positions.push_back(Pos);
+		}
+	}
+	return true;
+}
+
+
+
+
+
+void cHopperEntity::GoToSleep(cChunk & a_Chunk)
+{
+	cHopperScheduler & Scheduler = a_Chunk.GetWorld()->GetHopperScheduler();
+	if (!Scheduler.IsEnabled())
+	{
+		return;
+	}
+
+	// Watch the hopper itself (contents, meta), the source block above and the destination block, together with their
+	// horizontal neighbors for the double chests:
+	std::vector<Vector3i> Positions;
+	Positions.reserve(11);
+	Positions.push_back(Vector3i(m_PosX, m_PosY, m_PosZ));
+	if (!AddWatchedBlockAndSides(a_Chunk, m_PosX, m_PosY + 1, m_PosZ, Positions))
+	{
+		return;
+	}
+	int OutX, OutY, OutZ;
+	if (
+		GetOutputBlockPos(a_Chunk.GetMeta(m_RelX, m_PosY, m_RelZ), OutX, OutY, OutZ) &&
+		!AddWatchedBlockAndSides(a_Chunk, OutX, OutY, OutZ, Positions)
+	)
+	{
+		return;
+	}
+	Scheduler.Sleep(*this, Positions);
+}
+
+
+
+
+
 void cHopperEntity::SendTo(cClientHandle & a_Client)
 {
 	// The hopper entity doesn't need anything sent to the client when it's created / gets in the viewdistance
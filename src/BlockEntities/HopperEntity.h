@@ -10,6 +10,7 @@
 #pragma once
 
 #include "BlockEntityWithItems.h"
+#include "RedstonePoweredEntity.h"
 
 
 
@@ -18,6 +19,9 @@
 // tolua_begin
 class cHopperEntity :
 	public cBlockEntityWithItems
+	// tolua_end
+	, public cRedstonePoweredEntity
+	// tolua_begin
 {
 	typedef cBlockEntityWithItems super;
 
@@ -35,22 +39,42 @@ public:
 	
 	/// Constructor used for normal operation
 	cHopperEntity(int a_BlockX, int a_BlockY, int a_BlockZ, cWorld * a_World);
+	virtual ~cHopperEntity();
 	
 	/** Returns the block coords of the block receiving the output items, based on the meta
 	Returns false if unattached.
 	Exported in ManualBindings.cpp
 	*/
 	bool GetOutputBlockPos(NIBBLETYPE a_BlockMeta, int & a_OutputX, int & a_OutputY, int & a_OutputZ);
+
+	/** Returns true if the hopper is sleeping, waiting for a change around it */
+	bool IsSleeping(void) const { return m_IsSleeping; }
+
+	// cRedstonePoweredEntity overrides:
+	virtual void SetRedstonePower(bool a_IsPowered) override;
 	
 protected:
 
+	friend class cHopperScheduler;
+
 	Int64 m_LastMoveItemsInTick;
 	Int64 m_LastMoveItemsOutTick;
 
+	/** If true, the hopper is powered by redstone and locked, it doesn't move any items */
+	bool m_IsPowered;
+
+	/** If true, the hopper had nothing to do and is waiting in the world's cHopperScheduler for a change around it.
+	Set and reset by the scheduler. */
+	std::atomic<bool> m_IsSleeping;
+
 	// cBlockEntity overrides:
 	virtual bool Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk) override;
 	virtual void SendTo(cClientHandle & a_Client) override;
 	virtual void UsedBy(cPlayer * a_Player) override;
+
+	/** Puts the hopper to sleep in the world's cHopperScheduler, watching the blocks that it moves the items from and to.
+	The hopper stays awake if any of the watched blocks is in a chunk that isn't loaded, it may load later. */
+	void GoToSleep(cChunk & a_Chunk);
 	
 	/// Opens a new chest window for this chest. Scans for neighbors to open a double chest window, if appropriate.
 	void OpenNewWindow(void);
@@ -0,0 +1,260 @@
+
+// HopperScheduler.cpp
+
+// Implements the cHopperScheduler class that keeps the idle hoppers asleep until something around them changes
+
+#include "Globals.h"
+#include "HopperScheduler.h"
+#include "HopperEntity.h"
+#include "../IniFile.h"
+#include "../CommandOutput.h"
+
+
+
+
+
+cHopperScheduler::cHopperScheduler(void) :
+	m_IsEnabled(true),
+	m_NumSleeping(0),
+	m_NumActive(0),
+	m_LastNumActive(0)
+{
+	for (size_t i = 0; i < NUM_CHUNK_SLOTS; i++)
+	{
+		m_NumWatchedInChunk[i] = 0;
+	}
+}
+
+
+
+
+
+void cHopperScheduler::Load(cIniFile & a_IniFile)
+{
+	m_IsEnabled = a_IniFile.GetValueSetB("Hoppers", "SleepWhenIdle", m_IsEnabled);
+}
+
+
+
+
+
+void cHopperScheduler::BeginTick(void)
+{
+	m_LastNumActive = m_NumActive;
+	m_NumActive = 0;
+}
+
+
+
+
+
+void cHopperScheduler::Sleep(cHopperEntity & a_Hopper, const std::vector<Vector3i> & a_WatchedPositions)
+{
+	if (!m_IsEnabled)
+	{
+		return;
+	}
+
+	cCSLock Lock(m_CS);
+	std::vector<UInt64> & Keys = m_WatchedPositions[&a_Hopper];
+	ASSERT(Keys.empty());  // The hopper shouldn't be sleeping already
+	Keys.reserve(a_WatchedPositions.size());
+	for (std::vector<Vector3i>::const_iterator itr = a_WatchedPositions.begin(), end = a_WatchedPositions.end(); itr != end; ++itr)
+	{
+		UInt64 Key = MakeKey(itr->x, itr->y, itr->z);
+		m_Watchers[Key].push_back(&a_Hopper);
+		Keys.push_back(Key);
+		m_NumWatchedInChunk[GetChunkSlot(Key)] += 1;
+	}
+	a_Hopper.m_IsSleeping = true;
+	m_NumSleeping += 1;
+}
+
+
+
+
+
+void cHopperScheduler::WakeUpAt(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	UInt64 Key = MakeKey(a_BlockX, a_BlockY, a_BlockZ);
+	if (!MayBeWatched(Key))
+	{
+		// Nothing to wake up; this is the usual case for most of the block changes
+		return;
+	}
+
+	cCSLock Lock(m_CS);
+	cWatchers::iterator itr = m_Watchers.find(Key);
+	if (itr != m_Watchers.end())
+	{
+		WakeUpHoppers(itr->second);
+	}
+}
+
+
+
+
+
+void cHopperScheduler::WakeUpInBox(int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_MaxBlockX, int a_MaxBlockY, int a_MaxBlockZ)
+{
+	if (m_NumSleeping == 0)
+	{
+		return;
+	}
+
+	// All the positions watched by a hopper are within two blocks of the hopper in each direction,
+	// so it is enough to wake up all the hoppers within the box enlarged by two blocks:
+	cCSLock Lock(m_CS);
+	cHopperEntities ToWake;
+	for (cWatchedPositions::const_iterator itr = m_WatchedPositions.begin(), end = m_WatchedPositions.end(); itr != end; ++itr)
+	{
+		const cHopperEntity & Hopper = *itr->first;
+		if (
+			(Hopper.GetPosX() >= a_MinBlockX - 2) && (Hopper.GetPosX() <= a_MaxBlockX + 2) &&
+			(Hopper.GetPosY() >= a_MinBlockY - 2) && (Hopper.GetPosY() <= a_MaxBlockY + 2) &&
+			(Hopper.GetPosZ() >= a_MinBlockZ - 2) && (Hopper.GetPosZ() <= a_MaxBlockZ + 2)
+		)
+		{
+			ToWake.push_back(itr->first);
+		}
+	}
+	WakeUpHoppers(ToWake);
+}
+
+
+
+
+
+void cHopperScheduler::WakeUpHopper(int a_BlockX, int a_BlockY, int a_BlockZ, const cItem & a_Item)
+{
+	UInt64 Key = MakeKey(a_BlockX, a_BlockY, a_BlockZ);
+	if (!MayBeWatched(Key))
+	{
+		return;
+	}
+
+	cCSLock Lock(m_CS);
+	cWatchers::iterator itr = m_Watchers.find(Key);
+	if (itr == m_Watchers.end())
+	{
+		return;
+	}
+	for (cHopperEntities::iterator itrH = itr->second.begin(), end = itr->second.end(); itrH != end; ++itrH)
+	{
+		cHopperEntity & Hopper = **itrH;
+		if ((Hopper.GetPosX() == a_BlockX) && (Hopper.GetPosY() == a_BlockY) && (Hopper.GetPosZ() == a_BlockZ))
+		{
+			if (Hopper.GetContents().HowManyCanFit(a_Item) > 0)
+			{
+				// This invalidates the iterators, but there's only one hopper at each position:
+				RemoveHopper(Hopper);
+			}
+			return;
+		}
+	}
+}
+
+
+
+
+
+void cHopperScheduler::WakeUp(cHopperEntity & a_Hopper)
+{
+	cCSLock Lock(m_CS);
+	RemoveHopper(a_Hopper);
+}
+
+
+
+
+
+void cHopperScheduler::Report(cCommandOutputCallback & a_Output) const
+{
+	a_Output.Out("  hoppers: %d sleeping, %d active in the last tick", m_NumSleeping.load(), m_LastNumActive.load());
+	if (!m_IsEnabled)
+	{
+		a_Output.Out("  (hopper sleeping is disabled, all hoppers are active)");
+	}
+}
+
+
+
+
+
+UInt64 cHopperScheduler::MakeKey(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	// 26 bits are enough for the X and Z coords within the world border, 12 bits for the Y coord:
+	return
+		((static_cast<UInt64>(static_cast<UInt32>(a_BlockX)) & 0x3ffffff) << 38) |
+		((static_cast<UInt64>(static_cast<UInt32>(a_BlockZ)) & 0x3ffffff) << 12) |
+		(static_cast<UInt64>(static_cast<UInt32>(a_BlockY)) & 0xfff);
+}
+
+
+
+
+
+size_t cHopperScheduler::GetChunkSlot(UInt64 a_Key)
+{
+	// The low 6 bits of the chunk coords are the bits 4 - 9 of the block coords in the key:
+	size_t ChunkX = static_cast<size_t>(a_Key >> (38 + 4)) & 63;
+	size_t ChunkZ = static_cast<size_t>(a_Key >> (12 + 4)) & 63;
+	return ChunkX + 64 * ChunkZ;
+}
+
+
+
+
+
+bool cHopperScheduler::MayBeWatched(UInt64 a_Key) const
+{
+	return ((m_NumSleeping != 0) && (m_NumWatchedInChunk[GetChunkSlot(a_Key)] != 0));
+}
+
+
+
+
+
+void cHopperScheduler::WakeUpHoppers(cHopperEntities a_Hoppers)
+{
+	for (cHopperEntities::iterator itr = a_Hoppers.begin(), end = a_Hoppers.end(); itr != end; ++itr)
+	{
+		RemoveHopper(**itr);
+	}
+}
+
+
+
+
+
+void cHopperScheduler::RemoveHopper(cHopperEntity & a_Hopper)
+{
+	cWatchedPositions::iterator itr = m_WatchedPositions.find(&a_Hopper);
+	if (itr == m_WatchedPositions.end())
+	{
+		// Not sleeping
+		return;
+	}
+	for (std::vector<UInt64>::const_iterator itrK = itr->second.begin(), end = itr->second.end(); itrK != end; ++itrK)
+	{
+		m_NumWatchedInChunk[GetChunkSlot(*itrK)] -= 1;
+		cWatchers::iterator itrW = m_Watchers.find(*itrK);
+		if (itrW == m_Watchers.end())
+		{
+			continue;
+		}
+		cHopperEntities & Hoppers = itrW->second;
+		Hoppers.erase(std::remove(Hoppers.begin(), Hoppers.end(), &a_Hopper), Hoppers.end());
+		if (Hoppers.empty())
+		{
+			m_Watchers.erase(itrW);
+		}
+	}
+	m_WatchedPositions.erase(itr);
+	a_Hopper.m_IsSleeping = false;
+	m_NumSleeping -= 1;
+}
+
+
+
+
@@ -0,0 +1,129 @@
+
+// HopperScheduler.h
+
+// Declares the cHopperScheduler class that keeps the idle hoppers asleep until something around them changes
+
+
+
+
+
+#pragma once
+
+#include <atomic>
+#include <unordered_map>
+#include "../Vector3.h"
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+class cHopperEntity;
+class cIniFile;
+class cItem;
+
+
+
+
+
+/** Keeps track of the sleeping hoppers in a world. A hopper that has nothing to move goes to sleep, registering the
+positions whose change may give it some work: itself, the block it pulls from, the block it pushes into, and their
+horizontal neighbors (for the double chests). A sleeping hopper isn't processed in its ticks until a block or an
+inventory at any of its watched positions changes, or its redstone power changes.
+The block changes check a lock-free counter of the watched positions in their chunk first, so that only the changes
+in the chunks with some watched positions lock the scheduler.
+Counts the sleeping and the active hoppers, for the "entitystats" console command. */
+class cHopperScheduler
+{
+public:
+
+	cHopperScheduler(void);
+
+	/** Reads the settings from the [Hoppers] section of the world's ini file, writing the defaults if not present. */
+	void Load(cIniFile & a_IniFile);
+
+	/** Returns true if the idle hoppers are allowed to go to sleep */
+	bool IsEnabled(void) const { return m_IsEnabled; }
+
+	/** Starts a new tick; publishes the counts of the previous tick for the stats. Called by the world at the tick start. */
+	void BeginTick(void);
+
+	/** Counts the hopper as active in the current tick. Only called from the tick thread. */
+	void CountActive(void) { m_NumActive += 1; }
+
+	/** Puts the hopper to sleep until any of the specified block positions changes, or the hopper is woken up explicitly. */
+	void Sleep(cHopperEntity & a_Hopper, const std::vector<Vector3i> & a_WatchedPositions);
+
+	/** Wakes up all the hoppers watching the specified block. */
+	void WakeUpAt(int a_BlockX, int a_BlockY, int a_BlockZ);
+
+	/** Wakes up all the hoppers watching any block within the specified box, inclusive. */
+	void WakeUpInBox(int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_MaxBlockX, int a_MaxBlockY, int a_MaxBlockZ);
+
+	/** Wakes up the hopper at the specified position, if it is sleeping and has room for the item.
+	The hoppers that only watch the position are left asleep. Used by the pickups lying on or in a hopper;
+	a full hopper stays asleep, instead of waking up each tick only to fail sucking the pickup in and go to sleep again. */
+	void WakeUpHopper(int a_BlockX, int a_BlockY, int a_BlockZ, const cItem & a_Item);
+
+	/** Wakes up the specified hopper and removes all its registrations. Also used when the hopper is being destroyed. */
+	void WakeUp(cHopperEntity & a_Hopper);
+
+	/** Outputs the sleeping and active hopper counts. */
+	void Report(cCommandOutputCallback & a_Output) const;
+
+protected:
+
+	/** The number of the slots in m_NumWatchedInChunk; each slot covers the chunks with the same low 6 bits of their coords */
+	static const size_t NUM_CHUNK_SLOTS = 64 * 64;
+
+	typedef std::vector<cHopperEntity *> cHopperEntities;
+	typedef std::unordered_map<UInt64, cHopperEntities> cWatchers;
+	typedef std::unordered_map<cHopperEntity *, std::vector<UInt64> > cWatchedPositions;
+
+	/** If false, the hoppers never go to sleep */
+	bool m_IsEnabled;
+
+	/** Protects m_Watchers and m_WatchedPositions */
+	mutable cCriticalSection m_CS;
+
+	/** The sleeping hoppers watching each block position, keyed by MakeKey() */
+	cWatchers m_Watchers;
+
+	/** The position keys watched by each sleeping hopper, so that the hopper can be removed from m_Watchers */
+	cWatchedPositions m_WatchedPositions;
+
+	/** Number of the sleeping hoppers. Read without locking, so that the block changes don't lock anything when no hopper sleeps. */
+	std::atomic<int> m_NumSleeping;
+
+	/** The number of the positions watched in each chunk, indexed by GetChunkSlot(); the chunks 64 apart share a slot.
+	Read without locking, so that the block changes in the chunks without any watched positions don't lock anything. */
+	std::atomic<int> m_NumWatchedInChunk[NUM_CHUNK_SLOTS];
+
+	/** Number of the hoppers that were active in the current tick. Only used in the tick thread. */
+	int m_NumActive;
+
+	/** The number of active hoppers in the last finished tick, read by the stats */
+	std::atomic<int> m_LastNumActive;
+
+
+	/** Returns the key into m_Watchers for the specified block position */
+	static UInt64 MakeKey(int a_BlockX, int a_BlockY, int a_BlockZ);
+
+	/** Returns the index into m_NumWatchedInChunk for the chunk containing the block position with the specified key */
+	static size_t GetChunkSlot(UInt64 a_Key);
+
+	/** Returns true if the block position with the specified key may be watched by some hopper.
+	Doesn't lock anything, false positives are possible. */
+	bool MayBeWatched(UInt64 a_Key) const;
+
+	/** Wakes up all the hoppers in a_Hoppers; the vector may be the one in m_Watchers. Assumes m_CS is held. */
+	void WakeUpHoppers(cHopperEntities a_Hoppers);
+
+	/** Removes the hopper from m_Watchers and m_WatchedPositions and marks it awake. Assumes m_CS is held. */
+	void RemoveHopper(cHopperEntity & a_Hopper);
+} ;
+
+
+
+
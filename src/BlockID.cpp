@@ -6,7 +6,6 @@
 #include "BlockID.h"
 #include "IniFile.h"
 #include "Item.h"
-#include "Mobs/Monster.h"
 
 
 
@@ -7,7 +7,6 @@
 
 #include "ByteBuffer.h"
 #include "Endianness.h"
-#include "OSSupport/IsThread.h"
 
 
 
@@ -1000,11 +999,35 @@ bool cByteBuffer::ReadToByteBuffer(cByteBuffer & a_Dst, size_t a_NumBytes)
 
 
 
+char * cByteBuffer::GetContiguousData(size_t & a_Size)
+{
+	CHECK_THREAD
+	CheckValid();
+	a_Size = GetUsedSpace();
+	if (m_DataStart + a_Size > m_BufferSize)
+	{
+		// The data wraps around the end of the ringbuffer
+		return nullptr;
+	}
+	return m_Buffer + m_DataStart;
+}
+
+
+
+
+
 void cByteBuffer::CommitRead(void)
 {
 	CHECK_THREAD
 	CheckValid();
 	m_DataStart = m_ReadPos;
+	if (m_DataStart == m_WritePos)
+	{
+		// The buffer is empty, rewind to its beginning so that the next data doesn't wrap around:
+		m_DataStart = 0;
+		m_ReadPos = 0;
+		m_WritePos = 0;
+	}
 }
 
 
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <thread>
+
 
 
 
@@ -121,7 +123,13 @@ public:
 	/** Reads the specified number of bytes and writes it into the destinatio bytebuffer. Returns true on success. */
 	bool ReadToByteBuffer(cByteBuffer & a_Dst, size_t a_NumBytes);
 	
-	/** Removes the bytes that have been read from the ringbuffer */
+	/** Returns a pointer to the bytes stored in the ringbuffer, starting at the data start (including the bytes already read
+	but not committed), if they are stored contiguously; returns nullptr if they wrap around the end of the ringbuffer.
+	a_Size receives the number of bytes stored. Allows sending or back-patching the data in place, without copying it out. */
+	char * GetContiguousData(size_t & a_Size);
+	
+	/** Removes the bytes that have been read from the ringbuffer.
+	If this empties the ringbuffer, the next write starts at its beginning, so that data written in one go is kept contiguous. */
 	void CommitRead(void);
 	
 	/** Restarts next reading operation at the start of the ringbuffer */
@@ -78,6 +78,8 @@ cChunk::cChunk(
 	m_IsDirty(false),
 	m_IsSaving(false),
 	m_HasLoadFailed(false),
+	m_EntityIterationDepth(0),
+	m_HasEntityHoles(false),
 	m_StayCount(0),
 	m_PosX(a_ChunkX),
 	m_PosZ(a_ChunkZ),
@@ -132,9 +134,19 @@ cChunk::~cChunk()
 	m_BlockEntities.clear();
 
 	// Remove and destroy all entities that are not players:
-	cEntityList Entities;
+	cEntityVector Entities;
 	std::swap(Entities, m_Entities);  // Need another list because cEntity destructors check if they've been removed from chunk
-	for (cEntityList::const_iterator itr = Entities.begin(); itr != Entities.end(); ++itr)
+
+	// Only the entities in the cells are indexed by this chunk, a travelling entity in m_Entities may be indexed by the new world already:
+	for (size_t i = 0; i < ARRAYCOUNT(m_EntityCells); i++)
+	{
+		for (cEntityCell::const_iterator itr = m_EntityCells[i].begin(), end = m_EntityCells[i].end(); itr != end; ++itr)
+		{
+			(*itr)->SetChunkEntityCell(nullptr, nullptr, -1, 0);
+		}
+		m_EntityCells[i].clear();
+	}
+	for (cEntityVector::const_iterator itr = Entities.begin(); itr != Entities.end(); ++itr)
 	{
 		if (!(*itr)->IsPlayer())
 		{
@@ -284,9 +296,12 @@ void cChunk::GetAllData(cChunkDataCallback & a_Callback)
 
 	a_Callback.ChunkData(m_ChunkData);
 	
-	for (cEntityList::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
+	for (cEntityVector::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
 	{
-		a_Callback.Entity(*itr);
+		if (*itr != nullptr)
+		{
+			a_Callback.Entity(*itr);
+		}
 	}
 	
 	for (cBlockEntityList::iterator itr = m_BlockEntities.begin(); itr != m_BlockEntities.end(); ++itr)
@@ -442,6 +457,72 @@ void cChunk::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlock
 
 
 
+bool cChunk::WriteBlockAreaSection(const cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_SectionY)
+{
+	ASSERT(IsValid());
+	ASSERT((a_Area.GetDataTypes() & (cBlockArea::baTypes | cBlockArea::baMetas)) == (cBlockArea::baTypes | cBlockArea::baMetas));
+
+	// Intersect the area with the section:
+	const int SectionHeight = static_cast<int>(cChunkData::SectionHeight);
+	int BlockStartX = std::max(a_MinBlockX, m_PosX * cChunkDef::Width);
+	int BlockEndX   = std::min(a_MinBlockX + a_Area.GetSizeX(), (m_PosX + 1) * cChunkDef::Width);
+	int BlockStartY = std::max(a_MinBlockY, a_SectionY * SectionHeight);
+	int BlockEndY   = std::min(a_MinBlockY + a_Area.GetSizeY(), (a_SectionY + 1) * SectionHeight);
+	int BlockStartZ = std::max(a_MinBlockZ, m_PosZ * cChunkDef::Width);
+	int BlockEndZ   = std::min(a_MinBlockZ + a_Area.GetSizeZ(), (m_PosZ + 1) * cChunkDef::Width);
+	if ((BlockStartX >= BlockEndX) || (BlockStartY >= BlockEndY) || (BlockStartZ >= BlockEndZ))
+	{
+		return false;
+	}
+	int RelX = BlockStartX - m_PosX * cChunkDef::Width;
+	int RelZ = BlockStartZ - m_PosZ * cChunkDef::Width;
+	int SizeX = BlockEndX - BlockStartX;
+	int SizeY = BlockEndY - BlockStartY;
+	int SizeZ = BlockEndZ - BlockStartZ;
+
+	// The area's rows along X are contiguous, same as the chunk's:
+	size_t StrideZ = static_cast<size_t>(a_Area.GetSizeX());
+	size_t StrideY = StrideZ * static_cast<size_t>(a_Area.GetSizeZ());
+	size_t SrcIdx = static_cast<size_t>(a_Area.MakeIndex(BlockStartX - a_MinBlockX, BlockStartY - a_MinBlockY, BlockStartZ - a_MinBlockZ));
+	if (!m_ChunkData.WriteBox(
+		RelX, BlockStartY, RelZ, SizeX, SizeY, SizeZ,
+		a_Area.GetBlockTypes() + SrcIdx, a_Area.GetBlockMetas() + SrcIdx, StrideZ, StrideY
+	))
+	{
+		return false;
+	}
+
+	MarkDirty();
+	m_IsRedstoneDirty = true;
+	m_IsLightValid = false;
+	m_World->GetHopperScheduler().WakeUpInBox(BlockStartX, BlockStartY, BlockStartZ, BlockEndX - 1, BlockEndY - 1, BlockEndZ - 1);
+
+	// Update the heightmap; only the columns whose top is within the written box may change:
+	for (int z = RelZ; z < RelZ + SizeZ; z++)
+	{
+		for (int x = RelX; x < RelX + SizeX; x++)
+		{
+			HEIGHTTYPE & ColumnHeight = m_HeightMap[x + z * Width];
+			if (ColumnHeight >= BlockEndY)
+			{
+				continue;
+			}
+			// The column is all air above the box, rescan from the box's top down:
+			int y = BlockEndY - 1;
+			while ((y > 0) && (m_ChunkData.GetBlock(x, y, z) == E_BLOCK_AIR))
+			{
+				--y;
+			}
+			ColumnHeight = static_cast<HEIGHTTYPE>(y);
+		}
+	}
+	return true;
+}
+
+
+
+
+
 /// Returns true if there is a block entity at the coords specified
 bool cChunk::HasBlockEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ)
 {
@@ -475,25 +556,17 @@ void cChunk::Stay(bool a_Stay)
 void cChunk::CollectMobCensus(cMobCensus& toFill)
 {
 	toFill.CollectSpawnableChunk(*this);
-	std::list<const Vector3d*> playerPositions;
-	cPlayer* currentPlayer;
-	for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
-	{
-		currentPlayer = (*itr)->GetPlayer();
-		playerPositions.push_back(&(currentPlayer->GetPosition()));
-	}
 
-	Vector3d currentPosition;
-	for (cEntityList::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
+	for (cEntityVector::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
 	{
 		// LOGD("Counting entity #%i (%s)", (*itr)->GetUniqueID(), (*itr)->GetClass());
-		if ((*itr)->IsMob())
+		if ((*itr != nullptr) && (*itr)->IsMob())
 		{
 			cMonster& Monster = (cMonster&)(**itr);
-			currentPosition = Monster.GetPosition();
-			for (std::list<const Vector3d*>::const_iterator itr2 = playerPositions.begin(); itr2 != playerPositions.end(); ++itr2)
+			double DistanceSq = toFill.GetNearestPlayerDistanceSq(Monster.GetPosition());
+			if (DistanceSq >= 0)
 			{
-				toFill.CollectMob(Monster, *this, (currentPosition - **itr2).SqrLength());
+				toFill.CollectMob(Monster, *this, DistanceSq);
 			}
 		}
 	}  // for itr - m_Entitites[]
@@ -621,44 +694,89 @@ void cChunk::Tick(std::chrono::milliseconds a_Dt)
 		m_IsDirty = (*itr)->Tick(a_Dt, *this) | m_IsDirty;
 	}
 	
-	for (cEntityList::iterator itr = m_Entities.begin(); itr != m_Entities.end();)
+	// Decide which entities are ticked in this tick and by how much, based on their distance to the players.
+	// Zero time means the entity is skipped; mobs are ticked inside cWorld::TickMobs() (as we don't have to tick them if they are far away from players)
+	cEntityActivation & Activation = m_World->GetEntityActivation();
+	const cPlayerProximityGrid & PlayerGrid = m_World->GetPlayerGrid();
+	std::vector<std::chrono::milliseconds> & TickDts = m_EntityTickDts;
+	TickDts.assign(m_Entities.size(), std::chrono::milliseconds(0));
+	for (size_t i = 0; i < m_Entities.size(); i++)
+	{
+		cEntity * Entity = m_Entities[i];
+		if ((Entity != nullptr) && !Entity->IsMob())
+		{
+			Activation.ShouldTick(*Entity, PlayerGrid, a_Dt, TickDts[i]);
+		}
+	}
+
+	// Move the ticked item drops and XP orbs in a single pass, their Tick() skips the physics:
+	m_ChunkMap->GetEntityPhysicsBatch().Simulate(*this, m_Entities, TickDts);
+
+	// Merge the nearby item drops and XP orbs; the absorbed ones are destroyed and get removed below:
+	m_World->GetEntityMerger().MergeChunkEntities(m_PosX, m_PosZ, m_Entities);
+
+	// The destroyed entities are deleted only after all the entities have been processed:
+	cEntityVector ToDelete;
+	m_EntityIterationDepth++;
+	for (size_t i = 0; i < m_Entities.size(); i++)
 	{
-		if (!((*itr)->IsMob()))  // Mobs are ticked inside cWorld::TickMobs() (as we don't have to tick them if they are far away from players)
+		cEntity * Entity = m_Entities[i];
+		if (Entity == nullptr)
 		{
-			// Tick all entities in this chunk (except mobs):
-			(*itr)->Tick(a_Dt, *this);
+			// Removed during this iteration
+			continue;
 		}
 
-		if ((*itr)->IsDestroyed())  // Remove all entities that were scheduled for removal:
+		// The entities added while ticking are ticked fully:
+		std::chrono::milliseconds TickDt = (i < TickDts.size()) ? TickDts[i] : a_Dt;
+		if (!Entity->IsMob() && (TickDt.count() > 0) && !Entity->IsDestroyed())
 		{
-			LOGD("Destroying entity #%i (%s)", (*itr)->GetUniqueID(), (*itr)->GetClass());
+			// Tick all active entities in this chunk (except mobs):
+			Entity->Tick(TickDt, *this);
+			if (m_Entities[i] != Entity)
+			{
+				// The entity has removed itself from the chunk while ticking
+				continue;
+			}
+		}
+
+		if (Entity->IsDestroyed())  // Remove all entities that were scheduled for removal:
+		{
+			LOGD("Destroying entity #%i (%s)", Entity->GetUniqueID(), Entity->GetClass());
 			MarkDirty();
-			cEntity * ToDelete = *itr;
-			itr = m_Entities.erase(itr);
-			delete ToDelete;
+			EraseEntity(i);
+			ToDelete.push_back(Entity);
 		}
-		else if ((*itr)->IsWorldTravellingFrom(m_World))
+		else if (Entity->IsWorldTravellingFrom(m_World))
 		{
 			// Remove all entities that are travelling to another world
+			// They left this chunk's entity index when leaving the world, their cell may belong to the new world's chunk by now
 			MarkDirty();
-			(*itr)->SetWorldTravellingFrom(nullptr);
-			itr = m_Entities.erase(itr);
+			Entity->SetWorldTravellingFrom(nullptr);
+			EraseEntity(i, false);
 		}
 		else if (
-			((*itr)->GetChunkX() != m_PosX) ||
-			((*itr)->GetChunkZ() != m_PosZ)
+			(Entity->GetChunkX() != m_PosX) ||
+			(Entity->GetChunkZ() != m_PosZ)
 		)
 		{
 			// The entity moved out of the chunk, move it to the neighbor
 			MarkDirty();
-			MoveEntityToNewChunk(*itr);
-			itr = m_Entities.erase(itr);
+			EraseEntity(i);
+			MoveEntityToNewChunk(Entity);
 		}
 		else
 		{
-			++itr;
+			UpdateEntityCell(Entity);
 		}
-	}  // for itr - m_Entitites[]
+	}  // for i - m_Entitites[]
+	m_EntityIterationDepth--;
+	CompactEntities();
+
+	for (cEntityVector::iterator itr = ToDelete.begin(), end = ToDelete.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
 	
 	ApplyWeatherToTop();
 }
@@ -726,6 +844,128 @@ void cChunk::MoveEntityToNewChunk(cEntity * a_Entity)
 
 
 
+void cChunk::EraseEntity(size_t a_Index, bool a_ShouldRemoveFromCell)
+{
+	ASSERT(a_Index < m_Entities.size());
+	ASSERT(m_Entities[a_Index] != nullptr);
+
+	if (a_ShouldRemoveFromCell)
+	{
+		RemoveEntityFromCell(m_Entities[a_Index]);
+	}
+	if (m_EntityIterationDepth > 0)
+	{
+		// Swapping now would move a not-yet-visited entity behind the iteration, leave a hole instead:
+		m_Entities[a_Index] = nullptr;
+		m_HasEntityHoles = true;
+		return;
+	}
+	m_Entities[a_Index] = m_Entities.back();
+	m_Entities.pop_back();
+}
+
+
+
+
+
+void cChunk::CompactEntities(void)
+{
+	if ((m_EntityIterationDepth > 0) || !m_HasEntityHoles)
+	{
+		return;
+	}
+	m_Entities.erase(std::remove(m_Entities.begin(), m_Entities.end(), nullptr), m_Entities.end());
+	m_HasEntityHoles = false;
+}
+
+
+
+
+
+int cChunk::GetEntityCellIndex(double a_PosY)
+{
+	int Cell = FloorC(a_PosY / ENTITY_CELL_HEIGHT);
+	if (Cell < 0)
+	{
+		return 0;
+	}
+	if (Cell >= NUM_ENTITY_CELLS)
+	{
+		return NUM_ENTITY_CELLS - 1;
+	}
+	return Cell;
+}
+
+
+
+
+
+void cChunk::AddEntityToCell(cEntity * a_Entity)
+{
+	ASSERT(a_Entity->GetChunkEntityCell() < 0);  // Not in any cell yet
+	int Cell = GetEntityCellIndex(a_Entity->GetPosY());
+	a_Entity->SetChunkEntityCell(this, m_ChunkMap, Cell, m_EntityCells[Cell].size());
+	m_EntityCells[Cell].push_back(a_Entity);
+}
+
+
+
+
+
+void cChunk::RemoveEntityFromCell(cEntity * a_Entity)
+{
+	if (a_Entity->GetChunkEntityCellChunk() != this)
+	{
+		// Not indexed by this chunk; it has already left the world, or hasn't been added to the cells yet
+		return;
+	}
+	int Cell = a_Entity->GetChunkEntityCell();
+	ASSERT((Cell >= 0) && (Cell < NUM_ENTITY_CELLS));
+	cEntityCell & Entities = m_EntityCells[Cell];
+	size_t Idx = a_Entity->GetChunkEntityCellIdx();
+	ASSERT((Idx < Entities.size()) && (Entities[Idx] == a_Entity));
+
+	// The order within a cell doesn't matter, swap with the last one to avoid moving the rest:
+	cEntity * Last = Entities.back();
+	Entities[Idx] = Last;
+	Last->SetChunkEntityCellIdx(Idx);
+	Entities.pop_back();
+	a_Entity->SetChunkEntityCell(nullptr, nullptr, -1, 0);
+}
+
+
+
+
+
+void cChunk::UpdateEntityCell(cEntity * a_Entity)
+{
+	if (a_Entity->GetChunkEntityCellChunk() != this)
+	{
+		// Left the world, it is not indexed by this chunk anymore
+		return;
+	}
+	if (a_Entity->GetChunkEntityCell() == GetEntityCellIndex(a_Entity->GetPosY()))
+	{
+		return;
+	}
+	RemoveEntityFromCell(a_Entity);
+	AddEntityToCell(a_Entity);
+}
+
+
+
+
+
+void cChunk::GetEntityCellRange(double a_MinY, double a_MaxY, int & a_MinCell, int & a_MaxCell)
+{
+	a_MinCell = GetEntityCellIndex(a_MinY - ENTITY_CELL_QUERY_MARGIN);
+	a_MaxCell = GetEntityCellIndex(a_MaxY + ENTITY_CELL_QUERY_MARGIN);
+}
+
+
+
+
+
 void cChunk::ProcessQueuedSetBlocks(void)
 {
 	Int64 CurrTick = m_World->GetWorldAge();
@@ -779,11 +1019,7 @@ void cChunk::BroadcastPendingBlockChanges(void)
 
 	if (m_PendingSendBlocks.size() >= 10240)
 	{
-		// Resend the full chunk
-		for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
-		{
-			m_World->ForceSendChunkTo(m_PosX, m_PosZ, cChunkSender::E_CHUNK_PRIORITY_MEDIUM, (*itr));
-		}
+		ResendToClients();
 	}
 	else
 	{
@@ -800,6 +1036,18 @@ void cChunk::BroadcastPendingBlockChanges(void)
 
 
 
+void cChunk::ResendToClients(void)
+{
+	for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
+	{
+		m_World->ForceSendChunkTo(m_PosX, m_PosZ, cChunkSender::E_CHUNK_PRIORITY_MEDIUM, (*itr));
+	}
+}
+
+
+
+
+
 void cChunk::CheckBlocks()
 {
 	if (m_ToTickBlocks.empty())
@@ -1424,6 +1672,15 @@ void cChunk::WakeUpSimulators(void)
 
 
 
+void cChunk::WakeUpHoppersAt(int a_RelX, int a_RelY, int a_RelZ)
+{
+	m_World->GetHopperScheduler().WakeUpAt(a_RelX + m_PosX * Width, a_RelY, a_RelZ + m_PosZ * Width);
+}
+
+
+
+
+
 void cChunk::CalculateHeightmap(const BLOCKTYPE * a_BlockTypes)
 {
 	for (int x = 0; x < Width; x++)
@@ -1566,6 +1823,7 @@ void cChunk::FastSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockT
 
 	MarkDirty();
 	m_IsRedstoneDirty = true;
+	WakeUpHoppersAt(a_RelX, a_RelY, a_RelZ);
 
 	m_ChunkData.SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType);
 
@@ -1768,43 +2026,42 @@ void cChunk::CollectPickupsByPlayer(cPlayer & a_Player)
 	double PosX = a_Player.GetPosX();
 	double PosY = a_Player.GetPosY();
 	double PosZ = a_Player.GetPosZ();
-	
-	for (cEntityList::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
+
+	// Only the cells around the player can contain collectable items:
+	int MinCell, MaxCell;
+	GetEntityCellRange(PosY - 1.5, PosY + 1.5, MinCell, MaxCell);
+	for (int Cell = MinCell; Cell <= MaxCell; Cell++)
 	{
-		if ((!(*itr)->IsPickup()) && (!(*itr)->IsProjectile()))
-		{
-			continue;  // Only pickups and projectiles can be picked up
-		}
-		float DiffX = (float)((*itr)->GetPosX() - PosX);
-		float DiffY = (float)((*itr)->GetPosY() - PosY);
-		float DiffZ = (float)((*itr)->GetPosZ() - PosZ);
-		float SqrDist = DiffX * DiffX + DiffY * DiffY + DiffZ * DiffZ;
-		if (SqrDist < 1.5f * 1.5f)  // 1.5 block
+		cEntityCell & Entities = m_EntityCells[Cell];
+		for (cEntityCell::iterator itr = Entities.begin(); itr != Entities.end(); ++itr)
 		{
-			/*
-			LOG("Pickup %d being collected by player \"%s\", distance %f",
-				(*itr)->GetUniqueID(), a_Player->GetName().c_str(), SqrDist
-			);
-			*/
-			MarkDirty();
-			if ((*itr)->IsPickup())
+			if ((!(*itr)->IsPickup()) && (!(*itr)->IsProjectile()))
 			{
-				(reinterpret_cast<cPickup *>(*itr))->CollectedBy(a_Player);
+				continue;  // Only pickups and projectiles can be picked up
 			}
-			else
+			float DiffX = (float)((*itr)->GetPosX() - PosX);
+			float DiffY = (float)((*itr)->GetPosY() - PosY);
+			float DiffZ = (float)((*itr)->GetPosZ() - PosZ);
+			float SqrDist = DiffX * DiffX + DiffY * DiffY + DiffZ * DiffZ;
+			if (SqrDist < 1.5f * 1.5f)  // 1.5 block
 			{
-				(reinterpret_cast<cProjectileEntity *>(*itr))->CollectedBy(a_Player);
+				/*
+				LOG("Pickup %d being collected by player \"%s\", distance %f",
+					(*itr)->GetUniqueID(), a_Player->GetName().c_str(), SqrDist
+				);
+				*/
+				MarkDirty();
+				if ((*itr)->IsPickup())
+				{
+					(reinterpret_cast<cPickup *>(*itr))->CollectedBy(a_Player);
+				}
+				else
+				{
+					(reinterpret_cast<cProjectileEntity *>(*itr))->CollectedBy(a_Player);
+				}
 			}
-		}
-		else if (SqrDist < 5 * 5)
-		{
-			/*
-			LOG("Pickup %d close to player \"%s\", but still too far to collect: %f",
-				(*itr)->GetUniqueID(), a_Player->GetName().c_str(), SqrDist
-			);
-			*/
-		}
-	}
+		}  // for itr - Entities[]
+	}  // for Cell - m_EntityCells[]
 }
 
 
@@ -1861,8 +2118,12 @@ bool cChunk::AddClient(cClientHandle * a_Client)
 	}
 	m_LoadedByClient.push_back( a_Client);
 
-	for (cEntityList::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
+	for (cEntityVector::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
 	{
+		if (*itr == nullptr)
+		{
+			continue;
+		}
 		/*
 		// DEBUG:
 		LOGD("cChunk: Entity #%d (%s) at [%i, %i, %i] spawning for player \"%s\"",
@@ -1893,8 +2154,12 @@ void cChunk::RemoveClient(cClientHandle * a_Client)
 
 		if (!a_Client->IsDestroyed())
 		{
-			for (cEntityList::iterator itrE = m_Entities.begin(); itrE != m_Entities.end(); ++itrE)
+			for (cEntityVector::iterator itrE = m_Entities.begin(); itrE != m_Entities.end(); ++itrE)
 			{
+				if (*itrE == nullptr)
+				{
+					continue;
+				}
 				/*
 				// DEBUG:
 				LOGD("chunk [%i, %i] destroying entity #%i for player \"%s\"",
@@ -1948,6 +2213,7 @@ void cChunk::AddEntity(cEntity * a_Entity)
 	ASSERT(std::find(m_Entities.begin(), m_Entities.end(), a_Entity) == m_Entities.end());  // Not there already
 
 	m_Entities.push_back(a_Entity);
+	AddEntityToCell(a_Entity);
 }
 
 
@@ -1956,7 +2222,11 @@ void cChunk::AddEntity(cEntity * a_Entity)
 
 void cChunk::RemoveEntity(cEntity * a_Entity)
 {
-	m_Entities.remove(a_Entity);
+	cEntityVector::iterator itr = std::find(m_Entities.begin(), m_Entities.end(), a_Entity);
+	if (itr != m_Entities.end())
+	{
+		EraseEntity(static_cast<size_t>(itr - m_Entities.begin()));
+	}
 
 	// Mark as dirty if it was a server-generated entity:
 	if (!a_Entity->IsPlayer())
@@ -1971,9 +2241,9 @@ void cChunk::RemoveEntity(cEntity * a_Entity)
 
 bool cChunk::HasEntity(UInt32 a_EntityID)
 {
-	for (cEntityList::const_iterator itr = m_Entities.begin(), end = m_Entities.end(); itr != end; ++itr)
+	for (cEntityVector::const_iterator itr = m_Entities.begin(), end = m_Entities.end(); itr != end; ++itr)
 	{
-		if ((*itr)->GetUniqueID() == a_EntityID)
+		if ((*itr != nullptr) && ((*itr)->GetUniqueID() == a_EntityID))
 		{
 			return true;
 		}
@@ -1988,15 +2258,20 @@ bool cChunk::HasEntity(UInt32 a_EntityID)
 bool cChunk::ForEachEntity(cEntityCallback & a_Callback)
 {
 	// The entity list is locked by the parent chunkmap's CS
-	for (cEntityList::iterator itr = m_Entities.begin(), itr2 = itr; itr != m_Entities.end(); itr = itr2)
+	// The callback may remove entities, which then leave holes until the iteration is over:
+	bool res = true;
+	m_EntityIterationDepth++;
+	for (size_t i = 0; i < m_Entities.size(); i++)
 	{
-		++itr2;
-		if (a_Callback.Item(*itr))
+		if ((m_Entities[i] != nullptr) && a_Callback.Item(m_Entities[i]))
 		{
-			return false;
+			res = false;
+			break;
 		}
-	}  // for itr - m_Entitites[]
-	return true;
+	}  // for i - m_Entitites[]
+	m_EntityIterationDepth--;
+	CompactEntities();
+	return res;
 }
 
 
@@ -2006,20 +2281,16 @@ bool cChunk::ForEachEntity(cEntityCallback & a_Callback)
 bool cChunk::ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback & a_Callback)
 {
 	// The entity list is locked by the parent chunkmap's CS
-	for (cEntityList::iterator itr = m_Entities.begin(), itr2 = itr; itr != m_Entities.end(); itr = itr2)
+	// Collect the entities first, the callback may add or remove entities and thus modify the cells:
+	std::vector<cEntity *> Entities;
+	CollectEntitiesInBox(a_Box, Entities);
+	for (std::vector<cEntity *>::iterator itr = Entities.begin(), end = Entities.end(); itr != end; ++itr)
 	{
-		++itr2;
-		cBoundingBox EntBox((*itr)->GetPosition(), (*itr)->GetWidth() / 2, (*itr)->GetHeight());
-		if (!EntBox.DoesIntersect(a_Box))
-		{
-			// The entity is not in the specified box
-			continue;
-		}
 		if (a_Callback.Item(*itr))
 		{
 			return false;
 		}
-	}  // for itr - m_Entitites[]
+	}  // for itr - Entitites[]
 	return true;
 }
 
@@ -2027,12 +2298,36 @@ bool cChunk::ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback & a_
 
 
 
+void cChunk::CollectEntitiesInBox(const cBoundingBox & a_Box, std::vector<cEntity *> & a_Entities)
+{
+	int MinCell, MaxCell;
+	GetEntityCellRange(a_Box.GetMinY(), a_Box.GetMaxY(), MinCell, MaxCell);
+	for (int Cell = MinCell; Cell <= MaxCell; Cell++)
+	{
+		const cEntityCell & Entities = m_EntityCells[Cell];
+		for (cEntityCell::const_iterator itr = Entities.begin(), end = Entities.end(); itr != end; ++itr)
+		{
+			cBoundingBox EntBox((*itr)->GetPosition(), (*itr)->GetWidth() / 2, (*itr)->GetHeight());
+			if (!EntBox.DoesIntersect(a_Box))
+			{
+				// The entity is not in the specified box
+				continue;
+			}
+			a_Entities.push_back(*itr);
+		}  // for itr - Entities[]
+	}  // for Cell - m_EntityCells[]
+}
+
+
+
+
+
 bool cChunk::DoWithEntityByID(UInt32 a_EntityID, cEntityCallback & a_Callback, bool & a_CallbackResult)
 {
 	// The entity list is locked by the parent chunkmap's CS
-	for (cEntityList::iterator itr = m_Entities.begin(), end = m_Entities.end(); itr != end; ++itr)
+	for (cEntityVector::iterator itr = m_Entities.begin(), end = m_Entities.end(); itr != end; ++itr)
 	{
-		if ((*itr)->GetUniqueID() == a_EntityID)
+		if ((*itr != nullptr) && ((*itr)->GetUniqueID() == a_EntityID))
 		{
 			a_CallbackResult = a_Callback.Item(*itr);
 			return true;
@@ -2221,6 +2516,7 @@ bool cChunk::DoWithRedstonePoweredEntityAt(int a_BlockX, int a_BlockY, int a_Blo
 		{
 			case E_BLOCK_DROPPER:
 			case E_BLOCK_DISPENSER:
+			case E_BLOCK_HOPPER:
 			case E_BLOCK_NOTE_BLOCK:
 			{
 				break;
@@ -2980,6 +3276,29 @@ void cChunk::BroadcastEntityMetadata(const cEntity & a_Entity, const cClientHand
 
 
 
+bool cChunk::BroadcastEntityMovement(cEntity & a_Entity, const cEntityTracker::sMovement & a_Movement, const cClientHandle * a_Exclude)
+{
+	cEntityTracker & Tracker = m_World->GetEntityTracker();
+	Int64 WorldAge = m_World->GetWorldAge();
+	bool HasUnsyncedClients = false;
+	for (cClientHandleList::const_iterator itr = m_LoadedByClient.begin(); itr != m_LoadedByClient.end(); ++itr)
+	{
+		if (*itr == a_Exclude)
+		{
+			continue;
+		}
+		if (Tracker.SendMovement(**itr, a_Entity, a_Movement, WorldAge))
+		{
+			HasUnsyncedClients = true;
+		}
+	}  // for itr - LoadedByClient[]
+	return HasUnsyncedClients;
+}
+
+
+
+
+
 void cChunk::BroadcastEntityRelMove(const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude)
 {
 	for (cClientHandleList::const_iterator itr = m_LoadedByClient.begin(); itr != m_LoadedByClient.end(); ++itr)
@@ -146,6 +146,14 @@ public:
 	/** Writes the specified cBlockArea at the coords specified. Note that the coords may extend beyond the chunk! */
 	void WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes);
 
+	/** Writes the part of the cBlockArea (types + metas) that falls into the specified chunk section, a row at a time.
+	The changed blocks are not queued for the clients, the caller is expected to resend the whole chunk afterwards.
+	Returns true if any block has changed. */
+	bool WriteBlockAreaSection(const cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_SectionY);
+
+	/** Sends the whole chunk again to all the clients that have it loaded */
+	void ResendToClients(void);
+
 	/** Returns true if there is a block entity at the coords specified */
 	bool HasBlockEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ);
 	
@@ -242,6 +250,9 @@ public:
 	void AddEntity(cEntity * a_Entity);
 	void RemoveEntity(cEntity * a_Entity);
 	bool HasEntity(UInt32 a_EntityID);
+
+	/** Moves the entity into a different entity cell, if it has moved vertically out of its current one */
+	void UpdateEntityCell(cEntity * a_Entity);
 	
 	/** Calls the callback for each entity; returns true if all entities processed, false if the callback aborted by returning true */
 	bool ForEachEntity(cEntityCallback & a_Callback);  // Lua-accessible
@@ -250,6 +261,10 @@ public:
 	Returns true if all entities processed, false if the callback aborted by returning true. */
 	bool ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback & a_Callback);  // Lua-accessible
 
+	/** Appends all the entities that have a nonempty intersection with the specified boundingbox to a_Entities.
+	Uses the entity index, so only the cells that may contain such entities are scanned. */
+	void CollectEntitiesInBox(const cBoundingBox & a_Box, std::vector<cEntity *> & a_Entities);
+
 	/** Calls the callback if the entity with the specified ID is found, with the entity object as the callback param. Returns true if entity found. */
 	bool DoWithEntityByID(UInt32 a_EntityID, cEntityCallback & a_Callback, bool & a_CallbackResult);  // Lua-accessible
 
@@ -327,6 +342,7 @@ public:
 	void BroadcastEntityHeadLook     (const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityLook         (const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityMetadata     (const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
+	bool BroadcastEntityMovement     (cEntity & a_Entity, const cEntityTracker::sMovement & a_Movement, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityRelMove      (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityRelMoveLook  (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityStatus       (const cEntity & a_Entity, char a_Status, const cClientHandle * a_Exclude = nullptr);
@@ -375,6 +391,7 @@ public:
 			{
 				MarkDirty();
 				m_IsRedstoneDirty = true;
+				WakeUpHoppersAt(a_RelX, a_RelY, a_RelZ);
 				
 				m_PendingSendBlocks.push_back(sSetBlock(m_PosX, m_PosZ, a_RelX, a_RelY, a_RelZ, GetBlock(a_RelX, a_RelY, a_RelZ), a_Meta));
 			}
@@ -382,6 +399,9 @@ public:
 
 	inline NIBBLETYPE GetBlockLight(int a_RelX, int a_RelY, int a_RelZ) const {return m_ChunkData.GetBlockLight(a_RelX, a_RelY, a_RelZ); }
 	inline NIBBLETYPE GetSkyLight  (int a_RelX, int a_RelY, int a_RelZ) const {return m_ChunkData.GetSkyLight(a_RelX, a_RelY, a_RelZ); }
+
+	/** Returns the chunk's block storage, for the direct section access by cChunkNeighborhood */
+	const cChunkData & GetChunkData(void) const { return m_ChunkData; }
 	
 	/** Same as GetBlock(), but relative coords needn't be in this chunk (uses m_Neighbor-s or m_ChunkMap in such a case); returns true on success */
 	bool UnboundedRelGetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta) const;
@@ -461,6 +481,18 @@ private:
 	} ;
 
 	typedef std::vector<sSetBlockQueueItem> sSetBlockQueueVector;
+
+	/** Height of a single cell of the entity index, in blocks */
+	static const int ENTITY_CELL_HEIGHT = 16;
+
+	/** Number of cells in the entity index. Entities below / above the world are stored in the bottom / top cell. */
+	static const int NUM_ENTITY_CELLS = cChunkDef::Height / ENTITY_CELL_HEIGHT;
+
+	/** Distance, in blocks, by which the entity index queries are extended vertically.
+	Covers the tallest entities, whose bounding box reaches from their position into the cells above it. */
+	static const int ENTITY_CELL_QUERY_MARGIN = cEntity::MAX_HEIGHT;
+
+	typedef cEntityVector cEntityCell;
 	
 
 	/** Holds the presence status of the chunk - if it is present, or in the loader / generator queue, or unloaded */
@@ -481,8 +513,28 @@ private:
 	
 	// A critical section is not needed, because all chunk access is protected by its parent ChunkMap's csLayers
 	cClientHandleList  m_LoadedByClient;
-	cEntityList        m_Entities;
 	cBlockEntityList   m_BlockEntities;
+
+	/** All the entities in the chunk, in no particular order.
+	Removed by swapping with the last one, except while being iterated over (see m_EntityIterationDepth). */
+	cEntityVector m_Entities;
+
+	/** Number of the iterations over m_Entities in progress (Tick(), ForEachEntity()).
+	While nonzero, the removed entities leave a nullptr hole in m_Entities instead of being swapped out,
+	so that the iterations don't skip any entity; the holes are compacted once the last iteration is over. */
+	int m_EntityIterationDepth;
+
+	/** True if m_Entities contains nullptr holes left by entities removed during an iteration */
+	bool m_HasEntityHoles;
+
+	/** The time by which each entity in m_Entities is ticked in the current tick, see cEntityActivation.
+	Only used within Tick(), kept as a member so that its memory is reused across the ticks. */
+	std::vector<std::chrono::milliseconds> m_EntityTickDts;
+
+	/** Spatial index of m_Entities: the same entities, sorted into vertical cells by their Y coord.
+	Box and range queries only scan the cells that overlap the queried range instead of all the entities in the chunk.
+	Each entity remembers its cell (cEntity::GetChunkEntityCell()), the cells are updated as the entities move in Tick() and when their position is set directly. */
+	cEntityCell m_EntityCells[NUM_ENTITY_CELLS];
 	
 	/** Number of times the chunk has been requested to stay (by various cChunkStay objects); if zero, the chunk can be unloaded */
 	int m_StayCount;
@@ -534,6 +586,9 @@ private:
 	/** Wakes up each simulator for its specific blocks; through all the blocks in the chunk */
 	void WakeUpSimulators(void);
 
+	/** Wakes up the sleeping hoppers that watch the specified block, after the block has changed */
+	void WakeUpHoppersAt(int a_RelX, int a_RelY, int a_RelZ);
+
 	/** Sends m_PendingSendBlocks to all clients */
 	void BroadcastPendingBlockChanges(void);
 	
@@ -557,6 +612,25 @@ private:
 	
 	/** Called by Tick() when an entity moves out of this chunk into a neighbor; moves the entity and sends spawn / despawn packet to clients */
 	void MoveEntityToNewChunk(cEntity * a_Entity);
+
+	/** Removes the entity at the specified index from m_Entities and, unless a_ShouldRemoveFromCell is false, from the entity index.
+	Swaps it with the last entity, or leaves a hole if an iteration over m_Entities is in progress. */
+	void EraseEntity(size_t a_Index, bool a_ShouldRemoveFromCell = true);
+
+	/** Removes the holes left in m_Entities by the removals during iterations, if no iteration is in progress anymore */
+	void CompactEntities(void);
+
+	/** Returns the index of the entity cell containing the specified Y coord, clamped to the valid range */
+	static int GetEntityCellIndex(double a_PosY);
+
+	/** Adds the entity to the entity cell corresponding to its current position */
+	void AddEntityToCell(cEntity * a_Entity);
+
+	/** Removes the entity from the entity cell that it is stored in; ignored if not stored in any of this chunk's cells */
+	void RemoveEntityFromCell(cEntity * a_Entity);
+
+	/** Returns the range of entity cells that may contain entities intersecting the specified Y range */
+	static void GetEntityCellRange(double a_MinY, double a_MaxY, int & a_MinCell, int & a_MaxCell);
 	
 	/** Processes all blocks that have been scheduled for replacement by the QueueSetBlock() function */
 	void ProcessQueuedSetBlocks(void);
@@ -493,6 +493,89 @@ void cChunkData::SetMetas(const NIBBLETYPE * a_Src)
 
 
 
+bool cChunkData::WriteBox(
+	int a_RelX, int a_RelY, int a_RelZ, int a_SizeX, int a_SizeY, int a_SizeZ,
+	const BLOCKTYPE * a_SrcTypes, const NIBBLETYPE * a_SrcMetas, size_t a_SrcStrideZ, size_t a_SrcStrideY
+)
+{
+	ASSERT((a_RelX >= 0) && (a_SizeX > 0) && (a_RelX + a_SizeX <= cChunkDef::Width));
+	ASSERT((a_RelZ >= 0) && (a_SizeZ > 0) && (a_RelZ + a_SizeZ <= cChunkDef::Width));
+	ASSERT((a_RelY >= 0) && (a_SizeY > 0) && (a_RelY + a_SizeY <= cChunkDef::Height));
+
+	size_t SectionNum = static_cast<size_t>(a_RelY) / SectionHeight;
+	ASSERT(static_cast<size_t>(a_RelY + a_SizeY - 1) / SectionHeight == SectionNum);
+	int SectionY = a_RelY - static_cast<int>(SectionNum * SectionHeight);
+
+	if (m_Sections[SectionNum] == nullptr)
+	{
+		// Writing air into an unallocated section changes nothing, allocate it only if there's something else:
+		bool IsAllAir = true;
+		for (int y = 0; (y < a_SizeY) && IsAllAir; y++)
+		{
+			for (int z = 0; (z < a_SizeZ) && IsAllAir; z++)
+			{
+				size_t SrcIdx = static_cast<size_t>(y) * a_SrcStrideY + static_cast<size_t>(z) * a_SrcStrideZ;
+				for (int x = 0; x < a_SizeX; x++)
+				{
+					if ((a_SrcTypes[SrcIdx + static_cast<size_t>(x)] != E_BLOCK_AIR) || ((a_SrcMetas[SrcIdx + static_cast<size_t>(x)] & 0x0f) != 0))
+					{
+						IsAllAir = false;
+						break;
+					}
+				}
+			}
+		}
+		if (IsAllAir)
+		{
+			return false;
+		}
+		m_Sections[SectionNum] = Allocate();
+		if (m_Sections[SectionNum] == nullptr)
+		{
+			ASSERT(!"Failed to allocate a new section in Chunkbuffer");
+			return false;
+		}
+		ZeroSection(m_Sections[SectionNum]);
+	}
+
+	sChunkSection & Section = *m_Sections[SectionNum];
+	bool HasChanged = false;
+	for (int y = 0; y < a_SizeY; y++)
+	{
+		for (int z = 0; z < a_SizeZ; z++)
+		{
+			size_t SrcIdx = static_cast<size_t>(y) * a_SrcStrideY + static_cast<size_t>(z) * a_SrcStrideZ;
+			int DstIdx = cChunkDef::MakeIndexNoCheck(a_RelX, SectionY + y, a_RelZ + z);
+
+			// The types are contiguous along X in both arrays:
+			if (memcmp(Section.m_BlockTypes + DstIdx, a_SrcTypes + SrcIdx, static_cast<size_t>(a_SizeX)) != 0)
+			{
+				memcpy(Section.m_BlockTypes + DstIdx, a_SrcTypes + SrcIdx, static_cast<size_t>(a_SizeX));
+				HasChanged = true;
+			}
+
+			// The metas need packing into nibbles:
+			for (int x = 0; x < a_SizeX; x++)
+			{
+				int Idx = DstIdx + x;
+				int Shift = (Idx & 1) * 4;
+				NIBBLETYPE & Dst = Section.m_BlockMetas[Idx / 2];
+				NIBBLETYPE NewNibble = a_SrcMetas[SrcIdx + static_cast<size_t>(x)] & 0x0f;
+				if (((Dst >> Shift) & 0x0f) != NewNibble)
+				{
+					Dst = static_cast<NIBBLETYPE>((Dst & (0xf0 >> Shift)) | (NewNibble << Shift));
+					HasChanged = true;
+				}
+			}
+		}  // for z
+	}  // for y
+	return HasChanged;
+}
+
+
+
+
+
 void cChunkData::SetBlockLight(const NIBBLETYPE * a_Src)
 {
 	if (a_Src == nullptr)
@@ -27,14 +27,12 @@
 
 class cChunkData
 {
-private:
+public:
 
 	static const size_t SectionHeight = 16;
 	static const size_t NumSections = (cChunkDef::Height / SectionHeight);
 	static const size_t SectionBlockCount = SectionHeight * cChunkDef::Width * cChunkDef::Width;
 
-public:
-
 	struct sChunkSection;
 
 	cChunkData(cAllocationPool<cChunkData::sChunkSection> & a_Pool);
@@ -60,6 +58,14 @@ public:
 	
 	NIBBLETYPE GetSkyLight(int a_RelX, int a_RelY, int a_RelZ) const;
 	
+	/** Returns the specified section, or nullptr if the section is not allocated (all air).
+	The pointer stays valid until this object is destroyed or assigned to; sections are never freed on their own. */
+	const sChunkSection * GetSection(size_t a_SectionNum) const
+	{
+		ASSERT(a_SectionNum < NumSections);
+		return m_Sections[a_SectionNum];
+	}
+
 	/** Creates a (deep) copy of self. */
 	cChunkData Copy(void) const;
 
@@ -86,6 +92,15 @@ public:
 	Requires that a_Src is a valid pointer. */
 	void SetMetas(const NIBBLETYPE * a_Src);
 
+	/** Writes a box of block types and metas that lies within a single section, copying the types row by row.
+	The box is given in chunk-relative coords. a_SrcTypes and a_SrcMetas point to the box's first block;
+	the metas are unpacked, one per byte. The rows along X are a_SrcStrideZ apart, the layers a_SrcStrideY apart.
+	Allocates the section only if the box contains a non-air block. Returns true if any block has changed. */
+	bool WriteBox(
+		int a_RelX, int a_RelY, int a_RelZ, int a_SizeX, int a_SizeY, int a_SizeZ,
+		const BLOCKTYPE * a_SrcTypes, const NIBBLETYPE * a_SrcMetas, size_t a_SrcStrideZ, size_t a_SrcStrideY
+	);
+
 	/** Copies the blocklight data from the specified flat array into the internal representation.
 	Allocates sectios that are needed for the operation.
 	Allows a_Src to be nullptr, in which case it doesn't do anything. */
@@ -32,6 +32,7 @@ class cClientHandle;
 class cBlockEntity;
 
 typedef std::list<cEntity *>        cEntityList;
+typedef std::vector<cEntity *>      cEntityVector;
 typedef std::list<cBlockEntity *>   cBlockEntityList;
 
 
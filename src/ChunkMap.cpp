@@ -537,6 +537,23 @@ void cChunkMap::BroadcastEntityMetadata(const cEntity & a_Entity, const cClientH
 
 
 
+bool cChunkMap::BroadcastEntityMovement(cEntity & a_Entity, const cEntityTracker::sMovement & a_Movement, const cClientHandle * a_Exclude)
+{
+	cCSLock Lock(m_CSLayers);
+	cChunkPtr Chunk = GetChunkNoGen(a_Entity.GetChunkX(), a_Entity.GetChunkZ());
+	if (Chunk == nullptr)
+	{
+		return false;
+	}
+	// It's perfectly legal to broadcast packets even to invalid chunks!
+	return Chunk->BroadcastEntityMovement(a_Entity, a_Movement, a_Exclude);
+}
+
+
+
+
+
+
 void cChunkMap::BroadcastEntityRelMove(const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude)
 {
 	cCSLock Lock(m_CSLayers);
@@ -1809,6 +1826,36 @@ void cChunkMap::RemoveEntity(cEntity * a_Entity)
 
 
 
+void cChunkMap::UpdateEntityCell(cEntity & a_Entity)
+{
+	cCSLock Lock(m_CSLayers);
+	if (a_Entity.GetChunkEntityCellMap() != this)
+	{
+		// Not stored in this chunkmap, or moved to another one before the lock was acquired
+		return;
+	}
+	a_Entity.GetChunkEntityCellChunk()->UpdateEntityCell(&a_Entity);
+}
+
+
+
+
+
+void cChunkMap::RemoveEntityFromCell(cEntity & a_Entity)
+{
+	cCSLock Lock(m_CSLayers);
+	if (a_Entity.GetChunkEntityCellMap() != this)
+	{
+		// Not stored in this chunkmap, or moved to another one before the lock was acquired
+		return;
+	}
+	a_Entity.GetChunkEntityCellChunk()->RemoveEntityFromCell(&a_Entity);
+}
+
+
+
+
+
 bool cChunkMap::ForEachEntity(cEntityCallback & a_Callback)
 {
 	cCSLock Lock(m_CSLayers);
@@ -1873,6 +1920,67 @@ bool cChunkMap::ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback &
 
 
 
+bool cChunkMap::ForEachEntityNearest(const Vector3d & a_Pos, double a_Radius, size_t a_MaxCount, cEntityCallback & a_Callback)
+{
+	cBoundingBox Box(a_Pos - Vector3d(a_Radius, a_Radius, a_Radius), a_Pos + Vector3d(a_Radius, a_Radius, a_Radius));
+	int MinChunkX = FloorC(Box.GetMinX() / cChunkDef::Width);
+	int MinChunkZ = FloorC(Box.GetMinZ() / cChunkDef::Width);
+	int MaxChunkX = FloorC(Box.GetMaxX() / cChunkDef::Width);
+	int MaxChunkZ = FloorC(Box.GetMaxZ() / cChunkDef::Width);
+
+	cCSLock Lock(m_CSLayers);
+
+	// Collect the candidates from the entity index of each chunk in the range:
+	std::vector<cEntity *> Entities;
+	for (int z = MinChunkZ; z <= MaxChunkZ; z++)
+	{
+		for (int x = MinChunkX; x <= MaxChunkX; x++)
+		{
+			cChunkPtr Chunk = GetChunkNoGen(x, z);
+			if ((Chunk == nullptr) || !Chunk->IsValid())
+			{
+				continue;
+			}
+			Chunk->CollectEntitiesInBox(Box, Entities);
+		}  // for x
+	}  // for z
+
+	// Keep only the entities within the radius, paired with their squared distance:
+	typedef std::pair<double, cEntity *> cDistEntity;
+	std::vector<cDistEntity> Nearest;
+	Nearest.reserve(Entities.size());
+	double RadiusSq = a_Radius * a_Radius;
+	for (std::vector<cEntity *>::const_iterator itr = Entities.begin(), end = Entities.end(); itr != end; ++itr)
+	{
+		double DistSq = ((*itr)->GetPosition() - a_Pos).SqrLength();
+		if (DistSq <= RadiusSq)
+		{
+			Nearest.push_back(cDistEntity(DistSq, *itr));
+		}
+	}
+
+	// Only the first a_MaxCount entities need to be sorted:
+	size_t Count = std::min(a_MaxCount, Nearest.size());
+	std::partial_sort(Nearest.begin(), Nearest.begin() + static_cast<ptrdiff_t>(Count), Nearest.end(),
+		[](const cDistEntity & a_First, const cDistEntity & a_Second)
+		{
+			return (a_First.first < a_Second.first);
+		}
+	);
+	for (size_t i = 0; i < Count; i++)
+	{
+		if (a_Callback.Item(Nearest[i].second))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+
+
 void cChunkMap::DoExplosionAt(double a_ExplosionSize, double a_BlockX, double a_BlockY, double a_BlockZ, cVector3iArray & a_BlocksAffected)
 {
 	// Don't explode if outside of Y range (prevents the following test running into unallocated memory):
@@ -2055,7 +2163,7 @@ void cChunkMap::DoExplosionAt(double a_ExplosionSize, double a_BlockX, double a_
 
 
 	cTNTDamageCallback TNTDamageCallback(bbTNT, Vector3d(a_BlockX, a_BlockY, a_BlockZ), ExplosionSizeInt);
-	ForEachEntity(TNTDamageCallback);
+	ForEachEntityInBox(bbTNT, TNTDamageCallback);
 
 	// Wake up all simulators for the area, so that water and lava flows and sand falls into the blasted holes (FS #391):
 	WakeUpSimulatorsInArea(
@@ -2631,6 +2739,40 @@ bool cChunkMap::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBl
 
 
 
+bool cChunkMap::WriteBlockAreaSection(const cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_ChunkX, int a_ChunkZ, int a_SectionY, bool & a_HasChanged)
+{
+	cCSLock Lock(m_CSLayers);
+	cChunkPtr Chunk = GetChunkNoLoad(a_ChunkX, a_ChunkZ);
+	if ((Chunk == nullptr) || !Chunk->IsValid())
+	{
+		return false;
+	}
+	if (Chunk->WriteBlockAreaSection(a_Area, a_MinBlockX, a_MinBlockY, a_MinBlockZ, a_SectionY))
+	{
+		a_HasChanged = true;
+	}
+	return true;
+}
+
+
+
+
+
+void cChunkMap::ResendChunkToClients(int a_ChunkX, int a_ChunkZ)
+{
+	cCSLock Lock(m_CSLayers);
+	cChunkPtr Chunk = GetChunkNoLoad(a_ChunkX, a_ChunkZ);
+	if ((Chunk == nullptr) || !Chunk->IsValid())
+	{
+		return;
+	}
+	Chunk->ResendToClients();
+}
+
+
+
+
+
 void cChunkMap::GetChunkStats(int & a_NumChunksValid, int & a_NumChunksDirty)
 {
 	a_NumChunksValid = 0;
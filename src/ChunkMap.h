@@ -7,6 +7,8 @@
 
 
 #include "ChunkDataCallback.h"
+#include "EntityTracker.h"
+#include "Entities/EntityPhysicsBatch.h"
 
 
 
@@ -82,6 +84,11 @@ public:
 	void BroadcastEntityHeadLook(const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityLook(const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityMetadata(const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
+
+	/** Sends the movement update to the clients of the entity's chunk, through the world's entity tracker.
+	Returns true if some of the clients need a later update even if the entity doesn't move (see cEntityTracker::SendMovement()). */
+	bool BroadcastEntityMovement(cEntity & a_Entity, const cEntityTracker::sMovement & a_Movement, const cClientHandle * a_Exclude = nullptr);
+
 	void BroadcastEntityRelMove(const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityRelMoveLook(const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityStatus(const cEntity & a_Entity, char a_Status, const cClientHandle * a_Exclude = nullptr);
@@ -224,6 +231,14 @@ public:
 	
 	/** Removes the entity from its appropriate chunk */
 	void RemoveEntity(cEntity * a_Entity);
+
+	/** Moves the entity into the proper cell of its chunk's entity index after its position has been set directly.
+	Ignored if the entity isn't stored in a chunk of this chunkmap. */
+	void UpdateEntityCell(cEntity & a_Entity);
+
+	/** Removes the entity from its chunk's entity index, the entity stays in the chunk.
+	Ignored if the entity isn't stored in a chunk of this chunkmap. */
+	void RemoveEntityFromCell(cEntity & a_Entity);
 	
 	/** Calls the callback for each entity in the entire world; returns true if all entities processed, false if the callback aborted by returning true */
 	bool ForEachEntity(cEntityCallback & a_Callback);  // Lua-accessible
@@ -236,6 +251,11 @@ public:
 	If any chunk in the box is missing, ignores the entities in that chunk silently. */
 	bool ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback & a_Callback);  // Lua-accessible
 
+	/** Calls the callback for up to a_MaxCount entities whose position is within a_Radius of a_Pos, nearest first.
+	Returns true if all such entities processed, false if the callback aborted by returning true.
+	If any chunk in the range is missing, ignores the entities in that chunk silently. */
+	bool ForEachEntityNearest(const Vector3d & a_Pos, double a_Radius, size_t a_MaxCount, cEntityCallback & a_Callback);
+
 	/** Destroys and returns a list of blocks destroyed in the explosion at the specified coordinates */
 	void DoExplosionAt(double a_ExplosionSize, double a_BlockX, double a_BlockY, double a_BlockZ, cVector3iArray & a_BlockAffected);
 	
@@ -349,6 +369,14 @@ public:
 	/** Writes the block area into the specified coords. Returns true if all chunks have been processed. Prefer cBlockArea::Write() instead. */
 	bool WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes);
 
+	/** Writes the part of the block area that falls into the specified chunk section, used by cBlockAreaWriter.
+	The clients are not notified, call ResendChunkToClients() once the chunk is done.
+	Returns false if the chunk is not valid; a_HasChanged is set to true if any block has changed. */
+	bool WriteBlockAreaSection(const cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_ChunkX, int a_ChunkZ, int a_SectionY, bool & a_HasChanged);
+
+	/** Sends the whole chunk again to all the clients that have it loaded */
+	void ResendChunkToClients(int a_ChunkX, int a_ChunkZ);
+
 	/** Returns the number of valid chunks and the number of dirty chunks */
 	void GetChunkStats(int & a_NumChunksValid, int & a_NumChunksDirty);
 	
@@ -380,6 +408,9 @@ public:
 
 	cWorld * GetWorld(void) { return m_World; }
 
+	/** Returns the batch that the chunks use for moving their simple physics entities; only valid in the tick thread */
+	cEntityPhysicsBatch & GetEntityPhysicsBatch(void) { return m_EntityPhysicsBatch; }
+
 	int GetNumChunks(void);
 	
 	void ChunkValidated(void);  // Called by chunks that have become valid
@@ -510,6 +541,9 @@ private:
 
 	std::auto_ptr<cAllocationPool<cChunkData::sChunkSection> > m_Pool;
 
+	/** Reused by all the chunks' Tick() for moving the item drops and XP orbs */
+	cEntityPhysicsBatch m_EntityPhysicsBatch;
+
 	cChunkPtr GetChunk      (int a_ChunkX, int a_ChunkZ);  // Also queues the chunk for loading / generating if not valid
 	cChunkPtr GetChunkNoGen (int a_ChunkX, int a_ChunkZ);  // Also queues the chunk for loading if not valid; doesn't generate
 	cChunkPtr GetChunkNoLoad(int a_ChunkX, int a_ChunkZ);  // Doesn't load, doesn't generate
@@ -53,6 +53,9 @@ static const std::chrono::milliseconds PING_TIME_MS = std::chrono::milliseconds(
 
 int cClientHandle::s_ClientCount = 0;
 
+// Built during static initialization, so that no locking is needed when the world tick threads read it:
+const cChunkCoordsVector cClientHandle::s_SpiralOffsets = cClientHandle::CreateSpiralOffsets();
+
 
 
 
@@ -60,14 +63,20 @@ int cClientHandle::s_ClientCount = 0;
 ////////////////////////////////////////////////////////////////////////////////
 // cClientHandle:
 
-cClientHandle::cClientHandle(const AString & a_IPString, int a_ViewDistance) :
+cClientHandle::cClientHandle(const AString & a_IPString, int a_ViewDistance, int a_ChunkStreamBytesPerTick) :
 	m_CurrentViewDistance(a_ViewDistance),
 	m_RequestedViewDistance(a_ViewDistance),
 	m_IPString(a_IPString),
+	m_IsDecodingInNetworkThread(false),
 	m_Player(nullptr),
 	m_HasSentDC(false),
 	m_LastStreamedChunkX(0x7fffffff),  // bogus chunk coords to force streaming upon login
 	m_LastStreamedChunkZ(0x7fffffff),
+	m_SpiralCenterX(0x7fffffff),
+	m_SpiralCenterZ(0x7fffffff),
+	m_NextSpiralIndex(0),
+	m_ChunkStreamBytesPerTick(a_ChunkStreamBytesPerTick),
+	m_SendBacklog(0),
 	m_TicksSinceLastPacket(0),
 	m_Ping(1000),
 	m_PingID(1),
@@ -455,10 +464,7 @@ bool cClientHandle::StreamNextChunk(void)
 				}
 
 				// If the chunk already loading/loaded -> skip
-				if (
-					(std::find(m_ChunksToSend.begin(), m_ChunksToSend.end(), Coords) != m_ChunksToSend.end()) ||
-					(std::find(m_LoadedChunks.begin(), m_LoadedChunks.end(), Coords) != m_LoadedChunks.end())
-				)
+				if (IsChunkLoadedOrQueued(Coords))
 				{
 					continue;
 				}
@@ -471,41 +477,31 @@ bool cClientHandle::StreamNextChunk(void)
 		}
 	}
 
-	// Low priority: Add all chunks that are in range. (From the center out to the edge)
-	for (int d = 0; d <= m_CurrentViewDistance; ++d)  // cycle through (square) distance, from nearest to furthest
+	// Low priority: Add all chunks that are in range, walking the spiral from the center out to the edge.
+	// The spiral is resumed where the last call left off, unless the player moved to another chunk:
+	if ((m_SpiralCenterX != ChunkPosX) || (m_SpiralCenterZ != ChunkPosZ))
 	{
-		// For each distance add chunks in a hollow square centered around current position:
-		cChunkCoordsList CurcleChunks;
-		for (int i = -d; i <= d; ++i)
-		{
-			CurcleChunks.push_back(cChunkCoords(ChunkPosX + d, ChunkPosZ + i));
-			CurcleChunks.push_back(cChunkCoords(ChunkPosX - d, ChunkPosZ + i));
-		}
-		for (int i = -d + 1; i < d; ++i)
-		{
-			CurcleChunks.push_back(cChunkCoords(ChunkPosX + i, ChunkPosZ + d));
-			CurcleChunks.push_back(cChunkCoords(ChunkPosX + i, ChunkPosZ - d));
-		}
+		m_SpiralCenterX = ChunkPosX;
+		m_SpiralCenterZ = ChunkPosZ;
+		m_NextSpiralIndex = 0;
+	}
+	const cChunkCoordsVector & Spiral = GetSpiralOffsets();
+	size_t NumInRange = static_cast<size_t>((2 * m_CurrentViewDistance + 1) * (2 * m_CurrentViewDistance + 1));
+	for (; m_NextSpiralIndex < NumInRange; ++m_NextSpiralIndex)
+	{
+		cChunkCoords Coords(ChunkPosX + Spiral[m_NextSpiralIndex].m_ChunkX, ChunkPosZ + Spiral[m_NextSpiralIndex].m_ChunkZ);
 
-		// For each the CurcleChunks list and send the first unloaded chunk:
-		for (cChunkCoordsList::iterator itr = CurcleChunks.begin(), end = CurcleChunks.end(); itr != end; ++itr)
+		// If the chunk already loading/loaded -> skip
+		if (IsChunkLoadedOrQueued(Coords))
 		{
-			cChunkCoords Coords = *itr;
-
-			// If the chunk already loading/loaded -> skip
-			if (
-				(std::find(m_ChunksToSend.begin(), m_ChunksToSend.end(), Coords) != m_ChunksToSend.end()) ||
-				(std::find(m_LoadedChunks.begin(), m_LoadedChunks.end(), Coords) != m_LoadedChunks.end())
-			)
-			{
-				continue;
-			}
-
-			// Unloaded chunk found -> Send it to the client.
-			Lock.Unlock();
-			StreamChunk(Coords.m_ChunkX, Coords.m_ChunkZ, cChunkSender::E_CHUNK_PRIORITY_LOW);
-			return false;
+			continue;
 		}
+
+		// Unloaded chunk found -> Send it to the client.
+		// The index is not advanced, the next call re-checks this chunk in case the streaming failed.
+		Lock.Unlock();
+		StreamChunk(Coords.m_ChunkX, Coords.m_ChunkZ, cChunkSender::E_CHUNK_PRIORITY_LOW);
+		return false;
 	}
 
 	// All chunks are loaded -> Sets the last loaded chunk coordinates to current coordinates
@@ -526,7 +522,7 @@ void cClientHandle::UnloadOutOfRangeChunks(void)
 	cChunkCoordsList ChunksToRemove;
 	{
 		cCSLock Lock(m_CSChunkLists);
-		for (cChunkCoordsList::iterator itr = m_LoadedChunks.begin(); itr != m_LoadedChunks.end();)
+		for (cChunkCoordsSet::iterator itr = m_LoadedChunks.begin(); itr != m_LoadedChunks.end();)
 		{
 			int DiffX = Diff((*itr).m_ChunkX, ChunkPosX);
 			int DiffZ = Diff((*itr).m_ChunkZ, ChunkPosZ);
@@ -541,7 +537,7 @@ void cClientHandle::UnloadOutOfRangeChunks(void)
 			}
 		}
 
-		for (cChunkCoordsList::iterator itr = m_ChunksToSend.begin(); itr != m_ChunksToSend.end();)
+		for (cChunkCoordsSet::iterator itr = m_ChunksToSend.begin(); itr != m_ChunksToSend.end();)
 		{
 			int DiffX = Diff((*itr).m_ChunkX, ChunkPosX);
 			int DiffZ = Diff((*itr).m_ChunkZ, ChunkPosZ);
@@ -582,8 +578,8 @@ void cClientHandle::StreamChunk(int a_ChunkX, int a_ChunkZ, cChunkSender::eChunk
 	{
 		{
 			cCSLock Lock(m_CSChunkLists);
-			m_LoadedChunks.push_back(cChunkCoords(a_ChunkX, a_ChunkZ));
-			m_ChunksToSend.push_back(cChunkCoords(a_ChunkX, a_ChunkZ));
+			m_LoadedChunks.insert(cChunkCoords(a_ChunkX, a_ChunkZ));
+			m_ChunksToSend.insert(cChunkCoords(a_ChunkX, a_ChunkZ));
 		}
 		World->SendChunkTo(a_ChunkX, a_ChunkZ, a_Priority, this);
 	}
@@ -593,6 +589,60 @@ void cClientHandle::StreamChunk(int a_ChunkX, int a_ChunkZ, cChunkSender::eChunk
 
 
 
+bool cClientHandle::IsChunkLoadedOrQueued(const cChunkCoords & a_Coords) const
+{
+	return (
+		(m_ChunksToSend.find(a_Coords) != m_ChunksToSend.end()) ||
+		(m_LoadedChunks.find(a_Coords) != m_LoadedChunks.end())
+	);
+}
+
+
+
+
+
+const cChunkCoordsVector & cClientHandle::GetSpiralOffsets(void)
+{
+	return s_SpiralOffsets;
+}
+
+
+
+
+
+cChunkCoordsVector cClientHandle::CreateSpiralOffsets(void)
+{
+	cChunkCoordsVector Offsets;
+	Offsets.reserve((2 * MAX_VIEW_DISTANCE + 1) * (2 * MAX_VIEW_DISTANCE + 1));
+	for (int x = -MAX_VIEW_DISTANCE; x <= MAX_VIEW_DISTANCE; x++)
+	{
+		for (int z = -MAX_VIEW_DISTANCE; z <= MAX_VIEW_DISTANCE; z++)
+		{
+			Offsets.push_back(cChunkCoords(x, z));
+		}
+	}
+
+	// Sort by the square ring first, so that each view distance is a prefix; then by the real distance within the ring:
+	std::stable_sort(Offsets.begin(), Offsets.end(), [](const cChunkCoords & a_First, const cChunkCoords & a_Second)
+		{
+			int RingFirst  = std::max(std::abs(a_First.m_ChunkX),  std::abs(a_First.m_ChunkZ));
+			int RingSecond = std::max(std::abs(a_Second.m_ChunkX), std::abs(a_Second.m_ChunkZ));
+			if (RingFirst != RingSecond)
+			{
+				return (RingFirst < RingSecond);
+			}
+			int DistFirst  = a_First.m_ChunkX  * a_First.m_ChunkX  + a_First.m_ChunkZ  * a_First.m_ChunkZ;
+			int DistSecond = a_Second.m_ChunkX * a_Second.m_ChunkX + a_Second.m_ChunkZ * a_Second.m_ChunkZ;
+			return (DistFirst < DistSecond);
+		}
+	);
+	return Offsets;
+}
+
+
+
+
+
 // Removes the client from all chunks. Used when switching worlds or destroying the player
 void cClientHandle::RemoveFromAllChunks()
 {
@@ -613,6 +663,7 @@ void cClientHandle::RemoveFromAllChunks()
 		// so that all chunks are streamed in subsequent StreamChunks() call (FS #407)
 		m_LastStreamedChunkX = 0x7fffffff;
 		m_LastStreamedChunkZ = 0x7fffffff;
+		m_NextSpiralIndex = 0;
 	}
 }
 
@@ -1831,13 +1882,13 @@ void cClientHandle::SendData(const char * a_Data, size_t a_Size)
 void cClientHandle::RemoveFromWorld(void)
 {
 	// Remove all associated chunks:
-	cChunkCoordsList Chunks;
+	cChunkCoordsSet Chunks;
 	{
 		cCSLock Lock(m_CSChunkLists);
 		std::swap(Chunks, m_LoadedChunks);
 		m_ChunksToSend.clear();
 	}
-	for (cChunkCoordsList::iterator itr = Chunks.begin(), end = Chunks.end(); itr != end; ++itr)
+	for (cChunkCoordsSet::iterator itr = Chunks.begin(), end = Chunks.end(); itr != end; ++itr)
 	{
 		m_Protocol->SendUnloadChunk(itr->m_ChunkX, itr->m_ChunkZ);
 	}  // for itr - Chunks[]
@@ -1845,8 +1896,12 @@ void cClientHandle::RemoveFromWorld(void)
 	// Here, we set last streamed values to bogus ones so everything is resent
 	m_LastStreamedChunkX = 0x7fffffff;
 	m_LastStreamedChunkZ = 0x7fffffff;
+	m_NextSpiralIndex = 0;
 
 	m_HasSentPlayerChunk = false;
+
+	// The entities in the new world will all be new to the client:
+	m_TrackedEntities.Clear();
 }
 
 
@@ -1873,15 +1928,7 @@ bool cClientHandle::CheckBlockInteractionsRate(void)
 void cClientHandle::Tick(float a_Dt)
 {
 	// Process received network data:
-	AString IncomingData;
-	{
-		cCSLock Lock(m_CSIncomingData);
-		std::swap(IncomingData, m_IncomingData);
-	}
-	if (!IncomingData.empty())
-	{
-		m_Protocol->DataReceived(IncomingData.data(), IncomingData.size());
-	}
+	ProcessReceivedData();
 
 	// Send any queued outgoing data:
 	AString OutgoingData;
@@ -1897,6 +1944,9 @@ void cClientHandle::Tick(float a_Dt)
 			Link->Send(OutgoingData.data(), OutgoingData.size());
 		}
 	}
+
+	// Account the sent data against the chunk streaming budget:
+	ChargeSentData(OutgoingData.size());
 	
 	m_TicksSinceLastPacket += 1;
 	if (m_TicksSinceLastPacket > 600)  // 30 seconds time-out
@@ -1933,6 +1983,12 @@ void cClientHandle::Tick(float a_Dt)
 		// Stream 4 chunks per tick
 		for (int i = 0; i < 4; i++)
 		{
+			// Don't queue more chunks while the client is still receiving the previous ones over its budget (teleports):
+			if ((m_ChunkStreamBytesPerTick > 0) && (m_SendBacklog >= static_cast<size_t>(m_ChunkStreamBytesPerTick)))
+			{
+				break;
+			}
+
 			// Stream the next chunk
 			if (StreamNextChunk())
 			{
@@ -1972,9 +2028,8 @@ void cClientHandle::Tick(float a_Dt)
 
 
 
-void cClientHandle::ServerTick(float a_Dt)
+void cClientHandle::ProcessReceivedData(void)
 {
-	// Process received network data:
 	AString IncomingData;
 	{
 		cCSLock Lock(m_CSIncomingData);
@@ -1984,6 +2039,52 @@ void cClientHandle::ServerTick(float a_Dt)
 	{
 		m_Protocol->DataReceived(IncomingData.data(), IncomingData.size());
 	}
+
+	// Once in the game, decode the data in the network thread, so that the packet spam doesn't cost the tick thread:
+	bool IsDecodingInNetworkThread;
+	{
+		cCSLock Lock(m_CSIncomingData);
+		if (!m_IsDecodingInNetworkThread && m_Protocol->StartDecodingInNetworkThread())
+		{
+			// Pass any data that has arrived in the meantime, to keep the ordering:
+			if (!m_IncomingData.empty())
+			{
+				m_Protocol->DecodeReceivedData(m_IncomingData.data(), m_IncomingData.size());
+				m_IncomingData.clear();
+			}
+			m_IsDecodingInNetworkThread = true;
+		}
+		IsDecodingInNetworkThread = m_IsDecodingInNetworkThread;
+	}
+	if (IsDecodingInNetworkThread)
+	{
+		m_Protocol->HandleDecodedPackets();
+	}
+}
+
+
+
+
+
+void cClientHandle::ChargeSentData(size_t a_Size)
+{
+	if (m_ChunkStreamBytesPerTick <= 0)
+	{
+		return;
+	}
+	size_t Budget = static_cast<size_t>(m_ChunkStreamBytesPerTick);
+	m_SendBacklog += a_Size;
+	m_SendBacklog = (m_SendBacklog > Budget) ? (m_SendBacklog - Budget) : 0;
+}
+
+
+
+
+
+void cClientHandle::ServerTick(float a_Dt)
+{
+	// Process received network data:
+	ProcessReceivedData();
 	
 	// Send any queued outgoing data:
 	AString OutgoingData;
@@ -1995,6 +2096,7 @@ void cClientHandle::ServerTick(float a_Dt)
 	{
 		m_Link->Send(OutgoingData.data(), OutgoingData.size());
 	}
+	ChargeSentData(OutgoingData.size());
 	
 	if (m_State == csAuthenticated)
 	{
@@ -2056,7 +2158,7 @@ void cClientHandle::SendBlockChange(int a_BlockX, int a_BlockY, int a_BlockZ, BL
 
 	// Do not send block changes in chunks that weren't sent to the client yet:
 	cCSLock Lock(m_CSChunkLists);
-	if (std::find(m_SentChunks.begin(), m_SentChunks.end(), ChunkCoords) != m_SentChunks.end())
+	if (m_SentChunks.find(ChunkCoords) != m_SentChunks.end())
 	{
 		Lock.Unlock();
 		m_Protocol->SendBlockChange(a_BlockX, a_BlockY, a_BlockZ, a_BlockType, a_BlockMeta);
@@ -2074,7 +2176,7 @@ void cClientHandle::SendBlockChanges(int a_ChunkX, int a_ChunkZ, const sSetBlock
 	// Do not send block changes in chunks that weren't sent to the client yet:
 	cChunkCoords ChunkCoords = cChunkCoords(a_ChunkX, a_ChunkZ);
 	cCSLock Lock(m_CSChunkLists);
-	if (std::find(m_SentChunks.begin(), m_SentChunks.end(), ChunkCoords) != m_SentChunks.end())
+	if (m_SentChunks.find(ChunkCoords) != m_SentChunks.end())
 	{
 		Lock.Unlock();
 		m_Protocol->SendBlockChanges(a_ChunkX, a_ChunkZ, a_Changes);
@@ -2122,15 +2224,7 @@ void cClientHandle::SendChunkData(int a_ChunkX, int a_ChunkZ, cChunkDataSerializ
 	bool Found = false;
 	{
 		cCSLock Lock(m_CSChunkLists);
-		for (cChunkCoordsList::iterator itr = m_ChunksToSend.begin(); itr != m_ChunksToSend.end(); ++itr)
-		{
-			if ((itr->m_ChunkX == a_ChunkX) && (itr->m_ChunkZ == a_ChunkZ))
-			{
-				m_ChunksToSend.erase(itr);
-				Found = true;
-				break;
-			}
-		}  // for itr - m_ChunksToSend[]
+		Found = (m_ChunksToSend.erase(cChunkCoords(a_ChunkX, a_ChunkZ)) > 0);
 	}
 	if (!Found)
 	{
@@ -2145,7 +2239,7 @@ void cClientHandle::SendChunkData(int a_ChunkX, int a_ChunkZ, cChunkDataSerializ
 	// Add the chunk to the list of chunks sent to the player:
 	{
 		cCSLock Lock(m_CSChunkLists);
-		m_SentChunks.push_back(cChunkCoords(a_ChunkX, a_ChunkZ));
+		m_SentChunks.insert(cChunkCoords(a_ChunkX, a_ChunkZ));
 	}
 
 	// If it is the chunk the player's in, make them spawn (in the tick thread):
@@ -2173,6 +2267,7 @@ void cClientHandle::SendCollectEntity(const cEntity & a_Entity, const cPlayer &
 
 void cClientHandle::SendDestroyEntity(const cEntity & a_Entity)
 {
+	m_TrackedEntities.Remove(a_Entity.GetUniqueID());
 	m_Protocol->SendDestroyEntity(a_Entity);
 }
 
@@ -2690,7 +2785,7 @@ void cClientHandle::SendUnloadChunk(int a_ChunkX, int a_ChunkZ)
 	// Remove the chunk from the list of chunks sent to the client:
 	{
 		cCSLock Lock(m_CSChunkLists);
-		m_SentChunks.remove(cChunkCoords(a_ChunkX, a_ChunkZ));
+		m_SentChunks.erase(cChunkCoords(a_ChunkX, a_ChunkZ));
 	}
 
 	m_Protocol->SendUnloadChunk(a_ChunkX, a_ChunkZ);
@@ -2805,6 +2900,10 @@ void cClientHandle::SetViewDistance(int a_ViewDistance)
 	{
 		m_CurrentViewDistance = Clamp(a_ViewDistance, cClientHandle::MIN_VIEW_DISTANCE, world->GetMaxViewDistance());
 	}
+
+	// Make the next StreamNextChunk() call continue the spiral, in case the view distance grew:
+	m_LastStreamedChunkX = 0x7fffffff;
+	m_LastStreamedChunkZ = 0x7fffffff;
 }
 
 
@@ -2828,7 +2927,7 @@ bool cClientHandle::WantsSendChunk(int a_ChunkX, int a_ChunkZ)
 	}
 	
 	cCSLock Lock(m_CSChunkLists);
-	return (std::find(m_ChunksToSend.begin(), m_ChunksToSend.end(), cChunkCoords(a_ChunkX, a_ChunkZ)) != m_ChunksToSend.end());
+	return (m_ChunksToSend.find(cChunkCoords(a_ChunkX, a_ChunkZ)) != m_ChunksToSend.end());
 }
 
 
@@ -2844,10 +2943,7 @@ void cClientHandle::AddWantedChunk(int a_ChunkX, int a_ChunkZ)
 	
 	LOGD("Adding chunk [%d, %d] to wanted chunks for client %p", a_ChunkX, a_ChunkZ, this);
 	cCSLock Lock(m_CSChunkLists);
-	if (std::find(m_ChunksToSend.begin(), m_ChunksToSend.end(), cChunkCoords(a_ChunkX, a_ChunkZ)) == m_ChunksToSend.end())
-	{
-		m_ChunksToSend.push_back(cChunkCoords(a_ChunkX, a_ChunkZ));
-	}
+	m_ChunksToSend.insert(cChunkCoords(a_ChunkX, a_ChunkZ));
 }
 
 
@@ -2932,8 +3028,15 @@ void cClientHandle::OnReceivedData(const char * a_Data, size_t a_Length)
 	// Reset the timeout:
 	m_TicksSinceLastPacket = 0;
 
-	// Queue the incoming data to be processed in the tick thread:
 	cCSLock Lock(m_CSIncomingData);
+	if (m_IsDecodingInNetworkThread)
+	{
+		// Decode and validate the packets right here, only the decoded packets are handled in the tick thread:
+		m_Protocol->DecodeReceivedData(a_Data, a_Length);
+		return;
+	}
+
+	// Queue the incoming data to be processed in the tick thread:
 	m_IncomingData.append(a_Data, a_Length);
 }
 
@@ -20,9 +20,11 @@
 #include "UI/SlotArea.h"
 #include "json/json.h"
 #include "ChunkSender.h"
+#include "EntityTracker.h"
 
 
 #include <array>
+#include <unordered_set>
 
 
 
@@ -45,6 +47,8 @@ class cStatManager;
 class cClientHandle;
 typedef SharedPtr<cClientHandle> cClientHandlePtr;
 
+typedef std::unordered_set<cChunkCoords, cChunkCoordsHash> cChunkCoordsSet;
+
 
 
 
@@ -61,9 +65,13 @@ public:  // tolua_export
 	#endif
 	static const int MAX_VIEW_DISTANCE = 32;
 	static const int MIN_VIEW_DISTANCE = 1;
+
+	/** The default number of bytes per tick that a client may receive before chunk streaming to it is paused (used when no value is set in Settings.ini) */
+	static const int DEFAULT_CHUNK_STREAM_BYTES_PER_TICK = 64 * 1024;
 	
-	/** Creates a new client with the specified IP address in its description and the specified initial view distance. */
-	cClientHandle(const AString & a_IPString, int a_ViewDistance);
+	/** Creates a new client with the specified IP address in its description, the specified initial view distance
+	and the specified outgoing bandwidth budget for streaming chunks (0 = unlimited). */
+	cClientHandle(const AString & a_IPString, int a_ViewDistance, int a_ChunkStreamBytesPerTick);
 
 	virtual ~cClientHandle();
 
@@ -345,6 +353,9 @@ public:  // tolua_export
 
 	/** Returns the protocol version number of the protocol that the client is talking. Returns zero if the protocol version is not (yet) known. */
 	UInt32 GetProtocolVersion(void) const { return m_ProtocolVersion; }  // tolua_export
+
+	/** Returns the entity tracker's state for this client - which entities are in range and which need a resync. */
+	cEntityTracker::cClientEntities & GetTrackedEntities(void) { return m_TrackedEntities; }
 	
 private:
 
@@ -367,9 +378,9 @@ private:
 	Json::Value m_Properties;
 
 	cCriticalSection m_CSChunkLists;
-	cChunkCoordsList m_LoadedChunks;  // Chunks that the player belongs to
-	cChunkCoordsList m_ChunksToSend;  // Chunks that need to be sent to the player (queued because they weren't generated yet or there's not enough time to send them)
-	cChunkCoordsList m_SentChunks;    // Chunks that are currently sent to the client
+	cChunkCoordsSet  m_LoadedChunks;  // Chunks that the player belongs to
+	cChunkCoordsSet  m_ChunksToSend;  // Chunks that need to be sent to the player (queued because they weren't generated yet or there's not enough time to send them)
+	cChunkCoordsSet  m_SentChunks;    // Chunks that are currently sent to the client
 
 	cProtocol * m_Protocol;
 
@@ -380,6 +391,11 @@ private:
 	Protected by m_CSIncomingData. */
 	AString m_IncomingData;
 
+	/** Set once the protocol has taken over decoding the incoming data in the network thread (game state);
+	from then on the data is decoded directly in OnReceivedData() and only the decoded packets are handled in Tick().
+	Protected by m_CSIncomingData. */
+	bool m_IsDecodingInNetworkThread;
+
 	/** Protects m_OutgoingData against multithreaded access. */
 	cCriticalSection m_CSOutgoingData;
 
@@ -397,6 +413,21 @@ private:
 	int m_LastStreamedChunkX;
 	int m_LastStreamedChunkZ;
 
+	// Chunk position around which the spiral in StreamNextChunk() is walked
+	int m_SpiralCenterX;
+	int m_SpiralCenterZ;
+
+	/** Index into the spiral offsets (GetSpiralOffsets()) of the first chunk that may not have been streamed yet around the spiral center.
+	All chunks before this index are already loaded or queued for the client. */
+	size_t m_NextSpiralIndex;
+
+	/** Number of bytes per tick that may be sent to the client before chunk streaming is paused; 0 = unlimited */
+	int m_ChunkStreamBytesPerTick;
+
+	/** Number of bytes sent to the client in excess of m_ChunkStreamBytesPerTick, drained by that amount each tick.
+	New chunks are streamed only while this is below the per-tick budget. */
+	size_t m_SendBacklog;
+
 	/** Number of ticks since the last network packet was received (increased in Tick(), reset in OnReceivedData()) */
 	int m_TicksSinceLastPacket;
 	
@@ -451,6 +482,9 @@ private:
 	int m_NumBlockChangeInteractionsThisTick;
 	
 	static int s_ClientCount;
+
+	/** The chunk streaming order, see GetSpiralOffsets() */
+	static const cChunkCoordsVector s_SpiralOffsets;
 	
 	/** ID used for identification during authenticating. Assigned sequentially for each new instance. */
 	int m_UniqueID;
@@ -483,12 +517,35 @@ private:
 	/** Shared pointer to self, so that this instance can keep itself alive when needed. */
 	cClientHandlePtr m_Self;
 
+	/** The entities whose movement updates this client is receiving, maintained by the world's cEntityTracker. */
+	cEntityTracker::cClientEntities m_TrackedEntities;
+
+
+	/** Processes the data received on the link: passes the raw data or the decoded packets to the protocol for handling.
+	Hands the decoding over to the network thread once the protocol allows it. Called from Tick() and ServerTick(). */
+	void ProcessReceivedData(void);
+
+	/** Charges the data sent in this tick to the chunk streaming budget and drains one tick's budget from the backlog.
+	Called once per tick from either Tick() or ServerTick(), whichever sent the data. */
+	void ChargeSentData(size_t a_Size);
 
 	/** Returns true if the rate block interactions is within a reasonable limit (bot protection) */
 	bool CheckBlockInteractionsRate(void);
 	
 	/** Adds a single chunk to be streamed to the client; used by StreamChunks() */
 	void StreamChunk(int a_ChunkX, int a_ChunkZ, cChunkSender::eChunkPriority a_Priority);
+
+	/** Returns true if the chunk is either loaded by the client or queued for sending to it.
+	Assumes m_CSChunkLists is locked. */
+	bool IsChunkLoadedOrQueued(const cChunkCoords & a_Coords) const;
+
+	/** Returns the chunk offsets, relative to the player's chunk, in the order in which they should be streamed:
+	square rings of increasing distance, each ring sorted by the real distance from the center.
+	The first (2 * N + 1)^2 items cover the view distance N, up to MAX_VIEW_DISTANCE. */
+	static const cChunkCoordsVector & GetSpiralOffsets(void);
+
+	/** Creates the offsets returned by GetSpiralOffsets(); called once, to initialize s_SpiralOffsets */
+	static cChunkCoordsVector CreateSpiralOffsets(void);
 	
 	/** Handles the DIG_STARTED dig packet: */
 	void HandleBlockDigStarted (int a_BlockX, int a_BlockY, int a_BlockZ, eBlockFace a_BlockFace, BLOCKTYPE a_OldBlock, NIBBLETYPE a_OldMeta);
@@ -0,0 +1,366 @@
+
+// CraftingRecipeIndex.cpp
+
+// Implements the cCraftingRecipeIndex class that finds the crafting recipe matching a crafting grid by a hash lookup
+
+#include "Globals.h"
+#include "CraftingRecipeIndex.h"
+
+
+
+
+
+/** Mixes the value into the hash (FNV-1a over the whole value) */
+static inline UInt64 HashMix(UInt64 a_Hash, int a_Value)
+{
+	return (a_Hash ^ static_cast<UInt64>(static_cast<UInt32>(a_Value))) * 0x100000001b3ULL;
+}
+
+static const UInt64 HASH_INIT = 0xcbf29ce484222325ULL;
+
+
+
+
+
+size_t cCraftingRecipeIndex::AddRecipe(const sIngredients & a_Ingredients)
+{
+	size_t Idx = m_Recipes.size();
+	m_Recipes.push_back(sRecipe());
+	sRecipe & Recipe = m_Recipes.back();
+	Recipe.m_Ingredients = a_Ingredients;
+
+	// Calculate the size of the regular ingredients; an ingredient "anywhere" in one direction still counts in the other one:
+	int MaxX = 0, MaxY = 0;
+	Recipe.m_NumAnywhere = 0;
+	for (sIngredients::const_iterator itr = a_Ingredients.begin(), end = a_Ingredients.end(); itr != end; ++itr)
+	{
+		MaxX = std::max(MaxX, itr->x);
+		MaxY = std::max(MaxY, itr->y);
+		if ((itr->x < 0) || (itr->y < 0))
+		{
+			Recipe.m_NumAnywhere += 1;
+		}
+	}
+	Recipe.m_Width  = MaxX + 1;
+	Recipe.m_Height = MaxY + 1;
+	if ((Recipe.m_Width > MAX_GRID_WIDTH) || (Recipe.m_Height > MAX_GRID_HEIGHT))
+	{
+		// The recipe cannot match any grid, don't index it
+		return Idx;
+	}
+
+	// Collect the item types in the cells, each cell only once:
+	short Cells[MAX_GRID_CELLS];
+	std::fill(Cells, Cells + MAX_GRID_CELLS, static_cast<short>(-1));
+	short ItemTypes[MAX_GRID_CELLS];
+	int NumItemTypes = 0;
+	for (sIngredients::const_iterator itr = a_Ingredients.begin(), end = a_Ingredients.end(); itr != end; ++itr)
+	{
+		if ((itr->x >= 0) && (itr->y >= 0))
+		{
+			int CellIdx = itr->x + Recipe.m_Width * itr->y;
+			if (Cells[CellIdx] >= 0)
+			{
+				// Another ingredient in the same cell
+				continue;
+			}
+			Cells[CellIdx] = itr->m_ItemType;
+		}
+		if (NumItemTypes >= MAX_GRID_CELLS)
+		{
+			// More ingredients than cells, the recipe cannot match any grid
+			return Idx;
+		}
+		ItemTypes[NumItemTypes++] = itr->m_ItemType;
+	}
+
+	if (Recipe.m_NumAnywhere == 0)
+	{
+		m_ByShape[GetShapeKey(Cells, Recipe.m_Width, Recipe.m_Height)].push_back(Idx);
+	}
+	else
+	{
+		m_ByItemTypes[GetItemTypesKey(ItemTypes, NumItemTypes)].push_back(Idx);
+	}
+	return Idx;
+}
+
+
+
+
+
+void cCraftingRecipeIndex::Clear(void)
+{
+	m_Recipes.clear();
+	m_ByShape.clear();
+	m_ByItemTypes.clear();
+}
+
+
+
+
+
+bool cCraftingRecipeIndex::Find(const sCell * a_Grid, int a_GridWidth, int a_GridHeight, sMatch & a_Match) const
+{
+	ASSERT(a_GridWidth <= MAX_GRID_WIDTH);
+	ASSERT(a_GridHeight <= MAX_GRID_HEIGHT);
+
+	// Get the real bounds of the crafting grid:
+	int GridLeft = MAX_GRID_WIDTH, GridTop = MAX_GRID_HEIGHT;
+	int GridRight = -1, GridBottom = -1;
+	for (int y = 0; y < a_GridHeight; y++)
+	{
+		for (int x = 0; x < a_GridWidth; x++)
+		{
+			if (a_Grid[x + y * a_GridWidth].m_ItemType >= 0)
+			{
+				GridRight  = std::max(x, GridRight);
+				GridBottom = std::max(y, GridBottom);
+				GridLeft   = std::min(x, GridLeft);
+				GridTop    = std::min(y, GridTop);
+			}
+		}
+	}
+	if (GridRight < 0)
+	{
+		// Empty grid
+		return false;
+	}
+	int Width  = GridRight - GridLeft + 1;
+	int Height = GridBottom - GridTop + 1;
+	const sCell * Grid = a_Grid + GridLeft + a_GridWidth * GridTop;
+
+	// Calculate both keys of the cropped grid:
+	short Cells[MAX_GRID_CELLS];
+	short ItemTypes[MAX_GRID_CELLS];
+	int NumItemTypes = 0;
+	for (int y = 0; y < Height; y++)
+	{
+		for (int x = 0; x < Width; x++)
+		{
+			short ItemType = Grid[x + a_GridWidth * y].m_ItemType;
+			Cells[x + Width * y] = (ItemType >= 0) ? ItemType : -1;
+			if (ItemType >= 0)
+			{
+				ItemTypes[NumItemTypes++] = ItemType;
+			}
+		}
+	}
+	const cRecipeIdxs * ByShape     = FindKey(m_ByShape,     GetShapeKey(Cells, Width, Height));
+	const cRecipeIdxs * ByItemTypes = FindKey(m_ByItemTypes, GetItemTypesKey(ItemTypes, NumItemTypes));
+
+	// Verify the candidates from both indices, in the order of the recipes:
+	size_t NumByShape     = (ByShape     != nullptr) ? ByShape->size()     : 0;
+	size_t NumByItemTypes = (ByItemTypes != nullptr) ? ByItemTypes->size() : 0;
+	size_t i = 0, j = 0;
+	while ((i < NumByShape) || (j < NumByItemTypes))
+	{
+		size_t RecipeIdx;
+		if ((j >= NumByItemTypes) || ((i < NumByShape) && ((*ByShape)[i] < (*ByItemTypes)[j])))
+		{
+			RecipeIdx = (*ByShape)[i++];
+		}
+		else
+		{
+			RecipeIdx = (*ByItemTypes)[j++];
+		}
+		if (!MatchRecipeAnyOffset(RecipeIdx, Grid, Width, Height, a_GridWidth, a_Match))
+		{
+			continue;
+		}
+
+		// Move the match from the cropped grid to the original one:
+		a_Match.m_OffsetX += GridLeft;
+		a_Match.m_OffsetY += GridTop;
+		for (int k = m_Recipes[RecipeIdx].m_NumAnywhere - 1; k >= 0; k--)
+		{
+			a_Match.m_AnywhereX[k] += GridLeft;
+			a_Match.m_AnywhereY[k] += GridTop;
+		}
+		return true;
+	}
+
+	// No matching recipe found
+	return false;
+}
+
+
+
+
+
+bool cCraftingRecipeIndex::MatchRecipe(size_t a_RecipeIdx, const sCell * a_Grid, int a_GridWidth, int a_GridHeight, int a_GridStride, int a_OffsetX, int a_OffsetY, sMatch & a_Match) const
+{
+	const sRecipe & Recipe = m_Recipes[a_RecipeIdx];
+
+	// Check the regular items first:
+	bool HasMatched[MAX_GRID_WIDTH][MAX_GRID_HEIGHT];
+	memset(HasMatched, 0, sizeof(HasMatched));
+	for (sIngredients::const_iterator itr = Recipe.m_Ingredients.begin(), end = Recipe.m_Ingredients.end(); itr != end; ++itr)
+	{
+		if ((itr->x < 0) || (itr->y < 0))
+		{
+			// "Anywhere" item, process later
+			continue;
+		}
+		int x = itr->x + a_OffsetX;
+		int y = itr->y + a_OffsetY;
+		if ((x >= a_GridWidth) || (y >= a_GridHeight))
+		{
+			return false;
+		}
+		const sCell & Cell = a_Grid[x + a_GridStride * y];
+		if (
+			(Cell.m_ItemType < 0) ||                    // empty cell
+			(Cell.m_ItemType != itr->m_ItemType) ||     // different item type
+			(
+				(itr->m_ItemDamage >= 0) &&               // should compare damage values?
+				(itr->m_ItemDamage != Cell.m_ItemDamage)
+			)
+		)
+		{
+			// Doesn't match
+			return false;
+		}
+		HasMatched[x][y] = true;
+	}  // for itr - Recipe.m_Ingredients[]
+
+	// Process the "anywhere" items now, and only in the cells that haven't matched yet, first-come-first-served:
+	int NumAnywhere = 0;
+	for (sIngredients::const_iterator itr = Recipe.m_Ingredients.begin(), end = Recipe.m_Ingredients.end(); itr != end; ++itr)
+	{
+		if ((itr->x >= 0) && (itr->y >= 0))
+		{
+			// Regular item, already processed
+			continue;
+		}
+		// The fixed coord of a "*:N" or "N:*" item is relative to the cropped grid, not to the recipe's offset, same as it always was:
+		int StartX = 0, EndX = a_GridWidth  - 1;
+		int StartY = 0, EndY = a_GridHeight - 1;
+		if (itr->x >= 0)
+		{
+			StartX = itr->x;
+			EndX = StartX;
+		}
+		else if (itr->y >= 0)
+		{
+			StartY = itr->y;
+			EndY = StartY;
+		}
+		EndX = std::min(EndX, a_GridWidth  - 1);
+		EndY = std::min(EndY, a_GridHeight - 1);
+		bool Found = false;
+		for (int x = StartX; (x <= EndX) && !Found; x++)
+		{
+			for (int y = StartY; y <= EndY; y++)
+			{
+				const sCell & Cell = a_Grid[x + a_GridStride * y];
+				if (
+					!HasMatched[x][y] &&                       // not matched by some other item yet
+					(Cell.m_ItemType == itr->m_ItemType) &&
+					(
+						(itr->m_ItemDamage < 0) ||               // doesn't want damage comparison
+						(itr->m_ItemDamage == Cell.m_ItemDamage)
+					)
+				)
+				{
+					HasMatched[x][y] = true;
+					Found = true;
+					a_Match.m_AnywhereX[NumAnywhere] = x;
+					a_Match.m_AnywhereY[NumAnywhere] = y;
+					NumAnywhere += 1;
+					break;
+				}
+			}  // for y
+		}  // for x
+		if (!Found)
+		{
+			return false;
+		}
+	}  // for itr - Recipe.m_Ingredients[]
+
+	// Check if the whole grid has matched:
+	for (int y = 0; y < a_GridHeight; y++)
+	{
+		for (int x = 0; x < a_GridWidth; x++)
+		{
+			if (!HasMatched[x][y] && (a_Grid[x + a_GridStride * y].m_ItemType >= 0))
+			{
+				// There's an unmatched item in the grid
+				return false;
+			}
+		}
+	}
+
+	a_Match.m_RecipeIdx = a_RecipeIdx;
+	a_Match.m_OffsetX = a_OffsetX;
+	a_Match.m_OffsetY = a_OffsetY;
+	return true;
+}
+
+
+
+
+
+UInt64 cCraftingRecipeIndex::GetShapeKey(const short * a_ItemTypes, int a_Width, int a_Height)
+{
+	UInt64 Hash = HashMix(HashMix(HASH_INIT, a_Width), a_Height);
+	for (int i = a_Width * a_Height - 1; i >= 0; i--)
+	{
+		Hash = HashMix(Hash, a_ItemTypes[i]);
+	}
+	return Hash;
+}
+
+
+
+
+
+UInt64 cCraftingRecipeIndex::GetItemTypesKey(short * a_ItemTypes, int a_Count)
+{
+	std::sort(a_ItemTypes, a_ItemTypes + a_Count);
+	UInt64 Hash = HashMix(HASH_INIT, a_Count);
+	for (int i = 0; i < a_Count; i++)
+	{
+		Hash = HashMix(Hash, a_ItemTypes[i]);
+	}
+	return Hash;
+}
+
+
+
+
+
+const cCraftingRecipeIndex::cRecipeIdxs * cCraftingRecipeIndex::FindKey(const cRecipeMap & a_Map, UInt64 a_Key)
+{
+	cRecipeMap::const_iterator itr = a_Map.find(a_Key);
+	return (itr != a_Map.end()) ? &itr->second : nullptr;
+}
+
+
+
+
+
+bool cCraftingRecipeIndex::MatchRecipeAnyOffset(size_t a_RecipeIdx, const sCell * a_Grid, int a_GridWidth, int a_GridHeight, int a_GridStride, sMatch & a_Match) const
+{
+	// The "anywhere" items may be the ones offsetting the regular items to the right or downwards,
+	// e. g. recipe "A, * | B, 1:1" needs to check for B at 2:2 in case A is at 1:1, so all the offsets need to be checked.
+	// Also filters out the recipes that are too large for the grid, the loops aren't entered at all.
+	const sRecipe & Recipe = m_Recipes[a_RecipeIdx];
+	int MaxOfsX = a_GridWidth  - Recipe.m_Width;
+	int MaxOfsY = a_GridHeight - Recipe.m_Height;
+	for (int x = 0; x <= MaxOfsX; x++)
+	{
+		for (int y = 0; y <= MaxOfsY; y++)
+		{
+			if (MatchRecipe(a_RecipeIdx, a_Grid, a_GridWidth, a_GridHeight, a_GridStride, x, y, a_Match))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+
+
@@ -0,0 +1,132 @@
+
+// CraftingRecipeIndex.h
+
+// Declares the cCraftingRecipeIndex class that finds the crafting recipe matching a crafting grid by a hash lookup
+
+// The index works on the plain item types and damage values, it doesn't depend on the rest of the server
+// so that it can be benchmarked on its own.
+
+
+
+
+
+#pragma once
+
+#include <unordered_map>
+
+
+
+
+
+/** Stores the ingredients of the crafting recipes and finds the recipe matching a crafting grid.
+The recipes without any "anywhere" ingredients are indexed by their shape: the size and the item type in each cell.
+The recipes with "anywhere" ingredients are indexed by the multiset of their ingredients' item types.
+A lookup crops the grid, probes both indices and verifies only the recipes found there.
+When more recipes match, the one added first wins, same as when trying all of them in order. */
+class cCraftingRecipeIndex
+{
+public:
+
+	static const int MAX_GRID_WIDTH  = 3;
+	static const int MAX_GRID_HEIGHT = 3;
+	static const int MAX_GRID_CELLS  = MAX_GRID_WIDTH * MAX_GRID_HEIGHT;
+
+	/** A single ingredient of a recipe, one item in one cell. */
+	struct sIngredient
+	{
+		short m_ItemType;
+		short m_ItemDamage;  // -1 for any damage
+		int x, y;            // Relative to the recipe's top-left corner; -1 for "anywhere"
+	} ;
+	typedef std::vector<sIngredient> sIngredients;
+
+	/** A single cell of the crafting grid. An empty cell has a negative item type. */
+	struct sCell
+	{
+		short m_ItemType;
+		short m_ItemDamage;
+	} ;
+
+	/** Describes how a recipe matched a crafting grid. */
+	struct sMatch
+	{
+		/** The number of the matching recipe, in the order of adding */
+		size_t m_RecipeIdx;
+
+		/** The position of the recipe's top-left corner in the grid; add to the regular ingredients' coords */
+		int m_OffsetX, m_OffsetY;
+
+		/** The grid coords matched by each "anywhere" ingredient, in the order of the ingredients in the recipe */
+		int m_AnywhereX[MAX_GRID_CELLS];
+		int m_AnywhereY[MAX_GRID_CELLS];
+	} ;
+
+
+	/** Adds a recipe. The regular ingredients' coords need to be normalized, starting at (0, 0).
+	Returns the number of the recipe, the recipes are numbered in the order of adding. */
+	size_t AddRecipe(const sIngredients & a_Ingredients);
+
+	/** Removes all the recipes */
+	void Clear(void);
+
+	/** Returns the number of the recipes added */
+	size_t GetNumRecipes(void) const { return m_Recipes.size(); }
+
+	/** Finds the first recipe matching the grid. Returns true and fills in a_Match if found. */
+	bool Find(const sCell * a_Grid, int a_GridWidth, int a_GridHeight, sMatch & a_Match) const;
+
+	/** Checks if the grid matches the specified recipe placed at the specified offset within the grid.
+	Returns true and fills in a_Match if so. The "anywhere" ingredients are matched first-come-first-served,
+	a recipe with one horizontal and one vertical "anywhere" ("*:1, 1:*") may not match properly.
+	The fixed coord of a "*:N" / "N:*" ingredient is taken within the grid, the offset isn't added to it. */
+	bool MatchRecipe(size_t a_RecipeIdx, const sCell * a_Grid, int a_GridWidth, int a_GridHeight, int a_GridStride, int a_OffsetX, int a_OffsetY, sMatch & a_Match) const;
+
+	/** Returns the width of the regular ingredients of the specified recipe */
+	int GetRecipeWidth(size_t a_RecipeIdx) const { return m_Recipes[a_RecipeIdx].m_Width; }
+
+	/** Returns the height of the regular ingredients of the specified recipe */
+	int GetRecipeHeight(size_t a_RecipeIdx) const { return m_Recipes[a_RecipeIdx].m_Height; }
+
+protected:
+
+	struct sRecipe
+	{
+		sIngredients m_Ingredients;
+
+		/** Size of the regular ingredients; the "anywhere" ingredients are excluded */
+		int m_Width;
+		int m_Height;
+
+		/** Number of the "anywhere" ingredients */
+		int m_NumAnywhere;
+	} ;
+
+	/** The numbers of the recipes that share a key, in ascending order */
+	typedef std::vector<size_t> cRecipeIdxs;
+	typedef std::unordered_map<UInt64, cRecipeIdxs> cRecipeMap;
+
+	std::vector<sRecipe> m_Recipes;
+
+	/** The recipes without "anywhere" ingredients, keyed by their shape, see GetShapeKey() */
+	cRecipeMap m_ByShape;
+
+	/** The recipes with "anywhere" ingredients, keyed by the multiset of their item types, see GetItemTypesKey() */
+	cRecipeMap m_ByItemTypes;
+
+
+	/** Returns the key of the shape of the grid: its size and the item types in its cells, empty cells included. */
+	static UInt64 GetShapeKey(const short * a_ItemTypes, int a_Width, int a_Height);
+
+	/** Returns the key of the multiset of the item types. Sorts the item types in place. */
+	static UInt64 GetItemTypesKey(short * a_ItemTypes, int a_Count);
+
+	/** Returns the list of the recipes under the specified key, or nullptr if there are none. */
+	static const cRecipeIdxs * FindKey(const cRecipeMap & a_Map, UInt64 a_Key);
+
+	/** Checks all the possible offsets of the recipe within the grid. Returns true and fills in a_Match on the first match. */
+	bool MatchRecipeAnyOffset(size_t a_RecipeIdx, const sCell * a_Grid, int a_GridWidth, int a_GridHeight, int a_GridStride, sMatch & a_Match) const;
+} ;
+
+
+
+
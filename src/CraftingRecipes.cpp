@@ -5,8 +5,8 @@
 
 #include "Globals.h"
 #include "CraftingRecipes.h"
-#include "Root.h"
 #include "Bindings/PluginManager.h"
+#include "OSSupport/File.h"
 
 
 
@@ -193,7 +193,7 @@ void cCraftingGrid::Dump(void)
 {
 	for (int y = 0; y < m_Height; y++) for (int x = 0; x < m_Width; x++)
 	{
-		#ifdef _DEBUG
+		#if defined(_DEBUG) || defined(TEST_GLOBALS)
 		int idx = x + m_Width * y;
 		#endif
 		LOGD("Slot (%d, %d): Type %d, health %d, count %d",
@@ -283,28 +283,28 @@ cCraftingRecipes::~cCraftingRecipes()
 void cCraftingRecipes::GetRecipe(cPlayer & a_Player, cCraftingGrid & a_CraftingGrid, cCraftingRecipe & a_Recipe)
 {
 	// Allow plugins to intercept recipes using a pre-craft hook:
-	if (cRoot::Get()->GetPluginManager()->CallHookPreCrafting(a_Player, a_CraftingGrid, a_Recipe))
+	if (cPluginManager::Get()->CallHookPreCrafting(a_Player, a_CraftingGrid, a_Recipe))
 	{
 		return;
 	}
 	
 	// Built-in recipes:
-	std::unique_ptr<cRecipe> Recipe(FindRecipe(a_CraftingGrid.GetItems(), a_CraftingGrid.GetWidth(), a_CraftingGrid.GetHeight()));
+	cRecipe Recipe;
 	a_Recipe.Clear();
-	if (Recipe.get() == nullptr)
+	if (!FindRecipe(a_CraftingGrid.GetItems(), a_CraftingGrid.GetWidth(), a_CraftingGrid.GetHeight(), Recipe))
 	{
 		// Allow plugins to intercept a no-recipe-found situation:
-		cRoot::Get()->GetPluginManager()->CallHookCraftingNoRecipe(a_Player, a_CraftingGrid, a_Recipe);
+		cPluginManager::Get()->CallHookCraftingNoRecipe(a_Player, a_CraftingGrid, a_Recipe);
 		return;
 	}
-	for (cRecipeSlots::const_iterator itr = Recipe->m_Ingredients.begin(); itr != Recipe->m_Ingredients.end(); ++itr)
+	for (cRecipeSlots::const_iterator itr = Recipe.m_Ingredients.begin(); itr != Recipe.m_Ingredients.end(); ++itr)
 	{
 		a_Recipe.SetIngredient(itr->x, itr->y, itr->m_Item);
 	}  // for itr
-	a_Recipe.SetResult(Recipe->m_Result);
+	a_Recipe.SetResult(Recipe.m_Result);
 	
 	// Allow plugins to intercept recipes after they are processed:
-	cRoot::Get()->GetPluginManager()->CallHookPostCrafting(a_Player, a_CraftingGrid, a_Recipe);
+	cPluginManager::Get()->CallHookPostCrafting(a_Player, a_CraftingGrid, a_Recipe);
 }
 
 
@@ -358,6 +358,7 @@ void cCraftingRecipes::ClearRecipes(void)
 		delete *itr;
 	}
 	m_Recipes.clear();
+	m_Index.Clear();
 }
 
 
@@ -422,6 +423,22 @@ void cCraftingRecipes::AddRecipeLine(int a_LineNum, const AString & a_RecipeLine
 	}  // for itr - Ingredients[]
 	
 	NormalizeIngredients(Recipe.get());
+
+	// Index the ingredients, under the same number as the recipe in m_Recipes:
+	cCraftingRecipeIndex::sIngredients IndexIngredients;
+	IndexIngredients.reserve(Recipe->m_Ingredients.size());
+	for (cRecipeSlots::const_iterator itr = Recipe->m_Ingredients.begin(); itr != Recipe->m_Ingredients.end(); ++itr)
+	{
+		cCraftingRecipeIndex::sIngredient Ingredient;
+		Ingredient.m_ItemType = itr->m_Item.m_ItemType;
+		Ingredient.m_ItemDamage = itr->m_Item.m_ItemDamage;
+		Ingredient.x = itr->x;
+		Ingredient.y = itr->y;
+		IndexIngredients.push_back(Ingredient);
+	}
+	size_t Idx = m_Index.AddRecipe(IndexIngredients);
+	ASSERT(Idx == m_Recipes.size());
+	UNUSED(Idx);
 	
 	m_Recipes.push_back(Recipe.release());
 }
@@ -580,211 +597,61 @@ void cCraftingRecipes::NormalizeIngredients(cCraftingRecipes::cRecipe * a_Recipe
 
 
 
-cCraftingRecipes::cRecipe * cCraftingRecipes::FindRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight)
+bool cCraftingRecipes::FindRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, cRecipe & a_Recipe)
 {
 	ASSERT(a_GridWidth <= MAX_GRID_WIDTH);
 	ASSERT(a_GridHeight <= MAX_GRID_HEIGHT);
-	
-	// Get the real bounds of the crafting grid:
-	int GridLeft = MAX_GRID_WIDTH, GridTop = MAX_GRID_HEIGHT;
-	int GridRight = 0,  GridBottom = 0;
-	for (int y = 0; y < a_GridHeight; y++) for (int x = 0; x < a_GridWidth; x++)
+
+	// Look the grid up in the index:
+	cCraftingRecipeIndex::sCell Cells[MAX_GRID_WIDTH * MAX_GRID_HEIGHT];
+	for (int i = a_GridWidth * a_GridHeight - 1; i >= 0; i--)
 	{
-		if (!a_CraftingGrid[x + y * a_GridWidth].IsEmpty())
-		{
-			GridRight  = std::max(x, GridRight);
-			GridBottom = std::max(y, GridBottom);
-			GridLeft   = std::min(x, GridLeft);
-			GridTop    = std::min(y, GridTop);
-		}
+		Cells[i].m_ItemType = a_CraftingGrid[i].IsEmpty() ? static_cast<short>(E_ITEM_EMPTY) : a_CraftingGrid[i].m_ItemType;
+		Cells[i].m_ItemDamage = a_CraftingGrid[i].m_ItemDamage;
 	}
-	int GridWidth = GridRight - GridLeft + 1;
-	int GridHeight = GridBottom - GridTop + 1;
-	
-	// Search in the possibly minimized grid, but keep the stride:
-	const cItem * Grid = a_CraftingGrid + GridLeft + (a_GridWidth * GridTop);
-	cRecipe * Recipe = FindRecipeCropped(Grid, GridWidth, GridHeight, a_GridWidth);
-	if (Recipe == nullptr)
+	cCraftingRecipeIndex::sMatch Match;
+	if (!m_Index.Find(Cells, a_GridWidth, a_GridHeight, Match))
 	{
-		return nullptr;
+		return false;
 	}
-	
-	// A recipe has been found, move it to correspond to the original crafting grid:
-	for (cRecipeSlots::iterator itrS = Recipe->m_Ingredients.begin(); itrS != Recipe->m_Ingredients.end(); ++itrS)
-	{
-		itrS->x += GridLeft;
-		itrS->y += GridTop;
-	}  // for itrS - Recipe->m_Ingredients[]
-	
-	return Recipe;
-}
-
 
-
-
-
-cCraftingRecipes::cRecipe * cCraftingRecipes::FindRecipeCropped(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, int a_GridStride)
-{
-	for (cRecipes::const_iterator itr = m_Recipes.begin(); itr != m_Recipes.end(); ++itr)
-	{
-		// Both the crafting grid and the recipes are normalized. The only variable possible is the "anywhere" items.
-		// This still means that the "anywhere" item may be the one that is offsetting the grid contents to the right or downwards, so we need to check all possible positions.
-		// E. g. recipe "A, * | B, 1:1 | ..." still needs to check grid for B at 2:2 (in case A was in grid's 1:1)
-		// Calculate the maximum offsets for this recipe relative to the grid size, and iterate through all combinations of offsets.
-		// Also, this calculation automatically filters out recipes that are too large for the current grid - the loop won't be entered at all.
-		
-		int MaxOfsX = a_GridWidth  - (*itr)->m_Width;
-		int MaxOfsY = a_GridHeight - (*itr)->m_Height;
-		for (int x = 0; x <= MaxOfsX; x++) for (int y = 0; y <= MaxOfsY; y++)
-		{
-			cRecipe * Recipe = MatchRecipe(a_CraftingGrid, a_GridWidth, a_GridHeight, a_GridStride, *itr, x, y);
-			if (Recipe != nullptr)
-			{
-				return Recipe;
-			}
-		}  // for y, for x
-	}  // for itr - m_Recipes[]
-	
-	// No matching recipe found
-	return nullptr;
-}
-
-
-
-
-
-cCraftingRecipes::cRecipe * cCraftingRecipes::MatchRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, int a_GridStride, const cRecipe * a_Recipe, int a_OffsetX, int a_OffsetY)
-{
-	// Check the regular items first:
-	bool HasMatched[MAX_GRID_WIDTH][MAX_GRID_HEIGHT];
-	memset(HasMatched, 0, sizeof(HasMatched));
-	for (cRecipeSlots::const_iterator itrS = a_Recipe->m_Ingredients.begin(); itrS != a_Recipe->m_Ingredients.end(); ++itrS)
-	{
-		if ((itrS->x < 0) || (itrS->y < 0))
-		{
-			// "Anywhere" item, process later
-			continue;
-		}
-		ASSERT(itrS->x + a_OffsetX < a_GridWidth);
-		ASSERT(itrS->y + a_OffsetY < a_GridHeight);
-		int GridID = (itrS->x + a_OffsetX) + a_GridStride * (itrS->y + a_OffsetY);
-		
-		const cItem & Item = itrS->m_Item;
-		if (
-			(itrS->x >= a_GridWidth) ||
-			(itrS->y >= a_GridHeight) ||
-			(Item.m_ItemType != a_CraftingGrid[GridID].m_ItemType) ||   // same item type?
-			(Item.m_ItemCount > a_CraftingGrid[GridID].m_ItemCount) ||  // not enough items
-			(
-				(Item.m_ItemDamage >= 0) &&  // should compare damage values?
-				(Item.m_ItemDamage != a_CraftingGrid[GridID].m_ItemDamage)
-			)
-		)
-		{
-			// Doesn't match
-			return nullptr;
-		}
-		HasMatched[itrS->x + a_OffsetX][itrS->y + a_OffsetY] = true;
-	}  // for itrS - Recipe->m_Ingredients[]
-	
-	// Process the "Anywhere" items now, and only in the cells that haven't matched yet
-	// The "anywhere" items are processed on a first-come-first-served basis.
-	// Do not use a recipe with one horizontal and one vertical "anywhere" ("*:1, 1:*") as it may not match properly!
-	cRecipeSlots MatchedSlots;  // Stores the slots of "anywhere" items that have matched, with the match coords
-	for (cRecipeSlots::const_iterator itrS = a_Recipe->m_Ingredients.begin(); itrS != a_Recipe->m_Ingredients.end(); ++itrS)
+	// Copy the recipe, with the coords moved to correspond to the crafting grid; the "anywhere" items go last:
+	const cRecipe & Recipe = *m_Recipes[Match.m_RecipeIdx];
+	a_Recipe.m_Result = Recipe.m_Result;
+	a_Recipe.m_Width  = Recipe.m_Width;
+	a_Recipe.m_Height = Recipe.m_Height;
+	a_Recipe.m_Ingredients.clear();
+	a_Recipe.m_Ingredients.reserve(Recipe.m_Ingredients.size());
+	for (cRecipeSlots::const_iterator itrS = Recipe.m_Ingredients.begin(); itrS != Recipe.m_Ingredients.end(); ++itrS)
 	{
 		if ((itrS->x >= 0) && (itrS->y >= 0))
 		{
-			// Regular item, already processed
-			continue;
-		}
-		int StartX = 0, EndX = a_GridWidth  - 1;
-		int StartY = 0, EndY = a_GridHeight - 1;
-		if (itrS->x >= 0)
-		{
-			StartX = itrS->x;
-			EndX = itrS->x;
-		}
-		else if (itrS->y >= 0)
-		{
-			StartY = itrS->y;
-			EndY = itrS->y;
-		}
-		bool Found = false;
-		for (int x = StartX; x <= EndX; x++)
-		{
-			for (int y = StartY; y <= EndY; y++)
-			{
-				if (HasMatched[x][y])
-				{
-					// Already matched some other item
-					continue;
-				}
-				int GridIdx = x + a_GridStride * y;
-				if (
-					(a_CraftingGrid[GridIdx].m_ItemType == itrS->m_Item.m_ItemType) &&
-					(
-						(itrS->m_Item.m_ItemDamage < 0) ||  // doesn't want damage comparison
-						(itrS->m_Item.m_ItemDamage == a_CraftingGrid[GridIdx].m_ItemDamage)  // the damage matches
-					)
-				)
-				{
-					HasMatched[x][y] = true;
-					Found = true;
-					MatchedSlots.push_back(*itrS);
-					MatchedSlots.back().x = x;
-					MatchedSlots.back().y = y;
-					break;
-				}
-			}  // for y
-			if (Found)
-			{
-				break;
-			}
-		}  // for x
-		if (!Found)
-		{
-			return nullptr;
-		}
-	}  // for itrS - a_Recipe->m_Ingredients[]
-	
-	// Check if the whole grid has matched:
-	for (int x = 0; x < a_GridWidth; x++) for (int y = 0; y < a_GridHeight; y++)
-	{
-		if (!HasMatched[x][y] && !a_CraftingGrid[x + a_GridStride * y].IsEmpty())
-		{
-			// There's an unmatched item in the grid
-			return nullptr;
+			a_Recipe.m_Ingredients.push_back(*itrS);
+			a_Recipe.m_Ingredients.back().x += Match.m_OffsetX;
+			a_Recipe.m_Ingredients.back().y += Match.m_OffsetY;
 		}
-	}  // for y, for x
-	
-	// The recipe has matched. Create a copy of the recipe and set its coords to match the crafting grid:
-	std::unique_ptr<cRecipe> Recipe(new cRecipe);
-	Recipe->m_Result = a_Recipe->m_Result;
-	Recipe->m_Width  = a_Recipe->m_Width;
-	Recipe->m_Height = a_Recipe->m_Height;
-	for (cRecipeSlots::const_iterator itrS = a_Recipe->m_Ingredients.begin(); itrS != a_Recipe->m_Ingredients.end(); ++itrS)
+	}
+	int NumAnywhere = 0;
+	for (cRecipeSlots::const_iterator itrS = Recipe.m_Ingredients.begin(); itrS != Recipe.m_Ingredients.end(); ++itrS)
 	{
 		if ((itrS->x < 0) || (itrS->y < 0))
 		{
-			// "Anywhere" item, process later
-			continue;
+			a_Recipe.m_Ingredients.push_back(*itrS);
+			a_Recipe.m_Ingredients.back().x = Match.m_AnywhereX[NumAnywhere];
+			a_Recipe.m_Ingredients.back().y = Match.m_AnywhereY[NumAnywhere];
+			NumAnywhere += 1;
 		}
-		Recipe->m_Ingredients.push_back(*itrS);
 	}
-	Recipe->m_Ingredients.insert(Recipe->m_Ingredients.end(), MatchedSlots.begin(), MatchedSlots.end());
 
-	// We use Recipe instead of a_Recipe because we want the wildcard ingredients' slot numbers as well, which was just added previously
-	HandleFireworks(a_CraftingGrid, Recipe.get(), a_GridStride, a_OffsetX, a_OffsetY);
-
-	return Recipe.release();
+	HandleFireworks(a_CraftingGrid, &a_Recipe, a_GridWidth);
+	return true;
 }
 
 
 
 
 
-void cCraftingRecipes::HandleFireworks(const cItem * a_CraftingGrid, cCraftingRecipes::cRecipe * a_Recipe, int a_GridStride, int a_OffsetX, int a_OffsetY)
+void cCraftingRecipes::HandleFireworks(const cItem * a_CraftingGrid, cCraftingRecipes::cRecipe * a_Recipe, int a_GridStride)
 {
 	// TODO: add support for more than one dye in the recipe
 	// A manual and temporary solution (listing everything) is in crafting.txt for fade colours, but a programmatic solutions needs to be done for everything else
@@ -798,7 +665,7 @@ void cCraftingRecipes::HandleFireworks(const cItem * a_CraftingGrid, cCraftingRe
 				case E_ITEM_FIREWORK_STAR:
 				{
 					// Result was a rocket, found a star - copy star data to rocket data
-					int GridID = (itr->x + a_OffsetX) + a_GridStride * (itr->y + a_OffsetY);
+					int GridID = itr->x + a_GridStride * itr->y;
 					a_Recipe->m_Result.m_FireworkItem.CopyFrom(a_CraftingGrid[GridID].m_FireworkItem);
 					break;
 				}
@@ -826,13 +693,13 @@ void cCraftingRecipes::HandleFireworks(const cItem * a_CraftingGrid, cCraftingRe
 				{
 					// Result was star, found another star - probably adding fade colours, but copy data over anyhow
 					FoundStar = true;
-					int GridID = (itr->x + a_OffsetX) + a_GridStride * (itr->y + a_OffsetY);
+					int GridID = itr->x + a_GridStride * itr->y;
 					a_Recipe->m_Result.m_FireworkItem.CopyFrom(a_CraftingGrid[GridID].m_FireworkItem);
 					break;
 				}
 				case E_ITEM_DYE:
 				{
-					int GridID = (itr->x + a_OffsetX) + a_GridStride * (itr->y + a_OffsetY);
+					int GridID = itr->x + a_GridStride * itr->y;
 					DyeColours.push_back(cFireworkItem::GetVanillaColourCodeFromDye((NIBBLETYPE)(a_CraftingGrid[GridID].m_ItemDamage & 0x0f)));
 					break;
 				}
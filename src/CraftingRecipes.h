@@ -9,6 +9,7 @@
 #pragma once
 
 #include "Item.h"
+#include "CraftingRecipeIndex.h"
 
 
 
@@ -141,6 +142,9 @@ protected:
 	typedef std::vector<cRecipe *> cRecipes;
 	
 	cRecipes m_Recipes;
+
+	/** The ingredients of m_Recipes, in the same order, indexed for the lookup by the crafting grid contents */
+	cCraftingRecipeIndex m_Index;
 	
 	void LoadRecipes(void);
 	void ClearRecipes(void);
@@ -157,17 +161,12 @@ protected:
 	/// Moves the recipe to top-left corner, sets its MinWidth / MinHeight
 	void NormalizeIngredients(cRecipe * a_Recipe);
 	
-	/// Finds a recipe matching the crafting grid. Returns a newly allocated recipe (with all its coords set) or nullptr if not found. Caller must delete return value!
-	cRecipe * FindRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight);
-	
-	/// Same as FindRecipe, but the grid is guaranteed to be of minimal dimensions needed
-	cRecipe * FindRecipeCropped(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, int a_GridStride);
-	
-	/// Checks if the grid matches the specified recipe, offset by the specified offsets. Returns a matched cRecipe * if so, or nullptr if not matching. Caller must delete the return value!
-	cRecipe * MatchRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, int a_GridStride, const cRecipe * a_Recipe, int a_OffsetX, int a_OffsetY);
+	/** Finds a recipe matching the crafting grid. Returns true and fills in a_Recipe, with all its coords set to match the grid, if found. */
+	bool FindRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, cRecipe & a_Recipe);
 
-	/** Searches for anything firework related, and does the data setting if appropriate */
-	void HandleFireworks(const cItem * a_CraftingGrid, cCraftingRecipes::cRecipe * a_Recipe, int a_GridStride, int a_OffsetX, int a_OffsetY);
+	/** Searches for anything firework related, and does the data setting if appropriate.
+	The recipe's coords are expected to match the grid. */
+	void HandleFireworks(const cItem * a_CraftingGrid, cCraftingRecipes::cRecipe * a_Recipe, int a_GridStride);
 } ;
 
 
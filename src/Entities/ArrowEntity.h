@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ProjectileEntity.h"
+#include "EntityPool.h"
 
 
 
@@ -35,6 +36,7 @@ public:
 	// tolua_end
 	
 	CLASS_PROTODEF(cArrowEntity)
+	ENTITY_POOL_ALLOCATION(cArrowEntity)
 	
 	/** Creates a new arrow with psNoPickup state and default damage modifier coeff */
 	cArrowEntity(cEntity * a_Creator, double a_X, double a_Y, double a_Z, const Vector3d & a_Speed);
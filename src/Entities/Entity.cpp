@@ -7,9 +7,11 @@
 #include "../Matrix4.h"
 #include "../ClientHandle.h"
 #include "../Chunk.h"
+#include "../ChunkMap.h"
 #include "../Simulator/FluidSimulator.h"
 #include "../Bindings/PluginManager.h"
 #include "../Tracer.h"
+#include "EntityPhysicsBatch.h"
 #include "Player.h"
 #include "Items/ItemHandler.h"
 #include "../FastRandom.h"
@@ -34,6 +36,7 @@ cEntity::cEntity(eEntityType a_EntityType, double a_X, double a_Y, double a_Z, d
 	m_bDirtyHead(true),
 	m_bDirtyOrientation(true),
 	m_bHasSentNoSpeed(true),
+	m_HasUnsyncedClients(false),
 	m_bOnGround(false),
 	m_Gravity(-9.81f),
 	m_AirDrag(0.02f),
@@ -60,8 +63,17 @@ cEntity::cEntity(eEntityType a_EntityType, double a_X, double a_Y, double a_Z, d
 	m_Mass (0.001),  // Default 1g
 	m_Width(a_Width),
 	m_Height(a_Height),
-	m_InvulnerableTicks(0)
+	m_InvulnerableTicks(0),
+	m_ChunkEntityCellChunk(nullptr),
+	m_ChunkEntityCellMap(nullptr),
+	m_ChunkEntityCell(-1),
+	m_ChunkEntityCellIdx(0),
+	m_InactiveTime(0),
+	m_InactiveTicks(0),
+	m_CatchUpTicks(0)
 {
+	ASSERT(a_Height <= MAX_HEIGHT);  // The chunk's entity index queries would miss the entity
+
 	// Assign a proper ID:
 	cCSLock Lock(m_CSCount);
 	m_EntityCount++;
@@ -775,11 +787,13 @@ void cEntity::SetHealth(int a_Health)
 
 void cEntity::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 {
-	m_TicksAlive++;
+	// Also count the ticks skipped by the activation throttling, see cEntityActivation:
+	int NumTicks = 1 + m_CatchUpTicks;
+	m_TicksAlive += NumTicks;
 	
 	if (m_InvulnerableTicks > 0)
 	{
-		m_InvulnerableTicks--;
+		m_InvulnerableTicks = std::max(m_InvulnerableTicks - NumTicks, 0);
 	}
 
 	if (m_AttachedTo != nullptr)
@@ -830,10 +844,11 @@ void cEntity::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 			HandleAir();
 		}
 		
-		if (!DetectPortal())  // Our chunk is invalid if we have moved to another world
+		// The batched entities have already been moved by the chunk, see cEntityPhysicsBatch:
+		if (!DetectPortal() && !cEntityPhysicsBatch::IsBatched(*this))  // Our chunk is invalid if we have moved to another world
 		{
 			// None of the above functions changed position, we remain in the chunk of NextChunk
-			HandlePhysics(a_Dt, *NextChunk);
+			HandlePhysics(cEntityActivation::ClampPhysicsDt(a_Dt), *NextChunk);
 		}
 	}
 }
@@ -1403,6 +1418,7 @@ bool cEntity::DoMoveToWorld(cWorld * a_World, bool a_ShouldSendRespawn)
 	}
 
 	// Remove all links to the old world
+	RemoveFromChunkEntityCell();
 	SetWorldTravellingFrom(GetWorld());  // cChunk::Tick() handles entity removal
 	GetWorld()->BroadcastDestroyEntity(*this);
 
@@ -1651,21 +1667,22 @@ void cEntity::BroadcastMovementUpdate(const cClientHandle * a_Exclude)
 	// Process packet sending every two ticks
 	if (GetWorld()->GetWorldAge() % 2 == 0)
 	{
+		cEntityTracker::sMovement Movement;
 		double SpeedSqr = GetSpeed().SqrLength();
 		if (SpeedSqr == 0.0)
 		{
 			// Speed is zero, send this to clients once only as well as an absolute position
 			if (!m_bHasSentNoSpeed)
 			{
-				m_World->BroadcastEntityVelocity(*this, a_Exclude);
-				m_World->BroadcastTeleportEntity(*this, a_Exclude);
+				Movement.m_Velocity = true;
+				Movement.m_Teleport = true;
 				m_bHasSentNoSpeed = true;
 			}
 		}
 		else
 		{
 			// Movin'
-			m_World->BroadcastEntityVelocity(*this, a_Exclude);
+			Movement.m_Velocity = true;
 			m_bHasSentNoSpeed = false;
 		}
 		
@@ -1679,14 +1696,17 @@ void cEntity::BroadcastMovementUpdate(const cClientHandle * a_Exclude)
 			if ((abs(DiffX) <= 127) && (abs(DiffY) <= 127) && (abs(DiffZ) <= 127))  // Limitations of a Byte
 			{
 				// Difference within Byte limitations, use a relative move packet
+				Movement.m_RelX = (char)DiffX;
+				Movement.m_RelY = (char)DiffY;
+				Movement.m_RelZ = (char)DiffZ;
 				if (m_bDirtyOrientation)
 				{
-					m_World->BroadcastEntityRelMoveLook(*this, (char)DiffX, (char)DiffY, (char)DiffZ, a_Exclude);
+					Movement.m_RelMoveLook = true;
 					m_bDirtyOrientation = false;
 				}
 				else
 				{
-					m_World->BroadcastEntityRelMove(*this, (char)DiffX, (char)DiffY, (char)DiffZ, a_Exclude);
+					Movement.m_RelMove = true;
 				}
 				// Clients seem to store two positions, one for the velocity packet and one for the teleport/relmove packet
 				// The latter is only changed with a relmove/teleport, and m_LastPos stores this position
@@ -1695,7 +1715,7 @@ void cEntity::BroadcastMovementUpdate(const cClientHandle * a_Exclude)
 			else
 			{
 				// Too big a movement, do a teleport
-				m_World->BroadcastTeleportEntity(*this, a_Exclude);
+				Movement.m_Teleport = true;
 				m_LastPos = GetPosition();  // See above
 				m_bDirtyOrientation = false;
 			}
@@ -1703,15 +1723,22 @@ void cEntity::BroadcastMovementUpdate(const cClientHandle * a_Exclude)
 
 		if (m_bDirtyHead)
 		{
-			m_World->BroadcastEntityHeadLook(*this, a_Exclude);
+			Movement.m_HeadLook = true;
 			m_bDirtyHead = false;
 		}
 		if (m_bDirtyOrientation)
 		{
 			// Send individual update in case above (sending with rel-move packet) wasn't done
-			GetWorld()->BroadcastEntityLook(*this, a_Exclude);
+			Movement.m_Look = true;
 			m_bDirtyOrientation = false;
 		}
+
+		// The entity tracker decides which clients get the update; clients that skipped some updates, or that are out of range,
+		// get rechecked later even if nothing changes:
+		if (!Movement.IsEmpty() || m_HasUnsyncedClients)
+		{
+			m_HasUnsyncedClients = m_World->BroadcastEntityMovement(*this, Movement, a_Exclude);
+		}
 	}
 }
 
@@ -1790,6 +1817,7 @@ void cEntity::SetHeadYaw(double a_HeadYaw)
 
 void cEntity::SetHeight(double a_Height)
 {
+	ASSERT(a_Height <= MAX_HEIGHT);  // The chunk's entity index queries would miss the entity
 	m_Height = a_Height;
 }
 
@@ -2001,6 +2029,7 @@ Vector3d cEntity::GetLookVector(void) const
 void cEntity::SetPosition(double a_PosX, double a_PosY, double a_PosZ)
 {
 	m_Pos.Set(a_PosX, a_PosY, a_PosZ);
+	UpdateChunkEntityCell();
 }
 
 
@@ -2019,6 +2048,7 @@ void cEntity::SetPosX(double a_PosX)
 void cEntity::SetPosY(double a_PosY)
 {
 	m_Pos.y = a_PosY;
+	UpdateChunkEntityCell();
 }
 
 
@@ -2033,3 +2063,31 @@ void cEntity::SetPosZ(double a_PosZ)
 
 
 
+
+void cEntity::UpdateChunkEntityCell(void)
+{
+	// The chunk's entity index is otherwise only updated after each tick; keep it valid for the teleports and the position packets.
+	// Lock the chunkmap that stores the entity, rather than m_World's, those differ while the entity is travelling between worlds:
+	cChunkMap * ChunkMap = m_ChunkEntityCellMap;
+	if (ChunkMap != nullptr)
+	{
+		ChunkMap->UpdateEntityCell(*this);
+	}
+}
+
+
+
+
+
+void cEntity::RemoveFromChunkEntityCell(void)
+{
+	cChunkMap * ChunkMap = m_ChunkEntityCellMap;
+	if (ChunkMap != nullptr)
+	{
+		ChunkMap->RemoveEntityFromCell(*this);
+	}
+}
+
+
+
+
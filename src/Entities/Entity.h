@@ -42,6 +42,7 @@ class cWorld;
 class cClientHandle;
 class cPlayer;
 class cChunk;
+class cChunkMap;
 
 
 
@@ -138,6 +139,7 @@ public:
 	static const int BURN_TICKS            = 200;  ///< Ticks to keep an entity burning after it has stood in lava / fire
 	
 	static const int MAX_AIR_LEVEL         = 300;  ///< Maximum air an entity can have
+	static const int MAX_HEIGHT            = 11;   ///< Height of the tallest entity (cGiant, 10.8), rounded up; the chunk's entity index relies on it
 	static const int DROWNING_TICKS        = 20;   ///< Number of ticks per heart of damage
 	
 	static const int VOID_BOUNDARY         = -46;  ///< Y position to begin applying void damage
@@ -334,6 +336,9 @@ public:
 	
 	// tolua_end
 
+	/** Moves the item drops and XP orbs instead of HandlePhysics(), needs their physics state */
+	friend class cEntityPhysicsBatch;
+
 	virtual void Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk);
 	
 	/// Handles the physics of the entity - updates position based on speed, updates speed based on environment
@@ -470,6 +475,61 @@ public:
 	/** Sets the internal world pointer to a new cWorld, doesn't update anything else. */
 	void SetWorld(cWorld * a_World) { m_World = a_World; }
 
+	/** Returns the index of the cell of the chunk's entity index in which the entity is stored, -1 if not stored in any.
+	Maintained by cChunk only. */
+	int GetChunkEntityCell(void) const { return m_ChunkEntityCell; }
+
+	/** Returns the position of the entity within its cell of the chunk's entity index. Maintained by cChunk only. */
+	size_t GetChunkEntityCellIdx(void) const { return m_ChunkEntityCellIdx; }
+
+	/** Returns the chunk in whose entity index the entity is stored, nullptr if not stored in any. Maintained by cChunk only. */
+	cChunk * GetChunkEntityCellChunk(void) const { return m_ChunkEntityCellChunk; }
+
+	/** Returns the chunkmap of the chunk in whose entity index the entity is stored, nullptr if not stored in any.
+	The chunkmap's CS protects the entity's cell; it may belong to another world than GetWorld() while the entity is travelling. */
+	cChunkMap * GetChunkEntityCellMap(void) const { return m_ChunkEntityCellMap; }
+
+	/** Sets the chunk (and its chunkmap), the cell and the position within the cell in which the entity is stored. Used by cChunk only. */
+	void SetChunkEntityCell(cChunk * a_Chunk, cChunkMap * a_ChunkMap, int a_Cell, size_t a_Idx)
+	{
+		m_ChunkEntityCellChunk = a_Chunk;
+		m_ChunkEntityCellMap = a_ChunkMap;
+		m_ChunkEntityCell = a_Cell;
+		m_ChunkEntityCellIdx = a_Idx;
+	}
+
+	/** Sets the position of the entity within its cell, after another entity has been removed from the cell. Used by cChunk only. */
+	void SetChunkEntityCellIdx(size_t a_Idx) { m_ChunkEntityCellIdx = a_Idx; }
+
+	/** Moves the entity into the proper cell of its chunk's entity index, after its position has been set directly */
+	void UpdateChunkEntityCell(void);
+
+	/** Removes the entity from its chunk's entity index, when leaving the world.
+	The entity stays in the chunk's m_Entities until the chunk's next tick, but by then it may already be indexed by a chunk of the new world. */
+	void RemoveFromChunkEntityCell(void);
+
+	/** Returns true if another entity is attached to this entity (rides it) */
+	bool HasAttachee(void) const { return (m_Attachee != nullptr); }
+
+	/** Returns the time that has passed since the entity was last ticked, not counting the current tick.
+	Nonzero only while the entity is out of its activation range, see cEntityActivation. */
+	std::chrono::milliseconds GetInactiveTime(void) const { return m_InactiveTime; }
+
+	/** Sets the time that has passed since the entity was last ticked. Used by cEntityActivation only. */
+	void SetInactiveTime(std::chrono::milliseconds a_InactiveTime) { m_InactiveTime = a_InactiveTime; }
+
+	/** Returns the number of ticks skipped since the entity was last ticked, not counting the current tick. */
+	int GetInactiveTicks(void) const { return m_InactiveTicks; }
+
+	/** Sets the number of ticks skipped since the entity was last ticked. Used by cEntityActivation only. */
+	void SetInactiveTicks(int a_InactiveTicks) { m_InactiveTicks = a_InactiveTicks; }
+
+	/** Returns the number of ticks that were skipped before the current tick; the tick counters advance by this many extra ticks. */
+	int GetCatchUpTicks(void) const { return m_CatchUpTicks; }
+
+	/** Sets the number of ticks that were skipped before the current tick. Used by cEntityActivation only. */
+	void SetCatchUpTicks(int a_CatchUpTicks) { m_CatchUpTicks = a_CatchUpTicks; }
+
 protected:
 	static cCriticalSection m_CSCount;
 	static UInt32 m_EntityCount;
@@ -501,6 +561,9 @@ protected:
 	Ensures that said packet is sent only once */
 	bool m_bHasSentNoSpeed;
 
+	/** Set when the entity tracker has skipped an update for some of the clients; those need a resync even if the entity doesn't move */
+	bool m_HasUnsyncedClients;
+
 	/** Stores if the entity is on the ground */
 	bool m_bOnGround;
 	
@@ -617,6 +680,28 @@ private:
 	/** If a player hit a entity, the entity receive a invulnerable of 10 ticks.
 	While this ticks, a player can't hit this entity. */
 	int m_InvulnerableTicks;
+
+	/** The chunk in whose entity index the entity is stored, nullptr if none. See cChunk::m_EntityCells.
+	Protected by the CS of m_ChunkEntityCellMap. */
+	cChunk * m_ChunkEntityCellChunk;
+
+	/** The chunkmap owning m_ChunkEntityCellChunk, nullptr if none. */
+	cChunkMap * m_ChunkEntityCellMap;
+
+	/** The cell of the owning chunk's entity index in which the entity is stored, -1 if none. See cChunk::m_EntityCells. */
+	int m_ChunkEntityCell;
+
+	/** The position of the entity within its cell, so that it can be removed without searching the cell */
+	size_t m_ChunkEntityCellIdx;
+
+	/** The time skipped by the activation throttling since the last tick, see cEntityActivation */
+	std::chrono::milliseconds m_InactiveTime;
+
+	/** The number of ticks skipped by the activation throttling since the last tick, see cEntityActivation */
+	int m_InactiveTicks;
+
+	/** The number of ticks skipped before the current tick, the per-tick counters catch up by this many ticks */
+	int m_CatchUpTicks;
 } ;  // tolua_export
 
 typedef std::list<cEntity *> cEntityList;
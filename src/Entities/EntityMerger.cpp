@@ -0,0 +1,287 @@
+
+// EntityMerger.cpp
+
+// Implements the cEntityMerger class that combines the nearby item drops and XP orbs of a chunk into fewer entities
+
+#include "Globals.h"
+#include "EntityMerger.h"
+#include "Pickup.h"
+#include "ExpOrb.h"
+#include "../World.h"
+#include "../IniFile.h"
+#include "../CommandOutput.h"
+
+
+
+
+
+cEntityMerger::cEntityMerger(void) :
+	m_IsEnabled(true),
+	m_PickupRadius(1.2),
+	m_ExpOrbRadius(1.5),
+	m_MaxExpOrbReward(2477),  // The largest XP orb size known to the clients
+	m_Interval(5),
+	m_WorldTick(0),
+	m_NumMergedPickups(0),
+	m_NumMergedExpOrbs(0),
+	m_LastNumMergedPickups(0),
+	m_LastNumMergedExpOrbs(0),
+	m_TotalNumMergedPickups(0),
+	m_TotalNumMergedExpOrbs(0)
+{
+}
+
+
+
+
+
+void cEntityMerger::Load(cIniFile & a_IniFile)
+{
+	m_IsEnabled       = a_IniFile.GetValueSetB("EntityMerging", "Enabled",         m_IsEnabled);
+	m_PickupRadius    = a_IniFile.GetValueSetF("EntityMerging", "PickupRadius",    m_PickupRadius);
+	m_ExpOrbRadius    = a_IniFile.GetValueSetF("EntityMerging", "ExpOrbRadius",    m_ExpOrbRadius);
+	m_MaxExpOrbReward = a_IniFile.GetValueSetI("EntityMerging", "MaxExpOrbReward", m_MaxExpOrbReward);
+	m_Interval        = a_IniFile.GetValueSetI("EntityMerging", "Interval",        m_Interval);
+
+	// Radius 0 would make zero-sized cells:
+	m_PickupRadius = Clamp(m_PickupRadius, 0.1, 8.0);
+	m_ExpOrbRadius = Clamp(m_ExpOrbRadius, 0.1, 8.0);
+	m_MaxExpOrbReward = std::max(m_MaxExpOrbReward, 1);
+	m_Interval = std::max(m_Interval, 1);
+}
+
+
+
+
+
+void cEntityMerger::BeginTick(Int64 a_WorldTick)
+{
+	m_WorldTick = a_WorldTick;
+	{
+		cCSLock Lock(m_CS);
+		m_LastNumMergedPickups = m_NumMergedPickups;
+		m_LastNumMergedExpOrbs = m_NumMergedExpOrbs;
+		m_TotalNumMergedPickups += m_NumMergedPickups;
+		m_TotalNumMergedExpOrbs += m_NumMergedExpOrbs;
+	}
+	m_NumMergedPickups = 0;
+	m_NumMergedExpOrbs = 0;
+}
+
+
+
+
+
+void cEntityMerger::MergeChunkEntities(int a_ChunkX, int a_ChunkZ, const std::vector<cEntity *> & a_Entities)
+{
+	if (!m_IsEnabled)
+	{
+		return;
+	}
+
+	// Spread the chunks' passes over the interval:
+	if (((m_WorldTick + a_ChunkX + a_ChunkZ * 3) % m_Interval) != 0)
+	{
+		return;
+	}
+
+	m_Pickups.clear();
+	m_ExpOrbs.clear();
+	for (std::vector<cEntity *>::const_iterator itr = a_Entities.begin(), end = a_Entities.end(); itr != end; ++itr)
+	{
+		cEntity * Entity = *itr;
+		if ((Entity == nullptr) || Entity->IsDestroyed())
+		{
+			continue;
+		}
+		if (Entity->IsPickup())
+		{
+			AddToCells(m_Pickups, Entity, m_PickupRadius);
+		}
+		else if (Entity->IsExpOrb())
+		{
+			AddToCells(m_ExpOrbs, Entity, m_ExpOrbRadius);
+		}
+	}  // for itr - a_Entities[]
+
+	if (m_Pickups.size() > 1)
+	{
+		m_NumMergedPickups += MergeCells(m_Pickups, m_PickupRadius);
+	}
+	if (m_ExpOrbs.size() > 1)
+	{
+		m_NumMergedExpOrbs += MergeCells(m_ExpOrbs, m_ExpOrbRadius);
+	}
+}
+
+
+
+
+
+void cEntityMerger::Report(cCommandOutputCallback & a_Output) const
+{
+	cCSLock Lock(m_CS);
+	if (!m_IsEnabled)
+	{
+		a_Output.Out("  Merging of item drops and XP orbs is disabled");
+		return;
+	}
+	a_Output.Out("  Merged item drops: %d in the last tick, %lld total",
+		m_LastNumMergedPickups, static_cast<long long>(m_TotalNumMergedPickups)
+	);
+	a_Output.Out("  Merged XP orbs: %d in the last tick, %lld total",
+		m_LastNumMergedExpOrbs, static_cast<long long>(m_TotalNumMergedExpOrbs)
+	);
+}
+
+
+
+
+
+Int64 cEntityMerger::MakeCellKey(int a_CellX, int a_CellY, int a_CellZ)
+{
+	// 21 bits per coord; a single chunk spans far fewer cells than that, so the keys never collide within a chunk:
+	return (
+		((static_cast<Int64>(a_CellX) & 0x1fffff) << 42) |
+		((static_cast<Int64>(a_CellY) & 0x1fffff) << 21) |
+		(static_cast<Int64>(a_CellZ) & 0x1fffff)
+	);
+}
+
+
+
+
+
+void cEntityMerger::AddToCells(sCellEntities & a_Cells, cEntity * a_Entity, double a_CellSize)
+{
+	sCellEntity Cell;
+	Cell.m_CellX = FloorC(a_Entity->GetPosX() / a_CellSize);
+	Cell.m_CellY = FloorC(a_Entity->GetPosY() / a_CellSize);
+	Cell.m_CellZ = FloorC(a_Entity->GetPosZ() / a_CellSize);
+	Cell.m_CellKey = MakeCellKey(Cell.m_CellX, Cell.m_CellY, Cell.m_CellZ);
+	Cell.m_Entity = a_Entity;
+	a_Cells.push_back(Cell);
+}
+
+
+
+
+
+int cEntityMerger::MergeCells(sCellEntities & a_Cells, double a_Radius)
+{
+	std::sort(a_Cells.begin(), a_Cells.end());
+	const sCellEntities & Cells = a_Cells;
+
+	int NumMerged = 0;
+	double RadiusSq = a_Radius * a_Radius;
+	for (sCellEntities::const_iterator itrT = Cells.begin(), endT = Cells.end(); itrT != endT; ++itrT)
+	{
+		cEntity * Target = itrT->m_Entity;
+		if (Target->IsDestroyed())
+		{
+			continue;
+		}
+
+		// The cells are at least as large as the radius, so all the candidates are in the 27 cells around the target's:
+		for (int y = itrT->m_CellY - 1; y <= itrT->m_CellY + 1; y++)
+		{
+			for (int z = itrT->m_CellZ - 1; z <= itrT->m_CellZ + 1; z++)
+			{
+				for (int x = itrT->m_CellX - 1; x <= itrT->m_CellX + 1; x++)
+				{
+					sCellEntity Key;
+					Key.m_CellKey = MakeCellKey(x, y, z);
+					std::pair<sCellEntities::const_iterator, sCellEntities::const_iterator> Range = std::equal_range(Cells.begin(), endT, Key);
+					for (sCellEntities::const_iterator itrS = Range.first; itrS != Range.second; ++itrS)
+					{
+						// The older entity (lower ID) absorbs the newer one:
+						cEntity * Source = itrS->m_Entity;
+						if ((Source->GetUniqueID() <= Target->GetUniqueID()) || Source->IsDestroyed())
+						{
+							continue;
+						}
+						if ((Source->GetPosition() - Target->GetPosition()).SqrLength() > RadiusSq)
+						{
+							continue;
+						}
+						if (Merge(*Target, *Source))
+						{
+							Source->Destroy();
+							NumMerged += 1;
+						}
+					}  // for itrS - Cells[Range]
+				}  // for x
+			}  // for z
+		}  // for y
+	}  // for itrT - Cells[]
+	return NumMerged;
+}
+
+
+
+
+
+bool cEntityMerger::Merge(cEntity & a_Target, cEntity & a_Source)
+{
+	if (a_Target.IsPickup())
+	{
+		return MergePickups(static_cast<cPickup &>(a_Target), static_cast<cPickup &>(a_Source));
+	}
+	return MergeExpOrbs(static_cast<cExpOrb &>(a_Target), static_cast<cExpOrb &>(a_Source), m_MaxExpOrbReward);
+}
+
+
+
+
+
+bool cEntityMerger::MergePickups(cPickup & a_Target, cPickup & a_Source)
+{
+	if (a_Target.IsCollected() || a_Source.IsCollected() || (a_Target.IsPlayerCreated() != a_Source.IsPlayerCreated()))
+	{
+		return false;
+	}
+	cItem & TargetItem = a_Target.GetItem();
+	cItem & SourceItem = a_Source.GetItem();
+	if (!TargetItem.IsEqual(SourceItem))
+	{
+		return false;
+	}
+	int Count = std::min(static_cast<int>(SourceItem.m_ItemCount), TargetItem.GetMaxStackSize() - TargetItem.m_ItemCount);
+	if (Count <= 0)
+	{
+		return false;
+	}
+
+	TargetItem.m_ItemCount = static_cast<char>(TargetItem.m_ItemCount + Count);
+	SourceItem.m_ItemCount = static_cast<char>(SourceItem.m_ItemCount - Count);
+
+	// The moved items must not become collectable sooner, nor despawn sooner, than they would have:
+	a_Target.SetAge(std::min(a_Target.GetAge(), a_Source.GetAge()));
+
+	a_Target.GetWorld()->BroadcastEntityMetadata(a_Target);
+	if (SourceItem.m_ItemCount > 0)
+	{
+		a_Source.GetWorld()->BroadcastEntityMetadata(a_Source);
+		return false;
+	}
+	return true;
+}
+
+
+
+
+
+bool cEntityMerger::MergeExpOrbs(cExpOrb & a_Target, cExpOrb & a_Source, int a_MaxReward)
+{
+	if (a_Target.GetReward() + a_Source.GetReward() > a_MaxReward)
+	{
+		return false;
+	}
+	a_Target.SetReward(a_Target.GetReward() + a_Source.GetReward());
+	a_Target.SetAge(std::min(a_Target.GetAge(), a_Source.GetAge()));
+	return true;
+}
+
+
+
+
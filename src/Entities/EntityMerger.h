@@ -0,0 +1,127 @@
+
+// EntityMerger.h
+
+// Declares the cEntityMerger class that combines the nearby item drops and XP orbs of a chunk into fewer entities
+
+
+
+
+
+#pragma once
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+class cEntity;
+class cExpOrb;
+class cIniFile;
+class cPickup;
+
+
+
+
+
+/** Combines the item drops (cPickup) with the same item, and the XP orbs (cExpOrb), that are close to each other.
+Mob grinders and explosions spawn the drops by the thousands; each is ticked, sent to the clients and saved separately.
+The merger periodically runs over each chunk's entities, sorts the drops and orbs into a spatial hash of cells
+the size of the merge radius, and only compares the entities in the neighboring cells. The older entity (lower ID)
+absorbs the newer one, up to the item's max stack size, and takes over the younger age, so that neither the
+collection delay nor the despawn time of any item is shortened. Pickups that differ in IsPlayerCreated() are never
+merged, because their collection delays differ.
+One instance is owned by each world, configured in the [EntityMerging] section of the world's ini file.
+The merging runs in the world's tick thread; the stats can be read from any thread. */
+class cEntityMerger
+{
+public:
+
+	cEntityMerger(void);
+
+	/** Reads the settings from the [EntityMerging] section of the world's ini file, writing the defaults if not present. */
+	void Load(cIniFile & a_IniFile);
+
+	/** Starts a new tick; publishes the counts of the previous tick for the stats. Called by the world at the tick start. */
+	void BeginTick(Int64 a_WorldTick);
+
+	/** Merges the compatible item drops and XP orbs out of a_Entities, if the merging is due in this tick for the chunk.
+	The absorbed entities are destroyed; the caller removes them as usual. */
+	void MergeChunkEntities(int a_ChunkX, int a_ChunkZ, const std::vector<cEntity *> & a_Entities);
+
+	/** Outputs the merge stats. */
+	void Report(cCommandOutputCallback & a_Output) const;
+
+protected:
+
+	/** An entity in the spatial hash */
+	struct sCellEntity
+	{
+		Int64 m_CellKey;
+		int m_CellX, m_CellY, m_CellZ;
+		cEntity * m_Entity;
+
+		bool operator <(const sCellEntity & a_Other) const { return (m_CellKey < a_Other.m_CellKey); }
+	} ;
+
+	typedef std::vector<sCellEntity> sCellEntities;
+
+
+	/** If false, no merging is done */
+	bool m_IsEnabled;
+
+	/** Maximum distance between two merged item drops / XP orbs, in blocks */
+	double m_PickupRadius;
+	double m_ExpOrbRadius;
+
+	/** The largest reward that a merged XP orb may have */
+	int m_MaxExpOrbReward;
+
+	/** Number of ticks between two merging passes over a single chunk */
+	int m_Interval;
+
+	/** The world age, in ticks, of the current tick */
+	Int64 m_WorldTick;
+
+	/** The spatial hashes of the current chunk, sorted by the cell key. Kept between the calls to reuse the memory. */
+	sCellEntities m_Pickups;
+	sCellEntities m_ExpOrbs;
+
+	/** Number of the entities absorbed in the current tick. Only used in the tick thread. */
+	int m_NumMergedPickups;
+	int m_NumMergedExpOrbs;
+
+	/** Protects the m_Last* and m_Total* stats */
+	mutable cCriticalSection m_CS;
+
+	/** Number of the entities absorbed in the last finished tick */
+	int m_LastNumMergedPickups;
+	int m_LastNumMergedExpOrbs;
+
+	/** Number of the entities absorbed since the world started */
+	Int64 m_TotalNumMergedPickups;
+	Int64 m_TotalNumMergedExpOrbs;
+
+
+	/** Returns the key of the cell at the specified cell coords */
+	static Int64 MakeCellKey(int a_CellX, int a_CellY, int a_CellZ);
+
+	/** Adds the entity to a_Cells, in the cell of the specified size containing the entity */
+	static void AddToCells(sCellEntities & a_Cells, cEntity * a_Entity, double a_CellSize);
+
+	/** Merges the close enough entities in a_Cells. Returns the number of the absorbed entities. */
+	int MergeCells(sCellEntities & a_Cells, double a_Radius);
+
+	/** Merges a_Source into a_Target, if they are compatible. Returns true if a_Source has been absorbed completely. */
+	bool Merge(cEntity & a_Target, cEntity & a_Source);
+
+	/** Moves as many items from a_Source to a_Target as fits. Returns true if a_Source has been absorbed completely. */
+	static bool MergePickups(cPickup & a_Target, cPickup & a_Source);
+
+	/** Moves the reward of a_Source to a_Target, if the sum fits into a_MaxReward. Returns true if a_Source has been absorbed. */
+	static bool MergeExpOrbs(cExpOrb & a_Target, cExpOrb & a_Source, int a_MaxReward);
+} ;
+
+
+
+
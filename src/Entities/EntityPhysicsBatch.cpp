@@ -0,0 +1,391 @@
+
+// EntityPhysicsBatch.cpp
+
+// Implements the cEntityPhysicsBatch class that moves all the simple physics entities of a chunk in a single pass
+
+#include "Globals.h"
+#include "EntityPhysicsBatch.h"
+#include "Entity.h"
+#include "../Chunk.h"
+#include "../World.h"
+#include "../Simulator/FluidSimulator.h"
+
+
+
+
+
+const double cEntityPhysicsBatch::MAX_STEP_LENGTH = 0.5;
+
+
+
+
+
+cEntityPhysicsBatch::cEntityPhysicsBatch(void) :
+	m_ChunkX(0),
+	m_ChunkZ(0),
+	m_WaterSimulator(nullptr)
+{
+	memset(m_Chunks, 0, sizeof(m_Chunks));
+}
+
+
+
+
+
+bool cEntityPhysicsBatch::IsBatched(const cEntity & a_Entity)
+{
+	switch (a_Entity.GetEntityType())
+	{
+		case cEntity::etPickup:
+		case cEntity::etExpOrb:
+		{
+			return (a_Entity.m_AttachedTo == nullptr);
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
+
+
+
+void cEntityPhysicsBatch::Simulate(cChunk & a_Chunk, const std::vector<cEntity *> & a_Entities, const std::vector<std::chrono::milliseconds> & a_TickDts)
+{
+	Gather(a_Entities, a_TickDts);
+	if (m_Entities.empty())
+	{
+		return;
+	}
+	LoadNeighborhood(a_Chunk);
+
+	for (size_t i = 0, count = m_Entities.size(); i < count; i++)
+	{
+		SimulateEntity(i);
+	}
+
+	Scatter(a_Chunk);
+}
+
+
+
+
+
+void cEntityPhysicsBatch::Gather(const std::vector<cEntity *> & a_Entities, const std::vector<std::chrono::milliseconds> & a_TickDts)
+{
+	ASSERT(a_Entities.size() == a_TickDts.size());
+	m_Entities.clear();
+	m_TickDts.clear();
+	m_Dt.clear();
+	m_PosX.clear();
+	m_PosY.clear();
+	m_PosZ.clear();
+	m_SpeedX.clear();
+	m_SpeedY.clear();
+	m_SpeedZ.clear();
+	m_WaterSpeedX.clear();
+	m_WaterSpeedZ.clear();
+	m_Gravity.clear();
+	m_AirDrag.clear();
+	m_IsOnGround.clear();
+	m_Result.clear();
+
+	for (size_t i = 0, count = a_Entities.size(); i < count; i++)
+	{
+		cEntity * Entity = a_Entities[i];
+		if ((Entity == nullptr) || (a_TickDts[i].count() <= 0) || Entity->IsDestroyed() || !IsBatched(*Entity))
+		{
+			continue;
+		}
+		std::chrono::milliseconds PhysicsDt = cEntityActivation::ClampPhysicsDt(a_TickDts[i]);
+		m_Entities.push_back(Entity);
+		m_TickDts.push_back(PhysicsDt);
+		m_Dt.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(PhysicsDt).count());
+		m_PosX.push_back(Entity->GetPosX());
+		m_PosY.push_back(Entity->GetPosY());
+		m_PosZ.push_back(Entity->GetPosZ());
+		m_SpeedX.push_back(Entity->m_Speed.x);
+		m_SpeedY.push_back(Entity->m_Speed.y);
+		m_SpeedZ.push_back(Entity->m_Speed.z);
+		m_WaterSpeedX.push_back(Entity->m_WaterSpeed.x);
+		m_WaterSpeedZ.push_back(Entity->m_WaterSpeed.z);
+		m_Gravity.push_back(Entity->m_Gravity);
+		m_AirDrag.push_back(Entity->m_AirDrag);
+		m_IsOnGround.push_back(Entity->m_bOnGround ? 1 : 0);
+		m_Result.push_back(resMoved);
+	}  // for i - a_Entities[]
+}
+
+
+
+
+
+void cEntityPhysicsBatch::LoadNeighborhood(cChunk & a_Chunk)
+{
+	m_ChunkX = a_Chunk.GetPosX();
+	m_ChunkZ = a_Chunk.GetPosZ();
+	for (int x = 0; x < 3; x++)
+	{
+		for (int z = 0; z < 3; z++)
+		{
+			cChunk * Chunk = a_Chunk.GetRelNeighborChunk((x - 1) * cChunkDef::Width, (z - 1) * cChunkDef::Width);
+			m_Chunks[x][z] = ((Chunk != nullptr) && Chunk->IsValid()) ? Chunk : nullptr;
+		}
+	}
+	m_WaterSimulator = a_Chunk.GetWorld()->GetWaterSimulator();
+}
+
+
+
+
+
+void cEntityPhysicsBatch::SimulateEntity(size_t a_Idx)
+{
+	double Dt = m_Dt[a_Idx];
+	int BlockX = FloorC(m_PosX[a_Idx]);
+	int BlockY = FloorC(m_PosY[a_Idx]);
+	int BlockZ = FloorC(m_PosZ[a_Idx]);
+
+	if ((BlockY >= cChunkDef::Height) || (BlockY < 0))
+	{
+		// Outside of the world
+		m_SpeedY[a_Idx] += m_Gravity[a_Idx] * Dt;
+		m_PosX[a_Idx] += m_SpeedX[a_Idx] * Dt;
+		m_PosY[a_Idx] += m_SpeedY[a_Idx] * Dt;
+		m_PosZ[a_Idx] += m_SpeedZ[a_Idx] * Dt;
+		return;
+	}
+
+	BLOCKTYPE BlockIn, BlockBelow;
+	if (!GetBlock(BlockX, BlockY, BlockZ, BlockIn) || !GetBlock(BlockX, BlockY - 1, BlockZ, BlockBelow))
+	{
+		m_Result[a_Idx] = resFallback;
+		return;
+	}
+
+	if (!cBlockInfo::IsSolid(BlockIn))  // Making sure we are not inside a solid block
+	{
+		if (m_IsOnGround[a_Idx] && !cBlockInfo::IsSolid(BlockBelow))
+		{
+			m_IsOnGround[a_Idx] = 0;
+		}
+	}
+	else
+	{
+		// Push out the entity to the first non-solid neighbor, or up if there's none:
+		static const int CrossCoords[][2] =
+		{
+			{ 1,  0},
+			{-1,  0},
+			{ 0,  1},
+			{ 0, -1},
+		} ;
+		bool IsNoAirSurrounding = true;
+		for (size_t i = 0; i < ARRAYCOUNT(CrossCoords); i++)
+		{
+			BLOCKTYPE Neighbor;
+			if (!GetBlock(BlockX + CrossCoords[i][0], BlockY, BlockZ + CrossCoords[i][1], Neighbor))
+			{
+				// Too close to an unloaded chunk, bail out of any physics handling
+				m_Result[a_Idx] = resKeep;
+				return;
+			}
+			if (!cBlockInfo::IsSolid(Neighbor))
+			{
+				m_PosX[a_Idx] += CrossCoords[i][0];
+				m_PosZ[a_Idx] += CrossCoords[i][1];
+				IsNoAirSurrounding = false;
+				break;
+			}
+		}  // for i - CrossCoords[]
+		if (IsNoAirSurrounding)
+		{
+			m_PosY[a_Idx] += 0.5;
+		}
+		m_IsOnGround[a_Idx] = 1;
+	}
+
+	Vector3d Speed(m_SpeedX[a_Idx], m_SpeedY[a_Idx], m_SpeedZ[a_Idx]);
+	if (!m_IsOnGround[a_Idx])
+	{
+		double FallSpeed;
+		if (IsBlockWater(BlockIn))
+		{
+			FallSpeed = m_Gravity[a_Idx] * Dt / 3;  // Fall 3x slower in water
+			cEntity::ApplyFriction(Speed, 0.7, static_cast<float>(Dt));
+		}
+		else if (BlockIn == E_BLOCK_COBWEB)
+		{
+			Speed.y *= 0.05;  // Reduce overall falling speed
+			FallSpeed = 0;  // No falling
+		}
+		else
+		{
+			// Normal gravity
+			FallSpeed = m_Gravity[a_Idx] * Dt;
+			Speed -= Speed * (m_AirDrag[a_Idx] * 20.0f) * Dt;
+		}
+		Speed.y += static_cast<float>(FallSpeed);
+	}
+	else
+	{
+		cEntity::ApplyFriction(Speed, 0.7, static_cast<float>(Dt));
+	}
+
+	if (BlockIn == E_BLOCK_COBWEB)
+	{
+		Speed.x *= 0.25;
+		Speed.z *= 0.25;
+	}
+
+	// Flowing water pushes the entity; only water blocks have a flowing direction, so don't ask the simulator for any other:
+	m_WaterSpeedX[a_Idx] *= 0.9f;
+	m_WaterSpeedZ[a_Idx] *= 0.9f;
+	if (IsBlockWater(BlockIn))
+	{
+		switch (m_WaterSimulator->GetFlowingDirection(BlockX, BlockY, BlockZ))
+		{
+			case X_PLUS:  m_WaterSpeedX[a_Idx] =  0.2f; m_IsOnGround[a_Idx] = 0; break;
+			case X_MINUS: m_WaterSpeedX[a_Idx] = -0.2f; m_IsOnGround[a_Idx] = 0; break;
+			case Z_PLUS:  m_WaterSpeedZ[a_Idx] =  0.2f; m_IsOnGround[a_Idx] = 0; break;
+			case Z_MINUS: m_WaterSpeedZ[a_Idx] = -0.2f; m_IsOnGround[a_Idx] = 0; break;
+			default: break;
+		}
+	}
+	if (fabs(m_WaterSpeedX[a_Idx]) < 0.05)
+	{
+		m_WaterSpeedX[a_Idx] = 0;
+	}
+	if (fabs(m_WaterSpeedZ[a_Idx]) < 0.05)
+	{
+		m_WaterSpeedZ[a_Idx] = 0;
+	}
+	Speed.x += m_WaterSpeedX[a_Idx];
+	Speed.z += m_WaterSpeedZ[a_Idx];
+
+	m_SpeedX[a_Idx] = Speed.x;
+	m_SpeedY[a_Idx] = Speed.y;
+	m_SpeedZ[a_Idx] = Speed.z;
+	if (Speed.SqrLength() > 0)
+	{
+		MoveWithCollisions(a_Idx);
+	}
+}
+
+
+
+
+
+void cEntityPhysicsBatch::MoveWithCollisions(size_t a_Idx)
+{
+	double Dt = m_Dt[a_Idx];
+	double Pos[3]   = { m_PosX[a_Idx],   m_PosY[a_Idx],   m_PosZ[a_Idx] };
+	double Speed[3] = { m_SpeedX[a_Idx], m_SpeedY[a_Idx], m_SpeedZ[a_Idx] };
+
+	// Split the movement into steps short enough not to skip over any block:
+	double MaxDelta = std::max(std::max(fabs(Speed[0]), fabs(Speed[1])), fabs(Speed[2])) * Dt;
+	int NumSteps = Clamp(CeilC(MaxDelta / MAX_STEP_LENGTH), 1, static_cast<int>(MAX_STEPS));
+	double Delta[3] = { Speed[0] * Dt / NumSteps, Speed[1] * Dt / NumSteps, Speed[2] * Dt / NumSteps };
+
+	// The vertical axis goes first, so that a falling entity lands before sliding on:
+	static const int AxisOrder[] = { 1, 0, 2 };
+	for (int Step = 0; Step < NumSteps; Step++)
+	{
+		for (size_t a = 0; a < ARRAYCOUNT(AxisOrder); a++)
+		{
+			int Axis = AxisOrder[a];
+			if (Delta[Axis] == 0)
+			{
+				continue;
+			}
+			double Next[3] = { Pos[0], Pos[1], Pos[2] };
+			Next[Axis] += Delta[Axis];
+			BLOCKTYPE BlockType;
+			if (GetBlock(FloorC(Next[0]), FloorC(Next[1]), FloorC(Next[2]), BlockType) && !cBlockInfo::IsSolid(BlockType))
+			{
+				Pos[Axis] = Next[Axis];
+				continue;
+			}
+
+			// Hit a block face, stop just in front of it and kill the speed towards it, same as the traced physics does:
+			double Face = floor(Next[Axis]) + ((Delta[Axis] < 0) ? 1 : 0);
+			double Offset = (Axis == 1) ? 0.05 : 0.1;
+			Pos[Axis] = Face + ((Delta[Axis] < 0) ? Offset : -Offset);
+			if ((Axis == 1) && (Delta[Axis] < 0))
+			{
+				m_IsOnGround[a_Idx] = 1;
+			}
+			Speed[Axis] = 0;
+			Delta[Axis] = 0;
+		}  // for a - AxisOrder[]
+	}  // for Step
+
+	m_PosX[a_Idx] = Pos[0];
+	m_PosY[a_Idx] = Pos[1];
+	m_PosZ[a_Idx] = Pos[2];
+	m_SpeedX[a_Idx] = Speed[0];
+	m_SpeedY[a_Idx] = Speed[1];
+	m_SpeedZ[a_Idx] = Speed[2];
+}
+
+
+
+
+
+void cEntityPhysicsBatch::Scatter(cChunk & a_Chunk)
+{
+	for (size_t i = 0, count = m_Entities.size(); i < count; i++)
+	{
+		cEntity * Entity = m_Entities[i];
+		switch (m_Result[i])
+		{
+			case resMoved:
+			{
+				Entity->SetPosition(m_PosX[i], m_PosY[i], m_PosZ[i]);
+				Entity->SetSpeed(m_SpeedX[i], m_SpeedY[i], m_SpeedZ[i]);
+				Entity->m_WaterSpeed.x = m_WaterSpeedX[i];
+				Entity->m_WaterSpeed.z = m_WaterSpeedZ[i];
+				Entity->m_bOnGround = (m_IsOnGround[i] != 0);
+				break;
+			}
+			case resFallback:
+			{
+				Entity->HandlePhysics(m_TickDts[i], a_Chunk);
+				break;
+			}
+			case resKeep:
+			{
+				break;
+			}
+		}
+	}  // for i - m_Entities[]
+}
+
+
+
+
+
+bool cEntityPhysicsBatch::GetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE & a_BlockType) const
+{
+	if ((a_BlockY < 0) || (a_BlockY >= cChunkDef::Height))
+	{
+		a_BlockType = E_BLOCK_AIR;
+		return true;
+	}
+	int ChunkX, ChunkZ;
+	cChunkDef::BlockToChunk(a_BlockX, a_BlockZ, ChunkX, ChunkZ);
+	int IdxX = ChunkX - m_ChunkX + 1;
+	int IdxZ = ChunkZ - m_ChunkZ + 1;
+	if ((IdxX < 0) || (IdxX > 2) || (IdxZ < 0) || (IdxZ > 2) || (m_Chunks[IdxX][IdxZ] == nullptr))
+	{
+		return false;
+	}
+	a_BlockType = m_Chunks[IdxX][IdxZ]->GetBlock(a_BlockX - ChunkX * cChunkDef::Width, a_BlockY, a_BlockZ - ChunkZ * cChunkDef::Width);
+	return true;
+}
+
+
+
+
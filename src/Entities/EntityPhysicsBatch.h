@@ -0,0 +1,108 @@
+
+// EntityPhysicsBatch.h
+
+// Declares the cEntityPhysicsBatch class that moves all the simple physics entities of a chunk in a single pass
+
+
+
+
+
+#pragma once
+
+
+
+
+
+// fwd:
+class cChunk;
+class cEntity;
+class cFluidSimulator;
+
+
+
+
+
+/** Moves the item drops and XP orbs of a chunk in one pass, before the chunk ticks its entities.
+Those entities only fall, slide and bounce off blocks, yet cEntity::HandlePhysics() walks the neighbor chunks
+for each block lookup and traces the movement through the world, one entity at a time. The batch copies the position
+and speed of all such entities into flat arrays, resolves gravity, drag and the block collisions against the cached 3x3
+chunk neighborhood, and writes the results back. The entities then skip their own physics in their Tick().
+Entities that can't be resolved from the neighborhood fall back to cEntity::HandlePhysics().
+A single instance is owned by cChunkMap and reused by all its chunks; only used from the world's tick thread. */
+class cEntityPhysicsBatch
+{
+public:
+
+	cEntityPhysicsBatch(void);
+
+	/** Returns true if the entity's physics is handled by the batch instead of its own Tick() */
+	static bool IsBatched(const cEntity & a_Entity);
+
+	/** Moves the batched entities out of a_Entities, which are stored in a_Chunk.
+	a_TickDts holds the time by which each entity is ticked in this tick, entities with zero time are not moved. */
+	void Simulate(cChunk & a_Chunk, const std::vector<cEntity *> & a_Entities, const std::vector<std::chrono::milliseconds> & a_TickDts);
+
+protected:
+
+	/** Maximum length of a single collision-checked movement step, in blocks */
+	static const double MAX_STEP_LENGTH;
+
+	/** Maximum number of movement steps per entity per tick; faster entities may pass through thin obstacles */
+	static const int MAX_STEPS = 16;
+
+
+	// The state of the batched entities, one item per entity in each array:
+	std::vector<cEntity *> m_Entities;
+	std::vector<std::chrono::milliseconds> m_TickDts;
+	std::vector<double> m_Dt;  // m_TickDts in seconds
+	std::vector<double> m_PosX, m_PosY, m_PosZ;
+	std::vector<double> m_SpeedX, m_SpeedY, m_SpeedZ;
+	std::vector<double> m_WaterSpeedX, m_WaterSpeedZ;
+	std::vector<float> m_Gravity, m_AirDrag;
+	std::vector<char> m_IsOnGround;
+
+	/** What happens to each entity when the results are written back, one of the eResult values */
+	std::vector<char> m_Result;
+
+	/** The chunks around the simulated chunk, indexed by [RelChunkX + 1][RelChunkZ + 1]. nullptr for chunks that are not valid. */
+	cChunk * m_Chunks[3][3];
+
+	/** Coords of the simulated chunk */
+	int m_ChunkX, m_ChunkZ;
+
+	/** The water simulator of the world, used for the flowing water push */
+	cFluidSimulator * m_WaterSimulator;
+
+
+	enum eResult
+	{
+		resMoved,     // The new state is written back to the entity
+		resKeep,      // The entity is left as it is, it is too close to an unloaded chunk
+		resFallback,  // The entity is outside the neighborhood, its own HandlePhysics() is called
+	} ;
+
+
+	/** Empties the arrays and fills them with the batched entities out of a_Entities that are ticked in this tick */
+	void Gather(const std::vector<cEntity *> & a_Entities, const std::vector<std::chrono::milliseconds> & a_TickDts);
+
+	/** Caches the valid chunks around a_Chunk */
+	void LoadNeighborhood(cChunk & a_Chunk);
+
+	/** Simulates the entity at the specified index in the arrays */
+	void SimulateEntity(size_t a_Idx);
+
+	/** Moves the entity at the specified index by its speed, stopping it at the faces of the solid blocks in its way.
+	Blocks outside the neighborhood stop the entity as if they were solid. */
+	void MoveWithCollisions(size_t a_Idx);
+
+	/** Writes the results back to the entities */
+	void Scatter(cChunk & a_Chunk);
+
+	/** Returns the block type at the specified absolute coords from the cached neighborhood.
+	Coords above and below the world are air. Returns false if the block is outside the neighborhood or its chunk isn't valid. */
+	bool GetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE & a_BlockType) const;
+} ;
+
+
+
+
@@ -0,0 +1,109 @@
+
+// EntityPool.h
+
+// Declares the cEntityPool class template that recycles the memory of the frequently created and destroyed entities
+
+
+
+
+
+#pragma once
+
+
+
+
+
+/** Keeps the memory blocks of the destroyed instances of T and hands them out to the new instances.
+Item drops, XP orbs, arrows and falling blocks are created and destroyed by the thousands in farms and explosions;
+reusing their memory keeps them off the system allocator. Use the ENTITY_POOL_ALLOCATION macro in the class to enable.
+Descendant classes of a different size fall through to the global allocator. */
+template <class T>
+class cEntityPool
+{
+public:
+
+	~cEntityPool()
+	{
+		for (std::vector<void *>::iterator itr = m_FreeBlocks.begin(), end = m_FreeBlocks.end(); itr != end; ++itr)
+		{
+			::operator delete(*itr);
+		}
+	}
+
+
+	/** Returns a memory block for a new object of the specified size, reusing a freed block if possible */
+	static void * Allocate(size_t a_Size)
+	{
+		if (a_Size == sizeof(T))
+		{
+			cCSLock Lock(s_Pool.m_CS);
+			if (!s_Pool.m_FreeBlocks.empty())
+			{
+				void * res = s_Pool.m_FreeBlocks.back();
+				s_Pool.m_FreeBlocks.pop_back();
+				return res;
+			}
+		}
+		return ::operator new(a_Size);
+	}
+
+
+	/** Returns the memory block of a destroyed object of the specified size to the pool */
+	static void Free(void * a_Ptr, size_t a_Size)
+	{
+		if (a_Ptr == nullptr)
+		{
+			return;
+		}
+		if (a_Size == sizeof(T))
+		{
+			cCSLock Lock(s_Pool.m_CS);
+			if (s_Pool.m_FreeBlocks.size() < MAX_FREE_BLOCKS)
+			{
+				s_Pool.m_FreeBlocks.push_back(a_Ptr);
+				return;
+			}
+		}
+		::operator delete(a_Ptr);
+	}
+
+protected:
+
+	/** Maximum number of free blocks kept in the pool; the blocks freed above this are returned to the system */
+	static const size_t MAX_FREE_BLOCKS = 4096;
+
+	/** The single pool for T */
+	static cEntityPool s_Pool;
+
+	/** Protects m_FreeBlocks, entities are created and destroyed in the world tick threads and the storage thread */
+	cCriticalSection m_CS;
+
+	/** Memory blocks of the destroyed objects, available for reuse */
+	std::vector<void *> m_FreeBlocks;
+} ;
+
+template <class T> cEntityPool<T> cEntityPool<T>::s_Pool;
+
+
+
+
+
+#ifdef DEBUG_NEW
+	// MSVC debug builds map "new" to DEBUG_NEW for leak tracking, keep the global allocator there:
+	#define ENTITY_POOL_ALLOCATION(classname)
+#else
+	// Place this macro in the public section of a cEntity descendant class to allocate its instances from a cEntityPool
+	#define ENTITY_POOL_ALLOCATION(classname) \
+		static void * operator new(size_t a_Size) \
+		{ \
+			return cEntityPool<classname>::Allocate(a_Size); \
+		} \
+		static void operator delete(void * a_Ptr, size_t a_Size) \
+		{ \
+			cEntityPool<classname>::Free(a_Ptr, a_Size); \
+		}
+#endif
+
+
+
+
@@ -67,7 +67,7 @@ void cExpOrb::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 		SetSpeedZ( a_Distance.z);
 		BroadcastMovementUpdate();
 	}
-	HandlePhysics(a_Dt, a_Chunk);
+	// The physics has already been handled by the chunk, in cEntityPhysicsBatch
 	
 	m_Timer += a_Dt;
 	if (m_Timer >= std::chrono::minutes(5))
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Entity.h"
+#include "EntityPool.h"
 
 
 
@@ -17,6 +18,7 @@ public:
 	// tolua_end
 
 	CLASS_PROTODEF(cExpOrb)
+	ENTITY_POOL_ALLOCATION(cExpOrb)
 
 	cExpOrb(double a_X, double a_Y, double a_Z, int a_Reward);
 	cExpOrb(const Vector3d & a_Pos, int a_Reward);
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Entity.h"
+#include "EntityPool.h"
 
 
 
@@ -21,6 +22,7 @@ class cFallingBlock :
 	
 public:
 	CLASS_PROTODEF(cFallingBlock)
+	ENTITY_POOL_ALLOCATION(cFallingBlock)
 
 	/// Creates a new falling block. a_BlockPosition is expected in world coords
 	cFallingBlock(const Vector3i & a_BlockPosition, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta);
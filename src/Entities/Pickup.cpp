@@ -17,73 +17,6 @@
 
 
 
-class cPickupCombiningCallback :
-	public cEntityCallback
-{
-public:
-	cPickupCombiningCallback(Vector3d a_Position, cPickup * a_Pickup) :
-		m_FoundMatchingPickup(false),
-		m_Position(a_Position),
-		m_Pickup(a_Pickup)
-	{
-	}
-
-	virtual bool Item(cEntity * a_Entity) override
-	{
-		if (!a_Entity->IsPickup() || (a_Entity->GetUniqueID() <= m_Pickup->GetUniqueID()) || a_Entity->IsDestroyed())
-		{
-			return false;
-		}
-
-		Vector3d EntityPos = a_Entity->GetPosition();
-		double Distance = (EntityPos - m_Position).Length();
-
-		cItem & Item = ((cPickup *)a_Entity)->GetItem();
-		if ((Distance < 1.2) && Item.IsEqual(m_Pickup->GetItem()))
-		{
-			short CombineCount = Item.m_ItemCount;
-			if ((CombineCount + m_Pickup->GetItem().m_ItemCount) > Item.GetMaxStackSize())
-			{
-				CombineCount = Item.GetMaxStackSize() - m_Pickup->GetItem().m_ItemCount;
-			}
-
-			if (CombineCount <= 0)
-			{
-				return false;
-			}
-
-			m_Pickup->GetItem().AddCount((char)CombineCount);
-			Item.m_ItemCount -= CombineCount;
-
-			if (Item.m_ItemCount <= 0)
-			{
-				a_Entity->Destroy();
-			}
-			else
-			{
-				a_Entity->GetWorld()->BroadcastEntityMetadata(*a_Entity);
-			}
-			m_FoundMatchingPickup = true;
-		}
-		return false;
-	}
-
-	inline bool FoundMatchingPickup()
-	{
-		return m_FoundMatchingPickup;
-	}
-
-protected:
-	bool m_FoundMatchingPickup;
-
-	Vector3d m_Position;
-	cPickup * m_Pickup;
-};
-
-
-
-
-
 cPickup::cPickup(double a_PosX, double a_PosY, double a_PosZ, const cItem & a_Item, bool IsPlayerCreated, float a_SpeedX /* = 0.f */, float a_SpeedY /* = 0.f */, float a_SpeedZ /* = 0.f */)
 	: cEntity(etPickup, a_PosX, a_PosY, a_PosZ, 0.2, 0.2)
 	, m_Timer(0)
@@ -151,19 +84,18 @@ void cPickup::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 				}
 			}
 
-			// Try to combine the pickup with adjacent same-item pickups:
-			if (!IsDestroyed() && (m_Item.m_ItemCount < m_Item.GetMaxStackSize()))  // Don't combine if already full
+			// Wake up the sleeping hopper that may suck this pickup in, either below it, or the one that the pickup has fallen into;
+			// a hopper without room for the item stays asleep:
+			if (BlockBelow == E_BLOCK_HOPPER)
 			{
-				// By using a_Chunk's ForEachEntity() instead of cWorld's, pickups don't combine across chunk boundaries.
-				// That is a small price to pay for not having to traverse the entire world for each entity.
-				// The speedup in the tick thread is quite considerable.
-				cPickupCombiningCallback PickupCombiningCallback(GetPosition(), this);
-				a_Chunk.ForEachEntity(PickupCombiningCallback);
-				if (PickupCombiningCallback.FoundMatchingPickup())
-				{
-					m_World->BroadcastEntityMetadata(*this);
-				}
+				m_World->GetHopperScheduler().WakeUpHopper(BlockX, BlockY - 1, BlockZ, m_Item);
+			}
+			else if (BlockIn == E_BLOCK_HOPPER)
+			{
+				m_World->GetHopperScheduler().WakeUpHopper(BlockX, BlockY, BlockZ, m_Item);
 			}
+
+			// Combining with the adjacent same-item pickups is done by the chunk, see cEntityMerger
 		}
 	}
 	else
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Entity.h"
+#include "EntityPool.h"
 #include "../Item.h"
 
 
@@ -24,6 +25,7 @@ public:
 	// tolua_end
 
 	CLASS_PROTODEF(cPickup)
+	ENTITY_POOL_ALLOCATION(cPickup)
 
 	cPickup(double a_PosX, double a_PosY, double a_PosZ, const cItem & a_Item, bool IsPlayerCreated, float a_SpeedX = 0.f, float a_SpeedY = 0.f, float a_SpeedZ = 0.f);
 
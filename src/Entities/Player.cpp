@@ -237,7 +237,11 @@ void cPlayer::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 		// Apply food exhaustion from movement:
 		ApplyFoodExhaustionFromMovement();
 		
-		if (cRoot::Get()->GetPluginManager()->CallHookPlayerMoving(*this, m_LastPos, GetPosition()))
+		cPluginManager * PluginManager = cRoot::Get()->GetPluginManager();
+		if (
+			PluginManager->HasHookSubscribers(cPluginManager::HOOK_PLAYER_MOVING) &&
+			PluginManager->CallHookPlayerMoving(*this, m_LastPos, GetPosition())
+		)
 		{
 			CanMove = false;
 			TeleportToCoords(m_LastPos.x, m_LastPos.y, m_LastPos.z);
@@ -1616,6 +1620,7 @@ bool cPlayer::DoMoveToWorld(cWorld * a_World, bool a_ShouldSendRespawn)
 	GetWorld()->BroadcastDestroyEntity(*this);
 
 	// Remove player from the old world
+	RemoveFromChunkEntityCell();
 	SetWorldTravellingFrom(GetWorld());  // cChunk handles entity removal
 	GetWorld()->RemovePlayer(this, false);
 
@@ -0,0 +1,248 @@
+
+// EntityActivation.cpp
+
+// Implements the cEntityActivation class that throttles the ticking of the entities far from all players
+
+#include "Globals.h"
+#include "EntityActivation.h"
+#include "IniFile.h"
+#include "PlayerProximityGrid.h"
+#include "CommandOutput.h"
+#include "Mobs/Creeper.h"
+
+
+
+
+
+/** The longest time step for the physics; two ticks */
+static const std::chrono::milliseconds MAX_PHYSICS_DT(100);
+
+
+
+
+
+/** Names of the categories, as used in the ini file and in the stats */
+static const char * g_CategoryNames[cEntityActivation::acMax] =
+{
+	"Monster",
+	"Animal",
+	"Item",
+	"Minecart",
+	"Projectile",
+};
+
+
+
+
+
+cEntityActivation::cEntityActivation(void) :
+	m_IsEnabled(true),
+	m_WorldTick(0)
+{
+	m_Ranges[acMonster]    = 32;
+	m_Ranges[acAnimal]     = 24;
+	m_Ranges[acItem]       = 16;
+	m_Ranges[acMinecart]   = 16;
+	m_Ranges[acProjectile] = 24;
+	m_InactiveIntervals[acMonster]    = 10;
+	m_InactiveIntervals[acAnimal]     = 10;
+	m_InactiveIntervals[acItem]       = 20;
+	m_InactiveIntervals[acMinecart]   = 20;
+	m_InactiveIntervals[acProjectile] = 10;
+	for (int i = 0; i < acMax; i++)
+	{
+		m_NumActive[i] = 0;
+		m_NumInactive[i] = 0;
+		m_LastNumActive[i] = 0;
+		m_LastNumInactive[i] = 0;
+	}
+}
+
+
+
+
+
+void cEntityActivation::Load(cIniFile & a_IniFile)
+{
+	m_IsEnabled = a_IniFile.GetValueSetB("EntityActivation", "Enabled", m_IsEnabled);
+	for (int i = 0; i < acMax; i++)
+	{
+		AString Name(g_CategoryNames[i]);
+		m_Ranges[i]            = a_IniFile.GetValueSetI("EntityActivation", Name + "Range",            m_Ranges[i]);
+		m_InactiveIntervals[i] = a_IniFile.GetValueSetI("EntityActivation", Name + "InactiveInterval", m_InactiveIntervals[i]);
+		m_Ranges[i] = std::max(m_Ranges[i], 0);
+		m_InactiveIntervals[i] = std::max(m_InactiveIntervals[i], 1);
+	}
+}
+
+
+
+
+
+void cEntityActivation::BeginTick(Int64 a_WorldTick)
+{
+	m_WorldTick = a_WorldTick;
+	{
+		cCSLock Lock(m_CS);
+		for (int i = 0; i < acMax; i++)
+		{
+			m_LastNumActive[i] = m_NumActive[i];
+			m_LastNumInactive[i] = m_NumInactive[i];
+		}
+	}
+	for (int i = 0; i < acMax; i++)
+	{
+		m_NumActive[i] = 0;
+		m_NumInactive[i] = 0;
+	}
+}
+
+
+
+
+
+bool cEntityActivation::ShouldTick(cEntity & a_Entity, const cPlayerProximityGrid & a_PlayerGrid, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt)
+{
+	eCategory Category;
+	if (!GetCategory(a_Entity, Category))
+	{
+		CatchUp(a_Entity, a_Dt, a_TickDt);
+		return true;
+	}
+	bool IsActive = (a_PlayerGrid.GetNearestPlayerDistanceSq(a_Entity.GetPosition(), m_Ranges[Category]) >= 0);
+	return Decide(a_Entity, Category, IsActive, a_Dt, a_TickDt);
+}
+
+
+
+
+
+bool cEntityActivation::ShouldTickMob(cEntity & a_Monster, double a_NearestPlayerDistanceSq, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt)
+{
+	eCategory Category;
+	if (!GetCategory(a_Monster, Category))
+	{
+		CatchUp(a_Monster, a_Dt, a_TickDt);
+		return true;
+	}
+	double Range = static_cast<double>(m_Ranges[Category]);
+	bool IsActive = ((a_NearestPlayerDistanceSq >= 0) && (a_NearestPlayerDistanceSq <= Range * Range));
+	return Decide(a_Monster, Category, IsActive, a_Dt, a_TickDt);
+}
+
+
+
+
+
+void cEntityActivation::Report(cCommandOutputCallback & a_Output) const
+{
+	cCSLock Lock(m_CS);
+	a_Output.Out("  category     range  interval   active  inactive");
+	for (int i = 0; i < acMax; i++)
+	{
+		a_Output.Out("  %-10s %7d %9d %8d %9d",
+			g_CategoryNames[i], m_Ranges[i], m_InactiveIntervals[i], m_LastNumActive[i], m_LastNumInactive[i]
+		);
+	}
+	if (!m_IsEnabled)
+	{
+		a_Output.Out("  (activation ranges are disabled, all entities are active)");
+	}
+}
+
+
+
+
+
+std::chrono::milliseconds cEntityActivation::ClampPhysicsDt(std::chrono::milliseconds a_TickDt)
+{
+	return std::min(a_TickDt, MAX_PHYSICS_DT);
+}
+
+
+
+
+
+bool cEntityActivation::GetCategory(const cEntity & a_Entity, eCategory & a_Category)
+{
+	if (a_Entity.HasAttachee())
+	{
+		// A vehicle with a rider moves with the rider, keep it in sync
+		return false;
+	}
+	switch (a_Entity.GetEntityType())
+	{
+		case cEntity::etPickup:     a_Category = acItem;       return true;
+		case cEntity::etExpOrb:     a_Category = acItem;       return true;
+		case cEntity::etMinecart:   a_Category = acMinecart;   return true;
+		case cEntity::etProjectile: a_Category = acProjectile; return true;
+		case cEntity::etMonster:
+		{
+			bool IsHostile = (static_cast<const cMonster &>(a_Entity).GetMobFamily() == cMonster::mfHostile);
+			a_Category = IsHostile ? acMonster : acAnimal;
+			return true;
+		}
+		default: return false;
+	}
+}
+
+
+
+
+
+bool cEntityActivation::Decide(cEntity & a_Entity, eCategory a_Category, bool a_IsActive, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt)
+{
+	if (!m_IsEnabled || a_IsActive || NeedsEveryTick(a_Entity))
+	{
+		// Also catch up on the time skipped while the entity was inactive:
+		m_NumActive[a_Category] += 1;
+		CatchUp(a_Entity, a_Dt, a_TickDt);
+		return true;
+	}
+
+	m_NumInactive[a_Category] += 1;
+
+	// Spread the ticks of the inactive entities over the interval, based on their IDs, so that the entities
+	// that have become inactive at the same time (explosion drops) don't all tick in the same tick:
+	if (((m_WorldTick + a_Entity.GetUniqueID()) % m_InactiveIntervals[a_Category]) != 0)
+	{
+		a_Entity.SetInactiveTime(a_Entity.GetInactiveTime() + a_Dt);
+		a_Entity.SetInactiveTicks(a_Entity.GetInactiveTicks() + 1);
+		return false;
+	}
+	CatchUp(a_Entity, a_Dt, a_TickDt);
+	return true;
+}
+
+
+
+
+
+bool cEntityActivation::NeedsEveryTick(const cEntity & a_Entity)
+{
+	if (a_Entity.IsOnFire())
+	{
+		return true;
+	}
+	if (a_Entity.IsMob() && (static_cast<const cMonster &>(a_Entity).GetMobType() == mtCreeper))
+	{
+		return static_cast<const cCreeper &>(a_Entity).IsBlowing();
+	}
+	return false;
+}
+
+
+
+
+
+void cEntityActivation::CatchUp(cEntity & a_Entity, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt)
+{
+	a_TickDt = a_Entity.GetInactiveTime() + a_Dt;
+	a_Entity.SetInactiveTime(std::chrono::milliseconds(0));
+	a_Entity.SetCatchUpTicks(a_Entity.GetInactiveTicks());
+	a_Entity.SetInactiveTicks(0);
+}
+
+
+
+
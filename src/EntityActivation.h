@@ -0,0 +1,120 @@
+
+// EntityActivation.h
+
+// Declares the cEntityActivation class that throttles the ticking of the entities far from all players
+
+
+
+
+
+#pragma once
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+class cEntity;
+class cIniFile;
+class cPlayerProximityGrid;
+
+
+
+
+
+/** Decides, for each entity in each tick, whether the entity is ticked. Each entity category has its own activation
+range; entities within the range of any player are active and ticked every tick, the rest are inactive and only ticked
+once per the category's interval. When an inactive entity is ticked, it receives the whole time elapsed since its last
+tick, so that its time-based timers (despawning, pickup aging) catch up, and the number of the skipped ticks
+(cEntity::GetCatchUpTicks()), by which its tick counters (age, invulnerability, the mobs' cooldowns) advance.
+The physics only receives up to ClampPhysicsDt() of the time, the far entities may move less than they would.
+Burning entities and the creepers about to explode are always active, so that they take their damage and explode in time.
+Players, vehicles with a rider and the entities outside of the categories are always active as well.
+Counts the active and inactive entities of each category in each tick, for the "entitystats" console command. */
+class cEntityActivation
+{
+public:
+
+	/** The entity categories that have separately configurable activation ranges */
+	enum eCategory
+	{
+		acMonster = 0,
+		acAnimal,
+		acItem,
+		acMinecart,
+		acProjectile,
+
+		acMax,  // Number of categories, keep this last
+	} ;
+
+
+	cEntityActivation(void);
+
+	/** Reads the settings from the [EntityActivation] section of the world's ini file, writing the defaults if not present. */
+	void Load(cIniFile & a_IniFile);
+
+	/** Starts a new tick; publishes the counts of the previous tick for the stats. Called by the world at the tick start. */
+	void BeginTick(Int64 a_WorldTick);
+
+	/** Returns the activation range, in blocks, for the specified category */
+	int GetRange(eCategory a_Category) const { return m_Ranges[a_Category]; }
+
+	/** Decides whether the entity, which is not a mob, is ticked in this tick, using the players' positions in a_PlayerGrid.
+	Returns the time to tick the entity by in a_TickDt; returns false if the entity is to be skipped. */
+	bool ShouldTick(cEntity & a_Entity, const cPlayerProximityGrid & a_PlayerGrid, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt);
+
+	/** Decides whether the mob, whose nearest player is at the specified squared distance, is ticked in this tick.
+	Returns the time to tick the mob by in a_TickDt; returns false if the mob is to be skipped. */
+	bool ShouldTickMob(cEntity & a_Monster, double a_NearestPlayerDistanceSq, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt);
+
+	/** Outputs the active and inactive counts of the last tick. */
+	void Report(cCommandOutputCallback & a_Output) const;
+
+	/** Returns the time by which the physics of an entity ticked by a_TickDt is simulated.
+	The time caught up after being inactive is too long for a single physics step, so it is clamped. */
+	static std::chrono::milliseconds ClampPhysicsDt(std::chrono::milliseconds a_TickDt);
+
+protected:
+
+	/** If false, all the entities are always active */
+	bool m_IsEnabled;
+
+	/** Activation range, in blocks, for each category */
+	int m_Ranges[acMax];
+
+	/** Number of ticks between two ticks of an inactive entity, for each category */
+	int m_InactiveIntervals[acMax];
+
+	/** The world age, in ticks, of the current tick; staggers the inactive entities' ticks */
+	Int64 m_WorldTick;
+
+	/** Number of active / inactive entities in each category, counted in the current tick. Only used in the tick thread. */
+	int m_NumActive[acMax];
+	int m_NumInactive[acMax];
+
+	/** Protects m_LastNumActive and m_LastNumInactive */
+	mutable cCriticalSection m_CS;
+
+	/** The counts of the last finished tick, read by the stats */
+	int m_LastNumActive[acMax];
+	int m_LastNumInactive[acMax];
+
+
+	/** Returns true and the entity's category in a_Category if the entity is subject to the activation ranges;
+	returns false for the entities that are always active. */
+	static bool GetCategory(const cEntity & a_Entity, eCategory & a_Category);
+
+	/** Returns true if the entity needs to be ticked every tick even when out of range (burning, a creeper with its fuse lit) */
+	static bool NeedsEveryTick(const cEntity & a_Entity);
+
+	/** Gives the entity the time and the ticks skipped so far to catch up on in this tick, returns the time in a_TickDt. */
+	static void CatchUp(cEntity & a_Entity, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt);
+
+	/** Accounts the decision and accumulates the skipped time into the entity. Returns the time to tick the entity by in a_TickDt. */
+	bool Decide(cEntity & a_Entity, eCategory a_Category, bool a_IsActive, std::chrono::milliseconds a_Dt, std::chrono::milliseconds & a_TickDt);
+} ;
+
+
+
+
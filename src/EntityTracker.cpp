@@ -0,0 +1,294 @@
+// EntityTracker.cpp
+
+// Implements the cEntityTracker class that decides which clients receive an entity's movement updates and how often
+
+#include "Globals.h"
+#include "EntityTracker.h"
+#include "ClientHandle.h"
+#include "IniFile.h"
+#include "Entities/Player.h"
+#include "Mobs/Monster.h"
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cEntityTracker::sMovement:
+
+cEntityTracker::sMovement::sMovement(void) :
+	m_Velocity(false),
+	m_Teleport(false),
+	m_RelMove(false),
+	m_RelMoveLook(false),
+	m_HeadLook(false),
+	m_Look(false),
+	m_RelX(0),
+	m_RelY(0),
+	m_RelZ(0)
+{
+}
+
+
+
+
+
+bool cEntityTracker::sMovement::IsEmpty(void) const
+{
+	return !(m_Velocity || m_Teleport || m_RelMove || m_RelMoveLook || m_HeadLook || m_Look);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cEntityTracker::cClientEntities:
+
+void cEntityTracker::cClientEntities::Remove(UInt32 a_EntityID)
+{
+	cCSLock Lock(m_CS);
+	m_Entries.erase(a_EntityID);
+	m_OutOfRange.erase(a_EntityID);
+}
+
+
+
+
+
+void cEntityTracker::cClientEntities::Clear(void)
+{
+	cCSLock Lock(m_CS);
+	m_Entries.clear();
+	m_OutOfRange.clear();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cEntityTracker:
+
+cEntityTracker::cEntityTracker(void) :
+	m_IsEnabled(true),
+	m_NearTierPercent(50),
+	m_MidTierInterval(4),
+	m_FarTierInterval(10)
+{
+	m_Ranges[tcPlayer]     = cClientHandle::MAX_VIEW_DISTANCE * cChunkDef::Width;
+	m_Ranges[tcMonster]    = 80;
+	m_Ranges[tcAnimal]     = 80;
+	m_Ranges[tcItem]       = 64;
+	m_Ranges[tcProjectile] = 64;
+	m_Ranges[tcOther]      = 80;
+}
+
+
+
+
+
+void cEntityTracker::Load(cIniFile & a_IniFile)
+{
+	m_IsEnabled            = a_IniFile.GetValueSetB("EntityTracker", "Enabled",         m_IsEnabled);
+	m_Ranges[tcPlayer]     = a_IniFile.GetValueSetI("EntityTracker", "PlayerRange",     m_Ranges[tcPlayer]);
+	m_Ranges[tcMonster]    = a_IniFile.GetValueSetI("EntityTracker", "MonsterRange",    m_Ranges[tcMonster]);
+	m_Ranges[tcAnimal]     = a_IniFile.GetValueSetI("EntityTracker", "AnimalRange",     m_Ranges[tcAnimal]);
+	m_Ranges[tcItem]       = a_IniFile.GetValueSetI("EntityTracker", "ItemRange",       m_Ranges[tcItem]);
+	m_Ranges[tcProjectile] = a_IniFile.GetValueSetI("EntityTracker", "ProjectileRange", m_Ranges[tcProjectile]);
+	m_Ranges[tcOther]      = a_IniFile.GetValueSetI("EntityTracker", "OtherRange",      m_Ranges[tcOther]);
+	m_NearTierPercent      = a_IniFile.GetValueSetI("EntityTracker", "NearTierPercent", m_NearTierPercent);
+	m_MidTierInterval      = a_IniFile.GetValueSetI("EntityTracker", "MidTierInterval", m_MidTierInterval);
+	m_FarTierInterval      = a_IniFile.GetValueSetI("EntityTracker", "FarTierInterval", m_FarTierInterval);
+
+	for (size_t i = 0; i < ARRAYCOUNT(m_Ranges); i++)
+	{
+		if (m_Ranges[i] < cChunkDef::Width)
+		{
+			m_Ranges[i] = cChunkDef::Width;
+		}
+	}
+	m_NearTierPercent = Clamp(m_NearTierPercent, 0, 100);
+	m_MidTierInterval = std::max(m_MidTierInterval, 1);
+	m_FarTierInterval = std::max(m_FarTierInterval, m_MidTierInterval);
+}
+
+
+
+
+
+cEntityTracker::eCategory cEntityTracker::GetCategory(const cEntity & a_Entity)
+{
+	switch (a_Entity.GetEntityType())
+	{
+		case cEntity::etPlayer:     return tcPlayer;
+		case cEntity::etPickup:     return tcItem;
+		case cEntity::etExpOrb:     return tcItem;
+		case cEntity::etProjectile: return tcProjectile;
+		case cEntity::etMonster:
+		{
+			if (static_cast<const cMonster &>(a_Entity).GetMobFamily() == cMonster::mfHostile)
+			{
+				return tcMonster;
+			}
+			return tcAnimal;
+		}
+		default: return tcOther;
+	}
+}
+
+
+
+
+
+bool cEntityTracker::SendMovement(cClientHandle & a_Client, cEntity & a_Entity, const sMovement & a_Movement, Int64 a_WorldAge)
+{
+	const cPlayer * Player = a_Client.GetPlayer();
+	if (!m_IsEnabled || (Player == nullptr))
+	{
+		SendRelative(a_Client, a_Entity, a_Movement);
+		return false;
+	}
+
+	// Only the horizontal distance matters, the same way as for chunk loading:
+	double DiffX = Player->GetPosX() - a_Entity.GetPosX();
+	double DiffZ = Player->GetPosZ() - a_Entity.GetPosZ();
+	int Interval = GetUpdateInterval(DiffX * DiffX + DiffZ * DiffZ, m_Ranges[GetCategory(a_Entity)]);
+
+	cClientEntities & Tracked = a_Client.GetTrackedEntities();
+	cCSLock Lock(Tracked.m_CS);
+	cClientEntities::cEntries & Entries = Tracked.m_Entries;
+	cClientEntities::cEntries::iterator itr = Entries.find(a_Entity.GetUniqueID());
+	bool IsOutOfRange = (Tracked.m_OutOfRange.find(a_Entity.GetUniqueID()) != Tracked.m_OutOfRange.end());
+
+	if (Interval < 0)
+	{
+		// The entity is out of range. If it has just left, destroy it on the client, so that it doesn't stay frozen there;
+		// keep checking it, so that it gets spawned again when the player comes closer, even if it doesn't move anymore:
+		if (!IsOutOfRange)
+		{
+			a_Client.SendDestroyEntity(a_Entity);  // Removes the entity from Entries
+			Tracked.m_OutOfRange.insert(a_Entity.GetUniqueID());
+		}
+		return true;
+	}
+
+	if (itr == Entries.end())
+	{
+		// The entity has just entered the range; spawn it if it was destroyed for being out of range, then resync:
+		if (IsOutOfRange)
+		{
+			Tracked.m_OutOfRange.erase(a_Entity.GetUniqueID());
+			a_Entity.SpawnOn(a_Client);
+		}
+		SendAbsolute(a_Client, a_Entity);
+		cClientEntities::sEntry & Entry = Entries[a_Entity.GetUniqueID()];
+		Entry.m_LastUpdate = a_WorldAge;
+		Entry.m_IsInSync = true;
+		return false;
+	}
+
+	cClientEntities::sEntry & Entry = itr->second;
+	if (a_WorldAge - Entry.m_LastUpdate < Interval)
+	{
+		// Not yet time to update this client, skip the packets:
+		if (!a_Movement.IsEmpty())
+		{
+			Entry.m_IsInSync = false;
+		}
+		return !Entry.m_IsInSync;
+	}
+
+	if (Entry.m_IsInSync)
+	{
+		if (a_Movement.IsEmpty())
+		{
+			// Nothing to send, don't restart the interval
+			return false;
+		}
+		SendRelative(a_Client, a_Entity, a_Movement);
+	}
+	else
+	{
+		// Some relative updates have been skipped, the client needs the absolute state:
+		SendAbsolute(a_Client, a_Entity);
+		Entry.m_IsInSync = true;
+	}
+	Entry.m_LastUpdate = a_WorldAge;
+	return false;
+}
+
+
+
+
+
+int cEntityTracker::GetUpdateInterval(double a_DistanceSq, int a_Range) const
+{
+	double Range = static_cast<double>(a_Range);
+	if (a_DistanceSq > Range * Range)
+	{
+		return -1;
+	}
+
+	// The near tier receives all updates:
+	double NearRange = Range * m_NearTierPercent / 100;
+	if (a_DistanceSq <= NearRange * NearRange)
+	{
+		return 0;
+	}
+
+	// The rest of the range is split in half between the mid and the far tier:
+	double MidRange = (NearRange + Range) / 2;
+	if (a_DistanceSq <= MidRange * MidRange)
+	{
+		return m_MidTierInterval;
+	}
+	return m_FarTierInterval;
+}
+
+
+
+
+
+void cEntityTracker::SendRelative(cClientHandle & a_Client, const cEntity & a_Entity, const sMovement & a_Movement)
+{
+	if (a_Movement.m_Velocity)
+	{
+		a_Client.SendEntityVelocity(a_Entity);
+	}
+	if (a_Movement.m_Teleport)
+	{
+		a_Client.SendTeleportEntity(a_Entity);
+	}
+	if (a_Movement.m_RelMove)
+	{
+		a_Client.SendEntityRelMove(a_Entity, a_Movement.m_RelX, a_Movement.m_RelY, a_Movement.m_RelZ);
+	}
+	if (a_Movement.m_RelMoveLook)
+	{
+		a_Client.SendEntityRelMoveLook(a_Entity, a_Movement.m_RelX, a_Movement.m_RelY, a_Movement.m_RelZ);
+	}
+	if (a_Movement.m_HeadLook)
+	{
+		a_Client.SendEntityHeadLook(a_Entity);
+	}
+	if (a_Movement.m_Look)
+	{
+		a_Client.SendEntityLook(a_Entity);
+	}
+}
+
+
+
+
+
+void cEntityTracker::SendAbsolute(cClientHandle & a_Client, const cEntity & a_Entity)
+{
+	a_Client.SendEntityVelocity(a_Entity);
+	a_Client.SendTeleportEntity(a_Entity);
+	a_Client.SendEntityHeadLook(a_Entity);
+}
+
+
+
+
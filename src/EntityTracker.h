@@ -0,0 +1,160 @@
+// EntityTracker.h
+
+// Declares the cEntityTracker class that decides which clients receive an entity's movement updates and how often
+
+
+
+
+
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+
+
+
+
+
+// fwd:
+class cClientHandle;
+class cEntity;
+class cIniFile;
+
+
+
+
+
+/** Culls and throttles entity movement updates based on the distance between the entity and each client's player.
+Each entity category has its own tracking range; an entity that moves out of a client's range is destroyed on that client
+and spawned again once it is back in range. Clients within the range are divided into tiers: the near tier receives every update, the mid and far
+tiers receive updates less often. Whenever a client has missed an update, its view of the entity is considered
+out of sync and the next update it receives is an absolute one (teleport + velocity + head look), so that the
+relative moves that the near clients receive never accumulate errors on the far clients.
+The per-client tracking state is stored in each cClientHandle (cClientEntities). */
+class cEntityTracker
+{
+public:
+
+	/** The entity categories that have separately configurable tracking ranges */
+	enum eCategory
+	{
+		tcPlayer = 0,
+		tcMonster,
+		tcAnimal,
+		tcItem,
+		tcProjectile,
+		tcOther,
+
+		tcMax,  // Number of categories, keep this last
+	} ;
+
+
+	/** Describes the packets of a single movement update, as computed by cEntity::BroadcastMovementUpdate().
+	The packets are sent in the order of the members. */
+	struct sMovement
+	{
+		bool m_Velocity;
+		bool m_Teleport;
+		bool m_RelMove;
+		bool m_RelMoveLook;
+		bool m_HeadLook;
+		bool m_Look;
+		char m_RelX;
+		char m_RelY;
+		char m_RelZ;
+
+		sMovement(void);
+
+		/** Returns true if the update doesn't contain any packet */
+		bool IsEmpty(void) const;
+	} ;
+
+
+	/** The per-client tracking state, owned by cClientHandle.
+	Remembers, for each entity that the client is tracking, when it was last updated and whether its view is in sync;
+	and the entities that have been destroyed on the client for being out of range. */
+	class cClientEntities
+	{
+		friend class cEntityTracker;
+
+	public:
+		/** Forgets the entity, so that it is treated as entering the range on its next update.
+		Called when the entity is destroyed on the client, either for good or for being out of range. */
+		void Remove(UInt32 a_EntityID);
+
+		/** Forgets all the tracked entities. Called when the client leaves a world. */
+		void Clear(void);
+
+	protected:
+		struct sEntry
+		{
+			/** World age of the last update sent to the client */
+			Int64 m_LastUpdate;
+
+			/** True if the client has received all the updates since the last absolute one */
+			bool m_IsInSync;
+		} ;
+
+		typedef std::unordered_map<UInt32, sEntry> cEntries;
+		typedef std::unordered_set<UInt32> cEntityIDs;
+
+		cCriticalSection m_CS;
+
+		/** The entities that the client is tracking, keyed by their UniqueID. Protected by m_CS. */
+		cEntries m_Entries;
+
+		/** The UniqueIDs of the entities that have been destroyed on the client because they left the tracking range,
+		and need spawning once they are back in range. Not in m_Entries. Protected by m_CS. */
+		cEntityIDs m_OutOfRange;
+	} ;
+
+
+	cEntityTracker(void);
+
+	/** Reads the settings from the [EntityTracker] section of the world's ini file, writing the defaults if not present. */
+	void Load(cIniFile & a_IniFile);
+
+	/** Returns the tracking category of the specified entity */
+	static eCategory GetCategory(const cEntity & a_Entity);
+
+	/** Returns the tracking range, in blocks, for the specified category */
+	int GetRange(eCategory a_Category) const { return m_Ranges[a_Category]; }
+
+	/** Sends the specified movement update of a_Entity to a_Client, honoring the tracking range and the update tiers.
+	Destroys the entity on the client when it leaves the range, and spawns it again when it gets back.
+	Returns true if the client's view of the entity needs a later update, even if the entity doesn't move:
+	either it has been left out of sync, or it is out of range and needs spawning once the player comes closer. */
+	bool SendMovement(cClientHandle & a_Client, cEntity & a_Entity, const sMovement & a_Movement, Int64 a_WorldAge);
+
+protected:
+
+	/** If false, all the updates are sent to all clients, as if there was no tracker */
+	bool m_IsEnabled;
+
+	/** Tracking range, in blocks, for each category */
+	int m_Ranges[tcMax];
+
+	/** Percentage of the tracking range, within which the clients receive every update */
+	int m_NearTierPercent;
+
+	/** Minimum number of ticks between two updates for clients in the mid tier */
+	int m_MidTierInterval;
+
+	/** Minimum number of ticks between two updates for clients in the far tier */
+	int m_FarTierInterval;
+
+
+	/** Returns the minimum number of ticks between two updates, for a client at the specified squared distance.
+	Returns -1 if the client is outside the tracking range. */
+	int GetUpdateInterval(double a_DistanceSq, int a_Range) const;
+
+	/** Sends the packets of the movement update to the client */
+	static void SendRelative(cClientHandle & a_Client, const cEntity & a_Entity, const sMovement & a_Movement);
+
+	/** Sends the current absolute position, velocity and head look of the entity to the client */
+	static void SendAbsolute(cClientHandle & a_Client, const cEntity & a_Entity);
+} ;
+
+
+
+
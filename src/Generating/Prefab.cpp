@@ -189,6 +189,12 @@ void cPrefab::AddRotatedBlockAreas(void)
 		m_BlockArea[3].CopyFrom(m_BlockArea[0]);
 		m_BlockArea[3].RotateCW();
 	}
+	
+	// The images are kept for the whole lifetime of the generator, store them compact; drawing reads the packed metas directly:
+	for (size_t i = 0; i < ARRAYCOUNT(m_BlockArea); i++)
+	{
+		m_BlockArea[i].PackNibbles();
+	}
 }
 
 
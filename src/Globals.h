@@ -257,6 +257,7 @@ template class SizeChecker<UInt8,  1>;
 #include <queue>
 #include <limits>
 #include <chrono>
+#include <functional>
 
 
 
@@ -316,6 +317,20 @@ void inline LOG(const char * a_Format, ...)
 	va_end(argList);
 }
 
+void inline LOGINFO(const char * a_Format, ...) FORMATSTRING(1, 2);
+
+void inline LOGINFO(const char * a_Format, ...)
+{
+	va_list argList;
+	va_start(argList, a_Format);
+	vprintf(a_Format, argList);
+	putchar('\n');
+	va_end(argList);
+}
+
+	// The synchronization primitives, used by most of the server classes' members:
+	#include "OSSupport/CriticalSection.h"
+	#include "OSSupport/Event.h"
 #endif
 
 
@@ -376,7 +391,11 @@ void inline LOG(const char * a_Format, ...)
 #endif
 
 // Pretty much the same as ASSERT() but stays in Release builds
-#define VERIFY( x) ( !!(x) || ( LOGERROR("Verification failed: %s, file %s, line %i", #x, __FILE__, __LINE__), PrintStackTrace(), exit(1), 0))
+#ifdef TEST_GLOBALS
+	#define VERIFY( x) ( !!(x) || ( LOGERROR("Verification failed: %s, file %s, line %i", #x, __FILE__, __LINE__), exit(1), 0))
+#else
+	#define VERIFY( x) ( !!(x) || ( LOGERROR("Verification failed: %s, file %s, line %i", #x, __FILE__, __LINE__), PrintStackTrace(), exit(1), 0))
+#endif
 
 // Same as assert but in all Self test builds
 #ifdef SELF_TEST
@@ -10,6 +10,91 @@
 
 
 
+/** How long the idle writer thread waits for new lines before checking again, in msec */
+static const unsigned WRITER_IDLE_TIMEOUT_MSEC = 100;
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLogger::cWriterThread:
+
+/** The thread that writes out the queued lines to the listeners. */
+class cLogger::cWriterThread :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+
+	cWriterThread(cLogger & a_Logger) :
+		super("LogWriter"),
+		m_Logger(a_Logger)
+	{
+	}
+
+
+	/** Signals the thread to terminate, wakes it up if it is idle and waits for it to finish. */
+	void Terminate(void)
+	{
+		m_ShouldTerminate = true;
+		m_Logger.m_evtQueued.Set();
+		Wait();
+	}
+
+protected:
+
+	cLogger & m_Logger;
+
+
+	virtual void Execute(void) override
+	{
+		while (!m_ShouldTerminate)
+		{
+			if (m_Logger.WriteQueuedLines() == 0)
+			{
+				m_Logger.WaitForQueuedLines();
+			}
+		}
+	}
+} ;
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLogger:
+
+cLogger::cLogger(void) :
+	m_Queue(new sQueuedLine[QUEUE_SIZE]),
+	m_PushPos(0),
+	m_PopPos(0),
+	m_QueuedBytes(0),
+	m_NumDroppedLines(0),
+	m_IsWriterRunning(false),
+	m_IsWriterIdle(false)
+{
+	for (size_t i = 0; i < QUEUE_SIZE; i++)
+	{
+		m_Queue[i].m_Sequence = i;
+	}
+}
+
+
+
+
+
+cLogger::~cLogger()
+{
+	StopWriterThread();
+}
+
+
+
+
+
 cLogger & cLogger::GetInstance(void)
 {
 	static cLogger Instance;
@@ -22,39 +107,64 @@ cLogger & cLogger::GetInstance(void)
 
 void cLogger::InitiateMultithreading()
 {
-	GetInstance();
+	cLogger & Logger = GetInstance();
+	if (Logger.m_WriterThread != nullptr)
+	{
+		return;
+	}
+	Logger.m_WriterThread.reset(new cWriterThread(Logger));
+	if (!Logger.m_WriterThread->Start())
+	{
+		// Keep logging synchronously
+		Logger.m_WriterThread.reset();
+		return;
+	}
+	Logger.m_IsWriterRunning = true;
 }
 
 
 
 
 
-void cLogger::LogSimple(AString a_Message, eLogLevel a_LogLevel)
+void cLogger::TerminateMultithreading()
 {
-	time_t rawtime;
-	time(&rawtime);
+	GetInstance().StopWriterThread();
+}
 
-	struct tm * timeinfo;
-	#ifdef _MSC_VER
-		struct tm timeinforeal;
-		timeinfo = &timeinforeal;
-		localtime_s(timeinfo, &rawtime);
-	#else
-		timeinfo = localtime(&rawtime);
-	#endif
 
-	AString Line;
-	#ifdef _DEBUG
-		Printf(Line, "[%04llx|%02d:%02d:%02d] %s\n", static_cast<UInt64>(std::hash<std::thread::id>()(std::this_thread::get_id())), timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, a_Message.c_str());
-	#else
-		Printf(Line, "[%02d:%02d:%02d] %s\n", timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, a_Message.c_str());
-	#endif
 
 
-	cCSLock Lock(m_CriticalSection);
-	for (size_t i = 0; i < m_LogListeners.size(); i++)
+
+void cLogger::LogSimple(AString a_Message, eLogLevel a_LogLevel)
+{
+	if (!PushLine(std::move(a_Message), a_LogLevel))
+	{
+		if (a_LogLevel != llError)
+		{
+			// The queue is full, drop the line; the writer thread will report the number of the dropped lines:
+			m_NumDroppedLines += 1;
+			return;
+		}
+
+		// Don't drop the errors, make room for them instead. a_Message is still intact, PushLine() only moves from it on success:
+		Flush();
+		if (!PushLine(std::move(a_Message), a_LogLevel))
+		{
+			m_NumDroppedLines += 1;
+			return;
+		}
+	}
+
+	if (!m_IsWriterRunning || (a_LogLevel == llError))
+	{
+		Flush();
+		return;
+	}
+
+	// Wake up the writer thread if it is waiting for lines:
+	if (m_IsWriterIdle.exchange(false))
 	{
-		m_LogListeners[i]->Log(Line, a_LogLevel);
+		m_evtQueued.Set();
 	}
 }
 
@@ -66,7 +176,7 @@ void cLogger::Log(const char * a_Format, eLogLevel a_LogLevel, va_list a_ArgList
 {
 	AString Message;
 	AppendVPrintf(Message, a_Format, a_ArgList);
-	LogSimple(Message, a_LogLevel);
+	LogSimple(std::move(Message), a_LogLevel);
 }
 
 
@@ -86,6 +196,7 @@ void cLogger::AttachListener(cListener * a_Listener)
 void cLogger::DetachListener(cListener * a_Listener)
 {
 	cCSLock Lock(m_CriticalSection);
+	WriteQueuedLines();
 	m_LogListeners.erase(std::remove(m_LogListeners.begin(), m_LogListeners.end(), a_Listener));
 }
 
@@ -93,6 +204,200 @@ void cLogger::DetachListener(cListener * a_Listener)
 
 
 
+void cLogger::Flush(void)
+{
+	WriteQueuedLines();
+}
+
+
+
+
+
+void cLogger::StopWriterThread(void)
+{
+	if (m_WriterThread != nullptr)
+	{
+		// Any lines logged from now on are written synchronously, including those logged while waiting for the thread:
+		m_IsWriterRunning = false;
+		m_WriterThread->Terminate();
+		m_WriterThread.reset();
+	}
+	Flush();
+}
+
+
+
+
+
+bool cLogger::PushLine(AString && a_Message, eLogLevel a_LogLevel)
+{
+	// Reserve the bytes first, so that the memory held by the queue stays bounded even with many producers:
+	size_t Size = a_Message.size();
+	if (m_QueuedBytes.fetch_add(Size) + Size > MAX_QUEUED_BYTES)
+	{
+		m_QueuedBytes -= Size;
+		return false;
+	}
+
+	// Claim a free slot; a slot is free for position Pos when its sequence equals Pos:
+	size_t Pos = m_PushPos.load(std::memory_order_relaxed);
+	sQueuedLine * Line;
+	for (;;)
+	{
+		Line = &m_Queue[Pos & (QUEUE_SIZE - 1)];
+		size_t Sequence = Line->m_Sequence.load(std::memory_order_acquire);
+		if (Sequence == Pos)
+		{
+			// Sequentially consistent, pairs with the writer's idle check in WaitForQueuedLines():
+			if (m_PushPos.compare_exchange_weak(Pos, Pos + 1))
+			{
+				break;
+			}
+			// Another thread claimed the slot, Pos has been updated by compare_exchange_weak(), retry
+		}
+		else if (static_cast<ptrdiff_t>(Sequence - Pos) < 0)
+		{
+			// The slot still holds a line from the previous round, the queue is full:
+			m_QueuedBytes -= Size;
+			return false;
+		}
+		else
+		{
+			// Another thread has already pushed into this slot, retry with the current position:
+			Pos = m_PushPos.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Fill the slot and publish it to the consumer:
+	Line->m_Message = std::move(a_Message);
+	Line->m_LogLevel = a_LogLevel;
+	Line->m_Time = time(nullptr);
+	#ifdef _DEBUG
+		Line->m_ThreadID = static_cast<UInt64>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	#endif
+	Line->m_Sequence.store(Pos + 1);
+	return true;
+}
+
+
+
+
+
+bool cLogger::PopLine(sQueuedLine & a_Line)
+{
+	size_t Pos = m_PopPos.load(std::memory_order_relaxed);
+	sQueuedLine & Line = m_Queue[Pos & (QUEUE_SIZE - 1)];
+	if (Line.m_Sequence.load(std::memory_order_acquire) != Pos + 1)
+	{
+		// Empty, or the producer hasn't finished filling the slot yet
+		return false;
+	}
+
+	m_QueuedBytes -= Line.m_Message.size();
+	a_Line.m_Message = std::move(Line.m_Message);
+	Line.m_Message.clear();
+	a_Line.m_LogLevel = Line.m_LogLevel;
+	a_Line.m_Time = Line.m_Time;
+	#ifdef _DEBUG
+		a_Line.m_ThreadID = Line.m_ThreadID;
+	#endif
+
+	// Release the slot for the next round:
+	Line.m_Sequence.store(Pos + QUEUE_SIZE, std::memory_order_release);
+	m_PopPos.store(Pos + 1);
+	return true;
+}
+
+
+
+
+
+bool cLogger::IsQueueEmpty(void) const
+{
+	// A line that is still being filled in by its producer counts as queued already:
+	return (m_PushPos.load() == m_PopPos.load());
+}
+
+
+
+
+
+size_t cLogger::WriteQueuedLines(void)
+{
+	cCSLock Lock(m_CriticalSection);
+	size_t NumLines = 0;
+	sQueuedLine Line;
+	AString Text;
+	// Limit the batch to a single round of the queue, so that the listeners get flushed regularly even under a heavy load:
+	while ((NumLines < QUEUE_SIZE) && PopLine(Line))
+	{
+		struct tm * timeinfo;
+		#ifdef _MSC_VER
+			struct tm timeinforeal;
+			timeinfo = &timeinforeal;
+			localtime_s(timeinfo, &Line.m_Time);
+		#else
+			timeinfo = localtime(&Line.m_Time);
+		#endif
+
+		#ifdef _DEBUG
+			Printf(Text, "[%04llx|%02d:%02d:%02d] %s\n", Line.m_ThreadID, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, Line.m_Message.c_str());
+		#else
+			Printf(Text, "[%02d:%02d:%02d] %s\n", timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, Line.m_Message.c_str());
+		#endif
+
+		for (size_t i = 0; i < m_LogListeners.size(); i++)
+		{
+			m_LogListeners[i]->Log(Text, Line.m_LogLevel);
+		}
+		NumLines += 1;
+	}
+
+	// Report the lines dropped since the last time:
+	size_t NumDropped = m_NumDroppedLines.exchange(0);
+	if (NumDropped > 0)
+	{
+		Printf(Text, "Logging too fast, %u log lines have been dropped\n", static_cast<unsigned>(NumDropped));
+		for (size_t i = 0; i < m_LogListeners.size(); i++)
+		{
+			m_LogListeners[i]->Log(Text, llWarning);
+		}
+		NumLines += 1;
+	}
+
+	if (NumLines > 0)
+	{
+		for (size_t i = 0; i < m_LogListeners.size(); i++)
+		{
+			m_LogListeners[i]->Flush();
+		}
+	}
+	return NumLines;
+}
+
+
+
+
+
+void cLogger::WaitForQueuedLines(void)
+{
+	m_IsWriterIdle = true;
+
+	// Re-check after announcing the idle state; a line pushed before that wouldn't wake us up:
+	if (!IsQueueEmpty())
+	{
+		m_IsWriterIdle = false;
+		return;
+	}
+
+	m_evtQueued.Wait(WRITER_IDLE_TIMEOUT_MSEC);
+	m_IsWriterIdle = false;
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Global functions
 
@@ -1,6 +1,11 @@
 
 #pragma once
 
+#include <atomic>
+
+
+
+
 
 class cLogger
 {
@@ -20,25 +25,113 @@ public:
 		public:
 		virtual void Log(AString a_Message, eLogLevel a_LogLevel) = 0;
 
+		/** Called after each batch of lines has been passed to Log(), so that the listener may write out any lines it has buffered. */
+		virtual void Flush(void) {}
+
 		virtual ~cListener(){}
 	};
 
+	~cLogger();
+
 	void Log  (const char * a_Format, eLogLevel a_LogLevel, va_list a_ArgList) FORMATSTRING(2, 0);
 
-	/** Logs the simple text message at the specified log level. */
+	/** Logs the simple text message at the specified log level.
+	Once the writer thread is running, the message is only queued and the listeners are called from the writer thread,
+	except for the errors, which are written out before returning, so that they aren't lost if the server crashes right after. */
 	void LogSimple(AString a_Message, eLogLevel a_LogLevel = llRegular);
 
 	void AttachListener(cListener * a_Listener);
+
+	/** Removes the listener; any lines queued so far are written out to it first. */
 	void DetachListener(cListener * a_Listener);
-	
+
+	/** Writes out all the queued lines to the listeners in the calling thread. */
+	void Flush(void);
+
 	static cLogger & GetInstance(void);
+
 	// Must be called before calling GetInstance in a multithreaded context
+	/** Also starts the writer thread, from then on the logging calls only queue the lines. */
 	static void InitiateMultithreading();
+
+	/** Stops the writer thread and writes out all the queued lines; any further logging is written synchronously again. */
+	static void TerminateMultithreading();
+
 private:
 
+	class cWriterThread;
+
+	/** A single queued log line */
+	struct sQueuedLine
+	{
+		/** The position in the queue that the slot is ready for, see PushLine() and PopLine() */
+		std::atomic<size_t> m_Sequence;
+
+		AString m_Message;
+		eLogLevel m_LogLevel;
+		time_t m_Time;
+		#ifdef _DEBUG
+			UInt64 m_ThreadID;
+		#endif
+	} ;
+
+	/** Number of the slots in the queue, must be a power of 2 */
+	static const size_t QUEUE_SIZE = 4096;
+
+	/** Maximum number of message bytes held in the queue; lines that would go above this are dropped */
+	static const size_t MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+
+	/** Protects m_LogListeners and the consumer side of the queue */
 	cCriticalSection m_CriticalSection;
 	std::vector<cListener *> m_LogListeners;
 
+	/** The queued lines; a bounded lock-free queue that any thread may push into, and only the holder of m_CriticalSection pops from */
+	std::unique_ptr<sQueuedLine[]> m_Queue;
+
+	/** The queue position where the next line will be pushed */
+	std::atomic<size_t> m_PushPos;
+
+	/** The queue position where the next line will be popped. Only written while holding m_CriticalSection. */
+	std::atomic<size_t> m_PopPos;
+
+	/** Number of the message bytes currently held in the queue */
+	std::atomic<size_t> m_QueuedBytes;
+
+	/** Number of the lines dropped because the queue was full, since last reported */
+	std::atomic<size_t> m_NumDroppedLines;
+
+	/** The thread writing out the queued lines; nullptr when not running */
+	std::unique_ptr<cWriterThread> m_WriterThread;
+
+	/** Set when m_WriterThread is running and the lines may be left in the queue for it */
+	std::atomic<bool> m_IsWriterRunning;
+
+	/** Set while the writer thread is waiting for new lines; the producers then wake it up via m_evtQueued */
+	std::atomic<bool> m_IsWriterIdle;
+
+	/** Set when a new line has been queued for an idle writer thread */
+	cEvent m_evtQueued;
+
+
+	cLogger(void);
+
+	/** Stops the writer thread, if running, and writes out the queued lines. */
+	void StopWriterThread(void);
+
+	/** Pushes the line into the queue. Returns false if the queue is full. Lock-free, may be called from any thread. */
+	bool PushLine(AString && a_Message, eLogLevel a_LogLevel);
+
+	/** Pops the oldest line from the queue into a_Line. Returns false if the queue is empty. Assumes m_CriticalSection is held. */
+	bool PopLine(sQueuedLine & a_Line);
+
+	/** Returns true if there's no line waiting in the queue */
+	bool IsQueueEmpty(void) const;
+
+	/** Writes out all the queued lines to the listeners and flushes them. Returns the number of lines written. */
+	size_t WriteQueuedLines(void);
+
+	/** Called by the writer thread when there's nothing to write; waits until a line is queued or a timeout passes. */
+	void WaitForQueuedLines(void);
 };
 
 
@@ -55,11 +148,11 @@ extern void LOGERROR(const char* a_Format, ...) FORMATSTRING(1, 2);
 
 
 
-// In debug builds, translate LOGD to LOG, otherwise leave it out altogether:
+// In debug builds, translate LOGD to LOG, otherwise leave it out altogether, including the evaluation of its parameters:
 #ifdef _DEBUG
 	#define LOGD LOG
 #else
-	#define LOGD(...)
+	#define LOGD(...) do { } while (false)
 #endif  // _DEBUG
 
 
@@ -71,3 +164,4 @@ extern void LOGERROR(const char* a_Format, ...) FORMATSTRING(1, 2);
 
 
 
+
@@ -314,7 +314,22 @@ void cFileListener::Log(AString a_Message, cLogger::eLogLevel a_LogLevel)
 			break;
 		}
 	}
-	m_File.Printf("%s%s", LogLevelPrefix, a_Message.c_str());
+	m_Buffer.append(LogLevelPrefix);
+	m_Buffer.append(a_Message);
+}
+
+
+
+
+
+void cFileListener::Flush(void)
+{
+	if (!m_Buffer.empty() && m_File.IsOpen())
+	{
+		m_File.Write(m_Buffer.data(), m_Buffer.size());
+		m_File.Flush();
+	}
+	m_Buffer.clear();
 }
 
 
@@ -15,10 +15,14 @@ public:
 	cFileListener(AString a_Filename);
 
 	virtual void Log(AString a_Message, cLogger::eLogLevel a_LogLevel) override;
+	virtual void Flush(void) override;
 	
 private:
 
 	cFile m_File;
+
+	/** The lines logged since the last Flush(), written into the file all at once */
+	AString m_Buffer;
 };
 
 
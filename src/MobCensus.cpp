@@ -7,6 +7,15 @@
 
 
 
+cMobCensus::cMobCensus(const cPlayerProximityGrid & a_Players) :
+	m_Players(a_Players)
+{
+}
+
+
+
+
+
 void cMobCensus::CollectMob(cMonster & a_Monster, cChunk & a_Chunk, double a_Distance)
 {
 	m_ProximityCounter.CollectMob(a_Monster, a_Chunk, a_Distance);
@@ -17,6 +26,15 @@ void cMobCensus::CollectMob(cMonster & a_Monster, cChunk & a_Chunk, double a_Dis
 
 
 
+double cMobCensus::GetNearestPlayerDistanceSq(const Vector3d & a_Pos) const
+{
+	return m_Players.GetNearestPlayerDistanceSq(a_Pos, MAX_PLAYER_DISTANCE);
+}
+
+
+
+
+
 bool cMobCensus::IsCapped(cMonster::eFamily a_MobFamily)
 {
 	const int ratio = 319;  // This should be 256 as we are only supposed to take account from chunks that are in 17x17 from a player
@@ -3,6 +3,7 @@
 
 #include "MobProximityCounter.h"
 #include "MobFamilyCollecter.h"
+#include "PlayerProximityGrid.h"
 
 
 
@@ -25,6 +26,9 @@ as side effect 2 : it also know the caps for mobs number and can compare census
 class cMobCensus
 {
 public:
+	/** Creates a census that measures the mobs' distances to the players in a_Players */
+	cMobCensus(const cPlayerProximityGrid & a_Players);
+
 	/// Returns the nested proximity counter
 	cMobProximityCounter & GetProximityCounter(void);
 
@@ -35,6 +39,9 @@ public:
 	/// Collect a mob - it's distance to player, it's family ...
 	void CollectMob(cMonster& a_Monster, cChunk& a_Chunk, double a_Distance);
 
+	/** Returns the squared distance from the specified position to the nearest player, or -1 if there's no player near enough to matter */
+	double GetNearestPlayerDistanceSq(const Vector3d & a_Pos) const;
+
 	/// Returns true if the family is capped (i.e. there are more mobs of this family than max)
 	bool IsCapped(cMonster::eFamily a_MobFamily);
 	
@@ -42,6 +49,13 @@ public:
 	void Logd(void);
 	
 protected :
+	/** Maximum distance of a player from a mob, in blocks, for the mob to be collected.
+	Covers the diagonal of the maximum view distance, since only the mobs in the chunks loaded by clients are collected. */
+	static const int MAX_PLAYER_DISTANCE = 768;
+
+	/** The players whose distance to the mobs is measured */
+	const cPlayerProximityGrid & m_Players;
+
 	cMobProximityCounter m_ProximityCounter;
 	cMobFamilyCollecter m_MobFamilyCollecter;
 
@@ -6,78 +6,54 @@
 #include "Entities/Entity.h"
 #include "Chunk.h"
 
-void cMobProximityCounter::CollectMob(cEntity& a_Monster, cChunk& a_Chunk, double a_Distance)
+cMobProximityCounter::cMobProximityCounter(void) :
+	m_IsSorted(true)
 {
-	// LOGD("Collecting monster %s, with distance %f", a_Monster->GetClass(), a_Distance);
-	tMonsterToDistance::iterator it = m_MonsterToDistance.find(&a_Monster);
-	if (it == m_MonsterToDistance.end())
-	{
-		sDistanceAndChunk newDistanceAndChunk(a_Distance, a_Chunk);
-		std::pair<tMonsterToDistance::iterator, bool> result = m_MonsterToDistance.insert(tMonsterToDistance::value_type(&a_Monster, newDistanceAndChunk));
-		if (!result.second)
-		{
-			ASSERT(!"A collected Monster was not found inside distance map using find(), but insert() said there already is a key for it");
-		}
-	}
-	else
-	{
-		if (a_Distance < it->second.m_Distance)
-		{
-			it->second.m_Distance = a_Distance;
-			it->second.m_Chunk = &a_Chunk;
-		}
-	}
-
-	m_EligibleForSpawnChunks.insert(&a_Chunk);
-
 }
 
-void cMobProximityCounter::convertMaps()
+void cMobProximityCounter::CollectMob(cEntity& a_Monster, cChunk& a_Chunk, double a_Distance)
 {
-	for (tMonsterToDistance::const_iterator itr = m_MonsterToDistance.begin(); itr != m_MonsterToDistance.end(); ++itr)
-	{
-		m_DistanceToMonster.insert(tDistanceToMonster::value_type(itr->second.m_Distance, sMonsterAndChunk(*itr->first, *itr->second.m_Chunk)));
-	}
+	// LOGD("Collecting monster %s, with distance %f", a_Monster->GetClass(), a_Distance);
+	m_DistanceToMonster.push_back(tDistanceToMonster::value_type(a_Distance, sMonsterAndChunk(a_Monster, a_Chunk)));
+	m_IsSorted = false;
 }
 
 cMobProximityCounter::sIterablePair cMobProximityCounter::getMobWithinThosesDistances(double a_DistanceMin, double a_DistanceMax)
 {
-	sIterablePair toReturn;
-	toReturn.m_Count = 0;
-	toReturn.m_Begin = m_DistanceToMonster.end();
-	toReturn.m_End = m_DistanceToMonster.end();
-
-	a_DistanceMin *= a_DistanceMin;// this is because is use square distance
-	a_DistanceMax *= a_DistanceMax;
-
-	if (m_DistanceToMonster.empty())
-	{
-		convertMaps();
-	}
-
-	for (tDistanceToMonster::const_iterator itr = m_DistanceToMonster.begin(); itr != m_DistanceToMonster.end(); ++itr)
+	if (!m_IsSorted)
 	{
-		if (toReturn.m_Begin == m_DistanceToMonster.end())
-		{
-			if ((a_DistanceMin == 1) || (itr->first > a_DistanceMin))
+		std::sort(m_DistanceToMonster.begin(), m_DistanceToMonster.end(),
+			[](const tDistanceToMonster::value_type & a_First, const tDistanceToMonster::value_type & a_Second)
 			{
-				toReturn.m_Begin = itr;  // This is the first one with distance > a_DistanceMin;
+				return (a_First.first < a_Second.first);
 			}
-		}
+		);
+		m_IsSorted = true;
+	}
 
-		if (toReturn.m_Begin != m_DistanceToMonster.end())
-		{
-			if ((a_DistanceMax != 1) && (itr->first > a_DistanceMax))
+	// The distances are squared, find the first one > a_DistanceMin and the first one > a_DistanceMax:
+	const tDistanceToMonster & Mobs = m_DistanceToMonster;
+	sIterablePair toReturn;
+	toReturn.m_Begin = Mobs.begin();
+	toReturn.m_End = Mobs.end();
+	if (a_DistanceMin >= 0)
+	{
+		toReturn.m_Begin = std::upper_bound(Mobs.begin(), Mobs.end(), a_DistanceMin * a_DistanceMin,
+			[](double a_Distance, const tDistanceToMonster::value_type & a_Item)
 			{
-				toReturn.m_End = itr;  // This is just after the last one with distance < a_DistanceMax
-				// Note : if we are not going through this, it's ok, toReturn.m_End will be end();
-				break;
+				return (a_Distance < a_Item.first);
 			}
-			else
+		);
+	}
+	if (a_DistanceMax >= 0)
+	{
+		toReturn.m_End = std::upper_bound(toReturn.m_Begin, Mobs.end(), a_DistanceMax * a_DistanceMax,
+			[](double a_Distance, const tDistanceToMonster::value_type & a_Item)
 			{
-				toReturn.m_Count ++;
+				return (a_Distance < a_Item.first);
 			}
-		}
+		);
 	}
+	toReturn.m_Count = static_cast<int>(toReturn.m_End - toReturn.m_Begin);
 	return toReturn;
 }
@@ -1,8 +1,6 @@
 
 #pragma once
 
-#include <set>
-
 class cChunk;
 class cEntity;
 
@@ -13,48 +11,35 @@ class cEntity;
 class cMobProximityCounter
 {
 protected :
-	// structs used for later maps (see m_MonsterToDistance and m_DistanceToMonster)
-	struct sDistanceAndChunk
-	{
-		sDistanceAndChunk(double a_Distance, cChunk& a_Chunk) : m_Distance(a_Distance), m_Chunk(&a_Chunk) {}
-		double m_Distance;
-		cChunk* m_Chunk;
-	};
+	// struct used for the collected list (see m_DistanceToMonster)
 	struct sMonsterAndChunk
 	{
-		sMonsterAndChunk(cEntity& a_Monster, cChunk& a_Chunk) : m_Monster(a_Monster), m_Chunk(a_Chunk) {}
-		cEntity& m_Monster;
-		cChunk& m_Chunk;
+		sMonsterAndChunk(cEntity& a_Monster, cChunk& a_Chunk) : m_Monster(&a_Monster), m_Chunk(&a_Chunk) {}
+		cEntity* m_Monster;
+		cChunk* m_Chunk;
 	};
 
 public :
-	typedef std::map<cEntity*, sDistanceAndChunk> tMonsterToDistance;
-	typedef std::multimap<double, sMonsterAndChunk> tDistanceToMonster;
+	typedef std::vector<std::pair<double, sMonsterAndChunk> > tDistanceToMonster;
 
 protected :
-	// this map is filled during collection phase, it will be later transformed into DistanceToMonster
-	tMonsterToDistance m_MonsterToDistance;
-
-	// this map is generated after collection phase, in order to access monster by distance to player
+	// this list is filled during collection phase, it is sorted by the (squared) distance on the first query
 	tDistanceToMonster m_DistanceToMonster;
 
-	// this are the collected chunks. Used to determinate the number of elligible chunk for spawning.
-	std::set<cChunk*> m_EligibleForSpawnChunks;
-
-protected :
-	// transform monsterToDistance map (that was usefull for collecting) into distanceToMonster
-	// that will be usefull for picking up.
-	void convertMaps();
+	// true if m_DistanceToMonster has been sorted since the last collected mob
+	bool m_IsSorted;
 
 public :
-	// count a mob on a specified chunk with specified distance to an unkown player
-	// if the distance is shortest than the one collected, this become the new closest
-	// distance and the chunk become the "hosting" chunk (that is the one that will perform the action)
+	cMobProximityCounter(void);
+
+	// count a mob on a specified chunk with the specified squared distance to the closest player
+	// each mob is expected to be collected only once, by the chunk that it is in
 	void CollectMob(cEntity& a_Monster, cChunk& a_Chunk, double a_Distance);
 
 	// return the mobs that are within the range of distance of the closest player they are
 	// that means that if a mob is 30 m from a player and 150 m from another one. It will be
 	// in the range [0..50] but not in [100..200]
+	// a negative distance means the range is not bounded on that side
 	struct sIterablePair
 	{
 		tDistanceToMonster::const_iterator m_Begin;
@@ -130,7 +130,7 @@ bool cMonster::TickPathFinding(cChunk & a_Chunk)
 	if (m_TicksSinceLastPathReset < 1000)
 	{
 		// No need to count beyond 1000. 1000 is arbitary here.
-		++m_TicksSinceLastPathReset;
+		m_TicksSinceLastPathReset = std::min(m_TicksSinceLastPathReset + 1 + GetCatchUpTicks(), 1000);
 	}
 
 	if (ReachedFinalDestination())
@@ -215,7 +215,7 @@ void cMonster::MoveToWayPoint(cChunk & a_Chunk)
 	}
 	else
 	{
-		--m_JumpCoolDown;
+		m_JumpCoolDown = std::max(m_JumpCoolDown - 1 - GetCatchUpTicks(), 0);
 	}
 
 	Vector3d Distance = m_NextWayPointPosition - GetPosition();
@@ -303,7 +303,7 @@ void cMonster::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 
 	if (m_TicksSinceLastDamaged < 100)
 	{
-		++m_TicksSinceLastDamaged;
+		m_TicksSinceLastDamaged = std::min(m_TicksSinceLastDamaged + 1 + GetCatchUpTicks(), 100);
 	}
 	if ((m_Target != nullptr) && m_Target->IsDestroyed())
 	{
@@ -3,28 +3,19 @@
 #include <cmath>
 
 #include "Path.h"
+#include "PathFinderService.h"
 #include "../Chunk.h"
+#include "../World.h"
 
 #define DISTANCE_MANHATTAN 0  // 1: More speed, a bit less accuracy 0: Max accuracy, less speed.
 #define HEURISTICS_ONLY 0  // 1: Much more speed, much less accurate.
-#define CALCULATIONS_PER_STEP 60  // Higher means more CPU load but faster path calculations.
 // The only version which guarantees the shortest path is 0, 0.
 
-enum class eCellStatus {OPENLIST,  CLOSEDLIST,  NOLIST};
-struct cPathCell
-{
-	Vector3i m_Location;   // Location of the cell in the world.
-	int m_F, m_G, m_H;  // F, G, H as defined in regular A*.
-	eCellStatus m_Status;  // Which list is the cell in? Either non, open, or closed.
-	cPathCell * m_Parent;  // Cell's parent, as defined in regular A*.
-	bool m_IsSolid;	   // Is the cell an air or a solid? Partial solids are currently considered solids.
-};
-
 
 
 
 
-bool compareHeuristics::operator()(cPathCell * & a_Cell1, cPathCell * & a_Cell2)
+bool compareHeuristics::operator()(const cPathCell * a_Cell1, const cPathCell * a_Cell2) const
 {
 	return a_Cell1->m_F > a_Cell2->m_F;
 }
@@ -40,6 +31,8 @@ cPath::cPath(
 	double a_BoundingBoxWidth, double a_BoundingBoxHeight,
 	int a_MaxUp, int a_MaxDown
 ) :
+	m_Service(&a_Chunk.GetWorld()->GetPathFinderService()),
+	m_Arena(m_Service->AcquireArena()),
 	m_Destination(a_EndingPoint.Floor()),
 	m_Source(a_StartingPoint.Floor()),
 	m_CurrentPoint(0),  // GetNextPoint increments this to 1, but that's fine, since the first cell is always a_StartingPoint
@@ -50,7 +43,8 @@ cPath::cPath(
 
 	if (GetCell(m_Source)->m_IsSolid || GetCell(m_Destination)->m_IsSolid)
 	{
-		m_Status = ePathFinderStatus::PATH_NOT_FOUND;
+		FinishCalculation(ePathFinderStatus::PATH_NOT_FOUND);
+		m_Chunk = nullptr;
 		return;
 	}
 
@@ -80,7 +74,7 @@ cPath::cPath(
 	}
 
 	m_Status = ePathFinderStatus::CALCULATING;
-	m_StepsLeft = a_MaxSteps;
+	m_CalculationsLeft = a_MaxSteps * CALCULATIONS_PER_STEP;
 
 	ProcessCell(GetCell(a_StartingPoint), nullptr, 0);
 	m_Chunk = nullptr;
@@ -111,15 +105,17 @@ ePathFinderStatus cPath::Step(cChunk & a_Chunk)
 		return m_Status;
 	}
 
-	if (m_StepsLeft == 0)
+	if (m_CalculationsLeft <= 0)
 	{
 		FinishCalculation(ePathFinderStatus::PATH_NOT_FOUND);
 	}
 	else
 	{
-		--m_StepsLeft;
+		// Get our share of the world's budget for this tick. When the budget is used up, the search simply waits for the next tick:
+		int NumCalculations = m_Service->RequestSteps(std::min(m_CalculationsLeft, static_cast<int>(CALCULATIONS_PER_STEP)));
+		m_CalculationsLeft -= NumCalculations;
 		int i;
-		for (i = 0; i < CALCULATIONS_PER_STEP; ++i)
+		for (i = 0; i < NumCalculations; ++i)
 		{
 			if (Step_Internal())  // Step_Internal returns true when no more calculation is needed.
 			{
@@ -140,19 +136,34 @@ bool cPath::IsSolid(const Vector3i & a_Location)
 {
 	ASSERT(m_Chunk != nullptr);
 
-	auto Chunk = m_Chunk->GetNeighborChunk(a_Location.x, a_Location.z);
-	if ((Chunk == nullptr) || !Chunk->IsValid())
+	if (a_Location.y < 0)
 	{
 		return true;
 	}
-	m_Chunk = Chunk;
+	if (a_Location.y >= cChunkDef::Height)
+	{
+		return false;
+	}
 
-	BLOCKTYPE BlockType;
-	NIBBLETYPE BlockMeta;
+	// Most of the lookups hit the chunk of the previous lookup, only walk the neighbors when leaving it:
 	int RelX = a_Location.x - m_Chunk->GetPosX() * cChunkDef::Width;
 	int RelZ = a_Location.z - m_Chunk->GetPosZ() * cChunkDef::Width;
+	if ((RelX < 0) || (RelX >= cChunkDef::Width) || (RelZ < 0) || (RelZ >= cChunkDef::Width))
+	{
+		auto Chunk = m_Chunk->GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+		if ((Chunk == nullptr) || !Chunk->IsValid())
+		{
+			return true;
+		}
+		m_Chunk = Chunk;
+	}
+	else if (!m_Chunk->IsValid())
+	{
+		return true;
+	}
 
-	m_Chunk->GetBlockTypeMeta(RelX, a_Location.y, RelZ, BlockType, BlockMeta);
+	// Only the type is needed, the solidity then comes from the cBlockInfo table:
+	BLOCKTYPE BlockType = m_Chunk->GetBlock(RelX, a_Location.y, RelZ);
 	if ((BlockType == E_BLOCK_FENCE) || (BlockType == E_BLOCK_FENCE_GATE))
 	{
 		GetCell(a_Location + Vector3i(0, 1, 0))->m_IsSolid = true;  // Mobs will always think that the fence is 2 blocks high and therefore won't jump over.
@@ -239,13 +250,12 @@ bool cPath::Step_Internal()
 
 void cPath::FinishCalculation()
 {
-	for (auto && pair : m_Map)
+	if (m_Arena != nullptr)
 	{
-		delete pair.second;
+		// The cells are owned by the arena, hand it over to the next search:
+		m_Service->ReleaseArena(m_Arena);
+		m_Arena = nullptr;
 	}
-
-	m_Map.clear();
-	m_OpenList = std::priority_queue<cPathCell *, std::vector<cPathCell *>, compareHeuristics>{};
 }
 
 
@@ -265,7 +275,8 @@ void cPath::FinishCalculation(ePathFinderStatus a_NewStatus)
 void cPath::OpenListAdd(cPathCell * a_Cell)
 {
 	a_Cell->m_Status = eCellStatus::OPENLIST;
-	m_OpenList.push(a_Cell);
+	m_Arena->m_OpenList.push_back(a_Cell);
+	std::push_heap(m_Arena->m_OpenList.begin(), m_Arena->m_OpenList.end(), compareHeuristics());
 	#ifdef COMPILING_PATHFIND_DEBUGGER
 	si::setBlock(a_Cell->m_Location.x, a_Cell->m_Location.y, a_Cell->m_Location.z, debug_open, SetMini(a_Cell));
 	#endif
@@ -277,13 +288,15 @@ void cPath::OpenListAdd(cPathCell * a_Cell)
 
 cPathCell * cPath::OpenListPop()  // Popping from the open list also means adding to the closed list.
 {
-	if (m_OpenList.size() == 0)
+	std::vector<cPathCell *> & OpenList = m_Arena->m_OpenList;
+	if (OpenList.empty())
 	{
 		return nullptr;  // We've exhausted the search space and nothing was found, this will trigger a PATH_NOT_FOUND status.
 	}
 
-	cPathCell * Ret = m_OpenList.top();
-	m_OpenList.pop();
+	std::pop_heap(OpenList.begin(), OpenList.end(), compareHeuristics());
+	cPathCell * Ret = OpenList.back();
+	OpenList.pop_back();
 	Ret->m_Status = eCellStatus::CLOSEDLIST;
 	#ifdef COMPILING_PATHFIND_DEBUGGER
 si::setBlock((Ret)->m_Location.x, (Ret)->m_Location.y, (Ret)->m_Location.z, debug_closed, SetMini(Ret));
@@ -367,12 +380,13 @@ void cPath::ProcessCell(cPathCell * a_Cell, cPathCell * a_Caller, int a_GDelta)
 cPathCell * cPath::GetCell(const Vector3i & a_Location)
 {
 	// Create the cell in the hash table if it's not already there.
-	cPathCell * Cell;
-	if (m_Map.count(a_Location) == 0)  // Case 1: Cell is not on any list. We've never checked this cell before.
+	std::pair<cPathCellArena::cCellMap::iterator, bool> Inserted = m_Arena->m_Map.insert(std::make_pair(a_Location, static_cast<cPathCell *>(nullptr)));
+	if (Inserted.second)  // Case 1: Cell is not on any list. We've never checked this cell before.
 	{
-		Cell = new cPathCell();
+		cPathCell * Cell = m_Arena->NewCell();
+		Inserted.first->second = Cell;
 		Cell->m_Location = a_Location;
-		m_Map[a_Location] = Cell;
+		Cell->m_Parent = nullptr;
 		Cell->m_IsSolid = IsSolid(a_Location);
 		Cell->m_Status = eCellStatus::NOLIST;
 		#ifdef COMPILING_PATHFIND_DEBUGGER
@@ -384,6 +398,6 @@ cPathCell * cPath::GetCell(const Vector3i & a_Location)
 	}
 	else
 	{
-		return m_Map[a_Location];
+		return Inserted.first->second;
 	}
 }
@@ -21,18 +21,26 @@ Put this in your .cpp:
 //fwd: ../Chunk.h
 class cChunk;
 
+//fwd: PathFinderService.h
+class cPathCellArena;
+class cPathFinderService;
+
 /* Various little structs and classes */
 enum class ePathFinderStatus {CALCULATING,  PATH_FOUND,  PATH_NOT_FOUND};
-struct cPathCell;  // Defined inside Path.cpp
+struct cPathCell;  // Defined inside PathFinderService.h
 class compareHeuristics
 {
 public:
-	bool operator()(cPathCell * & a_V1,  cPathCell * &  a_V2);
+	bool operator()(const cPathCell * a_V1,  const cPathCell * a_V2) const;
 };
 
 class cPath
 {
 public:
+	/** The maximum number of cells a single search processes in one Step() call.
+	The world's cPathFinderService may grant fewer when many searches are running. */
+	static const int CALCULATIONS_PER_STEP = 60;
+
 	/** Creates a pathfinder instance. A Mob will probably need a single pathfinder instance for its entire life.
 
 	Note that if you have a man-sized mob (1x1x2, zombies, etc), you are advised to call this function without parameters
@@ -50,7 +58,7 @@ public:
 	Calling this before a path is found resets the current path and starts another search.
 	@param a_StartingPoint The function expects this position to be the lowest block the mob is in, a rule of thumb: "The block where the Zombie's knees are at".
 	@param a_EndingPoint "The block where the Zombie's knees want to be".
-	@param a_MaxSteps The maximum steps before giving up. */
+	@param a_MaxSteps The maximum steps before giving up. Each step processes up to CALCULATIONS_PER_STEP cells. */
 	cPath(
 		cChunk & a_Chunk,
 		const Vector3i & a_StartingPoint, const Vector3i & a_EndingPoint, int a_MaxSteps,
@@ -129,11 +137,11 @@ private:
 	cPathCell * GetCell(const Vector3i & a_location);
 
 	/* Pathfinding fields */
-	std::priority_queue<cPathCell *,  std::vector<cPathCell *>,  compareHeuristics> m_OpenList;
-	std::unordered_map<Vector3i,  cPathCell *, VectorHasher> m_Map;
+	cPathFinderService * m_Service;  // The world's service, shares the arenas and the per-tick budget among the searches.
+	cPathCellArena * m_Arena;  // The cells, map and open list of the current search. nullptr once the calculation has finished.
 	Vector3i m_Destination;
 	Vector3i m_Source;
-	int m_StepsLeft;
+	int m_CalculationsLeft;  // The number of cells that may still be processed before giving up.
 
 	/* Control fields */
 	ePathFinderStatus m_Status;
@@ -0,0 +1,162 @@
+
+// PathFinderService.cpp
+
+// Implements the cPathFinderService class that shares the memory and the CPU time among all the path searches in a world
+
+#include "Globals.h"
+#include "PathFinderService.h"
+#include "../IniFile.h"
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPathCellArena:
+
+cPathCellArena::cPathCellArena(void) :
+	m_NumUsedCells(0)
+{
+}
+
+
+
+
+
+cPathCellArena::~cPathCellArena()
+{
+	for (std::vector<cPathCell *>::iterator itr = m_Blocks.begin(), end = m_Blocks.end(); itr != end; ++itr)
+	{
+		delete[] *itr;
+	}
+}
+
+
+
+
+
+cPathCell * cPathCellArena::NewCell(void)
+{
+	size_t BlockIdx = m_NumUsedCells / CELLS_PER_BLOCK;
+	if (BlockIdx >= m_Blocks.size())
+	{
+		m_Blocks.push_back(new cPathCell[CELLS_PER_BLOCK]);
+	}
+	cPathCell * res = m_Blocks[BlockIdx] + (m_NumUsedCells % CELLS_PER_BLOCK);
+	m_NumUsedCells += 1;
+	return res;
+}
+
+
+
+
+
+void cPathCellArena::Clear(void)
+{
+	// clear() keeps the bucket array of the map and the capacity of the vector:
+	m_Map.clear();
+	m_OpenList.clear();
+	m_NumUsedCells = 0;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPathFinderService:
+
+cPathFinderService::cPathFinderService(void) :
+	m_StepsPerTick(2000),
+	m_StepsLeft(2000),
+	m_StepsPerSearch(cPath::CALCULATIONS_PER_STEP),
+	m_NumSearches(0)
+{
+}
+
+
+
+
+
+cPathFinderService::~cPathFinderService()
+{
+	for (std::vector<cPathCellArena *>::iterator itr = m_FreeArenas.begin(), end = m_FreeArenas.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+}
+
+
+
+
+
+void cPathFinderService::Load(cIniFile & a_IniFile)
+{
+	m_StepsPerTick = a_IniFile.GetValueSetI("Pathfinder", "StepsPerTick", m_StepsPerTick);
+	m_StepsPerTick = std::max(m_StepsPerTick, 1);
+	m_StepsLeft = m_StepsPerTick;
+}
+
+
+
+
+
+void cPathFinderService::Tick(void)
+{
+	// Split the budget evenly among the searches of the last tick, but never give a single search more than it used to get:
+	m_StepsPerSearch = Clamp(m_StepsPerTick / std::max(m_NumSearches, 1), 1, static_cast<int>(cPath::CALCULATIONS_PER_STEP));
+	m_StepsLeft = m_StepsPerTick;
+	m_NumSearches = 0;
+}
+
+
+
+
+
+int cPathFinderService::RequestSteps(int a_MaxSteps)
+{
+	m_NumSearches += 1;
+	int res = std::min(std::min(a_MaxSteps, m_StepsPerSearch), m_StepsLeft);
+	m_StepsLeft -= res;
+	return res;
+}
+
+
+
+
+
+cPathCellArena * cPathFinderService::AcquireArena(void)
+{
+	{
+		cCSLock Lock(m_CS);
+		if (!m_FreeArenas.empty())
+		{
+			cPathCellArena * res = m_FreeArenas.back();
+			m_FreeArenas.pop_back();
+			return res;
+		}
+	}
+	return new cPathCellArena;
+}
+
+
+
+
+
+void cPathFinderService::ReleaseArena(cPathCellArena * a_Arena)
+{
+	a_Arena->Clear();
+	{
+		cCSLock Lock(m_CS);
+		if (m_FreeArenas.size() < MAX_FREE_ARENAS)
+		{
+			m_FreeArenas.push_back(a_Arena);
+			return;
+		}
+	}
+	delete a_Arena;
+}
+
+
+
+
@@ -0,0 +1,134 @@
+
+// PathFinderService.h
+
+// Declares the cPathFinderService class that shares the memory and the CPU time among all the path searches in a world
+
+
+
+
+
+#pragma once
+
+#include "Path.h"
+
+
+
+
+
+class cIniFile;
+
+
+
+
+
+enum class eCellStatus {OPENLIST,  CLOSEDLIST,  NOLIST};
+struct cPathCell
+{
+	Vector3i m_Location;   // Location of the cell in the world.
+	int m_F, m_G, m_H;  // F, G, H as defined in regular A*.
+	eCellStatus m_Status;  // Which list is the cell in? Either non, open, or closed.
+	cPathCell * m_Parent;  // Cell's parent, as defined in regular A*.
+	bool m_IsSolid;	   // Is the cell an air or a solid? Partial solids are currently considered solids.
+};
+
+
+
+
+
+/** The memory used by a single path search: the cells, the map of visited locations and the open list.
+When the search finishes, the arena is cleared and handed to the next search, which then reuses the already allocated
+cells and hash buckets instead of allocating each cell separately. */
+class cPathCellArena
+{
+public:
+
+	typedef std::unordered_map<Vector3i, cPathCell *, cPath::VectorHasher> cCellMap;
+
+	/** All the cells visited by the search, keyed by their location */
+	cCellMap m_Map;
+
+	/** The open list, kept as a binary heap by std::push_heap() / std::pop_heap() using compareHeuristics */
+	std::vector<cPathCell *> m_OpenList;
+
+
+	cPathCellArena(void);
+	~cPathCellArena();
+
+	/** Returns a cell for the search to use. The cell stays valid until Clear() is called, its contents are undefined. */
+	cPathCell * NewCell(void);
+
+	/** Forgets all the cells, keeping the memory for the next search. */
+	void Clear(void);
+
+protected:
+
+	/** Number of cells allocated at once */
+	static const size_t CELLS_PER_BLOCK = 256;
+
+	/** The cell storage, each item is an array of CELLS_PER_BLOCK cells. Never moved, so that the cell pointers stay valid. */
+	std::vector<cPathCell *> m_Blocks;
+
+	/** Number of cells handed out by NewCell() since the last Clear() */
+	size_t m_NumUsedCells;
+} ;
+
+
+
+
+
+/** Owned by each world, hands out the search arenas to the cPath instances and splits the per-tick budget of A* steps
+among the searches running in the tick. Without the budget, a large number of mobs starting to chase a player in the same
+tick would all run their full calculation quota at once; with it, the searches get an equal share of the budget and the
+rest of their work is postponed to the following ticks.
+The step budget is only used from the world's tick thread, the arenas can be acquired and released from any thread. */
+class cPathFinderService
+{
+public:
+
+	cPathFinderService(void);
+	~cPathFinderService();
+
+	/** Reads the settings from the [Pathfinder] section of the world's ini file, writing the defaults if not present. */
+	void Load(cIniFile & a_IniFile);
+
+	/** Starts a new tick: refills the step budget and recalculates the per-search share of it,
+	based on the number of searches that have asked for steps in the previous tick. */
+	void Tick(void);
+
+	/** Returns the number of A* steps that the calling search may perform in the current tick, at most a_MaxSteps.
+	Returns 0 if the budget for the current tick has been used up. */
+	int RequestSteps(int a_MaxSteps);
+
+	/** Returns an empty arena for a new search. The search must return it using ReleaseArena() when it finishes. */
+	cPathCellArena * AcquireArena(void);
+
+	/** Clears the arena and keeps it for the next search. */
+	void ReleaseArena(cPathCellArena * a_Arena);
+
+protected:
+
+	/** Maximum number of cleared arenas kept for reuse; the arenas released above this are freed */
+	static const size_t MAX_FREE_ARENAS = 64;
+
+	/** Total number of A* steps that all the searches may perform in a single tick */
+	int m_StepsPerTick;
+
+	/** Number of A* steps left for the current tick */
+	int m_StepsLeft;
+
+	/** Number of A* steps that each search gets in the current tick */
+	int m_StepsPerSearch;
+
+	/** Number of searches that have asked for steps in the current tick */
+	int m_NumSearches;
+
+	/** Protects m_FreeArenas; the searches are usually destroyed in the tick thread, but not always */
+	cCriticalSection m_CS;
+
+	/** The cleared arenas, available for the next searches */
+	std::vector<cPathCellArena *> m_FreeArenas;
+} ;
+
+
+
+
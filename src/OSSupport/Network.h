@@ -321,6 +321,15 @@ public:
 
 	/** Returns all local IP addresses for network interfaces currently available. */
 	static AStringVector EnumLocalIPAddresses(void);
+
+	/** Sets up the pool of event loops that drive the links accepted by the servers created using Listen().
+	The accepted links are distributed round-robin among the loops, each running in its own thread; the link callbacks
+	of different links may therefore be called concurrently, while the callbacks of a single link are always serialized.
+	0 keeps all the links in the main network thread; a negative number uses half of the CPU cores, up to 8 loops.
+	The callers need to make sure that the callbacks of all the servers' links are thread-safe before enabling more loops.
+	Only the first call has any effect, and it should be made before the first call to Listen().
+	Implemented in NetworkSingleton.cpp. */
+	static void SetNumLinkEventLoops(int a_NumLoops);
 };
 
 
@@ -19,7 +19,9 @@
 
 
 cNetworkSingleton::cNetworkSingleton(void):
-	m_HasTerminated(false)
+	m_HasTerminated(false),
+	m_NextLinkEventLoop(0),
+	m_HasStartedLinkEventLoops(false)
 {
 	// Windows: initialize networking:
 	#ifdef _WIN32
@@ -95,9 +97,19 @@ void cNetworkSingleton::Terminate(void)
 	ASSERT(!m_HasTerminated);
 	m_HasTerminated = true;
 
-	// Wait for the LibEvent event loop to terminate:
+	// Wait for the LibEvent event loops to terminate:
 	event_base_loopbreak(m_EventBase);
 	m_EventLoopThread.join();
+	sLinkEventLoopPtrs LinkEventLoops;
+	{
+		cCSLock Lock(m_CS);
+		std::swap(LinkEventLoops, m_LinkEventLoops);
+	}
+	for (auto & Loop: LinkEventLoops)
+	{
+		event_base_loopbreak(Loop->m_EventBase);
+		Loop->m_Thread.join();
+	}
 
 	// Remove all objects:
 	{
@@ -110,6 +122,10 @@ void cNetworkSingleton::Terminate(void)
 
 	// Free the underlying LibEvent objects:
 	evdns_base_free(m_DNSBase, true);
+	for (auto & Loop: LinkEventLoops)
+	{
+		event_base_free(Loop->m_EventBase);
+	}
 	event_base_free(m_EventBase);
 
 	libevent_global_shutdown();
@@ -119,6 +135,51 @@ void cNetworkSingleton::Terminate(void)
 
 
 
+event_base * cNetworkSingleton::GetLinkEventBase(void)
+{
+	cCSLock Lock(m_CS);
+	if (m_LinkEventLoops.empty())
+	{
+		return m_EventBase;
+	}
+	event_base * res = m_LinkEventLoops[m_NextLinkEventLoop]->m_EventBase;
+	m_NextLinkEventLoop = (m_NextLinkEventLoop + 1) % m_LinkEventLoops.size();
+	return res;
+}
+
+
+
+
+
+void cNetworkSingleton::StartLinkEventLoops(int a_NumLoops)
+{
+	ASSERT(!m_HasTerminated);
+	cCSLock Lock(m_CS);
+	if (m_HasStartedLinkEventLoops)
+	{
+		return;
+	}
+	m_HasStartedLinkEventLoops = true;
+
+	for (int i = 0; i < a_NumLoops; i++)
+	{
+		sLinkEventLoopPtr Loop = std::make_shared<sLinkEventLoop>();
+		Loop->m_EventBase = event_base_new();
+		if (Loop->m_EventBase == nullptr)
+		{
+			// Not fatal, the links will be spread over the loops created so far, or the main loop:
+			LOGWARNING("Failed to create a LibEvent event loop for the network links, using only %d.", i);
+			break;
+		}
+		Loop->m_Thread = std::thread(RunLinkEventLoop, Loop->m_EventBase);
+		m_LinkEventLoops.push_back(Loop);
+	}
+}
+
+
+
+
+
 void cNetworkSingleton::LogCallback(int a_Severity, const char * a_Msg)
 {
 	switch (a_Severity)
@@ -148,6 +209,15 @@ void cNetworkSingleton::RunEventLoop(cNetworkSingleton * a_Self)
 
 
 
+void cNetworkSingleton::RunLinkEventLoop(event_base * a_EventBase)
+{
+	event_base_loop(a_EventBase, EVLOOP_NO_EXIT_ON_EMPTY);
+}
+
+
+
+
+
 void cNetworkSingleton::AddHostnameLookup(cHostnameLookupPtr a_HostnameLookup)
 {
 	ASSERT(!m_HasTerminated);
@@ -263,3 +333,21 @@ void cNetworkSingleton::RemoveServer(const cServerHandleImpl * a_Server)
 
 
 
+
+void cNetwork::SetNumLinkEventLoops(int a_NumLoops)
+{
+	if (a_NumLoops < 0)
+	{
+		// Auto-detect: use half of the cores, the other half is left for the main loop and the world threads; at most 8 loops:
+		int NumCores = static_cast<int>(std::thread::hardware_concurrency());
+		a_NumLoops = Clamp(NumCores / 2, 1, 8);
+	}
+	if (a_NumLoops > 0)
+	{
+		cNetworkSingleton::Get().StartLinkEventLoops(a_NumLoops);
+	}
+}
+
+
+
+
@@ -57,6 +57,16 @@ public:
 	/** Returns the main LibEvent handle for event registering. */
 	event_base * GetEventBase(void) { return m_EventBase; }
 
+	/** Returns the LibEvent handle to use for a newly accepted link.
+	Distributes the links round-robin among the link event loops started by StartLinkEventLoops();
+	returns the main event base if no link event loops are running. */
+	event_base * GetLinkEventBase(void);
+
+	/** Starts a_NumLoops additional event loops, each in its own thread, that will drive the accepted links.
+	The listening sockets, DNS lookups, outgoing connections and UDP endpoints stay in the main event loop.
+	Only the first call has any effect; it should be made before any server starts listening. */
+	void StartLinkEventLoops(int a_NumLoops);
+
 	/** Returns the LibEvent handle for DNS lookups. */
 	evdns_base * GetDNSBase(void) { return m_DNSBase; }
 
@@ -95,6 +105,18 @@ public:
 
 protected:
 
+	/** An additional event loop dedicated to accepted links, and the thread driving it. */
+	struct sLinkEventLoop
+	{
+		event_base * m_EventBase;
+		std::thread m_Thread;
+
+		sLinkEventLoop(void) : m_EventBase(nullptr) {}
+	};
+	typedef SharedPtr<sLinkEventLoop> sLinkEventLoopPtr;
+	typedef std::vector<sLinkEventLoopPtr> sLinkEventLoopPtrs;
+
+
 	/** The main LibEvent container for driving the event loop. */
 	event_base * m_EventBase;
 
@@ -122,6 +144,16 @@ protected:
 	/** The thread in which the main LibEvent loop runs. */
 	std::thread m_EventLoopThread;
 
+	/** The additional event loops driving the accepted links. Protected by m_CS.
+	Empty if all the links are driven by the main event loop. */
+	sLinkEventLoopPtrs m_LinkEventLoops;
+
+	/** Index into m_LinkEventLoops of the loop to receive the next accepted link. Protected by m_CS. */
+	size_t m_NextLinkEventLoop;
+
+	/** Set to true once StartLinkEventLoops() has been called. Protected by m_CS. */
+	bool m_HasStartedLinkEventLoops;
+
 
 	/** Initializes the LibEvent internals. */
 	cNetworkSingleton(void);
@@ -131,6 +163,9 @@ protected:
 
 	/** Implements the thread that runs LibEvent's event dispatcher loop. */
 	static void RunEventLoop(cNetworkSingleton * a_Self);
+
+	/** Implements the threads that run the event dispatcher loops for the accepted links. */
+	static void RunLinkEventLoop(event_base * a_EventBase);
 };
 
 
@@ -316,8 +316,9 @@ void cServerHandleImpl::Callback(evconnlistener * a_Listener, evutil_socket_t a_
 		return;
 	}
 
-	// Create a new cTCPLink for the incoming connection:
-	cTCPLinkImplPtr Link = std::make_shared<cTCPLinkImpl>(a_Socket, LinkCallbacks, Self->m_SelfPtr, a_Addr, static_cast<socklen_t>(a_Len));
+	// Create a new cTCPLink for the incoming connection, in the next link event loop:
+	event_base * EventBase = cNetworkSingleton::Get().GetLinkEventBase();
+	cTCPLinkImplPtr Link = std::make_shared<cTCPLinkImpl>(a_Socket, LinkCallbacks, Self->m_SelfPtr, a_Addr, static_cast<socklen_t>(a_Len), EventBase);
 	{
 		cCSLock Lock(Self->m_CS);
 		Self->m_Connections.push_back(Link);
@@ -0,0 +1,170 @@
+
+// PlayerProximityGrid.cpp
+
+// Implements the cPlayerProximityGrid class that answers "which players are near this point" queries without scanning all players
+
+#include "Globals.h"
+#include "PlayerProximityGrid.h"
+#include "Entities/Player.h"
+
+
+
+
+
+cPlayerProximityGrid::cPlayerProximityGrid(void) :
+	m_NumPlayers(0)
+{
+}
+
+
+
+
+
+void cPlayerProximityGrid::Rebuild(const std::list<cPlayer *> & a_Players)
+{
+	cCSLock Lock(m_CS);
+	m_Cells.clear();
+	for (std::list<cPlayer *>::const_iterator itr = a_Players.begin(), end = a_Players.end(); itr != end; ++itr)
+	{
+		const Vector3d & Pos = (*itr)->GetPosition();
+		m_Cells[MakeCellKey(GetCellCoord(Pos.x), GetCellCoord(Pos.z))].push_back(sPlayerPos(*itr, Pos));
+	}
+	m_NumPlayers = a_Players.size();
+}
+
+
+
+
+
+void cPlayerProximityGrid::Remove(const cPlayer * a_Player)
+{
+	cCSLock Lock(m_CS);
+
+	// The player may have moved to another cell since the rebuild, search all cells:
+	for (cCells::iterator itrC = m_Cells.begin(), endC = m_Cells.end(); itrC != endC; ++itrC)
+	{
+		sPlayerPosVector & Players = itrC->second;
+		for (sPlayerPosVector::iterator itr = Players.begin(), end = Players.end(); itr != end; ++itr)
+		{
+			if (itr->m_Player == a_Player)
+			{
+				Players.erase(itr);
+				m_NumPlayers -= 1;
+				return;
+			}
+		}  // for itr - Players[]
+	}  // for itrC - m_Cells[]
+}
+
+
+
+
+
+void cPlayerProximityGrid::GetPlayersInRange(const Vector3d & a_Pos, double a_Radius, sPlayerPosVector & a_Players) const
+{
+	int MinCellX = GetCellCoord(a_Pos.x - a_Radius);
+	int MaxCellX = GetCellCoord(a_Pos.x + a_Radius);
+	int MinCellZ = GetCellCoord(a_Pos.z - a_Radius);
+	int MaxCellZ = GetCellCoord(a_Pos.z + a_Radius);
+	double RadiusSq = a_Radius * a_Radius;
+
+	cCSLock Lock(m_CS);
+	if (m_NumPlayers == 0)
+	{
+		return;
+	}
+	for (int z = MinCellZ; z <= MaxCellZ; z++)
+	{
+		for (int x = MinCellX; x <= MaxCellX; x++)
+		{
+			cCells::const_iterator itrC = m_Cells.find(MakeCellKey(x, z));
+			if (itrC == m_Cells.end())
+			{
+				continue;
+			}
+			for (sPlayerPosVector::const_iterator itr = itrC->second.begin(), end = itrC->second.end(); itr != end; ++itr)
+			{
+				double DiffX = itr->m_Pos.x - a_Pos.x;
+				double DiffZ = itr->m_Pos.z - a_Pos.z;
+				if (DiffX * DiffX + DiffZ * DiffZ <= RadiusSq)
+				{
+					a_Players.push_back(*itr);
+				}
+			}  // for itr - Cell[]
+		}  // for x
+	}  // for z
+}
+
+
+
+
+
+double cPlayerProximityGrid::GetNearestPlayerDistanceSq(const Vector3d & a_Pos, double a_MaxRadius) const
+{
+	int CenterX = GetCellCoord(a_Pos.x);
+	int CenterZ = GetCellCoord(a_Pos.z);
+	int MaxRing = CeilC(a_MaxRadius / CELL_SIZE);
+	double MaxRadiusSq = a_MaxRadius * a_MaxRadius;
+	double NearestSq = -1;
+
+	cCSLock Lock(m_CS);
+	if (m_NumPlayers == 0)
+	{
+		return -1;
+	}
+
+	// Visit the cells in rings of growing size around the center cell.
+	// Each cell in ring N+1 is at least N * CELL_SIZE blocks away horizontally, so once a player nearer than that
+	// has been found, no further rings need to be visited:
+	for (int Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		double RingDist = static_cast<double>((Ring - 1) * CELL_SIZE);
+		if ((NearestSq >= 0) && (NearestSq <= RingDist * RingDist))
+		{
+			break;
+		}
+		for (int z = CenterZ - Ring; z <= CenterZ + Ring; z++)
+		{
+			// Only the border of the ring, the inside has been visited in the previous rings:
+			bool IsBorderRow = ((z == CenterZ - Ring) || (z == CenterZ + Ring));
+			int StepX = IsBorderRow ? 1 : std::max(2 * Ring, 1);
+			for (int x = CenterX - Ring; x <= CenterX + Ring; x += StepX)
+			{
+				cCells::const_iterator itrC = m_Cells.find(MakeCellKey(x, z));
+				if (itrC == m_Cells.end())
+				{
+					continue;
+				}
+				for (sPlayerPosVector::const_iterator itr = itrC->second.begin(), end = itrC->second.end(); itr != end; ++itr)
+				{
+					double DiffX = itr->m_Pos.x - a_Pos.x;
+					double DiffZ = itr->m_Pos.z - a_Pos.z;
+					if (DiffX * DiffX + DiffZ * DiffZ > MaxRadiusSq)
+					{
+						continue;
+					}
+					double DistSq = (itr->m_Pos - a_Pos).SqrLength();
+					if ((NearestSq < 0) || (DistSq < NearestSq))
+					{
+						NearestSq = DistSq;
+					}
+				}  // for itr - Cell[]
+			}  // for x
+		}  // for z
+	}  // for Ring
+	return NearestSq;
+}
+
+
+
+
+
+size_t cPlayerProximityGrid::GetNumPlayers(void) const
+{
+	cCSLock Lock(m_CS);
+	return m_NumPlayers;
+}
+
+
+
+
@@ -0,0 +1,104 @@
+
+// PlayerProximityGrid.h
+
+// Declares the cPlayerProximityGrid class that answers "which players are near this point" queries without scanning all players
+
+
+
+
+
+#pragma once
+
+#include <unordered_map>
+
+
+
+
+
+// fwd:
+class cPlayer;
+
+
+
+
+
+/** Sorts the players of a world into a horizontal grid of square cells, by their positions at the time of the last Rebuild().
+Range and nearest-player queries then only visit the cells around the queried point, so that the cost of a query doesn't
+depend on the number of players in the world. The world rebuilds the grid each tick; since the players move in between,
+the users that need exact positions should only use the grid for selecting the candidates, see cWorld::FindClosestPlayer().
+Thread safe, the internal lock is never held while calling out of the class. */
+class cPlayerProximityGrid
+{
+public:
+
+	/** A player, together with their position at the time of the last Rebuild() */
+	struct sPlayerPos
+	{
+		cPlayer * m_Player;
+		Vector3d m_Pos;
+
+		sPlayerPos(cPlayer * a_Player, const Vector3d & a_Pos) :
+			m_Player(a_Player),
+			m_Pos(a_Pos)
+		{
+		}
+	} ;
+
+	typedef std::vector<sPlayerPos> sPlayerPosVector;
+
+
+	/** Size of a single grid cell, in blocks */
+	static const int CELL_SIZE = 32;
+
+	/** Distance, in blocks, by which the queries about the players' current positions should be extended,
+	to cover the players' movement since the last rebuild */
+	static const int POSITION_SLACK = 8;
+
+
+	cPlayerProximityGrid(void);
+
+	/** Replaces the contents of the grid with the specified players at their current positions. */
+	void Rebuild(const std::list<cPlayer *> & a_Players);
+
+	/** Removes the player from the grid, so that no further queries return them. */
+	void Remove(const cPlayer * a_Player);
+
+	/** Appends to a_Players all the players whose position at the last rebuild is within a_Radius of a_Pos.
+	Only the horizontal (XZ) distance is checked. */
+	void GetPlayersInRange(const Vector3d & a_Pos, double a_Radius, sPlayerPosVector & a_Players) const;
+
+	/** Returns the squared distance between a_Pos and the nearest player, using the positions at the last rebuild.
+	Only the players within a_MaxRadius horizontally are considered; returns -1 if there's none. */
+	double GetNearestPlayerDistanceSq(const Vector3d & a_Pos, double a_MaxRadius) const;
+
+	/** Returns the number of players in the grid */
+	size_t GetNumPlayers(void) const;
+
+protected:
+
+	typedef std::unordered_map<Int64, sPlayerPosVector> cCells;
+
+
+	/** Protects all the members */
+	mutable cCriticalSection m_CS;
+
+	/** The players in each non-empty cell, keyed by MakeCellKey() */
+	cCells m_Cells;
+
+	/** Total number of players in m_Cells */
+	size_t m_NumPlayers;
+
+
+	/** Returns the coord of the cell containing the specified block coord */
+	static int GetCellCoord(double a_BlockCoord) { return FloorC(a_BlockCoord / CELL_SIZE); }
+
+	/** Returns the key into m_Cells for the specified cell coords */
+	static Int64 MakeCellKey(int a_CellX, int a_CellZ)
+	{
+		return (static_cast<Int64>(a_CellX) << 32) | static_cast<UInt32>(a_CellZ);
+	}
+} ;
+
+
+
+
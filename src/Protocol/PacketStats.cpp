@@ -0,0 +1,88 @@
+// PacketStats.cpp
+
+// Implements the cPacketStats class that collects the server-wide statistics of the received game packets
+
+#include "Globals.h"
+#include "PacketStats.h"
+#include "../CommandOutput.h"
+
+
+
+
+
+cPacketStats::cPacketStats(void) :
+	m_NumMalformed(0),
+	m_NumRateLimited(0)
+{
+	for (size_t i = 0; i < ARRAYCOUNT(m_Types); i++)
+	{
+		m_Types[i].m_NumPackets = 0;
+		m_Types[i].m_NumBytes = 0;
+		m_Types[i].m_DecodeMicroSec = 0;
+		m_Types[i].m_HandleMicroSec = 0;
+	}
+}
+
+
+
+
+
+void cPacketStats::AddDecoded(UInt32 a_PacketType, size_t a_Size, Int64 a_DecodeMicroSec)
+{
+	sTypeStats & Stats = GetTypeStats(a_PacketType);
+	Stats.m_NumPackets += 1;
+	Stats.m_NumBytes += static_cast<UInt64>(a_Size);
+	Stats.m_DecodeMicroSec += static_cast<UInt64>(std::max<Int64>(a_DecodeMicroSec, 0));
+}
+
+
+
+
+
+void cPacketStats::AddHandled(UInt32 a_PacketType, Int64 a_HandleMicroSec)
+{
+	GetTypeStats(a_PacketType).m_HandleMicroSec += static_cast<UInt64>(std::max<Int64>(a_HandleMicroSec, 0));
+}
+
+
+
+
+
+void cPacketStats::Report(cCommandOutputCallback & a_Output) const
+{
+	a_Output.Out("Received game packets, by type:");
+	a_Output.Out("  type    count        bytes  decode us (avg)  handle us (avg)");
+	for (UInt32 i = 0; i < NUM_PACKET_TYPES; i++)
+	{
+		const sTypeStats & Stats = m_Types[i];
+		UInt64 NumPackets = Stats.m_NumPackets;
+		if (NumPackets == 0)
+		{
+			continue;
+		}
+		UInt64 Decode = Stats.m_DecodeMicroSec;
+		UInt64 Handle = Stats.m_HandleMicroSec;
+		a_Output.Out("  0x%02x %8llu %12llu %10llu (%3llu) %10llu (%3llu)",
+			i,
+			static_cast<unsigned long long>(NumPackets),
+			static_cast<unsigned long long>(Stats.m_NumBytes),
+			static_cast<unsigned long long>(Decode), static_cast<unsigned long long>(Decode / NumPackets),
+			static_cast<unsigned long long>(Handle), static_cast<unsigned long long>(Handle / NumPackets)
+		);
+	}
+	a_Output.Out("Clients kicked for malformed packets: %llu", static_cast<unsigned long long>(m_NumMalformed));
+	a_Output.Out("Clients kicked for exceeding the packet rate: %llu", static_cast<unsigned long long>(m_NumRateLimited));
+}
+
+
+
+
+
+cPacketStats::sTypeStats & cPacketStats::GetTypeStats(UInt32 a_PacketType)
+{
+	return m_Types[std::min(a_PacketType, NUM_PACKET_TYPES - 1)];
+}
+
+
+
+
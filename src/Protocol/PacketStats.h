@@ -0,0 +1,76 @@
+// PacketStats.h
+
+// Declares the cPacketStats class that collects the server-wide statistics of the received game packets
+
+
+
+
+
+#pragma once
+
+#include <atomic>
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+
+
+
+
+
+/** Server-wide statistics of the game packets received from the clients, by packet type.
+Measures the time spent decoding each packet type in the network threads, and the time spent handling it
+in the tick threads, so that expensive or abused packet types can be spotted. Also counts the clients
+that have been kicked for sending malformed packets or too many packets.
+All the counters are atomic, they are updated from the network threads and the tick threads without locking. */
+class cPacketStats
+{
+public:
+
+	/** Number of packet types that are tracked; packet types above this are counted into the last one. */
+	static const UInt32 NUM_PACKET_TYPES = 0x20;
+
+
+	cPacketStats(void);
+
+	/** Accounts a packet that has been decoded and validated in a network thread. */
+	void AddDecoded(UInt32 a_PacketType, size_t a_Size, Int64 a_DecodeMicroSec);
+
+	/** Accounts the handling of a previously decoded packet in a tick thread. */
+	void AddHandled(UInt32 a_PacketType, Int64 a_HandleMicroSec);
+
+	/** Accounts a client that has been kicked for sending a malformed packet. */
+	void AddMalformed(void) { ++m_NumMalformed; }
+
+	/** Accounts a client that has been kicked for exceeding the packet rate limit. */
+	void AddRateLimited(void) { ++m_NumRateLimited; }
+
+	/** Outputs the statistics as a table, used by the "netstats" console command. */
+	void Report(cCommandOutputCallback & a_Output) const;
+
+protected:
+
+	struct sTypeStats
+	{
+		std::atomic<UInt64> m_NumPackets;
+		std::atomic<UInt64> m_NumBytes;
+		std::atomic<UInt64> m_DecodeMicroSec;
+		std::atomic<UInt64> m_HandleMicroSec;
+	} ;
+
+	sTypeStats m_Types[NUM_PACKET_TYPES];
+
+	std::atomic<UInt64> m_NumMalformed;
+	std::atomic<UInt64> m_NumRateLimited;
+
+
+	/** Returns the stats for the specified packet type, clamping the type to the tracked range. */
+	sTypeStats & GetTypeStats(UInt32 a_PacketType);
+} ;
+
+
+
+
@@ -62,6 +62,74 @@ cPacketizer::~cPacketizer()
 
 
 
+const char * cPacketizer::GetPacketData(size_t & a_Size)
+{
+	char * Data = m_Out.GetContiguousData(a_Size);
+	ASSERT(Data != nullptr);  // The buffer is emptied after each packet, so the packet never wraps around
+	ASSERT(a_Size >= MAX_HEADER_SIZE);
+	a_Size -= MAX_HEADER_SIZE;
+	return Data + MAX_HEADER_SIZE;
+}
+
+
+
+
+
+void cPacketizer::PrependVarInt32(UInt32 a_Value)
+{
+	char VarInt[MAX_VARINT32_SIZE];
+	size_t VarIntSize = EncodeVarInt32(a_Value, VarInt);
+
+	// Back-patch it in front of the header so far:
+	ASSERT(m_HeaderSize + VarIntSize <= MAX_HEADER_SIZE);
+	size_t Size;
+	char * Data = m_Out.GetContiguousData(Size);
+	ASSERT(Data != nullptr);
+	m_HeaderSize += VarIntSize;
+	memcpy(Data + MAX_HEADER_SIZE - m_HeaderSize, VarInt, VarIntSize);
+}
+
+
+
+
+
+size_t cPacketizer::EncodeVarInt32(UInt32 a_Value, char * a_Out)
+{
+	size_t Size = 0;
+	do
+	{
+		a_Out[Size] = static_cast<char>((a_Value & 0x7f) | ((a_Value > 0x7f) ? 0x80 : 0x00));
+		a_Value = a_Value >> 7;
+		Size++;
+	} while (a_Value > 0);
+	return Size;
+}
+
+
+
+
+
+const char * cPacketizer::GetWholePacket(size_t & a_Size)
+{
+	const char * Data = GetPacketData(a_Size);
+	a_Size += m_HeaderSize;
+	return Data - m_HeaderSize;
+}
+
+
+
+
+
+void cPacketizer::Discard(void)
+{
+	m_Out.SkipRead(m_Out.GetReadableSpace());
+	m_Out.CommitRead();
+}
+
+
+
+
+
 void cPacketizer::WriteByteAngle(double a_Angle)
 {
 	WriteBEInt8(static_cast<Int8>(255 * a_Angle / 360));
@@ -17,18 +17,32 @@
 
 
 
-/** Composes an individual packet in the protocol's m_OutPacketBuffer; sends it just before being destructed. */
+/** Composes an individual packet in the protocol's m_OutPacketBuffer; sends it just before being destructed.
+The packet is composed in place: space for the packet header is reserved in front of the packet data, so that the protocol
+can back-patch the length VarInt(s) once the packet size is known and send the whole packet directly from the buffer.
+Since the buffer is reused for all the packets of the connection, composing and sending a packet doesn't allocate any memory. */
 class cPacketizer
 {
 public:
+	/** The space reserved in front of the packet data for the header, enough for two VarInts (packet length and data length). */
+	static const size_t MAX_HEADER_SIZE = 10;
+
+	/** The maximum number of bytes taken by a 32-bit VarInt */
+	static const size_t MAX_VARINT32_SIZE = 5;
+
+
 	/** Starts serializing a new packet into the protocol's m_OutPacketBuffer.
 	Locks the protocol's m_CSPacket to avoid multithreading issues. */
 	cPacketizer(cProtocol & a_Protocol, UInt32 a_PacketType) :
 		m_Protocol(a_Protocol),
 		m_Out(a_Protocol.m_OutPacketBuffer),
 		m_Lock(a_Protocol.m_CSPacket),
-		m_PacketType(a_PacketType)  // Used for logging purposes
+		m_PacketType(a_PacketType),  // Used for logging purposes
+		m_HeaderSize(0)
 	{
+		ASSERT(m_Out.GetUsedSpace() == 0);  // The previous packet must have been fully sent
+		static const char Reserved[MAX_HEADER_SIZE] = {0};
+		VERIFY(m_Out.Write(Reserved, sizeof(Reserved)));
 		m_Out.WriteVarInt32(a_PacketType);
 	}
 
@@ -135,6 +149,25 @@ public:
 
 	UInt32 GetPacketType(void) const { return m_PacketType; }
 
+	/** Returns the serialized packet data - the packet type followed by the payload, without any header.
+	a_Size receives the size of the data. The data is stored contiguously in the protocol's buffer. */
+	const char * GetPacketData(size_t & a_Size);
+
+	/** Back-patches the VarInt in front of the packet data and any header parts prepended before, into the reserved header space.
+	The header is thus built from the back, e.g. for a (length, data length) header, prepend the data length first. */
+	void PrependVarInt32(UInt32 a_Value);
+
+	/** Encodes the value as a VarInt into a_Out, which needs room for at least MAX_VARINT32_SIZE bytes.
+	Returns the number of bytes written. */
+	static size_t EncodeVarInt32(UInt32 a_Value, char * a_Out);
+
+	/** Returns the whole packet, starting with the header prepended so far, ready to be sent.
+	a_Size receives the size of the whole packet. */
+	const char * GetWholePacket(size_t & a_Size);
+
+	/** Removes the packet from the protocol's buffer, once it has been sent. */
+	void Discard(void);
+
 protected:
 	/** The protocol instance in which the packet is being constructed. */
 	cProtocol & m_Protocol;
@@ -148,6 +181,9 @@ protected:
 	/** Type of the contained packet.
 	Used for logging purposes, the packet type is encoded into m_Out immediately in constructor. */
 	UInt32 m_PacketType;
+
+	/** Number of bytes of the reserved header space that have been back-patched by PrependVarInt32(). */
+	size_t m_HeaderSize;
 } ;
 
 
@@ -12,6 +12,7 @@
 
 #include "../Defines.h"
 #include "../Endianness.h"
+#include "../OSSupport/CriticalSection.h"
 #include "../Scoreboard.h"
 #include "../Map.h"
 #include "../ByteBuffer.h"
@@ -52,8 +53,7 @@ class cProtocol
 public:
 	cProtocol(cClientHandle * a_Client) :
 		m_Client(a_Client),
-		m_OutPacketBuffer(64 KiB),
-		m_OutPacketLenBuffer(20)  // 20 bytes is more than enough for one VarInt
+		m_OutPacketBuffer(64 KiB)
 	{
 	}
 
@@ -61,6 +61,19 @@ public:
 	
 	/// Called when client sends some data
 	virtual void DataReceived(const char * a_Data, size_t a_Size) = 0;
+
+	/** Called in the tick thread to check whether the received data can from now on be decoded in the network thread.
+	If the protocol is in a state where the decoding doesn't depend on the packet handlers anymore (game state),
+	it prepares for the network-thread decoding and returns true; DecodeReceivedData() is then called instead of DataReceived().
+	The default implementation keeps all the decoding in the tick thread. */
+	virtual bool StartDecodingInNetworkThread(void) { return false; }
+
+	/** Called in the network thread with the received data, once StartDecodingInNetworkThread() has returned true.
+	Decodes and validates the packets and queues them for HandleDecodedPackets(). */
+	virtual void DecodeReceivedData(const char * a_Data, size_t a_Size) { UNUSED(a_Data); UNUSED(a_Size); }
+
+	/** Called in the tick thread to handle the packets queued by DecodeReceivedData(). */
+	virtual void HandleDecodedPackets(void) {}
 	
 	// Sending stuff to clients (alphabetically sorted):
 	virtual void SendAttachEntity               (const cEntity & a_Entity, const cEntity * a_Vehicle) = 0;
@@ -152,12 +165,10 @@ protected:
 	Automated via cPacketizer class. */
 	cCriticalSection m_CSPacket;
 
-	/** Buffer for composing the outgoing packets, through cPacketizer */
+	/** Buffer for composing the outgoing packets, through cPacketizer.
+	Reused for all the packets of the connection; the packet header is back-patched in place and the packet is sent directly from here. */
 	cByteBuffer m_OutPacketBuffer;
 	
-	/** Buffer for composing packet length (so that each cPacketizer instance doesn't allocate a new cPacketBuffer) */
-	cByteBuffer m_OutPacketLenBuffer;
-	
 	/** A generic data-sending routine, all outgoing packet data needs to be routed through this so that descendants may override it. */
 	virtual void SendData(const char * a_Data, size_t a_Size) = 0;
 
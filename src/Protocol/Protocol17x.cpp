@@ -2395,31 +2395,26 @@ void cProtocol172::SendData(const char * a_Data, size_t a_Size)
 
 void cProtocol172::SendPacket(cPacketizer & a_Packet)
 {
-	AString DataToSend;
-
-	// Send the packet length
-	UInt32 PacketLen = static_cast<UInt32>(m_OutPacketBuffer.GetUsedSpace());
-
-	m_OutPacketLenBuffer.WriteVarInt32(PacketLen);
-	m_OutPacketLenBuffer.ReadAll(DataToSend);
-	SendData(DataToSend.data(), DataToSend.size());
-	m_OutPacketLenBuffer.CommitRead();
-	
-	// Send the packet data:
-	m_OutPacketBuffer.ReadAll(DataToSend);
-	SendData(DataToSend.data(), DataToSend.size());
-	m_OutPacketBuffer.CommitRead();
+	// Back-patch the packet length in front of the packet data and send it all at once:
+	size_t PacketLen;
+	const char * PacketData = a_Packet.GetPacketData(PacketLen);
+	a_Packet.PrependVarInt32(static_cast<UInt32>(PacketLen));
+	size_t WholeLen;
+	const char * WholePacket = a_Packet.GetWholePacket(WholeLen);
+	SendData(WholePacket, WholeLen);
 	
 	// Log the comm into logfile:
 	if (g_ShouldLogCommOut)
 	{
 		AString Hex;
-		ASSERT(DataToSend.size() > 0);
-		CreateHexDump(Hex, DataToSend.data(), DataToSend.size(), 16);
+		ASSERT(PacketLen > 0);
+		CreateHexDump(Hex, PacketData, PacketLen, 16);
 		m_CommLogFile.Printf("Outgoing packet: type %d (0x%x), length %u (0x%x), state %d. Payload (incl. type):\n%s\n",
-			a_Packet.GetPacketType(), a_Packet.GetPacketType(), PacketLen, PacketLen, m_State, Hex.c_str()
+			a_Packet.GetPacketType(), a_Packet.GetPacketType(), static_cast<unsigned>(PacketLen), static_cast<unsigned>(PacketLen), m_State, Hex.c_str()
 		);
 	}
+
+	a_Packet.Discard();
 }
 
 
@@ -14,6 +14,7 @@ Implements the 1.8.x protocol classes:
 #include "ChunkDataSerializer.h"
 #include "PolarSSL++/Sha1Checksum.h"
 #include "Packetizer.h"
+#include "PacketStats.h"
 
 #include "../ClientHandle.h"
 #include "../Root.h"
@@ -53,6 +54,9 @@ Implements the 1.8.x protocol classes:
 /** The slot number that the client uses to indicate "outside the window". */
 static const Int16 SLOT_NUM_OUTSIDE = -999;
 
+/** The maximum payload size of the variable-sized serverbound game packets, such as plugin messages. */
+static const size_t MAX_GAME_PACKET_PAYLOAD = 32767;
+
 
 
 
@@ -107,7 +111,11 @@ cProtocol180::cProtocol180(cClientHandle * a_Client, const AString & a_ServerAdd
 	m_State(a_State),
 	m_ReceivedData(32 KiB),
 	m_IsEncrypted(false),
-	m_LastSentDimension(dimNotSet)
+	m_LastSentDimension(dimNotSet),
+	m_HasDecodingFailed(false),
+	m_MaxPacketsPerSecond(0),
+	m_NumPacketsThisPeriod(0),
+	m_PacketStats(nullptr)
 {
 	// Create the comm log file, if so requested:
 	if (g_ShouldLogCommIn || g_ShouldLogCommOut)
@@ -156,6 +164,84 @@ void cProtocol180::DataReceived(const char * a_Data, size_t a_Size)
 
 
 
+bool cProtocol180::StartDecodingInNetworkThread(void)
+{
+	// Only the game state can be decoded ahead of the packet handlers, the login state switches encryption on
+	// The comm log is written from the tick thread only, so keep decoding there when it is enabled
+	if ((m_State != 3) || g_ShouldLogCommIn)
+	{
+		return false;
+	}
+
+	cServer * Server = cRoot::Get()->GetServer();
+	m_PacketStats = &Server->GetPacketStats();
+	m_MaxPacketsPerSecond = Server->GetMaxPacketsPerSecond();
+	m_RateLimitPeriodStart = std::chrono::steady_clock::now();
+	return true;
+}
+
+
+
+
+
+void cProtocol180::DecodeReceivedData(const char * a_Data, size_t a_Size)
+{
+	if (m_IsEncrypted)
+	{
+		Byte Decrypted[512];
+		while (a_Size > 0)
+		{
+			size_t NumBytes = (a_Size > sizeof(Decrypted)) ? sizeof(Decrypted) : a_Size;
+			m_Decryptor.ProcessData(Decrypted, reinterpret_cast<const Byte *>(a_Data), NumBytes);
+			DecodeDecryptedData(reinterpret_cast<const char *>(Decrypted), NumBytes);
+			a_Size -= NumBytes;
+			a_Data += NumBytes;
+		}
+	}
+	else
+	{
+		DecodeDecryptedData(a_Data, a_Size);
+	}
+}
+
+
+
+
+
+void cProtocol180::HandleDecodedPackets(void)
+{
+	cDecodedPackets Packets;
+	AString Error;
+	{
+		cCSLock Lock(m_CSDecodedPackets);
+		std::swap(Packets, m_DecodedPackets);
+		std::swap(Error, m_DecodeError);
+	}
+
+	for (auto & Packet: Packets)
+	{
+		auto Start = std::chrono::steady_clock::now();
+		UInt32 PacketLen = static_cast<UInt32>(Packet.m_Data.size());
+		cByteBuffer bb(PacketLen + 1);
+		VERIFY(bb.Write(Packet.m_Data.data(), Packet.m_Data.size()));
+		UInt32 PacketType;
+		VERIFY(bb.ReadVarInt(PacketType));  // Already validated in DecodeDecryptedData()
+		bb.Write("\0", 1);  // Extra NUL to detect over-reads
+		// An unhandled packet has already been logged by HandleExtractedPacket(), the packets after it are still handled:
+		HandleExtractedPacket(bb, PacketType, PacketLen);
+		m_PacketStats->AddHandled(PacketType, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start).count());
+	}
+
+	if (!Error.empty())
+	{
+		m_Client->Kick(Error);
+	}
+}
+
+
+
+
+
 void cProtocol180::SendAttachEntity(const cEntity & a_Entity, const cEntity * a_Vehicle)
 {
 	ASSERT(m_State == 3);  // In game mode?
@@ -1571,11 +1657,20 @@ void cProtocol180::SendWindowProperty(const cWindow & a_Window, short a_Property
 
 
 bool cProtocol180::CompressPacket(const AString & a_Packet, AString & a_CompressedData)
+{
+	return CompressPacket(a_Packet.data(), a_Packet.size(), a_CompressedData);
+}
+
+
+
+
+
+bool cProtocol180::CompressPacket(const char * a_Packet, size_t a_PacketSize, AString & a_CompressedData)
 {
 	// Compress the data:
 	char CompressedData[MAX_COMPRESSED_PACKET_LEN];
 
-	uLongf CompressedSize = compressBound(a_Packet.size());
+	uLongf CompressedSize = compressBound(a_PacketSize);
 	if (CompressedSize >= MAX_COMPRESSED_PACKET_LEN)
 	{
 		ASSERT(!"Too high packet size.");
@@ -1584,27 +1679,23 @@ bool cProtocol180::CompressPacket(const AString & a_Packet, AString & a_Compress
 
 	int Status = compress2(
 		reinterpret_cast<Bytef *>(CompressedData), &CompressedSize,
-		reinterpret_cast<const Bytef *>(a_Packet.data()), a_Packet.size(), Z_DEFAULT_COMPRESSION
+		reinterpret_cast<const Bytef *>(a_Packet), a_PacketSize, Z_DEFAULT_COMPRESSION
 	);
 	if (Status != Z_OK)
 	{
 		return false;
 	}
 
-	AString LengthData;
-	cByteBuffer Buffer(20);
-	Buffer.WriteVarInt32(static_cast<UInt32>(a_Packet.size()));
-	Buffer.ReadAll(LengthData);
-	Buffer.CommitRead();
-
-	Buffer.WriteVarInt32(CompressedSize + LengthData.size());
-	Buffer.WriteVarInt32(static_cast<UInt32>(a_Packet.size()));
-	Buffer.ReadAll(LengthData);
-	Buffer.CommitRead();
+	// The header is (packet length, uncompressed data length), the packet length includes the data length VarInt:
+	char DataLength[cPacketizer::MAX_VARINT32_SIZE];
+	size_t DataLengthSize = cPacketizer::EncodeVarInt32(static_cast<UInt32>(a_PacketSize), DataLength);
+	char PacketLength[cPacketizer::MAX_VARINT32_SIZE];
+	size_t PacketLengthSize = cPacketizer::EncodeVarInt32(static_cast<UInt32>(CompressedSize + DataLengthSize), PacketLength);
 
 	a_CompressedData.clear();
-	a_CompressedData.reserve(LengthData.size() + CompressedSize);
-	a_CompressedData.append(LengthData.data(), LengthData.size());
+	a_CompressedData.reserve(PacketLengthSize + DataLengthSize + CompressedSize);
+	a_CompressedData.append(PacketLength, PacketLengthSize);
+	a_CompressedData.append(DataLength, DataLengthSize);
 	a_CompressedData.append(CompressedData, CompressedSize);
 	return true;
 }
@@ -1751,65 +1842,21 @@ void cProtocol180::AddReceivedData(const char * a_Data, size_t a_Size)
 	// Handle all complete packets:
 	for (;;)
 	{
-		UInt32 PacketLen;
-		if (!m_ReceivedData.ReadVarInt(PacketLen))
+		AString Packet, Error;
+		if (!ExtractPacket(Packet, Error))
 		{
-			// Not enough data
-			m_ReceivedData.ResetRead();
-			break;
-		}
-		if (!m_ReceivedData.CanReadBytes(PacketLen))
-		{
-			// The full packet hasn't been received yet
-			m_ReceivedData.ResetRead();
-			break;
-		}
-		
-		// Check packet for compression:
-		UInt32 CompressedSize = 0;
-		AString UncompressedData;
-		if (m_State == 3)
-		{
-			UInt32 NumBytesRead = m_ReceivedData.GetReadableSpace();
-			m_ReceivedData.ReadVarInt(CompressedSize);
-			if (CompressedSize > PacketLen)
+			if (!Error.empty())
 			{
-				m_Client->Kick("Bad compression");
+				m_Client->Kick(Error);
 				return;
 			}
-			if (CompressedSize > 0)
-			{
-				// Decompress the data:
-				AString CompressedData;
-				if (!m_ReceivedData.ReadString(CompressedData, CompressedSize))
-				{
-					m_Client->Kick("Compression failure");
-					return;
-				}
-				InflateString(CompressedData.data(), CompressedSize, UncompressedData);
-				PacketLen = UncompressedData.size();
-			}
-			else
-			{
-				NumBytesRead -= m_ReceivedData.GetReadableSpace();  // How many bytes has the CompressedSize taken up?
-				ASSERT(PacketLen > NumBytesRead);
-				PacketLen -= NumBytesRead;
-			}
+			break;
 		}
-		
-		// Move the packet payload to a separate cByteBuffer, bb:
+
+		// Move the packet to a separate cByteBuffer, bb:
+		UInt32 PacketLen = static_cast<UInt32>(Packet.size());
 		cByteBuffer bb(PacketLen + 1);
-		if (CompressedSize == 0)
-		{
-			// No compression was used, move directly
-			VERIFY(m_ReceivedData.ReadToByteBuffer(bb, (int)PacketLen));
-		}
-		else
-		{
-			// Compression was used, move the uncompressed data:
-			VERIFY(bb.Write(UncompressedData.data(), UncompressedData.size()));
-		}
-		m_ReceivedData.CommitRead();
+		VERIFY(bb.Write(Packet.data(), Packet.size()));
 
 		UInt32 PacketType;
 		if (!bb.ReadVarInt(PacketType))
@@ -1820,68 +1867,11 @@ void cProtocol180::AddReceivedData(const char * a_Data, size_t a_Size)
 
 		// Write one NUL extra, so that we can detect over-reads
 		bb.Write("\0", 1);
-		
-		// Log the packet info into the comm log file:
-		if (g_ShouldLogCommIn && m_CommLogFile.IsOpen())
-		{
-			AString PacketData;
-			bb.ReadAll(PacketData);
-			bb.ResetRead();
-			bb.ReadVarInt(PacketType);  // We have already read the packet type once, it will be there again
-			ASSERT(PacketData.size() > 0);  // We have written an extra NUL, so there had to be at least one byte read
-			PacketData.resize(PacketData.size() - 1);
-			AString PacketDataHex;
-			CreateHexDump(PacketDataHex, PacketData.data(), PacketData.size(), 16);
-			m_CommLogFile.Printf("Next incoming packet is type %u (0x%x), length %u (0x%x) at state %d. Payload:\n%s\n",
-				PacketType, PacketType, PacketLen, PacketLen, m_State, PacketDataHex.c_str()
-			);
-		}
 
-		if (!HandlePacket(bb, PacketType))
+		if (!HandleExtractedPacket(bb, PacketType, PacketLen))
 		{
-			// Unknown packet, already been reported, but without the length. Log the length here:
-			LOGWARNING("Unhandled packet: type 0x%x, state %d, length %u", PacketType, m_State, PacketLen);
-			
-			#ifdef _DEBUG
-				// Dump the packet contents into the log:
-				bb.ResetRead();
-				AString Packet;
-				bb.ReadAll(Packet);
-				Packet.resize(Packet.size() - 1);  // Drop the final NUL pushed there for over-read detection
-				AString Out;
-				CreateHexDump(Out, Packet.data(), (int)Packet.size(), 24);
-				LOGD("Packet contents:\n%s", Out.c_str());
-			#endif  // _DEBUG
-			
-			// Put a message in the comm log:
-			if (g_ShouldLogCommIn && m_CommLogFile.IsOpen())
-			{
-				m_CommLogFile.Printf("^^^^^^ Unhandled packet ^^^^^^\n\n\n");
-			}
-			
 			return;
 		}
-
-		// The packet should have 1 byte left in the buffer - the NUL we had added
-		if (bb.GetReadableSpace() != 1)
-		{
-			// Read more or less than packet length, report as error
-			LOGWARNING("Protocol 1.8: Wrong number of bytes read for packet 0x%x, state %d. Read " SIZE_T_FMT " bytes, packet contained %u bytes",
-				PacketType, m_State, bb.GetUsedSpace() - bb.GetReadableSpace(), PacketLen
-			);
-
-			// Put a message in the comm log:
-			if (g_ShouldLogCommIn && m_CommLogFile.IsOpen())
-			{
-				m_CommLogFile.Printf("^^^^^^ Wrong number of bytes read for this packet (exp %d left, got " SIZE_T_FMT " left) ^^^^^^\n\n\n",
-					1, bb.GetReadableSpace()
-				);
-				m_CommLogFile.Flush();
-			}
-
-			ASSERT(!"Read wrong number of bytes!");
-			m_Client->PacketError(PacketType);
-		}
 	}  // for (ever)
 
 	// Log any leftover bytes into the logfile:
@@ -1905,6 +1895,293 @@ void cProtocol180::AddReceivedData(const char * a_Data, size_t a_Size)
 
 
 
+
+void cProtocol180::DecodeDecryptedData(const char * a_Data, size_t a_Size)
+{
+	if (m_HasDecodingFailed)
+	{
+		return;
+	}
+
+	cDecodedPackets Packets;
+	AString Error;
+	while ((a_Size > 0) && Error.empty())
+	{
+		// Write as much of the data as fits into the buffer, then extract the packets to make room for more:
+		size_t NumBytes = std::min(a_Size, m_ReceivedData.GetFreeSpace());
+		if (NumBytes == 0)
+		{
+			// The buffer is full and doesn't contain a complete packet, the packet is too large:
+			Error = "Packet too large";
+			break;
+		}
+		VERIFY(m_ReceivedData.Write(a_Data, NumBytes));
+		a_Data += NumBytes;
+		a_Size -= NumBytes;
+
+		for (;;)
+		{
+			auto Start = std::chrono::steady_clock::now();
+			sDecodedPacket Packet;
+			if (!ExtractPacket(Packet.m_Data, Error))
+			{
+				break;
+			}
+
+			// Validate the packet structure:
+			UInt32 PacketType = 0;
+			size_t TypeLen = 0;
+			for (size_t i = 0; i < std::min<size_t>(Packet.m_Data.size(), 5); i++)
+			{
+				Byte b = static_cast<Byte>(Packet.m_Data[i]);
+				PacketType |= static_cast<UInt32>(b & 0x7f) << (7 * i);
+				if ((b & 0x80) == 0)
+				{
+					TypeLen = i + 1;
+					break;
+				}
+			}
+			if ((TypeLen == 0) || !IsValidGamePacket(PacketType, Packet.m_Data.size() - TypeLen))
+			{
+				m_PacketStats->AddMalformed();
+				Error = Printf("Malformed packet 0x%x", PacketType);
+				break;
+			}
+
+			// Apply the rate limit:
+			if (m_MaxPacketsPerSecond > 0)
+			{
+				if (Start - m_RateLimitPeriodStart >= std::chrono::seconds(1))
+				{
+					m_RateLimitPeriodStart = Start;
+					m_NumPacketsThisPeriod = 0;
+				}
+				m_NumPacketsThisPeriod += 1;
+				if (m_NumPacketsThisPeriod > m_MaxPacketsPerSecond)
+				{
+					m_PacketStats->AddRateLimited();
+					Error = "Too many packets";
+					break;
+				}
+			}
+
+			Packet.m_PacketType = PacketType;
+			m_PacketStats->AddDecoded(PacketType, Packet.m_Data.size(), std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start).count());
+			Packets.push_back(std::move(Packet));
+		}
+	}
+
+	if (!Error.empty())
+	{
+		// Only the IP is safe to read from this thread, the username may be changing in the tick thread:
+		LOGD("Client @ %s failed packet validation: %s", m_Client->GetIPString().c_str(), Error.c_str());
+		m_HasDecodingFailed = true;
+	}
+	if (Packets.empty() && Error.empty())
+	{
+		return;
+	}
+
+	// Queue the packets for the tick thread:
+	cCSLock Lock(m_CSDecodedPackets);
+	if (m_DecodedPackets.empty())
+	{
+		std::swap(m_DecodedPackets, Packets);
+	}
+	else
+	{
+		for (auto & Packet: Packets)
+		{
+			m_DecodedPackets.push_back(std::move(Packet));
+		}
+	}
+	if (!Error.empty())
+	{
+		m_DecodeError = Error;
+	}
+}
+
+
+
+
+
+bool cProtocol180::ExtractPacket(AString & a_Packet, AString & a_Error)
+{
+	UInt32 PacketLen;
+	if (!m_ReceivedData.ReadVarInt(PacketLen))
+	{
+		// Not enough data
+		m_ReceivedData.ResetRead();
+		return false;
+	}
+	if (!m_ReceivedData.CanReadBytes(PacketLen))
+	{
+		// The full packet hasn't been received yet
+		m_ReceivedData.ResetRead();
+		return false;
+	}
+
+	// Check packet for compression:
+	UInt32 CompressedSize = 0;
+	if (m_State == 3)
+	{
+		UInt32 NumBytesRead = static_cast<UInt32>(m_ReceivedData.GetReadableSpace());
+		m_ReceivedData.ReadVarInt(CompressedSize);
+		if (CompressedSize > PacketLen)
+		{
+			a_Error = "Bad compression";
+			return false;
+		}
+		if (CompressedSize > 0)
+		{
+			// Decompress the data:
+			AString CompressedData;
+			if (!m_ReceivedData.ReadString(CompressedData, CompressedSize))
+			{
+				a_Error = "Compression failure";
+				return false;
+			}
+			InflateString(CompressedData.data(), CompressedSize, a_Packet);
+		}
+		else
+		{
+			NumBytesRead -= static_cast<UInt32>(m_ReceivedData.GetReadableSpace());  // How many bytes has the CompressedSize taken up?
+			ASSERT(PacketLen > NumBytesRead);
+			PacketLen -= NumBytesRead;
+		}
+	}
+
+	if (CompressedSize == 0)
+	{
+		// No compression was used, move directly
+		VERIFY(m_ReceivedData.ReadString(a_Packet, PacketLen));
+	}
+	m_ReceivedData.CommitRead();
+	return true;
+}
+
+
+
+
+
+bool cProtocol180::HandleExtractedPacket(cByteBuffer & a_ByteBuffer, UInt32 a_PacketType, UInt32 a_PacketLen)
+{
+	// Log the packet info into the comm log file:
+	if (g_ShouldLogCommIn && m_CommLogFile.IsOpen())
+	{
+		AString PacketData;
+		a_ByteBuffer.ReadAll(PacketData);
+		a_ByteBuffer.ResetRead();
+		a_ByteBuffer.ReadVarInt(a_PacketType);  // We have already read the packet type once, it will be there again
+		ASSERT(PacketData.size() > 0);  // We have written an extra NUL, so there had to be at least one byte read
+		PacketData.resize(PacketData.size() - 1);
+		AString PacketDataHex;
+		CreateHexDump(PacketDataHex, PacketData.data(), PacketData.size(), 16);
+		m_CommLogFile.Printf("Next incoming packet is type %u (0x%x), length %u (0x%x) at state %d. Payload:\n%s\n",
+			a_PacketType, a_PacketType, a_PacketLen, a_PacketLen, m_State, PacketDataHex.c_str()
+		);
+	}
+
+	if (!HandlePacket(a_ByteBuffer, a_PacketType))
+	{
+		// Unknown packet, already been reported, but without the length. Log the length here:
+		LOGWARNING("Unhandled packet: type 0x%x, state %d, length %u", a_PacketType, m_State, a_PacketLen);
+		
+		#ifdef _DEBUG
+			// Dump the packet contents into the log:
+			a_ByteBuffer.ResetRead();
+			AString Packet;
+			a_ByteBuffer.ReadAll(Packet);
+			Packet.resize(Packet.size() - 1);  // Drop the final NUL pushed there for over-read detection
+			AString Out;
+			CreateHexDump(Out, Packet.data(), (int)Packet.size(), 24);
+			LOGD("Packet contents:\n%s", Out.c_str());
+		#endif  // _DEBUG
+		
+		// Put a message in the comm log:
+		if (g_ShouldLogCommIn && m_CommLogFile.IsOpen())
+		{
+			m_CommLogFile.Printf("^^^^^^ Unhandled packet ^^^^^^\n\n\n");
+		}
+		
+		return false;
+	}
+
+	// The packet should have 1 byte left in the buffer - the NUL we had added
+	if (a_ByteBuffer.GetReadableSpace() != 1)
+	{
+		// Read more or less than packet length, report as error
+		LOGWARNING("Protocol 1.8: Wrong number of bytes read for packet 0x%x, state %d. Read " SIZE_T_FMT " bytes, packet contained %u bytes",
+			a_PacketType, m_State, a_ByteBuffer.GetUsedSpace() - a_ByteBuffer.GetReadableSpace(), a_PacketLen
+		);
+
+		// Put a message in the comm log:
+		if (g_ShouldLogCommIn && m_CommLogFile.IsOpen())
+		{
+			m_CommLogFile.Printf("^^^^^^ Wrong number of bytes read for this packet (exp %d left, got " SIZE_T_FMT " left) ^^^^^^\n\n\n",
+				1, a_ByteBuffer.GetReadableSpace()
+			);
+			m_CommLogFile.Flush();
+		}
+
+		ASSERT(!"Read wrong number of bytes!");
+		m_Client->PacketError(a_PacketType);
+	}
+	return true;
+}
+
+
+
+
+
+bool cProtocol180::IsValidGamePacket(UInt32 a_PacketType, size_t a_PayloadSize)
+{
+	// Size bounds of the payload of the serverbound game packets, as read by the HandlePacketXYZ() functions:
+	static const struct
+	{
+		size_t m_Min;
+		size_t m_Max;
+	} Limits[] =
+	{
+		{  1,   5 },                      // 0x00 KeepAlive: VarInt
+		{  1, 402 },                      // 0x01 ChatMessage: String(100)
+		{  2,  22 },                      // 0x02 UseEntity: VarInt, VarInt, [3x float]
+		{  1,   1 },                      // 0x03 Player: bool
+		{ 25,  25 },                      // 0x04 PlayerPos: 3x double, bool
+		{  9,   9 },                      // 0x05 PlayerLook: 2x float, bool
+		{ 33,  33 },                      // 0x06 PlayerPosLook: 3x double, 2x float, bool
+		{ 10,  10 },                      // 0x07 BlockDig: byte, position, byte
+		{ 14, MAX_GAME_PACKET_PAYLOAD },  // 0x08 BlockPlace: position, byte, slot, 3x byte
+		{  2,   2 },                      // 0x09 SlotSelect: short
+		{  0,   0 },                      // 0x0a Animation
+		{  3,  11 },                      // 0x0b EntityAction: VarInt, byte, VarInt
+		{  9,   9 },                      // 0x0c SteerVehicle: 2x float, byte
+		{  1,   1 },                      // 0x0d WindowClose: byte
+		{  9, MAX_GAME_PACKET_PAYLOAD },  // 0x0e WindowClick: byte, short, byte, short, byte, slot
+		{  4,   4 },                      // 0x0f ConfirmTransaction: byte, short, bool
+		{  4, MAX_GAME_PACKET_PAYLOAD },  // 0x10 CreativeInventoryAction: short, slot
+		{  2,   2 },                      // 0x11 EnchantItem: 2x byte
+		{ 12, MAX_GAME_PACKET_PAYLOAD },  // 0x12 UpdateSign: position, 4x String
+		{  9,   9 },                      // 0x13 PlayerAbilities: byte, 2x float
+		{  2, MAX_GAME_PACKET_PAYLOAD },  // 0x14 TabComplete: String, bool, [position]
+		{  5,  69 },                      // 0x15 ClientSettings: String(16), 2x byte, bool, byte
+		{  1,   1 },                      // 0x16 ClientStatus: byte
+		{  1, MAX_GAME_PACKET_PAYLOAD },  // 0x17 PluginMessage: String, data
+		{ 16,  16 },                      // 0x18 Spectate: UUID
+		{  2, MAX_GAME_PACKET_PAYLOAD },  // 0x19 ResourcePackStatus: String, VarInt
+	};
+	if (a_PacketType >= ARRAYCOUNT(Limits))
+	{
+		// Not a known packet, let it through to be reported as unhandled:
+		return (a_PayloadSize <= MAX_GAME_PACKET_PAYLOAD);
+	}
+	return ((a_PayloadSize >= Limits[a_PacketType].m_Min) && (a_PayloadSize <= Limits[a_PacketType].m_Max));
+}
+
+
+
+
+
 bool cProtocol180::HandlePacket(cByteBuffer & a_ByteBuffer, UInt32 a_PacketType)
 {
 	switch (m_State)
@@ -2830,58 +3107,48 @@ eBlockFace cProtocol180::FaceIntToBlockFace(Int8 a_BlockFace)
 
 void cProtocol180::SendPacket(cPacketizer & a_Pkt)
 {
-	UInt32 PacketLen = static_cast<UInt32>(m_OutPacketBuffer.GetUsedSpace());
-	AString PacketData, CompressedPacket;
-	m_OutPacketBuffer.ReadAll(PacketData);
-	m_OutPacketBuffer.CommitRead();
+	size_t PacketLen;
+	const char * PacketData = a_Pkt.GetPacketData(PacketLen);
 
 	if ((m_State == 3) && (PacketLen >= 256))
 	{
 		// Compress the packet payload:
-		if (!cProtocol180::CompressPacket(PacketData, CompressedPacket))
+		if (cProtocol180::CompressPacket(PacketData, PacketLen, m_CompressedPacket))
 		{
-			return;
+			SendData(m_CompressedPacket.data(), m_CompressedPacket.size());
 		}
 	}
-	else if (m_State == 3)
-	{
-		// The packet is not compressed, indicate this in the packet header:
-		m_OutPacketLenBuffer.WriteVarInt32(PacketLen + 1);
-		m_OutPacketLenBuffer.WriteVarInt32(0);
-		AString LengthData;
-		m_OutPacketLenBuffer.ReadAll(LengthData);
-		SendData(LengthData.data(), LengthData.size());
-	}
-	else
-	{
-		// Compression doesn't apply to this state, send raw data:
-		m_OutPacketLenBuffer.WriteVarInt32(PacketLen);
-		AString LengthData;
-		m_OutPacketLenBuffer.ReadAll(LengthData);
-		SendData(LengthData.data(), LengthData.size());
-	}
-
-	// Send the packet's payload, either direct or compressed:
-	if (CompressedPacket.empty())
-	{
-		m_OutPacketLenBuffer.CommitRead();
-		SendData(PacketData.data(), PacketData.size());
-	}
 	else
 	{
-		SendData(CompressedPacket.data(), CompressedPacket.size());
+		// Back-patch the header in front of the packet data and send it all at once:
+		if (m_State == 3)
+		{
+			// The packet is not compressed, indicate this in the packet header:
+			a_Pkt.PrependVarInt32(0);
+			a_Pkt.PrependVarInt32(static_cast<UInt32>(PacketLen) + 1);
+		}
+		else
+		{
+			// Compression doesn't apply to this state, send raw data:
+			a_Pkt.PrependVarInt32(static_cast<UInt32>(PacketLen));
+		}
+		size_t WholeLen;
+		const char * WholePacket = a_Pkt.GetWholePacket(WholeLen);
+		SendData(WholePacket, WholeLen);
 	}
 
 	// Log the comm into logfile:
 	if (g_ShouldLogCommOut && m_CommLogFile.IsOpen())
 	{
 		AString Hex;
-		ASSERT(PacketData.size() > 0);
-		CreateHexDump(Hex, PacketData.data(), PacketData.size(), 16);
+		ASSERT(PacketLen > 0);
+		CreateHexDump(Hex, PacketData, PacketLen, 16);
 		m_CommLogFile.Printf("Outgoing packet: type %d (0x%x), length %u (0x%x), state %d. Payload (incl. type):\n%s\n",
-			a_Pkt.GetPacketType(), a_Pkt.GetPacketType(), PacketLen, PacketLen, m_State, Hex.c_str()
+			a_Pkt.GetPacketType(), a_Pkt.GetPacketType(), static_cast<unsigned>(PacketLen), static_cast<unsigned>(PacketLen), m_State, Hex.c_str()
 		);
 	}
+
+	a_Pkt.Discard();
 }
 
 
@@ -42,6 +42,7 @@ namespace Json
 {
 	class Value;
 }
+class cPacketStats;
 
 
 
@@ -58,6 +59,9 @@ public:
 	
 	/** Called when client sends some data: */
 	virtual void DataReceived(const char * a_Data, size_t a_Size) override;
+	virtual bool StartDecodingInNetworkThread(void) override;
+	virtual void DecodeReceivedData(const char * a_Data, size_t a_Size) override;
+	virtual void HandleDecodedPackets(void) override;
 
 	/** Sending stuff to clients (alphabetically sorted): */
 	virtual void SendAttachEntity               (const cEntity & a_Entity, const cEntity * a_Vehicle) override;
@@ -143,6 +147,9 @@ public:
 	If compression fails, the function returns false. */
 	static bool CompressPacket(const AString & a_Packet, AString & a_Compressed);
 
+	/** Compress the packet, same as above, but reads the packet data from a plain memory block. */
+	static bool CompressPacket(const char * a_Packet, size_t a_PacketSize, AString & a_Compressed);
+
 	/** The 1.8 protocol use a particle id instead of a string. This function converts the name to the id. If the name is incorrect, it returns 0. */
 	static int GetParticleID(const AString & a_ParticleName);
 
@@ -170,15 +177,72 @@ protected:
 
 	/** The logfile where the comm is logged, when g_ShouldLogComm is true */
 	cFile m_CommLogFile;
+
+	/** Buffer for the compressed outgoing packet, reused for all the packets to avoid allocations. Protected by m_CSPacket. */
+	AString m_CompressedPacket;
 	
 	/** The dimension that was last sent to a player in a Respawn or Login packet.
 	Used to avoid Respawning into the same dimension, which confuses the client. */
 	eDimension m_LastSentDimension;
+
+	/** A game packet that has been decoded and validated in the network thread, waiting to be handled in the tick thread. */
+	struct sDecodedPacket
+	{
+		UInt32 m_PacketType;
+
+		/** The whole packet, including the packet type, without the length and compression headers. */
+		AString m_Data;
+	} ;
+	typedef std::vector<sDecodedPacket> cDecodedPackets;
+
+	/** Protects m_DecodedPackets and m_DecodeError against multithreaded access. */
+	cCriticalSection m_CSDecodedPackets;
+
+	/** The packets decoded in the network thread, waiting for HandleDecodedPackets(). Protected by m_CSDecodedPackets. */
+	cDecodedPackets m_DecodedPackets;
+
+	/** If not empty, the network-thread decoding has failed and the client is to be kicked with this reason
+	in the tick thread. Protected by m_CSDecodedPackets. */
+	AString m_DecodeError;
+
+	/** Set when the network-thread decoding fails, no more data is decoded afterwards. Only used in the network thread. */
+	bool m_HasDecodingFailed;
+
+	/** The maximum number of packets per second that the client may send, 0 for unlimited.
+	Set in StartDecodingInNetworkThread(). */
+	int m_MaxPacketsPerSecond;
+
+	/** Number of packets received in the current rate-limiting period. Only used in the network thread. */
+	int m_NumPacketsThisPeriod;
+
+	/** Start of the current rate-limiting period. Only used in the network thread. */
+	std::chrono::steady_clock::time_point m_RateLimitPeriodStart;
+
+	/** The server-wide packet statistics. Set in StartDecodingInNetworkThread(). */
+	cPacketStats * m_PacketStats;
 	
 	
 	/** Adds the received (unencrypted) data to m_ReceivedData, parses complete packets */
 	void AddReceivedData(const char * a_Data, size_t a_Size);
 
+	/** Adds the received (unencrypted) data to m_ReceivedData in the network thread.
+	Validates complete packets and queues them for HandleDecodedPackets(). */
+	void DecodeDecryptedData(const char * a_Data, size_t a_Size);
+
+	/** Extracts the next complete packet out of m_ReceivedData, undoing its compression.
+	a_Packet receives the packet type followed by the payload.
+	Returns false if there isn't a complete packet yet, or if the data is invalid, in which case a_Error is set. */
+	bool ExtractPacket(AString & a_Packet, AString & a_Error);
+
+	/** Logs and handles a single packet extracted by ExtractPacket().
+	a_ByteBuffer contains the payload, with the packet type already read and an extra NUL at the end for over-read detection.
+	Returns false if the packet was not understood and the rest of the received data should not be processed. */
+	bool HandleExtractedPacket(cByteBuffer & a_ByteBuffer, UInt32 a_PacketType, UInt32 a_PacketLen);
+
+	/** Returns true if the game packet of the specified type and payload size (excluding the packet type) is structurally valid,
+	that is, its size is within the bounds of its fields. Packets of unknown types are let through, to be reported as unhandled. */
+	static bool IsValidGamePacket(UInt32 a_PacketType, size_t a_PayloadSize);
+
 	/** Reads and handles the packet. The packet length and type have already been read.
 	Returns true if the packet was understood, false if it was an unknown packet
 	*/
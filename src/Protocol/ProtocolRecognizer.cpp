@@ -88,6 +88,42 @@ void cProtocolRecognizer::DataReceived(const char * a_Data, size_t a_Size)
 
 
 
+bool cProtocolRecognizer::StartDecodingInNetworkThread(void)
+{
+	if (m_Protocol == nullptr)
+	{
+		return false;
+	}
+	return m_Protocol->StartDecodingInNetworkThread();
+}
+
+
+
+
+
+void cProtocolRecognizer::DecodeReceivedData(const char * a_Data, size_t a_Size)
+{
+	// Only called after StartDecodingInNetworkThread() has succeeded, so the protocol is known:
+	ASSERT(m_Protocol != nullptr);
+	m_Protocol->DecodeReceivedData(a_Data, a_Size);
+}
+
+
+
+
+
+void cProtocolRecognizer::HandleDecodedPackets(void)
+{
+	if (m_Protocol != nullptr)
+	{
+		m_Protocol->HandleDecodedPackets();
+	}
+}
+
+
+
+
+
 void cProtocolRecognizer::SendAttachEntity(const cEntity & a_Entity, const cEntity * a_Vehicle)
 {
 	ASSERT(m_Protocol != nullptr);
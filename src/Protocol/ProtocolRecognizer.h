@@ -46,6 +46,9 @@ public:
 	
 	/// Called when client sends some data:
 	virtual void DataReceived(const char * a_Data, size_t a_Size) override;
+	virtual bool StartDecodingInNetworkThread(void) override;
+	virtual void DecodeReceivedData(const char * a_Data, size_t a_Size) override;
+	virtual void HandleDecodedPackets(void) override;
 	
 	/// Sending stuff to clients (alphabetically sorted):
 	virtual void SendAttachEntity               (const cEntity & a_Entity, const cEntity * a_Vehicle) override;
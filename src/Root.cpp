@@ -143,6 +143,7 @@ void cRoot::Start(void)
 		m_MojangAPI = new cMojangAPI;
 		bool ShouldAuthenticate = IniFile.GetValueSetB("Authentication", "Authenticate", true);
 		m_MojangAPI->Start(IniFile, ShouldAuthenticate);  // Mojang API needs to be started before plugins, so that plugins may use it for DB upgrades on server init
+		m_WorkerPool.Start(IniFile.GetValueSetI("WorkerPool", "NumThreads", 2));  // Started before plugins, so that they may queue async jobs on init
 		if (!m_Server->InitServer(IniFile, ShouldAuthenticate))
 		{
 			IniFile.WriteFile("settings.ini");
@@ -233,6 +234,9 @@ void cRoot::Start(void)
 		LOGD("Shutting down deadlock detector...");
 		dd.Stop();
 
+		LOGD("Stopping worker pool...");
+		m_WorkerPool.Stop();
+
 		LOGD("Stopping world threads...");
 		StopWorlds();
 
@@ -354,7 +358,29 @@ void cRoot::StartWorlds(void)
 	for (WorldMap::iterator itr = m_WorldsByName.begin(); itr != m_WorldsByName.end(); ++itr)
 	{
 		itr->second->Start();
-		itr->second->InitializeSpawn();
+	}
+
+	// Each world has its own generator, lighting and storage threads, so their spawn areas can be prepared concurrently:
+	std::vector<std::thread> SpawnThreads;
+	for (WorldMap::iterator itr = m_WorldsByName.begin(); itr != m_WorldsByName.end(); ++itr)
+	{
+		try
+		{
+			SpawnThreads.push_back(std::thread(&cWorld::InitializeSpawn, itr->second));
+		}
+		catch (std::system_error & a_Exception)
+		{
+			LOGWARNING("Could not create the spawn preparation thread for world %s, error %i; preparing it sequentially.", itr->first.c_str(), a_Exception.code().value());
+			itr->second->InitializeSpawn();
+		}
+	}
+	for (std::vector<std::thread>::iterator itr = SpawnThreads.begin(); itr != SpawnThreads.end(); ++itr)
+	{
+		itr->join();
+	}
+
+	for (WorldMap::iterator itr = m_WorldsByName.begin(); itr != m_WorldsByName.end(); ++itr)
+	{
 		m_PluginManager->CallHookWorldStarted(*itr->second);
 	}
 }
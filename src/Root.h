@@ -6,6 +6,7 @@
 #include "HTTPServer/HTTPServer.h"
 #include "Defines.h"
 #include "RankManager.h"
+#include "WorkerPool.h"
 #include <thread>
 
 
@@ -90,6 +91,7 @@ public:
 	cAuthenticator &   GetAuthenticator  (void) { return m_Authenticator; }
 	cMojangAPI &       GetMojangAPI      (void) { return *m_MojangAPI; }
 	cRankManager *     GetRankManager    (void) { return m_RankManager.get(); }
+	cWorkerPool &      GetWorkerPool     (void) { return m_WorkerPool; }
 
 	/** Queues a console command for execution through the cServer class.
 	The command will be executed in the tick thread
@@ -194,6 +196,7 @@ private:
 	cPluginManager *   m_PluginManager;
 	cAuthenticator     m_Authenticator;
 	cMojangAPI *       m_MojangAPI;
+	cWorkerPool        m_WorkerPool;
 
 	std::unique_ptr<cRankManager> m_RankManager;
 
@@ -206,7 +209,7 @@ private:
 	/// Loads the worlds from settings.ini, creates the worldmap
 	void LoadWorlds(cIniFile & IniFile);
 	
-	/// Starts each world's life
+	/// Starts each world's life, preparing the spawn areas of all the worlds concurrently
 	void StartWorlds(void);
 	
 	/// Stops each world's threads, so that it's safe to unload them
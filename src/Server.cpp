@@ -9,6 +9,7 @@
 #include "World.h"
 #include "ChunkDef.h"
 #include "Bindings/PluginManager.h"
+#include "Bindings/PluginProfiler.h"
 #include "ChatColor.h"
 #include "Entities/Player.h"
 #include "Inventory.h"
@@ -135,6 +136,8 @@ cServer::cServer(void) :
 	m_PlayerCount(0),
 	m_PlayerCountDiff(0),
 	m_ClientViewDistance(0),
+	m_ClientChunkStreamBytesPerTick(0),
+	m_MaxPacketsPerSecond(0),
 	m_bIsConnected(false),
 	m_bRestarting(false),
 	m_RCONServer(*this),
@@ -246,6 +249,14 @@ bool cServer::InitServer(cIniFile & a_SettingsIni, bool a_ShouldAuth)
 		m_ClientViewDistance = cClientHandle::MAX_VIEW_DISTANCE;
 		LOGINFO("Setting default viewdistance to the maximum of %d", m_ClientViewDistance);
 	}
+	m_ClientChunkStreamBytesPerTick = std::max(a_SettingsIni.GetValueSetI("Server", "ChunkStreamBytesPerTick", cClientHandle::DEFAULT_CHUNK_STREAM_BYTES_PER_TICK), 0);
+	m_MaxPacketsPerSecond = std::max(a_SettingsIni.GetValueSetI("Server", "MaxPacketsPerSecond", 500), 0);
+
+	// Set up the network threads for the client connections before any server starts listening.
+	// 0 (the default) keeps all the links in the main network thread; more loops make the callbacks of different links,
+	// including the webadmin and RCON ones, run concurrently, so the loops are only used when explicitly configured.
+	// -1 = based on CPU count:
+	cNetwork::SetNumLinkEventLoops(a_SettingsIni.GetValueSetI("Server", "NetworkEventLoops", 0));
 
 	PrepareKeys();
 
@@ -297,7 +308,7 @@ void cServer::PrepareKeys(void)
 cTCPLink::cCallbacksPtr cServer::OnConnectionAccepted(const AString & a_RemoteIPAddress)
 {
 	LOGD("Client \"%s\" connected!", a_RemoteIPAddress.c_str());
-	cClientHandlePtr NewHandle = std::make_shared<cClientHandle>(a_RemoteIPAddress, m_ClientViewDistance);
+	cClientHandlePtr NewHandle = std::make_shared<cClientHandle>(a_RemoteIPAddress, m_ClientViewDistance, m_ClientChunkStreamBytesPerTick);
 	NewHandle->SetSelf(NewHandle);
 	cCSLock Lock(m_CSClients);
 	m_Clients.push_back(NewHandle);
@@ -324,6 +335,9 @@ bool cServer::Tick(float a_Dt)
 	// Send the tick to the plugins, as well as let the plugin manager reload, if asked to (issue #102):
 	cPluginManager::Get()->Tick(a_Dt);
 
+	// Deliver the results of the finished async jobs:
+	cRoot::Get()->GetWorkerPool().TickFinishedJobs();
+
 	// Let the Root process all the queued commands:
 	cRoot::Get()->TickCommands();
 
@@ -522,6 +536,76 @@ void cServer::ExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallbac
 		a_Output.Finished();
 		return;
 	}
+	else if (split[0].compare("entitystats") == 0)
+	{
+		class cWorldCallback : public cWorldListCallback
+		{
+		public:
+			cWorldCallback(cCommandOutputCallback & a_Output) : m_Output(a_Output) {}
+
+			virtual bool Item(cWorld * a_World) override
+			{
+				m_Output.Out("World %s:", a_World->GetName().c_str());
+				a_World->GetEntityActivation().Report(m_Output);
+				a_World->GetEntityMerger().Report(m_Output);
+				a_World->GetHopperScheduler().Report(m_Output);
+				return false;
+			}
+
+			cCommandOutputCallback & m_Output;
+		} WC(a_Output);
+		cRoot::Get()->ForEachWorld(WC);
+		a_Output.Finished();
+		return;
+	}
+	else if (split[0].compare("hookstats") == 0)
+	{
+		cPluginManager::Get()->ReportHookStats(a_Output);
+		a_Output.Finished();
+		return;
+	}
+	else if (split[0].compare("luaprof") == 0)
+	{
+		if (split.size() < 2)
+		{
+			cPluginProfiler::ReportAll(a_Output);
+		}
+		else if ((split[1] == "on") || (split[1] == "off"))
+		{
+			cPluginProfiler::SetEnabled(split[1] == "on");
+			a_Output.Out("Lua plugin profiling is %s", split[1].c_str());
+		}
+		else if (split[1] == "reset")
+		{
+			cPluginProfiler::ResetAll();
+			a_Output.Out("Lua plugin profiles have been reset");
+		}
+		else if ((split[1] == "slow") && (split.size() > 2))
+		{
+			int Threshold = 0;
+			if ((split[2] != "off") && !StringToInteger(split[2], Threshold))
+			{
+				a_Output.Out("Invalid slow call threshold: %s", split[2].c_str());
+			}
+			else
+			{
+				cPluginProfiler::SetSlowCallThreshold(Threshold);
+				a_Output.Out("Slow call sampling threshold: %d ms", Threshold);
+			}
+		}
+		else
+		{
+			a_Output.Out("Usage: luaprof [on | off | reset | slow <ms> | slow off]");
+		}
+		a_Output.Finished();
+		return;
+	}
+	else if (split[0].compare("netstats") == 0)
+	{
+		m_PacketStats.Report(a_Output);
+		a_Output.Finished();
+		return;
+	}
 	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
 	else if (split[0].compare("dumpmem") == 0)
 	{
@@ -604,6 +688,10 @@ void cServer::BindBuiltInConsoleCommands(void)
 	PlgMgr->BindConsoleCommand("restart", nullptr, " - Restarts the server cleanly");
 	PlgMgr->BindConsoleCommand("stop", nullptr, " - Stops the server cleanly");
 	PlgMgr->BindConsoleCommand("chunkstats", nullptr, " - Displays detailed chunk memory statistics");
+	PlgMgr->BindConsoleCommand("entitystats", nullptr, " - Displays the active and inactive entity counts, the merge stats and the sleeping hoppers of each world");
+	PlgMgr->BindConsoleCommand("hookstats", nullptr, " - Displays the call counts and times of the plugin hooks");
+	PlgMgr->BindConsoleCommand("luaprof", nullptr, " - Displays the time spent in the Lua plugins; [on | off | reset | slow <ms>] controls the profiling");
+	PlgMgr->BindConsoleCommand("netstats", nullptr, " - Displays the statistics of the received game packets");
 	PlgMgr->BindConsoleCommand("load <pluginname>", nullptr, " - Adds and enables the specified plugin");
 	PlgMgr->BindConsoleCommand("unload <pluginname>", nullptr, " - Disables the specified plugin");
 	PlgMgr->BindConsoleCommand("destroyentities", nullptr, " - Destroys all entities in all worlds");
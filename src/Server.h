@@ -12,6 +12,7 @@
 #include "RCONServer.h"
 #include "OSSupport/IsThread.h"
 #include "OSSupport/Network.h"
+#include "Protocol/PacketStats.h"
 
 #ifdef _MSC_VER
 	#pragma warning(push)
@@ -138,6 +139,13 @@ public:
 	Read from settings, admins should set this to true only when they chain to BungeeCord,
 	it makes the server vulnerable to identity theft through direct connections. */
 	bool ShouldAllowBungeeCord(void) const { return m_ShouldAllowBungeeCord; }
+
+	/** Returns the maximum number of packets per second that a client in the game may send before being kicked; 0 = unlimited.
+	Read from the settings.ini [Server].MaxPacketsPerSecond setting. */
+	int GetMaxPacketsPerSecond(void) const { return m_MaxPacketsPerSecond; }
+
+	/** Returns the statistics of the received game packets, updated by the protocols. */
+	cPacketStats & GetPacketStats(void) { return m_PacketStats; }
 	
 private:
 
@@ -187,6 +195,15 @@ private:
 	
 	int m_ClientViewDistance;  // The default view distance for clients; settable in Settings.ini
 
+	/** The number of bytes per tick that each client may receive before chunk streaming to it is paused; 0 = unlimited. Settable in Settings.ini */
+	int m_ClientChunkStreamBytesPerTick;
+
+	/** The maximum number of packets per second that each client may send in the game; 0 = unlimited. Settable in Settings.ini */
+	int m_MaxPacketsPerSecond;
+
+	/** Statistics of the received game packets, by packet type. */
+	cPacketStats m_PacketStats;
+
 	bool m_bIsConnected;  // true - connected false - not connected
 
 	bool m_bRestarting;
@@ -0,0 +1,97 @@
+
+// ChunkNeighborhood.cpp
+
+// Implements the cChunkNeighborhood class providing the simulators with fast access to the blocks of a chunk and its eight neighbors
+
+#include "Globals.h"
+#include "ChunkNeighborhood.h"
+#include "../Chunk.h"
+
+
+
+
+
+cChunkNeighborhood::cChunkNeighborhood(void)
+{
+	for (size_t i = 0; i < ARRAYCOUNT(m_Columns); i++)
+	{
+		m_Columns[i].m_Chunk = nullptr;
+	}
+}
+
+
+
+
+
+void cChunkNeighborhood::Init(cChunk & a_Chunk)
+{
+	for (int z = 0; z < 3; z++)
+	{
+		for (int x = 0; x < 3; x++)
+		{
+			sColumn & Column = m_Columns[z * 3 + x];
+			int RelX = (x - 1) * cChunkDef::Width;
+			int RelZ = (z - 1) * cChunkDef::Width;
+			cChunk * Chunk = a_Chunk.GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+			if ((Chunk == nullptr) || !Chunk->IsValid())
+			{
+				Column.m_Chunk = nullptr;
+				continue;
+			}
+			Column.m_Chunk = Chunk;
+			const cChunkData & Data = Chunk->GetChunkData();
+			for (int i = 0; i < NUM_SECTIONS; i++)
+			{
+				Column.m_Sections[i] = Data.GetSection(static_cast<size_t>(i));
+			}
+		}  // for x
+	}  // for z
+	ASSERT(m_Columns[CENTER].m_Chunk == &a_Chunk);
+}
+
+
+
+
+
+bool cChunkNeighborhood::GetBlockTypeMeta(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta) const
+{
+	const sColumn * Column = GetColumnAdjustCoords(a_RelX, a_RelZ);
+	if ((Column == nullptr) || (a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	const cChunkData::sChunkSection * Section = Column->m_Sections[a_RelY / SECTION_HEIGHT];
+	if (Section == nullptr)
+	{
+		a_BlockType = E_BLOCK_AIR;
+		a_BlockMeta = 0;
+		return true;
+	}
+	int Index = cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY % SECTION_HEIGHT, a_RelZ);
+	a_BlockType = Section->m_BlockTypes[Index];
+	a_BlockMeta = (Section->m_BlockMetas[Index / 2] >> ((Index & 1) * 4)) & 0x0f;
+	return true;
+}
+
+
+
+
+
+bool cChunkNeighborhood::SetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+{
+	const sColumn * Column = GetColumnAdjustCoords(a_RelX, a_RelZ);
+	if ((Column == nullptr) || (a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	Column->m_Chunk->SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta);
+
+	// Setting a block into an empty section allocates the section:
+	int SectionNum = a_RelY / SECTION_HEIGHT;
+	const_cast<sColumn *>(Column)->m_Sections[SectionNum] = Column->m_Chunk->GetChunkData().GetSection(static_cast<size_t>(SectionNum));
+	return true;
+}
+
+
+
+
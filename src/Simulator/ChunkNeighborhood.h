@@ -0,0 +1,121 @@
+
+// ChunkNeighborhood.h
+
+// Declares the cChunkNeighborhood class providing the simulators with fast access to the blocks of a chunk and its eight neighbors
+
+
+
+
+
+#pragma once
+
+#include "../BlockID.h"
+#include "../ChunkData.h"
+
+
+
+
+
+class cChunk;
+
+
+
+
+
+/** A 3x3 chunk view around the chunk being simulated, with the chunks and their sections resolved upfront.
+A simulator sets it up once per SimulateChunk() call, then reads the blocks around the simulated blocks with a couple
+of array lookups, instead of walking the chunk's neighbor pointers (or even the chunkmap) for each single block.
+The coords are relative to the center chunk and may reach up to one chunk into the neighbors.
+The view must not outlive the simulate call, the chunks may get unloaded afterwards.
+The writes go through the chunks' SetBlock(), so that the clients and the dirty flags are handled as usual.
+Any other code that may change the blocks, including the plugin hooks, needs a Refresh() afterwards. */
+class cChunkNeighborhood
+{
+public:
+
+	cChunkNeighborhood(void);
+
+	/** Resolves the chunk, its neighbors and their sections. The neighbors that are not valid are left out. */
+	void Init(cChunk & a_Chunk);
+
+	/** Resolves the chunks and their sections again, around the same center chunk.
+	Must be called after anything that may have changed the chunks' blocks behind the view's back, such as writing
+	through the world or calling plugin hooks; the cached sections may have been allocated, or freed and replaced. */
+	void Refresh(void) { Init(GetChunk()); }
+
+	/** Returns the center chunk */
+	cChunk & GetChunk(void) const { return *m_Columns[CENTER].m_Chunk; }
+
+	/** Returns the chunk containing the specified coords and adjusts the coords to be relative to it.
+	Returns nullptr if the chunk is not valid or the coords are outside the view. */
+	cChunk * GetChunkAdjustCoords(int & a_RelX, int & a_RelZ) const
+	{
+		const sColumn * Column = GetColumnAdjustCoords(a_RelX, a_RelZ);
+		return (Column == nullptr) ? nullptr : Column->m_Chunk;
+	}
+
+	/** Retrieves the block type; returns false if the block's chunk is not available or the coords are out of range */
+	bool GetBlockType(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType) const
+	{
+		const sColumn * Column = GetColumnAdjustCoords(a_RelX, a_RelZ);
+		if ((Column == nullptr) || (a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+		{
+			return false;
+		}
+		const cChunkData::sChunkSection * Section = Column->m_Sections[a_RelY / SECTION_HEIGHT];
+		a_BlockType = (Section == nullptr) ? static_cast<BLOCKTYPE>(E_BLOCK_AIR) : Section->m_BlockTypes[cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY % SECTION_HEIGHT, a_RelZ)];
+		return true;
+	}
+
+	/** Retrieves the block type and meta; returns false if the block's chunk is not available or the coords are out of range */
+	bool GetBlockTypeMeta(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta) const;
+
+	/** Sets the block through its chunk and refreshes the cached section.
+	Returns false if the block's chunk is not available or the coords are out of range. */
+	bool SetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta);
+
+protected:
+
+	static const int SECTION_HEIGHT = static_cast<int>(cChunkData::SectionHeight);
+	static const int NUM_SECTIONS = static_cast<int>(cChunkData::NumSections);
+
+	/** Index of the center chunk in m_Columns[] */
+	static const int CENTER = 4;
+
+	struct sColumn
+	{
+		/** The chunk, nullptr if not valid */
+		cChunk * m_Chunk;
+
+		/** The chunk's sections, nullptr for the unallocated ones */
+		const cChunkData::sChunkSection * m_Sections[NUM_SECTIONS];
+	} ;
+
+	/** The chunks of the view, indexed by (DiffZ + 1) * 3 + (DiffX + 1) */
+	sColumn m_Columns[9];
+
+
+	/** Returns the column containing the specified coords and adjusts the coords to be relative to it.
+	Returns nullptr if the chunk is not valid or the coords are outside the view. */
+	const sColumn * GetColumnAdjustCoords(int & a_RelX, int & a_RelZ) const
+	{
+		if ((a_RelX < -cChunkDef::Width) || (a_RelX >= 2 * cChunkDef::Width) || (a_RelZ < -cChunkDef::Width) || (a_RelZ >= 2 * cChunkDef::Width))
+		{
+			return nullptr;
+		}
+		int ColX = (a_RelX + cChunkDef::Width) / cChunkDef::Width;
+		int ColZ = (a_RelZ + cChunkDef::Width) / cChunkDef::Width;
+		const sColumn & Column = m_Columns[ColZ * 3 + ColX];
+		if (Column.m_Chunk == nullptr)
+		{
+			return nullptr;
+		}
+		a_RelX -= (ColX - 1) * cChunkDef::Width;
+		a_RelZ -= (ColZ - 1) * cChunkDef::Width;
+		return &Column;
+	}
+} ;
+
+
+
+
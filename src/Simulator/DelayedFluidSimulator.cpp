@@ -14,32 +14,6 @@
 
 
 
-////////////////////////////////////////////////////////////////////////////////
-// cDelayedFluidSimulatorChunkData::cSlot
-
-bool cDelayedFluidSimulatorChunkData::cSlot::Add(int a_RelX, int a_RelY, int a_RelZ)
-{
-	ASSERT(a_RelZ >= 0);
-	ASSERT(a_RelZ < static_cast<int>(ARRAYCOUNT(m_Blocks)));
-	
-	cCoordWithIntVector & Blocks = m_Blocks[a_RelZ];
-	int Index = cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ);
-	for (cCoordWithIntVector::const_iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
-	{
-		if (itr->Data == Index)
-		{
-			// Already present
-			return false;
-		}
-	}  // for itr - Blocks[]
-	Blocks.push_back(cCoordWithInt(a_RelX, a_RelY, a_RelZ, Index));
-	return true;
-}
-
-
-
-
-
 ////////////////////////////////////////////////////////////////////////////////
 // cDelayedFluidSimulatorChunkData:
 
@@ -136,20 +110,15 @@ void cDelayedFluidSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a
 	cDelayedFluidSimulatorChunkData * ChunkData = (cDelayedFluidSimulatorChunkData *)ChunkDataRaw;
 	cDelayedFluidSimulatorChunkData::cSlot & Slot = ChunkData->m_Slots[m_SimSlotNum];
 	
-	// Simulate all the blocks in the scheduled slot:
-	for (size_t i = 0; i < ARRAYCOUNT(Slot.m_Blocks); i++)
+	// Simulate all the blocks in the scheduled slot.
+	// Take them out first, so that any blocks re-added while simulating are queued anew rather than lost:
+	Slot.TakeBlocks(m_SimBlocks);
+	m_TotalBlocks -= static_cast<int>(m_SimBlocks.size());
+	for (std::vector<UInt16>::const_iterator itr = m_SimBlocks.begin(), end = m_SimBlocks.end(); itr != end; ++itr)
 	{
-		cCoordWithIntVector & Blocks = Slot.m_Blocks[i];
-		if (Blocks.empty())
-		{
-			continue;
-		}
-		for (cCoordWithIntVector::iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
-		{
-			SimulateBlock(a_Chunk, itr->x, itr->y, itr->z);
-		}
-		m_TotalBlocks -= (int)Blocks.size();
-		Blocks.clear();
+		int RelX, RelY, RelZ;
+		cDirtyBlockSet::UnpackBlock(*itr, RelX, RelY, RelZ);
+		SimulateBlock(a_Chunk, RelX, RelY, RelZ);
 	}
 }
 
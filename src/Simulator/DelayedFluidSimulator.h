@@ -10,6 +10,7 @@
 #pragma once
 
 #include "FluidSimulator.h"
+#include "DirtyBlockSet.h"
 
 
 
@@ -19,20 +20,8 @@ class cDelayedFluidSimulatorChunkData :
 	public cFluidSimulatorData
 {
 public:
-	class cSlot
-	{
-	public:
-		/// Returns true if the specified block is stored
-		bool HasBlock(int a_RelX, int a_RelY, int a_RelZ);
-		
-		/// Adds the specified block unless already present; returns true if added, false if the block was already present
-		bool Add(int a_RelX, int a_RelY, int a_RelZ);
-		
-		/** Array of block containers, each item stores blocks for one Z coord
-		Int param is the block index (for faster duplicate comparison in Add())
-		*/
-		cCoordWithIntVector m_Blocks[16];
-	} ;
+	/** The blocks queued for a single delay tick */
+	typedef cDirtyBlockSet cSlot;
 	
 	cDelayedFluidSimulatorChunkData(int a_TickDelay);
 	virtual ~cDelayedFluidSimulatorChunkData();
@@ -67,6 +56,9 @@ protected:
 	
 	int m_TotalBlocks;  // Statistics only: the total number of blocks currently queued
 
+	/** The blocks taken out of the slot being simulated in SimulateChunk(). Kept between the calls to reuse the memory. */
+	std::vector<UInt16> m_SimBlocks;
+
 	/*
 	Slots:
 	| 0 | 1 | ... | m_AddSlotNum | m_SimSlotNum | ... | m_TickDelay - 1 |
@@ -0,0 +1,129 @@
+
+// DirtyBlockSet.cpp
+
+// Implements the cDirtyBlockSet class representing a set of blocks within a single chunk, with constant-time duplicate checks
+
+#include "Globals.h"
+#include "DirtyBlockSet.h"
+
+
+
+
+
+// The packed block coords need exactly 16 bits:
+static_assert((cChunkDef::Width == 16) && (cChunkDef::Height == 256), "cDirtyBlockSet's block packing needs updating for the new chunk size");
+
+
+
+
+
+cDirtyBlockSet::cDirtyBlockSet(void)
+{
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		m_Sections[i] = nullptr;
+		m_SectionIdleTakes[i] = 0;
+	}
+}
+
+
+
+
+
+cDirtyBlockSet::~cDirtyBlockSet()
+{
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		delete[] m_Sections[i];
+	}
+}
+
+
+
+
+
+bool cDirtyBlockSet::Add(int a_RelX, int a_RelY, int a_RelZ)
+{
+	UInt16 Packed = PackBlock(a_RelX, a_RelY, a_RelZ);
+	UInt64 *& Section = m_Sections[a_RelY / SECTION_HEIGHT];
+	if (Section == nullptr)
+	{
+		Section = new UInt64[WORDS_PER_SECTION];
+		memset(Section, 0, sizeof(UInt64) * WORDS_PER_SECTION);
+	}
+
+	int Bit = Packed & 0x0fff;
+	UInt64 Mask = 1ULL << (Bit & 63);
+	UInt64 & Word = Section[Bit >> 6];
+	if ((Word & Mask) != 0)
+	{
+		// Already present
+		return false;
+	}
+	Word |= Mask;
+	m_Blocks.push_back(Packed);
+	return true;
+}
+
+
+
+
+
+bool cDirtyBlockSet::HasBlock(int a_RelX, int a_RelY, int a_RelZ) const
+{
+	UInt16 Packed = PackBlock(a_RelX, a_RelY, a_RelZ);
+	const UInt64 * Section = m_Sections[a_RelY / SECTION_HEIGHT];
+	if (Section == nullptr)
+	{
+		return false;
+	}
+	int Bit = Packed & 0x0fff;
+	return ((Section[Bit >> 6] & (1ULL << (Bit & 63))) != 0);
+}
+
+
+
+
+
+void cDirtyBlockSet::TakeBlocks(std::vector<UInt16> & a_Blocks)
+{
+	a_Blocks.clear();
+	std::swap(a_Blocks, m_Blocks);
+	std::sort(a_Blocks.begin(), a_Blocks.end());
+
+	// Clear only the words holding the taken bits; all the bits in such a word belong to the taken blocks.
+	// The bitsets stay allocated for the next Add(), so that an ongoing flood doesn't reallocate them every tick:
+	bool IsUsed[NUM_SECTIONS] = {};
+	for (auto Packed: a_Blocks)
+	{
+		int SectionIdx = Packed >> 12;
+		int Bit = Packed & 0x0fff;
+		m_Sections[SectionIdx][Bit >> 6] = 0;
+		IsUsed[SectionIdx] = true;
+	}
+
+	// Release the bitsets that have stayed empty for a while, so that a chunk with a settled flood doesn't keep the memory:
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		if (m_Sections[i] == nullptr)
+		{
+			continue;
+		}
+		if (IsUsed[i])
+		{
+			m_SectionIdleTakes[i] = 0;
+			continue;
+		}
+		m_SectionIdleTakes[i] += 1;
+		if (m_SectionIdleTakes[i] > MAX_IDLE_TAKES)
+		{
+			delete[] m_Sections[i];
+			m_Sections[i] = nullptr;
+			m_SectionIdleTakes[i] = 0;
+		}
+	}
+}
+
+
+
+
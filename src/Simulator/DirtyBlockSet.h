@@ -0,0 +1,90 @@
+
+// DirtyBlockSet.h
+
+// Declares the cDirtyBlockSet class representing a set of blocks within a single chunk, with constant-time duplicate checks
+
+
+
+
+
+#pragma once
+
+#include "../ChunkDef.h"
+
+
+
+
+
+/** A set of blocks within a single chunk, used by the simulators to queue the blocks to be simulated.
+Each 16-block-high section of the chunk has its own bitset, allocated upon adding the first block in the section,
+so that checking for a duplicate is a single bit test regardless of how many blocks are queued. Next to the bits,
+the set keeps a compact list of the queued blocks, so that emptying the set only touches the queued blocks.
+The blocks are taken out sorted in the block order (Y, Z, X), which walks the chunk's block arrays forward. */
+class cDirtyBlockSet
+{
+public:
+
+	cDirtyBlockSet(void);
+	~cDirtyBlockSet();
+
+	/** Adds the specified block unless already present; returns true if added, false if the block was already present */
+	bool Add(int a_RelX, int a_RelY, int a_RelZ);
+
+	/** Returns true if the specified block is stored */
+	bool HasBlock(int a_RelX, int a_RelY, int a_RelZ) const;
+
+	/** Returns the number of the stored blocks */
+	size_t GetNumBlocks(void) const { return m_Blocks.size(); }
+
+	/** Moves all the blocks, packed and sorted in the block order, into a_Blocks, and empties the set.
+	The previous contents of a_Blocks is discarded, but its memory is reused. Use UnpackBlock() to get the coords. */
+	void TakeBlocks(std::vector<UInt16> & a_Blocks);
+
+	/** Returns the coords of a block packed by TakeBlocks() */
+	static void UnpackBlock(UInt16 a_Packed, int & a_RelX, int & a_RelY, int & a_RelZ)
+	{
+		a_RelX = a_Packed & 0x0f;
+		a_RelZ = (a_Packed >> 4) & 0x0f;
+		a_RelY = a_Packed >> 8;
+	}
+
+protected:
+
+	static const int SECTION_HEIGHT = 16;
+	static const int NUM_SECTIONS = cChunkDef::Height / SECTION_HEIGHT;
+	static const int WORDS_PER_SECTION = cChunkDef::Width * cChunkDef::Width * SECTION_HEIGHT / 64;
+
+
+	/** The number of consecutive TakeBlocks() calls that found a section empty, after which the section's bitset is freed.
+	Keeps the bitsets of a chunk with an ongoing flood allocated, while a chunk whose flood has settled doesn't keep the memory. */
+	static const int MAX_IDLE_TAKES = 20;
+
+
+	/** The bitsets of the queued blocks, one per section, indexed by the packed coords within the section.
+	nullptr for the sections that haven't had any queued blocks for a while. */
+	UInt64 * m_Sections[NUM_SECTIONS];
+
+	/** The number of consecutive TakeBlocks() calls that found each allocated section empty */
+	int m_SectionIdleTakes[NUM_SECTIONS];
+
+	/** The queued blocks, packed, in the order of adding */
+	std::vector<UInt16> m_Blocks;
+
+
+	/** Returns the block coords packed into a single number; the packed numbers sort in the block order. */
+	static UInt16 PackBlock(int a_RelX, int a_RelY, int a_RelZ)
+	{
+		ASSERT((a_RelX >= 0) && (a_RelX < cChunkDef::Width));
+		ASSERT((a_RelY >= 0) && (a_RelY < cChunkDef::Height));
+		ASSERT((a_RelZ >= 0) && (a_RelZ < cChunkDef::Width));
+		return static_cast<UInt16>((a_RelY << 8) | (a_RelZ << 4) | a_RelX);
+	}
+
+	// The set owns the section bitsets, it cannot be copied:
+	cDirtyBlockSet(const cDirtyBlockSet &) = delete;
+	cDirtyBlockSet & operator =(const cDirtyBlockSet &) = delete;
+} ;
+
+
+
+
@@ -2,6 +2,7 @@
 #include "Globals.h"  // NOTE: MSVC stupidness requires this to be the same across all modules
 
 #include "FireSimulator.h"
+#include "ChunkNeighborhood.h"
 #include "../World.h"
 #include "../BlockID.h"
 #include "../Defines.h"
@@ -91,6 +92,14 @@ cFireSimulator::~cFireSimulator()
 void cFireSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk)
 {
 	cCoordWithIntList & Data = a_Chunk->GetFireSimulatorData();
+	if (Data.empty())
+	{
+		return;
+	}
+
+	// Resolve the neighbor chunks once for all the fire blocks in the chunk:
+	cChunkNeighborhood Area;
+	Area.Init(*a_Chunk);
 
 	int NumMSecs = static_cast<int>(a_Dt.count());
 	for (cCoordWithIntList::iterator itr = Data.begin(); itr != Data.end();)
@@ -111,7 +120,7 @@ void cFireSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX,
 		}
 
 		// Try to spread the fire:
-		TrySpreadFire(a_Chunk, itr->x, itr->y, itr->z);
+		TrySpreadFire(Area, itr->x, itr->y, itr->z);
 
 		itr->Data -= NumMSecs;
 		if (itr->Data >= 0)
@@ -134,8 +143,8 @@ void cFireSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX,
 			FLOG("FS: Fire at {%d, %d, %d} burnt out, removing the fire block",
 				itr->x + a_ChunkX * cChunkDef::Width, itr->y, itr->z + a_ChunkZ * cChunkDef::Width
 			);
-			a_Chunk->SetBlock(itr->x, itr->y, itr->z, E_BLOCK_AIR, 0);
-			RemoveFuelNeighbors(a_Chunk, itr->x, itr->y, itr->z);
+			Area.SetBlock(itr->x, itr->y, itr->z, E_BLOCK_AIR, 0);
+			RemoveFuelNeighbors(Area, itr->x, itr->y, itr->z);
 			itr = Data.erase(itr);
 			continue;
 		}
@@ -144,7 +153,7 @@ void cFireSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX,
 		{
 			a_Chunk->SetMeta(x, y, z, BlockMeta + 1);
 		}
-		itr->Data = GetBurnStepTime(a_Chunk, itr->x, itr->y, itr->z);  // TODO: Add some randomness into this
+		itr->Data = GetBurnStepTime(Area, itr->x, itr->y, itr->z);  // TODO: Add some randomness into this
 	}  // for itr - Data[]
 }
 
@@ -252,12 +261,12 @@ void cFireSimulator::AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk *
 
 
 
-int cFireSimulator::GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+int cFireSimulator::GetBurnStepTime(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ)
 {
 	bool IsBlockBelowSolid = false;
-	if (a_RelY > 0)
+	BLOCKTYPE BlockBelow;
+	if (a_Area.GetBlockType(a_RelX, a_RelY - 1, a_RelZ, BlockBelow))
 	{
-		BLOCKTYPE BlockBelow = a_Chunk->GetBlock(a_RelX, a_RelY - 1, a_RelZ);
 		if (DoesBurnForever(BlockBelow))
 		{
 			// Is burning atop of netherrack, burn forever (re-check in 10 sec)
@@ -272,9 +281,8 @@ int cFireSimulator::GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, in
 	
 	for (size_t i = 0; i < ARRAYCOUNT(gCrossCoords); i++)
 	{
-		BLOCKTYPE  BlockType;
-		NIBBLETYPE BlockMeta;
-		if (a_Chunk->UnboundedRelGetBlock(a_RelX + gCrossCoords[i].x, a_RelY, a_RelZ + gCrossCoords[i].z, BlockType, BlockMeta))
+		BLOCKTYPE BlockType;
+		if (a_Area.GetBlockType(a_RelX + gCrossCoords[i].x, a_RelY, a_RelZ + gCrossCoords[i].z, BlockType))
 		{
 			if (IsFuel(BlockType))
 			{
@@ -288,7 +296,7 @@ int cFireSimulator::GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, in
 		// Checked through everything, nothing was flammable
 		// If block below isn't solid, we can't have fire, it would be a non-fueled fire
 		// SetBlock just to make sure fire doesn't spawn
-		a_Chunk->SetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_AIR, 0);
+		a_Area.SetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_AIR, 0);
 		return 0;
 	}
 	return m_BurnStepTimeNonfuel;
@@ -298,7 +306,7 @@ int cFireSimulator::GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, in
 
 
 
-void cFireSimulator::TrySpreadFire(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+void cFireSimulator::TrySpreadFire(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ)
 {
 	/*
 	if (m_World.GetTickRandomNumber(10000) > 100)
@@ -325,21 +333,23 @@ void cFireSimulator::TrySpreadFire(cChunk * a_Chunk, int a_RelX, int a_RelY, int
 				// Start the fire in the neighbor {x, y, z}
 				/*
 				FLOG("FS: Trying to start fire at {%d, %d, %d}.",
-					x + a_Chunk->GetPosX() * cChunkDef::Width, y, z + a_Chunk->GetPosZ() * cChunkDef::Width
+					x + a_Area.GetChunk().GetPosX() * cChunkDef::Width, y, z + a_Area.GetChunk().GetPosZ() * cChunkDef::Width
 				);
 				*/
-				if (CanStartFireInBlock(a_Chunk, x, y, z))
+				if (CanStartFireInBlock(a_Area, x, y, z))
 				{
-					int a_PosX = x + a_Chunk->GetPosX() * cChunkDef::Width;
-					int a_PosZ = z + a_Chunk->GetPosZ() * cChunkDef::Width;
+					int a_PosX = x + a_Area.GetChunk().GetPosX() * cChunkDef::Width;
+					int a_PosZ = z + a_Area.GetChunk().GetPosZ() * cChunkDef::Width;
 					
-					if (cRoot::Get()->GetPluginManager()->CallHookBlockSpread(m_World, a_PosX, y, a_PosZ, ssFireSpread))
+					bool IsCancelled = cRoot::Get()->GetPluginManager()->CallHookBlockSpread(m_World, a_PosX, y, a_PosZ, ssFireSpread);
+					a_Area.Refresh();  // The plugins may have changed the blocks
+					if (IsCancelled)
 					{
 						return;
 					}
 					
 					FLOG("FS: Starting new fire at {%d, %d, %d}.", a_PosX, y, a_PosZ);
-					a_Chunk->UnboundedRelSetBlock(x, y, z, E_BLOCK_FIRE, 0);
+					a_Area.SetBlock(x, y, z, E_BLOCK_FIRE, 0);
 				}
 			}  // for y
 		}  // for z
@@ -350,45 +360,45 @@ void cFireSimulator::TrySpreadFire(cChunk * a_Chunk, int a_RelX, int a_RelY, int
 
 
 
-void cFireSimulator::RemoveFuelNeighbors(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+void cFireSimulator::RemoveFuelNeighbors(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ)
 {
+	int BaseX = a_Area.GetChunk().GetPosX() * cChunkDef::Width;
+	int BaseZ = a_Area.GetChunk().GetPosZ() * cChunkDef::Width;
 	for (size_t i = 0; i < ARRAYCOUNT(gNeighborCoords); i++)
 	{
 		BLOCKTYPE  BlockType;
 		int X = a_RelX + gNeighborCoords[i].x;
+		int Y = a_RelY + gNeighborCoords[i].y;
 		int Z = a_RelZ + gNeighborCoords[i].z;
-
-		cChunkPtr Neighbour = a_Chunk->GetRelNeighborChunkAdjustCoords(X, Z);
-		if (Neighbour == nullptr)
+		if (!a_Area.GetBlockType(X, Y, Z, BlockType) || !IsFuel(BlockType))
 		{
 			continue;
 		}
-		BlockType = Neighbour->GetBlock(X, a_RelY + gNeighborCoords[i].y, Z);
 
-		if (!IsFuel(BlockType))
-		{
-			continue;
-		}
-
-		int AbsX = (Neighbour->GetPosX() * cChunkDef::Width) + X;
-		int Y = a_RelY + gNeighborCoords[i].y;
-		int AbsZ = (Neighbour->GetPosZ() * cChunkDef::Width) + Z;
+		int AbsX = BaseX + X;
+		int AbsZ = BaseZ + Z;
 
 		if (BlockType == E_BLOCK_TNT)
 		{
 			m_World.SpawnPrimedTNT(AbsX, Y, AbsZ, 0);
-			Neighbour->SetBlock(X, Y, Z, E_BLOCK_AIR, 0);
+			a_Area.Refresh();  // The spawning hooks may have changed the blocks
+			a_Area.SetBlock(X, Y, Z, E_BLOCK_AIR, 0);
 			return;
 		}
 
 		bool ShouldReplaceFuel = (m_World.GetTickRandomNumber(MAX_CHANCE_REPLACE_FUEL) < m_ReplaceFuelChance);
-		if (ShouldReplaceFuel && !cRoot::Get()->GetPluginManager()->CallHookBlockSpread(m_World, AbsX, Y, AbsZ, ssFireSpread))
+		if (ShouldReplaceFuel)
+		{
+			ShouldReplaceFuel = !cRoot::Get()->GetPluginManager()->CallHookBlockSpread(m_World, AbsX, Y, AbsZ, ssFireSpread);
+			a_Area.Refresh();  // The plugins may have changed the blocks
+		}
+		if (ShouldReplaceFuel)
 		{
-			Neighbour->SetBlock(X, Y, Z, E_BLOCK_FIRE, 0);
+			a_Area.SetBlock(X, Y, Z, E_BLOCK_FIRE, 0);
 		}
 		else
 		{
-			Neighbour->SetBlock(X, Y, Z, E_BLOCK_AIR, 0);
+			a_Area.SetBlock(X, Y, Z, E_BLOCK_AIR, 0);
 		}
 	}  // for i - Coords[]
 }
@@ -397,11 +407,10 @@ void cFireSimulator::RemoveFuelNeighbors(cChunk * a_Chunk, int a_RelX, int a_Rel
 
 
 
-bool cFireSimulator::CanStartFireInBlock(cChunk * a_NearChunk, int a_RelX, int a_RelY, int a_RelZ)
+bool cFireSimulator::CanStartFireInBlock(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ)
 {
-	BLOCKTYPE  BlockType;
-	NIBBLETYPE BlockMeta;
-	if (!a_NearChunk->UnboundedRelGetBlock(a_RelX, a_RelY, a_RelZ, BlockType, BlockMeta))
+	BLOCKTYPE BlockType;
+	if (!a_Area.GetBlockType(a_RelX, a_RelY, a_RelZ, BlockType))
 	{
 		// The chunk is not accessible
 		return false;
@@ -415,7 +424,7 @@ bool cFireSimulator::CanStartFireInBlock(cChunk * a_NearChunk, int a_RelX, int a
 	
 	for (size_t i = 0; i < ARRAYCOUNT(gNeighborCoords); i++)
 	{
-		if (!a_NearChunk->UnboundedRelGetBlock(a_RelX + gNeighborCoords[i].x, a_RelY + gNeighborCoords[i].y, a_RelZ + gNeighborCoords[i].z, BlockType, BlockMeta))
+		if (!a_Area.GetBlockType(a_RelX + gNeighborCoords[i].x, a_RelY + gNeighborCoords[i].y, a_RelZ + gNeighborCoords[i].z, BlockType))
 		{
 			// Neighbor inaccessible, skip it while evaluating
 			continue;
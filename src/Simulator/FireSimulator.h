@@ -8,6 +8,12 @@
 
 
 
+class cChunkNeighborhood;
+
+
+
+
+
 /** The fire simulator takes care of the fire blocks.
 It periodically increases their meta ("steps") until they "burn out"; it also supports the forever burning netherrack.
 Each individual fire block gets stored in per-chunk data; that list is then used for fast retrieval.
@@ -47,20 +53,19 @@ protected:
 	virtual void AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk) override;
 	
 	/// Returns the time [msec] after which the specified fire block is stepped again; based on surrounding fuels
-	int GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
+	int GetBurnStepTime(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ);
 	
 	/// Tries to spread fire to a neighborhood of the specified block
-	void TrySpreadFire(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
+	void TrySpreadFire(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ);
 	
 	/// Removes all burnable blocks neighboring the specified block
-	void RemoveFuelNeighbors(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
+	void RemoveFuelNeighbors(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ);
 	
 	/** Returns true if a fire can be started in the specified block,
 	that is, it is an air block and has fuel next to it.
-	Note that a_NearChunk may be a chunk neighbor to the block specified!
-	The coords are relative to a_NearChunk but not necessarily in it.
+	The coords are relative to a_Area's center chunk but not necessarily in it.
 	*/
-	bool CanStartFireInBlock(cChunk * a_NearChunk, int a_RelX, int a_RelY, int a_RelZ);
+	bool CanStartFireInBlock(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ);
 } ;
 
 
@@ -0,0 +1,1391 @@
+
+// GraphRedstoneSimulator.cpp
+
+// Implements the cGraphRedstoneSimulator class that compiles the redstone circuits into a graph of nodes and edges,
+// and propagates the power changes along the edges only
+
+#include "Globals.h"
+#include "GraphRedstoneSimulator.h"
+#include "IncrementalRedstoneSimulator.h"
+#include "DirtyBlockSet.h"
+#include "Chunk.h"
+#include "World.h"
+#include "Blocks/GetHandlerCompileTimeTemplate.h"
+#include "Blocks/BlockTorch.h"
+#include "Blocks/BlockLever.h"
+#include "Blocks/BlockButton.h"
+#include "Blocks/BlockDoor.h"
+#include "Blocks/BlockPiston.h"
+#include "Blocks/ChunkInterface.h"
+
+
+
+
+
+/** The offsets of the six neighbors, followed by the eight diagonal neighbors one level up and down, through which the wires connect */
+static const Vector3i g_NeighborOffsets[] =
+{
+	Vector3i( 1,  0,  0),
+	Vector3i(-1,  0,  0),
+	Vector3i( 0,  1,  0),
+	Vector3i( 0, -1,  0),
+	Vector3i( 0,  0,  1),
+	Vector3i( 0,  0, -1),
+	Vector3i( 1,  1,  0),
+	Vector3i(-1,  1,  0),
+	Vector3i( 0,  1,  1),
+	Vector3i( 0,  1, -1),
+	Vector3i( 1, -1,  0),
+	Vector3i(-1, -1,  0),
+	Vector3i( 0, -1,  1),
+	Vector3i( 0, -1, -1),
+} ;
+
+static const size_t NUM_ADJACENT_OFFSETS = 6;
+static const size_t NUM_WIRE_OFFSETS = ARRAYCOUNT(g_NeighborOffsets);
+
+
+
+
+
+/** Returns the block type with the on / off variants mapped to a single one, so that switching doesn't count as a change */
+static BLOCKTYPE GetBaseBlockType(BLOCKTYPE a_BlockType)
+{
+	switch (a_BlockType)
+	{
+		case E_BLOCK_REDSTONE_TORCH_ON:    return E_BLOCK_REDSTONE_TORCH_OFF;
+		case E_BLOCK_REDSTONE_REPEATER_ON: return E_BLOCK_REDSTONE_REPEATER_OFF;
+		case E_BLOCK_REDSTONE_LAMP_ON:     return E_BLOCK_REDSTONE_LAMP_OFF;
+		default:                           return a_BlockType;
+	}
+}
+
+
+
+
+
+/** Returns true if a wire next to the block connects to it */
+static bool IsWireConnectable(BLOCKTYPE a_BlockType)
+{
+	switch (a_BlockType)
+	{
+		case E_BLOCK_BLOCK_OF_REDSTONE:
+		case E_BLOCK_DAYLIGHT_SENSOR:
+		case E_BLOCK_DETECTOR_RAIL:
+		case E_BLOCK_HEAVY_WEIGHTED_PRESSURE_PLATE:
+		case E_BLOCK_LEVER:
+		case E_BLOCK_LIGHT_WEIGHTED_PRESSURE_PLATE:
+		case E_BLOCK_REDSTONE_REPEATER_OFF:
+		case E_BLOCK_REDSTONE_REPEATER_ON:
+		case E_BLOCK_REDSTONE_TORCH_OFF:
+		case E_BLOCK_REDSTONE_TORCH_ON:
+		case E_BLOCK_REDSTONE_WIRE:
+		case E_BLOCK_STONE_BUTTON:
+		case E_BLOCK_STONE_PRESSURE_PLATE:
+		case E_BLOCK_WOODEN_BUTTON:
+		case E_BLOCK_WOODEN_PRESSURE_PLATE:
+		{
+			return true;
+		}
+		default: return false;
+	}
+}
+
+
+
+
+
+/** Returns true if the block at the specified coords, possibly in a neighboring chunk, is solid */
+static bool IsSolidAt(cChunk & a_Chunk, const Vector3i & a_RelPos)
+{
+	BLOCKTYPE BlockType;
+	if (!a_Chunk.UnboundedRelGetBlockType(a_RelPos.x, a_RelPos.y, a_RelPos.z, BlockType))
+	{
+		return false;
+	}
+	return cBlockInfo::IsSolid(BlockType);
+}
+
+
+
+
+
+/** Returns true if the wire at a_WirePos connects to the block in the specified horizontal direction,
+either on the same level, or through a wire one level up or down */
+static bool DoesWireConnectTo(cChunk & a_Chunk, const Vector3i & a_WirePos, const Vector3i & a_Dir)
+{
+	Vector3i Pos = a_WirePos + a_Dir;
+	BLOCKTYPE BlockType;
+	if (!a_Chunk.UnboundedRelGetBlockType(Pos.x, Pos.y, Pos.z, BlockType))
+	{
+		return false;
+	}
+	if (IsWireConnectable(BlockType))
+	{
+		return true;
+	}
+	if (cBlockInfo::IsSolid(BlockType))
+	{
+		// A wire on top of the block connects, unless the block above this wire cuts it:
+		BLOCKTYPE Above;
+		return (
+			a_Chunk.UnboundedRelGetBlockType(Pos.x, Pos.y + 1, Pos.z, BlockType) && (BlockType == E_BLOCK_REDSTONE_WIRE) &&
+			a_Chunk.UnboundedRelGetBlockType(a_WirePos.x, a_WirePos.y + 1, a_WirePos.z, Above) && !cBlockInfo::IsSolid(Above)
+		);
+	}
+	return (a_Chunk.UnboundedRelGetBlockType(Pos.x, Pos.y - 1, Pos.z, BlockType) && (BlockType == E_BLOCK_REDSTONE_WIRE));
+}
+
+
+
+
+
+/** Returns the directions the wire at the specified position points to, as eRedstoneDirection flags.
+A wire with no connections is a dot that points everywhere, a wire with a single connection is a line that points
+along that connection, a wire with more connections points to its connections only. */
+static int GetWireDirs(cChunk & a_Chunk, const Vector3i & a_Pos)
+{
+	int Dirs = cIncrementalRedstoneSimulator::REDSTONE_NONE;
+	int NumConnections = 0;
+	if (DoesWireConnectTo(a_Chunk, a_Pos, Vector3i(1, 0, 0)))
+	{
+		Dirs |= cIncrementalRedstoneSimulator::REDSTONE_X_POS;
+		NumConnections += 1;
+	}
+	if (DoesWireConnectTo(a_Chunk, a_Pos, Vector3i(-1, 0, 0)))
+	{
+		Dirs |= cIncrementalRedstoneSimulator::REDSTONE_X_NEG;
+		NumConnections += 1;
+	}
+	if (DoesWireConnectTo(a_Chunk, a_Pos, Vector3i(0, 0, 1)))
+	{
+		Dirs |= cIncrementalRedstoneSimulator::REDSTONE_Z_POS;
+		NumConnections += 1;
+	}
+	if (DoesWireConnectTo(a_Chunk, a_Pos, Vector3i(0, 0, -1)))
+	{
+		Dirs |= cIncrementalRedstoneSimulator::REDSTONE_Z_NEG;
+		NumConnections += 1;
+	}
+
+	if (NumConnections == 1)
+	{
+		// A line, points both ways along its axis:
+		if ((Dirs & (cIncrementalRedstoneSimulator::REDSTONE_X_POS | cIncrementalRedstoneSimulator::REDSTONE_X_NEG)) != 0)
+		{
+			Dirs = cIncrementalRedstoneSimulator::REDSTONE_X_POS | cIncrementalRedstoneSimulator::REDSTONE_X_NEG;
+		}
+		else
+		{
+			Dirs = cIncrementalRedstoneSimulator::REDSTONE_Z_POS | cIncrementalRedstoneSimulator::REDSTONE_Z_NEG;
+		}
+	}
+	return Dirs;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cGraphRedstoneSimulator::cChunkData:
+
+/** The per-chunk data: the nodes, the blocks waiting to be compiled, the evaluation queue and the timing wheel */
+class cGraphRedstoneSimulator::cChunkData :
+	public cRedstoneSimulatorChunkData
+{
+public:
+
+	cChunkData(void) :
+		m_WheelPos(0)
+	{
+	}
+
+	/** The nodes in the chunk, keyed by MakeKey() of their relative coords */
+	std::unordered_map<int, sNode> m_Nodes;
+
+	/** The blocks whose node needs to be (re)compiled */
+	cDirtyBlockSet m_ToCompile;
+
+	/** The keys of the nodes waiting for evaluation */
+	std::vector<int> m_Queue;
+
+	/** The keys of the source nodes that need polling each tick */
+	std::vector<int> m_Polled;
+
+	/** The timing wheel: the slot for the current tick is m_Wheel[m_WheelPos]. Allocated upon the first scheduled change. */
+	std::vector<std::vector<sScheduledChange>> m_Wheel;
+
+	int m_WheelPos;
+} ;
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cGraphRedstoneSimulator::sNode:
+
+cGraphRedstoneSimulator::sNode::sNode(void) :
+	m_Type(ntNone),
+	m_BlockType(E_BLOCK_AIR),
+	m_Meta(0),
+	m_WireDirs(0),
+	m_Power(0),
+	m_StrongPower(0),
+	m_IsQueued(false),
+	m_PendingState(-1)
+{
+}
+
+
+
+
+
+bool cGraphRedstoneSimulator::sNode::IsSameDescription(const sNode & a_Other) const
+{
+	if ((m_Type != a_Other.m_Type) || (m_Meta != a_Other.m_Meta) || (m_WireDirs != a_Other.m_WireDirs))
+	{
+		return false;
+	}
+
+	// Any solid block conducts the same way:
+	return ((m_Type == ntSolid) || (GetBaseBlockType(m_BlockType) == GetBaseBlockType(a_Other.m_BlockType)));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cGraphRedstoneSimulator:
+
+cGraphRedstoneSimulator::cGraphRedstoneSimulator(cWorld & a_World) :
+	super(a_World)
+{
+}
+
+
+
+
+
+cRedstoneSimulatorChunkData * cGraphRedstoneSimulator::CreateChunkData()
+{
+	return new cChunkData;
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk)
+{
+	UNUSED(a_Dt);
+	UNUSED(a_ChunkX);
+	UNUSED(a_ChunkZ);
+
+	cChunkData * Data = static_cast<cChunkData *>(a_Chunk->GetRedstoneSimulatorData());
+	if ((Data == nullptr) || (Data->m_Nodes.empty() && (Data->m_ToCompile.GetNumBlocks() == 0)))
+	{
+		return;
+	}
+
+	CompileNodes(*a_Chunk, *Data);
+	ApplyScheduledChanges(*a_Chunk, *Data);
+	PollSources(*a_Chunk, *Data);
+
+	// Evaluate the queued nodes until the changes settle; the evaluations may queue further nodes:
+	int NumEvaluations = 0;
+	while (!Data->m_Queue.empty())
+	{
+		m_EvalKeys.clear();
+		std::swap(m_EvalKeys, Data->m_Queue);
+		for (size_t i = 0; i < m_EvalKeys.size(); i++)
+		{
+			if (NumEvaluations >= MAX_EVALUATIONS)
+			{
+				// Leave the rest for the next tick; the nodes are still marked as queued:
+				Data->m_Queue.insert(Data->m_Queue.end(), m_EvalKeys.begin() + static_cast<ptrdiff_t>(i), m_EvalKeys.end());
+				return;
+			}
+			auto itr = Data->m_Nodes.find(m_EvalKeys[i]);
+			if (itr == Data->m_Nodes.end())
+			{
+				continue;
+			}
+			itr->second.m_IsQueued = false;
+			Evaluate(*a_Chunk, *Data, m_EvalKeys[i], KeyToPos(m_EvalKeys[i]), itr->second);
+			NumEvaluations += 1;
+		}
+	}
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk)
+{
+	if ((a_Chunk == nullptr) || !a_Chunk->IsValid())
+	{
+		return;
+	}
+	QueueCompile(*a_Chunk, Vector3i(a_BlockX - a_Chunk->GetPosX() * cChunkDef::Width, a_BlockY, a_BlockZ - a_Chunk->GetPosZ() * cChunkDef::Width));
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::QueueCompile(cChunk & a_Chunk, const Vector3i & a_RelPos)
+{
+	if ((a_RelPos.y < 0) || (a_RelPos.y >= cChunkDef::Height))
+	{
+		return;
+	}
+	int RelX = a_RelPos.x;
+	int RelZ = a_RelPos.z;
+	cChunk * Chunk = a_Chunk.GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+	if ((Chunk == nullptr) || !Chunk->IsValid())
+	{
+		return;
+	}
+	cChunkData * Data = static_cast<cChunkData *>(Chunk->GetRedstoneSimulatorData());
+	if (Data == nullptr)
+	{
+		return;
+	}
+
+	// Only the existing nodes and the blocks that may become nodes are worth compiling:
+	if (Data->m_Nodes.find(MakeKey(RelX, a_RelPos.y, RelZ)) == Data->m_Nodes.end())
+	{
+		BLOCKTYPE BlockType = Chunk->GetBlock(RelX, a_RelPos.y, RelZ);
+		if (!IsComponent(BlockType) && !cBlockInfo::FullyOccupiesVoxel(BlockType))
+		{
+			return;
+		}
+	}
+	Data->m_ToCompile.Add(RelX, a_RelPos.y, RelZ);
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::CompileNodes(cChunk & a_Chunk, cChunkData & a_Data)
+{
+	// Changing a node's description recompiles its neighbors; repeat until the descriptions settle:
+	for (int Pass = 0; (Pass < MAX_COMPILE_PASSES) && (a_Data.m_ToCompile.GetNumBlocks() > 0); Pass++)
+	{
+		a_Data.m_ToCompile.TakeBlocks(m_CompileBlocks);
+		for (auto Packed : m_CompileBlocks)
+		{
+			Vector3i RelPos;
+			cDirtyBlockSet::UnpackBlock(Packed, RelPos.x, RelPos.y, RelPos.z);
+			int Key = MakeKey(RelPos);
+			auto itr = a_Data.m_Nodes.find(Key);
+
+			sNode Node;
+			if (!DescribeNode(a_Chunk, RelPos, Node))
+			{
+				if (itr != a_Data.m_Nodes.end())
+				{
+					a_Data.m_Polled.erase(std::remove(a_Data.m_Polled.begin(), a_Data.m_Polled.end(), Key), a_Data.m_Polled.end());
+					a_Data.m_Nodes.erase(itr);
+					QueueCompileAround(a_Chunk, RelPos);
+				}
+				continue;
+			}
+
+			bool IsPolled = ((Node.m_Type == ntPlate) || (Node.m_Type == ntDaylight) || (Node.m_Type == ntDetectorRail));
+			if (itr == a_Data.m_Nodes.end())
+			{
+				itr = a_Data.m_Nodes.insert(std::make_pair(Key, Node)).first;
+				if (IsPolled)
+				{
+					a_Data.m_Polled.push_back(Key);
+				}
+				QueueCompileAround(a_Chunk, RelPos);
+			}
+			else if (!itr->second.IsSameDescription(Node))
+			{
+				// Replace the node, dropping its pending state change; keep it in the queue if it is there:
+				bool WasPolled = ((itr->second.m_Type == ntPlate) || (itr->second.m_Type == ntDaylight) || (itr->second.m_Type == ntDetectorRail));
+				Node.m_IsQueued = itr->second.m_IsQueued;
+				itr->second = Node;
+				if (WasPolled && !IsPolled)
+				{
+					a_Data.m_Polled.erase(std::remove(a_Data.m_Polled.begin(), a_Data.m_Polled.end(), Key), a_Data.m_Polled.end());
+				}
+				else if (IsPolled && !WasPolled)
+				{
+					a_Data.m_Polled.push_back(Key);
+				}
+				QueueCompileAround(a_Chunk, RelPos);
+			}
+
+			// The neighbors may have changed, rebuild the edges and re-evaluate even an unchanged node:
+			BuildEdges(a_Chunk, RelPos, itr->second);
+			if (!itr->second.m_IsQueued)
+			{
+				itr->second.m_IsQueued = true;
+				a_Data.m_Queue.push_back(Key);
+			}
+		}  // for Packed - m_CompileBlocks[]
+	}
+}
+
+
+
+
+
+bool cGraphRedstoneSimulator::DescribeNode(cChunk & a_Chunk, const Vector3i & a_RelPos, sNode & a_Node)
+{
+	BLOCKTYPE BlockType;
+	NIBBLETYPE Meta;
+	a_Chunk.GetBlockTypeMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z, BlockType, Meta);
+	a_Node.m_BlockType = BlockType;
+
+	switch (BlockType)
+	{
+		case E_BLOCK_BLOCK_OF_REDSTONE:
+		{
+			a_Node.m_Type = ntConstant;
+			a_Node.m_Power = 15;
+			return true;
+		}
+		case E_BLOCK_LEVER:
+		case E_BLOCK_STONE_BUTTON:
+		case E_BLOCK_WOODEN_BUTTON:
+		{
+			// The meta includes the on / off bit, toggling recompiles the node and so re-evaluates its neighbors
+			a_Node.m_Type = ntLever;
+			a_Node.m_Meta = Meta;
+			a_Node.m_Power = ((Meta & 0x08) != 0) ? 15 : 0;
+			return true;
+		}
+		case E_BLOCK_HEAVY_WEIGHTED_PRESSURE_PLATE:
+		case E_BLOCK_LIGHT_WEIGHTED_PRESSURE_PLATE:
+		case E_BLOCK_STONE_PRESSURE_PLATE:
+		case E_BLOCK_WOODEN_PRESSURE_PLATE:
+		{
+			a_Node.m_Type = ntPlate;
+			return true;
+		}
+		case E_BLOCK_DAYLIGHT_SENSOR:
+		{
+			a_Node.m_Type = ntDaylight;
+			return true;
+		}
+		case E_BLOCK_DETECTOR_RAIL:
+		{
+			a_Node.m_Type = ntDetectorRail;
+			a_Node.m_Power = ((Meta & 0x08) != 0) ? 15 : 0;
+			return true;
+		}
+		case E_BLOCK_REDSTONE_TORCH_OFF:
+		case E_BLOCK_REDSTONE_TORCH_ON:
+		{
+			a_Node.m_Type = ntTorch;
+			a_Node.m_Meta = Meta;
+			a_Node.m_Power = (BlockType == E_BLOCK_REDSTONE_TORCH_ON) ? 15 : 0;
+			return true;
+		}
+		case E_BLOCK_REDSTONE_WIRE:
+		{
+			a_Node.m_Type = ntWire;
+			a_Node.m_WireDirs = GetWireDirs(a_Chunk, a_RelPos);
+			a_Node.m_Power = Meta;
+			return true;
+		}
+		case E_BLOCK_REDSTONE_REPEATER_OFF:
+		case E_BLOCK_REDSTONE_REPEATER_ON:
+		{
+			a_Node.m_Type = ntRepeater;
+			a_Node.m_Meta = Meta;
+			a_Node.m_Power = (BlockType == E_BLOCK_REDSTONE_REPEATER_ON) ? 15 : 0;
+			return true;
+		}
+		case E_BLOCK_REDSTONE_LAMP_ON:
+		{
+			a_Node.m_Type = ntActuator;
+			a_Node.m_Power = 15;
+			return true;
+		}
+		case E_BLOCK_PISTON:
+		case E_BLOCK_STICKY_PISTON:
+		case E_BLOCK_POWERED_RAIL:
+		case E_BLOCK_ACTIVATOR_RAIL:
+		{
+			// The extended / active state is in the meta:
+			a_Node.m_Type = ntActuator;
+			a_Node.m_Power = ((Meta & 0x08) != 0) ? 15 : 0;
+			return true;
+		}
+		default:
+		{
+			if (IsComponent(BlockType))
+			{
+				// The rest of the actuators start unpowered; their state is checked on the first evaluation
+				a_Node.m_Type = ntActuator;
+				return true;
+			}
+			break;
+		}
+	}
+
+	// A solid block is a node only if it conducts power to or from a component:
+	if (!cBlockInfo::FullyOccupiesVoxel(BlockType))
+	{
+		return false;
+	}
+	for (size_t i = 0; i < NUM_ADJACENT_OFFSETS; i++)
+	{
+		Vector3i Pos = a_RelPos + g_NeighborOffsets[i];
+		BLOCKTYPE Neighbor;
+		if (a_Chunk.UnboundedRelGetBlockType(Pos.x, Pos.y, Pos.z, Neighbor) && IsComponent(Neighbor))
+		{
+			a_Node.m_Type = ntSolid;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::BuildEdges(cChunk & a_Chunk, const Vector3i & a_RelPos, sNode & a_Node)
+{
+	a_Node.m_Inputs.clear();
+	a_Node.m_Outputs.clear();
+
+	// Only the wires connect diagonally:
+	size_t NumOffsets = (a_Node.m_Type == ntWire) ? NUM_WIRE_OFFSETS : NUM_ADJACENT_OFFSETS;
+	for (size_t i = 0; i < NumOffsets; i++)
+	{
+		Vector3i NeighborPos = a_RelPos + g_NeighborOffsets[i];
+		const sNode * Neighbor = FindNode(a_Chunk, NeighborPos);
+		if (Neighbor == nullptr)
+		{
+			continue;
+		}
+		eEdgeType Input = GetEdgeType(a_Chunk, NeighborPos, *Neighbor, a_RelPos, a_Node);
+		if (Input != etNone)
+		{
+			a_Node.m_Inputs.push_back(sEdge(NeighborPos, Input));
+		}
+		if (GetEdgeType(a_Chunk, a_RelPos, a_Node, NeighborPos, *Neighbor) != etNone)
+		{
+			a_Node.m_Outputs.push_back(NeighborPos);
+		}
+	}
+}
+
+
+
+
+
+cGraphRedstoneSimulator::eEdgeType cGraphRedstoneSimulator::GetEdgeType(cChunk & a_Chunk, const Vector3i & a_SrcPos, const sNode & a_Src, const Vector3i & a_DstPos, const sNode & a_Dst)
+{
+	Vector3i Dir = a_DstPos - a_SrcPos;
+	bool IsAdjacent = ((std::abs(Dir.x) + std::abs(Dir.y) + std::abs(Dir.z)) == 1);
+	if (!IsAdjacent && ((a_Src.m_Type != ntWire) || (a_Dst.m_Type != ntWire)))
+	{
+		return etNone;
+	}
+
+	switch (a_Src.m_Type)
+	{
+		case ntSolid:
+		{
+			// A solid block powers the components attached to it, never another solid block:
+			switch (a_Dst.m_Type)
+			{
+				case ntWire:     return etStrong;
+				case ntActuator: return etDirect;
+				case ntTorch:
+				case ntRepeater: return CanReceiveFrom(a_Dst, a_DstPos, a_SrcPos) ? etDirect : etNone;
+				default:         return etNone;
+			}
+		}
+
+		case ntConstant:
+		case ntLever:
+		case ntPlate:
+		case ntDaylight:
+		case ntDetectorRail:
+		{
+			if (a_Dst.m_Type == ntSolid)
+			{
+				// Only the block the source is attached to is powered, strongly:
+				Vector3i AttachedPos;
+				return (GetAttachedPos(a_Src, a_SrcPos, AttachedPos) && (AttachedPos == a_DstPos)) ? etStrongInto : etNone;
+			}
+			return CanReceiveFrom(a_Dst, a_DstPos, a_SrcPos) ? etDirect : etNone;
+		}
+
+		case ntTorch:
+		{
+			Vector3i SupportPos;
+			if (GetAttachedPos(a_Src, a_SrcPos, SupportPos) && (SupportPos == a_DstPos))
+			{
+				return etNone;
+			}
+			if (Dir.y > 0)
+			{
+				// The block above the torch is powered strongly:
+				if (a_Dst.m_Type == ntSolid)
+				{
+					return etStrongInto;
+				}
+				return CanReceiveFrom(a_Dst, a_DstPos, a_SrcPos) ? etDirect : etNone;
+			}
+			if (Dir.y < 0)
+			{
+				// A wall torch powers an actuator below it:
+				return (a_Dst.m_Type == ntActuator) ? etDirect : etNone;
+			}
+			if (a_Dst.m_Type == ntSolid)
+			{
+				return etNone;
+			}
+			return CanReceiveFrom(a_Dst, a_DstPos, a_SrcPos) ? etDirect : etNone;
+		}
+
+		case ntRepeater:
+		{
+			if (GetRepeaterFront(a_Src, a_SrcPos) != a_DstPos)
+			{
+				return etNone;
+			}
+			switch (a_Dst.m_Type)
+			{
+				case ntSolid: return etStrongInto;
+				case ntRepeater:
+				{
+					if (GetRepeaterBack(a_Dst, a_DstPos) == a_SrcPos)
+					{
+						return etDirect;
+					}
+					// Unless facing each other, a repeater pointing into the other's side locks it:
+					return (GetRepeaterFront(a_Dst, a_DstPos) != a_SrcPos) ? etLock : etNone;
+				}
+				default: return CanReceiveFrom(a_Dst, a_DstPos, a_SrcPos) ? etDirect : etNone;
+			}
+		}
+
+		case ntWire:
+		{
+			if (a_Dst.m_Type == ntWire)
+			{
+				if (IsAdjacent)
+				{
+					return (Dir.y == 0) ? etWire : etNone;
+				}
+				if ((std::abs(Dir.x) + std::abs(Dir.z) != 1) || (std::abs(Dir.y) != 1))
+				{
+					return etNone;
+				}
+				// Up the side of a block, unless a block above the source cuts it; down the side, unless the block beside the source cuts it:
+				Vector3i CutPos = (Dir.y > 0) ? (a_SrcPos + Vector3i(0, 1, 0)) : (a_SrcPos + Vector3i(Dir.x, 0, Dir.z));
+				return IsSolidAt(a_Chunk, CutPos) ? etNone : etWire;
+			}
+			if (Dir.y > 0)
+			{
+				return etNone;
+			}
+			if ((Dir.y == 0) && !DoesWirePointTo(a_Src, Dir))
+			{
+				return etNone;
+			}
+			switch (a_Dst.m_Type)
+			{
+				case ntSolid:    return etWeakInto;
+				case ntActuator: return etDirect;
+				case ntRepeater: return (GetRepeaterBack(a_Dst, a_DstPos) == a_SrcPos) ? etDirect : etNone;
+				default:         return etNone;
+			}
+		}
+
+		default:
+		{
+			return etNone;
+		}
+	}
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::QueueCompileAround(cChunk & a_Chunk, const Vector3i & a_RelPos)
+{
+	for (size_t i = 0; i < NUM_WIRE_OFFSETS; i++)
+	{
+		QueueCompile(a_Chunk, a_RelPos + g_NeighborOffsets[i]);
+	}
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::Evaluate(cChunk & a_Chunk, cChunkData & a_Data, int a_Key, const Vector3i & a_RelPos, sNode & a_Node)
+{
+	unsigned char Power = 0;
+	unsigned char StrongPower = 0;
+	bool IsLocked = false;
+	for (auto & Edge : a_Node.m_Inputs)
+	{
+		const sNode * Src = FindNode(a_Chunk, Edge.m_RelPos);
+		if (Src == nullptr)
+		{
+			continue;
+		}
+		unsigned char Value = 0;
+		switch (Edge.m_Type)
+		{
+			case etDirect:
+			case etWeakInto:   Value = Src->m_Power; break;
+			case etWire:       Value = (Src->m_Power > 0) ? static_cast<unsigned char>(Src->m_Power - 1) : 0; break;
+			case etStrong:     Value = Src->m_StrongPower; break;
+			case etStrongInto:
+			{
+				Value = Src->m_Power;
+				StrongPower = std::max(StrongPower, Value);
+				break;
+			}
+			case etLock:
+			{
+				IsLocked = IsLocked || (Src->m_Power > 0);
+				break;
+			}
+			case etNone: break;
+		}
+		Power = std::max(Power, Value);
+	}  // for Edge - a_Node.m_Inputs[]
+
+	switch (a_Node.m_Type)
+	{
+		case ntSolid:
+		{
+			if ((Power != a_Node.m_Power) || (StrongPower != a_Node.m_StrongPower))
+			{
+				a_Node.m_Power = Power;
+				a_Node.m_StrongPower = StrongPower;
+				QueueOutputs(a_Chunk, a_Node);
+			}
+			break;
+		}
+		case ntWire:
+		{
+			if (Power != a_Node.m_Power)
+			{
+				a_Node.m_Power = Power;
+				a_Chunk.SetMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z, Power);
+				QueueOutputs(a_Chunk, a_Node);
+			}
+			break;
+		}
+		case ntTorch:
+		case ntRepeater:
+		{
+			if (IsLocked)
+			{
+				break;
+			}
+			bool ShouldBeOn = (a_Node.m_Type == ntTorch) ? (Power == 0) : (Power > 0);
+			bool IsOn = (a_Node.m_Power > 0);
+			if (ShouldBeOn == IsOn)
+			{
+				// Back in the current state before the delay ran out, cancel the change:
+				a_Node.m_PendingState = -1;
+			}
+			else if (a_Node.m_PendingState != (ShouldBeOn ? 1 : 0))
+			{
+				int Delay = (a_Node.m_Type == ntTorch) ? TORCH_DELAY : ((((a_Node.m_Meta & 0x0c) >> 2) + 1) * 2);
+				Schedule(a_Data, a_Key, a_Node, Delay, ShouldBeOn);
+			}
+			break;
+		}
+		case ntActuator:
+		{
+			bool WasPowered = (a_Node.m_Power > 0);
+			a_Node.m_Power = Power;
+			if ((Power > 0) != WasPowered)
+			{
+				Actuate(a_Chunk, a_RelPos, a_Node, (Power > 0));
+			}
+			break;
+		}
+		default:
+		{
+			// The sources have no inputs
+			break;
+		}
+	}
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::QueueOutputs(cChunk & a_Chunk, const sNode & a_Node)
+{
+	for (auto & Pos : a_Node.m_Outputs)
+	{
+		QueueNode(a_Chunk, Pos);
+	}
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::QueueNode(cChunk & a_Chunk, const Vector3i & a_RelPos)
+{
+	if ((a_RelPos.y < 0) || (a_RelPos.y >= cChunkDef::Height))
+	{
+		return;
+	}
+	int RelX = a_RelPos.x;
+	int RelZ = a_RelPos.z;
+	cChunk * Chunk = a_Chunk.GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+	if ((Chunk == nullptr) || !Chunk->IsValid())
+	{
+		return;
+	}
+	cChunkData * Data = static_cast<cChunkData *>(Chunk->GetRedstoneSimulatorData());
+	if (Data == nullptr)
+	{
+		return;
+	}
+	int Key = MakeKey(RelX, a_RelPos.y, RelZ);
+	auto itr = Data->m_Nodes.find(Key);
+	if ((itr == Data->m_Nodes.end()) || itr->second.m_IsQueued)
+	{
+		return;
+	}
+	itr->second.m_IsQueued = true;
+	Data->m_Queue.push_back(Key);
+}
+
+
+
+
+
+cGraphRedstoneSimulator::sNode * cGraphRedstoneSimulator::FindNode(cChunk & a_Chunk, const Vector3i & a_RelPos)
+{
+	if ((a_RelPos.y < 0) || (a_RelPos.y >= cChunkDef::Height))
+	{
+		return nullptr;
+	}
+	int RelX = a_RelPos.x;
+	int RelZ = a_RelPos.z;
+	cChunk * Chunk = a_Chunk.GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+	if ((Chunk == nullptr) || !Chunk->IsValid())
+	{
+		return nullptr;
+	}
+	cChunkData * Data = static_cast<cChunkData *>(Chunk->GetRedstoneSimulatorData());
+	if (Data == nullptr)
+	{
+		return nullptr;
+	}
+	auto itr = Data->m_Nodes.find(MakeKey(RelX, a_RelPos.y, RelZ));
+	return (itr == Data->m_Nodes.end()) ? nullptr : &itr->second;
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::Schedule(cChunkData & a_Data, int a_Key, sNode & a_Node, int a_DelayTicks, bool a_ShouldBeOn)
+{
+	ASSERT((a_DelayTicks > 0) && (a_DelayTicks < WHEEL_SIZE));
+	if (a_Data.m_Wheel.empty())
+	{
+		a_Data.m_Wheel.resize(WHEEL_SIZE);
+	}
+	sScheduledChange Change;
+	Change.m_Key = a_Key;
+	Change.m_ShouldBeOn = a_ShouldBeOn;
+	a_Data.m_Wheel[static_cast<size_t>((a_Data.m_WheelPos + a_DelayTicks) % WHEEL_SIZE)].push_back(Change);
+	a_Node.m_PendingState = a_ShouldBeOn ? 1 : 0;
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::ApplyScheduledChanges(cChunk & a_Chunk, cChunkData & a_Data)
+{
+	a_Data.m_WheelPos = (a_Data.m_WheelPos + 1) % WHEEL_SIZE;
+	if (a_Data.m_Wheel.empty())
+	{
+		return;
+	}
+
+	m_DueChanges.clear();
+	std::swap(m_DueChanges, a_Data.m_Wheel[static_cast<size_t>(a_Data.m_WheelPos)]);
+	for (auto & Change : m_DueChanges)
+	{
+		auto itr = a_Data.m_Nodes.find(Change.m_Key);
+		if (itr == a_Data.m_Nodes.end())
+		{
+			continue;
+		}
+		sNode & Node = itr->second;
+		if (Node.m_PendingState != (Change.m_ShouldBeOn ? 1 : 0))
+		{
+			// Cancelled, or the node has been recompiled since
+			continue;
+		}
+		Node.m_PendingState = -1;
+
+		BLOCKTYPE NewBlockType;
+		if (Node.m_Type == ntTorch)
+		{
+			NewBlockType = Change.m_ShouldBeOn ? E_BLOCK_REDSTONE_TORCH_ON : E_BLOCK_REDSTONE_TORCH_OFF;
+		}
+		else
+		{
+			NewBlockType = Change.m_ShouldBeOn ? E_BLOCK_REDSTONE_REPEATER_ON : E_BLOCK_REDSTONE_REPEATER_OFF;
+		}
+		Vector3i RelPos = KeyToPos(Change.m_Key);
+		a_Chunk.SetBlock(RelPos.x, RelPos.y, RelPos.z, NewBlockType, a_Chunk.GetMeta(RelPos.x, RelPos.y, RelPos.z));
+		Node.m_BlockType = NewBlockType;
+		Node.m_Power = Change.m_ShouldBeOn ? 15 : 0;
+		QueueOutputs(a_Chunk, Node);
+
+		// The inputs may have changed again during the delay:
+		if (!Node.m_IsQueued)
+		{
+			Node.m_IsQueued = true;
+			a_Data.m_Queue.push_back(Change.m_Key);
+		}
+	}  // for Change - m_DueChanges[]
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::PollSources(cChunk & a_Chunk, cChunkData & a_Data)
+{
+	for (auto Key : a_Data.m_Polled)
+	{
+		auto itr = a_Data.m_Nodes.find(Key);
+		if (itr == a_Data.m_Nodes.end())
+		{
+			continue;
+		}
+		sNode & Node = itr->second;
+		Vector3i RelPos = KeyToPos(Key);
+		unsigned char Power = GetPolledPower(a_Chunk, RelPos, Node);
+		if (Power == Node.m_Power)
+		{
+			continue;
+		}
+
+		if ((Node.m_Type == ntPlate) && ((Power > 0) != (Node.m_Power > 0)))
+		{
+			int BlockX = a_Chunk.GetPosX() * cChunkDef::Width + RelPos.x;
+			int BlockZ = a_Chunk.GetPosZ() * cChunkDef::Width + RelPos.z;
+			a_Chunk.SetMeta(RelPos.x, RelPos.y, RelPos.z, (Power > 0) ? E_META_PRESSURE_PLATE_DEPRESSED : E_META_PRESSURE_PLATE_RAISED);
+			a_Chunk.BroadcastSoundEffect("random.click", BlockX + 0.5, RelPos.y + 0.1, BlockZ + 0.5, 0.3F, (Power > 0) ? 0.6F : 0.5F);
+		}
+		Node.m_Power = Power;
+		QueueOutputs(a_Chunk, Node);
+	}  // for Key - a_Data.m_Polled[]
+}
+
+
+
+
+
+unsigned char cGraphRedstoneSimulator::GetPolledPower(cChunk & a_Chunk, const Vector3i & a_RelPos, const sNode & a_Node)
+{
+	switch (a_Node.m_Type)
+	{
+		case ntDetectorRail:
+		{
+			return ((a_Chunk.GetMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z) & 0x08) != 0) ? 15 : 0;
+		}
+
+		case ntDaylight:
+		{
+			if (!a_Chunk.IsLightValid() || (a_RelPos.y + 1 >= cChunkDef::Height))
+			{
+				return a_Node.m_Power;
+			}
+			return (a_Chunk.GetTimeAlteredLight(a_Chunk.GetSkyLight(a_RelPos.x, a_RelPos.y + 1, a_RelPos.z)) > 8) ? 15 : 0;
+		}
+
+		case ntPlate:
+		{
+			Vector3f PlatePos(
+				static_cast<float>(a_Chunk.GetPosX() * cChunkDef::Width + a_RelPos.x) + 0.5f,
+				static_cast<float>(a_RelPos.y),
+				static_cast<float>(a_Chunk.GetPosZ() * cChunkDef::Width + a_RelPos.z) + 0.5f
+			);
+			if (a_Node.m_BlockType == E_BLOCK_STONE_PRESSURE_PLATE)
+			{
+				// As in the incremental simulator, stone plates are triggered by players only
+				return (m_World.FindClosestPlayer(PlatePos, 0.5f, false) != nullptr) ? 15 : 0;
+			}
+
+			class cPlateCallback :
+				public cEntityCallback
+			{
+			public:
+				cPlateCallback(const Vector3f & a_PlatePos) :
+					m_PlatePos(a_PlatePos),
+					m_NumEntities(0)
+				{
+				}
+
+				virtual bool Item(cEntity * a_Entity) override
+				{
+					if ((Vector3f(a_Entity->GetPosition()) - m_PlatePos).Length() <= 0.5f)
+					{
+						m_NumEntities += 1;
+					}
+					return false;
+				}
+
+				Vector3f m_PlatePos;
+				int m_NumEntities;
+			} Callback(PlatePos);
+			m_World.ForEachEntityInChunk(a_Chunk.GetPosX(), a_Chunk.GetPosZ(), Callback);
+
+			switch (a_Node.m_BlockType)
+			{
+				case E_BLOCK_LIGHT_WEIGHTED_PRESSURE_PLATE: return static_cast<unsigned char>(std::min(Callback.m_NumEntities, 15));
+				case E_BLOCK_HEAVY_WEIGHTED_PRESSURE_PLATE: return static_cast<unsigned char>(std::min((Callback.m_NumEntities + 9) / 10, 15));
+				default:                                    return (Callback.m_NumEntities > 0) ? 15 : 0;
+			}
+		}
+
+		default:
+		{
+			return a_Node.m_Power;
+		}
+	}
+}
+
+
+
+
+
+void cGraphRedstoneSimulator::Actuate(cChunk & a_Chunk, const Vector3i & a_RelPos, sNode & a_Node, bool a_IsPowered)
+{
+	int BlockX = a_Chunk.GetPosX() * cChunkDef::Width + a_RelPos.x;
+	int BlockY = a_RelPos.y;
+	int BlockZ = a_Chunk.GetPosZ() * cChunkDef::Width + a_RelPos.z;
+
+	switch (a_Node.m_BlockType)
+	{
+		case E_BLOCK_REDSTONE_LAMP_OFF:
+		case E_BLOCK_REDSTONE_LAMP_ON:
+		{
+			BLOCKTYPE NewBlockType = a_IsPowered ? E_BLOCK_REDSTONE_LAMP_ON : E_BLOCK_REDSTONE_LAMP_OFF;
+			a_Chunk.SetBlock(a_RelPos.x, a_RelPos.y, a_RelPos.z, NewBlockType, 0);
+			a_Node.m_BlockType = NewBlockType;
+			break;
+		}
+
+		case E_BLOCK_PISTON:
+		case E_BLOCK_STICKY_PISTON:
+		{
+			if (a_IsPowered)
+			{
+				GetHandlerCompileTime<E_BLOCK_PISTON>::type::ExtendPiston(BlockX, BlockY, BlockZ, &m_World);
+			}
+			else
+			{
+				GetHandlerCompileTime<E_BLOCK_PISTON>::type::RetractPiston(BlockX, BlockY, BlockZ, &m_World);
+			}
+			break;
+		}
+
+		case E_BLOCK_TNT:
+		{
+			if (a_IsPowered)
+			{
+				a_Chunk.BroadcastSoundEffect("game.tnt.primed", static_cast<double>(BlockX), static_cast<double>(BlockY), static_cast<double>(BlockZ), 0.5f, 0.6f);
+				a_Chunk.SetBlock(a_RelPos.x, a_RelPos.y, a_RelPos.z, E_BLOCK_AIR, 0);
+				m_World.SpawnPrimedTNT(BlockX + 0.5, BlockY + 0.5, BlockZ + 0.5);  // 80 ticks to boom
+
+				// The chunk's SetBlock doesn't wake the simulators, remove the node explicitly:
+				QueueCompile(a_Chunk, a_RelPos);
+			}
+			break;
+		}
+
+		case E_BLOCK_COMMAND_BLOCK:
+		case E_BLOCK_DISPENSER:
+		case E_BLOCK_DROPPER:
+		case E_BLOCK_NOTE_BLOCK:
+		{
+			class cSetPowerCallback :
+				public cRedstonePoweredCallback
+			{
+				bool m_IsPowered;
+			public:
+				cSetPowerCallback(bool a_IsPowered) : m_IsPowered(a_IsPowered) {}
+
+				virtual bool Item(cRedstonePoweredEntity * a_Entity) override
+				{
+					a_Entity->SetRedstonePower(m_IsPowered);
+					return false;
+				}
+			} SetPower(a_IsPowered);
+			a_Chunk.DoWithRedstonePoweredEntityAt(BlockX, BlockY, BlockZ, SetPower);
+			break;
+		}
+
+		case E_BLOCK_ACACIA_DOOR:
+		case E_BLOCK_BIRCH_DOOR:
+		case E_BLOCK_DARK_OAK_DOOR:
+		case E_BLOCK_IRON_DOOR:
+		case E_BLOCK_JUNGLE_DOOR:
+		case E_BLOCK_SPRUCE_DOOR:
+		case E_BLOCK_WOODEN_DOOR:
+		{
+			typedef GetHandlerCompileTime<E_BLOCK_WOODEN_DOOR>::type DoorHandler;
+			cChunkInterface ChunkInterface(m_World.GetChunkMap());
+			if ((DoorHandler::IsOpen(ChunkInterface, BlockX, BlockY, BlockZ) != 0) != a_IsPowered)
+			{
+				DoorHandler::SetOpen(ChunkInterface, BlockX, BlockY, BlockZ, a_IsPowered);
+				a_Chunk.BroadcastSoundParticleEffect(1003, BlockX, BlockY, BlockZ, 0);
+			}
+			break;
+		}
+
+		case E_BLOCK_IRON_TRAPDOOR:
+		case E_BLOCK_TRAPDOOR:
+		{
+			m_World.SetTrapdoorOpen(BlockX, BlockY, BlockZ, a_IsPowered);
+			break;
+		}
+
+		case E_BLOCK_ACACIA_FENCE_GATE:
+		case E_BLOCK_BIRCH_FENCE_GATE:
+		case E_BLOCK_DARK_OAK_FENCE_GATE:
+		case E_BLOCK_FENCE_GATE:
+		case E_BLOCK_JUNGLE_FENCE_GATE:
+		case E_BLOCK_SPRUCE_FENCE_GATE:
+		{
+			NIBBLETYPE Meta = a_Chunk.GetMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z);
+			NIBBLETYPE NewMeta = a_IsPowered ? (Meta | 0x04) : (Meta & 0x0b);
+			if (NewMeta != Meta)
+			{
+				a_Chunk.SetMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z, NewMeta);
+				a_Chunk.BroadcastSoundParticleEffect(1003, BlockX, BlockY, BlockZ, 0);
+			}
+			break;
+		}
+
+		case E_BLOCK_ACTIVATOR_RAIL:
+		case E_BLOCK_POWERED_RAIL:
+		{
+			NIBBLETYPE Meta = a_Chunk.GetMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z);
+			a_Chunk.SetMeta(a_RelPos.x, a_RelPos.y, a_RelPos.z, a_IsPowered ? (Meta | 0x08) : (Meta & 0x07));
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+
+
+
+
+bool cGraphRedstoneSimulator::IsComponent(BLOCKTYPE a_BlockType)
+{
+	switch (a_BlockType)
+	{
+		case E_BLOCK_ACACIA_DOOR:
+		case E_BLOCK_ACACIA_FENCE_GATE:
+		case E_BLOCK_ACTIVATOR_RAIL:
+		case E_BLOCK_BIRCH_DOOR:
+		case E_BLOCK_BIRCH_FENCE_GATE:
+		case E_BLOCK_BLOCK_OF_REDSTONE:
+		case E_BLOCK_COMMAND_BLOCK:
+		case E_BLOCK_DARK_OAK_DOOR:
+		case E_BLOCK_DARK_OAK_FENCE_GATE:
+		case E_BLOCK_DAYLIGHT_SENSOR:
+		case E_BLOCK_DETECTOR_RAIL:
+		case E_BLOCK_DISPENSER:
+		case E_BLOCK_DROPPER:
+		case E_BLOCK_FENCE_GATE:
+		case E_BLOCK_HEAVY_WEIGHTED_PRESSURE_PLATE:
+		case E_BLOCK_IRON_DOOR:
+		case E_BLOCK_IRON_TRAPDOOR:
+		case E_BLOCK_JUNGLE_DOOR:
+		case E_BLOCK_JUNGLE_FENCE_GATE:
+		case E_BLOCK_LEVER:
+		case E_BLOCK_LIGHT_WEIGHTED_PRESSURE_PLATE:
+		case E_BLOCK_NOTE_BLOCK:
+		case E_BLOCK_PISTON:
+		case E_BLOCK_POWERED_RAIL:
+		case E_BLOCK_REDSTONE_LAMP_OFF:
+		case E_BLOCK_REDSTONE_LAMP_ON:
+		case E_BLOCK_REDSTONE_REPEATER_OFF:
+		case E_BLOCK_REDSTONE_REPEATER_ON:
+		case E_BLOCK_REDSTONE_TORCH_OFF:
+		case E_BLOCK_REDSTONE_TORCH_ON:
+		case E_BLOCK_REDSTONE_WIRE:
+		case E_BLOCK_SPRUCE_DOOR:
+		case E_BLOCK_SPRUCE_FENCE_GATE:
+		case E_BLOCK_STICKY_PISTON:
+		case E_BLOCK_STONE_BUTTON:
+		case E_BLOCK_STONE_PRESSURE_PLATE:
+		case E_BLOCK_TNT:
+		case E_BLOCK_TRAPDOOR:
+		case E_BLOCK_WOODEN_BUTTON:
+		case E_BLOCK_WOODEN_DOOR:
+		case E_BLOCK_WOODEN_PRESSURE_PLATE:
+		{
+			return true;
+		}
+		default: return false;
+	}
+}
+
+
+
+
+
+bool cGraphRedstoneSimulator::GetAttachedPos(const sNode & a_Node, const Vector3i & a_Pos, Vector3i & a_AttachedPos)
+{
+	eBlockFace Face;
+	switch (a_Node.m_Type)
+	{
+		case ntLever:
+		{
+			if (a_Node.m_BlockType == E_BLOCK_LEVER)
+			{
+				Face = GetHandlerCompileTime<E_BLOCK_LEVER>::type::BlockMetaDataToBlockFace(a_Node.m_Meta);
+			}
+			else
+			{
+				if ((a_Node.m_Meta & 0x07) > 5)
+				{
+					return false;
+				}
+				Face = GetHandlerCompileTime<E_BLOCK_STONE_BUTTON>::type::BlockMetaDataToBlockFace(a_Node.m_Meta);
+			}
+			break;
+		}
+		case ntTorch:
+		{
+			if (a_Node.m_Meta > 5)
+			{
+				return false;
+			}
+			Face = GetHandlerCompileTime<E_BLOCK_TORCH>::type::MetaDataToDirection(a_Node.m_Meta);
+			break;
+		}
+		case ntPlate:
+		case ntDetectorRail:
+		{
+			a_AttachedPos = a_Pos + Vector3i(0, -1, 0);
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+	a_AttachedPos = a_Pos;
+	AddFaceDirection(a_AttachedPos.x, a_AttachedPos.y, a_AttachedPos.z, Face, true);
+	return true;
+}
+
+
+
+
+
+Vector3i cGraphRedstoneSimulator::GetRepeaterFront(const sNode & a_Node, const Vector3i & a_Pos)
+{
+	switch (a_Node.m_Meta & 0x03)
+	{
+		case 0x0: return a_Pos + Vector3i(0, 0, -1);
+		case 0x1: return a_Pos + Vector3i(1, 0, 0);
+		case 0x2: return a_Pos + Vector3i(0, 0, 1);
+		default:  return a_Pos + Vector3i(-1, 0, 0);
+	}
+}
+
+
+
+
+
+bool cGraphRedstoneSimulator::CanReceiveFrom(const sNode & a_Dst, const Vector3i & a_DstPos, const Vector3i & a_SrcPos)
+{
+	switch (a_Dst.m_Type)
+	{
+		case ntWire:
+		case ntActuator:
+		{
+			return true;
+		}
+		case ntTorch:
+		{
+			// Only through the block it is attached to:
+			Vector3i SupportPos;
+			return (GetAttachedPos(a_Dst, a_DstPos, SupportPos) && (SupportPos == a_SrcPos));
+		}
+		case ntRepeater:
+		{
+			return (GetRepeaterBack(a_Dst, a_DstPos) == a_SrcPos);
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
+
+
+
+bool cGraphRedstoneSimulator::DoesWirePointTo(const sNode & a_Wire, const Vector3i & a_Dir)
+{
+	if (a_Wire.m_WireDirs == cIncrementalRedstoneSimulator::REDSTONE_NONE)
+	{
+		// A dot points everywhere
+		return true;
+	}
+	int Flag;
+	if (a_Dir.x > 0)
+	{
+		Flag = cIncrementalRedstoneSimulator::REDSTONE_X_POS;
+	}
+	else if (a_Dir.x < 0)
+	{
+		Flag = cIncrementalRedstoneSimulator::REDSTONE_X_NEG;
+	}
+	else if (a_Dir.z > 0)
+	{
+		Flag = cIncrementalRedstoneSimulator::REDSTONE_Z_POS;
+	}
+	else
+	{
+		Flag = cIncrementalRedstoneSimulator::REDSTONE_Z_NEG;
+	}
+	return ((a_Wire.m_WireDirs & Flag) != 0);
+}
+
+
+
+
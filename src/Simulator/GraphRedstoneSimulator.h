@@ -0,0 +1,216 @@
+
+// GraphRedstoneSimulator.h
+
+// Declares the cGraphRedstoneSimulator class that compiles the redstone circuits into a graph of nodes and edges,
+// and propagates the power changes along the edges only
+
+
+
+
+
+#pragma once
+
+#include "RedstoneSimulator.h"
+
+
+
+
+
+/** A redstone simulator that compiles the circuits into a graph, instead of re-scanning the circuit blocks each tick.
+Each redstone component, and each solid block next to one, is a node, stored in the chunk data of the chunk it is in.
+Each node has a list of input edges, each telling how the power of a neighboring node reaches this node, and a list
+of the output nodes to notify when its power changes. A node is (re)compiled only when a block in its neighborhood
+changes; if the node's description changes, its neighborhood is recompiled in turn, so that the edges stay in sync.
+Power changes are propagated through a per-chunk event queue: only the nodes whose inputs have changed are evaluated.
+Torches and repeaters change their state through a per-chunk timing wheel, after their delay.
+Edges and outputs refer to the nodes by their position, so that unloading a neighboring chunk leaves no dangling pointers.
+Selected by "RedstoneSimulator=Graph" in the [Physics] section of the world's ini file.
+Supported components: wire, repeaters, torches, levers, buttons, pressure plates, daylight sensors, detector rails,
+redstone blocks, and the lamps, pistons, TNT, dispensers, droppers, note blocks, command blocks, doors, trapdoors,
+fence gates, and powered and activator rails. Comparators, tripwires, trapped chests and hoppers are not simulated. */
+class cGraphRedstoneSimulator :
+	public cRedstoneSimulator
+{
+	typedef cRedstoneSimulator super;
+
+public:
+
+	cGraphRedstoneSimulator(cWorld & a_World);
+
+	virtual cRedstoneSimulatorChunkData * CreateChunkData() override;
+
+	virtual void Simulate(float a_Dt) override { UNUSED(a_Dt); }  // not used
+	virtual void SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk) override;
+	virtual bool IsAllowedBlock(BLOCKTYPE a_BlockType) override { return IsComponent(a_BlockType); }
+
+protected:
+
+	/** The kinds of the graph nodes */
+	enum eNodeType
+	{
+		ntNone,
+		ntSolid,         // A solid block next to a component, conducts the power to the components around it
+		ntConstant,      // Redstone block
+		ntLever,         // Levers and buttons, the power is in the meta
+		ntPlate,         // Pressure plates, polled each tick
+		ntDaylight,      // Daylight sensor, polled
+		ntDetectorRail,  // Detector rail, the power is in the meta, polled
+		ntTorch,
+		ntWire,
+		ntRepeater,
+		ntActuator,      // Any component that only receives power: lamps, pistons, doors etc.
+	} ;
+
+	/** The ways the power of a source node reaches the destination node */
+	enum eEdgeType
+	{
+		etNone,
+		etDirect,      // The destination receives the source's power
+		etWire,        // Wire to wire, the destination receives the source's power minus one
+		etStrong,      // Solid to wire, the destination receives the source's strong power only
+		etStrongInto,  // Into a solid block, powers it strongly (the block then powers wires, too)
+		etWeakInto,    // Into a solid block, powers it weakly (the block then powers only the non-wire components)
+		etLock,        // Repeater into a repeater's side, locks the destination
+	} ;
+
+	struct sEdge
+	{
+		Vector3i m_RelPos;  // Relative to the chunk owning the destination node; may be outside that chunk
+		eEdgeType m_Type;
+
+		sEdge(const Vector3i & a_RelPos, eEdgeType a_Type) : m_RelPos(a_RelPos), m_Type(a_Type) {}
+	} ;
+
+	struct sNode
+	{
+		eNodeType m_Type;
+
+		/** The current block type; torches, repeaters and lamps switch between their on and off variants */
+		BLOCKTYPE m_BlockType;
+
+		/** The meta bits that define the node's edges (facing, delay); compared when the node is recompiled */
+		NIBBLETYPE m_Meta;
+
+		/** For wires, the directions the wire points to (cIncrementalRedstoneSimulator::eRedstoneDirection flags) */
+		int m_WireDirs;
+
+		/** The power the node outputs; for solids the weak or strong power, for actuators the received power */
+		unsigned char m_Power;
+
+		/** For solids, the strong power, which also powers the wires */
+		unsigned char m_StrongPower;
+
+		/** True while the node is in its chunk's evaluation queue */
+		bool m_IsQueued;
+
+		/** For torches and repeaters, the state scheduled in the timing wheel: -1 = none, 0 = off, 1 = on */
+		signed char m_PendingState;
+
+		std::vector<sEdge> m_Inputs;
+		std::vector<Vector3i> m_Outputs;
+
+		sNode(void);
+
+		/** Returns true if the two nodes have the same type, block and edge-defining meta */
+		bool IsSameDescription(const sNode & a_Other) const;
+	} ;
+
+	struct sScheduledChange
+	{
+		int m_Key;
+		bool m_ShouldBeOn;
+	} ;
+
+	class cChunkData;
+
+	/** Number of the timing wheel's slots; must be larger than the longest repeater delay, in ticks */
+	static const int WHEEL_SIZE = 16;
+
+	/** Delay of the torches, in ticks */
+	static const int TORCH_DELAY = 2;
+
+	/** Maximum number of the node evaluations per chunk per tick; the rest is left queued for the next tick */
+	static const int MAX_EVALUATIONS = 65536;
+
+	/** Maximum number of the passes over the recompiled nodes per chunk per tick */
+	static const int MAX_COMPILE_PASSES = 16;
+
+
+	/** Buffers reused across the chunks, to avoid reallocating them each tick */
+	std::vector<UInt16> m_CompileBlocks;
+	std::vector<int> m_EvalKeys;
+	std::vector<sScheduledChange> m_DueChanges;
+
+
+	virtual void AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk) override;
+
+	/** Queues the block at the specified position, possibly in a neighboring chunk, for compiling, if it is or may become a node */
+	void QueueCompile(cChunk & a_Chunk, const Vector3i & a_RelPos);
+
+	/** Recompiles the nodes queued for compiling in the chunk */
+	void CompileNodes(cChunk & a_Chunk, cChunkData & a_Data);
+
+	/** Fills in the description of the node at the specified position; returns false if the block is not a node */
+	bool DescribeNode(cChunk & a_Chunk, const Vector3i & a_RelPos, sNode & a_Node);
+
+	/** Rebuilds the input and output edges of the node, based on its neighbors */
+	void BuildEdges(cChunk & a_Chunk, const Vector3i & a_RelPos, sNode & a_Node);
+
+	/** Returns how the source node powers the destination node */
+	eEdgeType GetEdgeType(cChunk & a_Chunk, const Vector3i & a_SrcPos, const sNode & a_Src, const Vector3i & a_DstPos, const sNode & a_Dst);
+
+	/** Queues the nodes around the specified position for compiling, including those in the neighboring chunks */
+	void QueueCompileAround(cChunk & a_Chunk, const Vector3i & a_RelPos);
+
+	/** Evaluates the node's inputs and updates its state */
+	void Evaluate(cChunk & a_Chunk, cChunkData & a_Data, int a_Key, const Vector3i & a_RelPos, sNode & a_Node);
+
+	/** Queues the output nodes of the node for evaluation */
+	void QueueOutputs(cChunk & a_Chunk, const sNode & a_Node);
+
+	/** Queues the node at the specified position, possibly in a neighboring chunk, for evaluation */
+	void QueueNode(cChunk & a_Chunk, const Vector3i & a_RelPos);
+
+	/** Returns the node at the specified position, possibly in a neighboring chunk, or nullptr if there's none */
+	sNode * FindNode(cChunk & a_Chunk, const Vector3i & a_RelPos);
+
+	/** Schedules a torch or repeater state change in the timing wheel */
+	void Schedule(cChunkData & a_Data, int a_Key, sNode & a_Node, int a_DelayTicks, bool a_ShouldBeOn);
+
+	/** Advances the chunk's timing wheel and applies the state changes that are due */
+	void ApplyScheduledChanges(cChunk & a_Chunk, cChunkData & a_Data);
+
+	/** Updates the power of the sources that need polling (pressure plates, daylight sensors, detector rails) */
+	void PollSources(cChunk & a_Chunk, cChunkData & a_Data);
+
+	/** Returns the current power of the polled source */
+	unsigned char GetPolledPower(cChunk & a_Chunk, const Vector3i & a_RelPos, const sNode & a_Node);
+
+	/** Makes the actuator react to its power turning on or off */
+	void Actuate(cChunk & a_Chunk, const Vector3i & a_RelPos, sNode & a_Node, bool a_IsPowered);
+
+	/** Returns true if the block is any of the components handled by the simulator */
+	static bool IsComponent(BLOCKTYPE a_BlockType);
+
+	/** Returns the key of the node at the specified relative coords in its chunk's node map */
+	static int MakeKey(int a_RelX, int a_RelY, int a_RelZ) { return (a_RelY << 8) | (a_RelZ << 4) | a_RelX; }
+	static int MakeKey(const Vector3i & a_RelPos) { return MakeKey(a_RelPos.x, a_RelPos.y, a_RelPos.z); }
+	static Vector3i KeyToPos(int a_Key) { return Vector3i(a_Key & 0x0f, a_Key >> 8, (a_Key >> 4) & 0x0f); }
+
+	/** Returns the position of the block the lever, button, plate, detector rail or torch is attached to; returns false if none */
+	static bool GetAttachedPos(const sNode & a_Node, const Vector3i & a_Pos, Vector3i & a_AttachedPos);
+
+	/** Returns the position in front of / behind the repeater */
+	static Vector3i GetRepeaterFront(const sNode & a_Node, const Vector3i & a_Pos);
+	static Vector3i GetRepeaterBack(const sNode & a_Node, const Vector3i & a_Pos) { return a_Pos * 2 - GetRepeaterFront(a_Node, a_Pos); }
+
+	/** Returns true if the non-solid destination node takes power from a source at a_SrcPos next to it */
+	static bool CanReceiveFrom(const sNode & a_Dst, const Vector3i & a_DstPos, const Vector3i & a_SrcPos);
+
+	/** Returns true if the wire node points to the specified horizontal direction */
+	static bool DoesWirePointTo(const sNode & a_Wire, const Vector3i & a_Dir);
+} ;
+
+
+
+
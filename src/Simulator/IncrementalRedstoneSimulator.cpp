@@ -258,6 +258,7 @@ void cIncrementalRedstoneSimulator::SimulateChunk(std::chrono::milliseconds a_Dt
 				}
 				case E_BLOCK_DISPENSER:
 				case E_BLOCK_DROPPER:
+				case E_BLOCK_HOPPER:
 				{
 					HandleDropSpenser(dataitr->x, dataitr->y, dataitr->z);
 					break;
@@ -146,7 +146,7 @@ private:
 	/* ====== DEVICES ====== */
 	/** Handles pistons */
 	void HandlePiston(int a_RelBlockX, int a_RelBlockY, int a_RelBlockZ);
-	/** Handles dispensers and droppers */
+	/** Handles dispensers, droppers and hoppers (locked while powered) */
 	void HandleDropSpenser(int a_RelBlockX, int a_RelBlockY, int a_RelBlockZ);
 	/** Handles TNT (exploding) */
 	void HandleTNT(int a_RelBlockX, int a_RelBlockY, int a_RelBlockZ);
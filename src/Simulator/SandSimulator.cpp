@@ -2,6 +2,7 @@
 #include "Globals.h"  // NOTE: MSVC stupidness requires this to be the same across all modules
 
 #include "SandSimulator.h"
+#include "ChunkNeighborhood.h"
 #include "../World.h"
 #include "../BlockID.h"
 #include "../Defines.h"
@@ -32,22 +33,29 @@ void cSandSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX,
 		return;
 	}
 
+	// Resolve the chunk's sections once for all the queued blocks:
+	cChunkNeighborhood Area;
+	Area.Init(*a_Chunk);
+
 	int BaseX = a_Chunk->GetPosX() * cChunkDef::Width;
 	int BaseZ = a_Chunk->GetPosZ() * cChunkDef::Width;
 	for (cSandSimulatorChunkData::const_iterator itr = ChunkData.begin(), end = ChunkData.end(); itr != end; ++itr)
 	{
-		BLOCKTYPE BlockType = a_Chunk->GetBlock(itr->x, itr->y, itr->z);
+		BLOCKTYPE BlockType;
+		NIBBLETYPE BlockMeta;
+		Area.GetBlockTypeMeta(itr->x, itr->y, itr->z, BlockType, BlockMeta);
 		if (!IsAllowedBlock(BlockType) || (itr->y <= 0))
 		{
 			continue;
 		}
 
-		BLOCKTYPE BlockBelow = (itr->y > 0) ? a_Chunk->GetBlock(itr->x, itr->y - 1, itr->z) : E_BLOCK_AIR;
+		BLOCKTYPE BlockBelow;
+		Area.GetBlockType(itr->x, itr->y - 1, itr->z, BlockBelow);
 		if (CanStartFallingThrough(BlockBelow))
 		{
 			if (m_IsInstantFall)
 			{
-				DoInstantFall(a_Chunk, itr->x, itr->y, itr->z);
+				DoInstantFall(Area, itr->x, itr->y, itr->z);
 				continue;
 			}
 			Vector3i Pos;
@@ -60,9 +68,10 @@ void cSandSimulator::SimulateChunk(std::chrono::milliseconds a_Dt, int a_ChunkX,
 				Pos.x, Pos.y, Pos.z, ItemTypeToString(BlockType).c_str(), ItemTypeToString(BlockBelow).c_str()
 			);
 			*/
-			cFallingBlock * FallingBlock = new cFallingBlock(Pos, BlockType, a_Chunk->GetMeta(itr->x, itr->y, itr->z));
+			cFallingBlock * FallingBlock = new cFallingBlock(Pos, BlockType, BlockMeta);
 			FallingBlock->Initialize(m_World);
-			a_Chunk->SetBlock(itr->x, itr->y, itr->z, E_BLOCK_AIR, 0);
+			Area.Refresh();  // The spawning hooks may have changed the blocks
+			Area.SetBlock(itr->x, itr->y, itr->z, E_BLOCK_AIR, 0);
 		}
 	}
 	m_TotalBlocks -= (int)ChunkData.size();
@@ -273,20 +282,20 @@ void cSandSimulator::FinishFalling(
 
 
 
-void cSandSimulator::DoInstantFall(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+void cSandSimulator::DoInstantFall(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ)
 {
 	// Remove the original block:
 	BLOCKTYPE  FallingBlockType;
 	NIBBLETYPE FallingBlockMeta;
-	a_Chunk->GetBlockTypeMeta(a_RelX, a_RelY, a_RelZ, FallingBlockType, FallingBlockMeta);
-	a_Chunk->SetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_AIR, 0);
+	a_Area.GetBlockTypeMeta(a_RelX, a_RelY, a_RelZ, FallingBlockType, FallingBlockMeta);
+	a_Area.SetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_AIR, 0);
 	
 	// Search for a place to put it:
 	for (int y = a_RelY - 1; y >= 0; y--)
 	{
 		BLOCKTYPE BlockType;
 		NIBBLETYPE BlockMeta;
-		a_Chunk->GetBlockTypeMeta(a_RelX, y, a_RelZ, BlockType, BlockMeta);
+		a_Area.GetBlockTypeMeta(a_RelX, y, a_RelZ, BlockType, BlockMeta);
 		int BlockY;
 		if (DoesBreakFallingThrough(BlockType, BlockMeta))
 		{
@@ -303,9 +312,12 @@ void cSandSimulator::DoInstantFall(cChunk * a_Chunk, int a_RelX, int a_RelY, int
 		}
 		
 		// Finish the fall at the found bottom:
-		int BlockX = a_RelX + a_Chunk->GetPosX() * cChunkDef::Width;
-		int BlockZ = a_RelZ + a_Chunk->GetPosZ() * cChunkDef::Width;
+		int BlockX = a_RelX + a_Area.GetChunk().GetPosX() * cChunkDef::Width;
+		int BlockZ = a_RelZ + a_Area.GetChunk().GetPosZ() * cChunkDef::Width;
 		FinishFalling(&m_World, BlockX, BlockY, BlockZ, FallingBlockType, FallingBlockMeta);
+
+		// The block was written through the world and may have allocated a section, the pickup spawning calls plugin hooks:
+		a_Area.Refresh();
 		return;
 	}
 	
@@ -9,6 +9,12 @@ typedef cCoordWithIntList cSandSimulatorChunkData;
 #include "Chunk.h"
 
 
+
+
+
+class cChunkNeighborhood;
+
+
 /// Despite the class name, this simulator takes care of all blocks that fall when suspended in the air.
 class cSandSimulator :
 	public cSimulator
@@ -51,7 +57,7 @@ protected:
 	virtual void AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk) override;
 	
 	/// Performs the instant fall of the block - removes it from top, Finishes it at the bottom
-	void DoInstantFall(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
+	void DoInstantFall(cChunkNeighborhood & a_Area, int a_RelX, int a_RelY, int a_RelZ);
 };
 
 
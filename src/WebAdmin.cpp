@@ -6,11 +6,14 @@
 
 #include "Bindings/PluginManager.h"
 #include "Bindings/Plugin.h"
+#include "Bindings/PluginLua.h"
+#include "Bindings/PluginProfiler.h"
 
 #include "World.h"
 #include "Entities/Player.h"
 #include "Server.h"
 #include "Root.h"
+#include "CommandOutput.h"
 
 #include "HTTPServer/HTTPMessage.h"
 #include "HTTPServer/HTTPConnection.h"
@@ -514,6 +517,43 @@ AString cWebAdmin::GetDefaultPage(void)
 	cPluginManager::Get()->ForEachPlugin(Callback);
 	Content += "</ul>";
 
+	// Display the dispatch stats of the hooks that are handled or have been:
+	Content += "<h4>Plugin hooks:</h4><ul>";
+	cPluginManager * PluginManager = cPluginManager::Get();
+	for (int i = 0; i < cPluginManager::HOOK_NUM_HOOKS; i++)
+	{
+		cPluginManager::PluginHook Hook = static_cast<cPluginManager::PluginHook>(i);
+		UInt64 NumCalls = PluginManager->GetHookNumCalls(Hook);
+		if ((NumCalls == 0) && !PluginManager->HasHookSubscribers(Hook))
+		{
+			continue;
+		}
+		UInt64 NanoSec = PluginManager->GetHookTotalNanoSec(Hook);
+		AppendPrintf(Content, "<li>%s: %llu calls, %llu ms total, %llu us avg</li>",
+			cPluginLua::GetHookFnName(i),
+			static_cast<unsigned long long>(NumCalls),
+			static_cast<unsigned long long>(NanoSec / 1000000),
+			static_cast<unsigned long long>((NumCalls == 0) ? 0 : NanoSec / NumCalls / 1000)
+		);
+	}
+	Content += "</ul>";
+
+	// Display the Lua plugins' profiles:
+	class cProfileOutput :
+		public cCommandOutputCallback
+	{
+	public:
+		AString m_Text;
+
+		virtual void Out(const AString & a_Text) override
+		{
+			m_Text.append(a_Text);
+			m_Text.push_back('\n');
+		}
+	} ProfileOutput;
+	cPluginProfiler::ReportAll(ProfileOutput);
+	Content += "<h4>Lua plugin profile:</h4><pre>" + GetHTMLEscapedString(ProfileOutput.m_Text) + "</pre>";
+
 	// Display a list of all players:
 	Content += "<h4>Players:</h4><ul>";
 	cPlayerAccum PlayerAccum;
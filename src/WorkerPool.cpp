@@ -0,0 +1,183 @@
+
+// WorkerPool.cpp
+
+// Implements the cWorkerPool class that runs jobs in background threads and delivers their results in the server tick thread
+
+#include "Globals.h"
+#include "WorkerPool.h"
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cWorkerPool::cWorkerThread:
+
+cWorkerPool::cWorkerThread::cWorkerThread(cWorkerPool & a_Pool, int a_Index) :
+	super(Printf("WorkerPool thread %d", a_Index)),
+	m_Pool(a_Pool)
+{
+}
+
+
+
+
+
+void cWorkerPool::cWorkerThread::Execute(void)
+{
+	for (;;)
+	{
+		if (m_Pool.m_ShouldStop || m_ShouldTerminate)
+		{
+			// Pass the wakeup on to the next worker, so that all of them stop:
+			m_Pool.m_evtJobQueued.Set();
+			return;
+		}
+		cJobPtr Job = m_Pool.GetNextJob();
+		if (Job == nullptr)
+		{
+			m_Pool.m_evtJobQueued.Wait();
+			continue;
+		}
+		Job->Execute();
+		m_Pool.JobExecuted(Job);
+	}
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cWorkerPool:
+
+cWorkerPool::cWorkerPool(void) :
+	m_ShouldStop(false)
+{
+}
+
+
+
+
+
+cWorkerPool::~cWorkerPool()
+{
+	Stop();
+}
+
+
+
+
+
+void cWorkerPool::Start(int a_NumThreads)
+{
+	ASSERT(m_Threads.empty());
+	m_ShouldStop = false;
+	for (int i = 0; i < a_NumThreads; i++)
+	{
+		m_Threads.push_back(std::unique_ptr<cWorkerThread>(new cWorkerThread(*this, i)));
+		m_Threads.back()->Start();
+	}
+}
+
+
+
+
+
+void cWorkerPool::Stop(void)
+{
+	if (m_Threads.empty())
+	{
+		return;
+	}
+	m_ShouldStop = true;
+	m_evtJobQueued.Set();
+	for (cWorkerThreads::iterator itr = m_Threads.begin(), end = m_Threads.end(); itr != end; ++itr)
+	{
+		(*itr)->Stop();
+	}
+	m_Threads.clear();
+
+	cCSLock Lock(m_CS);
+	if (!m_Queue.empty())
+	{
+		LOGD("WorkerPool: dropping %u queued jobs", static_cast<unsigned>(m_Queue.size()));
+	}
+	m_Queue.clear();
+	m_Finished.clear();
+}
+
+
+
+
+
+void cWorkerPool::QueueJob(cJobPtr a_Job)
+{
+	{
+		cCSLock Lock(m_CS);
+		m_Queue.push_back(a_Job);
+	}
+	m_evtJobQueued.Set();
+}
+
+
+
+
+
+void cWorkerPool::TickFinishedJobs(void)
+{
+	std::vector<cJobPtr> Finished;
+	{
+		cCSLock Lock(m_CS);
+		std::swap(Finished, m_Finished);
+	}
+	for (std::vector<cJobPtr>::iterator itr = Finished.begin(), end = Finished.end(); itr != end; ++itr)
+	{
+		(*itr)->Finished();
+	}
+}
+
+
+
+
+
+size_t cWorkerPool::GetNumQueuedJobs(void) const
+{
+	cCSLock Lock(m_CS);
+	return m_Queue.size();
+}
+
+
+
+
+
+cWorkerPool::cJobPtr cWorkerPool::GetNextJob(void)
+{
+	cCSLock Lock(m_CS);
+	if (m_Queue.empty())
+	{
+		return nullptr;
+	}
+	cJobPtr Job = m_Queue.front();
+	m_Queue.pop_front();
+	if (!m_Queue.empty())
+	{
+		// There's more work, wake up another worker:
+		m_evtJobQueued.Set();
+	}
+	return Job;
+}
+
+
+
+
+
+void cWorkerPool::JobExecuted(cJobPtr a_Job)
+{
+	cCSLock Lock(m_CS);
+	m_Finished.push_back(a_Job);
+}
+
+
+
+
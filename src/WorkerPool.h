@@ -0,0 +1,115 @@
+
+// WorkerPool.h
+
+// Declares the cWorkerPool class that runs jobs in background threads and delivers their results in the server tick thread
+
+
+
+
+
+#pragma once
+
+#include <atomic>
+#include "OSSupport/IsThread.h"
+
+
+
+
+
+/** A pool of worker threads for the work that would otherwise stall the tick threads, such as loading files
+or running plugin computations. Each job is executed in one of the worker threads, then its results are
+delivered in the server tick thread, through TickFinishedJobs(). A job must not touch the worlds or the plugins
+while executing, only in the Finished() call.
+The pool is owned by cRoot, it is started before the plugins load and stopped after the server tick thread stops.
+The jobs that haven't been executed by then are dropped, and the results of the executed ones are not delivered. */
+class cWorkerPool
+{
+public:
+
+	/** The interface for the jobs to be executed by the pool */
+	class cJob
+	{
+	public:
+		// Force a virtual destructor in descendants:
+		virtual ~cJob() {}
+
+		/** Called in a worker thread to do the job's work */
+		virtual void Execute(void) = 0;
+
+		/** Called in the server tick thread after Execute() has finished, to deliver the results */
+		virtual void Finished(void) = 0;
+	} ;
+
+	typedef SharedPtr<cJob> cJobPtr;
+
+
+	cWorkerPool(void);
+	~cWorkerPool();
+
+	/** Starts the specified number of worker threads */
+	void Start(int a_NumThreads);
+
+	/** Stops the worker threads, waiting for the jobs being executed; drops the queued and the finished jobs */
+	void Stop(void);
+
+	/** Queues the job for execution. Thread-safe. */
+	void QueueJob(cJobPtr a_Job);
+
+	/** Calls Finished() of the jobs that have been executed since the last call. Called from the server tick thread. */
+	void TickFinishedJobs(void);
+
+	/** Returns the number of the jobs waiting for a worker thread */
+	size_t GetNumQueuedJobs(void) const;
+
+	/** Returns true if the pool is stopping; the long-running jobs should check this and bail out. Thread-safe. */
+	bool IsStopping(void) const { return m_ShouldStop; }
+
+protected:
+
+	class cWorkerThread :
+		public cIsThread
+	{
+		typedef cIsThread super;
+
+	public:
+		cWorkerThread(cWorkerPool & a_Pool, int a_Index);
+
+	protected:
+		cWorkerPool & m_Pool;
+
+		// cIsThread override:
+		virtual void Execute(void) override;
+	} ;
+
+	typedef std::vector<std::unique_ptr<cWorkerThread>> cWorkerThreads;
+
+
+	/** The worker threads */
+	cWorkerThreads m_Threads;
+
+	/** Protects m_Queue and m_Finished against multithreaded access */
+	mutable cCriticalSection m_CS;
+
+	/** The jobs waiting for a worker thread */
+	std::deque<cJobPtr> m_Queue;
+
+	/** The jobs that have been executed and wait for TickFinishedJobs() */
+	std::vector<cJobPtr> m_Finished;
+
+	/** Wakes up a worker thread when a job is queued or the pool is stopping */
+	cEvent m_evtJobQueued;
+
+	/** Set when the pool is stopping, the workers exit as soon as they finish their current job */
+	std::atomic<bool> m_ShouldStop;
+
+
+	/** Removes the next job from the queue and returns it; returns nullptr if the queue is empty */
+	cJobPtr GetNextJob(void);
+
+	/** Moves the executed job to the list of the finished jobs */
+	void JobExecuted(cJobPtr a_Job);
+} ;
+
+
+
+
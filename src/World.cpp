@@ -32,6 +32,7 @@
 #include "Simulator/FloodyFluidSimulator.h"
 #include "Simulator/FluidSimulator.h"
 #include "Simulator/FireSimulator.h"
+#include "Simulator/GraphRedstoneSimulator.h"
 #include "Simulator/NoopFluidSimulator.h"
 #include "Simulator/NoopRedstoneSimulator.h"
 #include "Simulator/SandSimulator.h"
@@ -74,75 +75,136 @@ const int TIME_SPAWN_DIVISOR =   148;
 ////////////////////////////////////////////////////////////////////////////////
 // cSpawnPrepare:
 
-/** Generates and lights the spawn area of the world. Runs as a separate thread. */
+/** Generates and lights the spawn area of the world.
+The chunks are fed into the lighting thread, which loads or generates them and their neighbors, and then lights them.
+Up to m_QueueDepth chunks are in that pipeline at a time; each prepared chunk queues the next one.
+The chunks are prepared from the spawn outwards, ring by ring, so that the inner area can be reported as ready
+to the world (and the players allowed to join) while the outer rings are still being prepared in the background. */
 class cSpawnPrepare:
-	public cIsThread,
 	public cChunkCoordCallback
 {
-	typedef cIsThread super;
-
 public:
-	cSpawnPrepare(cWorld & a_World, int a_SpawnChunkX, int a_SpawnChunkZ, int a_PrepareDistance):
-		super("SpawnPrepare"),
+	cSpawnPrepare(cWorld & a_World, int a_SpawnChunkX, int a_SpawnChunkZ, int a_PrepareDistance, int a_InnerRadius, int a_QueueDepth):
 		m_World(a_World),
 		m_SpawnChunkX(a_SpawnChunkX),
 		m_SpawnChunkZ(a_SpawnChunkZ),
-		m_PrepareDistance(a_PrepareDistance),
-		m_MaxIdx(a_PrepareDistance * a_PrepareDistance),
+		m_InnerRadius(a_InnerRadius),
+		m_NextIdx(0),
+		m_NumInner(0),
+		m_NumInnerPrepared(0),
 		m_NumPrepared(0),
+		m_QueueDepth(std::max(a_QueueDepth, 1)),
 		m_LastReportChunkCount(0)
 	{
-		// Start the thread:
-		Start();
-
-		// Wait for start confirmation, so that the thread can be waited-upon after the constructor returns:
-		m_EvtStarted.Wait();
+		// List the chunks ordered by their distance from the spawn chunk, so that the inner ones get prepared first:
+		std::vector<std::pair<int, Vector3i> > Chunks;  // (Distance, {ChunkX, 0, ChunkZ})
+		int MinCoord = -a_PrepareDistance / 2;
+		for (int z = MinCoord; z < MinCoord + a_PrepareDistance; z++)
+		{
+			for (int x = MinCoord; x < MinCoord + a_PrepareDistance; x++)
+			{
+				int Distance = std::max(std::abs(x), std::abs(z));
+				Chunks.push_back(std::make_pair(Distance, Vector3i(a_SpawnChunkX + x, 0, a_SpawnChunkZ + z)));
+				if (Distance <= a_InnerRadius)
+				{
+					m_NumInner += 1;
+				}
+			}
+		}
+		std::stable_sort(Chunks.begin(), Chunks.end(),
+			[](const std::pair<int, Vector3i> & a_First, const std::pair<int, Vector3i> & a_Second)
+			{
+				return (a_First.first < a_Second.first);
+			}
+		);
+		m_Chunks.reserve(Chunks.size());
+		for (auto itr = Chunks.cbegin(), end = Chunks.cend(); itr != end; ++itr)
+		{
+			m_Chunks.push_back(itr->second);
+		}
 	}
 
 
-	// cIsThread override:
-	virtual void Execute(void) override
+	/** Queues the first batch of chunks into the pipeline. The rest get queued as the preparation progresses. */
+	void Start(void)
 	{
-		// Confirm thread start:
-		m_EvtStarted.Set();
+		m_StartTime = std::chrono::steady_clock::now();
+		m_LastReportTime = m_StartTime;
+		if (m_Chunks.empty())
+		{
+			m_EvtInnerFinished.Set();
+			m_EvtFinished.Set();
+			return;
+		}
+		if (m_NumInner == 0)
+		{
+			m_EvtInnerFinished.Set();
+		}
 
-		// Queue the initial chunks:
-		m_MaxIdx = m_PrepareDistance * m_PrepareDistance;
-		int maxQueue = std::min(m_MaxIdx - 1, 100);  // Number of chunks to queue at once
-		m_NextIdx = maxQueue;
-		m_LastReportTime = std::chrono::steady_clock::now();
-		for (int i = 0; i < maxQueue; i++)
+		// Fill the pipeline. PrepareChunk() calls the callback right away for the chunks that are already lit,
+		// so the lock mustn't be held while calling it:
+		for (;;)
 		{
-			int chunkX, chunkZ;
-			DecodeChunkCoords(i, chunkX, chunkZ);
-			m_World.PrepareChunk(chunkX, chunkZ, this);
-		}  // for i
+			Vector3i Chunk;
+			{
+				cCSLock Lock(m_CS);
+				if ((m_NextIdx - m_NumPrepared >= m_QueueDepth) || (m_NextIdx >= static_cast<int>(m_Chunks.size())))
+				{
+					break;
+				}
+				Chunk = m_Chunks[static_cast<size_t>(m_NextIdx)];
+				m_NextIdx += 1;
+			}
+			m_World.PrepareChunk(Chunk.x, Chunk.z, this);
+		}
+	}
+
 
-		// Wait for the lighting thread to prepare everything. Event is set in the Call() callback:
-		m_EvtFinished.Wait();
+	/** Waits until the chunks within the inner radius are prepared. */
+	void WaitForInner(void)
+	{
+		m_EvtInnerFinished.Wait();
 	}
 
 protected:
 	cWorld & m_World;
 	int m_SpawnChunkX;
 	int m_SpawnChunkZ;
-	int m_PrepareDistance;
 
-	/** The index of the next chunk to be queued in the lighting thread. */
+	/** The chunks within this distance from the spawn chunk need to be prepared before the world is reported as started. */
+	int m_InnerRadius;
+
+	/** Coords of all the chunks to prepare ({ChunkX, 0, ChunkZ}), in the order of preparing. */
+	std::vector<Vector3i> m_Chunks;
+
+	/** Protects the counters against the callbacks coming from the lighting thread and from PrepareChunk() at the same time. */
+	cCriticalSection m_CS;
+
+	/** The index into m_Chunks of the next chunk to be queued. */
 	int m_NextIdx;
 
-	/** The maximum index of the prepared chunks. Queueing stops when m_NextIdx reaches this number. */
-	int m_MaxIdx;
+	/** Number of the chunks within the inner radius; these are at the start of m_Chunks. */
+	int m_NumInner;
 
-	/** Total number of chunks already finished preparing. Preparation finishes when this number reaches m_MaxIdx. */
+	/** Number of the chunks within the inner radius already finished preparing.
+	The chunks in the pipeline finish out of order, so the inner ones need to be counted separately. */
+	int m_NumInnerPrepared;
+
+	/** Total number of chunks already finished preparing. */
 	int m_NumPrepared;
 
-	/** Event used to signal that the thread has started. */
-	cEvent m_EvtStarted;
+	/** Number of chunks queued in the pipeline at a time. */
+	int m_QueueDepth;
+
+	/** Event used to signal that the inner area is prepared. */
+	cEvent m_EvtInnerFinished;
 
-	/** Event used to signal that the preparation is finished. */
+	/** Event used to signal that the entire area is prepared. */
 	cEvent m_EvtFinished;
 
+	/** The timestamp of the preparation start, for the final report. */
+	std::chrono::steady_clock::time_point m_StartTime;
+
 	/** The timestamp of the last progress report emitted. */
 	std::chrono::steady_clock::time_point m_LastReportTime;
 
@@ -150,54 +212,59 @@ protected:
 	int m_LastReportChunkCount;
 
 	// cChunkCoordCallback override:
-	virtual void Call(int a_ChunkX, int a_ChunkZ)
+	virtual void Call(int a_ChunkX, int a_ChunkZ) override
 	{
-		// Check if this was the last chunk:
+		cCSLock Lock(m_CS);
 		m_NumPrepared += 1;
-		if (m_NumPrepared >= m_MaxIdx)
+		int NumChunks = static_cast<int>(m_Chunks.size());
+		auto Now = std::chrono::steady_clock::now();
+
+		bool IsInner = (std::max(std::abs(a_ChunkX - m_SpawnChunkX), std::abs(a_ChunkZ - m_SpawnChunkZ)) <= m_InnerRadius);
+		if (IsInner)
 		{
-			m_EvtFinished.Set();
-			// Must return here, because "this" may have gotten deleted by the previous line
-			return;
+			m_NumInnerPrepared += 1;
 		}
-
-		// Queue another chunk, if appropriate:
-		if (m_NextIdx < m_MaxIdx)
+		if (IsInner && (m_NumInnerPrepared == m_NumInner))
 		{
-			int chunkX, chunkZ;
-			DecodeChunkCoords(m_NextIdx, chunkX, chunkZ);
-			m_World.GetLightingThread().QueueChunk(chunkX, chunkZ, this);
-			m_NextIdx += 1;
+			if (m_NumInner < NumChunks)
+			{
+				LOG("Spawn area of world %s is ready, preparing the remaining %d chunks in the background",
+					m_World.GetName().c_str(), NumChunks - m_NumInner
+				);
+			}
+			m_EvtInnerFinished.Set();
+		}
+		if (m_NumPrepared >= NumChunks)
+		{
+			LOG("Prepared %d spawn chunks of world %s in %.02f seconds",
+				NumChunks, m_World.GetName().c_str(),
+				static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(Now - m_StartTime).count()) / 1000
+			);
+			m_EvtFinished.Set();
+			return;
 		}
 
 		// Report progress every 1 second:
-		auto Now = std::chrono::steady_clock::now();
 		if (Now - m_LastReportTime > std::chrono::seconds(1))
 		{
-			float PercentDone = static_cast<float>(m_NumPrepared * 100) / m_MaxIdx;
+			float PercentDone = static_cast<float>(m_NumPrepared * 100) / NumChunks;
 			float ChunkSpeed = static_cast<float>((m_NumPrepared - m_LastReportChunkCount) * 1000) / std::chrono::duration_cast<std::chrono::milliseconds>(Now - m_LastReportTime).count();
-			LOG("Preparing spawn (%s): %.02f%% (%d/%d; %.02f chunks/s)",
-				m_World.GetName().c_str(), PercentDone, m_NumPrepared, m_MaxIdx, ChunkSpeed
+			LOG("Preparing spawn (%s): %.02f%% (%d/%d; %.02f chunks/s; %d queued for generating, %d for lighting)",
+				m_World.GetName().c_str(), PercentDone, m_NumPrepared, NumChunks, ChunkSpeed,
+				m_World.GetGeneratorQueueLength(), static_cast<int>(m_World.GetLightingQueueLength())
 			);
 			m_LastReportTime = Now;
 			m_LastReportChunkCount = m_NumPrepared;
 		}
-	}
-
 
-	/** Decodes the index into chunk coords. Provides the specific chunk ordering. */
-	void DecodeChunkCoords(int a_Idx, int & a_ChunkX, int & a_ChunkZ)
-	{
-		// A zigzag pattern from the top to bottom, each row alternating between forward-x and backward-x:
-		int z = a_Idx / m_PrepareDistance;
-		int x = a_Idx % m_PrepareDistance;
-		if ((z & 1) == 0)
+		// Queue another chunk, if appropriate. Queueing locks the chunkmap, so do it outside of the lock:
+		if (m_NextIdx < NumChunks)
 		{
-			// Reverse every second row:
-			x = m_PrepareDistance - 1 - x;
+			Vector3i Chunk = m_Chunks[static_cast<size_t>(m_NextIdx)];
+			m_NextIdx += 1;
+			cCSUnlock Unlock(Lock);
+			m_World.GetLightingThread().QueueChunk(Chunk.x, Chunk.z, this);
 		}
-		a_ChunkZ = m_SpawnChunkZ + z - m_PrepareDistance / 2;
-		a_ChunkX = m_SpawnChunkX + x - m_PrepareDistance / 2;
 	}
 };
 
@@ -319,7 +386,8 @@ cWorld::cWorld(const AString & a_WorldName, eDimension a_Dimension, const AStrin
 	m_Scoreboard(this),
 	m_MapManager(this),
 	m_GeneratorCallbacks(*this),
-	m_TickThread(*this)
+	m_TickThread(*this),
+	m_BlockAreaWriteSectionsPerTick(64)
 {
 	LOGD("cWorld::cWorld(\"%s\")", a_WorldName.c_str());
 
@@ -467,10 +535,18 @@ void cWorld::InitializeSpawn(void)
 	cIniFile IniFile;
 	IniFile.ReadFile(m_IniFileName);
 	int ViewDist = IniFile.GetValueSetI("SpawnPosition", "PregenerateDistance", DefaultViewDist);
+
+	// The world is reported as started (and the players may join) once the chunks within this radius are ready, the rest is prepared in the background.
+	// The default covers the entire pregenerated area:
+	int InnerRadius = IniFile.GetValueSetI("SpawnPosition", "PregenerateWaitRadius", ViewDist);
+
+	// Number of chunks being loaded, generated and lit at the same time:
+	int QueueDepth = IniFile.GetValueSetI("SpawnPosition", "PregenerateQueueDepth", 256);
 	IniFile.WriteFile(m_IniFileName);
 
-	cSpawnPrepare prep(*this, ChunkX, ChunkZ, ViewDist);
-	prep.Wait();
+	m_SpawnPrepare.reset(new cSpawnPrepare(*this, ChunkX, ChunkZ, ViewDist, InnerRadius, QueueDepth));
+	m_SpawnPrepare->Start();
+	m_SpawnPrepare->WaitForInner();
 	
 	#ifdef TEST_LINEBLOCKTRACER
 	// DEBUG: Test out the cLineBlockTracer class by tracing a few lines:
@@ -601,6 +677,7 @@ void cWorld::Start(void)
 	m_IsDaylightCycleEnabled      = IniFile.GetValueSetB("General",       "IsDaylightCycleEnabled",      true);
 	int GameMode                  = IniFile.GetValueSetI("General",       "Gamemode",                    (int)m_GameMode);
 	int Weather                   = IniFile.GetValueSetI("General",       "Weather",                     (int)m_Weather);
+	m_BlockAreaWriteSectionsPerTick = std::max(IniFile.GetValueSetI("General", "BlockAreaWriteSectionsPerTick", m_BlockAreaWriteSectionsPerTick), 1);
 	
 	if (GetDimension() == dimOverworld)
 	{
@@ -620,6 +697,11 @@ void cWorld::Start(void)
 	InitialiseGeneratorDefaults(IniFile);
 	InitialiseAndLoadMobSpawningValues(IniFile);
 	SetTimeOfDay(IniFile.GetValueSetI("General", "TimeInTicks", GetTimeOfDay()));
+	m_EntityTracker.Load(IniFile);
+	m_EntityActivation.Load(IniFile);
+	m_EntityMerger.Load(IniFile);
+	m_HopperScheduler.Load(IniFile);
+	m_PathFinderService.Load(IniFile);
 
 	m_ChunkMap = make_unique<cChunkMap>(this);
 	
@@ -901,6 +983,9 @@ void cWorld::Stop(void)
 	
 	m_TickThread.Stop();
 	m_Lighting.Stop();
+
+	// The lighting thread won't call the spawn preparation back anymore, it can be freed even if it hasn't finished:
+	m_SpawnPrepare.reset();
 	m_Generator.Stop();
 	m_ChunkSender.Stop();
 	m_Storage.Stop();
@@ -913,7 +998,11 @@ void cWorld::Stop(void)
 void cWorld::Tick(std::chrono::milliseconds a_Dt, std::chrono::milliseconds a_LastTickDurationMSec)
 {
 	// Call the plugins
-	cPluginManager::Get()->CallHookWorldTick(*this, a_Dt, a_LastTickDurationMSec);
+	cPluginManager * PluginManager = cPluginManager::Get();
+	if (PluginManager->HasHookSubscribers(cPluginManager::HOOK_WORLD_TICK))
+	{
+		PluginManager->CallHookWorldTick(*this, a_Dt, a_LastTickDurationMSec);
+	}
 	
 	// Set any chunk data that has been queued for setting:
 	cSetChunkDataPtrs SetChunkDataQueue;
@@ -964,12 +1053,17 @@ void cWorld::Tick(std::chrono::milliseconds a_Dt, std::chrono::milliseconds a_La
 	// Add players waiting in the queue to be added:
 	AddQueuedPlayers();
 
+	m_PathFinderService.Tick();
+	m_EntityActivation.BeginTick(GetWorldAge());
+	m_EntityMerger.BeginTick(GetWorldAge());
+	m_HopperScheduler.BeginTick();
 	m_ChunkMap->Tick(a_Dt);
 
 	TickClients(static_cast<float>(a_Dt.count()));
 	TickQueuedBlocks();
 	TickQueuedTasks();
 	TickScheduledTasks();
+	TickBlockAreaWriters();
 	
 	GetSimulatorManager()->Simulate(static_cast<float>(a_Dt.count()));
 
@@ -1033,8 +1127,14 @@ void cWorld::TickMobs(std::chrono::milliseconds a_Dt)
 	// _X 2013_10_22: This is a quick fix for #283 - the world needs to be locked while ticking mobs
 	cWorld::cLock Lock(*this);
 
+	// Sort the players by their current positions, for the census and the mobs' nearest player queries:
+	{
+		cCSLock PlayersLock(m_CSPlayers);
+		m_PlayerGrid.Rebuild(m_Players);
+	}
+
 	// before every Mob action, we have to count them depending on the distance to players, on their family ...
-	cMobCensus MobCensus;
+	cMobCensus MobCensus(m_PlayerGrid);
 	m_ChunkMap->CollectMobCensus(MobCensus);
 	if (m_bAnimals)
 	{
@@ -1075,14 +1175,19 @@ void cWorld::TickMobs(std::chrono::milliseconds a_Dt)
 	cMobProximityCounter::sIterablePair allCloseEnoughToMoveMobs = MobCensus.GetProximityCounter().getMobWithinThosesDistances(-1, 64 * 16);// MG TODO : deal with this magic number (the 16 is the size of a block)
 	for (cMobProximityCounter::tDistanceToMonster::const_iterator itr = allCloseEnoughToMoveMobs.m_Begin; itr != allCloseEnoughToMoveMobs.m_End; ++itr)
 	{
-		itr->second.m_Monster.Tick(a_Dt, itr->second.m_Chunk);
+		// The mobs outside their activation range are only ticked once in a while, catching up on the skipped time:
+		std::chrono::milliseconds TickDt;
+		if (m_EntityActivation.ShouldTickMob(*itr->second.m_Monster, itr->first, a_Dt, TickDt))
+		{
+			itr->second.m_Monster->Tick(TickDt, *itr->second.m_Chunk);
+		}
 	}
 
 	// remove too far mobs
 	cMobProximityCounter::sIterablePair allTooFarMobs = MobCensus.GetProximityCounter().getMobWithinThosesDistances(128 * 16, -1);// MG TODO : deal with this magic number (the 16 is the size of a block)
 	for (cMobProximityCounter::tDistanceToMonster::const_iterator itr = allTooFarMobs.m_Begin; itr != allTooFarMobs.m_End; ++itr)
 	{
-		itr->second.m_Monster.Destroy(true);
+		itr->second.m_Monster->Destroy(true);
 	}
 }
 
@@ -1147,6 +1252,37 @@ void cWorld::TickScheduledTasks(void)
 
 
 
+
+void cWorld::TickBlockAreaWriters(void)
+{
+	{
+		cCSLock Lock(m_CSBlockAreaWritersToAdd);
+		m_BlockAreaWriters.splice(m_BlockAreaWriters.end(), m_BlockAreaWritersToAdd);
+	}
+
+	// The first writers get the budget first, so that each edit finishes as soon as possible:
+	int Budget = m_BlockAreaWriteSectionsPerTick;
+	for (auto itr = m_BlockAreaWriters.begin(); itr != m_BlockAreaWriters.end();)
+	{
+		if (Budget > 0)
+		{
+			Budget -= (*itr)->Tick(*m_ChunkMap, Budget);
+		}
+		if ((*itr)->IsFinished())
+		{
+			itr = m_BlockAreaWriters.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+}
+
+
+
+
+
 void cWorld::TickClients(float a_Dt)
 {
 	cClientHandlePtrs RemoveClients;
@@ -2206,6 +2342,15 @@ void cWorld::BroadcastEntityMetadata(const cEntity & a_Entity, const cClientHand
 
 
 
+bool cWorld::BroadcastEntityMovement(cEntity & a_Entity, const cEntityTracker::sMovement & a_Movement, const cClientHandle * a_Exclude)
+{
+	return m_ChunkMap->BroadcastEntityMovement(a_Entity, a_Movement, a_Exclude);
+}
+
+
+
+
+
 void cWorld::BroadcastEntityRelMove(const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude)
 {
 	m_ChunkMap->BroadcastEntityRelMove(a_Entity, a_RelX, a_RelY, a_RelZ, a_Exclude);
@@ -2722,6 +2867,7 @@ void cWorld::RemovePlayer(cPlayer * a_Player, bool a_RemoveFromChunk)
 		cCSLock Lock(m_CSPlayers);
 		LOGD("Removing player %s from world \"%s\"", a_Player->GetName().c_str(), m_WorldName.c_str());
 		m_Players.remove(a_Player);
+		m_PlayerGrid.Remove(a_Player);
 	}
 	
 	// Remove the player's client from the list of clients to be ticked:
@@ -2835,9 +2981,13 @@ cPlayer * cWorld::FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit,
 	cPlayer * ClosestPlayer = nullptr;
 
 	cCSLock Lock(m_CSPlayers);
-	for (cPlayerList::const_iterator itr = m_Players.begin(); itr != m_Players.end(); ++itr)
+
+	// Only the players near the position can be the closest ones, the grid knows them by their position at the last rebuild:
+	cPlayerProximityGrid::sPlayerPosVector Candidates;
+	m_PlayerGrid.GetPlayersInRange(a_Pos, a_SightLimit + cPlayerProximityGrid::POSITION_SLACK, Candidates);
+	for (cPlayerProximityGrid::sPlayerPosVector::const_iterator itr = Candidates.begin(); itr != Candidates.end(); ++itr)
 	{
-		Vector3f Pos = (*itr)->GetPosition();
+		Vector3f Pos = itr->m_Player->GetPosition();
 		double Distance = (Pos - a_Pos).Length();
 
 		if (Distance < ClosestDistance)
@@ -2847,13 +2997,13 @@ cPlayer * cWorld::FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit,
 				if (!LineOfSight.Trace(a_Pos, (Pos - a_Pos), (int)(Pos - a_Pos).Length()))
 				{
 					ClosestDistance = Distance;
-					ClosestPlayer = *itr;
+					ClosestPlayer = itr->m_Player;
 				}
 			}
 			else
 			{
 				ClosestDistance = Distance;
-				ClosestPlayer = *itr;
+				ClosestPlayer = itr->m_Player;
 			}
 		}
 	}
@@ -2909,6 +3059,15 @@ bool cWorld::ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback & a_
 
 
 
+bool cWorld::ForEachEntityNearest(const Vector3d & a_Pos, double a_Radius, size_t a_MaxCount, cEntityCallback & a_Callback)
+{
+	return m_ChunkMap->ForEachEntityNearest(a_Pos, a_Radius, a_MaxCount, a_Callback);
+}
+
+
+
+
+
 bool cWorld::DoWithEntityByID(UInt32 a_UniqueID, cEntityCallback & a_Callback)
 {
 	// First check the entities-to-add:
@@ -3187,6 +3346,16 @@ void cWorld::QueueTask(cTaskPtr a_Task)
 
 
 
+void cWorld::QueueBlockAreaWriter(cBlockAreaWriter * a_Writer)
+{
+	cCSLock Lock(m_CSBlockAreaWritersToAdd);
+	m_BlockAreaWritersToAdd.push_back(cBlockAreaWriterPtr(a_Writer));
+}
+
+
+
+
+
 void cWorld::ScheduleTask(int a_DelayTicks, cTaskPtr a_Task)
 {
 	Int64 TargetTick = a_DelayTicks + std::chrono::duration_cast<cTickTimeLong>(m_WorldAge).count();
@@ -3483,6 +3652,10 @@ cRedstoneSimulator * cWorld::InitializeRedstoneSimulator(cIniFile & a_IniFile)
 	{
 		res = new cIncrementalRedstoneSimulator(*this);
 	}
+	else if (NoCaseCompare(SimulatorName, "Graph") == 0)
+	{
+		res = new cGraphRedstoneSimulator(*this);
+	}
 	else if (NoCaseCompare(SimulatorName, "noop") == 0)
 	{
 		res = new cRedstoneNoopSimulator(*this);
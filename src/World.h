@@ -27,6 +27,12 @@
 #include "Blocks/BroadcastInterface.h"
 #include "FastRandom.h"
 #include "ClientHandle.h"
+#include "PlayerProximityGrid.h"
+#include "EntityActivation.h"
+#include "Entities/EntityMerger.h"
+#include "BlockEntities/HopperScheduler.h"
+#include "Mobs/PathFinderService.h"
+#include "BlockAreaWriter.h"
 
 
 
@@ -56,6 +62,7 @@ class cCompositeChat;
 class cCuboid;
 class cSetChunkData;
 class cBroadcaster;
+class cSpawnPrepare;
 
 
 typedef std::list< cPlayer * > cPlayerList;
@@ -239,6 +246,7 @@ public:
 	void BroadcastEntityHeadLook             (const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityLook                 (const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityMetadata             (const cEntity & a_Entity, const cClientHandle * a_Exclude = nullptr);
+	bool BroadcastEntityMovement             (cEntity & a_Entity, const cEntityTracker::sMovement & a_Movement, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityRelMove              (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityRelMoveLook          (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ, const cClientHandle * a_Exclude = nullptr);
 	void BroadcastEntityStatus               (const cEntity & a_Entity, char a_Status, const cClientHandle * a_Exclude = nullptr);
@@ -351,6 +359,11 @@ public:
 	If any chunk in the box is missing, ignores the entities in that chunk silently. */
 	bool ForEachEntityInBox(const cBoundingBox & a_Box, cEntityCallback & a_Callback);  // Exported in ManualBindings.cpp
 
+	/** Calls the callback for up to a_MaxCount entities whose position is within a_Radius of a_Pos, nearest first.
+	Returns true if all such entities processed, false if the callback aborted by returning true.
+	If any chunk in the range is missing, ignores the entities in that chunk silently. */
+	bool ForEachEntityNearest(const Vector3d & a_Pos, double a_Radius, size_t a_MaxCount, cEntityCallback & a_Callback);
+
 	/** Calls the callback if the entity with the specified ID is found, with the entity object as the callback param.
 	Returns true if entity found and callback returned false. */
 	bool DoWithEntityByID(UInt32 a_UniqueID, cEntityCallback & a_Callback);  // Exported in ManualBindings.cpp
@@ -534,6 +547,24 @@ public:
 	inline cFluidSimulator * GetWaterSimulator(void) { return m_WaterSimulator; }
 	inline cFluidSimulator * GetLavaSimulator (void) { return m_LavaSimulator; }
 	inline cRedstoneSimulator * GetRedstoneSimulator(void) { return m_RedstoneSimulator; }
+
+	/** Returns the tracker that culls and throttles entity movement updates sent to clients */
+	cEntityTracker & GetEntityTracker(void) { return m_EntityTracker; }
+
+	/** Returns the activation ranges that throttle the ticking of the entities far from all players */
+	cEntityActivation & GetEntityActivation(void) { return m_EntityActivation; }
+
+	/** Returns the merger that combines the nearby item drops and XP orbs */
+	cEntityMerger & GetEntityMerger(void) { return m_EntityMerger; }
+
+	/** Returns the scheduler that keeps the idle hoppers asleep */
+	cHopperScheduler & GetHopperScheduler(void) { return m_HopperScheduler; }
+
+	/** Returns the players sorted by their positions at the last tick, see cPlayerProximityGrid */
+	const cPlayerProximityGrid & GetPlayerGrid(void) const { return m_PlayerGrid; }
+
+	/** Returns the service that shares the search memory and the per-tick step budget among the mob path searches */
+	cPathFinderService & GetPathFinderService(void) { return m_PathFinderService; }
 	
 	/** Calls the callback for each block entity in the specified chunk; returns true if all block entities processed, false if the callback aborted by returning true */
 	bool ForEachBlockEntityInChunk(int a_ChunkX, int a_ChunkZ, cBlockEntityCallback & a_Callback);  // Exported in ManualBindings.cpp
@@ -708,6 +739,10 @@ public:
 	/** Queues a task onto the tick thread, with the specified delay. */
 	void ScheduleTask(int a_DelayTicks, cTaskPtr a_Task);
 
+	/** Queues an incremental write of a block area; takes ownership of the writer.
+	The writers are ticked in the order they were queued, sharing the BlockAreaWriteSectionsPerTick budget. */
+	void QueueBlockAreaWriter(cBlockAreaWriter * a_Writer);  // Exported in ManualBindings.cpp as QueueWriteBlockArea()
+
 	/** Returns the number of chunks loaded	 */
 	int GetNumChunks() const;  // tolua_export
 
@@ -722,6 +757,8 @@ public:
 
 	cLightingThread & GetLightingThread(void) { return m_Lighting; }
 
+	/** Prepares the spawn area. Returns once the chunks within the "PregenerateWaitRadius" are ready,
+	the rest of the area keeps being prepared in the background. */
 	void InitializeSpawn(void);
 	
 	/** Starts threads that belong to this world */
@@ -953,12 +990,19 @@ private:
 	cCriticalSection m_CSPlayers;
 	cPlayerList      m_Players;
 
+	/** The players of m_Players sorted by their position, rebuilt each tick in TickMobs().
+	Used for the nearest-player queries of the mob AI and the mob census. Modified only while holding m_CSPlayers. */
+	cPlayerProximityGrid m_PlayerGrid;
+
 	cWorldStorage     m_Storage;
 	
 	unsigned int m_MaxPlayers;
 
 	std::unique_ptr<cChunkMap> m_ChunkMap;
 
+	/** The spawn area preparation, kept until the world stops, because it may continue in the background after InitializeSpawn() returns */
+	std::unique_ptr<cSpawnPrepare> m_SpawnPrepare;
+
 	bool m_bAnimals;
 	std::set<eMonsterType> m_AllowedMobs;
 
@@ -1006,6 +1050,11 @@ private:
 
 	cScoreboard      m_Scoreboard;
 	cMapManager      m_MapManager;
+	cEntityTracker   m_EntityTracker;
+	cEntityActivation m_EntityActivation;
+	cEntityMerger    m_EntityMerger;
+	cHopperScheduler m_HopperScheduler;
+	cPathFinderService m_PathFinderService;
 	
 	/** The callbacks that the ChunkGenerator uses to store new chunks and interface to plugins */
 	cChunkGeneratorCallbacks m_GeneratorCallbacks;
@@ -1058,6 +1107,22 @@ private:
 	/** Queue for the chunk data to be set into m_ChunkMap by the tick thread. Protected by m_CSSetChunkDataQueue */
 	cSetChunkDataPtrs m_SetChunkDataQueue;
 
+	typedef std::unique_ptr<cBlockAreaWriter> cBlockAreaWriterPtr;
+	typedef std::list<cBlockAreaWriterPtr> cBlockAreaWriterPtrs;
+
+	/** CS protecting m_BlockAreaWritersToAdd */
+	cCriticalSection m_CSBlockAreaWritersToAdd;
+
+	/** The block area writers queued from any thread, waiting for the tick thread to move them to m_BlockAreaWriters.
+	Protected by m_CSBlockAreaWritersToAdd */
+	cBlockAreaWriterPtrs m_BlockAreaWritersToAdd;
+
+	/** The block area writers being ticked, in the order they were queued. Accessed only from the tick thread. */
+	cBlockAreaWriterPtrs m_BlockAreaWriters;
+
+	/** The maximum number of chunk sections that the block area writers may write in a single tick */
+	int m_BlockAreaWriteSectionsPerTick;
+
 
 	cWorld(const AString & a_WorldName, eDimension a_Dimension = dimOverworld, const AString & a_LinkedOverworldName = "");
 	virtual ~cWorld();
@@ -1075,6 +1140,9 @@ private:
 	
 	/** Executes all tasks queued onto the tick thread */
 	void TickScheduledTasks(void);
+
+	/** Lets the queued block area writers write up to m_BlockAreaWriteSectionsPerTick sections, removes the finished ones */
+	void TickBlockAreaWriters(void);
 	
 	/** Ticks all clients that are in this world */
 	void TickClients(float a_Dt);
@@ -278,7 +278,14 @@ AString cSchematicFileSerializer::SaveToSchematicNBT(const cBlockArea & a_BlockA
 		AString Dummy(a_BlockArea.GetBlockCount(), 0);
 		Writer.AddByteArray("Blocks", Dummy.data(), Dummy.size());
 	}
-	if (a_BlockArea.HasBlockMetas())
+	if (a_BlockArea.HasBlockMetas() && a_BlockArea.AreNibblesPacked())
+	{
+		// The file stores one meta per byte:
+		AString Metas(a_BlockArea.GetBlockCount(), 0);
+		cBlockAreaKernels::UnpackNibbles(reinterpret_cast<NIBBLETYPE *>(&Metas[0]), a_BlockArea.m_BlockMetas, 0, Metas.size());
+		Writer.AddByteArray("Data", Metas.data(), Metas.size());
+	}
+	else if (a_BlockArea.HasBlockMetas())
 	{
 		Writer.AddByteArray("Data", (const char *)a_BlockArea.m_BlockMetas, a_BlockArea.GetBlockCount());
 	}
@@ -239,6 +239,9 @@ void universalMain()
 	}
 	#endif
 
+	// Write out any lines still queued in the logger:
+	cLogger::TerminateMultithreading();
+
 	g_ServerTerminated = true;
 
 	// Shutdown all of LibEvent:
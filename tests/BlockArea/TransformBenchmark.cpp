@@ -0,0 +1,934 @@
+
+// TransformBenchmark.cpp
+
+// Checks the cBlockArea transformations, merging, cropping and expanding, both with the nibbles stored one per byte
+// and packed, against the former per-block loops and against each other, and reading the area from the chunks;
+// then measures the transformations on the plains village prefabs and on a large pseudo-random area.
+// The blockhandlers are stubbed out in Stubs.cpp, each blocktype transforms its metas through a different permutation.
+
+#include "Globals.h"
+#include "BlockArea.h"
+#include "BlockInfo.h"
+#include "Blocks/BlockHandler.h"
+#include "ChunkData.h"
+#include "ChunkDataCallback.h"
+#include "ForEachChunkProvider.h"
+#include "Generating/Prefabs/PlainsVillagePrefabs.h"
+
+
+
+
+
+/** A block area as plain arrays, in the same layout as cBlockArea, used by the former per-block loops */
+struct sArea
+{
+	int m_SizeX, m_SizeY, m_SizeZ;
+	std::vector<BLOCKTYPE> m_Types;
+	std::vector<NIBBLETYPE> m_Metas;
+
+	size_t GetBlockCount(void) const { return m_Types.size(); }
+	int MakeIndex(int a_X, int a_Y, int a_Z) const { return a_X + a_Z * m_SizeX + a_Y * m_SizeX * m_SizeZ; }
+} ;
+
+
+
+
+
+/** Creates the areas out of the plains village prefabs' images */
+static std::vector<sArea> LoadPrefabs(void)
+{
+	std::vector<sArea> res;
+	for (size_t i = 0; i < g_PlainsVillagePrefabsCount; i++)
+	{
+		const cPrefab::sDef & Def = g_PlainsVillagePrefabs[i];
+
+		// Parse the charmap, "Char: BlockType: BlockMeta" lines:
+		BLOCKTYPE Types[256] = {};
+		NIBBLETYPE Metas[256] = {};
+		AStringVector Lines = StringSplitAndTrim(Def.m_CharMap, "\n");
+		for (AStringVector::const_iterator itr = Lines.begin(), end = Lines.end(); itr != end; ++itr)
+		{
+			AStringVector Items = StringSplitAndTrim(*itr, ":");
+			testassert(Items.size() >= 3);
+			Byte Char = static_cast<Byte>(Items[0][0]);
+			Types[Char] = static_cast<BLOCKTYPE>(atoi(Items[1].c_str()));
+			Metas[Char] = static_cast<NIBBLETYPE>(atoi(Items[2].c_str()));
+		}
+
+		// The image is organized YZX, the same as the area:
+		sArea Area;
+		Area.m_SizeX = Def.m_SizeX;
+		Area.m_SizeY = Def.m_SizeY;
+		Area.m_SizeZ = Def.m_SizeZ;
+		size_t NumBlocks = static_cast<size_t>(Def.m_SizeX * Def.m_SizeY * Def.m_SizeZ);
+		testassert(strlen(Def.m_Image) == NumBlocks);
+		for (size_t b = 0; b < NumBlocks; b++)
+		{
+			Byte Char = static_cast<Byte>(Def.m_Image[b]);
+			Area.m_Types.push_back(Types[Char]);
+			Area.m_Metas.push_back(Metas[Char]);
+		}
+		res.push_back(Area);
+	}
+	return res;
+}
+
+
+
+
+
+/** Returns the next pseudo-random number of the sequence */
+static UInt32 NextRandom(UInt32 & a_Seed)
+{
+	a_Seed = a_Seed * 1103515245 + 12345;
+	return a_Seed >> 8;
+}
+
+
+
+
+
+/** Creates an area of the specified size with pseudo-random contents */
+static sArea CreateRandomArea(int a_SizeX, int a_SizeY, int a_SizeZ)
+{
+	sArea Area;
+	Area.m_SizeX = a_SizeX;
+	Area.m_SizeY = a_SizeY;
+	Area.m_SizeZ = a_SizeZ;
+	size_t NumBlocks = static_cast<size_t>(a_SizeX * a_SizeY * a_SizeZ);
+	Area.m_Types.resize(NumBlocks);
+	Area.m_Metas.resize(NumBlocks);
+	UInt32 Seed = 0x12345678;
+	for (size_t i = 0; i < NumBlocks; i++)
+	{
+		UInt32 Rnd = NextRandom(Seed);
+		Area.m_Types[i] = static_cast<BLOCKTYPE>(Rnd >> 16);
+		Area.m_Metas[i] = static_cast<NIBBLETYPE>((Rnd >> 8) & 0x0f);
+	}
+	return Area;
+}
+
+
+
+
+
+/** Creates a cBlockArea with the contents of the plain area */
+static void ToBlockArea(const sArea & a_Src, cBlockArea & a_Dst, bool a_ShouldPack)
+{
+	a_Dst.Create(a_Src.m_SizeX, a_Src.m_SizeY, a_Src.m_SizeZ, cBlockArea::baTypes | cBlockArea::baMetas);
+	memcpy(a_Dst.GetBlockTypes(), a_Src.m_Types.data(), a_Src.GetBlockCount());
+	memcpy(a_Dst.GetBlockMetas(), a_Src.m_Metas.data(), a_Src.GetBlockCount());
+	if (a_ShouldPack)
+	{
+		a_Dst.PackNibbles();
+	}
+}
+
+
+
+
+
+/** Reads the contents of the cBlockArea, packed or not, through its per-block getters */
+static sArea FromBlockArea(const cBlockArea & a_Src)
+{
+	sArea res;
+	res.m_SizeX = a_Src.GetSizeX();
+	res.m_SizeY = a_Src.GetSizeY();
+	res.m_SizeZ = a_Src.GetSizeZ();
+	res.m_Types.resize(a_Src.GetBlockCount());
+	res.m_Metas.resize(a_Src.GetBlockCount());
+	for (int y = 0; y < res.m_SizeY; y++)
+	{
+		for (int z = 0; z < res.m_SizeZ; z++)
+		{
+			for (int x = 0; x < res.m_SizeX; x++)
+			{
+				int Idx = res.MakeIndex(x, y, z);
+				a_Src.GetRelBlockTypeMeta(x, y, z, res.m_Types[Idx], res.m_Metas[Idx]);
+			}
+		}
+	}
+	return res;
+}
+
+
+
+
+
+/** Fills all the datatypes of the area with pseudo-random contents, about a third of the blocks are air */
+static void FillRandom(cBlockArea & a_Area, UInt32 a_Seed)
+{
+	for (int y = 0; y < a_Area.GetSizeY(); y++)
+	{
+		for (int z = 0; z < a_Area.GetSizeZ(); z++)
+		{
+			for (int x = 0; x < a_Area.GetSizeX(); x++)
+			{
+				UInt32 Rnd = NextRandom(a_Seed);
+				BLOCKTYPE Type = ((Rnd % 3) == 0) ? E_BLOCK_AIR : static_cast<BLOCKTYPE>(Rnd >> 16);
+				a_Area.SetRelBlockTypeMeta(x, y, z, Type, static_cast<NIBBLETYPE>((Rnd >> 4) & 0x0f));
+				if (a_Area.HasBlockLights())
+				{
+					a_Area.SetRelBlockLight(x, y, z, static_cast<NIBBLETYPE>((Rnd >> 8) & 0x0f));
+				}
+				if (a_Area.HasBlockSkyLights())
+				{
+					a_Area.SetRelBlockSkyLight(x, y, z, static_cast<NIBBLETYPE>((Rnd >> 12) & 0x0f));
+				}
+			}
+		}
+	}
+}
+
+
+
+
+
+/** Returns true if the two areas have the same size and the same contents of all the datatypes, compared through the per-block getters */
+static bool AreEqual(const cBlockArea & a_Area1, const cBlockArea & a_Area2)
+{
+	if (
+		(a_Area1.GetSize() != a_Area2.GetSize()) ||
+		(a_Area1.GetOrigin() != a_Area2.GetOrigin()) ||
+		(a_Area1.GetDataTypes() != a_Area2.GetDataTypes())
+	)
+	{
+		return false;
+	}
+	for (int y = 0; y < a_Area1.GetSizeY(); y++)
+	{
+		for (int z = 0; z < a_Area1.GetSizeZ(); z++)
+		{
+			for (int x = 0; x < a_Area1.GetSizeX(); x++)
+			{
+				if (
+					(a_Area1.HasBlockTypes() && (a_Area1.GetRelBlockType(x, y, z) != a_Area2.GetRelBlockType(x, y, z))) ||
+					(a_Area1.HasBlockMetas() && (a_Area1.GetRelBlockMeta(x, y, z) != a_Area2.GetRelBlockMeta(x, y, z))) ||
+					(a_Area1.HasBlockLights() && (a_Area1.GetRelBlockLight(x, y, z) != a_Area2.GetRelBlockLight(x, y, z))) ||
+					(a_Area1.HasBlockSkyLights() && (a_Area1.GetRelBlockSkyLight(x, y, z) != a_Area2.GetRelBlockSkyLight(x, y, z)))
+				)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+
+
+
+
+static bool AreEqual(const sArea & a_Area1, const sArea & a_Area2)
+{
+	return (
+		(a_Area1.m_SizeX == a_Area2.m_SizeX) &&
+		(a_Area1.m_SizeY == a_Area2.m_SizeY) &&
+		(a_Area1.m_SizeZ == a_Area2.m_SizeZ) &&
+		(a_Area1.m_Types == a_Area2.m_Types) &&
+		(a_Area1.m_Metas == a_Area2.m_Metas)
+	);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// The former per-block loops, calling the blockhandler for each block:
+
+static void ReferenceRotateCCW(sArea & a_Area)
+{
+	std::vector<BLOCKTYPE> NewTypes(a_Area.GetBlockCount());
+	std::vector<NIBBLETYPE> NewMetas(a_Area.GetBlockCount());
+	for (int x = 0; x < a_Area.m_SizeX; x++)
+	{
+		int NewZ = a_Area.m_SizeX - x - 1;
+		for (int z = 0; z < a_Area.m_SizeZ; z++)
+		{
+			int NewX = z;
+			for (int y = 0; y < a_Area.m_SizeY; y++)
+			{
+				int NewIdx = NewX + NewZ * a_Area.m_SizeZ + y * a_Area.m_SizeX * a_Area.m_SizeZ;
+				int OldIdx = a_Area.MakeIndex(x, y, z);
+				NewTypes[NewIdx] = a_Area.m_Types[OldIdx];
+				NewMetas[NewIdx] = BlockHandler(a_Area.m_Types[OldIdx])->MetaRotateCCW(a_Area.m_Metas[OldIdx]);
+			}  // for y
+		}  // for z
+	}  // for x
+	std::swap(a_Area.m_Types, NewTypes);
+	std::swap(a_Area.m_Metas, NewMetas);
+	std::swap(a_Area.m_SizeX, a_Area.m_SizeZ);
+}
+
+
+
+
+
+static void ReferenceRotateCW(sArea & a_Area)
+{
+	std::vector<BLOCKTYPE> NewTypes(a_Area.GetBlockCount());
+	std::vector<NIBBLETYPE> NewMetas(a_Area.GetBlockCount());
+	for (int x = 0; x < a_Area.m_SizeX; x++)
+	{
+		int NewZ = x;
+		for (int z = 0; z < a_Area.m_SizeZ; z++)
+		{
+			int NewX = a_Area.m_SizeZ - z - 1;
+			for (int y = 0; y < a_Area.m_SizeY; y++)
+			{
+				int NewIdx = NewX + NewZ * a_Area.m_SizeZ + y * a_Area.m_SizeX * a_Area.m_SizeZ;
+				int OldIdx = a_Area.MakeIndex(x, y, z);
+				NewTypes[NewIdx] = a_Area.m_Types[OldIdx];
+				NewMetas[NewIdx] = BlockHandler(a_Area.m_Types[OldIdx])->MetaRotateCW(a_Area.m_Metas[OldIdx]);
+			}  // for y
+		}  // for z
+	}  // for x
+	std::swap(a_Area.m_Types, NewTypes);
+	std::swap(a_Area.m_Metas, NewMetas);
+	std::swap(a_Area.m_SizeX, a_Area.m_SizeZ);
+}
+
+
+
+
+
+/** The former MirrorXY loop, swapping block by block; unlike the former one, it transforms the metas of the middle row, too */
+static void ReferenceMirrorXY(sArea & a_Area)
+{
+	int HalfZ = (a_Area.m_SizeZ + 1) / 2;
+	int MaxZ = a_Area.m_SizeZ - 1;
+	for (int y = 0; y < a_Area.m_SizeY; y++)
+	{
+		for (int z = 0; z < HalfZ; z++)
+		{
+			for (int x = 0; x < a_Area.m_SizeX; x++)
+			{
+				int Idx1 = a_Area.MakeIndex(x, y, z);
+				int Idx2 = a_Area.MakeIndex(x, y, MaxZ - z);
+				if (Idx1 == Idx2)
+				{
+					a_Area.m_Metas[Idx1] = BlockHandler(a_Area.m_Types[Idx1])->MetaMirrorXY(a_Area.m_Metas[Idx1]);
+					continue;
+				}
+				std::swap(a_Area.m_Types[Idx1], a_Area.m_Types[Idx2]);
+				NIBBLETYPE Meta1 = BlockHandler(a_Area.m_Types[Idx2])->MetaMirrorXY(a_Area.m_Metas[Idx1]);
+				NIBBLETYPE Meta2 = BlockHandler(a_Area.m_Types[Idx1])->MetaMirrorXY(a_Area.m_Metas[Idx2]);
+				a_Area.m_Metas[Idx1] = Meta2;
+				a_Area.m_Metas[Idx2] = Meta1;
+			}  // for x
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
+/** The former MirrorXZ loop, swapping block by block; unlike the former one, it transforms the metas of the middle layer, too */
+static void ReferenceMirrorXZ(sArea & a_Area)
+{
+	int HalfY = (a_Area.m_SizeY + 1) / 2;
+	int MaxY = a_Area.m_SizeY - 1;
+	for (int y = 0; y < HalfY; y++)
+	{
+		for (int z = 0; z < a_Area.m_SizeZ; z++)
+		{
+			for (int x = 0; x < a_Area.m_SizeX; x++)
+			{
+				int Idx1 = a_Area.MakeIndex(x, y, z);
+				int Idx2 = a_Area.MakeIndex(x, MaxY - y, z);
+				if (Idx1 == Idx2)
+				{
+					a_Area.m_Metas[Idx1] = BlockHandler(a_Area.m_Types[Idx1])->MetaMirrorXZ(a_Area.m_Metas[Idx1]);
+					continue;
+				}
+				std::swap(a_Area.m_Types[Idx1], a_Area.m_Types[Idx2]);
+				NIBBLETYPE Meta1 = BlockHandler(a_Area.m_Types[Idx2])->MetaMirrorXZ(a_Area.m_Metas[Idx1]);
+				NIBBLETYPE Meta2 = BlockHandler(a_Area.m_Types[Idx1])->MetaMirrorXZ(a_Area.m_Metas[Idx2]);
+				a_Area.m_Metas[Idx1] = Meta2;
+				a_Area.m_Metas[Idx2] = Meta1;
+			}  // for x
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
+/** The former MirrorYZ loop, swapping block by block; unlike the former one, it transforms the metas of the middle column, too */
+static void ReferenceMirrorYZ(sArea & a_Area)
+{
+	int HalfX = (a_Area.m_SizeX + 1) / 2;
+	int MaxX = a_Area.m_SizeX - 1;
+	for (int y = 0; y < a_Area.m_SizeY; y++)
+	{
+		for (int z = 0; z < a_Area.m_SizeZ; z++)
+		{
+			for (int x = 0; x < HalfX; x++)
+			{
+				int Idx1 = a_Area.MakeIndex(x, y, z);
+				int Idx2 = a_Area.MakeIndex(MaxX - x, y, z);
+				if (Idx1 == Idx2)
+				{
+					a_Area.m_Metas[Idx1] = BlockHandler(a_Area.m_Types[Idx1])->MetaMirrorYZ(a_Area.m_Metas[Idx1]);
+					continue;
+				}
+				std::swap(a_Area.m_Types[Idx1], a_Area.m_Types[Idx2]);
+				NIBBLETYPE Meta1 = BlockHandler(a_Area.m_Types[Idx2])->MetaMirrorYZ(a_Area.m_Metas[Idx1]);
+				NIBBLETYPE Meta2 = BlockHandler(a_Area.m_Types[Idx1])->MetaMirrorYZ(a_Area.m_Metas[Idx2]);
+				a_Area.m_Metas[Idx1] = Meta2;
+				a_Area.m_Metas[Idx2] = Meta1;
+			}  // for x
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
+/** The former msOverwrite merge of the whole area into a same-sized one, block by block */
+static void ReferenceOverwrite(sArea & a_Dst, const sArea & a_Src)
+{
+	for (int y = 0; y < a_Src.m_SizeY; y++)
+	{
+		for (int z = 0; z < a_Src.m_SizeZ; z++)
+		{
+			int Idx = a_Src.MakeIndex(0, y, z);
+			for (int x = 0; x < a_Src.m_SizeX; x++)
+			{
+				a_Dst.m_Types[Idx] = a_Src.m_Types[Idx];
+				a_Dst.m_Metas[Idx] = a_Src.m_Metas[Idx];
+				++Idx;
+			}  // for x
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// The checks:
+
+typedef void (* cReferenceFn)(sArea & a_Area);
+typedef void (cBlockArea::* cTransformFn)(void);
+
+static const char * g_TransformNames[] = { "RotateCCW", "RotateCW", "MirrorXY", "MirrorXZ", "MirrorYZ" };
+static const cReferenceFn g_References[] = { ReferenceRotateCCW, ReferenceRotateCW, ReferenceMirrorXY, ReferenceMirrorXZ, ReferenceMirrorYZ };
+static const cTransformFn g_Transforms[] =
+{
+	&cBlockArea::RotateCCW, &cBlockArea::RotateCW, &cBlockArea::MirrorXY, &cBlockArea::MirrorXZ, &cBlockArea::MirrorYZ
+};
+
+
+
+
+
+/** Checks that cBlockArea's transformations produce the same areas as the former loops, both unpacked and packed */
+static void TestTransforms(const std::vector<sArea> & a_Areas)
+{
+	for (std::vector<sArea>::const_iterator itr = a_Areas.begin(), end = a_Areas.end(); itr != end; ++itr)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(g_References); i++)
+		{
+			sArea Reference(*itr);
+			g_References[i](Reference);
+			for (int Packed = 0; Packed < 2; Packed++)
+			{
+				cBlockArea Area;
+				ToBlockArea(*itr, Area, (Packed != 0));
+				(Area.*g_Transforms[i])();
+				testassert(Area.AreNibblesPacked() == (Packed != 0));  // The packed areas are packed again afterwards
+				testassert(AreEqual(Reference, FromBlockArea(Area)));
+			}
+		}
+	}
+}
+
+
+
+
+
+/** Checks that merging a packed source gives the same results as merging the same source unpacked,
+for the strategies with their own code paths, and at offsets that make the source rows start at odd nibble indices. */
+static void TestPackedMerge(void)
+{
+	cBlockArea Src, Dst;
+	Src.Create(13, 7, 11);
+	FillRandom(Src, 1);
+	Dst.Create(20, 9, 17);
+	FillRandom(Dst, 2);
+	cBlockArea PackedSrc;
+	Src.CopyTo(PackedSrc);
+	PackedSrc.PackNibbles();
+
+	const cBlockArea::eMergeStrategy Strategies[] =
+	{
+		cBlockArea::msOverwrite, cBlockArea::msFillAir, cBlockArea::msImprint, cBlockArea::msLake,
+		cBlockArea::msSpongePrint, cBlockArea::msDifference, cBlockArea::msSimpleCompare, cBlockArea::msMask,
+	};
+	const int Offsets[][3] =
+	{
+		{  0,  0,  0 },
+		{  1,  2,  3 },
+		{  3,  1,  5 },
+		{ -3, -1, -5 },
+		{ -1,  0,  2 },
+		{ 12,  5, 10 },  // Partially outside the destination
+	};
+	for (size_t s = 0; s < ARRAYCOUNT(Strategies); s++)
+	{
+		for (size_t o = 0; o < ARRAYCOUNT(Offsets); o++)
+		{
+			cBlockArea Expected, FromPacked, IntoPacked;
+			Dst.CopyTo(Expected);
+			Dst.CopyTo(FromPacked);
+			Dst.CopyTo(IntoPacked);
+			IntoPacked.PackNibbles();
+			Expected.Merge(Src, Offsets[o][0], Offsets[o][1], Offsets[o][2], Strategies[s]);
+			FromPacked.Merge(PackedSrc, Offsets[o][0], Offsets[o][1], Offsets[o][2], Strategies[s]);
+			IntoPacked.Merge(PackedSrc, Offsets[o][0], Offsets[o][1], Offsets[o][2], Strategies[s]);
+			testassert(AreEqual(Expected, FromPacked));
+			testassert(IntoPacked.AreNibblesPacked());
+			testassert(AreEqual(Expected, IntoPacked));
+		}
+	}
+
+	// Check the overwriting against the source block by block, too:
+	cBlockArea Overwritten;
+	Dst.CopyTo(Overwritten);
+	Overwritten.Merge(PackedSrc, 3, 1, 5, cBlockArea::msOverwrite);
+	for (int y = 0; y < Dst.GetSizeY(); y++)
+	{
+		for (int z = 0; z < Dst.GetSizeZ(); z++)
+		{
+			for (int x = 0; x < Dst.GetSizeX(); x++)
+			{
+				int SrcX = x - 3, SrcY = y - 1, SrcZ = z - 5;
+				bool IsInSrc = (
+					(SrcX >= 0) && (SrcX < Src.GetSizeX()) &&
+					(SrcY >= 0) && (SrcY < Src.GetSizeY()) &&
+					(SrcZ >= 0) && (SrcZ < Src.GetSizeZ())
+				);
+				const cBlockArea & Expected = IsInSrc ? Src : Dst;
+				int ExpX = IsInSrc ? SrcX : x;
+				int ExpY = IsInSrc ? SrcY : y;
+				int ExpZ = IsInSrc ? SrcZ : z;
+				testassert(Overwritten.GetRelBlockType(x, y, z) == Expected.GetRelBlockType(ExpX, ExpY, ExpZ));
+				testassert(Overwritten.GetRelBlockMeta(x, y, z) == Expected.GetRelBlockMeta(ExpX, ExpY, ExpZ));
+			}
+		}
+	}
+}
+
+
+
+
+
+/** Checks that cropping and expanding a packed area gives the same results as with the unpacked one, and keeps it packed */
+static void TestPackedCropExpand(void)
+{
+	const int AllTypes = cBlockArea::baTypes | cBlockArea::baMetas | cBlockArea::baLight | cBlockArea::baSkyLight;
+	cBlockArea Unpacked, Packed;
+	Unpacked.Create(15, 9, 13, AllTypes);
+	FillRandom(Unpacked, 3);
+	Unpacked.CopyTo(Packed);
+	Packed.PackNibbles();
+
+	Unpacked.Crop(1, 2, 0, 3, 5, 1);
+	Packed.Crop(1, 2, 0, 3, 5, 1);
+	testassert(Packed.AreNibblesPacked());
+	testassert(AreEqual(Unpacked, Packed));
+
+	Unpacked.Expand(3, 0, 1, 2, 0, 7);
+	Packed.Expand(3, 0, 1, 2, 0, 7);
+	testassert(Packed.AreNibblesPacked());
+	testassert(AreEqual(Unpacked, Packed));
+}
+
+
+
+
+
+/** Checks that packing, copying and unpacking an area with an odd number of blocks keeps all of its nibbles */
+static void TestPackingRoundTrip(void)
+{
+	const int AllTypes = cBlockArea::baTypes | cBlockArea::baMetas | cBlockArea::baLight | cBlockArea::baSkyLight;
+	cBlockArea Original;
+	Original.Create(7, 5, 9, AllTypes);
+	FillRandom(Original, 4);
+	testassert((Original.GetBlockCount() % 2) == 1);
+
+	// The packed area reads the same through the getters:
+	cBlockArea Packed;
+	Original.CopyTo(Packed);
+	Packed.PackNibbles();
+	testassert(AreEqual(Original, Packed));
+
+	// The copy of a packed area stays packed:
+	cBlockArea Copy;
+	Packed.CopyTo(Copy);
+	testassert(Copy.AreNibblesPacked());
+	testassert(AreEqual(Original, Copy));
+
+	// The setters change only their own nibble, at both even and odd indices:
+	Copy.SetRelBlockMeta(0, 0, 0, 0x0a);
+	Copy.SetRelBlockMeta(1, 0, 0, 0x05);
+	Copy.SetRelBlockLight(6, 4, 8, 0x0c);
+	Original.SetRelBlockMeta(0, 0, 0, 0x0a);
+	Original.SetRelBlockMeta(1, 0, 0, 0x05);
+	Original.SetRelBlockLight(6, 4, 8, 0x0c);
+	testassert(AreEqual(Original, Copy));
+
+	// Unpacking gives the original arrays back:
+	Copy.UnpackNibbles();
+	testassert(!Copy.AreNibblesPacked());
+	size_t NumBlocks = Original.GetBlockCount();
+	testassert(memcmp(Copy.GetBlockTypes(),    Original.GetBlockTypes(),    NumBlocks) == 0);
+	testassert(memcmp(Copy.GetBlockMetas(),    Original.GetBlockMetas(),    NumBlocks) == 0);
+	testassert(memcmp(Copy.GetBlockLight(),    Original.GetBlockLight(),    NumBlocks) == 0);
+	testassert(memcmp(Copy.GetBlockSkyLight(), Original.GetBlockSkyLight(), NumBlocks) == 0);
+}
+
+
+
+
+
+/** Checks the packed nibble helpers at both even and odd starting indices */
+static void TestPackingKernels(const sArea & a_Area)
+{
+	std::vector<NIBBLETYPE> Packed((a_Area.GetBlockCount() + 1) / 2);
+	cBlockAreaKernels::PackNibbles(Packed.data(), a_Area.m_Metas.data(), a_Area.GetBlockCount());
+	std::vector<NIBBLETYPE> Unpacked(a_Area.GetBlockCount());
+	cBlockAreaKernels::UnpackNibbles(Unpacked.data(), Packed.data(), 0, Unpacked.size());
+	testassert(Unpacked == a_Area.m_Metas);
+
+	for (size_t Start = 0; Start < 4; Start++)
+	{
+		size_t Count = std::min<size_t>(a_Area.GetBlockCount() - Start, 37);
+		std::vector<NIBBLETYPE> Part(Count);
+		cBlockAreaKernels::UnpackNibbles(Part.data(), Packed.data(), Start, Count);
+		for (size_t i = 0; i < Count; i++)
+		{
+			testassert(Part[i] == a_Area.m_Metas[Start + i]);
+			testassert(cBlockAreaKernels::GetPackedNibble(Packed.data(), Start + i) == a_Area.m_Metas[Start + i]);
+		}
+	}
+
+	NIBBLETYPE Buffer[3] = { 0xff, 0xff, 0xff };
+	cBlockAreaKernels::SetPackedNibble(Buffer, 2, 0x05);
+	cBlockAreaKernels::SetPackedNibble(Buffer, 3, 0x0a);
+	testassert(Buffer[0] == 0xff);
+	testassert(Buffer[1] == 0xa5);
+	testassert(Buffer[2] == 0xff);
+}
+
+
+
+
+
+/** Allocates the chunk sections straight from the heap */
+class cTestSectionPool :
+	public cAllocationPool<cChunkData::sChunkSection>
+{
+public:
+	virtual cChunkData::sChunkSection * Allocate(void) override
+	{
+		return new cChunkData::sChunkSection;
+	}
+
+	virtual void Free(cChunkData::sChunkSection * a_Ptr) override
+	{
+		delete a_Ptr;
+	}
+} ;
+
+
+
+
+
+/** Provides a few chunks of pseudo-random data to cBlockArea::Read(); the top sections are left unallocated */
+class cTestChunkProvider :
+	public cForEachChunkProvider
+{
+public:
+	/** The number of chunks in each direction, starting at chunk (0, 0) */
+	static const int NUM_CHUNKS = 3;
+
+	/** The height from which the chunks are empty, their sections unallocated */
+	static const int DATA_HEIGHT = 96;
+
+	cTestChunkProvider(void)
+	{
+		UInt32 Seed = 0x2468ace;
+		for (int i = 0; i < NUM_CHUNKS * NUM_CHUNKS; i++)
+		{
+			sChunk & Chunk = m_Chunks[i];
+			memset(Chunk.m_BlockTypes, 0, sizeof(Chunk.m_BlockTypes));
+			memset(Chunk.m_BlockMetas, 0, sizeof(Chunk.m_BlockMetas));
+			memset(Chunk.m_BlockLight, 0, sizeof(Chunk.m_BlockLight));
+			memset(Chunk.m_BlockSkyLight, 0xff, sizeof(Chunk.m_BlockSkyLight));
+			int DataSize = cChunkDef::Width * cChunkDef::Width * DATA_HEIGHT;
+			for (int Idx = 0; Idx < DataSize; Idx++)
+			{
+				Chunk.m_BlockTypes[Idx] = static_cast<BLOCKTYPE>(1 + NextRandom(Seed) % 255);
+			}
+			for (int Idx = 0; Idx < DataSize / 2; Idx++)
+			{
+				Chunk.m_BlockMetas[Idx]    = static_cast<NIBBLETYPE>(NextRandom(Seed));
+				Chunk.m_BlockLight[Idx]    = static_cast<NIBBLETYPE>(NextRandom(Seed));
+				Chunk.m_BlockSkyLight[Idx] = static_cast<NIBBLETYPE>(NextRandom(Seed));
+			}
+			Chunk.m_Data.reset(new cChunkData(m_Pool));
+			Chunk.m_Data->SetBlockTypes(Chunk.m_BlockTypes);
+			Chunk.m_Data->SetMetas(Chunk.m_BlockMetas);
+			Chunk.m_Data->SetBlockLight(Chunk.m_BlockLight);
+			Chunk.m_Data->SetSkyLight(Chunk.m_BlockSkyLight);
+		}
+	}
+
+	/** Checks that the area contains the data from the chunks at its origin, for all the datatypes it has */
+	void VerifyArea(const cBlockArea & a_Area) const
+	{
+		int DataTypes = a_Area.GetDataTypes();
+		for (int y = 0; y < a_Area.GetSizeY(); y++)
+		{
+			for (int z = 0; z < a_Area.GetSizeZ(); z++)
+			{
+				for (int x = 0; x < a_Area.GetSizeX(); x++)
+				{
+					int BlockX = a_Area.GetOriginX() + x;
+					int BlockY = a_Area.GetOriginY() + y;
+					int BlockZ = a_Area.GetOriginZ() + z;
+					const sChunk & Chunk = m_Chunks[BlockX / cChunkDef::Width + NUM_CHUNKS * (BlockZ / cChunkDef::Width)];
+					int Idx = cChunkDef::MakeIndexNoCheck(BlockX % cChunkDef::Width, BlockY, BlockZ % cChunkDef::Width);
+					int Shift = (Idx % 2) * 4;
+					if ((DataTypes & cBlockArea::baTypes) != 0)
+					{
+						testassert(a_Area.GetRelBlockType(x, y, z) == Chunk.m_BlockTypes[Idx]);
+					}
+					if ((DataTypes & cBlockArea::baMetas) != 0)
+					{
+						testassert(a_Area.GetRelBlockMeta(x, y, z) == ((Chunk.m_BlockMetas[Idx / 2] >> Shift) & 0x0f));
+					}
+					if ((DataTypes & cBlockArea::baLight) != 0)
+					{
+						testassert(a_Area.GetRelBlockLight(x, y, z) == ((Chunk.m_BlockLight[Idx / 2] >> Shift) & 0x0f));
+					}
+					if ((DataTypes & cBlockArea::baSkyLight) != 0)
+					{
+						testassert(a_Area.GetRelBlockSkyLight(x, y, z) == ((Chunk.m_BlockSkyLight[Idx / 2] >> Shift) & 0x0f));
+					}
+				}  // for x
+			}  // for z
+		}  // for y
+	}
+
+	// cForEachChunkProvider overrides:
+	virtual bool ForEachChunkInRect(int a_MinChunkX, int a_MaxChunkX, int a_MinChunkZ, int a_MaxChunkZ, cChunkDataCallback & a_Callback) override
+	{
+		testassert((a_MinChunkX >= 0) && (a_MaxChunkX < NUM_CHUNKS));
+		testassert((a_MinChunkZ >= 0) && (a_MaxChunkZ < NUM_CHUNKS));
+		for (int z = a_MinChunkZ; z <= a_MaxChunkZ; z++)
+		{
+			for (int x = a_MinChunkX; x <= a_MaxChunkX; x++)
+			{
+				if (a_Callback.Coords(x, z))
+				{
+					a_Callback.ChunkData(*m_Chunks[x + NUM_CHUNKS * z].m_Data);
+				}
+			}
+		}
+		return true;
+	}
+
+	virtual bool WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes) override
+	{
+		UNUSED(a_Area);
+		UNUSED(a_MinBlockX);
+		UNUSED(a_MinBlockY);
+		UNUSED(a_MinBlockZ);
+		UNUSED(a_DataTypes);
+		return false;
+	}
+
+protected:
+	struct sChunk
+	{
+		cChunkDef::BlockTypes   m_BlockTypes;
+		cChunkDef::BlockNibbles m_BlockMetas;
+		cChunkDef::BlockNibbles m_BlockLight;
+		cChunkDef::BlockNibbles m_BlockSkyLight;
+		std::unique_ptr<cChunkData> m_Data;
+	} ;
+
+	cTestSectionPool m_Pool;
+	sChunk m_Chunks[NUM_CHUNKS * NUM_CHUNKS];
+} ;
+
+
+
+
+
+/** Reads the chunks into areas with various datatypes, both small ones and ones large enough to be filled by more threads */
+static void TestRead(void)
+{
+	std::unique_ptr<cTestChunkProvider> Provider(new cTestChunkProvider);
+	static const int DataTypes[] =
+	{
+		cBlockArea::baTypes,
+		cBlockArea::baMetas | cBlockArea::baSkyLight,
+		cBlockArea::baTypes | cBlockArea::baMetas | cBlockArea::baLight | cBlockArea::baSkyLight,
+	};
+	for (size_t i = 0; i < ARRAYCOUNT(DataTypes); i++)
+	{
+		// A small area, filled by the calling thread alone:
+		cBlockArea Small;
+		testassert(Small.Read(Provider.get(), 13, 19, 90, 100, 5, 40, DataTypes[i]));
+		Provider->VerifyArea(Small);
+
+		// 3 * 3 chunks of 8 sections each, enough for more threads; the top two sections are unallocated:
+		cBlockArea Large;
+		testassert(Large.Read(Provider.get(), 5, 44, 3, 125, 7, 46, DataTypes[i]));
+		Provider->VerifyArea(Large);
+	}
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// The benchmark:
+
+/** Returns the time elapsed since a_Start, in milliseconds */
+static double MSecSince(std::chrono::steady_clock::time_point a_Start)
+{
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - a_Start);
+	return static_cast<double>(Duration.count()) / 1000;
+}
+
+
+
+
+
+static void Benchmark(const char * a_Name, const std::vector<sArea> & a_Areas, int a_NumRounds)
+{
+	size_t NumBlocks = 0;
+	for (std::vector<sArea>::const_iterator itr = a_Areas.begin(), end = a_Areas.end(); itr != end; ++itr)
+	{
+		NumBlocks += itr->GetBlockCount();
+	}
+	printf("%s: %u areas, %u blocks in total, %d rounds\n",
+		a_Name, static_cast<unsigned>(a_Areas.size()), static_cast<unsigned>(NumBlocks), a_NumRounds
+	);
+
+	for (size_t i = 0; i < ARRAYCOUNT(g_TransformNames); i++)
+	{
+		std::vector<sArea> References(a_Areas);
+		auto Start = std::chrono::steady_clock::now();
+		for (int r = 0; r < a_NumRounds; r++)
+		{
+			for (std::vector<sArea>::iterator itr = References.begin(), end = References.end(); itr != end; ++itr)
+			{
+				g_References[i](*itr);
+			}
+		}
+		double ReferenceMSec = MSecSince(Start);
+
+		std::vector<cBlockArea> Areas(a_Areas.size());
+		for (size_t a = 0; a < a_Areas.size(); a++)
+		{
+			ToBlockArea(a_Areas[a], Areas[a], false);
+		}
+		Start = std::chrono::steady_clock::now();
+		for (int r = 0; r < a_NumRounds; r++)
+		{
+			for (std::vector<cBlockArea>::iterator itr = Areas.begin(), end = Areas.end(); itr != end; ++itr)
+			{
+				((*itr).*g_Transforms[i])();
+			}
+		}
+		double AreaMSec = MSecSince(Start);
+		testassert(AreEqual(References[0], FromBlockArea(Areas[0])));
+
+		printf("  %-10s per-block: %9.2f ms, cBlockArea: %9.2f ms, speedup %5.2fx\n",
+			g_TransformNames[i], ReferenceMSec, AreaMSec, ReferenceMSec / std::max(AreaMSec, 0.001)
+		);
+	}
+
+	// Merging the packed areas into same-sized ones, the way the prefabs are drawn:
+	std::vector<sArea> ReferenceDsts(a_Areas);
+	std::vector<cBlockArea> Srcs(a_Areas.size()), Dsts(a_Areas.size());
+	for (size_t a = 0; a < a_Areas.size(); a++)
+	{
+		ToBlockArea(a_Areas[a], Srcs[a], true);
+		ToBlockArea(a_Areas[a], Dsts[a], false);
+	}
+	auto Start = std::chrono::steady_clock::now();
+	for (int r = 0; r < a_NumRounds; r++)
+	{
+		for (size_t a = 0; a < a_Areas.size(); a++)
+		{
+			ReferenceOverwrite(ReferenceDsts[a], a_Areas[a]);
+		}
+	}
+	double ReferenceMSec = MSecSince(Start);
+	Start = std::chrono::steady_clock::now();
+	for (int r = 0; r < a_NumRounds; r++)
+	{
+		for (size_t a = 0; a < a_Areas.size(); a++)
+		{
+			Dsts[a].Merge(Srcs[a], 0, 0, 0, cBlockArea::msOverwrite);
+		}
+	}
+	double AreaMSec = MSecSince(Start);
+	for (size_t a = 0; a < a_Areas.size(); a++)
+	{
+		testassert(AreEqual(FromBlockArea(Dsts[a]), a_Areas[a]));
+	}
+	printf("  %-10s per-block: %9.2f ms, packed rows: %9.2f ms, speedup %5.2fx\n",
+		"Overwrite", ReferenceMSec, AreaMSec, ReferenceMSec / std::max(AreaMSec, 0.001)
+	);
+
+	// Metas, blocklight and skylight, one byte per block vs. packed:
+	printf("  Nibble arrays: %u KiB unpacked, %u KiB packed\n",
+		static_cast<unsigned>(3 * NumBlocks / 1024), static_cast<unsigned>(3 * ((NumBlocks + 1) / 2) / 1024)
+	);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	std::vector<sArea> Prefabs = LoadPrefabs();
+	std::vector<sArea> Large;
+	Large.push_back(CreateRandomArea(256, 64, 256));
+	std::vector<sArea> Odd;
+	Odd.push_back(CreateRandomArea(37, 5, 53));
+
+	TestTransforms(Prefabs);
+	TestTransforms(Odd);
+	TestPackedMerge();
+	TestPackedCropExpand();
+	TestPackingRoundTrip();
+	TestPackingKernels(Prefabs[0]);
+	TestPackingKernels(Odd[0]);
+	TestRead();
+	printf("cBlockArea matches the per-block loops.\n");
+
+	Benchmark("Plains village prefabs", Prefabs, 100);
+	Benchmark("Large area", Large, 3);
+	return 0;
+}
+
+
+
+
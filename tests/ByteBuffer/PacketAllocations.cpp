@@ -0,0 +1,273 @@
+
+// PacketAllocations.cpp
+
+// Checks that composing and sending packets through cPacketizer doesn't allocate any memory, and that the packets
+// are back-patched with correct headers: the packets are composed through a test protocol that sends them
+// the same way as the 1.8 protocol sends the uncompressed game packets, and are compared to independently encoded ones.
+
+#include "Globals.h"
+#include "Protocol/Packetizer.h"
+
+
+
+
+
+/** Number of allocations made while s_IsCounting is set */
+static size_t s_NumAllocations = 0;
+static bool s_IsCounting = false;
+
+
+
+
+
+void * operator new(size_t a_Size)
+{
+	if (s_IsCounting)
+	{
+		s_NumAllocations += 1;
+	}
+	void * res = malloc(a_Size);
+	if (res == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return res;
+}
+
+
+
+
+
+void operator delete(void * a_Ptr) throw()
+{
+	free(a_Ptr);
+}
+
+
+
+
+
+/** A protocol that only composes the test packets, and "sends" them into a preallocated memory block. */
+class cTestProtocol :
+	public cProtocol
+{
+	typedef cProtocol super;
+
+public:
+
+	cTestProtocol(void) :
+		super(nullptr),
+		m_SentSize(0)
+	{
+	}
+
+
+	/** Composes a packet with the specified text through cPacketizer. The packet is sent when the packetizer goes out of scope. */
+	void SendTestPacket(const AString & a_Text)
+	{
+		cPacketizer Pkt(*this, 0x04);
+		Pkt.WriteBEDouble(1.5);
+		Pkt.WriteBEDouble(64);
+		Pkt.WriteBEDouble(-2.5);
+		Pkt.WriteBool(true);
+		Pkt.WriteString(a_Text);
+		Pkt.WritePosition64(10, 20, 30);
+	}
+
+
+	/** Returns the data sent for the last packet. */
+	const char * GetSentData(size_t & a_Size) const
+	{
+		a_Size = m_SentSize;
+		return m_Sent;
+	}
+
+
+	// The rest of the cProtocol interface is not used:
+	virtual void DataReceived(const char * a_Data, size_t a_Size) override {}
+	virtual void SendAttachEntity               (const cEntity & a_Entity, const cEntity * a_Vehicle) override {}
+	virtual void SendBlockAction                (int a_BlockX, int a_BlockY, int a_BlockZ, char a_Byte1, char a_Byte2, BLOCKTYPE a_BlockType) override {}
+	virtual void SendBlockBreakAnim             (UInt32 a_EntityID, int a_BlockX, int a_BlockY, int a_BlockZ, char a_Stage) override {}
+	virtual void SendBlockChange                (int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta) override {}
+	virtual void SendBlockChanges               (int a_ChunkX, int a_ChunkZ, const sSetBlockVector & a_Changes) override {}
+	virtual void SendChat                       (const AString & a_Message) override {}
+	virtual void SendChat                       (const cCompositeChat & a_Message) override {}
+	virtual void SendChunkData                  (int a_ChunkX, int a_ChunkZ, cChunkDataSerializer & a_Serializer) override {}
+	virtual void SendCollectEntity              (const cEntity & a_Entity, const cPlayer & a_Player) override {}
+	virtual void SendDestroyEntity              (const cEntity & a_Entity) override {}
+	virtual void SendDisconnect                 (const AString & a_Reason) override {}
+	virtual void SendEditSign                   (int a_BlockX, int a_BlockY, int a_BlockZ) override {}
+	virtual void SendEntityEffect               (const cEntity & a_Entity, int a_EffectID, int a_Amplifier, short a_Duration) override {}
+	virtual void SendEntityEquipment            (const cEntity & a_Entity, short a_SlotNum, const cItem & a_Item) override {}
+	virtual void SendEntityHeadLook             (const cEntity & a_Entity) override {}
+	virtual void SendEntityLook                 (const cEntity & a_Entity) override {}
+	virtual void SendEntityMetadata             (const cEntity & a_Entity) override {}
+	virtual void SendEntityProperties           (const cEntity & a_Entity) override {}
+	virtual void SendEntityRelMove              (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ) override {}
+	virtual void SendEntityRelMoveLook          (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ) override {}
+	virtual void SendEntityStatus               (const cEntity & a_Entity, char a_Status) override {}
+	virtual void SendEntityVelocity             (const cEntity & a_Entity) override {}
+	virtual void SendExplosion                  (double a_BlockX, double a_BlockY, double a_BlockZ, float a_Radius, const cVector3iArray & a_BlocksAffected, const Vector3d & a_PlayerMotion) override {}
+	virtual void SendGameMode                   (eGameMode a_GameMode) override {}
+	virtual void SendHealth                     (void) override {}
+	virtual void SendInventorySlot              (char a_WindowID, short a_SlotNum, const cItem & a_Item) override {}
+	virtual void SendKeepAlive                  (int a_PingID) override {}
+	virtual void SendLogin                      (const cPlayer & a_Player, const cWorld & a_World) override {}
+	virtual void SendLoginSuccess               (void) override {}
+	virtual void SendMapColumn                  (int a_ID, int a_X, int a_Y, const Byte * a_Colors, unsigned int a_Length, unsigned int m_Scale) override {}
+	virtual void SendMapDecorators              (int a_ID, const cMapDecoratorList & a_Decorators, unsigned int m_Scale) override {}
+	virtual void SendMapInfo                    (int a_ID, unsigned int a_Scale) override {}
+	virtual void SendPaintingSpawn              (const cPainting & a_Painting) override {}
+	virtual void SendPickupSpawn                (const cPickup & a_Pickup) override {}
+	virtual void SendPlayerAbilities            (void) override {}
+	virtual void SendEntityAnimation            (const cEntity & a_Entity, char a_Animation) override {}
+	virtual void SendParticleEffect             (const AString & a_SoundName, float a_SrcX, float a_SrcY, float a_SrcZ, float a_OffsetX, float a_OffsetY, float a_OffsetZ, float a_ParticleData, int a_ParticleAmount) override {}
+	virtual void SendParticleEffect             (const AString & a_SoundName, Vector3f a_Src, Vector3f a_Offset, float a_ParticleData, int a_ParticleAmount, std::array<int, 2> a_Data) override {}
+	virtual void SendPlayerListAddPlayer        (const cPlayer & a_Player) override {}
+	virtual void SendPlayerListRemovePlayer     (const cPlayer & a_Player) override {}
+	virtual void SendPlayerListUpdateGameMode   (const cPlayer & a_Player) override {}
+	virtual void SendPlayerListUpdatePing       (const cPlayer & a_Player) override {}
+	virtual void SendPlayerListUpdateDisplayName(const cPlayer & a_Player, const AString & a_CustomName) override {}
+	virtual void SendPlayerMaxSpeed             (void) override {}
+	virtual void SendPlayerMoveLook             (void) override {}
+	virtual void SendPlayerPosition             (void) override {}
+	virtual void SendPlayerSpawn                (const cPlayer & a_Player) override {}
+	virtual void SendPluginMessage              (const AString & a_Channel, const AString & a_Message) override {}
+	virtual void SendRemoveEntityEffect         (const cEntity & a_Entity, int a_EffectID) override {}
+	virtual void SendRespawn                    (eDimension a_Dimension, bool a_ShouldIgnoreDimensionChecks) override {}
+	virtual void SendExperience                 (void) override {}
+	virtual void SendExperienceOrb              (const cExpOrb & a_ExpOrb) override {}
+	virtual void SendScoreboardObjective        (const AString & a_Name, const AString & a_DisplayName, Byte a_Mode) override {}
+	virtual void SendScoreUpdate                (const AString & a_Objective, const AString & a_Player, cObjective::Score a_Score, Byte a_Mode) override {}
+	virtual void SendDisplayObjective           (const AString & a_Objective, cScoreboard::eDisplaySlot a_Display) override {}
+	virtual void SendSoundEffect                (const AString & a_SoundName, double a_X, double a_Y, double a_Z, float a_Volume, float a_Pitch) override {}
+	virtual void SendSoundParticleEffect        (int a_EffectID, int a_SrcX, int a_SrcY, int a_SrcZ, int a_Data) override {}
+	virtual void SendSpawnFallingBlock          (const cFallingBlock & a_FallingBlock) override {}
+	virtual void SendSpawnMob                   (const cMonster & a_Mob) override {}
+	virtual void SendSpawnObject                (const cEntity & a_Entity, char a_ObjectType, int a_ObjectData, Byte a_Yaw, Byte a_Pitch) override {}
+	virtual void SendSpawnVehicle               (const cEntity & a_Vehicle, char a_VehicleType, char a_VehicleSubType) override {}
+	virtual void SendStatistics                 (const cStatManager & a_Manager) override {}
+	virtual void SendTabCompletionResults       (const AStringVector & a_Results) override {}
+	virtual void SendTeleportEntity             (const cEntity & a_Entity) override {}
+	virtual void SendThunderbolt                (int a_BlockX, int a_BlockY, int a_BlockZ) override {}
+	virtual void SendTimeUpdate                 (Int64 a_WorldAge, Int64 a_TimeOfDay, bool a_DoDaylightCycle) override {}
+	virtual void SendUnloadChunk                (int a_ChunkX, int a_ChunkZ) override {}
+	virtual void SendUpdateBlockEntity          (cBlockEntity & a_BlockEntity) override {}
+	virtual void SendUpdateSign                 (int a_BlockX, int a_BlockY, int a_BlockZ, const AString & a_Line1, const AString & a_Line2, const AString & a_Line3, const AString & a_Line4) override {}
+	virtual void SendUseBed                     (const cEntity & a_Entity, int a_BlockX, int a_BlockY, int a_BlockZ) override {}
+	virtual void SendWeather                    (eWeather a_Weather) override {}
+	virtual void SendWholeInventory             (const cWindow    & a_Window) override {}
+	virtual void SendWindowClose                (const cWindow    & a_Window) override {}
+	virtual void SendWindowOpen                 (const cWindow & a_Window) override {}
+	virtual void SendWindowProperty             (const cWindow & a_Window, short a_Property, short a_Value) override {}
+	virtual AString GetAuthServerID(void) override { return AString(); }
+
+protected:
+
+	/** The data sent for the last packet */
+	char m_Sent[70000];
+	size_t m_SentSize;
+
+
+	virtual void SendData(const char * a_Data, size_t a_Size) override
+	{
+		testassert(a_Size <= sizeof(m_Sent));
+		memcpy(m_Sent, a_Data, a_Size);
+		m_SentSize = a_Size;
+	}
+
+
+	virtual void SendPacket(cPacketizer & a_Pkt) override
+	{
+		// Same as cProtocol180::SendPacket() for the uncompressed game packets, a (length, data length) header:
+		size_t PacketLen;
+		a_Pkt.GetPacketData(PacketLen);
+		a_Pkt.PrependVarInt32(0);
+		a_Pkt.PrependVarInt32(static_cast<UInt32>(PacketLen) + 1);
+		size_t WholeLen;
+		const char * WholePacket = a_Pkt.GetWholePacket(WholeLen);
+		SendData(WholePacket, WholeLen);
+		a_Pkt.Discard();
+	}
+} ;
+
+
+
+
+
+/** Returns the test packet with the specified text, encoded independently of cPacketizer. */
+static AString EncodeTestPacket(const AString & a_Text)
+{
+	cByteBuffer Payload(70000);
+	testassert(Payload.WriteVarInt32(0x04));
+	testassert(Payload.WriteBEDouble(1.5));
+	testassert(Payload.WriteBEDouble(64));
+	testassert(Payload.WriteBEDouble(-2.5));
+	testassert(Payload.WriteBool(true));
+	testassert(Payload.WriteVarUTF8String(a_Text));
+	testassert(Payload.WritePosition64(10, 20, 30));
+	AString PayloadData;
+	Payload.ReadAll(PayloadData);
+
+	cByteBuffer Packet(70000);
+	testassert(Packet.WriteVarInt32(static_cast<UInt32>(PayloadData.size()) + 1));
+	testassert(Packet.WriteVarInt32(0));
+	testassert(Packet.Write(PayloadData.data(), PayloadData.size()));
+	AString PacketData;
+	Packet.ReadAll(PacketData);
+	return PacketData;
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	cTestProtocol Protocol;
+
+	// Texts giving packet lengths that are encoded in one, two and three bytes:
+	AString Texts[] =
+	{
+		AString("Hello, world!"),
+		AString(200, 'a'),
+		AString(20000, 'b'),
+	};
+	for (size_t i = 0; i < ARRAYCOUNT(Texts); i++)
+	{
+		AString Expected = EncodeTestPacket(Texts[i]);
+
+		s_IsCounting = true;
+		for (int n = 0; n < 1000; n++)
+		{
+			Protocol.SendTestPacket(Texts[i]);
+		}
+		s_IsCounting = false;
+		testassert(s_NumAllocations == 0);
+
+		size_t SentSize;
+		const char * Sent = Protocol.GetSentData(SentSize);
+		testassert(SentSize == Expected.size());
+		testassert(memcmp(Sent, Expected.data(), SentSize) == 0);
+	}
+
+	// The VarInts encoded for the compressed packets' headers:
+	UInt32 Values[] = { 0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0x1fffff, 0x200000, 0xffffffff };
+	for (size_t i = 0; i < ARRAYCOUNT(Values); i++)
+	{
+		char VarInt[cPacketizer::MAX_VARINT32_SIZE];
+		size_t Size = cPacketizer::EncodeVarInt32(Values[i], VarInt);
+		cByteBuffer Buffer(16);
+		testassert(Buffer.WriteVarInt32(Values[i]));
+		AString Expected;
+		Buffer.ReadAll(Expected);
+		testassert(AString(VarInt, Size) == Expected);
+	}
+
+	LOG("PacketAllocations test finished, no allocations while composing %d packets.", static_cast<int>(1000 * ARRAYCOUNT(Texts)));
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,453 @@
+
+// RecipeLookupBenchmark.cpp
+
+// Checks the indexed recipe lookup in cCraftingRecipes against the former matcher that tried all the recipes in order,
+// and measures both on the grids made from all the recipes in crafting.txt, on the grids with an item missing
+// and on pseudo-random grids.
+// Needs to be run in the folder with crafting.txt and items.ini, the recipes are loaded by cCraftingRecipes itself.
+
+#include "Globals.h"
+#include "CraftingRecipes.h"
+
+
+
+
+
+/** A 3x3 crafting grid */
+struct sGrid
+{
+	cItem m_Items[cCraftingRecipes::MAX_GRID_WIDTH * cCraftingRecipes::MAX_GRID_HEIGHT];
+} ;
+
+/** Pseudo-random generator state */
+static UInt32 g_Seed = 0x12345678;
+
+
+
+
+
+static int Random(int a_Max)
+{
+	g_Seed = g_Seed * 1103515245 + 12345;
+	return static_cast<int>((g_Seed >> 16) % static_cast<UInt32>(a_Max));
+}
+
+
+
+
+
+/** Exposes the recipes loaded by cCraftingRecipes and adds the former lookup that tried all the recipes in order. */
+class cTestCraftingRecipes :
+	public cCraftingRecipes
+{
+	typedef cCraftingRecipes super;
+
+public:
+	using super::cRecipe;
+	using super::cRecipeSlots;
+
+	size_t GetNumRecipes(void) const { return m_Recipes.size(); }
+
+	const cRecipe & GetRecipeAt(size_t a_Idx) const { return *m_Recipes[a_Idx]; }
+
+	/** Finds the recipe through the index, the way GetRecipe() does. */
+	bool FindIndexed(const sGrid & a_Grid, cRecipe & a_Recipe)
+	{
+		return FindRecipe(a_Grid.m_Items, MAX_GRID_WIDTH, MAX_GRID_HEIGHT, a_Recipe);
+	}
+
+	/** Finds the recipe by cropping the grid and trying all the recipes in order, the way cCraftingRecipes used to.
+	Returns true and fills in a_Recipe, with all its coords set to match the grid, if found. */
+	bool FindLinear(const sGrid & a_Grid, cRecipe & a_Recipe)
+	{
+		const cItem * CraftingGrid = a_Grid.m_Items;
+		int GridLeft = MAX_GRID_WIDTH, GridTop = MAX_GRID_HEIGHT;
+		int GridRight = 0,  GridBottom = 0;
+		for (int y = 0; y < MAX_GRID_HEIGHT; y++)
+		{
+			for (int x = 0; x < MAX_GRID_WIDTH; x++)
+			{
+				if (!CraftingGrid[x + y * MAX_GRID_WIDTH].IsEmpty())
+				{
+					GridRight  = std::max(x, GridRight);
+					GridBottom = std::max(y, GridBottom);
+					GridLeft   = std::min(x, GridLeft);
+					GridTop    = std::min(y, GridTop);
+				}
+			}
+		}
+		int GridWidth = GridRight - GridLeft + 1;
+		int GridHeight = GridBottom - GridTop + 1;
+
+		// Search in the possibly minimized grid, but keep the stride:
+		const cItem * Grid = CraftingGrid + GridLeft + (MAX_GRID_WIDTH * GridTop);
+		if (!FindRecipeCropped(Grid, GridWidth, GridHeight, MAX_GRID_WIDTH, a_Recipe))
+		{
+			return false;
+		}
+
+		// Move the recipe to correspond to the original crafting grid:
+		for (cRecipeSlots::iterator itrS = a_Recipe.m_Ingredients.begin(); itrS != a_Recipe.m_Ingredients.end(); ++itrS)
+		{
+			itrS->x += GridLeft;
+			itrS->y += GridTop;
+		}
+		HandleFireworks(CraftingGrid, &a_Recipe, MAX_GRID_WIDTH);
+		return true;
+	}
+
+protected:
+
+	/** Tries all the recipes at all the offsets in the cropped grid, in order. */
+	bool FindRecipeCropped(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, int a_GridStride, cRecipe & a_Recipe)
+	{
+		for (cRecipes::const_iterator itr = m_Recipes.begin(); itr != m_Recipes.end(); ++itr)
+		{
+			int MaxOfsX = a_GridWidth  - (*itr)->m_Width;
+			int MaxOfsY = a_GridHeight - (*itr)->m_Height;
+			for (int x = 0; x <= MaxOfsX; x++)
+			{
+				for (int y = 0; y <= MaxOfsY; y++)
+				{
+					if (MatchRecipe(a_CraftingGrid, a_GridWidth, a_GridHeight, a_GridStride, **itr, x, y, a_Recipe))
+					{
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	/** The former matcher of a single recipe at a single offset within the cropped grid.
+	The only change is that the regular ingredients in the returned recipe are moved by the offset, the former code left them
+	at the recipe's own coords, so the crafting grid took the items from the wrong cells for a recipe smaller than the grid. */
+	bool MatchRecipe(const cItem * a_CraftingGrid, int a_GridWidth, int a_GridHeight, int a_GridStride, const cRecipe & a_Recipe, int a_OffsetX, int a_OffsetY, cRecipe & a_Match)
+	{
+		// Check the regular items first:
+		bool HasMatched[MAX_GRID_WIDTH][MAX_GRID_HEIGHT];
+		memset(HasMatched, 0, sizeof(HasMatched));
+		for (cRecipeSlots::const_iterator itrS = a_Recipe.m_Ingredients.begin(); itrS != a_Recipe.m_Ingredients.end(); ++itrS)
+		{
+			if ((itrS->x < 0) || (itrS->y < 0))
+			{
+				// "Anywhere" item, process later
+				continue;
+			}
+			testassert(itrS->x + a_OffsetX < a_GridWidth);
+			testassert(itrS->y + a_OffsetY < a_GridHeight);
+			int GridID = (itrS->x + a_OffsetX) + a_GridStride * (itrS->y + a_OffsetY);
+			const cItem & Item = itrS->m_Item;
+			if (
+				(Item.m_ItemType != a_CraftingGrid[GridID].m_ItemType) ||
+				(Item.m_ItemCount > a_CraftingGrid[GridID].m_ItemCount) ||
+				((Item.m_ItemDamage >= 0) && (Item.m_ItemDamage != a_CraftingGrid[GridID].m_ItemDamage))
+			)
+			{
+				return false;
+			}
+			HasMatched[itrS->x + a_OffsetX][itrS->y + a_OffsetY] = true;
+		}
+
+		// Process the "anywhere" items, first-come-first-served; the fixed coord of "*:N" and "N:*" doesn't get the offset:
+		cRecipeSlots MatchedSlots;
+		for (cRecipeSlots::const_iterator itrS = a_Recipe.m_Ingredients.begin(); itrS != a_Recipe.m_Ingredients.end(); ++itrS)
+		{
+			if ((itrS->x >= 0) && (itrS->y >= 0))
+			{
+				// Regular item, already processed
+				continue;
+			}
+			int StartX = 0, EndX = a_GridWidth  - 1;
+			int StartY = 0, EndY = a_GridHeight - 1;
+			if (itrS->x >= 0)
+			{
+				StartX = itrS->x;
+				EndX = itrS->x;
+			}
+			else if (itrS->y >= 0)
+			{
+				StartY = itrS->y;
+				EndY = itrS->y;
+			}
+			bool Found = false;
+			for (int x = StartX; (x <= EndX) && !Found; x++)
+			{
+				for (int y = StartY; y <= EndY; y++)
+				{
+					if (HasMatched[x][y])
+					{
+						continue;
+					}
+					int GridIdx = x + a_GridStride * y;
+					if (
+						(a_CraftingGrid[GridIdx].m_ItemType == itrS->m_Item.m_ItemType) &&
+						((itrS->m_Item.m_ItemDamage < 0) || (itrS->m_Item.m_ItemDamage == a_CraftingGrid[GridIdx].m_ItemDamage))
+					)
+					{
+						HasMatched[x][y] = true;
+						Found = true;
+						MatchedSlots.push_back(*itrS);
+						MatchedSlots.back().x = x;
+						MatchedSlots.back().y = y;
+						break;
+					}
+				}
+			}
+			if (!Found)
+			{
+				return false;
+			}
+		}
+
+		// Check if the whole grid has matched:
+		for (int x = 0; x < a_GridWidth; x++)
+		{
+			for (int y = 0; y < a_GridHeight; y++)
+			{
+				if (!HasMatched[x][y] && !a_CraftingGrid[x + a_GridStride * y].IsEmpty())
+				{
+					return false;
+				}
+			}
+		}
+
+		// The recipe has matched, copy it with the coords set to match the cropped grid:
+		a_Match.m_Result = a_Recipe.m_Result;
+		a_Match.m_Width  = a_Recipe.m_Width;
+		a_Match.m_Height = a_Recipe.m_Height;
+		a_Match.m_Ingredients.clear();
+		for (cRecipeSlots::const_iterator itrS = a_Recipe.m_Ingredients.begin(); itrS != a_Recipe.m_Ingredients.end(); ++itrS)
+		{
+			if ((itrS->x >= 0) && (itrS->y >= 0))
+			{
+				a_Match.m_Ingredients.push_back(*itrS);
+				a_Match.m_Ingredients.back().x += a_OffsetX;
+				a_Match.m_Ingredients.back().y += a_OffsetY;
+			}
+		}
+		a_Match.m_Ingredients.insert(a_Match.m_Ingredients.end(), MatchedSlots.begin(), MatchedSlots.end());
+		return true;
+	}
+} ;
+
+typedef cTestCraftingRecipes::cRecipe cRecipe;
+typedef cTestCraftingRecipes::cRecipeSlots cRecipeSlots;
+
+
+
+
+
+/** Returns true if both recipes have the same result and the same ingredients in the same cells */
+static bool AreSameRecipes(const cRecipe & a_Recipe1, const cRecipe & a_Recipe2)
+{
+	if (
+		!a_Recipe1.m_Result.IsEqual(a_Recipe2.m_Result) ||
+		(a_Recipe1.m_Result.m_ItemCount != a_Recipe2.m_Result.m_ItemCount) ||
+		(a_Recipe1.m_Ingredients.size() != a_Recipe2.m_Ingredients.size())
+	)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < a_Recipe1.m_Ingredients.size(); i++)
+	{
+		const cRecipeSlots::value_type & Slot1 = a_Recipe1.m_Ingredients[i];
+		const cRecipeSlots::value_type & Slot2 = a_Recipe2.m_Ingredients[i];
+		if (
+			(Slot1.x != Slot2.x) || (Slot1.y != Slot2.y) ||
+			(Slot1.m_Item.m_ItemType != Slot2.m_Item.m_ItemType) ||
+			(Slot1.m_Item.m_ItemDamage != Slot2.m_Item.m_ItemDamage)
+		)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+
+
+/** Creates the grid that the player would lay out for the recipe; the "anywhere" items go into the first free cells.
+Returns false if the recipe doesn't fit. */
+static bool CreateRecipeGrid(const cRecipe & a_Recipe, sGrid & a_Grid)
+{
+	for (size_t i = 0; i < ARRAYCOUNT(a_Grid.m_Items); i++)
+	{
+		a_Grid.m_Items[i].Empty();
+	}
+	for (cRecipeSlots::const_iterator itr = a_Recipe.m_Ingredients.begin(); itr != a_Recipe.m_Ingredients.end(); ++itr)
+	{
+		if ((itr->x >= 0) && (itr->y >= 0))
+		{
+			if ((itr->x >= 3) || (itr->y >= 3))
+			{
+				return false;
+			}
+			a_Grid.m_Items[itr->x + 3 * itr->y] = cItem(itr->m_Item.m_ItemType, 1, std::max<short>(itr->m_Item.m_ItemDamage, 0));
+		}
+	}
+	for (cRecipeSlots::const_iterator itr = a_Recipe.m_Ingredients.begin(); itr != a_Recipe.m_Ingredients.end(); ++itr)
+	{
+		if ((itr->x >= 0) && (itr->y >= 0))
+		{
+			continue;
+		}
+		bool Placed = false;
+		for (int x = 0; (x < 3) && !Placed; x++)
+		{
+			for (int y = 0; (y < 3) && !Placed; y++)
+			{
+				cItem & Item = a_Grid.m_Items[x + 3 * y];
+				if (!Item.IsEmpty() || ((itr->x >= 0) && (itr->x != x)) || ((itr->y >= 0) && (itr->y != y)))
+				{
+					continue;
+				}
+				Item = cItem(itr->m_Item.m_ItemType, 1, std::max<short>(itr->m_Item.m_ItemDamage, 0));
+				Placed = true;
+			}
+		}
+		if (!Placed)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+
+
+/** Checks that both lookups find the same recipe for each grid, returns the number of grids with a recipe found */
+static int Verify(cTestCraftingRecipes & a_Recipes, const std::vector<sGrid> & a_Grids)
+{
+	int NumFound = 0;
+	cRecipe Linear, Indexed;
+	for (std::vector<sGrid>::const_iterator itr = a_Grids.begin(), end = a_Grids.end(); itr != end; ++itr)
+	{
+		bool HasLinear = a_Recipes.FindLinear(*itr, Linear);
+		bool HasIndexed = a_Recipes.FindIndexed(*itr, Indexed);
+		testassert(HasLinear == HasIndexed);
+		if (HasIndexed)
+		{
+			testassert(AreSameRecipes(Linear, Indexed));
+			NumFound += 1;
+		}
+	}
+	return NumFound;
+}
+
+
+
+
+
+/** Looks up all the grids a_NumRounds times, returns the time taken per lookup in microseconds */
+template <bool IsIndexed>
+static double Measure(cTestCraftingRecipes & a_Recipes, const std::vector<sGrid> & a_Grids, int a_NumRounds)
+{
+	int Checksum = 0;
+	cRecipe Recipe;
+	auto Start = std::chrono::steady_clock::now();
+	for (int r = 0; r < a_NumRounds; r++)
+	{
+		for (std::vector<sGrid>::const_iterator itr = a_Grids.begin(), end = a_Grids.end(); itr != end; ++itr)
+		{
+			bool Found = IsIndexed ? a_Recipes.FindIndexed(*itr, Recipe) : a_Recipes.FindLinear(*itr, Recipe);
+			Checksum += Found ? Recipe.m_Result.m_ItemType : 0;
+		}
+	}
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start);
+	testassert(Checksum != 0x7fffffff);  // Keep the lookups from being optimized away
+	return static_cast<double>(Duration.count()) / (static_cast<double>(a_Grids.size()) * a_NumRounds);
+}
+
+
+
+
+
+static void Benchmark(const char * a_Name, cTestCraftingRecipes & a_Recipes, const std::vector<sGrid> & a_Grids, int a_NumRounds)
+{
+	int NumFound = Verify(a_Recipes, a_Grids);
+	double LinearUSec = Measure<false>(a_Recipes, a_Grids, a_NumRounds);
+	double IndexedUSec = Measure<true>(a_Recipes, a_Grids, a_NumRounds);
+	printf("  %-24s %5u grids, %5d matching; all recipes: %8.3f us, indexed: %8.3f us per lookup, speedup %6.1fx\n",
+		a_Name, static_cast<unsigned>(a_Grids.size()), NumFound,
+		LinearUSec, IndexedUSec, LinearUSec / std::max(IndexedUSec, 0.0001)
+	);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	cTestCraftingRecipes Recipes;
+	testassert(Recipes.GetNumRecipes() > 0);
+	printf("Loaded %u recipes\n", static_cast<unsigned>(Recipes.GetNumRecipes()));
+
+	// The grids laid out for each recipe, and the same grids with one item missing; collect the ingredients, too:
+	std::vector<sGrid> RecipeGrids, PartialGrids;
+	std::vector<cItem> Ingredients;
+	for (size_t i = 0; i < Recipes.GetNumRecipes(); i++)
+	{
+		const cRecipe & Recipe = Recipes.GetRecipeAt(i);
+		for (cRecipeSlots::const_iterator itr = Recipe.m_Ingredients.begin(); itr != Recipe.m_Ingredients.end(); ++itr)
+		{
+			Ingredients.push_back(cItem(itr->m_Item.m_ItemType, 1, std::max<short>(itr->m_Item.m_ItemDamage, 0)));
+		}
+		sGrid Grid;
+		if (!CreateRecipeGrid(Recipe, Grid))
+		{
+			continue;
+		}
+		RecipeGrids.push_back(Grid);
+		int NumItems = 0;
+		for (size_t j = 0; j < ARRAYCOUNT(Grid.m_Items); j++)
+		{
+			NumItems += Grid.m_Items[j].IsEmpty() ? 0 : 1;
+		}
+		if (NumItems < 2)
+		{
+			continue;
+		}
+		for (int j = Random(NumItems); ; j = (j + 1) % static_cast<int>(ARRAYCOUNT(Grid.m_Items)))
+		{
+			if (!Grid.m_Items[j].IsEmpty())
+			{
+				Grid.m_Items[j].Empty();
+				break;
+			}
+		}
+		PartialGrids.push_back(Grid);
+	}
+	testassert(!Ingredients.empty());
+
+	// Pseudo-random grids of the items used in the recipes:
+	std::vector<sGrid> RandomGrids(2000);
+	for (std::vector<sGrid>::iterator itr = RandomGrids.begin(), end = RandomGrids.end(); itr != end; ++itr)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(itr->m_Items); i++)
+		{
+			if (Random(2) == 0)
+			{
+				itr->m_Items[i] = Ingredients[static_cast<size_t>(Random(static_cast<int>(Ingredients.size())))];
+			}
+		}
+	}
+
+	// Each recipe's grid needs to match some recipe, either the recipe itself or an earlier one with the same ingredients:
+	testassert(Verify(Recipes, RecipeGrids) == static_cast<int>(RecipeGrids.size()));
+	printf("The indexed lookup matches trying all the recipes.\n");
+
+	Benchmark("Recipe grids", Recipes, RecipeGrids, 20);
+	Benchmark("Grids with item missing", Recipes, PartialGrids, 20);
+	Benchmark("Random grids", Recipes, RandomGrids, 5);
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,99 @@
+
+// Stubs.cpp
+
+// Implements the stubs of the plugin manager, fireworks and enchantments that cCraftingRecipes needs, so that the test doesn't need the whole server.
+
+#include "Globals.h"
+#include "Bindings/PluginManager.h"
+#include "Enchantments.h"
+#include "WorldStorage/FireworksSerializer.h"
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPluginManager:
+
+cPluginManager * cPluginManager::Get(void)
+{
+	return nullptr;
+}
+
+
+
+
+
+bool cPluginManager::CallHookCraftingNoRecipe(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraftingRecipe & a_Recipe)
+{
+	return false;
+}
+
+
+
+
+
+bool cPluginManager::CallHookPostCrafting(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraftingRecipe & a_Recipe)
+{
+	return false;
+}
+
+
+
+
+
+bool cPluginManager::CallHookPreCrafting(cPlayer & a_Player, cCraftingGrid & a_Grid, cCraftingRecipe & a_Recipe)
+{
+	return false;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cFireworkItem:
+
+int cFireworkItem::GetVanillaColourCodeFromDye(NIBBLETYPE a_DyeMeta)
+{
+	return a_DyeMeta;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cEnchantments:
+
+cEnchantments::cEnchantments(void)
+{
+}
+
+
+
+
+
+cEnchantments::cEnchantments(const AString & a_StringSpec)
+{
+}
+
+
+
+
+
+void cEnchantments::Clear(void)
+{
+	m_Enchantments.clear();
+}
+
+
+
+bool cEnchantments::operator ==(const cEnchantments & a_Other) const
+{
+	return (m_Enchantments == a_Other.m_Enchantments);
+}
+
+
+
+
@@ -0,0 +1,434 @@
+// FloodBenchmark.cpp
+
+// Checks cDirtyBlockSet and measures it against the former linear-scan slot storage of cDelayedFluidSimulator,
+// by flooding a 64 x 64 basin, 16 blocks deep, the way cFloodyFluidSimulator spreads the fluids, until it settles.
+// cVanillaFluidSimulator only differs from the floody one in preferring the directions towards the nearest drop;
+// the basin has no drops, so the vanilla simulator spreads the same and the same benchmark covers it.
+
+#include "Globals.h"
+#include "Simulator/DirtyBlockSet.h"
+
+
+
+
+
+/** The slot storage used by cDelayedFluidSimulator before cDirtyBlockSet: one list per Z coord, linearly scanned for duplicates */
+class cLinearScanSlot
+{
+public:
+	bool Add(int a_RelX, int a_RelY, int a_RelZ)
+	{
+		std::vector<UInt16> & Blocks = m_Blocks[a_RelZ];
+		UInt16 Packed = static_cast<UInt16>((a_RelY << 8) | (a_RelZ << 4) | a_RelX);
+		for (std::vector<UInt16>::const_iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
+		{
+			if (*itr == Packed)
+			{
+				return false;
+			}
+		}
+		Blocks.push_back(Packed);
+		return true;
+	}
+
+	size_t GetNumBlocks(void) const
+	{
+		size_t res = 0;
+		for (size_t i = 0; i < ARRAYCOUNT(m_Blocks); i++)
+		{
+			res += m_Blocks[i].size();
+		}
+		return res;
+	}
+
+	void TakeBlocks(std::vector<UInt16> & a_Blocks)
+	{
+		a_Blocks.clear();
+		for (size_t i = 0; i < ARRAYCOUNT(m_Blocks); i++)
+		{
+			a_Blocks.insert(a_Blocks.end(), m_Blocks[i].begin(), m_Blocks[i].end());
+			m_Blocks[i].clear();
+		}
+	}
+
+protected:
+	std::vector<UInt16> m_Blocks[16];
+} ;
+
+
+
+
+
+/** The fluid settings that differ between water and lava, with the defaults of cWorld */
+struct sFluidSettings
+{
+	const char * m_Name;
+	int m_Falloff;
+	int m_TickDelay;
+	int m_NumNeighborsForSource;
+} ;
+
+static const sFluidSettings g_Water = { "water", 1, 5,  2 };
+static const sFluidSettings g_Lava  = { "lava",  2, 30, -1 };
+
+
+
+
+
+/** A closed basin of 4 x 4 chunks, flooded from a source wall along two of its sides.
+Each chunk has its own delay slots; the blocks are queued and simulated the same way cDelayedFluidSimulator does it,
+including waking up the changed block and all its neighbors whenever a block changes, as cChunk::SetBlock() does. */
+template <class SlotType>
+class cBasin
+{
+public:
+	static const int NUM_CHUNKS = 4;
+	static const int SIZE = NUM_CHUNKS * cChunkDef::Width;
+	static const int DEPTH = 16;
+	static const int FLOOR_Y = 63;
+
+	/** Level of the blocks that have no fluid */
+	static const int AIR = -1;
+
+
+	cBasin(const sFluidSettings & a_Settings) :
+		m_Settings(a_Settings),
+		m_AddSlotNum(a_Settings.m_TickDelay - 1),
+		m_SimSlotNum(0),
+		m_NumSimulated(0)
+	{
+		for (int i = 0; i < NUM_CHUNKS * NUM_CHUNKS; i++)
+		{
+			m_Slots[i] = new SlotType[a_Settings.m_TickDelay];
+		}
+		for (int y = 0; y < DEPTH; y++)
+		{
+			for (int z = 0; z < SIZE; z++)
+			{
+				for (int x = 0; x < SIZE; x++)
+				{
+					m_Levels[y][z][x] = AIR;
+				}
+			}
+		}
+
+		// The source walls along the X = 0 and Z = 0 sides:
+		for (int y = 0; y < DEPTH; y++)
+		{
+			for (int i = 0; i < SIZE; i++)
+			{
+				SetLevel(i, y, 0, 0);
+				SetLevel(0, y, i, 0);
+			}
+		}
+	}
+
+
+	~cBasin()
+	{
+		for (int i = 0; i < NUM_CHUNKS * NUM_CHUNKS; i++)
+		{
+			delete[] m_Slots[i];
+		}
+	}
+
+
+	/** Runs the ticks until there are no more blocks queued. Returns the number of ticks it took. */
+	int RunUntilSettled(void)
+	{
+		int NumTicks = 0;
+		while (GetNumQueued() > 0)
+		{
+			Tick();
+			NumTicks += 1;
+			testassert(NumTicks < 100000);
+		}
+		return NumTicks;
+	}
+
+
+	/** Returns the number of the source blocks in the basin */
+	int GetNumSources(void) const
+	{
+		int res = 0;
+		for (int y = 0; y < DEPTH; y++)
+		{
+			for (int z = 0; z < SIZE; z++)
+			{
+				for (int x = 0; x < SIZE; x++)
+				{
+					res += (m_Levels[y][z][x] == 0) ? 1 : 0;
+				}
+			}
+		}
+		return res;
+	}
+
+
+	/** Returns the number of the simulated blocks */
+	int GetNumSimulated(void) const { return m_NumSimulated; }
+
+protected:
+	const sFluidSettings & m_Settings;
+	SlotType * m_Slots[NUM_CHUNKS * NUM_CHUNKS];
+	int m_AddSlotNum;
+	int m_SimSlotNum;
+	int m_Levels[DEPTH][SIZE][SIZE];
+	std::vector<UInt16> m_SimBlocks;
+	int m_NumSimulated;
+
+
+	int GetLevel(int a_X, int a_Y, int a_Z) const
+	{
+		if ((a_X < 0) || (a_X >= SIZE) || (a_Y < 0) || (a_Y >= DEPTH) || (a_Z < 0) || (a_Z >= SIZE))
+		{
+			// The basin walls
+			return AIR;
+		}
+		return m_Levels[a_Y][a_Z][a_X];
+	}
+
+
+	void SetLevel(int a_X, int a_Y, int a_Z, int a_Level)
+	{
+		m_Levels[a_Y][a_Z][a_X] = a_Level;
+		WakeUp(a_X, a_Y, a_Z);
+		WakeUp(a_X - 1, a_Y, a_Z);
+		WakeUp(a_X + 1, a_Y, a_Z);
+		WakeUp(a_X, a_Y - 1, a_Z);
+		WakeUp(a_X, a_Y + 1, a_Z);
+		WakeUp(a_X, a_Y, a_Z - 1);
+		WakeUp(a_X, a_Y, a_Z + 1);
+	}
+
+
+	void WakeUp(int a_X, int a_Y, int a_Z)
+	{
+		if (GetLevel(a_X, a_Y, a_Z) == AIR)
+		{
+			// Only the fluid blocks are queued
+			return;
+		}
+		int ChunkIdx = (a_Z / cChunkDef::Width) * NUM_CHUNKS + a_X / cChunkDef::Width;
+		m_Slots[ChunkIdx][m_AddSlotNum].Add(a_X % cChunkDef::Width, FLOOR_Y + a_Y, a_Z % cChunkDef::Width);
+	}
+
+
+	size_t GetNumQueued(void) const
+	{
+		size_t res = 0;
+		for (int i = 0; i < NUM_CHUNKS * NUM_CHUNKS; i++)
+		{
+			for (int s = 0; s < m_Settings.m_TickDelay; s++)
+			{
+				res += m_Slots[i][s].GetNumBlocks();
+			}
+		}
+		return res;
+	}
+
+
+	void Tick(void)
+	{
+		m_AddSlotNum = m_SimSlotNum;
+		m_SimSlotNum = (m_SimSlotNum + 1) % m_Settings.m_TickDelay;
+		for (int i = 0; i < NUM_CHUNKS * NUM_CHUNKS; i++)
+		{
+			m_Slots[i][m_SimSlotNum].TakeBlocks(m_SimBlocks);
+			int BaseX = (i % NUM_CHUNKS) * cChunkDef::Width;
+			int BaseZ = (i / NUM_CHUNKS) * cChunkDef::Width;
+			for (std::vector<UInt16>::const_iterator itr = m_SimBlocks.begin(), end = m_SimBlocks.end(); itr != end; ++itr)
+			{
+				int RelX, RelY, RelZ;
+				cDirtyBlockSet::UnpackBlock(*itr, RelX, RelY, RelZ);
+				SimulateBlock(BaseX + RelX, RelY - FLOOR_Y, BaseZ + RelZ);
+			}
+		}
+	}
+
+
+	/** Simulates a single fluid block the way cFloodyFluidSimulator does on a solid floor */
+	void SimulateBlock(int a_X, int a_Y, int a_Z)
+	{
+		m_NumSimulated += 1;
+		int Level = GetLevel(a_X, a_Y, a_Z);
+		int Neighbors[4] =
+		{
+			GetLevel(a_X - 1, a_Y, a_Z),
+			GetLevel(a_X + 1, a_Y, a_Z),
+			GetLevel(a_X, a_Y, a_Z - 1),
+			GetLevel(a_X, a_Y, a_Z + 1),
+		};
+
+		if (Level > 0)
+		{
+			// A flowing block becomes a source when having enough source neighbors:
+			int NumSources = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				NumSources += (Neighbors[i] == 0) ? 1 : 0;
+			}
+			if ((m_Settings.m_NumNeighborsForSource > 0) && (NumSources >= m_Settings.m_NumNeighborsForSource))
+			{
+				SetLevel(a_X, a_Y, a_Z, 0);
+				return;
+			}
+		}
+
+		// Spread to the neighbors that have no fluid or a lower level:
+		int NewLevel = Level + m_Settings.m_Falloff;
+		if (NewLevel > 7)
+		{
+			return;
+		}
+		static const int Dirs[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+		for (int i = 0; i < 4; i++)
+		{
+			int NeighborX = a_X + Dirs[i][0];
+			int NeighborZ = a_Z + Dirs[i][1];
+			if ((NeighborX < 0) || (NeighborX >= SIZE) || (NeighborZ < 0) || (NeighborZ >= SIZE))
+			{
+				continue;
+			}
+			if ((Neighbors[i] == AIR) || (Neighbors[i] > NewLevel))
+			{
+				SetLevel(NeighborX, a_Y, NeighborZ, NewLevel);
+			}
+		}
+	}
+} ;
+
+
+
+
+
+/** Checks the basic operations of cDirtyBlockSet */
+static void TestDirtyBlockSet(void)
+{
+	cDirtyBlockSet Set;
+	testassert(Set.GetNumBlocks() == 0);
+	testassert(!Set.HasBlock(1, 2, 3));
+
+	// Duplicates are rejected:
+	testassert(Set.Add(1, 2, 3));
+	testassert(!Set.Add(1, 2, 3));
+	testassert(Set.HasBlock(1, 2, 3));
+	testassert(!Set.HasBlock(3, 2, 1));
+
+	// Blocks in multiple sections, including the chunk's corners:
+	testassert(Set.Add(15, 255, 15));
+	testassert(Set.Add(0, 0, 0));
+	testassert(Set.Add(5, 17, 0));
+	testassert(Set.Add(4, 17, 1));
+	testassert(!Set.Add(15, 255, 15));
+	testassert(Set.GetNumBlocks() == 5);
+
+	// The blocks are taken in the block order and the set is emptied:
+	std::vector<UInt16> Blocks;
+	Set.TakeBlocks(Blocks);
+	testassert(Blocks.size() == 5);
+	static const int Expected[5][3] =
+	{
+		{0, 0, 0},
+		{1, 2, 3},
+		{5, 17, 0},
+		{4, 17, 1},
+		{15, 255, 15},
+	};
+	for (size_t i = 0; i < Blocks.size(); i++)
+	{
+		int x, y, z;
+		cDirtyBlockSet::UnpackBlock(Blocks[i], x, y, z);
+		testassert((x == Expected[i][0]) && (y == Expected[i][1]) && (z == Expected[i][2]));
+	}
+	testassert(Set.GetNumBlocks() == 0);
+	testassert(!Set.HasBlock(1, 2, 3));
+
+	// The set can be refilled after taking:
+	testassert(Set.Add(1, 2, 3));
+	testassert(Set.HasBlock(1, 2, 3));
+
+	// Taking clears the bits of the blocks sharing a bitset word, and of the blocks in the sections released after staying empty:
+	testassert(Set.Add(2, 2, 3));
+	Set.TakeBlocks(Blocks);
+	testassert(Blocks.size() == 2);
+	testassert(Set.Add(2, 2, 3));
+	testassert(!Set.HasBlock(1, 2, 3));
+	for (int i = 0; i < 100; i++)
+	{
+		Set.TakeBlocks(Blocks);
+	}
+	testassert(!Set.HasBlock(2, 2, 3));
+	testassert(!Set.HasBlock(15, 255, 15));
+	testassert(Set.Add(15, 255, 15));
+	testassert(Set.GetNumBlocks() == 1);
+
+	// Out-of-chunk coords are caught:
+	CheckAsserts(
+		Set.Add(16, 0, 0);
+	);
+	CheckAsserts(
+		Set.Add(0, 256, 0);
+	);
+}
+
+
+
+
+
+/** Floods the basin using the specified slot storage; returns the number of ticks to settle and reports the time */
+template <class SlotType>
+static int Flood(const sFluidSettings & a_Settings, const char * a_StorageName, int & a_NumSources)
+{
+	std::unique_ptr<cBasin<SlotType>> Basin(new cBasin<SlotType>(a_Settings));
+	auto Start = std::chrono::steady_clock::now();
+	int NumTicks = Basin->RunUntilSettled();
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start);
+	a_NumSources = Basin->GetNumSources();
+	printf("  %-12s %-20s settled in %5d ticks, %8d blocks simulated, %8.2f ms\n",
+		a_Settings.m_Name, a_StorageName, NumTicks, Basin->GetNumSimulated(), static_cast<double>(Duration.count()) / 1000
+	);
+	return NumTicks;
+}
+
+
+
+
+
+/** Floods the basin with both storages; checks that both flood it the same */
+static void BenchmarkFlood(const sFluidSettings & a_Settings)
+{
+	int NumSourcesLinear, NumSourcesBitset;
+	int NumTicksLinear = Flood<cLinearScanSlot>(a_Settings, "linear scan", NumSourcesLinear);
+	int NumTicksBitset = Flood<cDirtyBlockSet>(a_Settings, "cDirtyBlockSet", NumSourcesBitset);
+
+	// The blocks are simulated in a different order within a tick, which may change the path, but not the outcome:
+	testassert(NumSourcesLinear == NumSourcesBitset);
+	testassert(NumTicksLinear > 0);
+	testassert(NumTicksBitset > 0);
+	if (a_Settings.m_NumNeighborsForSource > 0)
+	{
+		// The source walls fill the whole basin with sources:
+		testassert(NumSourcesBitset == cBasin<cDirtyBlockSet>::SIZE * cBasin<cDirtyBlockSet>::SIZE * cBasin<cDirtyBlockSet>::DEPTH);
+	}
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	TestDirtyBlockSet();
+
+	printf("Flooding a %d x %d basin, %d blocks deep:\n",
+		cBasin<cDirtyBlockSet>::SIZE, cBasin<cDirtyBlockSet>::SIZE, cBasin<cDirtyBlockSet>::DEPTH
+	);
+	BenchmarkFlood(g_Water);
+	BenchmarkFlood(g_Lava);
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,642 @@
+
+// RedstoneSimulatorTest.cpp
+
+// Builds the same circuits for cGraphRedstoneSimulator and cIncrementalRedstoneSimulator, runs both, and compares the results:
+//  - a wire run with the power decaying along it, across a chunk border
+//  - a torch inverter, and a torch clock
+//  - a repeater's delay, and a repeater locked by another repeater
+//  - a piston extended and retracted by a lever
+
+#include "Globals.h"
+#include "Chunk.h"
+#include "World.h"
+#include "AllocationPool.h"
+#include "Blocks/BlockPiston.h"
+#include "Simulator/GraphRedstoneSimulator.h"
+#include "Simulator/IncrementalRedstoneSimulator.h"
+
+
+
+
+
+/** The height at which the circuits are built, on a stone floor */
+static const int CIRCUIT_Y = 65;
+
+/** The number of ticks after which all the circuits in this test are settled */
+static const int SETTLE_TICKS = 30;
+
+/** The meta of a lever standing on the floor, and the lever's "on" bit */
+static const NIBBLETYPE LEVER_FLOOR = 0x05;
+static const NIBBLETYPE LEVER_ON = 0x08;
+
+/** The metas of the repeaters outputting towards ZM and XP; the delay is in bits 2 and 3 */
+static const NIBBLETYPE REPEATER_ZM = 0x00;
+static const NIBBLETYPE REPEATER_XP = 0x01;
+
+
+
+
+
+/** Allocates the chunk sections straight from the heap */
+class cTestSectionPool :
+	public cAllocationPool<cChunkData::sChunkSection>
+{
+public:
+	virtual cChunkData::sChunkSection * Allocate(void) override
+	{
+		return new cChunkData::sChunkSection;
+	}
+
+	virtual void Free(cChunkData::sChunkSection * a_Ptr) override
+	{
+		delete a_Ptr;
+	}
+} ;
+
+
+
+
+
+/** Two neighboring chunks, [0, 0] and [1, 0], simulated by one of the redstone simulators.
+The blocks are changed the same way the chunkmap does it: the chunk's block is set, then the simulator is woken up.
+The world passed to the simulator is never constructed, the world's functions the simulators call are stubs. */
+class cTestCircuit
+{
+public:
+	cTestCircuit(bool a_UseGraphSimulator);
+	~cTestCircuit();
+
+	/** Sets the block at the specified absolute coords and wakes the simulator up */
+	void SetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta);
+
+	BLOCKTYPE GetBlock(int a_BlockX, int a_BlockY, int a_BlockZ);
+	NIBBLETYPE GetMeta(int a_BlockX, int a_BlockY, int a_BlockZ);
+
+	/** Simulates the specified number of ticks in both chunks */
+	void Tick(int a_NumTicks = 1);
+
+	/** Returns the number of the ticks simulated so far */
+	int GetNumTicks(void) const { return m_NumTicks; }
+
+	/** Returns the number of times the pistons have been extended or retracted */
+	int GetNumPistonMoves(void) const { return m_NumPistonMoves; }
+
+	cRedstoneSimulator & GetSimulator(void) { return *m_Simulator; }
+
+	/** Returns the circuit whose (fake) world is the one specified */
+	static cTestCircuit & FromWorld(cWorld * a_World);
+
+	/** Moves the piston at the specified coords, called from the stubbed piston handler.
+	Same as the piston handler, the piston that is already in the requested state is left alone. */
+	void MovePiston(int a_BlockX, int a_BlockY, int a_BlockZ, bool a_ShouldExtend);
+
+protected:
+
+	/** All the existing circuits, so that the stubbed piston handler can find the circuit by its world */
+	static std::vector<cTestCircuit *> s_Circuits;
+
+	typedef std::aligned_storage<sizeof(cWorld)>::type cWorldStorage;
+
+	/** The storage for the world object; the object is never constructed, only its address is used.
+	Allocated on the heap, the world object is too large for the stack. */
+	std::unique_ptr<cWorldStorage> m_WorldStorage;
+
+	cTestSectionPool m_Pool;
+	std::unique_ptr<cRedstoneSimulator> m_Simulator;
+	std::unique_ptr<cChunk> m_Chunks[2];
+	int m_NumTicks;
+	int m_NumPistonMoves;
+
+	cWorld & GetWorld(void) { return reinterpret_cast<cWorld &>(*m_WorldStorage); }
+
+	/** Returns the chunk containing the specified absolute coords */
+	cChunk & GetChunk(int a_BlockX, int a_BlockZ);
+} ;
+
+
+
+
+
+std::vector<cTestCircuit *> cTestCircuit::s_Circuits;
+
+
+
+
+
+cTestCircuit::cTestCircuit(bool a_UseGraphSimulator) :
+	m_WorldStorage(new cWorldStorage()),
+	m_NumTicks(0),
+	m_NumPistonMoves(0)
+{
+	if (a_UseGraphSimulator)
+	{
+		m_Simulator.reset(new cGraphRedstoneSimulator(GetWorld()));
+	}
+	else
+	{
+		m_Simulator.reset(new cIncrementalRedstoneSimulator(GetWorld()));
+	}
+	m_Chunks[0].reset(new cChunk(0, 0, nullptr, &GetWorld(), nullptr, nullptr, nullptr, nullptr, m_Pool));
+	m_Chunks[1].reset(new cChunk(1, 0, nullptr, &GetWorld(), m_Chunks[0].get(), nullptr, nullptr, nullptr, m_Pool));
+	for (auto & Chunk : m_Chunks)
+	{
+		Chunk->SetRedstoneSimulatorData(m_Simulator->CreateChunkData());
+		for (int z = 0; z < cChunkDef::Width; z++)
+		{
+			for (int x = 0; x < cChunkDef::Width; x++)
+			{
+				Chunk->SetBlock(x, CIRCUIT_Y - 1, z, E_BLOCK_STONE, 0);
+			}
+		}
+	}
+	s_Circuits.push_back(this);
+}
+
+
+
+
+
+cTestCircuit::~cTestCircuit()
+{
+	s_Circuits.erase(std::find(s_Circuits.begin(), s_Circuits.end(), this));
+
+	// Destroy the chunks before the simulator that created their data:
+	m_Chunks[1].reset();
+	m_Chunks[0].reset();
+}
+
+
+
+
+
+void cTestCircuit::SetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+{
+	cChunk & Chunk = GetChunk(a_BlockX, a_BlockZ);
+	Chunk.SetBlock(a_BlockX - Chunk.GetPosX() * cChunkDef::Width, a_BlockY, a_BlockZ - Chunk.GetPosZ() * cChunkDef::Width, a_BlockType, a_BlockMeta);
+	m_Simulator->WakeUp(a_BlockX, a_BlockY, a_BlockZ, &Chunk);
+}
+
+
+
+
+
+BLOCKTYPE cTestCircuit::GetBlock(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	cChunk & Chunk = GetChunk(a_BlockX, a_BlockZ);
+	return Chunk.GetBlock(a_BlockX - Chunk.GetPosX() * cChunkDef::Width, a_BlockY, a_BlockZ - Chunk.GetPosZ() * cChunkDef::Width);
+}
+
+
+
+
+
+NIBBLETYPE cTestCircuit::GetMeta(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	cChunk & Chunk = GetChunk(a_BlockX, a_BlockZ);
+	return Chunk.GetMeta(a_BlockX - Chunk.GetPosX() * cChunkDef::Width, a_BlockY, a_BlockZ - Chunk.GetPosZ() * cChunkDef::Width);
+}
+
+
+
+
+
+void cTestCircuit::Tick(int a_NumTicks)
+{
+	for (int i = 0; i < a_NumTicks; i++)
+	{
+		for (auto & Chunk : m_Chunks)
+		{
+			Chunk->Tick(std::chrono::milliseconds(50));
+		}
+		m_NumTicks += 1;
+	}
+}
+
+
+
+
+
+cTestCircuit & cTestCircuit::FromWorld(cWorld * a_World)
+{
+	for (auto Circuit : s_Circuits)
+	{
+		if (&Circuit->GetWorld() == a_World)
+		{
+			return *Circuit;
+		}
+	}
+	testassert(!"The world doesn't belong to any circuit");
+	return *s_Circuits.front();
+}
+
+
+
+
+
+void cTestCircuit::MovePiston(int a_BlockX, int a_BlockY, int a_BlockZ, bool a_ShouldExtend)
+{
+	BLOCKTYPE BlockType = GetBlock(a_BlockX, a_BlockY, a_BlockZ);
+	NIBBLETYPE Meta = GetMeta(a_BlockX, a_BlockY, a_BlockZ);
+	bool IsExtended = ((Meta & E_META_PISTON_EXTENDED) != 0);
+	if (IsExtended == a_ShouldExtend)
+	{
+		return;
+	}
+	m_NumPistonMoves += 1;
+	SetBlock(a_BlockX, a_BlockY, a_BlockZ, BlockType, static_cast<NIBBLETYPE>(Meta ^ E_META_PISTON_EXTENDED));
+}
+
+
+
+
+
+cChunk & cTestCircuit::GetChunk(int a_BlockX, int a_BlockZ)
+{
+	int ChunkX, ChunkZ;
+	cChunkDef::BlockToChunk(a_BlockX, a_BlockZ, ChunkX, ChunkZ);
+	testassert((ChunkX >= 0) && (ChunkX <= 1) && (ChunkZ == 0));
+	return *m_Chunks[ChunkX];
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cChunk, the ticking stubbed to run the circuit's simulator, in the same order as the server does:
+
+void cChunk::Tick(std::chrono::milliseconds a_Dt)
+{
+	CheckBlocks();
+	cTestCircuit::FromWorld(m_World).GetSimulator().SimulateChunk(a_Dt, m_PosX, m_PosZ, this);
+}
+
+
+
+
+
+void cChunk::CheckBlocks(void)
+{
+	// Wake the simulator up for the blocks queued by SetBlock(); all the blocks in the test circuits can stay where they are:
+	std::vector<Vector3i> ToTickBlocks;
+	std::swap(m_ToTickBlocks, ToTickBlocks);
+	for (auto & Pos : ToTickBlocks)
+	{
+		cTestCircuit::FromWorld(m_World).GetSimulator().WakeUp(Pos.x + m_PosX * cChunkDef::Width, Pos.y, Pos.z + m_PosZ * cChunkDef::Width, this);
+	}
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cBlockPistonHandler, stubbed to move the pistons in the test circuits:
+
+void cBlockPistonHandler::ExtendPiston(int a_BlockX, int a_BlockY, int a_BlockZ, cWorld * a_World)
+{
+	cTestCircuit::FromWorld(a_World).MovePiston(a_BlockX, a_BlockY, a_BlockZ, true);
+}
+
+
+
+
+
+void cBlockPistonHandler::RetractPiston(int a_BlockX, int a_BlockY, int a_BlockZ, cWorld * a_World)
+{
+	cTestCircuit::FromWorld(a_World).MovePiston(a_BlockX, a_BlockY, a_BlockZ, false);
+}
+
+
+
+
+
+/** The same circuit, built and simulated by both simulators */
+class cCircuitPair
+{
+public:
+	cTestCircuit m_Graph;
+	cTestCircuit m_Incremental;
+
+	cCircuitPair(void) :
+		m_Graph(true),
+		m_Incremental(false)
+	{
+	}
+
+	void SetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+	{
+		m_Graph.SetBlock(a_BlockX, a_BlockY, a_BlockZ, a_BlockType, a_BlockMeta);
+		m_Incremental.SetBlock(a_BlockX, a_BlockY, a_BlockZ, a_BlockType, a_BlockMeta);
+	}
+
+	void Tick(int a_NumTicks = 1)
+	{
+		m_Graph.Tick(a_NumTicks);
+		m_Incremental.Tick(a_NumTicks);
+	}
+
+	/** Checks that both simulators have left the same blocks and metas in the specified area at CIRCUIT_Y; exits on a difference */
+	void CheckSame(const char * a_TestName, int a_MinX, int a_MaxX, int a_MinZ, int a_MaxZ)
+	{
+		for (int z = a_MinZ; z <= a_MaxZ; z++)
+		{
+			for (int x = a_MinX; x <= a_MaxX; x++)
+			{
+				BLOCKTYPE GraphBlock = m_Graph.GetBlock(x, CIRCUIT_Y, z);
+				NIBBLETYPE GraphMeta = m_Graph.GetMeta(x, CIRCUIT_Y, z);
+				BLOCKTYPE IncrementalBlock = m_Incremental.GetBlock(x, CIRCUIT_Y, z);
+				NIBBLETYPE IncrementalMeta = m_Incremental.GetMeta(x, CIRCUIT_Y, z);
+				if ((GraphBlock != IncrementalBlock) || (GraphMeta != IncrementalMeta))
+				{
+					printf("%s: the simulators differ at {%d, %d, %d} after %d ticks: graph %d:%d, incremental %d:%d\n",
+						a_TestName, x, CIRCUIT_Y, z, m_Graph.GetNumTicks(),
+						GraphBlock, GraphMeta, IncrementalBlock, IncrementalMeta
+					);
+					exit(1);
+				}
+			}
+		}
+	}
+} ;
+
+
+
+
+
+/** Returns the number of ticks until the block at the specified coords becomes the specified blocktype; -1 if it doesn't within a_MaxTicks */
+static int TicksUntil(cTestCircuit & a_Circuit, int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, int a_MaxTicks)
+{
+	for (int i = 1; i <= a_MaxTicks; i++)
+	{
+		a_Circuit.Tick();
+		if (a_Circuit.GetBlock(a_BlockX, a_BlockY, a_BlockZ) == a_BlockType)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+
+
+/** A lever powering a run of 17 wires that crosses into the neighboring chunk; the last two wires stay unpowered */
+static void TestWireDecay(void)
+{
+	cCircuitPair Circuit;
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	for (int x = 11; x <= 27; x++)
+	{
+		Circuit.SetBlock(x, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_WIRE, 0);
+	}
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Wire decay, off", 10, 27, 8, 8);
+
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR | LEVER_ON);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Wire decay, on", 10, 27, 8, 8);
+	for (int x = 11; x <= 27; x++)
+	{
+		testassert(Circuit.m_Graph.GetMeta(x, CIRCUIT_Y, 8) == std::max(0, 15 - (x - 11)));
+	}
+
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Wire decay, off again", 10, 27, 8, 8);
+	for (int x = 11; x <= 27; x++)
+	{
+		testassert(Circuit.m_Graph.GetMeta(x, CIRCUIT_Y, 8) == 0);
+	}
+	printf("Wire decay: OK\n");
+}
+
+
+
+
+
+/** A lever powering a block through a wire; the torch on the block's other side inverts the power for a lamp */
+static void TestTorchInverter(void)
+{
+	cCircuitPair Circuit;
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.SetBlock(11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_WIRE, 0);
+	Circuit.SetBlock(12, CIRCUIT_Y, 8, E_BLOCK_STONE, 0);
+	Circuit.SetBlock(13, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_TORCH_ON, E_META_TORCH_EAST);
+	Circuit.SetBlock(14, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_LAMP_OFF, 0);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Torch inverter, lever off", 10, 14, 8, 8);
+	testassert(Circuit.m_Graph.GetBlock(13, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_TORCH_ON);
+	testassert(Circuit.m_Graph.GetBlock(14, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_ON);
+
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR | LEVER_ON);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Torch inverter, lever on", 10, 14, 8, 8);
+	testassert(Circuit.m_Graph.GetBlock(13, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_TORCH_OFF);
+	testassert(Circuit.m_Graph.GetBlock(14, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_OFF);
+
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Torch inverter, lever off again", 10, 14, 8, 8);
+	testassert(Circuit.m_Graph.GetBlock(13, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_TORCH_ON);
+	testassert(Circuit.m_Graph.GetBlock(14, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_ON);
+	printf("Torch inverter: OK\n");
+}
+
+
+
+
+
+/** A torch whose output is wired back into its own block. The two simulators toggle the torch at different ticks,
+so instead of the blocks, the test compares that both keep the torch toggling. */
+static void TestTorchClock(void)
+{
+	static const int NUM_TICKS = 40;
+	static const int WIRES[][2] =
+	{
+		{14, 8}, {14, 9}, {14, 10}, {13, 10}, {12, 10}, {12, 9},  // The last wire points into the torch's block
+	} ;
+
+	cCircuitPair Circuit;
+	Circuit.SetBlock(12, CIRCUIT_Y, 8, E_BLOCK_STONE, 0);
+	Circuit.SetBlock(13, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_TORCH_ON, E_META_TORCH_EAST);
+	for (size_t i = 0; i < ARRAYCOUNT(WIRES); i++)
+	{
+		Circuit.SetBlock(WIRES[i][0], CIRCUIT_Y, WIRES[i][1], E_BLOCK_REDSTONE_WIRE, 0);
+	}
+
+	cTestCircuit * Simulated[] = { &Circuit.m_Graph, &Circuit.m_Incremental };
+	int NumToggles[ARRAYCOUNT(Simulated)];
+	int LastToggle[ARRAYCOUNT(Simulated)];
+	for (size_t i = 0; i < ARRAYCOUNT(Simulated); i++)
+	{
+		NumToggles[i] = 0;
+		LastToggle[i] = 0;
+		BLOCKTYPE Torch = Simulated[i]->GetBlock(13, CIRCUIT_Y, 8);
+		for (int Tick = 1; Tick <= NUM_TICKS; Tick++)
+		{
+			Simulated[i]->Tick();
+			BLOCKTYPE NewTorch = Simulated[i]->GetBlock(13, CIRCUIT_Y, 8);
+			if (NewTorch != Torch)
+			{
+				Torch = NewTorch;
+				NumToggles[i] += 1;
+				LastToggle[i] = Tick;
+			}
+		}
+	}
+	printf("Torch clock: %d toggles in graph, %d toggles in incremental, in %d ticks\n", NumToggles[0], NumToggles[1], NUM_TICKS);
+	for (size_t i = 0; i < ARRAYCOUNT(Simulated); i++)
+	{
+		// Each state lasts at most a few ticks, and the clock doesn't stop:
+		testassert(NumToggles[i] >= NUM_TICKS / 4);
+		testassert(LastToggle[i] > NUM_TICKS - 4);
+	}
+	printf("Torch clock: OK\n");
+}
+
+
+
+
+
+/** A lever powering a lamp through a repeater, for each of the repeater's delays.
+The incremental simulator switches the repeater a fixed number of ticks later than the graph one, because it handles
+the change one tick after it has been woken up; the test checks that both add the same delay for each delay setting. */
+static void TestRepeaterDelay(void)
+{
+	// The incremental simulator's extra ticks, measured with the first delay:
+	int IncrementalLagOn = -1;
+	int IncrementalLagOff = -1;
+	for (int Delay = 0; Delay < 4; Delay++)
+	{
+		cCircuitPair Circuit;
+		Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+		Circuit.SetBlock(11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_REPEATER_OFF, static_cast<NIBBLETYPE>(REPEATER_XP | (Delay << 2)));
+		Circuit.SetBlock(12, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_LAMP_OFF, 0);
+		Circuit.Tick(SETTLE_TICKS);
+		Circuit.CheckSame("Repeater delay, off", 10, 12, 8, 8);
+
+		// The lever is evaluated in the first tick, then the repeater waits (Delay + 1) redstone ticks, two game ticks each:
+		int ExpectedTicks = (Delay + 1) * 2 + 1;
+		Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR | LEVER_ON);
+		int GraphOn = TicksUntil(Circuit.m_Graph, 11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_REPEATER_ON, SETTLE_TICKS);
+		int IncrementalOn = TicksUntil(Circuit.m_Incremental, 11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_REPEATER_ON, SETTLE_TICKS);
+		testassert(GraphOn == ExpectedTicks);
+		testassert(IncrementalOn >= GraphOn);
+		Circuit.Tick(SETTLE_TICKS);
+		Circuit.CheckSame("Repeater delay, on", 10, 12, 8, 8);
+		testassert(Circuit.m_Graph.GetBlock(12, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_ON);
+
+		Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+		int GraphOff = TicksUntil(Circuit.m_Graph, 11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_REPEATER_OFF, SETTLE_TICKS);
+		int IncrementalOff = TicksUntil(Circuit.m_Incremental, 11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_REPEATER_OFF, SETTLE_TICKS);
+		testassert(GraphOff == ExpectedTicks);
+		testassert(IncrementalOff >= GraphOff);
+		Circuit.Tick(SETTLE_TICKS);
+		Circuit.CheckSame("Repeater delay, off again", 10, 12, 8, 8);
+		testassert(Circuit.m_Graph.GetBlock(12, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_OFF);
+
+		// The difference between the two simulators doesn't depend on the delay:
+		if (Delay == 0)
+		{
+			IncrementalLagOn = IncrementalOn - GraphOn;
+			IncrementalLagOff = IncrementalOff - GraphOff;
+		}
+		testassert(IncrementalOn - GraphOn == IncrementalLagOn);
+		testassert(IncrementalOff - GraphOff == IncrementalLagOff);
+		printf("Repeater delay %d: graph %d / %d ticks, incremental %d / %d ticks (on / off)\n", Delay, GraphOn, GraphOff, IncrementalOn, IncrementalOff);
+	}
+	printf("Repeater delay: OK\n");
+}
+
+
+
+
+
+/** A repeater locked by another repeater powering its side: while locked, it keeps its output regardless of its input */
+static void TestRepeaterLock(void)
+{
+	cCircuitPair Circuit;
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.SetBlock(11, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_REPEATER_OFF, REPEATER_XP);
+	Circuit.SetBlock(12, CIRCUIT_Y, 8, E_BLOCK_REDSTONE_LAMP_OFF, 0);
+	Circuit.SetBlock(11, CIRCUIT_Y, 9, E_BLOCK_REDSTONE_REPEATER_OFF, REPEATER_ZM);  // Into the first repeater's side
+	Circuit.SetBlock(11, CIRCUIT_Y, 10, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Repeater lock, both off", 10, 12, 8, 10);
+
+	// Switch the repeater on, then lock it:
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR | LEVER_ON);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.SetBlock(11, CIRCUIT_Y, 10, E_BLOCK_LEVER, LEVER_FLOOR | LEVER_ON);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Repeater lock, locked on", 10, 12, 8, 10);
+	testassert(Circuit.m_Graph.GetBlock(11, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_REPEATER_ON);
+
+	// The locked repeater ignores its input:
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Repeater lock, input off while locked", 10, 12, 8, 10);
+	testassert(Circuit.m_Graph.GetBlock(11, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_REPEATER_ON);
+	testassert(Circuit.m_Graph.GetBlock(12, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_ON);
+
+	// Unlocked, the repeater follows its input again:
+	Circuit.SetBlock(11, CIRCUIT_Y, 10, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Repeater lock, unlocked", 10, 12, 8, 10);
+	testassert(Circuit.m_Graph.GetBlock(11, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_REPEATER_OFF);
+	testassert(Circuit.m_Graph.GetBlock(12, CIRCUIT_Y, 8) == E_BLOCK_REDSTONE_LAMP_OFF);
+	printf("Repeater lock: OK\n");
+}
+
+
+
+
+
+/** A lever extending and retracting a piston next to it */
+static void TestPiston(void)
+{
+	cCircuitPair Circuit;
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.SetBlock(11, CIRCUIT_Y, 8, E_BLOCK_PISTON, E_META_PISTON_XP);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Piston, off", 10, 11, 8, 8);
+	testassert(Circuit.m_Graph.GetNumPistonMoves() == 0);
+	testassert(Circuit.m_Incremental.GetNumPistonMoves() == 0);
+
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR | LEVER_ON);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Piston, on", 10, 11, 8, 8);
+	testassert(Circuit.m_Graph.GetMeta(11, CIRCUIT_Y, 8) == (E_META_PISTON_XP | E_META_PISTON_EXTENDED));
+	testassert(Circuit.m_Graph.GetNumPistonMoves() == 1);
+	testassert(Circuit.m_Incremental.GetNumPistonMoves() == 1);
+
+	Circuit.SetBlock(10, CIRCUIT_Y, 8, E_BLOCK_LEVER, LEVER_FLOOR);
+	Circuit.Tick(SETTLE_TICKS);
+	Circuit.CheckSame("Piston, off again", 10, 11, 8, 8);
+	testassert(Circuit.m_Graph.GetMeta(11, CIRCUIT_Y, 8) == E_META_PISTON_XP);
+	testassert(Circuit.m_Graph.GetNumPistonMoves() == 2);
+	testassert(Circuit.m_Incremental.GetNumPistonMoves() == 2);
+	printf("Piston: OK\n");
+}
+
+
+
+
+
+int main(int argc, char * argv[])
+{
+	TestWireDecay();
+	TestTorchInverter();
+	TestTorchClock();
+	TestRepeaterDelay();
+	TestRepeaterLock();
+	TestPiston();
+	printf("cGraphRedstoneSimulator matches cIncrementalRedstoneSimulator.\n");
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,477 @@
+
+// Stubs.cpp
+
+// Implements the stubs of the chunk, world and the other classes that the redstone simulators need, so that the test doesn't need the whole server.
+// The chunk keeps its blocks in a real cChunkData; its neighbors are only reachable through the neighbor pointers.
+// The chunk's Tick() and CheckBlocks(), which need the simulator, are stubbed in the test itself.
+// The world is never constructed, its stubbed functions don't touch it.
+
+#include "Globals.h"
+#include "Chunk.h"
+#include "World.h"
+#include "Enchantments.h"
+#include "BlockInfo.h"
+#include "Blocks/BlockHandler.h"
+#include "Blocks/ChunkInterface.h"
+#include "Simulator/RedstoneSimulator.h"
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cChunk:
+
+cChunk::cChunk(
+	int a_ChunkX, int a_ChunkZ,
+	cChunkMap * a_ChunkMap, cWorld * a_World,
+	cChunk * a_NeighborXM, cChunk * a_NeighborXP, cChunk * a_NeighborZM, cChunk * a_NeighborZP,
+	cAllocationPool<cChunkData::sChunkSection> & a_Pool
+) :
+	m_Presence(cpPresent),
+	m_ShouldGenerateIfLoadFailed(false),
+	m_IsLightValid(true),
+	m_IsDirty(false),
+	m_IsSaving(false),
+	m_HasLoadFailed(false),
+	m_EntityIterationDepth(0),
+	m_HasEntityHoles(false),
+	m_StayCount(0),
+	m_PosX(a_ChunkX),
+	m_PosZ(a_ChunkZ),
+	m_World(a_World),
+	m_ChunkMap(a_ChunkMap),
+	m_ChunkData(a_Pool),
+	m_BlockTickX(0),
+	m_BlockTickY(0),
+	m_BlockTickZ(0),
+	m_NeighborXM(a_NeighborXM),
+	m_NeighborXP(a_NeighborXP),
+	m_NeighborZM(a_NeighborZM),
+	m_NeighborZP(a_NeighborZP),
+	m_WaterSimulatorData(nullptr),
+	m_LavaSimulatorData(nullptr),
+	m_RedstoneSimulatorData(nullptr),  // Set by the test, the world's simulator is not available
+	m_IsRedstoneDirty(false),
+	m_AlwaysTicked(0)
+{
+	if (a_NeighborXM != nullptr)
+	{
+		a_NeighborXM->m_NeighborXP = this;
+	}
+	if (a_NeighborXP != nullptr)
+	{
+		a_NeighborXP->m_NeighborXM = this;
+	}
+	if (a_NeighborZM != nullptr)
+	{
+		a_NeighborZM->m_NeighborZP = this;
+	}
+	if (a_NeighborZP != nullptr)
+	{
+		a_NeighborZP->m_NeighborZM = this;
+	}
+}
+
+
+
+
+
+cChunk::~cChunk()
+{
+	if (m_NeighborXM != nullptr)
+	{
+		m_NeighborXM->m_NeighborXP = nullptr;
+	}
+	if (m_NeighborXP != nullptr)
+	{
+		m_NeighborXP->m_NeighborXM = nullptr;
+	}
+	if (m_NeighborZM != nullptr)
+	{
+		m_NeighborZM->m_NeighborZP = nullptr;
+	}
+	if (m_NeighborZP != nullptr)
+	{
+		m_NeighborZP->m_NeighborZM = nullptr;
+	}
+	delete m_RedstoneSimulatorData;
+	m_RedstoneSimulatorData = nullptr;
+}
+
+
+
+
+
+void cChunk::SetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta, bool a_SendToClients)
+{
+	// Same as the server's chunk, the simulators are woken up only for the queued blocks, in the next tick's CheckBlocks():
+	if ((GetBlock(a_RelX, a_RelY, a_RelZ) != a_BlockType) || (GetMeta(a_RelX, a_RelY, a_RelZ) != a_BlockMeta))
+	{
+		m_IsRedstoneDirty = true;
+		m_ChunkData.SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType);
+		m_ChunkData.SetMeta(a_RelX, a_RelY, a_RelZ, a_BlockMeta);
+	}
+	m_ToTickBlocks.push_back(Vector3i(a_RelX, a_RelY, a_RelZ));
+	QueueTickBlockNeighbors(a_RelX, a_RelY, a_RelZ);
+}
+
+
+
+
+
+void cChunk::QueueTickBlock(int a_RelX, int a_RelY, int a_RelZ)
+{
+	m_ToTickBlocks.push_back(Vector3i(a_RelX, a_RelY, a_RelZ));
+}
+
+
+
+
+
+void cChunk::QueueTickBlockNeighbors(int a_RelX, int a_RelY, int a_RelZ)
+{
+	UnboundedQueueTickBlock(a_RelX + 1, a_RelY, a_RelZ);
+	UnboundedQueueTickBlock(a_RelX - 1, a_RelY, a_RelZ);
+	UnboundedQueueTickBlock(a_RelX, a_RelY + 1, a_RelZ);
+	UnboundedQueueTickBlock(a_RelX, a_RelY - 1, a_RelZ);
+	UnboundedQueueTickBlock(a_RelX, a_RelY, a_RelZ + 1);
+	UnboundedQueueTickBlock(a_RelX, a_RelY, a_RelZ - 1);
+}
+
+
+
+
+
+void cChunk::UnboundedQueueTickBlock(int a_RelX, int a_RelY, int a_RelZ)
+{
+	if ((a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return;
+	}
+	cChunk * Chunk = GetRelNeighborChunkAdjustCoords(a_RelX, a_RelZ);
+	if (Chunk != nullptr)
+	{
+		Chunk->QueueTickBlock(a_RelX, a_RelY, a_RelZ);
+	}
+}
+
+
+
+
+
+BLOCKTYPE cChunk::GetBlock(int a_RelX, int a_RelY, int a_RelZ) const
+{
+	return m_ChunkData.GetBlock(a_RelX, a_RelY, a_RelZ);
+}
+
+
+
+
+
+void cChunk::GetBlockTypeMeta(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta) const
+{
+	a_BlockType = GetBlock(a_RelX, a_RelY, a_RelZ);
+	a_BlockMeta = m_ChunkData.GetMeta(a_RelX, a_RelY, a_RelZ);
+}
+
+
+
+
+
+bool cChunk::UnboundedRelGetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta) const
+{
+	if ((a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	cChunk * Chunk = GetRelNeighborChunkAdjustCoords(a_RelX, a_RelZ);
+	if (Chunk == nullptr)
+	{
+		return false;
+	}
+	Chunk->GetBlockTypeMeta(a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta);
+	return true;
+}
+
+
+
+
+
+bool cChunk::UnboundedRelGetBlockType(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType) const
+{
+	if ((a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	cChunk * Chunk = GetRelNeighborChunkAdjustCoords(a_RelX, a_RelZ);
+	if (Chunk == nullptr)
+	{
+		return false;
+	}
+	a_BlockType = Chunk->GetBlock(a_RelX, a_RelY, a_RelZ);
+	return true;
+}
+
+
+
+
+
+cChunk * cChunk::GetNeighborChunk(int a_BlockX, int a_BlockZ)
+{
+	return GetRelNeighborChunk(a_BlockX - m_PosX * cChunkDef::Width, a_BlockZ - m_PosZ * cChunkDef::Width);
+}
+
+
+
+
+
+cChunk * cChunk::GetRelNeighborChunk(int a_RelX, int a_RelZ)
+{
+	return GetRelNeighborChunkAdjustCoords(a_RelX, a_RelZ);
+}
+
+
+
+
+
+cChunk * cChunk::GetRelNeighborChunkAdjustCoords(int & a_RelX, int & a_RelZ) const
+{
+	cChunk * Chunk = const_cast<cChunk *>(this);
+	int RelX = a_RelX;
+	int RelZ = a_RelZ;
+	while ((RelX >= Width) && (Chunk != nullptr))
+	{
+		RelX -= Width;
+		Chunk = Chunk->m_NeighborXP;
+	}
+	while ((RelX < 0) && (Chunk != nullptr))
+	{
+		RelX += Width;
+		Chunk = Chunk->m_NeighborXM;
+	}
+	while ((RelZ >= Width) && (Chunk != nullptr))
+	{
+		RelZ -= Width;
+		Chunk = Chunk->m_NeighborZP;
+	}
+	while ((RelZ < 0) && (Chunk != nullptr))
+	{
+		RelZ += Width;
+		Chunk = Chunk->m_NeighborZM;
+	}
+	if (Chunk != nullptr)
+	{
+		a_RelX = RelX;
+		a_RelZ = RelZ;
+	}
+	return Chunk;
+}
+
+
+
+
+
+NIBBLETYPE cChunk::GetTimeAlteredLight(NIBBLETYPE a_Skylight) const
+{
+	return a_Skylight;
+}
+
+
+
+
+
+bool cChunk::DoWithRedstonePoweredEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ, cRedstonePoweredCallback & a_Callback)
+{
+	return false;
+}
+
+
+
+
+
+bool cChunk::DoWithChestAt(int a_BlockX, int a_BlockY, int a_BlockZ, cChestCallback & a_Callback)
+{
+	return false;
+}
+
+
+
+
+
+void cChunk::BroadcastSoundEffect(const AString & a_SoundName, double a_X, double a_Y, double a_Z, float a_Volume, float a_Pitch, const cClientHandle * a_Exclude)
+{
+}
+
+
+
+
+
+void cChunk::BroadcastSoundParticleEffect(int a_EffectID, int a_SrcX, int a_SrcY, int a_SrcZ, int a_Data, const cClientHandle * a_Exclude)
+{
+}
+
+
+
+
+
+void cChunk::WakeUpHoppersAt(int a_RelX, int a_RelY, int a_RelZ)
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cWorld:
+
+cPlayer * cWorld::FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit, bool a_CheckLineOfSight)
+{
+	return nullptr;
+}
+
+
+
+
+
+bool cWorld::ForEachEntityInChunk(int a_ChunkX, int a_ChunkZ, cEntityCallback & a_Callback)
+{
+	return true;
+}
+
+
+
+
+
+NIBBLETYPE cWorld::GetBlockSkyLight(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	return 0;
+}
+
+
+
+
+
+bool cWorld::IsChunkLighted(int a_ChunkX, int a_ChunkZ)
+{
+	return true;
+}
+
+
+
+
+
+void cWorld::QueueLightChunk(int a_ChunkX, int a_ChunkZ, cChunkCoordCallback * a_Callback)
+{
+}
+
+
+
+
+
+bool cWorld::SetTrapdoorOpen(int a_BlockX, int a_BlockY, int a_BlockZ, bool a_Open)
+{
+	return false;
+}
+
+
+
+
+
+UInt32 cWorld::SpawnPrimedTNT(double a_X, double a_Y, double a_Z, int a_FuseTimeInSec, double a_InitialVelocityCoeff)
+{
+	return cEntity::INVALID_ID;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cChunkInterface:
+
+BLOCKTYPE cChunkInterface::GetBlock(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	return E_BLOCK_AIR;
+}
+
+
+
+
+
+NIBBLETYPE cChunkInterface::GetBlockMeta(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	return 0;
+}
+
+
+
+
+
+void cChunkInterface::SetBlockMeta(int a_BlockX, int a_BlockY, int a_BlockZ, NIBBLETYPE a_MetaData)
+{
+}
+
+
+
+
+
+bool cChunkInterface::ForEachChunkInRect(int a_MinChunkX, int a_MaxChunkX, int a_MinChunkZ, int a_MaxChunkZ, cChunkDataCallback & a_Callback)
+{
+	return false;
+}
+
+
+
+
+
+bool cChunkInterface::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes)
+{
+	return false;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cBlockHandler:
+
+cBlockHandler * cBlockHandler::CreateBlockHandler(BLOCKTYPE a_BlockType)
+{
+	// The simulators only need the blockinfo's properties, not the handlers
+	return nullptr;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cEnchantments, used by cItem's constructor:
+
+cEnchantments::cEnchantments(const AString & a_StringSpec)
+{
+}
+
+
+
+
+
+void cEnchantments::Clear(void)
+{
+}
+
+
+
+
+
+AString ItemToFullString(const cItem & a_Item)
+{
+	return Printf("%d:%d * %d", a_Item.m_ItemType, a_Item.m_ItemDamage, a_Item.m_ItemCount);
+}
+
+
+
+